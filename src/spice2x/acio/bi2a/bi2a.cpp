@@ -43,223 +43,249 @@ static bool __cdecl ac_io_bi2a_get_control_status_buffer(void *buffer) {
     return true;
 }
 
-static bool __cdecl ac_io_bi2a_update_control_status_buffer() {
+/*
+ * status buffer update, specialized per game so the poll path does not test the model
+ */
 
-    // check freeze
-    if (STATUS_BUFFER_FREEZE) {
-        return true;
-    }
+template<uint32_t Model>
+static void ac_io_bi2a_update_control_status_buffer_game() {
+}
 
-    // Sound Voltex
-    if (avs::game::is_model("KFC")) {
+// Sound Voltex
+template<>
+void ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("KFC")>() {
+
+    // clear buffer
+    memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
+    STATUS_BUFFER[0] = 1;
+
+    /*
+     * Unmapped Buttons
+     *
+     * Control      Bit
+     * EX BUTTON 1  93
+     * EX BUTTON 2  92
+     * EX ANALOG 1  170-183
+     * EX ANALOG 2  186-199
+     */
+
+    // get buttons
+    auto &buttons = games::sdvx::get_buttons();
+
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Test))) {
+        ARRAY_SETB(STATUS_BUFFER, 19);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Service))) {
+        ARRAY_SETB(STATUS_BUFFER, 18);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::CoinMech))) {
+        ARRAY_SETB(STATUS_BUFFER, 17);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Start))) {
+        ARRAY_SETB(STATUS_BUFFER, 85);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_A))) {
+        ARRAY_SETB(STATUS_BUFFER, 84);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_B))) {
+        ARRAY_SETB(STATUS_BUFFER, 83);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_C))) {
+        ARRAY_SETB(STATUS_BUFFER, 82);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_D))) {
+        ARRAY_SETB(STATUS_BUFFER, 81);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_L))) {
+        ARRAY_SETB(STATUS_BUFFER, 80);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_R))) {
+        ARRAY_SETB(STATUS_BUFFER, 95);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Headphone))) {
+        ARRAY_SETB(STATUS_BUFFER, 87);
+    }
 
-        // clear buffer
-        memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
-        STATUS_BUFFER[0] = 1;
+    // volume left
+    const auto now = get_performance_milliseconds();
+    const auto vol_l_state = socd::socd_clean(0,
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Left)),
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Right)),
+        now);
+    if (vol_l_state == socd::SocdCCW) {
+        BI2A_VOLL = (BI2A_VOLL - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    } else if (vol_l_state == socd::SocdCW) {
+        BI2A_VOLL = (BI2A_VOLL + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    }
 
-        /*
-         * Unmapped Buttons
-         *
-         * Control      Bit
-         * EX BUTTON 1  93
-         * EX BUTTON 2  92
-         * EX ANALOG 1  170-183
-         * EX ANALOG 2  186-199
-         */
+    // volume right
+    const auto vol_r_state = socd::socd_clean(1,
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Left)),
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Right)),
+        now);
+    if (vol_r_state == socd::SocdCCW) {
+        BI2A_VOLR = (BI2A_VOLR - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    } else if (vol_r_state == socd::SocdCW) {
+        BI2A_VOLR = (BI2A_VOLR + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    }
 
-        // get buttons
-        auto &buttons = games::sdvx::get_buttons();
+    // update volumes
+    auto &analogs = games::sdvx::get_analogs();
+    auto vol_left = BI2A_VOLL;
+    auto vol_right = BI2A_VOLR;
+    if (analogs.at(0).isSet() || analogs.at(1).isSet()) {
+        vol_left += (unsigned int) (Analogs::getState(RI_MGR,
+                analogs.at(games::sdvx::Analogs::VOL_L)) * 1023.99f);
+        vol_right += (unsigned int) (Analogs::getState(RI_MGR,
+                analogs.at(games::sdvx::Analogs::VOL_R)) * 1023.99f);
+    }
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Test))) {
-            ARRAY_SETB(STATUS_BUFFER, 19);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Service))) {
-            ARRAY_SETB(STATUS_BUFFER, 18);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::CoinMech))) {
-            ARRAY_SETB(STATUS_BUFFER, 17);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Start))) {
-            ARRAY_SETB(STATUS_BUFFER, 85);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_A))) {
-            ARRAY_SETB(STATUS_BUFFER, 84);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_B))) {
-            ARRAY_SETB(STATUS_BUFFER, 83);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_C))) {
-            ARRAY_SETB(STATUS_BUFFER, 82);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_D))) {
-            ARRAY_SETB(STATUS_BUFFER, 81);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_L))) {
-            ARRAY_SETB(STATUS_BUFFER, 80);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_R))) {
-            ARRAY_SETB(STATUS_BUFFER, 95);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Headphone))) {
-            ARRAY_SETB(STATUS_BUFFER, 87);
-        }
+    // proper loops
+    vol_left %= 1024;
+    vol_right %= 1024;
 
-        // volume left
-        const auto now = get_performance_milliseconds();
-        const auto vol_l_state = socd::socd_clean(0,
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Left)),
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Right)),
-            now);
-        if (vol_l_state == socd::SocdCCW) {
-            BI2A_VOLL = (BI2A_VOLL - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        } else if (vol_l_state == socd::SocdCW) {
-            BI2A_VOLL = (BI2A_VOLL + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        }
+    // save volumes in buffer
+    *((uint16_t*) &STATUS_BUFFER[17]) = (uint16_t) ((vol_left) << 2);
+    *((uint16_t*) &STATUS_BUFFER[19]) = (uint16_t) ((vol_right) << 2);
 
-        // volume right
-        const auto vol_r_state = socd::socd_clean(1,
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Left)),
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Right)),
-            now);
-        if (vol_r_state == socd::SocdCCW) {
-            BI2A_VOLR = (BI2A_VOLR - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        } else if (vol_r_state == socd::SocdCW) {
-            BI2A_VOLR = (BI2A_VOLR + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        }
+    log_debug(
+        "bi2a",
+        "knobs = {} {}",
+        *((uint16_t*) &STATUS_BUFFER[17]),
+        *((uint16_t*) &STATUS_BUFFER[19]));
+}
 
-        // update volumes
-        auto &analogs = games::sdvx::get_analogs();
-        auto vol_left = BI2A_VOLL;
-        auto vol_right = BI2A_VOLR;
-        if (analogs.at(0).isSet() || analogs.at(1).isSet()) {
-            vol_left += (unsigned int) (Analogs::getState(RI_MGR,
-                    analogs.at(games::sdvx::Analogs::VOL_L)) * 1023.99f);
-            vol_right += (unsigned int) (Analogs::getState(RI_MGR,
-                    analogs.at(games::sdvx::Analogs::VOL_R)) * 1023.99f);
-        }
+// DanceDanceRevolution
+template<>
+void ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("MDX")>() {
 
-        // proper loops
-        vol_left %= 1024;
-        vol_right %= 1024;
+    // clear buffer
+    memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
+    STATUS_BUFFER[0] = 1;
 
-        // save volumes in buffer
-        *((uint16_t*) &STATUS_BUFFER[17]) = (uint16_t) ((vol_left) << 2);
-        *((uint16_t*) &STATUS_BUFFER[19]) = (uint16_t) ((vol_right) << 2);
+    // get buttons
+    auto &buttons = games::ddr::get_buttons();
 
-        log_debug(
-            "bi2a",
-            "knobs = {} {}",
-            *((uint16_t*) &STATUS_BUFFER[17]),
-            *((uint16_t*) &STATUS_BUFFER[19]));
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::COIN_MECH)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[2] |= 1 << 1;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::SERVICE)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[2] |= 1 << 2;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::TEST)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[2] |= 1 << 3;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_START)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[10] |= 1 << 7;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_UP)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[10] |= 1 << 6;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_DOWN)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[10] |= 1 << 5;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_LEFT)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[10] |= 1 << 4;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_RIGHT)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[10] |= 1 << 3;
     }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_START)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[11] |= 1 << 5;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_UP)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[11] |= 1 << 4;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_DOWN)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[11] |= 1 << 3;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_LEFT)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[11] |= 1 << 2;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_RIGHT)) == Buttons::BUTTON_PRESSED) {
+        STATUS_BUFFER[11] |= 1 << 1;
+    }
+}
 
-    // DanceDanceRevolution
-    if (avs::game::is_model("MDX")) {
+// DANCERUSH
+template<>
+void ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("REC")>() {
 
-        // clear buffer
-        memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
-        STATUS_BUFFER[0] = 1;
+    // clear buffer
+    memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
+    STATUS_BUFFER[0] = 1;
 
-        // get buttons
-        auto &buttons = games::ddr::get_buttons();
+    // get buttons
+    auto &buttons = games::drs::get_buttons();
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::COIN_MECH)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[2] |= 1 << 1;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::SERVICE)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[2] |= 1 << 2;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::TEST)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[2] |= 1 << 3;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_START)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[10] |= 1 << 7;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_UP)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[10] |= 1 << 6;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_DOWN)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[10] |= 1 << 5;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_LEFT)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[10] |= 1 << 4;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P1_MENU_RIGHT)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[10] |= 1 << 3;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_START)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[11] |= 1 << 5;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_UP)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[11] |= 1 << 4;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_DOWN)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[11] |= 1 << 3;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_LEFT)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[11] |= 1 << 2;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::ddr::Buttons::P2_MENU_RIGHT)) == Buttons::BUTTON_PRESSED) {
-            STATUS_BUFFER[11] |= 1 << 1;
-        }
+    // test
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::Test)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 19);
     }
 
-    // DANCERUSH
-    if (avs::game::is_model("REC")) {
-
-        // clear buffer
-        memset(STATUS_BUFFER, 0, std::size(STATUS_BUFFER));
-        STATUS_BUFFER[0] = 1;
+    // service
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::Service)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 18);
+    }
 
-        // get buttons
-        auto &buttons = games::drs::get_buttons();
+    // coin
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::CoinMech)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 17);
+    }
 
-        // test
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::Test)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 19);
-        }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Start)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 87);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Up)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 86);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Down)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 85);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Left)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 84);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Right)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 83);
+    }
 
-        // service
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::Service)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 18);
-        }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Start)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 93);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Up)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 92);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Down)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 91);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Left)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 90);
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Right)) == Buttons::State::BUTTON_PRESSED) {
+        ARRAY_SETB(STATUS_BUFFER, 89);
+    }
+}
 
-        // coin
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::CoinMech)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 17);
-        }
+static bool __cdecl ac_io_bi2a_update_control_status_buffer() {
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Start)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 87);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Up)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 86);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Down)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 85);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Left)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 84);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P1_Right)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 83);
-        }
+    // check freeze
+    if (STATUS_BUFFER_FREEZE) {
+        return true;
+    }
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Start)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 93);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Up)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 92);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Down)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 91);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Left)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 90);
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::drs::Buttons::P2_Right)) == Buttons::State::BUTTON_PRESSED) {
-            ARRAY_SETB(STATUS_BUFFER, 89);
-        }
+    // game specific inputs
+    switch (avs::game::MODEL_ID) {
+        case avs::game::model_id("KFC"):
+            ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("KFC")>();
+            break;
+        case avs::game::model_id("MDX"):
+            ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("MDX")>();
+            break;
+        case avs::game::model_id("REC"):
+            ac_io_bi2a_update_control_status_buffer_game<avs::game::model_id("REC")>();
+            break;
+        default:
+            break;
     }
 
     return true;
@@ -688,85 +714,56 @@ static bool __cdecl ac_io_bi2a_control_tapeled_bright(size_t off1, size_t off2,
             games::ddr::DDR_TAPELEDS[device][led_index][1] = g;
             games::ddr::DDR_TAPELEDS[device][led_index][2] = b;
         }
+    }
+
+    return true;
+}
+
+static bool __cdecl ac_io_bi2a_tapeled_send() {
+
+    if (!tapeledutils::is_enabled()) {
+        return true;
+    }
+
+    if (avs::game::is_model("MDX")) {
 
+        /*
+         * the tapes got set LED by LED into our buffers by now, one device per tape, so this is
+         * where the colors are picked, each tape as a whole
+         */
         static struct TapeLedMapping {
-            bool split; // true == 50 LEDs for one light, false == 25 for two lights
-            uint8_t index_r0, index_g0, index_b0;
-            uint8_t index_r1, index_g1, index_b1;
-            size_t index_for_avg0 = UINT8_MAX;
-            size_t index_for_avg1 = UINT8_MAX;
-
-            TapeLedMapping(
-                uint8_t index_r0, uint8_t index_g0, uint8_t index_b0,
-                uint8_t index_r1, uint8_t index_g1, uint8_t index_b1)
-                    : index_r0(index_r0), index_g0(index_g0), index_b0(index_b0),
-                      index_r1(index_r1), index_g1(index_g1), index_b1(index_b1) {
-
-                    split = (index_r1 != UINT8_MAX);
-                    if (split) {
-                        index_for_avg0 = tapeledutils::get_led_index_using_avg_algo(25);
-                        index_for_avg1 = index_for_avg0 + 25;
-                    } else {
-                        index_for_avg0 = tapeledutils::get_led_index_using_avg_algo(50);
-                        index_for_avg1 = -1;
-                    }
-                }
+            size_t device;
+            size_t led_count;
+            uint8_t index_r, index_g, index_b;
+            tapeledutils::tape_cache cache;
+
+            TapeLedMapping(size_t device, size_t led_count, uint8_t index_r, uint8_t index_g, uint8_t index_b)
+                : device(device), led_count(led_count), index_r(index_r), index_g(index_g), index_b(index_b) {}
 
         } mapping[] = {
-            {
-                games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_B,
-                games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_B
-            },
-            {
-                games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_B,
-                games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_B
-            },
-            {
-                games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_B,
-                games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_B
-            },
-            {
-                games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_B,
-                games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_B
-            },
-            {
-                games::ddr::Lights::GOLD_TOP_PANEL_AVG_R, games::ddr::Lights::GOLD_TOP_PANEL_AVG_G, games::ddr::Lights::GOLD_TOP_PANEL_AVG_B,
-                UINT8_MAX, UINT8_MAX, UINT8_MAX
-            },
-            {
-                UINT8_MAX, UINT8_MAX, UINT8_MAX,
-                UINT8_MAX, UINT8_MAX, UINT8_MAX
-            },
-            {
-                games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_R, games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_G, games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_B,
-                UINT8_MAX, UINT8_MAX, UINT8_MAX
-            },
-            {
-                games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_R, games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_G, games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_B,
-                UINT8_MAX, UINT8_MAX, UINT8_MAX
-            },
+            { 0, 25, games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_UP_AVG_B },
+            { 1, 25, games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_RIGHT_AVG_B },
+            { 2, 25, games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_LEFT_AVG_B },
+            { 3, 25, games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_R, games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_G, games::ddr::Lights::GOLD_P1_FOOT_DOWN_AVG_B },
+            { 4, 25, games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_UP_AVG_B },
+            { 5, 25, games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_RIGHT_AVG_B },
+            { 6, 25, games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_LEFT_AVG_B },
+            { 7, 25, games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_R, games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_G, games::ddr::Lights::GOLD_P2_FOOT_DOWN_AVG_B },
+            { 8, 50, games::ddr::Lights::GOLD_TOP_PANEL_AVG_R, games::ddr::Lights::GOLD_TOP_PANEL_AVG_G, games::ddr::Lights::GOLD_TOP_PANEL_AVG_B },
+            { 9, 50, games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_R, games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_G, games::ddr::Lights::GOLD_MONITOR_SIDE_LEFT_AVG_B },
+            { 10, 50, games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_R, games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_G, games::ddr::Lights::GOLD_MONITOR_SIDE_RIGHT_AVG_B },
         };
 
-        if (off1 < std::size(mapping)) {
-            auto &map = mapping[off1];
-            
-            size_t off2_match = -1;
-            if (!map.split || off2 < 25) {
-                off2_match = map.index_for_avg0;
-            } else {
-                off2_match = map.index_for_avg1;
-            }
-            if (off2_match == off2 && map.index_r0 != UINT8_MAX) {
-                auto &lights = games::ddr::get_lights();
-                if (!map.split || off2 < 25) {
-                    Lights::writeLight(RI_MGR, lights[map.index_r0], r / 255.f);
-                    Lights::writeLight(RI_MGR, lights[map.index_g0], g / 255.f);
-                    Lights::writeLight(RI_MGR, lights[map.index_b0], b / 255.f);
-                } else {
-                    Lights::writeLight(RI_MGR, lights[map.index_r1], r / 255.f);
-                    Lights::writeLight(RI_MGR, lights[map.index_g1], g / 255.f);
-                    Lights::writeLight(RI_MGR, lights[map.index_b1], b / 255.f);
-                }
+        auto &lights = games::ddr::get_lights();
+        for (auto &map : mapping) {
+
+            // only tapes that changed since the last send get a new color
+            tapeledutils::rgb_float3_t rgb;
+            const auto data = &games::ddr::DDR_TAPELEDS[map.device][0][0];
+            if (tapeledutils::update_led_tape(map.cache, data, map.led_count, 0, rgb)) {
+                Lights::writeLight(RI_MGR, lights[map.index_r], rgb.r);
+                Lights::writeLight(RI_MGR, lights[map.index_g], rgb.g);
+                Lights::writeLight(RI_MGR, lights[map.index_b], rgb.b);
             }
         }
     }
@@ -774,10 +771,6 @@ static bool __cdecl ac_io_bi2a_control_tapeled_bright(size_t off1, size_t off2,
     return true;
 }
 
-static bool __cdecl ac_io_bi2a_tapeled_send() {
-    return true;
-}
-
 static int __cdecl ac_io_bi2a_get_exbio2_status(uint8_t *info) {
     // surely this meme never gets old
     info[5] = 5;
@@ -301,165 +301,198 @@ static char __cdecl ac_io_kfca_unlock_coincounter(int a1) {
     return 1;
 }
 
-static char __cdecl ac_io_kfca_update_control_status_buffer() {
-    static const int input_offset = 4;
+/*
+ * status buffer update, specialized per game so the poll path does not test the model
+ */
 
-    // check freeze
-    if (STATUS_BUFFER_FREEZE) {
-        return true;
-    }
+template<uint32_t Model>
+static void ac_io_kfca_update_control_status_buffer_game() {
+}
 
-    // clear buffer
-    memset(STATUS_BUFFER, 0, 64);
+// SDVX
+template<>
+void ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("KFC")>() {
+    static const int input_offset = 4;
 
-    // SDVX
-    if (avs::game::is_model("KFC")) {
+    // get buttons
+    auto &buttons = games::sdvx::get_buttons();
 
-        // get buttons
-        auto &buttons = games::sdvx::get_buttons();
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Test))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x20;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Service))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x10;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::CoinMech))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x04;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Start))) {
+        STATUS_BUFFER[input_offset + 9] |= 0x08;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_A))) {
+        STATUS_BUFFER[input_offset + 9] |= 0x04;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_B))) {
+        STATUS_BUFFER[input_offset + 9] |= 0x02;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_C))) {
+        STATUS_BUFFER[input_offset + 9] |= 0x01;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_D))) {
+        STATUS_BUFFER[input_offset + 11] |= 0x20;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_L))) {
+        STATUS_BUFFER[input_offset + 11] |= 0x10;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_R))) {
+        STATUS_BUFFER[input_offset + 11] |= 0x08;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Headphone))) {
+        STATUS_BUFFER[input_offset + 9] |= 0x20;
+    }
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Test))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Service))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::CoinMech))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x04;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Start))) {
-            STATUS_BUFFER[input_offset + 9] |= 0x08;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_A))) {
-            STATUS_BUFFER[input_offset + 9] |= 0x04;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_B))) {
-            STATUS_BUFFER[input_offset + 9] |= 0x02;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_C))) {
-            STATUS_BUFFER[input_offset + 9] |= 0x01;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::BT_D))) {
-            STATUS_BUFFER[input_offset + 11] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_L))) {
-            STATUS_BUFFER[input_offset + 11] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::FX_R))) {
-            STATUS_BUFFER[input_offset + 11] |= 0x08;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::Headphone))) {
-            STATUS_BUFFER[input_offset + 9] |= 0x20;
-        }
+    // volume left
+    const auto now = get_performance_milliseconds();
+    const auto vol_l_state = socd::socd_clean(0,
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Left)),
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Right)),
+        now);
+    if (vol_l_state == socd::SocdCCW) {
+        KFCA_VOLL = (KFCA_VOLL - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    } else if (vol_l_state == socd::SocdCW) {
+        KFCA_VOLL = (KFCA_VOLL + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    }
 
-        // volume left
-        const auto now = get_performance_milliseconds();
-        const auto vol_l_state = socd::socd_clean(0,
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Left)),
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_L_Right)),
-            now);
-        if (vol_l_state == socd::SocdCCW) {
-            KFCA_VOLL = (KFCA_VOLL - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        } else if (vol_l_state == socd::SocdCW) {
-            KFCA_VOLL = (KFCA_VOLL + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        }
+    // volume right
+    const auto vol_r_state = socd::socd_clean(1,
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Left)),
+        Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Right)),
+        now);
+    if (vol_r_state == socd::SocdCCW) {
+        KFCA_VOLR = (KFCA_VOLR - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    } else if (vol_r_state == socd::SocdCW) {
+        KFCA_VOLR = (KFCA_VOLR + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
+    }
 
-        // volume right
-        const auto vol_r_state = socd::socd_clean(1,
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Left)),
-            Buttons::getState(RI_MGR, buttons.at(games::sdvx::Buttons::VOL_R_Right)),
-            now);
-        if (vol_r_state == socd::SocdCCW) {
-            KFCA_VOLR = (KFCA_VOLR - games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        } else if (vol_r_state == socd::SocdCW) {
-            KFCA_VOLR = (KFCA_VOLR + games::sdvx::DIGITAL_KNOB_SENS) & 1023;
-        }
+    // update volumes
+    auto &analogs = games::sdvx::get_analogs();
+    auto vol_left = KFCA_VOLL;
+    auto vol_right = KFCA_VOLR;
+    if (analogs.at(0).isSet() || analogs.at(1).isSet()) {
+        vol_left += (unsigned int) (Analogs::getState(RI_MGR,
+                                                      analogs.at(games::sdvx::Analogs::VOL_L)) * 1023.99f);
+        vol_right += (unsigned int) (Analogs::getState(RI_MGR,
+                                                       analogs.at(games::sdvx::Analogs::VOL_R)) * 1023.99f);
+    }
 
-        // update volumes
-        auto &analogs = games::sdvx::get_analogs();
-        auto vol_left = KFCA_VOLL;
-        auto vol_right = KFCA_VOLR;
-        if (analogs.at(0).isSet() || analogs.at(1).isSet()) {
-            vol_left += (unsigned int) (Analogs::getState(RI_MGR,
-                                                          analogs.at(games::sdvx::Analogs::VOL_L)) * 1023.99f);
-            vol_right += (unsigned int) (Analogs::getState(RI_MGR,
-                                                           analogs.at(games::sdvx::Analogs::VOL_R)) * 1023.99f);
-        }
+    // proper loops
+    vol_left %= 1024;
+    vol_right %= 1024;
+    
+    log_debug("kfca", "knobs = {} {}", vol_left, vol_right);
+
+    // save volumes in buffer
+    STATUS_BUFFER[input_offset + 16 + 0] |= (unsigned char) ((vol_left << 6) & 0xFF);
+    STATUS_BUFFER[input_offset + 16 + 1] |= (unsigned char) ((vol_left >> 2) & 0xFF);
+    STATUS_BUFFER[input_offset + 16 + 2] |= (unsigned char) ((vol_right << 6) & 0xFF);
+    STATUS_BUFFER[input_offset + 16 + 3] |= (unsigned char) ((vol_right >> 2) & 0xFF);
+}
 
-        // proper loops
-        vol_left %= 1024;
-        vol_right %= 1024;
-        
-        log_debug("kfca", "knobs = {} {}", vol_left, vol_right);
+// Beatstream
+template<>
+void ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("NBT")>() {
+    static const int input_offset = 4;
+
+    // get buttons
+    auto &buttons = games::bs::get_buttons();
 
-        // save volumes in buffer
-        STATUS_BUFFER[input_offset + 16 + 0] |= (unsigned char) ((vol_left << 6) & 0xFF);
-        STATUS_BUFFER[input_offset + 16 + 1] |= (unsigned char) ((vol_left >> 2) & 0xFF);
-        STATUS_BUFFER[input_offset + 16 + 2] |= (unsigned char) ((vol_right << 6) & 0xFF);
-        STATUS_BUFFER[input_offset + 16 + 3] |= (unsigned char) ((vol_right >> 2) & 0xFF);
+    if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::Test))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x20;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::Service))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x10;
     }
+    if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::CoinMech))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x04;
+    }
+}
 
-    // Beatstream
-    if (avs::game::is_model("NBT")) {
+// Nostalgia
+template<>
+void ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("PAN")>() {
+    static const int input_offset = 4;
 
-        // get buttons
-        auto &buttons = games::bs::get_buttons();
+    // get buttons
+    auto &buttons = games::nost::get_buttons();
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::Test))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::Service))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::bs::Buttons::CoinMech))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x04;
-        }
+    if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::Service))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x10;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::Test))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x20;
     }
+    if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::CoinMech))) {
+        STATUS_BUFFER[input_offset + 1] |= 0x04;
+    }
+}
 
-    // Nostalgia
-    if (avs::game::is_model("PAN")) {
+// Scotto
+template<>
+void ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("NSC")>() {
+    static const int input_offset = 4;
 
-        // get buttons
-        auto &buttons = games::nost::get_buttons();
+    // get buttons
+    auto &buttons = games::scotto::get_buttons();
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::Service))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::Test))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::nost::Buttons::CoinMech))) {
-            STATUS_BUFFER[input_offset + 1] |= 0x04;
-        }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Test)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 1] |= 0x20;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Service)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 1] |= 0x10;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::CoinMech)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 1] |= 0x04;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Start)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 9] |= 0x20;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Up)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 9] |= 0x10;
+    }
+    if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Down)) == Buttons::State::BUTTON_PRESSED) {
+        STATUS_BUFFER[input_offset + 9] |= 0x08;
     }
 
-    // Scotto
-    if (avs::game::is_model("NSC")) {
+    // the code also checks `input_offset + 9` for 0x01 but that does not trigger any response
+    // in the "I/O CHECK" scene
+}
 
-        // get buttons
-        auto &buttons = games::scotto::get_buttons();
+static char __cdecl ac_io_kfca_update_control_status_buffer() {
 
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Test)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 1] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Service)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 1] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::CoinMech)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 1] |= 0x04;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Start)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 9] |= 0x20;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Up)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 9] |= 0x10;
-        }
-        if (Buttons::getState(RI_MGR, buttons.at(games::scotto::Buttons::Down)) == Buttons::State::BUTTON_PRESSED) {
-            STATUS_BUFFER[input_offset + 9] |= 0x08;
-        }
+    // check freeze
+    if (STATUS_BUFFER_FREEZE) {
+        return true;
+    }
+
+    // clear buffer
+    memset(STATUS_BUFFER, 0, 64);
 
-        // the code also checks `input_offset + 9` for 0x01 but that does not trigger any response
-        // in the "I/O CHECK" scene
+    // game specific inputs
+    switch (avs::game::MODEL_ID) {
+        case avs::game::model_id("KFC"):
+            ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("KFC")>();
+            break;
+        case avs::game::model_id("NBT"):
+            ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("NBT")>();
+            break;
+        case avs::game::model_id("PAN"):
+            ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("PAN")>();
+            break;
+        case avs::game::model_id("NSC"):
+            ac_io_kfca_update_control_status_buffer_game<avs::game::model_id("NSC")>();
+            break;
+        default:
+            break;
     }
 
     // success
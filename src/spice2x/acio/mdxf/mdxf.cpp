@@ -204,280 +204,328 @@ static void count_calls_from_game() {
  * Implementations
  */
 
-static uint64_t __cdecl ac_io_mdxf_get_control_status_buffer(int node, void *out, uint8_t index, uint8_t head_in) {
+/*
+ * the hooks are specialized per game so the poll path does not test the model
+ */
+
+// default error value (matches original mask behavior)
+static uint64_t ac_io_mdxf_error_value(int node) {
+    return static_cast<uint64_t>(node - 0x11) & 0xFFFFFFFFFFFFFF00;
+}
+
+template<uint32_t Model>
+static uint64_t ac_io_mdxf_get_control_status_buffer_game(int node, void *out, uint8_t index, uint8_t head_in) {
+    return ac_io_mdxf_error_value(node);
+}
 
-    // Default error value (matches original mask behavior)
-    auto error_ret = static_cast<uint64_t>(node - 0x11) & 0xFFFFFFFFFFFFFF00;
+// Dance Dance Revolution
+template<>
+uint64_t ac_io_mdxf_get_control_status_buffer_game<avs::game::model_id("MDX")>(
+        int node, void *out, uint8_t index, uint8_t head_in) {
+    // Select player-specific state
+    std::mutex* mutex = nullptr;
+    uint8_t* head = nullptr;
+    uint8_t (*buffer)[STATUS_BUFFER_SIZE];
+    size_t size = STATUS_BUFFER_NUM_ENTRIES;
     
-    // Dance Dance Revolution
-    if (avs::game::is_model("MDX")) {
-        // Select player-specific state
-        std::mutex* mutex = nullptr;
-        uint8_t* head = nullptr;
-        uint8_t (*buffer)[STATUS_BUFFER_SIZE];
-        size_t size = STATUS_BUFFER_NUM_ENTRIES;
-        
-        if (node == 17 || node == 25) {
-            mutex = &MUTEX_P1;
-            head = &HEAD_P1;
-            buffer = BUFFERS.STATUS_BUFFER_P1;
-        } else if (node == 18 || node == 26) {
-            mutex = &MUTEX_P2;
-            head = &HEAD_P2;
-            buffer = BUFFERS.STATUS_BUFFER_P2;
-        } else {
-            memset(out, 0, STATUS_BUFFER_SIZE);
-            return error_ret;
-        }
-        
-        std::lock_guard<std::mutex> lock(*mutex);
-        
-        const uint8_t start_index = (head_in == 0xFF) ? *head : head_in;
+    if (node == 17 || node == 25) {
+        mutex = &MUTEX_P1;
+        head = &HEAD_P1;
+        buffer = BUFFERS.STATUS_BUFFER_P1;
+    } else if (node == 18 || node == 26) {
+        mutex = &MUTEX_P2;
+        head = &HEAD_P2;
+        buffer = BUFFERS.STATUS_BUFFER_P2;
+    } else {
+        memset(out, 0, STATUS_BUFFER_SIZE);
+        return ac_io_mdxf_error_value(node);
+    }
+    
+    std::lock_guard<std::mutex> lock(*mutex);
+    
+    const uint8_t start_index = (head_in == 0xFF) ? *head : head_in;
 
-        // Compute ring index: walk backwards from start_index as index increases
-        // Assumes ring buffer size is a power of two
-        const size_t mask = size - 1;
-        const size_t offset = static_cast<size_t>(index) & mask;
-        const size_t i = (static_cast<size_t>(start_index) - offset + size) & mask;
+    // Compute ring index: walk backwards from start_index as index increases
+    // Assumes ring buffer size is a power of two
+    const size_t mask = size - 1;
+    const size_t offset = static_cast<size_t>(index) & mask;
+    const size_t i = (static_cast<size_t>(start_index) - offset + size) & mask;
 
-        // Copy the chosen entry
-        memcpy(out, buffer[i], STATUS_BUFFER_SIZE);
+    // Copy the chosen entry
+    memcpy(out, buffer[i], STATUS_BUFFER_SIZE);
 
-        // Return the start value actually used
-        return static_cast<uint64_t>(start_index);
-    }
+    // Return the start value actually used
+    return static_cast<uint64_t>(start_index);
+}
 
-    return error_ret;
+template<uint32_t Model>
+static void ac_io_mdxf_set_output_level_game(unsigned int a1, unsigned int a2, uint8_t value) {
 }
 
-static bool __cdecl ac_io_mdxf_set_output_level(unsigned int a1, unsigned int a2, uint8_t value) {
-    if (avs::game::is_model("MDX")) {
-        static const struct {
-            int a2[4];
-        } mapping[] = {
+// Dance Dance Revolution
+template<>
+void ac_io_mdxf_set_output_level_game<avs::game::model_id("MDX")>(unsigned int a1, unsigned int a2, uint8_t value) {
+    static const struct {
+        int a2[4];
+    } mapping[] = {
+        {
+            // a1 == 17
             {
-                // a1 == 17
-                {
-                    games::ddr::Lights::GOLD_P1_STAGE_UP_RIGHT,
-                    games::ddr::Lights::GOLD_P1_STAGE_DOWN_LEFT,
-                    games::ddr::Lights::GOLD_P1_STAGE_UP_LEFT,
-                    games::ddr::Lights::GOLD_P1_STAGE_DOWN_RIGHT
-                }
-            },
+                games::ddr::Lights::GOLD_P1_STAGE_UP_RIGHT,
+                games::ddr::Lights::GOLD_P1_STAGE_DOWN_LEFT,
+                games::ddr::Lights::GOLD_P1_STAGE_UP_LEFT,
+                games::ddr::Lights::GOLD_P1_STAGE_DOWN_RIGHT
+            }
+        },
+        {
+            // a1 == 18
             {
-                // a1 == 18
-                {
-                    games::ddr::Lights::GOLD_P2_STAGE_UP_RIGHT,
-                    games::ddr::Lights::GOLD_P2_STAGE_DOWN_LEFT,
-                    games::ddr::Lights::GOLD_P2_STAGE_UP_LEFT,
-                    games::ddr::Lights::GOLD_P2_STAGE_DOWN_RIGHT
-                }
+                games::ddr::Lights::GOLD_P2_STAGE_UP_RIGHT,
+                games::ddr::Lights::GOLD_P2_STAGE_DOWN_LEFT,
+                games::ddr::Lights::GOLD_P2_STAGE_UP_LEFT,
+                games::ddr::Lights::GOLD_P2_STAGE_DOWN_RIGHT
             }
-        };
-        if ((a1 == 17 || a1 == 18) && (a2 < 4)) {
-            // get light from mapping
-            const auto light = mapping[a1 - 17].a2[a2];
+        }
+    };
+    if ((a1 == 17 || a1 == 18) && (a2 < 4)) {
+        // get light from mapping
+        const auto light = mapping[a1 - 17].a2[a2];
 
-            // get lights
-            auto &lights = games::ddr::get_lights();
+        // get lights
+        auto &lights = games::ddr::get_lights();
 
-            // write lights
-            GameAPI::Lights::writeLight(RI_MGR, lights[light], value / 128.f);
-        }
+        // write lights
+        GameAPI::Lights::writeLight(RI_MGR, lights[light], value / 128.f);
     }
-    
-    return true;
 }
 
-static bool __cdecl ac_io_mdxf_update_control_status_buffer_impl(int node, MDXFPollSource source, uint64_t current_time) {
-
-    // check freeze
-    if (STATUS_BUFFER_FREEZE) {
-        return true;
-    }
+template<uint32_t Model>
+static bool ac_io_mdxf_update_control_status_buffer_game(int node, MDXFPollSource source, uint64_t current_time) {
+    return true;
+}
 
-    // Dance Dance Revolution
-    if (avs::game::is_model("MDX")) {
-        // Marks this module as actively being used, allowing this function to be called from other sources
-        if (source == ARKMDXP4_POLL) {
-            if (!IS_MDXF_ACTIVE) {
-                log_debug("mdxf", "initializing mdxf I/O support");
-                IS_MDXF_ACTIVE = true;
-                if (acio::MDXF_BUFFER_FILL_MODE == acio::MDXFBufferFillMode::THREAD_MODE) {
-                    IS_THREAD_NEEDED = true;
-                    mdxf_thread_start();
-                }
-            }
-            if (acio::MDXF_BUFFER_FILL_MODE == acio::MDXFBufferFillMode::AUTO_MODE) {
-                count_calls_from_game();
+// Dance Dance Revolution
+template<>
+bool ac_io_mdxf_update_control_status_buffer_game<avs::game::model_id("MDX")>(
+        int node, MDXFPollSource source, uint64_t current_time) {
+    // Marks this module as actively being used, allowing this function to be called from other sources
+    if (source == ARKMDXP4_POLL) {
+        if (!IS_MDXF_ACTIVE) {
+            log_debug("mdxf", "initializing mdxf I/O support");
+            IS_MDXF_ACTIVE = true;
+            if (acio::MDXF_BUFFER_FILL_MODE == acio::MDXFBufferFillMode::THREAD_MODE) {
+                IS_THREAD_NEEDED = true;
+                mdxf_thread_start();
             }
         }
-        
-        uint8_t (*buffer)[STATUS_BUFFER_SIZE];
-        uint8_t *head = nullptr;
-        uint16_t *prev_state = nullptr;
-        uint64_t *prev_time = nullptr;
-        std::mutex* mutex = nullptr;
-        
-        switch (node) {
-            case 17:
-            case 25:
-                mutex = &MUTEX_P1;
-                head = &HEAD_P1;
-                prev_state = &PREV_STATE_P1;
-                prev_time = &PREV_TIME_P1;
-                buffer = BUFFERS.STATUS_BUFFER_P1;
-                break;
-            case 18:
-            case 26:
-                mutex = &MUTEX_P2;
-                head = &HEAD_P2;
-                prev_state = &PREV_STATE_P2;
-                prev_time = &PREV_TIME_P2;
-                buffer = BUFFERS.STATUS_BUFFER_P2;
-                break;
-            default:
-                // return failure on unknown node
-                return false;
+        if (acio::MDXF_BUFFER_FILL_MODE == acio::MDXFBufferFillMode::AUTO_MODE) {
+            count_calls_from_game();
         }
+    }
     
-        // Sensor Map (LDUR):
-        // FOOT DOWN = bit 32-35 = byte 4, bit 0-3
-        // FOOT UP = bit 36-39 = byte 4, bit 4-7
-        // FOOT RIGHT = bit 40-43 = byte 5, bit 0-3
-        // FOOT LEFT = bit 44-47 = byte 5, bit 4-7
-        static const size_t buttons_p1[] = {
-                games::ddr::Buttons::P1_PANEL_UP,
-                games::ddr::Buttons::P1_PANEL_DOWN,
-                games::ddr::Buttons::P1_PANEL_LEFT,
-                games::ddr::Buttons::P1_PANEL_RIGHT,
-        };
-        static const size_t buttons_p2[] = {
-                games::ddr::Buttons::P2_PANEL_UP,
-                games::ddr::Buttons::P2_PANEL_DOWN,
-                games::ddr::Buttons::P2_PANEL_LEFT,
-                games::ddr::Buttons::P2_PANEL_RIGHT,
-        };
-
-        // decide on button map
-        const size_t *button_map = nullptr;
-        int player = 0;
-        switch (node) {
-            case 17:
-            case 25:
-                button_map = &buttons_p1[0];
-                player = 1;
-                break;
-            case 18:
-            case 26:
-                button_map = &buttons_p2[0];
-                player = 2;
-                break;
-        }
-        
-        uint16_t current_state;
-        
-        // Only call getState() if called externally when actual input events happen, otherwise use previous known state
-        if (source == EXTERNAL_POLL) {
-            // get buttons
-            auto &buttons = games::ddr::get_buttons();
-            
-            // get analogs
-            bool analog_left = false;
-            bool analog_right = false;
-            games::ddr::get_analog_x_axis(player, analog_left, analog_right);
-            bool analog_up = false;
-            bool analog_down = false;
-            games::ddr::get_analog_y_axis(player, analog_up, analog_down);
-            
-            uint8_t up_down = 0;
-            uint8_t left_right = 0;
-            if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[0])) || analog_up) {
-                up_down |= 0xF0;
-            }
-            if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[1])) || analog_down) {
-                up_down |= 0x0F;
-            }
-            if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[2])) || analog_left) {
-                left_right |= 0xF0;
-            }
-            if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[3])) || analog_right) {
-                left_right |= 0x0F;
-            }
-            current_state = (uint16_t(up_down) << 8) | left_right;
-        } else {
-            current_state = *prev_state;
-        }
-        
-        std::lock_guard<std::mutex> lock(*mutex);
+    uint8_t (*buffer)[STATUS_BUFFER_SIZE];
+    uint8_t *head = nullptr;
+    uint16_t *prev_state = nullptr;
+    uint64_t *prev_time = nullptr;
+    std::mutex* mutex = nullptr;
+    
+    switch (node) {
+        case 17:
+        case 25:
+            mutex = &MUTEX_P1;
+            head = &HEAD_P1;
+            prev_state = &PREV_STATE_P1;
+            prev_time = &PREV_TIME_P1;
+            buffer = BUFFERS.STATUS_BUFFER_P1;
+            break;
+        case 18:
+        case 26:
+            mutex = &MUTEX_P2;
+            head = &HEAD_P2;
+            prev_state = &PREV_STATE_P2;
+            prev_time = &PREV_TIME_P2;
+            buffer = BUFFERS.STATUS_BUFFER_P2;
+            break;
+        default:
+            // return failure on unknown node
+            return false;
+    }
+
+    // Sensor Map (LDUR):
+    // FOOT DOWN = bit 32-35 = byte 4, bit 0-3
+    // FOOT UP = bit 36-39 = byte 4, bit 4-7
+    // FOOT RIGHT = bit 40-43 = byte 5, bit 0-3
+    // FOOT LEFT = bit 44-47 = byte 5, bit 4-7
+    static const size_t buttons_p1[] = {
+            games::ddr::Buttons::P1_PANEL_UP,
+            games::ddr::Buttons::P1_PANEL_DOWN,
+            games::ddr::Buttons::P1_PANEL_LEFT,
+            games::ddr::Buttons::P1_PANEL_RIGHT,
+    };
+    static const size_t buttons_p2[] = {
+            games::ddr::Buttons::P2_PANEL_UP,
+            games::ddr::Buttons::P2_PANEL_DOWN,
+            games::ddr::Buttons::P2_PANEL_LEFT,
+            games::ddr::Buttons::P2_PANEL_RIGHT,
+    };
+
+    // decide on button map
+    const size_t *button_map = nullptr;
+    int player = 0;
+    switch (node) {
+        case 17:
+        case 25:
+            button_map = &buttons_p1[0];
+            player = 1;
+            break;
+        case 18:
+        case 26:
+            button_map = &buttons_p2[0];
+            player = 2;
+            break;
+    }
+    
+    uint16_t current_state;
+    
+    // Only call getState() if called externally when actual input events happen, otherwise use previous known state
+    if (source == EXTERNAL_POLL) {
+        // get buttons
+        auto &buttons = games::ddr::get_buttons();
         
-        const bool has_state_changed = *prev_state != current_state;
-        const bool has_time_changed = *prev_time < current_time;
+        // get analogs
+        bool analog_left = false;
+        bool analog_right = false;
+        games::ddr::get_analog_x_axis(player, analog_left, analog_right);
+        bool analog_up = false;
+        bool analog_down = false;
+        games::ddr::get_analog_y_axis(player, analog_up, analog_down);
         
-        // If state hasn't changed and either the update was triggered externally or the time hasn't changed, then don't advance head pointer or write a new entry
-        if (!has_state_changed && (source == EXTERNAL_POLL || !has_time_changed)) {
-            return true;
+        uint8_t up_down = 0;
+        uint8_t left_right = 0;
+        if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[0])) || analog_up) {
+            up_down |= 0xF0;
         }
-        
-        // The start and stop time cutoffs for backfilling entries. Min(..) ensures times aren't negative.
-        // The stop time is just before the current_time, set by BACKFILL_PADDING_MS, which avoids the last backfilled entry being too close to current_time.
-        uint64_t start_time = *prev_time;
-        const uint64_t stop_time = current_time - std::min<uint64_t>(current_time, BACKFILL_PADDING_MS);
-        
-        // Ensures the first iteration will write the first entry at current_time and not backfill to time 0ms.
-        if (start_time == 0) {
-            start_time = current_time - std::min<uint64_t>(current_time, BACKFILL_INTERVAL_MS);
+        if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[1])) || analog_down) {
+            up_down |= 0x0F;
         }
-        
-        // Ensures only STATUS_BUFFER_NUM_ENTRIES entries at most are backfilled
-        const uint64_t max_backfill = BACKFILL_INTERVAL_MS * STATUS_BUFFER_NUM_ENTRIES;
-        const uint64_t min_time = current_time - std::min<uint64_t>(current_time, max_backfill);
-        if (start_time < min_time) {
-            start_time = min_time;
+        if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[2])) || analog_left) {
+            left_right |= 0xF0;
         }
-        
-        // Don't backfill entries if called externally or if a separate thread is being used to fill auxiliary entries
-        if (source == EXTERNAL_POLL || IS_THREAD_NEEDED) {
-            start_time = stop_time - 1;
+        if (GameAPI::Buttons::getState(RI_MGR, buttons.at(button_map[3])) || analog_right) {
+            left_right |= 0x0F;
         }
+        current_state = (uint16_t(up_down) << 8) | left_right;
+    } else {
+        current_state = *prev_state;
+    }
+    
+    std::lock_guard<std::mutex> lock(*mutex);
+    
+    const bool has_state_changed = *prev_state != current_state;
+    const bool has_time_changed = *prev_time < current_time;
+    
+    // If state hasn't changed and either the update was triggered externally or the time hasn't changed, then don't advance head pointer or write a new entry
+    if (!has_state_changed && (source == EXTERNAL_POLL || !has_time_changed)) {
+        return true;
+    }
+    
+    // The start and stop time cutoffs for backfilling entries. Min(..) ensures times aren't negative.
+    // The stop time is just before the current_time, set by BACKFILL_PADDING_MS, which avoids the last backfilled entry being too close to current_time.
+    uint64_t start_time = *prev_time;
+    const uint64_t stop_time = current_time - std::min<uint64_t>(current_time, BACKFILL_PADDING_MS);
+    
+    // Ensures the first iteration will write the first entry at current_time and not backfill to time 0ms.
+    if (start_time == 0) {
+        start_time = current_time - std::min<uint64_t>(current_time, BACKFILL_INTERVAL_MS);
+    }
+    
+    // Ensures only STATUS_BUFFER_NUM_ENTRIES entries at most are backfilled
+    const uint64_t max_backfill = BACKFILL_INTERVAL_MS * STATUS_BUFFER_NUM_ENTRIES;
+    const uint64_t min_time = current_time - std::min<uint64_t>(current_time, max_backfill);
+    if (start_time < min_time) {
+        start_time = min_time;
+    }
+    
+    // Don't backfill entries if called externally or if a separate thread is being used to fill auxiliary entries
+    if (source == EXTERNAL_POLL || IS_THREAD_NEEDED) {
+        start_time = stop_time - 1;
+    }
+    
+    uint64_t time = start_time;
+    uint16_t state = *prev_state;
+    
+    // Backfill entries a fixed interval apart from each other between prev_time and current_time
+    while (time < stop_time) {
+        // Advance head pointer
+        *head = (*head + 1) % STATUS_BUFFER_NUM_ENTRIES;
+        uint8_t* buffer_entry = buffer[*head];
+
+        // Clear buffer
+        memset(buffer_entry, 0, STATUS_BUFFER_SIZE);
         
-        uint64_t time = start_time;
-        uint16_t state = *prev_state;
+        time += BACKFILL_INTERVAL_MS;
         
-        // Backfill entries a fixed interval apart from each other between prev_time and current_time
-        while (time < stop_time) {
-            // Advance head pointer
-            *head = (*head + 1) % STATUS_BUFFER_NUM_ENTRIES;
-            uint8_t* buffer_entry = buffer[*head];
-
-            // Clear buffer
-            memset(buffer_entry, 0, STATUS_BUFFER_SIZE);
-            
-            time += BACKFILL_INTERVAL_MS;
-            
-            // If the stop time is reached, then write current_time and current_state instead for this final iteration
-            const bool isEdge = (time >= stop_time);
-            if (isEdge) {
-                state = current_state;
-                time = current_time;
-            }
-            
-            // Write button state
-            buffer_entry[4] = (state >> 8) & 0xFF;
-            buffer_entry[5] = state & 0xFF;
-            
-            // Write game time
-            *(uint64_t*)&buffer_entry[0x18] = time;
+        // If the stop time is reached, then write current_time and current_state instead for this final iteration
+        const bool isEdge = (time >= stop_time);
+        if (isEdge) {
+            state = current_state;
+            time = current_time;
         }
         
-        *prev_state = current_state;
-        *prev_time = current_time;
+        // Write button state
+        buffer_entry[4] = (state >> 8) & 0xFF;
+        buffer_entry[5] = state & 0xFF;
+        
+        // Write game time
+        *(uint64_t*)&buffer_entry[0x18] = time;
     }
+    
+    *prev_state = current_state;
+    *prev_time = current_time;
 
     // return success
     return true;
 }
 
+static uint64_t __cdecl ac_io_mdxf_get_control_status_buffer(int node, void *out, uint8_t index, uint8_t head_in) {
+    switch (avs::game::MODEL_ID) {
+        case avs::game::model_id("MDX"):
+            return ac_io_mdxf_get_control_status_buffer_game<avs::game::model_id("MDX")>(
+                    node, out, index, head_in);
+        default:
+            return ac_io_mdxf_error_value(node);
+    }
+}
+
+static bool __cdecl ac_io_mdxf_set_output_level(unsigned int a1, unsigned int a2, uint8_t value) {
+    switch (avs::game::MODEL_ID) {
+        case avs::game::model_id("MDX"):
+            ac_io_mdxf_set_output_level_game<avs::game::model_id("MDX")>(a1, a2, value);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+static bool __cdecl ac_io_mdxf_update_control_status_buffer_impl(int node, MDXFPollSource source, uint64_t current_time) {
+
+    // check freeze
+    if (STATUS_BUFFER_FREEZE) {
+        return true;
+    }
+
+    // game specific inputs
+    switch (avs::game::MODEL_ID) {
+        case avs::game::model_id("MDX"):
+            return ac_io_mdxf_update_control_status_buffer_game<avs::game::model_id("MDX")>(
+                    node, source, current_time);
+        default:
+            return true;
+    }
+}
+
 static bool __cdecl ac_io_mdxf_update_control_status_buffer(int node) {
     return ac_io_mdxf_update_control_status_buffer_impl(node, ARKMDXP4_POLL, arkGetTickTime64());
 }
@@ -28,6 +28,16 @@ namespace api::modules {
     static std::mutex FRAME_CACHE_M;
     static std::unordered_map<int, CachedFrame> FRAME_CACHE;
 
+    // base64 straight into memory owned by the response document, which the value then
+    // references instead of copying; frames are several hundred kilobytes
+    static Value encode_jpeg(const std::vector<uint8_t> &jpeg, Response &res) {
+        const size_t length = crypt::base64_encoded_size(jpeg.size());
+        auto buffer = static_cast<char *>(res.doc()->GetAllocator().Malloc(length + 1));
+        crypt::base64_encode(jpeg.data(), jpeg.size(), buffer);
+        buffer[length] = '\0';
+        return Value(StringRef(buffer, static_cast<SizeType>(length)));
+    }
+
     static void add_jpeg_response(
             int screen,
             uint64_t timestamp,
@@ -36,10 +46,7 @@ namespace api::modules {
             const std::vector<uint8_t> &jpeg,
             Response &res) {
 
-        auto encoded = crypt::base64_encode(jpeg.data(), jpeg.size());
-
-        Value data;
-        data.SetString(encoded.c_str(), encoded.length(), res.doc()->GetAllocator());
+        Value data = encode_jpeg(jpeg, res);
         res.add_data(timestamp);
         res.add_data(width);
         res.add_data(height);
@@ -57,10 +64,7 @@ namespace api::modules {
         }
 
         const auto &cached = pos->second;
-        auto encoded = crypt::base64_encode(cached.jpeg.data(), cached.jpeg.size());
-
-        Value data;
-        data.SetString(encoded.c_str(), encoded.length(), res.doc()->GetAllocator());
+        Value data = encode_jpeg(cached.jpeg, res);
         res.add_data(cached.timestamp);
         res.add_data(cached.width);
         res.add_data(cached.height);
@@ -4,6 +4,7 @@
 #include "external/rapidjson/document.h"
 #include "avs/game.h"
 #include "avs/ea3.h"
+#include "hooks/audio/telemetry.h"
 #include "util/logging.h"
 #include "util/utils.h"
 #include "util/memutils.h"
@@ -19,6 +20,7 @@ namespace api::modules {
         functions["avs"] = std::bind(&Info::avs, this, _1, _2);
         functions["launcher"] = std::bind(&Info::launcher, this, _1, _2);
         functions["memory"] = std::bind(&Info::memory, this, _1, _2);
+        functions["audio"] = std::bind(&Info::audio, this, _1, _2);
     }
 
     /**
@@ -95,4 +97,46 @@ namespace api::modules {
         // add info object
         res.add_data(info);
     }
+
+    /**
+     * audio()
+     */
+    void Info::audio(Request &req, Response &res) {
+        namespace telemetry = hooks::audio::telemetry;
+
+        // get allocator
+        auto &alloc = res.doc()->GetAllocator();
+
+        // one object per monitored stream
+        for (size_t index = 0; index < telemetry::STREAM_COUNT; index++) {
+            const auto stream = static_cast<telemetry::Stream>(index);
+            const auto snap = telemetry::snapshot(stream);
+            if (!snap.active) {
+                continue;
+            }
+
+            Value fill(kArrayType);
+            for (auto count : snap.fill) {
+                fill.PushBack(count, alloc);
+            }
+
+            Value info(kObjectType);
+            info.AddMember("stream", StringRef(telemetry::stream_name(stream)), alloc);
+            info.AddMember("period_us", snap.period_us, alloc);
+            info.AddMember("capacity", snap.capacity_frames, alloc);
+            info.AddMember("callbacks", snap.callbacks, alloc);
+            info.AddMember("missed_deadlines", snap.missed_deadlines, alloc);
+            info.AddMember("underruns", snap.underruns, alloc);
+            info.AddMember("period_p50_us", snap.period_p50_us, alloc);
+            info.AddMember("period_p99_us", snap.period_p99_us, alloc);
+            info.AddMember("period_max_us", snap.period_max_us, alloc);
+            info.AddMember("processing_p50_us", snap.processing_p50_us, alloc);
+            info.AddMember("processing_p99_us", snap.processing_p99_us, alloc);
+            info.AddMember("processing_max_us", snap.processing_max_us, alloc);
+            info.AddMember("fill", fill, alloc);
+
+            // add info object
+            res.add_data(info);
+        }
+    }
 }
@@ -15,3 +15,8 @@ def info_launcher(con: Connection):
 def info_memory(con: Connection):
     res = con.request(Request("info", "memory"))
     return res.get_data()[0]
+
+
+def info_audio(con: Connection):
+    res = con.request(Request("info", "audio"))
+    return res.get_data()
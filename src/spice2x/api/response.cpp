@@ -47,5 +47,5 @@ std::string Response::get_string(bool pretty) {
         rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
         this->document.Accept(writer);
     }
-    return std::string(sb.GetString());
+    return std::string(sb.GetString(), sb.GetSize());
 }
@@ -1,10 +1,12 @@
 #include "controller.h"
 #include "serial.h"
+#include "serial_framer.h"
 
 #include <chrono>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "util/logging.h"
 #include "util/utils.h"
@@ -19,9 +21,24 @@ namespace api {
         this->thread = new std::thread([this] () {
             log_warning("api::serial", "listening on {} (baud: {})", this->port, this->baud);
 
-            // read buffer
-            uint8_t read_buffer[16*1024];
-            size_t read_buffer_len = 0;
+            // requests come in through the framer, plain answers of a batch go out together
+            SerialFramer framer;
+            std::vector<char> out;
+            std::vector<char> batch;
+            const auto write_batch = [this, &batch] () {
+                DWORD bytes_written = 0;
+                if (!batch.empty() && (!WriteFile(
+                        this->handle,
+                        batch.data(),
+                        (DWORD) batch.size(),
+                        &bytes_written,
+                        nullptr) || bytes_written != batch.size())) {
+                    return false;
+                }
+                //log_info("api::serial::out", "{}", bin2hex(batch));
+                batch.clear();
+                return true;
+            };
 
             // serial retry loop
             while (this->running) {
@@ -32,132 +49,97 @@ namespace api {
                 }
 
                 // reset in-buffer
-                read_buffer_len = 0;
+                framer.clear();
 
                 // connection loop
                 DWORD retry_time = 1000;
                 while (this->handle != INVALID_HANDLE_VALUE) {
                     retry_time = 1000;
-                    DWORD bytes_read = 0;
 
-                    // check if we need to wait for incoming data first
-                    bool messages_in_buffer = false;
-                    for (size_t i = 0; i < read_buffer_len; i++) {
-                        if (read_buffer[i] == 0x00) {
-                            messages_in_buffer = true;
-                            break;
-                        }
-                    }
-
-                    // read data
-                    if (!messages_in_buffer && (!ReadFile(
-                            this->handle,
-                            &read_buffer[read_buffer_len],
-                            sizeof(read_buffer) - read_buffer_len, &bytes_read,
-                            nullptr) || bytes_read == 0)) {
+                    // read data, whatever the port has right now
+                    DWORD bytes_read = 0;
+                    size_t buffer_size = 0;
+                    auto buffer = framer.receive_buffer(buffer_size);
+                    if (!ReadFile(this->handle, buffer, (DWORD) buffer_size, &bytes_read, nullptr)
+                            || bytes_read == 0) {
 
                         // open new connection
                         log_warning("api::serial", "read error on {}", this->port);
                         this->free_port();
                         break;
+                    }
+                    //log_info("api::serial::in", "{}", bin2hex(buffer, bytes_read));
+
+                    // check for reset
+                    if (framer.received(bytes_read)) {
+                        state->password = this->controller->get_password();
+                        state->password_change = true;
+                        Controller::process_password_change(state);
+                        log_info("api::serial", "session reset, remaining bytes: {}", framer.buffered());
+                    }
+
+                    // process every complete request, plain answers wait for the batch write
+                    const char *request;
+                    size_t request_size;
+                    bool failed = false;
+                    bool write_failed = false;
+                    batch.clear();
+                    while (framer.next(state->cipher, request, request_size)) {
+
+                        // zero bytes of a reset split over two reads are no request
+                        if (request_size == 0) {
+                            continue;
+                        }
 
-                    } else {
-                        //log_info("api::serial::in", "{}", bin2hex(read_buffer + read_buffer_len, bytes_read));
-
-                        // check for reset
-                        if (read_buffer_len + bytes_read > 7) {
-                            size_t zero_counter = 0;
-                            for (size_t i = 0; i < read_buffer_len + bytes_read; i++) {
-                                if (read_buffer[i] == 0x00) {
-                                    if (++zero_counter == 8) {
-
-                                        // reset password
-                                        state->password = this->controller->get_password();
-                                        state->password_change = true;
-                                        Controller::process_password_change(state);
-
-                                        // drop input
-                                        size_t new_length = 0;
-                                        while (++i < read_buffer_len + bytes_read) {
-                                            read_buffer[new_length++] = read_buffer[i];
-                                        }
-                                        bytes_read = new_length;
-                                        read_buffer_len = 0;
-                                        log_info("api::serial", "session reset, remaining bytes: {} {}", bytes_read, bin2hex(read_buffer, bytes_read));
-                                        break;
-                                    }
-                                } else {
-                                    zero_counter = 0;
-                                }
-                            }
+                        // process request
+                        out.clear();
+                        if (!this->controller->process_request(state, request, request_size, &out)) {
+                            log_warning("api::serial", "process error on {} (length {})",
+                                        this->port, request_size);
+                            failed = true;
+                            break;
                         }
 
-                        // crypt in-data
-                        if (state->cipher) {
-                            state->cipher->crypt(&read_buffer[read_buffer_len], bytes_read);
+                        // crypt out-data
+                        const bool encrypted = state->cipher != nullptr;
+                        if (encrypted) {
+                            state->cipher->crypt((uint8_t*) out.data(), out.size());
                         }
+                        batch.insert(batch.end(), out.begin(), out.end());
+
+                        // check for password change, applies to the next request already
+                        Controller::process_password_change(state);
 
-                        // adjust size
-                        read_buffer_len += bytes_read;
-
-                        // check if message complete
-                        for (size_t i = 0; i < read_buffer_len; ++i) {
-                            if (read_buffer[i] != 0x00) {
-                                continue;
-                            } else {
-
-                                // process request
-                                std::vector<char> out;
-                                if (!this->controller->process_request(
-                                        state,
-                                        (const char*) &read_buffer[0], read_buffer_len, &out)) {
-
-                                    // open new connection
-                                    log_warning("api::serial", "process error on {} (length {})",
-                                                this->port, i - 1);
-                                    this->free_port();
-                                    retry_time = 5;
-                                    break;
-                                }
-
-                                // adjust in-buffer
-                                if (i == read_buffer_len - 1) {
-                                    read_buffer_len = 0;
-                                } else {
-                                    size_t new_length = 0;
-                                    while (i < read_buffer_len) {
-                                        read_buffer[new_length++] = read_buffer[i++];
-                                    }
-                                    read_buffer_len = new_length;
-                                }
-
-                                // crypt out-data
-                                if (state->cipher) {
-                                    state->cipher->crypt((uint8_t*) out.data(), out.size());
-                                }
-
-                                // send answer
-                                DWORD bytes_written = 0;
-                                if (!WriteFile(
-                                        this->handle,
-                                        out.data(),
-                                        out.size(),
-                                        &bytes_written,
-                                        nullptr) || bytes_written != out.size()) {
-
-                                    // open new connection
-                                    log_warning("api::serial", "write error on {}", this->port);
-                                    this->free_port();
-                                    break;
-                                }
-
-                                // check for password change
-                                Controller::process_password_change(state);
-                                //log_info("api::serial::out", "{}", bin2hex(out));
-                                read_buffer_len = 0;
-                            }
+                        // requests and answers share one keystream, the client can only encrypt
+                        // its next request after decrypting this answer, so it goes out right now
+                        if (encrypted && !write_batch()) {
+                            write_failed = true;
+                            break;
                         }
                     }
+
+                    // send answers
+                    if (write_failed || !write_batch()) {
+
+                        // open new connection
+                        log_warning("api::serial", "write error on {}", this->port);
+                        this->free_port();
+                        break;
+                    }
+
+                    // open new connection
+                    if (failed) {
+                        this->free_port();
+                        retry_time = 5;
+                        break;
+                    }
+
+                    // a request filling the whole buffer can never complete
+                    if (framer.overflowed()) {
+                        log_warning("api::serial", "request too large on {}, dropping {} bytes",
+                                    this->port, framer.buffered());
+                        framer.clear();
+                    }
                 }
 
                 // slow down on reconnect
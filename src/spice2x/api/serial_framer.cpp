@@ -0,0 +1,86 @@
+#include "serial_framer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace api {
+
+    // raw zero bytes in a row resetting the session
+    static constexpr size_t RESET_ZEROS = 8;
+
+    SerialFramer::SerialFramer(size_t capacity) {
+        this->ring.resize(std::bit_ceil(std::max<size_t>(capacity, 16)));
+        this->mask = this->ring.size() - 1;
+    }
+
+    uint8_t *SerialFramer::receive_buffer(size_t &size) {
+        const auto offset = this->tail & this->mask;
+        size = std::min(this->ring.size() - (this->tail - this->head), this->ring.size() - offset);
+        return size > 0 ? &this->ring[offset] : nullptr;
+    }
+
+    bool SerialFramer::received(size_t size) {
+        const auto start = this->tail;
+        this->tail += size;
+
+        // the reset check runs on the bytes as they came in, before any decryption
+        bool reset = false;
+        for (auto pos = start; pos < this->tail; pos++) {
+            if (this->ring[pos & this->mask] != 0x00) {
+                this->zero_run = 0;
+            } else if (++this->zero_run == RESET_ZEROS) {
+                this->zero_run = 0;
+                this->head = pos + 1;
+                this->scan = pos + 1;
+                reset = true;
+            }
+        }
+        return reset;
+    }
+
+    bool SerialFramer::next(util::RC4 *cipher, const char *&data, size_t &size) {
+
+        // continue the terminator search where the last one stopped
+        bool found = false;
+        while (!found && this->scan < this->tail) {
+            const auto offset = this->scan & this->mask;
+            const auto piece = std::min(this->tail - this->scan, this->ring.size() - offset);
+            auto start = &this->ring[offset];
+            size_t length;
+            if (cipher) {
+                length = cipher->crypt_until(start, piece, 0x00);
+                found = start[length - 1] == 0x00;
+            } else {
+                auto terminator = (uint8_t *) memchr(start, 0x00, piece);
+                found = terminator != nullptr;
+                length = found ? (size_t) (terminator - start) + 1 : piece;
+            }
+            this->scan += length;
+        }
+        if (!found) {
+            return false;
+        }
+
+        // hand the request out in place unless it wraps around
+        const auto offset = this->head & this->mask;
+        size = this->scan - 1 - this->head;
+        if (offset + size <= this->ring.size()) {
+            data = (const char *) &this->ring[offset];
+        } else {
+            const auto first = this->ring.size() - offset;
+            this->wrapped.resize(size);
+            memcpy(this->wrapped.data(), &this->ring[offset], first);
+            memcpy(this->wrapped.data() + first, this->ring.data(), size - first);
+            data = this->wrapped.data();
+        }
+        this->head = this->scan;
+        return true;
+    }
+
+    void SerialFramer::clear() {
+        this->head = this->tail;
+        this->scan = this->tail;
+        this->zero_run = 0;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "util/rc4.h"
+
+namespace api {
+
+    /*
+     * Request framing of the serial API. Requests are terminated by a zero byte once decrypted,
+     * and eight zero bytes in a row on the wire reset the session.
+     *
+     * Received bytes go into a ring and stay where they landed: the reset check only looks at
+     * new bytes, the terminator search picks up where it stopped, and a request that lies in one
+     * piece in the ring is handed out in place. Only a request wrapping around the end of the
+     * ring gets copied. Every complete request in the buffer comes out one after the other, so
+     * a client may send the next ones without waiting for answers, as long as the session is not
+     * encrypted.
+     *
+     * Decryption happens as requests are taken out and stops at each terminator, so a key
+     * changed by one request applies to the very next byte. With encryption, requests and
+     * answers run through the same RC4 keystream, so a client cannot encrypt a request before it
+     * decrypted the answer to the last one: no pipelining, and the caller has to encrypt and send
+     * each answer before taking out the next request. No Windows dependencies.
+     */
+    class SerialFramer {
+    public:
+
+        // `capacity` is rounded up to a power of two and limits the size of a single request
+        explicit SerialFramer(size_t capacity = 16 * 1024);
+
+        // free space to receive into, in one piece; null when the ring is full
+        uint8_t *receive_buffer(size_t &size);
+
+        /*
+         * `size` bytes were written to the receive buffer. Returns true when they contained a
+         * session reset, everything up to it is gone then and the caller has to reset the key
+         * before taking out the next request.
+         */
+        bool received(size_t size);
+
+        /*
+         * Takes out the next complete request, decrypting with `cipher` if there is one. The
+         * request excludes its terminator and stays valid until the next call on the framer.
+         */
+        bool next(util::RC4 *cipher, const char *&data, size_t &size);
+
+        // the ring is full and holds no complete request, so the one in it can never finish
+        bool overflowed() const {
+            return this->tail - this->head == this->ring.size() && this->scan == this->tail;
+        }
+
+        // drops everything buffered
+        void clear();
+
+        size_t buffered() const {
+            return this->tail - this->head;
+        }
+
+    private:
+        std::vector<uint8_t> ring;
+        size_t mask;
+
+        // running byte counts: start of the first request, end of the terminator search, end
+        // of the received data. head <= scan <= tail
+        size_t head = 0;
+        size_t scan = 0;
+        size_t tail = 0;
+
+        // zero bytes in a row at the end of the received data
+        size_t zero_run = 0;
+
+        // a request wrapping around the end of the ring, put back together
+        std::vector<char> wrapped;
+    };
+}
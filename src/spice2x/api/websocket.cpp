@@ -1,89 +1,114 @@
-#define HEADSOCKET_IMPLEMENTATION
-#include "external/headsocket.h"
-
 #include "websocket.h"
+
+#include <map>
+#include <mutex>
+
 #include "util/utils.h"
 #include "util/rc4.h"
 #include "util/logging.h"
 #include "overlay/notifications.h"
 #include "controller.h"
-
-using namespace headsocket;
+#include "websocket_server.h"
 
 namespace api {
 
-    namespace {
-
-        // how long a single handshake read may stall before the connection is dropped;
-        // headsocket reads the request a byte at a time, so this is an idle timeout between
-        // bytes rather than a deadline for the whole handshake
-        constexpr int handshake_timeout_ms = 5000;
-
-        void set_recv_timeout(connection &conn, int milliseconds) {
-            DWORD timeout = static_cast<DWORD>(milliseconds);
-            setsockopt(conn.impl()->socket, SOL_SOCKET, SO_RCVTIMEO,
-                    reinterpret_cast<const char *>(&timeout), sizeof(timeout));
-        }
-    }
-
     /*
-     * Client class declaration
+     * Controller state so we don't have to import the server in our header
      */
-    class WebSocketClient : public web_socket_client {
+    struct WebSocketControllerState : ws::ServerHandler {
+        Controller *controller = nullptr;
+        std::unique_ptr<ws::Server> server;
+
+        // client states by connection
+        std::map<ws::ClientId, ClientState *> clients;
+        std::mutex clients_m;
+
+        ClientState *find(ws::ClientId client) {
+            std::lock_guard<std::mutex> lock(this->clients_m);
+            auto it = this->clients.find(client);
+            return it != this->clients.end() ? it->second : nullptr;
+        }
 
-        // required class header
-        HEADSOCKET_CLIENT(WebSocketClient, web_socket_client);
+        void on_open(ws::ClientId client, const std::string &address) override {
 
-    private:
-        ClientState *state = nullptr;
+            // init state
+            auto state = new ClientState();
+            this->controller->init_state(state);
+            {
+                std::lock_guard<std::mutex> lock(this->clients_m);
+                this->clients[client] = state;
+            }
 
-        // headsocket doesn't expose the peer address on its own client API, but the
-        // sockaddr_in captured at accept time is sitting right there in the impl
-        std::string remote_address() const {
-            char address_data[INET_ADDRSTRLEN] {};
-            inet_ntop(AF_INET, &this->_p->conn.impl()->from.sin_addr,
-                    address_data, INET_ADDRSTRLEN);
-            return std::string(address_data);
+            // log connection
+            log_info("api::websocket", "client connected: {}", address);
+            overlay::notifications::add(
+                    overlay::notifications::Severity::Success,
+                    fmt::format("API websocket client connected ({})", address));
         }
 
-    protected:
-        bool async_received_data(const data_block &db, uint8_t *ptr, size_t length) override;
+        void on_close(ws::ClientId client, const std::string &address) override {
+
+            // log disconnection
+            log_info("api::websocket", "client disconnected: {}", address);
+            overlay::notifications::add(
+                    overlay::notifications::Severity::Info,
+                    fmt::format("API websocket client disconnected ({})", address));
+
+            // clean up state
+            ClientState *state = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(this->clients_m);
+                auto it = this->clients.find(client);
+                if (it != this->clients.end()) {
+                    state = it->second;
+                    this->clients.erase(it);
+                }
+            }
+            if (state) {
+                Controller::free_state(state);
+                delete state;
+            }
+        }
 
-        void on_accept() override;
-        void on_disconnect() override;
-    };
+        /*
+         * This is where business actually happens, the server never calls this for the same
+         * client twice at a time, so the state needs no locking of its own
+         */
+        void on_message(ws::ClientId client, ws::Opcode opcode, std::vector<uint8_t> &message) override {
 
-    /*
-     * Server class declaration
-     */
-    class WebSocketServer : public web_socket_server<WebSocketClient> {
-        HEADSOCKET_SERVER(WebSocketServer, web_socket_server);
-    public:
-        WebSocketController *websocket;
+            // check state
+            auto state = this->find(client);
+            if (!state) {
+                log_fatal("api::websocket", "client with no state received message");
+            }
 
-    protected:
-        bool handshake(connection &conn) override {
+            // check message type
+            if (opcode != ws::Opcode::Binary) {
+                log_warning("api::websocket", "message received with non-binary type");
+                return;
+            }
 
-            // headsocket runs the handshake on its single accept thread with a blocking
-            // recv, so a peer that connects and then says nothing would park that thread and
-            // leave every later connection sitting unaccepted in the backlog
-            set_recv_timeout(conn, handshake_timeout_ms);
-            const bool accepted = base_t::handshake(conn);
+            // crypt in-data
+            if (state->cipher) {
+                state->cipher->crypt(message.data(), message.size());
+            }
 
-            // from here the client thread owns the socket and wants to block on reads
-            set_recv_timeout(conn, 0);
+            // process request
+            std::vector<char> out;
+            this->controller->process_request(state,
+                    reinterpret_cast<const char *>(message.data()), message.size(), &out);
 
-            return accepted;
-        }
-    };
+            // crypt out-data
+            if (state->cipher) {
+                state->cipher->crypt(reinterpret_cast<uint8_t *>(out.data()), out.size());
+            }
 
-    void api::WebSocketServer::init() {}
+            // send answer
+            this->server->send(client, ws::Opcode::Binary, std::vector<uint8_t>(out.begin(), out.end()));
 
-    /*
-     * Controller state so we don't have to import headsocket stuff in our header
-     */
-    struct WebSocketControllerState {
-        std::shared_ptr<WebSocketServer> server;
+            // check for password change
+            Controller::process_password_change(state);
+        }
     };
 
     WebSocketController::WebSocketController(Controller *controller, uint16_t port) {
@@ -91,11 +116,14 @@ namespace api {
 
         // create state
         this->state = new WebSocketControllerState();
+        this->state->controller = controller;
 
         // start server
-        this->state->server = WebSocketServer::create(port);
-        this->state->server->websocket = this;
-        if (this->state->server->is_running()) {
+        ws::ServerConfig config;
+        config.port = port;
+        config.worker_count = 4;
+        this->state->server = std::make_unique<ws::Server>(config, *this->state);
+        if (this->state->server->start()) {
             log_info("api::websocket", "server listening on port: {}", port);
         } else {
             log_warning("api::websocket", "server failed to listen on port: {}", port);
@@ -107,6 +135,11 @@ namespace api {
         // stop server
         this->state->server->stop();
 
+        // print stats
+        const auto stats = this->state->server->stats();
+        log_misc("api::websocket", "messages in: {}, out: {}, sends: {}, dropped clients: {}",
+                stats.messages_in, stats.messages_out, stats.send_calls, stats.clients_dropped);
+
         // delete state
         delete this->state;
     }
@@ -114,103 +147,4 @@ namespace api {
     void WebSocketController::free_socket() {
         this->state->server->stop();
     }
-
-    void WebSocketClient::on_accept() {
-        web_socket_client::on_accept();
-
-        // get pointer to server
-        auto srv = reinterpret_cast<WebSocketServer *>(server().get());
-        if (!srv || !srv->websocket) {
-            log_fatal("api::websocket", "on_accept has no server");
-        }
-
-        // check for init
-        state = new ClientState();
-        srv->websocket->controller->init_state(state);
-
-        // log connection
-        const auto address = this->remote_address();
-        log_info("api::websocket", "client connected: {}", address);
-        overlay::notifications::add(
-                overlay::notifications::Severity::Success,
-                fmt::format("API websocket client connected ({})", address));
-    }
-
-    void WebSocketClient::on_disconnect() {
-
-        // log disconnection
-        const auto address = this->remote_address();
-        log_info("api::websocket", "client disconnected: {}", address);
-        overlay::notifications::add(
-                overlay::notifications::Severity::Info,
-                fmt::format("API websocket client disconnected ({})", address));
-
-        // get pointer to server
-        auto srv = reinterpret_cast<WebSocketServer *>(server().get());
-        if (!srv || !srv->websocket) {
-            log_fatal("api::websocket", "on_disconnect has no server");
-        }
-
-        // clean up state
-        srv->websocket->controller->free_state(state);
-        delete state;
-        state = nullptr;
-
-        // call super
-        web_socket_client::on_disconnect();
-    }
-
-    /*
-     * This is where business actually happens, gets called on every datablock receive
-     */
-    bool WebSocketClient::async_received_data(const data_block &db, uint8_t *ptr, size_t length) {
-
-        // get pointer to server
-        auto srv = reinterpret_cast<WebSocketServer *>(server().get());
-        if (!srv || !srv->websocket) {
-            log_fatal("api::websocket", "received datablock without server");
-        }
-
-        // check state
-        if (!state) {
-            log_fatal("api::websocket", "client with no state received datablock");
-        }
-
-        // check datablock type
-        switch (db.op) {
-            case opcode::binary: {
-
-                // allocate buffers
-                std::vector<char> in(ptr, ptr + length);
-                std::vector<char> out;
-
-                // crypt in-data
-                if (state->cipher) {
-                    state->cipher->crypt(reinterpret_cast<uint8_t *>(in.data()), in.size());
-                }
-
-                // process request
-                srv->websocket->controller->process_request(state, &in, &out);
-
-                // crypt out-data
-                if (state->cipher) {
-                    state->cipher->crypt(reinterpret_cast<uint8_t *>(out.data()), out.size());
-                }
-
-                // send answer
-                push(out.data(), out.size());
-
-                // check for password change
-                srv->websocket->controller->process_password_change(state);
-
-                break;
-            }
-            default:
-                log_warning("api::websocket", "datablock received with non-binary type");
-                break;
-        }
-
-        // always consume the datablock, nomnom
-        return true;
-    }
 }
@@ -0,0 +1,464 @@
+#include "websocket_deflate.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace api::ws {
+
+    namespace {
+
+        const uint16_t LENGTH_BASE[29] {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+        };
+        const uint8_t LENGTH_EXTRA[29] {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+        };
+        const uint16_t DISTANCE_BASE[30] {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+        };
+        const uint8_t DISTANCE_EXTRA[30] {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+        };
+
+        // the tail a sender strips off every message, put back before decompressing
+        const uint8_t SYNC_TAIL[4] { 0x00, 0x00, 0xFF, 0xFF };
+
+        constexpr size_t MATCH_MIN = 3;
+        constexpr size_t MATCH_MAX = 258;
+
+        /*
+         * Compression
+         */
+
+        // Huffman codes go out most significant bit first, everything else least significant first
+        uint16_t reverse_bits(uint16_t code, int length) {
+            uint16_t reversed = 0;
+            for (int i = 0; i < length; i++) {
+                reversed = (uint16_t) (reversed << 1 | (code >> i & 1));
+            }
+            return reversed;
+        }
+
+        struct FixedCode {
+            uint16_t bits;
+            uint8_t length;
+        };
+
+        // the fixed literal/length code of RFC 1951 3.2.6, already reversed
+        struct FixedCodes {
+            FixedCode literal[288];
+
+            FixedCodes() {
+                for (int symbol = 0; symbol < 288; symbol++) {
+                    uint16_t code;
+                    int length;
+                    if (symbol < 144) {
+                        code = (uint16_t) (0x30 + symbol);
+                        length = 8;
+                    } else if (symbol < 256) {
+                        code = (uint16_t) (0x190 + symbol - 144);
+                        length = 9;
+                    } else if (symbol < 280) {
+                        code = (uint16_t) (symbol - 256);
+                        length = 7;
+                    } else {
+                        code = (uint16_t) (0xC0 + symbol - 280);
+                        length = 8;
+                    }
+                    this->literal[symbol] = { reverse_bits(code, length), (uint8_t) length };
+                }
+            }
+        };
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint8_t> &out) : out(out) {
+            }
+
+            void put(uint32_t value, int length) {
+                this->buffer |= (uint64_t) value << this->count;
+                this->count += length;
+                if (this->count >= 32) {
+                    for (int i = 0; i < 4; i++) {
+                        this->out.push_back((uint8_t) (this->buffer >> (i * 8)));
+                    }
+                    this->buffer >>= 32;
+                    this->count -= 32;
+                }
+            }
+
+            // pads to the next byte boundary
+            void flush() {
+                while (this->count > 0) {
+                    this->out.push_back((uint8_t) this->buffer);
+                    this->buffer >>= 8;
+                    this->count = std::max(this->count - 8, 0);
+                }
+                this->buffer = 0;
+            }
+
+        private:
+            std::vector<uint8_t> &out;
+            uint64_t buffer = 0;
+            int count = 0;
+        };
+
+        inline uint32_t hash3(const uint8_t *data, int hash_bits) {
+            const uint32_t value = (uint32_t) data[0] | (uint32_t) data[1] << 8 | (uint32_t) data[2] << 16;
+            return (value * 0x9E3779B1u) >> (32 - hash_bits);
+        }
+
+        // how far two positions keep matching, up to `max` bytes
+        inline size_t match_length(const uint8_t *a, const uint8_t *b, size_t max) {
+            size_t length = 0;
+            while (length + 8 <= max) {
+                uint64_t x, y;
+                memcpy(&x, a + length, 8);
+                memcpy(&y, b + length, 8);
+                if (x != y) {
+
+                    // little endian, the first differing byte is the lowest one
+                    return length + (size_t) (std::countr_zero(x ^ y) / 8);
+                }
+                length += 8;
+            }
+            while (length < max && a[length] == b[length]) {
+                length++;
+            }
+            return length;
+        }
+
+        /*
+         * Decompression, after Mark Adler's puff: canonical codes decoded bit by bit, which is
+         * plenty for API requests of a few kilobytes.
+         */
+
+        struct Huffman {
+            uint16_t count[16];
+            uint16_t symbol[288];
+        };
+
+        // false when the lengths over-subscribe the code; incomplete codes are fine
+        bool build_huffman(Huffman &h, const uint8_t *lengths, int n) {
+            memset(h.count, 0, sizeof(h.count));
+            for (int symbol = 0; symbol < n; symbol++) {
+                h.count[lengths[symbol]]++;
+            }
+            int left = 1;
+            for (int length = 1; length < 16; length++) {
+                left <<= 1;
+                left -= h.count[length];
+                if (left < 0) {
+                    return false;
+                }
+            }
+            uint16_t offsets[16];
+            offsets[1] = 0;
+            for (int length = 1; length < 15; length++) {
+                offsets[length + 1] = (uint16_t) (offsets[length] + h.count[length]);
+            }
+            for (int symbol = 0; symbol < n; symbol++) {
+                if (lengths[symbol] != 0) {
+                    h.symbol[offsets[lengths[symbol]]++] = (uint16_t) symbol;
+                }
+            }
+            return true;
+        }
+
+        struct FixedTables {
+            Huffman literal;
+            Huffman distance;
+
+            FixedTables() {
+                uint8_t lengths[288];
+                memset(lengths, 8, 144);
+                memset(lengths + 144, 9, 112);
+                memset(lengths + 256, 7, 24);
+                memset(lengths + 280, 8, 8);
+                build_huffman(this->literal, lengths, 288);
+                memset(lengths, 5, 30);
+                build_huffman(this->distance, lengths, 30);
+            }
+        };
+
+        class Inflater {
+        public:
+            Inflater(const uint8_t *data, size_t size, size_t limit, std::vector<uint8_t> &out)
+                    : data(data), size(size), limit(limit), out(out) {
+            }
+
+            bool run() {
+                bool last;
+                do {
+                    last = this->bits(1) != 0;
+                    bool ok;
+                    switch (this->bits(2)) {
+                        case 0:
+                            ok = this->stored();
+                            break;
+                        case 1: {
+                            static const FixedTables fixed;
+                            ok = this->codes(fixed.literal, fixed.distance);
+                            break;
+                        }
+                        case 2:
+                            ok = this->dynamic();
+                            break;
+                        default:
+                            ok = false;
+                            break;
+                    }
+                    if (!ok || this->failed) {
+                        return false;
+                    }
+                } while (!last && this->pos < this->size + sizeof(SYNC_TAIL));
+                return true;
+            }
+
+        private:
+            const uint8_t *data;
+            size_t size;
+            size_t limit;
+            std::vector<uint8_t> &out;
+            size_t pos = 0;
+            uint32_t buffer = 0;
+            int count = 0;
+
+            // set once the input ran out, everything read after that is zero
+            bool failed = false;
+
+            uint8_t byte() {
+                if (this->pos < this->size) {
+                    return this->data[this->pos++];
+                }
+                if (this->pos < this->size + sizeof(SYNC_TAIL)) {
+                    return SYNC_TAIL[this->pos++ - this->size];
+                }
+                this->failed = true;
+                return 0;
+            }
+
+            uint32_t bits(int n) {
+                while (this->count < n) {
+                    this->buffer |= (uint32_t) this->byte() << this->count;
+                    this->count += 8;
+                }
+                const auto value = this->buffer & ((1u << n) - 1);
+                this->buffer >>= n;
+                this->count -= n;
+                return value;
+            }
+
+            int decode(const Huffman &h) {
+                int code = 0;
+                int first = 0;
+                int index = 0;
+                for (int length = 1; length < 16; length++) {
+                    code |= (int) this->bits(1);
+                    const int count = h.count[length];
+                    if (code - count < first) {
+                        return h.symbol[index + (code - first)];
+                    }
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                return -1;
+            }
+
+            bool stored() {
+                this->buffer = 0;
+                this->count = 0;
+                const auto length = this->bits(16);
+                const auto complement = this->bits(16);
+                if (this->failed || length != (~complement & 0xFFFF)
+                        || this->out.size() + length > this->limit) {
+                    return false;
+                }
+                for (uint32_t i = 0; i < length; i++) {
+                    this->out.push_back(this->byte());
+                }
+                return !this->failed;
+            }
+
+            bool codes(const Huffman &literal, const Huffman &distance) {
+                while (!this->failed) {
+                    auto symbol = this->decode(literal);
+                    if (symbol < 0) {
+                        return false;
+                    }
+                    if (symbol < 256) {
+                        if (this->out.size() >= this->limit) {
+                            return false;
+                        }
+                        this->out.push_back((uint8_t) symbol);
+                        continue;
+                    }
+                    if (symbol == 256) {
+                        return true;
+                    }
+
+                    // a match, copied byte by byte since it may overlap itself
+                    symbol -= 257;
+                    if (symbol >= 29) {
+                        return false;
+                    }
+                    const size_t length = LENGTH_BASE[symbol] + this->bits(LENGTH_EXTRA[symbol]);
+                    const auto distance_symbol = this->decode(distance);
+                    if (distance_symbol < 0 || distance_symbol >= 30) {
+                        return false;
+                    }
+                    const size_t offset = DISTANCE_BASE[distance_symbol]
+                            + this->bits(DISTANCE_EXTRA[distance_symbol]);
+                    if (offset > this->out.size() || this->out.size() + length > this->limit) {
+                        return false;
+                    }
+                    auto pos = this->out.size();
+                    this->out.resize(pos + length);
+                    auto target = this->out.data() + pos;
+                    for (size_t i = 0; i < length; i++) {
+                        target[i] = target[i - offset];
+                    }
+                }
+                return false;
+            }
+
+            bool dynamic() {
+                static const uint8_t ORDER[19] {
+                    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+                };
+                const int literal_count = (int) this->bits(5) + 257;
+                const int distance_count = (int) this->bits(5) + 1;
+                const int length_count = (int) this->bits(4) + 4;
+                if (literal_count > 286 || distance_count > 30) {
+                    return false;
+                }
+
+                // the code lengths are themselves Huffman coded
+                uint8_t lengths[286 + 30] {};
+                for (int i = 0; i < length_count; i++) {
+                    lengths[ORDER[i]] = (uint8_t) this->bits(3);
+                }
+                Huffman length_code;
+                if (!build_huffman(length_code, lengths, 19)) {
+                    return false;
+                }
+                memset(lengths, 0, sizeof(lengths));
+                int index = 0;
+                while (index < literal_count + distance_count) {
+                    const auto symbol = this->decode(length_code);
+                    if (symbol < 0 || this->failed) {
+                        return false;
+                    }
+                    if (symbol < 16) {
+                        lengths[index++] = (uint8_t) symbol;
+                        continue;
+                    }
+                    uint8_t value = 0;
+                    int repeat;
+                    if (symbol == 16) {
+                        if (index == 0) {
+                            return false;
+                        }
+                        value = lengths[index - 1];
+                        repeat = 3 + (int) this->bits(2);
+                    } else if (symbol == 17) {
+                        repeat = 3 + (int) this->bits(3);
+                    } else {
+                        repeat = 11 + (int) this->bits(7);
+                    }
+                    if (index + repeat > literal_count + distance_count) {
+                        return false;
+                    }
+                    while (repeat--) {
+                        lengths[index++] = value;
+                    }
+                }
+                if (lengths[256] == 0) {
+                    return false;
+                }
+
+                Huffman literal, distance;
+                if (!build_huffman(literal, lengths, literal_count)
+                        || !build_huffman(distance, lengths + literal_count, distance_count)) {
+                    return false;
+                }
+                return this->codes(literal, distance);
+            }
+        };
+    }
+
+    void deflate_message(const uint8_t *data, size_t size, int window_bits, std::vector<uint8_t> &out) {
+        static const FixedCodes fixed;
+        out.clear();
+        out.reserve(size / 2 + 16);
+        BitWriter writer(out);
+
+        // a single fixed Huffman block, not final since more would follow a sync flush
+        writer.put(0, 1);
+        writer.put(1, 2);
+
+        // the hash table only needs to be as large as the message
+        const int hash_bits = std::clamp((int) std::bit_width(size), 8, 15);
+        std::vector<int32_t> head((size_t) 1 << hash_bits, -1);
+        const size_t window = (size_t) 1 << std::clamp(window_bits, 8, 15);
+
+        const auto literal = [&writer](uint8_t value) {
+            writer.put(fixed.literal[value].bits, fixed.literal[value].length);
+        };
+
+        size_t pos = 0;
+        while (pos + MATCH_MIN <= size) {
+            auto &slot = head[hash3(data + pos, hash_bits)];
+            const auto candidate = slot;
+            slot = (int32_t) pos;
+
+            size_t length = 0;
+            if (candidate >= 0 && pos - (size_t) candidate <= window) {
+                length = match_length(data + candidate, data + pos, std::min(MATCH_MAX, size - pos));
+            }
+            if (length < MATCH_MIN) {
+                literal(data[pos++]);
+                continue;
+            }
+
+            // length symbol and extra bits
+            const auto distance = pos - (size_t) candidate;
+            const auto length_index = std::upper_bound(LENGTH_BASE, LENGTH_BASE + 29, length) - LENGTH_BASE - 1;
+            const auto &code = fixed.literal[257 + length_index];
+            writer.put(code.bits, code.length);
+            writer.put((uint32_t) (length - LENGTH_BASE[length_index]), LENGTH_EXTRA[length_index]);
+
+            // distance symbols all have a fixed five bit code
+            const auto distance_index = std::upper_bound(DISTANCE_BASE, DISTANCE_BASE + 30, distance) - DISTANCE_BASE - 1;
+            writer.put(reverse_bits((uint16_t) distance_index, 5), 5);
+            writer.put((uint32_t) (distance - DISTANCE_BASE[distance_index]), DISTANCE_EXTRA[distance_index]);
+
+            // remember the positions inside the match for later ones
+            const auto end = pos + length;
+            for (pos++; pos < end && pos + MATCH_MIN <= size; pos++) {
+                head[hash3(data + pos, hash_bits)] = (int32_t) pos;
+            }
+            pos = end;
+        }
+        while (pos < size) {
+            literal(data[pos++]);
+        }
+
+        // end of block, then the empty stored block of a sync flush minus its 00 00 FF FF
+        writer.put(fixed.literal[256].bits, fixed.literal[256].length);
+        writer.put(0, 3);
+        writer.flush();
+    }
+
+    bool inflate_message(const uint8_t *data, size_t size, size_t limit, std::vector<uint8_t> &out) {
+        out.clear();
+        return Inflater(data, size, limit, out).run();
+    }
+}
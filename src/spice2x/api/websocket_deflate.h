@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Raw DEFLATE (RFC 1951) as permessage-deflate uses it, without zlib framing and with the
+ * 00 00 FF FF tail of the final sync flush left off. Every message stands on its own, we never
+ * keep a context between messages in either direction.
+ *
+ * The compressor is a greedy LZ77 matcher with the fixed Huffman code: not the best ratio, but
+ * fast and good enough for the repetitive JSON the API sends. The decompressor takes any valid
+ * stream. No Windows dependencies.
+ */
+namespace api::ws {
+
+    // compresses `size` bytes into `out`, replacing its contents. `window_bits` is 8 to 15
+    void deflate_message(const uint8_t *data, size_t size, int window_bits, std::vector<uint8_t> &out);
+
+    // decompresses a message into `out`. false on corrupt data or output beyond `limit` bytes
+    bool inflate_message(const uint8_t *data, size_t size, size_t limit, std::vector<uint8_t> &out);
+}
@@ -0,0 +1,468 @@
+#include "websocket_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "external/hash-library/sha1.h"
+
+#include "websocket_deflate.h"
+
+namespace api::ws {
+
+    namespace {
+
+        const char ACCEPT_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        // kept local so this file stays free of the Windows bound util/crypt
+        std::string base64_encode(const uint8_t *data, size_t size) {
+            static const char TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::string out;
+            out.reserve((size + 2) / 3 * 4);
+            for (size_t i = 0; i < size; i += 3) {
+                const uint32_t chunk = (uint32_t) data[i] << 16
+                        | (i + 1 < size ? (uint32_t) data[i + 1] << 8 : 0)
+                        | (i + 2 < size ? (uint32_t) data[i + 2] : 0);
+                out.push_back(TABLE[(chunk >> 18) & 63]);
+                out.push_back(TABLE[(chunk >> 12) & 63]);
+                out.push_back(i + 1 < size ? TABLE[(chunk >> 6) & 63] : '=');
+                out.push_back(i + 2 < size ? TABLE[chunk & 63] : '=');
+            }
+            return out;
+        }
+
+        std::string lowercase(std::string text) {
+            for (auto &c : text) {
+                if (c >= 'A' && c <= 'Z') {
+                    c = (char) (c - 'A' + 'a');
+                }
+            }
+            return text;
+        }
+
+        std::string trim(const std::string &text) {
+            const auto begin = text.find_first_not_of(" \t");
+            if (begin == std::string::npos) {
+                return "";
+            }
+            const auto end = text.find_last_not_of(" \t");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        // splits a header value into its comma or semicolon separated items, trimmed
+        std::vector<std::string> split(const std::string &text, char separator) {
+            std::vector<std::string> items;
+            size_t pos = 0;
+            while (pos <= text.size()) {
+                auto end = text.find(separator, pos);
+                if (end == std::string::npos) {
+                    end = text.size();
+                }
+                items.push_back(trim(text.substr(pos, end - pos)));
+                pos = end + 1;
+            }
+            return items;
+        }
+
+        bool has_token(const std::string &value, const char *token) {
+            for (auto &item : split(lowercase(value), ',')) {
+                if (item == token) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+         * Picks the first permessage-deflate offer we can honor. Both directions always run
+         * without context takeover, which the response asks of the client, so the only thing
+         * an offer can change for us is the window we may use.
+         */
+        bool accept_deflate_offer(const std::string &extensions, int &window_bits) {
+            for (auto &offer : split(extensions, ',')) {
+                auto params = split(offer, ';');
+                if (params.empty() || lowercase(params[0]) != "permessage-deflate") {
+                    continue;
+                }
+                bool usable = true;
+                int bits = 15;
+                for (size_t i = 1; i < params.size() && usable; i++) {
+                    const auto eq = params[i].find('=');
+                    const auto name = lowercase(trim(params[i].substr(0, eq)));
+                    auto value = eq == std::string::npos ? "" : trim(params[i].substr(eq + 1));
+                    value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+                    if (name == "server_max_window_bits") {
+                        bits = value.empty() ? -1 : atoi(value.c_str());
+                        usable = bits >= 8 && bits <= 15;
+                    } else if (name != "client_max_window_bits"
+                            && name != "server_no_context_takeover"
+                            && name != "client_no_context_takeover") {
+                        usable = false;
+                    }
+                }
+                if (usable) {
+                    window_bits = bits;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    /*
+     * HandshakeParser
+     */
+
+    HandshakeParser::Result HandshakeParser::push(const char *data, size_t size, size_t &consumed) {
+
+        // only look at what is new, plus the three bytes before in case the blank line straddles
+        const auto search_from = this->head.size() >= 3 ? this->head.size() - 3 : 0;
+        this->head.append(data, size);
+        const auto end = this->head.find("\r\n\r\n", search_from);
+        if (end == std::string::npos) {
+            consumed = size;
+            return this->head.size() > this->size_limit ? Result::Failed : Result::Incomplete;
+        }
+
+        // leave whatever follows the request to the caller
+        const auto head_size = end + 4;
+        consumed = size - (this->head.size() - head_size);
+        this->head.resize(head_size);
+        if (head_size > this->size_limit) {
+            return Result::Failed;
+        }
+        return this->parse() ? Result::Done : Result::Failed;
+    }
+
+    bool HandshakeParser::parse() {
+        auto lines = split(this->head, '\n');
+
+        // request line
+        const auto request = split(trim(lines[0].substr(0, lines[0].find('\r'))), ' ');
+        if (request.size() != 3 || request[0] != "GET" || request[2].rfind("HTTP/1.", 0) != 0) {
+            return false;
+        }
+        this->result.path = request[1];
+
+        // headers
+        bool upgrade = false;
+        bool connection = false;
+        bool version = false;
+        std::string extensions;
+        for (size_t i = 1; i < lines.size(); i++) {
+            const auto line = lines[i].substr(0, lines[i].find('\r'));
+            const auto colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            const auto name = lowercase(trim(line.substr(0, colon)));
+            const auto value = trim(line.substr(colon + 1));
+            if (name == "upgrade") {
+                upgrade = has_token(value, "websocket");
+            } else if (name == "connection") {
+                connection = has_token(value, "upgrade");
+            } else if (name == "sec-websocket-version") {
+                version = value == "13";
+            } else if (name == "sec-websocket-key") {
+                this->result.key = value;
+            } else if (name == "sec-websocket-extensions") {
+                extensions += extensions.empty() ? value : ", " + value;
+            }
+        }
+        if (!upgrade || !connection || !version || this->result.key.size() != 24) {
+            return false;
+        }
+
+        this->result.deflate = accept_deflate_offer(extensions, this->result.deflate_window_bits);
+        return true;
+    }
+
+    std::string HandshakeParser::response(bool deflate) const {
+        std::string response =
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + accept_key(this->result.key) + "\r\n";
+        if (deflate) {
+            response += "Sec-WebSocket-Extensions: permessage-deflate; "
+                        "server_no_context_takeover; client_no_context_takeover";
+            if (this->result.deflate_window_bits < 15) {
+                response += "; server_max_window_bits=" + std::to_string(this->result.deflate_window_bits);
+            }
+            response += "\r\n";
+        }
+        return response + "\r\n";
+    }
+
+    std::string HandshakeParser::reject_response() {
+        return "HTTP/1.1 400 Bad Request\r\n"
+               "Connection: close\r\n"
+               "Content-Length: 0\r\n"
+               "\r\n";
+    }
+
+    std::string accept_key(const std::string &key) {
+        SHA1 sha1;
+        sha1.add(key.data(), key.size());
+        sha1.add(ACCEPT_GUID, sizeof(ACCEPT_GUID) - 1);
+        unsigned char digest[SHA1::HashBytes];
+        sha1.getHash(digest);
+        return base64_encode(digest, sizeof(digest));
+    }
+
+    /*
+     * Frames
+     */
+
+    size_t write_frame_header(uint8_t *out, Opcode opcode, size_t size, bool compressed, bool fin) {
+        out[0] = (uint8_t) ((fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (uint8_t) opcode);
+        if (size < 126) {
+            out[1] = (uint8_t) size;
+            return 2;
+        }
+        if (size <= 0xFFFF) {
+            out[1] = 126;
+            out[2] = (uint8_t) (size >> 8);
+            out[3] = (uint8_t) size;
+            return 4;
+        }
+        out[1] = 127;
+        for (int i = 0; i < 8; i++) {
+            out[2 + i] = (uint8_t) ((uint64_t) size >> (56 - i * 8));
+        }
+        return 10;
+    }
+
+    void apply_mask(uint8_t *data, size_t size, const uint8_t mask[4], size_t offset) {
+
+        // the mask lined up with the first byte, then eight bytes at a time
+        uint8_t rotated[8];
+        for (size_t i = 0; i < 8; i++) {
+            rotated[i] = mask[(offset + i) & 3];
+        }
+        uint64_t mask64;
+        memcpy(&mask64, rotated, sizeof(mask64));
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t chunk;
+            memcpy(&chunk, data + i, sizeof(chunk));
+            chunk ^= mask64;
+            memcpy(data + i, &chunk, sizeof(chunk));
+        }
+        for (; i < size; i++) {
+            data[i] ^= rotated[i & 7];
+        }
+    }
+
+    size_t FrameParser::header_needed() const {
+        size_t needed = 2;
+        const auto length = this->header[1] & 0x7F;
+        if (length == 126) {
+            needed += 2;
+        } else if (length == 127) {
+            needed += 8;
+        }
+        if (this->header[1] & 0x80) {
+            needed += 4;
+        }
+        return needed;
+    }
+
+    bool FrameParser::push(const uint8_t *data, size_t size, Handler &handler) {
+        if (this->error_code) {
+            return false;
+        }
+        while (size > 0) {
+            if (this->state == State::Header) {
+
+                // the first two bytes tell how long the rest of the header is
+                const auto needed = this->header_size < 2 ? 2 : this->header_needed();
+                const auto take = std::min(needed - this->header_size, size);
+                memcpy(this->header + this->header_size, data, take);
+                this->header_size += take;
+                data += take;
+                size -= take;
+                if (this->header_size < 2 || this->header_size < this->header_needed()) {
+                    continue;
+                }
+                if (!this->begin_frame()) {
+                    return false;
+                }
+                if (this->remaining == 0) {
+                    this->end_frame(handler);
+                } else {
+                    this->state = State::Payload;
+                }
+                continue;
+            }
+
+            // payload, unmasked on the way into its buffer
+            const auto take = (size_t) std::min<uint64_t>(this->remaining, size);
+            uint8_t *target;
+            if ((uint8_t) this->opcode & 0x8) {
+                target = this->control + this->control_size;
+                this->control_size += take;
+            } else {
+                const auto old_size = this->message.size();
+                this->message.resize(old_size + take);
+                target = this->message.data() + old_size;
+            }
+            memcpy(target, data, take);
+            apply_mask(target, take, this->mask, this->frame_offset);
+            this->frame_offset += take;
+            this->remaining -= take;
+            data += take;
+            size -= take;
+            if (this->remaining == 0) {
+                this->end_frame(handler);
+            }
+        }
+        return true;
+    }
+
+    bool FrameParser::begin_frame() {
+        const auto b0 = this->header[0];
+        const auto b1 = this->header[1];
+        this->fin = (b0 & 0x80) != 0;
+        this->opcode = (Opcode) (b0 & 0x0F);
+        const bool rsv1 = (b0 & 0x40) != 0;
+
+        // everything a client sends is masked
+        if ((b0 & 0x30) || !(b1 & 0x80)) {
+            return this->fail(CLOSE_PROTOCOL_ERROR);
+        }
+
+        // payload length
+        uint64_t length = b1 & 0x7F;
+        size_t pos = 2;
+        if (length == 126) {
+            length = (uint64_t) this->header[2] << 8 | this->header[3];
+            pos = 4;
+        } else if (length == 127) {
+            length = 0;
+            for (int i = 0; i < 8; i++) {
+                length = length << 8 | this->header[2 + i];
+            }
+            pos = 10;
+            if (length >> 63) {
+                return this->fail(CLOSE_PROTOCOL_ERROR);
+            }
+        }
+        memcpy(this->mask, this->header + pos, 4);
+
+        switch (this->opcode) {
+            case Opcode::Close:
+            case Opcode::Ping:
+            case Opcode::Pong:
+                if (!this->fin || rsv1 || length > sizeof(this->control)) {
+                    return this->fail(CLOSE_PROTOCOL_ERROR);
+                }
+                this->control_size = 0;
+                break;
+            case Opcode::Text:
+            case Opcode::Binary:
+                if (this->in_message || (rsv1 && !this->deflate)) {
+                    return this->fail(CLOSE_PROTOCOL_ERROR);
+                }
+                this->in_message = true;
+                this->message_opcode = this->opcode;
+                this->message_compressed = rsv1;
+                this->message.clear();
+                break;
+            case Opcode::Continuation:
+                if (!this->in_message || rsv1) {
+                    return this->fail(CLOSE_PROTOCOL_ERROR);
+                }
+                break;
+            default:
+                return this->fail(CLOSE_PROTOCOL_ERROR);
+        }
+
+        // data frames add up to a message which has its limit
+        if (!((uint8_t) this->opcode & 0x8)) {
+            if (length > this->message_limit - this->message.size()) {
+                return this->fail(CLOSE_TOO_BIG);
+            }
+            this->message.reserve(this->message.size() + (size_t) length);
+        }
+
+        this->remaining = length;
+        this->frame_offset = 0;
+        return true;
+    }
+
+    void FrameParser::end_frame(Handler &handler) {
+        this->state = State::Header;
+        this->header_size = 0;
+        if ((uint8_t) this->opcode & 0x8) {
+            handler.on_control(this->opcode, this->control, this->control_size);
+        } else if (this->fin) {
+            this->in_message = false;
+            handler.on_message(this->message_opcode, this->message, this->message_compressed);
+            this->message.clear();
+        }
+    }
+
+    SharedFrame make_frame(Opcode opcode, std::vector<uint8_t> payload, int deflate_window_bits) {
+        auto frame = std::make_shared<OutFrame>();
+        bool compressed = false;
+        if (deflate_window_bits) {
+
+            // messages are compressed one by one, keep the result only when it is smaller
+            std::vector<uint8_t> deflated;
+            deflate_message(payload.data(), payload.size(), deflate_window_bits, deflated);
+            if (deflated.size() < payload.size()) {
+                payload = std::move(deflated);
+                compressed = true;
+            }
+        }
+        frame->header_size = (uint8_t) write_frame_header(frame->header, opcode, payload.size(), compressed);
+        frame->payload = std::move(payload);
+        return frame;
+    }
+
+    /*
+     * SendQueue
+     */
+
+    void SendQueue::push(SharedFrame frame) {
+        this->queued += frame->header_size + frame->payload.size();
+        this->frames.push_back(std::move(frame));
+    }
+
+    size_t SendQueue::gather(SendSpan *spans, size_t max) const {
+        size_t count = 0;
+        size_t skip = this->offset;
+        for (auto &frame : this->frames) {
+            if (count + 2 > max) {
+                break;
+            }
+            if (skip < frame->header_size) {
+                spans[count++] = { frame->header + skip, frame->header_size - skip };
+                skip = 0;
+            } else {
+                skip -= frame->header_size;
+            }
+            if (skip < frame->payload.size()) {
+                spans[count++] = { frame->payload.data() + skip, frame->payload.size() - skip };
+            }
+            skip = 0;
+        }
+        return count;
+    }
+
+    void SendQueue::consume(size_t bytes) {
+        this->queued -= bytes;
+        while (bytes > 0) {
+            auto &frame = this->frames.front();
+            const auto left = frame->header_size + frame->payload.size() - this->offset;
+            if (bytes < left) {
+                this->offset += bytes;
+                return;
+            }
+            bytes -= left;
+            this->offset = 0;
+            this->frames.pop_front();
+        }
+    }
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * WebSocket protocol pieces (RFC 6455, permessage-deflate from RFC 7692), kept apart from
+ * sockets and threads. Everything parses incrementally: feed it whatever recv() returned, no
+ * matter where the boundaries fall, and it picks up where it left off.
+ * No Windows dependencies, so it runs and benchmarks anywhere.
+ */
+namespace api::ws {
+
+    enum class Opcode : uint8_t {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA,
+    };
+
+    // close codes
+    constexpr uint16_t CLOSE_NORMAL = 1000;
+    constexpr uint16_t CLOSE_GOING_AWAY = 1001;
+    constexpr uint16_t CLOSE_PROTOCOL_ERROR = 1002;
+    constexpr uint16_t CLOSE_INVALID_DATA = 1007;
+    constexpr uint16_t CLOSE_TOO_BIG = 1009;
+
+    // largest header of a frame we send; server frames are never masked
+    constexpr size_t FRAME_HEADER_MAX = 10;
+
+    // what the client asked for and we agreed to
+    struct Handshake {
+        std::string path;
+        std::string key;
+        bool deflate = false;
+
+        // largest LZ77 window the client lets us use, from server_max_window_bits
+        int deflate_window_bits = 15;
+    };
+
+    class HandshakeParser {
+    public:
+        enum class Result {
+            Incomplete,
+            Done,
+            Failed,
+        };
+
+        explicit HandshakeParser(size_t size_limit = 8 * 1024) : size_limit(size_limit) {
+        }
+
+        /*
+         * Feeds received bytes. `consumed` tells how many belonged to the request, anything
+         * after it is already WebSocket data and has to go to the frame parser.
+         */
+        Result push(const char *data, size_t size, size_t &consumed);
+
+        // valid once push() returned Done
+        const Handshake &handshake() const {
+            return this->result;
+        }
+
+        // the 101 response accepting the request, with or without compression
+        std::string response(bool deflate) const;
+
+        // what to answer a request we refuse
+        static std::string reject_response();
+
+    private:
+        size_t size_limit;
+        std::string head;
+        Handshake result;
+
+        bool parse();
+    };
+
+    // Sec-WebSocket-Accept for a Sec-WebSocket-Key
+    std::string accept_key(const std::string &key);
+
+    /*
+     * Writes the header of an unmasked frame with a `size` bytes payload, returns its length.
+     * `compressed` sets RSV1, which marks the first frame of a deflated message.
+     */
+    size_t write_frame_header(uint8_t *out, Opcode opcode, size_t size, bool compressed = false, bool fin = true);
+
+    // applies a frame mask starting at payload offset `offset`, the same operation both ways
+    void apply_mask(uint8_t *data, size_t size, const uint8_t mask[4], size_t offset);
+
+    class FrameParser {
+    public:
+
+        struct Handler {
+            virtual ~Handler() = default;
+
+            // a complete message, the parser no longer needs `payload` and it may be moved out
+            virtual void on_message(Opcode opcode, std::vector<uint8_t> &payload, bool compressed) = 0;
+
+            // ping, pong or close; may arrive between the frames of a fragmented message
+            virtual void on_control(Opcode opcode, const uint8_t *payload, size_t size) = 0;
+        };
+
+        explicit FrameParser(size_t message_limit) : message_limit(message_limit) {
+        }
+
+        // whether RSV1 is allowed on messages, only after permessage-deflate got negotiated
+        void set_deflate(bool deflate) {
+            this->deflate = deflate;
+        }
+
+        /*
+         * Feeds received bytes, calling the handler for everything completed by them.
+         * Returns false on a protocol violation, the connection is unusable from then on and
+         * error() holds the close code to send.
+         */
+        bool push(const uint8_t *data, size_t size, Handler &handler);
+
+        uint16_t error() const {
+            return this->error_code;
+        }
+
+    private:
+        enum class State {
+            Header,
+            Payload,
+        };
+
+        size_t message_limit;
+        bool deflate = false;
+        uint16_t error_code = 0;
+
+        // current frame
+        State state = State::Header;
+        uint8_t header[14] {};
+        size_t header_size = 0;
+        Opcode opcode = Opcode::Continuation;
+        bool fin = false;
+        uint8_t mask[4] {};
+        uint64_t remaining = 0;
+        size_t frame_offset = 0;
+
+        // message being put together from data frames
+        std::vector<uint8_t> message;
+        Opcode message_opcode = Opcode::Continuation;
+        bool message_compressed = false;
+        bool in_message = false;
+
+        // control frames are at most 125 bytes but may still be split over several reads
+        uint8_t control[125] {};
+        size_t control_size = 0;
+
+        bool fail(uint16_t code) {
+            this->error_code = code;
+            return false;
+        }
+
+        size_t header_needed() const;
+        bool begin_frame();
+        void end_frame(Handler &handler);
+    };
+
+    /*
+     * A frame ready to go out. Header and payload are kept apart so the payload never gets
+     * copied, and the whole frame is immutable so one instance can be queued to any number of
+     * clients at once.
+     */
+    struct OutFrame {
+        uint8_t header[FRAME_HEADER_MAX] {};
+        uint8_t header_size = 0;
+        std::vector<uint8_t> payload;
+    };
+    using SharedFrame = std::shared_ptr<const OutFrame>;
+
+    // builds a frame, compressing the payload when `deflate_window_bits` is not zero
+    SharedFrame make_frame(Opcode opcode, std::vector<uint8_t> payload, int deflate_window_bits = 0);
+
+    struct SendSpan {
+        const void *data;
+        size_t size;
+    };
+
+    /*
+     * Outgoing frames of a client, sent in order. gather() lays the unsent bytes out for a
+     * single vectored send, consume() drops what the socket took.
+     */
+    class SendQueue {
+    public:
+
+        void push(SharedFrame frame);
+
+        // fills up to `max` spans, returns how many
+        size_t gather(SendSpan *spans, size_t max) const;
+
+        void consume(size_t bytes);
+
+        size_t bytes() const {
+            return this->queued;
+        }
+
+        bool empty() const {
+            return this->frames.empty();
+        }
+
+        void clear() {
+            this->frames.clear();
+            this->offset = 0;
+            this->queued = 0;
+        }
+
+    private:
+        std::deque<SharedFrame> frames;
+
+        // bytes of the first frame already sent, header included
+        size_t offset = 0;
+        size_t queued = 0;
+    };
+}
@@ -0,0 +1,767 @@
+#ifdef _WIN32
+
+// select() takes at most FD_SETSIZE sockets, the default of 64 leaves little room for clients
+#define FD_SETSIZE 256
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#else
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#endif
+
+#include "websocket_server.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "websocket_deflate.h"
+
+namespace api::ws {
+
+    namespace {
+
+        using clock = std::chrono::steady_clock;
+
+        // frames gathered into a single vectored send, header and payload take one span each
+        constexpr size_t SEND_SPANS_MAX = 64;
+
+        constexpr size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+
+        // reads per client and wakeup, so one busy client cannot starve the others
+        constexpr int RECEIVE_ROUNDS_MAX = 4;
+
+#ifdef _WIN32
+        using socket_t = SOCKET;
+        constexpr socket_t NO_SOCKET = INVALID_SOCKET;
+
+        bool would_block() {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+
+        void close_socket(socket_t socket) {
+            closesocket(socket);
+        }
+
+        bool set_nonblocking(socket_t socket) {
+            u_long enable = 1;
+            return ioctlsocket(socket, FIONBIO, &enable) == 0;
+        }
+
+        long send_spans(socket_t socket, const SendSpan *spans, size_t count) {
+            WSABUF buffers[SEND_SPANS_MAX];
+            for (size_t i = 0; i < count; i++) {
+                buffers[i].buf = (char *) spans[i].data;
+                buffers[i].len = (ULONG) spans[i].size;
+            }
+            DWORD sent = 0;
+            if (WSASend(socket, buffers, (DWORD) count, &sent, 0, nullptr, nullptr) != 0) {
+                return -1;
+            }
+            return (long) sent;
+        }
+#else
+        using socket_t = int;
+        constexpr socket_t NO_SOCKET = -1;
+
+        bool would_block() {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+
+        void close_socket(socket_t socket) {
+            ::close(socket);
+        }
+
+        bool set_nonblocking(socket_t socket) {
+            const auto flags = fcntl(socket, F_GETFL, 0);
+            return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+        }
+
+        long send_spans(socket_t socket, const SendSpan *spans, size_t count) {
+            iovec buffers[SEND_SPANS_MAX];
+            for (size_t i = 0; i < count; i++) {
+                buffers[i].iov_base = const_cast<void *>(spans[i].data);
+                buffers[i].iov_len = spans[i].size;
+            }
+            msghdr message {};
+            message.msg_iov = buffers;
+            message.msg_iovlen = count;
+            return (long) sendmsg(socket, &message, MSG_NOSIGNAL);
+        }
+#endif
+
+        // frames not coming from a worker's message, like handshake answers, go out raw
+        SharedFrame make_raw(const std::string &text) {
+            auto frame = std::make_shared<OutFrame>();
+            frame->payload.assign(text.begin(), text.end());
+            return frame;
+        }
+
+        SharedFrame make_close(uint16_t code) {
+            return make_frame(Opcode::Close, { (uint8_t) (code >> 8), (uint8_t) code });
+        }
+    }
+
+    struct Server::Platform {
+        socket_t listener = NO_SOCKET;
+
+        // loopback UDP socket connected to itself, a datagram on it ends the select() early
+        socket_t wake_socket = NO_SOCKET;
+
+        std::vector<uint8_t> buffer = std::vector<uint8_t>(RECEIVE_BUFFER_SIZE);
+        bool wsa_started = false;
+    };
+
+    struct Server::Client : FrameParser::Handler {
+        Server &server;
+        ClientId id;
+        socket_t socket;
+        std::string address;
+        clock::time_point handshake_deadline;
+
+        HandshakeParser handshake;
+        FrameParser frames;
+        SendQueue queue;
+        int deflate_bits = 0;
+
+        // received messages waiting for a worker
+        std::deque<std::pair<Opcode, std::vector<uint8_t>>> inbox;
+
+        // what came after the handshake in the same read, fed to the frame parser after on_open
+        std::vector<uint8_t> early_data;
+
+        bool open = false;
+
+        // a close frame or the handshake rejection is queued, the socket goes once it is sent
+        bool closing = false;
+
+        // the send queue ran past the hard limit, or sending from outside the I/O thread failed
+        bool overflow = false;
+        bool broken = false;
+
+        // socket closed, waiting for the worker to let go
+        bool dead = false;
+
+        // queued for or handled by a worker
+        bool busy = false;
+
+        Client(Server &server, ClientId id, socket_t socket, std::string address)
+                : server(server), id(id), socket(socket), address(std::move(address)),
+                  frames(server.config.message_limit) {
+            this->handshake_deadline = clock::now()
+                    + std::chrono::milliseconds(server.config.handshake_timeout_ms);
+        }
+
+        void fail(uint16_t code) {
+            if (!this->closing) {
+                this->closing = true;
+                this->server.queue_frame(*this, make_close(code));
+            }
+        }
+
+        void on_message(Opcode opcode, std::vector<uint8_t> &payload, bool compressed) override {
+            if (this->closing) {
+                return;
+            }
+            if (compressed) {
+                std::vector<uint8_t> inflated;
+                if (!inflate_message(payload.data(), payload.size(), this->server.config.message_limit, inflated)) {
+                    this->fail(CLOSE_INVALID_DATA);
+                    return;
+                }
+                payload = std::move(inflated);
+            }
+            this->inbox.emplace_back(opcode, std::move(payload));
+            this->server.stats_.messages_in++;
+        }
+
+        void on_control(Opcode opcode, const uint8_t *payload, size_t size) override {
+            if (this->closing) {
+                return;
+            }
+            switch (opcode) {
+                case Opcode::Ping:
+                    this->server.queue_frame(*this, make_frame(
+                            Opcode::Pong, std::vector<uint8_t>(payload, payload + size)));
+                    break;
+                case Opcode::Close:
+
+                    // answer with the same code, then hang up
+                    this->server.queue_frame(*this, make_frame(
+                            Opcode::Close, std::vector<uint8_t>(payload, payload + std::min<size_t>(size, 2))));
+                    this->closing = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+    };
+
+    Server::Server(ServerConfig config, ServerHandler &handler)
+            : config(config), handler(handler), platform(std::make_unique<Platform>()) {
+
+        // the listener and the wake socket share the set with the clients
+        this->config.client_limit = std::min<size_t>(this->config.client_limit, FD_SETSIZE - 2);
+        this->config.worker_count = std::max<size_t>(this->config.worker_count, 1);
+        this->config.inbox_limit = std::max<size_t>(this->config.inbox_limit, 1);
+    }
+
+    Server::~Server() {
+        this->stop();
+    }
+
+    bool Server::start() {
+        if (this->running) {
+            return true;
+        }
+        auto &p = *this->platform;
+
+#ifdef _WIN32
+        WSADATA wsa_data {};
+        if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+            return false;
+        }
+        p.wsa_started = true;
+#endif
+
+        // listener
+        p.listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (p.listener == NO_SOCKET) {
+            this->stop();
+            return false;
+        }
+#ifndef _WIN32
+        int reuse = 1;
+        setsockopt(p.listener, SOL_SOCKET, SO_REUSEADDR, (const char *) &reuse, sizeof(reuse));
+#endif
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(this->config.port);
+        socklen_t address_size = sizeof(address);
+        if (bind(p.listener, (sockaddr *) &address, sizeof(address)) != 0
+                || listen(p.listener, SOMAXCONN) != 0
+                || !set_nonblocking(p.listener)
+                || getsockname(p.listener, (sockaddr *) &address, &address_size) != 0) {
+            this->stop();
+            return false;
+        }
+        this->bound_port = ntohs(address.sin_port);
+
+        // wake socket
+        sockaddr_in loopback {};
+        loopback.sin_family = AF_INET;
+        loopback.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t loopback_size = sizeof(loopback);
+        p.wake_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (p.wake_socket == NO_SOCKET
+                || bind(p.wake_socket, (sockaddr *) &loopback, sizeof(loopback)) != 0
+                || getsockname(p.wake_socket, (sockaddr *) &loopback, &loopback_size) != 0
+                || connect(p.wake_socket, (sockaddr *) &loopback, sizeof(loopback)) != 0
+                || !set_nonblocking(p.wake_socket)) {
+            this->stop();
+            return false;
+        }
+
+        // threads
+        this->running = true;
+        this->io_thread = std::thread([this] { this->io_run(); });
+        for (size_t i = 0; i < this->config.worker_count; i++) {
+            this->workers.emplace_back([this] { this->worker_run(); });
+        }
+        return true;
+    }
+
+    void Server::stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->running = false;
+            this->wake();
+        }
+        this->work_cv.notify_all();
+        for (auto &worker : this->workers) {
+            worker.join();
+        }
+        this->workers.clear();
+        if (this->io_thread.joinable()) {
+            this->io_thread.join();
+        }
+
+        // nothing else runs anymore
+        for (auto &[id, client] : this->clients) {
+            if (!client->dead) {
+                close_socket(client->socket);
+            }
+            if (client->open) {
+                this->handler.on_close(id, client->address);
+            }
+        }
+        this->clients.clear();
+        this->ready.clear();
+
+        auto &p = *this->platform;
+        if (p.listener != NO_SOCKET) {
+            close_socket(p.listener);
+            p.listener = NO_SOCKET;
+        }
+        if (p.wake_socket != NO_SOCKET) {
+            close_socket(p.wake_socket);
+            p.wake_socket = NO_SOCKET;
+        }
+#ifdef _WIN32
+        if (p.wsa_started) {
+            WSACleanup();
+            p.wsa_started = false;
+        }
+#endif
+    }
+
+    bool Server::send(ClientId client_id, Opcode opcode, std::vector<uint8_t> payload) {
+
+        // look up whether to compress, then do it without holding up everyone else
+        int deflate_bits;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            auto it = this->clients.find(client_id);
+            if (it == this->clients.end() || !it->second->open || it->second->closing || it->second->dead) {
+                return false;
+            }
+            deflate_bits = payload.size() >= this->config.deflate_min_size ? it->second->deflate_bits : 0;
+        }
+        auto frame = make_frame(opcode, std::move(payload), deflate_bits);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->clients.find(client_id);
+        if (it == this->clients.end() || it->second->closing || it->second->dead) {
+            return false;
+        }
+        this->queue_frame(*it->second, std::move(frame), true);
+        return true;
+    }
+
+    size_t Server::broadcast(Opcode opcode, std::vector<uint8_t> payload) {
+
+        // the smallest window any client allows works for all of them
+        int deflate_bits = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            for (auto &[id, client] : this->clients) {
+                if (client->open && client->deflate_bits
+                        && (deflate_bits == 0 || client->deflate_bits < deflate_bits)) {
+                    deflate_bits = client->deflate_bits;
+                }
+            }
+        }
+
+        // one frame per variant, shared by everyone getting it. a plain frame is fine for
+        // clients with compression too, which covers those connecting meanwhile
+        SharedFrame deflated;
+        if (deflate_bits && payload.size() >= this->config.deflate_min_size) {
+            deflated = make_frame(opcode, payload, deflate_bits);
+            if (!(deflated->header[0] & 0x40)) {
+                deflated.reset();
+            }
+        }
+        auto plain = make_frame(opcode, std::move(payload));
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        size_t count = 0;
+        for (auto &[id, client] : this->clients) {
+            if (!client->open || client->closing || client->dead) {
+                continue;
+            }
+            this->queue_frame(*client, client->deflate_bits && deflated ? deflated : plain);
+            count++;
+        }
+        return count;
+    }
+
+    void Server::close(ClientId client_id, uint16_t code) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->clients.find(client_id);
+        if (it != this->clients.end() && it->second->open && !it->second->dead) {
+            it->second->fail(code);
+        }
+    }
+
+    Server::Stats Server::stats() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->stats_;
+    }
+
+    void Server::wake() {
+
+        // called with the mutex held or after the threads stopped, one datagram is enough
+        if (this->wake_pending || this->platform->wake_socket == NO_SOCKET) {
+            return;
+        }
+        if (std::this_thread::get_id() == this->io_thread.get_id()) {
+            return;
+        }
+        this->wake_pending = true;
+        const char byte = 0;
+        ::send(this->platform->wake_socket, &byte, 1, 0);
+    }
+
+    void Server::queue_frame(Client &client, SharedFrame frame, bool direct) {
+        const auto was_empty = client.queue.empty();
+        client.queue.push(std::move(frame));
+        this->stats_.messages_out++;
+
+        // past the hard limit the client is not worth waiting for anymore
+        if (client.queue.bytes() > this->config.drop_bytes) {
+            if (!client.overflow) {
+                client.overflow = true;
+                this->wake();
+            }
+            return;
+        }
+
+        if (!was_empty) {
+            return;
+        }
+
+        // an answer to the last request of a client goes out right away from the worker, which
+        // saves the round through the I/O thread; with more requests waiting the I/O thread
+        // sends all answers together. whatever the socket does not take is left to it as well
+        if (direct && client.inbox.empty() && !client.dead
+                && std::this_thread::get_id() != this->io_thread.get_id()) {
+            client.broken = !this->flush(client);
+            if (client.queue.empty() && !client.broken && !client.closing) {
+                return;
+            }
+        }
+        this->wake();
+    }
+
+    bool Server::receive(Client &client) {
+        auto &buffer = this->platform->buffer;
+        for (int round = 0; round < RECEIVE_ROUNDS_MAX && !client.closing; round++) {
+            const auto received = recv(client.socket, (char *) buffer.data(), (int) buffer.size(), 0);
+            if (received == 0) {
+                return false;
+            }
+            if (received < 0) {
+                return would_block();
+            }
+
+            // the handshake may end anywhere in the read, the rest is frames
+            if (!client.open) {
+                size_t consumed = 0;
+                switch (client.handshake.push((const char *) buffer.data(), (size_t) received, consumed)) {
+                    case HandshakeParser::Result::Incomplete:
+                        continue;
+                    case HandshakeParser::Result::Failed:
+                        this->queue_frame(client, make_raw(HandshakeParser::reject_response()));
+                        client.closing = true;
+                        return true;
+                    case HandshakeParser::Result::Done: {
+                        const auto &handshake = client.handshake.handshake();
+                        const auto deflate = this->config.deflate && handshake.deflate;
+                        client.deflate_bits = deflate ? handshake.deflate_window_bits : 0;
+                        client.frames.set_deflate(deflate);
+                        this->queue_frame(client, make_raw(client.handshake.response(deflate)));
+                        client.open = true;
+                        client.early_data.assign(buffer.data() + consumed, buffer.data() + received);
+
+                        // the handler learns about the client before any of its messages
+                        return true;
+                    }
+                }
+            }
+
+            this->handle_frames(client, buffer.data(), (size_t) received);
+            if ((size_t) received < buffer.size()) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    void Server::handle_frames(Client &client, const uint8_t *data, size_t size) {
+        if (!client.frames.push(data, size, client)) {
+            client.fail(client.frames.error());
+        }
+    }
+
+    void Server::dispatch(Client &client, std::unique_lock<std::mutex> &lock) {
+        if (client.busy || client.dead || client.inbox.empty()) {
+            return;
+        }
+        client.busy = true;
+
+        // the only client with a single request waiting gets its answer right here, a worker
+        // would only add two thread hops to the round trip. nobody else is there to be held up
+        // by a slow request, and the client's own requests are answered in order anyway
+        if (this->clients.size() == 1 && client.inbox.size() == 1 && !client.closing) {
+            auto [opcode, message] = std::move(client.inbox.front());
+            client.inbox.pop_front();
+            lock.unlock();
+            this->handler.on_message(client.id, opcode, message);
+            lock.lock();
+            if (client.inbox.empty()) {
+                client.busy = false;
+                return;
+            }
+        }
+
+        this->ready.push_back(&client);
+        this->work_cv.notify_one();
+    }
+
+    bool Server::flush(Client &client) {
+        SendSpan spans[SEND_SPANS_MAX];
+        while (!client.queue.empty()) {
+            const auto count = client.queue.gather(spans, SEND_SPANS_MAX);
+            const auto sent = send_spans(client.socket, spans, count);
+            if (sent < 0) {
+                return would_block();
+            }
+            this->stats_.send_calls++;
+            this->stats_.bytes_out += (uint64_t) sent;
+            client.queue.consume((size_t) sent);
+        }
+        return true;
+    }
+
+    void Server::drop(Client &client, std::vector<std::pair<ClientId, std::string>> &closed) {
+        if (!client.dead) {
+            close_socket(client.socket);
+            client.dead = true;
+        }
+        client.queue.clear();
+        client.inbox.clear();
+
+        // a worker still holding the client finishes the job once it is done
+        if (!client.busy) {
+            if (client.open) {
+                closed.emplace_back(client.id, client.address);
+            }
+            this->clients.erase(client.id);
+        }
+    }
+
+    void Server::io_run() {
+        auto &p = *this->platform;
+        std::vector<Client *> opened;
+        std::vector<Client *> dropping;
+        std::vector<std::pair<ClientId, std::string>> closed;
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (this->running) {
+
+            // what to wait for
+            fd_set read_set, write_set;
+            FD_ZERO(&read_set);
+            FD_ZERO(&write_set);
+            FD_SET(p.wake_socket, &read_set);
+            auto max_socket = p.wake_socket;
+            if (this->clients.size() < this->config.client_limit) {
+                FD_SET(p.listener, &read_set);
+                max_socket = std::max(max_socket, p.listener);
+            }
+            auto now = clock::now();
+            auto timeout = std::chrono::milliseconds(1000);
+            for (auto &[id, client] : this->clients) {
+                if (client->dead) {
+                    continue;
+                }
+
+                // slow readers stop getting their requests read until their answers went out
+                const auto readable = !client->closing && (!client->open
+                        || (client->queue.bytes() < this->config.backpressure_bytes
+                        && client->inbox.size() < this->config.inbox_limit));
+                if (readable) {
+                    FD_SET(client->socket, &read_set);
+                }
+                if (!client->queue.empty()) {
+                    FD_SET(client->socket, &write_set);
+                }
+                max_socket = std::max(max_socket, client->socket);
+                if (!client->open) {
+                    timeout = std::min(timeout, std::max(std::chrono::milliseconds(0),
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    client->handshake_deadline - now)));
+                }
+            }
+
+            lock.unlock();
+            timeval tv {};
+            tv.tv_sec = (long) (timeout.count() / 1000);
+            tv.tv_usec = (long) (timeout.count() % 1000 * 1000);
+            const auto ready_count = select((int) max_socket + 1, &read_set, &write_set, nullptr, &tv);
+            lock.lock();
+            if (!this->running) {
+                break;
+            }
+            if (ready_count < 0) {
+                FD_ZERO(&read_set);
+                FD_ZERO(&write_set);
+            }
+
+            // wakeups only exist to end the select()
+            if (FD_ISSET(p.wake_socket, &read_set)) {
+                char drain[64];
+                while (recv(p.wake_socket, drain, sizeof(drain), 0) > 0) {
+                }
+            }
+            this->wake_pending = false;
+
+            // new connections
+            if (FD_ISSET(p.listener, &read_set)) {
+                while (this->clients.size() < this->config.client_limit) {
+                    sockaddr_in address {};
+                    socklen_t address_size = sizeof(address);
+                    const auto socket = accept(p.listener, (sockaddr *) &address, &address_size);
+                    if (socket == NO_SOCKET) {
+                        break;
+                    }
+#ifndef _WIN32
+                    if (socket >= FD_SETSIZE) {
+                        close_socket(socket);
+                        continue;
+                    }
+#endif
+                    int no_delay = 1;
+                    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char *) &no_delay, sizeof(no_delay));
+                    if (!set_nonblocking(socket)) {
+                        close_socket(socket);
+                        continue;
+                    }
+                    char address_text[INET_ADDRSTRLEN] {};
+                    inet_ntop(AF_INET, &address.sin_addr, address_text, sizeof(address_text));
+                    const auto id = this->next_id++;
+                    this->clients.emplace(id, std::make_unique<Client>(*this, id, socket, address_text));
+                }
+            }
+
+            // reads first, then send whatever is queued right away; a socket that is not
+            // writable just says so, which is cheaper than another round through select()
+            now = clock::now();
+            for (auto &[id, client_ptr] : this->clients) {
+                auto &client = *client_ptr;
+                if (client.dead) {
+                    continue;
+                }
+                if (FD_ISSET(client.socket, &read_set)) {
+                    const auto was_open = client.open;
+                    if (!this->receive(client)) {
+                        dropping.push_back(&client);
+                        continue;
+                    }
+                    if (!was_open && client.open) {
+                        opened.push_back(&client);
+                    }
+                    this->dispatch(client, lock);
+                }
+                if (client.overflow || client.broken) {
+                    this->stats_.clients_dropped += client.overflow ? 1 : 0;
+                    dropping.push_back(&client);
+                    continue;
+                }
+                if (!this->flush(client)
+                        || (client.closing && client.queue.empty())
+                        || (!client.open && now > client.handshake_deadline)) {
+                    dropping.push_back(&client);
+                }
+            }
+
+            // new clients meet the handler, then their first frames get parsed
+            if (!opened.empty()) {
+                lock.unlock();
+                for (auto client : opened) {
+                    this->handler.on_open(client->id, client->address);
+                }
+                lock.lock();
+                for (auto client : opened) {
+                    if (std::find(dropping.begin(), dropping.end(), client) != dropping.end()) {
+                        continue;
+                    }
+                    if (!client->early_data.empty()) {
+                        this->handle_frames(*client, client->early_data.data(), client->early_data.size());
+                        client->early_data.clear();
+                        client->early_data.shrink_to_fit();
+                        this->dispatch(*client, lock);
+                    }
+                    if (!this->flush(*client)) {
+                        dropping.push_back(client);
+                    }
+                }
+                opened.clear();
+            }
+
+            for (auto client : dropping) {
+                this->drop(*client, closed);
+            }
+            dropping.clear();
+            if (!closed.empty()) {
+                lock.unlock();
+                for (auto &[id, address] : closed) {
+                    this->handler.on_close(id, address);
+                }
+                lock.lock();
+                closed.clear();
+            }
+        }
+
+        // say goodbye to whoever can still take it
+        for (auto &[id, client] : this->clients) {
+            if (client->open && !client->dead && !client->closing) {
+                this->queue_frame(*client, make_close(CLOSE_GOING_AWAY));
+                this->flush(*client);
+            }
+        }
+    }
+
+    void Server::worker_run() {
+        std::vector<std::pair<ClientId, std::string>> closed;
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (true) {
+            this->work_cv.wait(lock, [this] {
+                return !this->running || !this->ready.empty();
+            });
+            if (!this->running) {
+                break;
+            }
+
+            // one message per turn, clients with more go to the back of the line
+            auto client = this->ready.front();
+            this->ready.pop_front();
+            if (!client->dead && !client->inbox.empty()) {
+                if (client->inbox.size() >= this->config.inbox_limit) {
+                    this->wake();
+                }
+                auto [opcode, message] = std::move(client->inbox.front());
+                client->inbox.pop_front();
+                lock.unlock();
+                this->handler.on_message(client->id, opcode, message);
+                lock.lock();
+            }
+
+            if (client->dead) {
+                client->busy = false;
+                closed.clear();
+                this->drop(*client, closed);
+                if (!closed.empty()) {
+                    lock.unlock();
+                    this->handler.on_close(closed[0].first, closed[0].second);
+                    lock.lock();
+                }
+            } else if (!client->inbox.empty() && this->running) {
+                this->ready.push_back(client);
+                this->work_cv.notify_one();
+            } else {
+                client->busy = false;
+            }
+        }
+    }
+}
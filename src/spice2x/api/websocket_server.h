@@ -0,0 +1,142 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "websocket_protocol.h"
+
+/*
+ * WebSocket server engine.
+ *
+ * A single I/O thread drives every connection with nonblocking sockets: handshakes and frames
+ * are parsed as bytes come in, and everything queued for a client leaves in one vectored send
+ * per wakeup instead of a send per frame. Messages are handled by a small worker pool, one at a
+ * time and in order per client, so a slow request never stalls the socket of anyone else.
+ * A client that is alone with a single request in flight is answered on the I/O thread instead,
+ * there is no one else to stall and the hops to and from a worker would double its latency.
+ *
+ * Clients that do not keep up get backpressure: past a soft limit of unsent bytes we stop
+ * reading from them, so they cannot pile up more responses, and past a hard limit they get
+ * dropped. Broadcasts are encoded once and the same frame is queued to every client.
+ *
+ * Builds with winsock as well as BSD sockets, so it can be tested and benchmarked anywhere.
+ */
+namespace api::ws {
+
+    using ClientId = uint64_t;
+
+    class ServerHandler {
+    public:
+        virtual ~ServerHandler() = default;
+
+        // handshake completed, called on the I/O thread before any message of the client
+        virtual void on_open(ClientId client, const std::string &address) = 0;
+
+        // called on a worker, or on the I/O thread for a lone request of the only client; calls
+        // for the same client never overlap and keep their order
+        virtual void on_message(ClientId client, Opcode opcode, std::vector<uint8_t> &message) = 0;
+
+        // the connection is gone and on_message is done with it, the ID is not used again
+        virtual void on_close(ClientId client, const std::string &address) = 0;
+    };
+
+    struct ServerConfig {
+        uint16_t port = 0;
+        size_t client_limit = 64;
+        size_t worker_count = 2;
+        size_t message_limit = 4 * 1024 * 1024;
+
+        // unsent bytes past which we stop reading from a client, and past which we drop it
+        size_t backpressure_bytes = 1024 * 1024;
+        size_t drop_bytes = 16 * 1024 * 1024;
+
+        // received messages waiting for a worker past which we stop reading from a client
+        size_t inbox_limit = 64;
+
+        // permessage-deflate for clients offering it, only for messages worth the effort
+        bool deflate = true;
+        size_t deflate_min_size = 512;
+
+        int handshake_timeout_ms = 5000;
+    };
+
+    class Server {
+    public:
+
+        struct Stats {
+            uint64_t messages_in = 0;
+            uint64_t messages_out = 0;
+            uint64_t bytes_out = 0;
+            uint64_t send_calls = 0;
+            uint64_t clients_dropped = 0;
+        };
+
+        Server(ServerConfig config, ServerHandler &handler);
+        ~Server();
+
+        Server(const Server &) = delete;
+        Server &operator=(const Server &) = delete;
+
+        // false when the port could not be bound
+        bool start();
+
+        // closes all connections, calling on_close for each open one
+        void stop();
+
+        // the bound port, useful when the config asked for any (0)
+        uint16_t port() const {
+            return this->bound_port;
+        }
+
+        // queues a message, false when the client is gone. safe from any thread
+        bool send(ClientId client, Opcode opcode, std::vector<uint8_t> payload);
+
+        // queues one message to all open clients, returns to how many
+        size_t broadcast(Opcode opcode, std::vector<uint8_t> payload);
+
+        // starts a close handshake
+        void close(ClientId client, uint16_t code = CLOSE_NORMAL);
+
+        Stats stats() const;
+
+    private:
+        struct Client;
+        struct Platform;
+
+        ServerConfig config;
+        ServerHandler &handler;
+        std::unique_ptr<Platform> platform;
+        uint16_t bound_port = 0;
+
+        mutable std::mutex mutex;
+        std::condition_variable work_cv;
+        std::map<ClientId, std::unique_ptr<Client>> clients;
+        std::deque<Client *> ready;
+        ClientId next_id = 1;
+        Stats stats_;
+        bool running = false;
+        bool wake_pending = false;
+
+        std::thread io_thread;
+        std::vector<std::thread> workers;
+
+        void io_run();
+        void worker_run();
+        void wake();
+
+        // all with the mutex held
+        void queue_frame(Client &client, SharedFrame frame, bool direct = false);
+        bool receive(Client &client);
+        bool flush(Client &client);
+        void handle_frames(Client &client, const uint8_t *data, size_t size);
+        void dispatch(Client &client, std::unique_lock<std::mutex> &lock);
+        void drop(Client &client, std::vector<std::pair<ClientId, std::string>> &closed);
+    };
+}
@@ -1,6 +1,12 @@
 #include "automap.h"
-#include <fstream>
-#include "external/tinyxml2/tinyxml2.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include "automap_dump.h"
 #include "util/logging.h"
 #include "util/detour.h"
 #include "util/utils.h"
@@ -20,9 +26,31 @@ namespace avs::automap {
     bool RESTRICT_NETWORK = false;
     std::string DUMP_FILENAME = "";
 
-    // logging
-    static std::ofstream LOGFILE;
+    /*
+     * Capture pipeline.
+     *
+     * property_destroy runs on whatever game thread drops a property, network threads
+     * included, so the hook only has AVS write the property out and queues the copy. A single
+     * worker appends the records to the dump and renders text for the log hooks, off the game
+     * threads and in capture order.
+     */
+
+    // bytes captured but not yet written; a capture beyond this waits for the worker, which
+    // only happens when the disk cannot keep up at all
+    static constexpr size_t CAPTURE_QUEUE_LIMIT = 32 * 1024 * 1024;
+
+    static std::mutex CAPTURE_QUEUE_M;
+    static std::condition_variable CAPTURE_QUEUE_CV;
+    static std::deque<DumpRecord> CAPTURE_QUEUE;
+    static size_t CAPTURE_QUEUE_BYTES = 0;
+    static bool CAPTURE_WORKER_STARTED = false;
+
+    // dump file and log hooks, owned by the worker and guarded against hook changes
+    static std::mutex OUTPUT_M;
+    static DumpWriter DUMP_WRITER;
+    static bool DUMP_OPEN_FAILED = false;
     static std::vector<std::pair<AutomapHook_t, void*>> HOOKS;
+    static std::atomic<size_t> HOOK_COUNT {0};
 
 
     static bool property_is_network(avs::core::property_ptr prop, avs::core::node_ptr node = nullptr) {
@@ -98,7 +126,7 @@ namespace avs::automap {
         }
 
         // check if dumps are enabled first
-        if (!DUMP && HOOKS.empty()) {
+        if (!DUMP && HOOK_COUNT.load(std::memory_order_relaxed) == 0) {
             return false;
         }
 
@@ -377,89 +405,150 @@ namespace avs::automap {
         return avs::core::property_psmap_export(prop, node, data, psmap);
     }
 
-    avs::core::avs_error_t property_destroy(avs::core::property_ptr prop) {
+    static bool open_dump() {
 
-        // we definitely need a property for this to work
-        if (prop == NULL) {
-            log_warning("automap", "property_destroy called on NULL");
-            return 0;
+        // try filenames with IDs starting at 0, skipping the ones of old XML dumps as well
+        // since converting the new dump writes one
+        for (int i = 0; i < 10000; i++) {
+            std::string path = "automap_" + to_string(i) + ".bin";
+            if (fileutils::file_exists("automap_" + to_string(i) + ".xml")) {
+                continue;
+            }
+            if (DUMP_WRITER.open(path)) {
+                DUMP_FILENAME = path;
+                log_info("automap", "using logfile: {}", path);
+                return true;
+            }
         }
+        return false;
+    }
 
-        // check if dump is enabled
-        if (property_dump_enabled(prop)) {
+    static void write_records(std::vector<DumpRecord> &records) {
+        std::lock_guard<std::mutex> lock(OUTPUT_M);
+        for (auto &record : records) {
+            if (DUMP && !DUMP_WRITER.is_open() && !DUMP_OPEN_FAILED && !open_dump()) {
+                log_warning("automap", "couldn't create a logfile, dumping is disabled");
+                DUMP_OPEN_FAILED = true;
+            }
+            if (DUMP && DUMP_WRITER.is_open() && !DUMP_WRITER.append(record)) {
+                log_warning("automap", "couldn't write property to logfile");
+            }
+            if (!HOOKS.empty()) {
+                auto text = record_to_text(record);
+                for (auto &hook : HOOKS) {
+                    hook.first(hook.second, text.c_str());
+                }
+            }
+        }
+        if (DUMP_WRITER.is_open()) {
+            DUMP_WRITER.flush();
+        }
+    }
 
-            // convert to XML
-            avs::core::property_set_flag(prop, avs::core::PROP_XML, avs::core::PROP_BINARY);
+    static void capture_worker() {
+        std::vector<DumpRecord> records;
+        std::unique_lock<std::mutex> lock(CAPTURE_QUEUE_M);
+        while (true) {
+            CAPTURE_QUEUE_CV.wait(lock, [] { return !CAPTURE_QUEUE.empty(); });
+
+            // take everything queued, one flush covers the whole batch
+            records.clear();
+            while (!CAPTURE_QUEUE.empty()) {
+                records.emplace_back(std::move(CAPTURE_QUEUE.front()));
+                CAPTURE_QUEUE.pop_front();
+            }
+            lock.unlock();
+
+            // an escape from here would end the worker and with it every later capture
+            try {
+                write_records(records);
+            } catch (const std::exception &e) {
+                log_warning("automap", "writing properties failed: {}", e.what());
+            } catch (...) {
+                log_warning("automap", "writing properties failed");
+            }
 
-            // optionally reconvert to JSON
-            if (JSON) {
-                avs::core::property_set_flag(prop, avs::core::PROP_JSON, avs::core::PROP_XML);
+            lock.lock();
+            for (auto &record : records) {
+                CAPTURE_QUEUE_BYTES -= record.data.size();
             }
+            CAPTURE_QUEUE_CV.notify_all();
+        }
+    }
 
-            // query size
-            auto size = avs::core::property_query_size(prop);
-            if (size < 0) {
-                log_warning("automap", "couldn't query property size");
-            } else {
-                log_misc("automap", "writing property to file: {} bytes", size);
-
-                // get XML
-                std::vector<uint8_t> data(size);
-                if (avs::core::property_mem_write(prop, &data[0], data.size()) >= 0) {
-
-                    // initialize log
-                    if (DUMP && !LOGFILE.is_open()) {
-
-                        // try filenames with IDs starting at 0
-                        for (int i = 0; i < 10000 && !LOGFILE.is_open(); i++) {
-                            std::string path = "automap_" + to_string(i) + ".xml";
-
-                            // check if this one is available to use
-                            if (!fileutils::file_exists(path)) {
-
-                                // try creating the file
-                                LOGFILE.open(path, std::ios::out | std::ios::binary);
-                                if (LOGFILE.is_open()) {
-                                    DUMP_FILENAME = path;
-                                    log_info("automap", "using logfile: {}", path);
-                                }
-                            }
-                        }
-                    }
+    static bool property_write(avs::core::property_ptr prop, std::vector<uint8_t> &data) {
+        auto size = avs::core::property_query_size(prop);
+        if (size < 0) {
+            return false;
+        }
+        data.resize(size);
+        auto written = avs::core::property_mem_write(prop, data.data(), data.size());
+        if (written < 0) {
+            return false;
+        }
+        if (written > 0 && (size_t) written < data.size()) {
+            data.resize(written);
+        }
+        return true;
+    }
 
-                    // prettify
-                    tinyxml2::XMLDocument document;
-                    if (!JSON && document.Parse((const char*) &data[0],
-                            data.size()) == tinyxml2::XMLError::XML_SUCCESS) {
+    static void property_capture(avs::core::property_ptr prop) {
+        DumpRecord record;
+        record.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // binary is the cheapest form to get out of AVS, text is left for JSON captures and
+        // for properties AVS cannot write as binary
+        bool captured = false;
+        if (!JSON) {
+            avs::core::property_set_flag(prop, avs::core::PROP_BINARY, avs::core::PROP_JSON);
+            captured = property_write(prop, record.data);
+            record.format = RecordFormat::KBin;
+        }
+        if (!captured) {
+            avs::core::property_set_flag(prop, avs::core::PROP_XML, avs::core::PROP_BINARY);
+            if (JSON) {
+                avs::core::property_set_flag(prop, avs::core::PROP_JSON, avs::core::PROP_XML);
+            }
+            captured = property_write(prop, record.data);
+            record.format = RecordFormat::Text;
+        }
+        if (!captured) {
+            log_warning("automap", "couldn't write property to memory");
+            return;
+        }
 
-                        // write pretty output to log
-                        tinyxml2::XMLPrinter xml_printer;
-                        document.Print(&xml_printer);
-                        for (auto &hook : HOOKS) {
-                            hook.first(hook.second, xml_printer.CStr());
-                        }
-                        if (DUMP && LOGFILE.is_open()) {
-                            LOGFILE << xml_printer.CStr() << std::endl;
-                        }
+        // queue
+        const size_t size = record.data.size();
+        std::unique_lock<std::mutex> lock(CAPTURE_QUEUE_M);
+        if (CAPTURE_QUEUE_BYTES > 0 && CAPTURE_QUEUE_BYTES + size > CAPTURE_QUEUE_LIMIT) {
+            log_warning("automap", "{} bytes of properties still being written, waiting", CAPTURE_QUEUE_BYTES);
+            CAPTURE_QUEUE_CV.wait(lock, [size] {
+                return CAPTURE_QUEUE_BYTES == 0 || CAPTURE_QUEUE_BYTES + size <= CAPTURE_QUEUE_LIMIT;
+            });
+        }
+        if (!CAPTURE_WORKER_STARTED) {
+            CAPTURE_WORKER_STARTED = true;
 
-                    } else {
+            // detached, so a batch still being written at exit does not block shutdown
+            std::thread(capture_worker).detach();
+        }
+        CAPTURE_QUEUE.emplace_back(std::move(record));
+        CAPTURE_QUEUE_BYTES += size;
+        CAPTURE_QUEUE_CV.notify_all();
+    }
 
-                        // write avs output to log
-                        for (auto &hook : HOOKS) {
-                            hook.first(hook.second, std::string((const char *) &data[0], data.size()).c_str());
-                        }
-                        if (DUMP && LOGFILE.is_open()) {
-                            LOGFILE << std::string((const char *) &data[0], data.size());
-                        }
-                    }
+    avs::core::avs_error_t property_destroy(avs::core::property_ptr prop) {
 
-                    // flush
-                    LOGFILE.flush();
+        // we definitely need a property for this to work
+        if (prop == NULL) {
+            log_warning("automap", "property_destroy called on NULL");
+            return 0;
+        }
 
-                } else {
-                    log_warning("automap", "couldn't write property to memory");
-                }
-            }
+        // check if dump is enabled
+        if (property_dump_enabled(prop)) {
+            property_capture(prop);
         }
 
         // kill it with fire
@@ -491,11 +580,33 @@ namespace avs::automap {
         ENABLED = false;
     }
 
-    void hook_add(AutomapHook_t hook, void *user) {
+    void hook_add(AutomapHook_t hook, void *user, bool replay) {
+        std::lock_guard<std::mutex> lock(OUTPUT_M);
+
+        // the worker flushes the dump before it lets go of the lock, so the file holds every
+        // record the hook would otherwise miss
+        if (replay && DUMP_WRITER.is_open()) {
+            dump_read(DUMP_FILENAME, [hook, user](const DumpRecord &record) {
+                hook(user, record_to_text(record).c_str());
+            });
+        }
         HOOKS.push_back(std::pair(hook, user));
+        HOOK_COUNT.store(HOOKS.size(), std::memory_order_relaxed);
     }
 
     void hook_remove(AutomapHook_t hook, void *user) {
+        std::lock_guard<std::mutex> lock(OUTPUT_M);
         HOOKS.erase(std::remove(HOOKS.begin(), HOOKS.end(), std::pair(hook, user)), HOOKS.end());
+        HOOK_COUNT.store(HOOKS.size(), std::memory_order_relaxed);
+    }
+
+    bool convert(const std::string &path) {
+        auto out_path = std::filesystem::path(path).replace_extension(".xml").string();
+        if (!dump_convert(path, out_path)) {
+            log_warning("automap", "couldn't convert {} to {}", path, out_path);
+            return false;
+        }
+        log_info("automap", "converted {} to {}", path, out_path);
+        return true;
     }
 }
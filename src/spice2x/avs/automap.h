@@ -14,8 +14,12 @@ namespace avs::automap {
     void enable();
     void disable();
 
-    // log hooks
+    // log hooks, called from the capture worker. with `replay`, a new hook is first fed
+    // everything already in the dump
     typedef void (*AutomapHook_t)(void *user, const char *data);
-    void hook_add(AutomapHook_t hook, void *user);
+    void hook_add(AutomapHook_t hook, void *user, bool replay = false);
     void hook_remove(AutomapHook_t hook, void *user);
+
+    // writes the pretty printed text of a dump next to it, as <name>.xml
+    bool convert(const std::string &path);
 }
@@ -0,0 +1,194 @@
+#include "automap_dump.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "easrv/kbin.h"
+#include "external/tinyxml2/tinyxml2.h"
+
+namespace avs::automap {
+
+    /*
+     * Layout, all integers little endian:
+     *
+     * dump   header: "AUTOMAP\0", u32 version, u32 reserved
+     *        record: u32 size, u8 format, u8[3] reserved, u64 timestamp, `size` bytes of data
+     * index  entry:  u64 record offset, u32 record size, u32 reserved
+     */
+    static const char DUMP_MAGIC[8] = {'A', 'U', 'T', 'O', 'M', 'A', 'P', '\0'};
+    static const uint32_t DUMP_VERSION = 1;
+    static const size_t DUMP_HEADER_SIZE = 16;
+    static const size_t RECORD_HEADER_SIZE = 16;
+    static const size_t INDEX_ENTRY_SIZE = 16;
+
+    static inline void store_le(uint8_t *ptr, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            ptr[i] = (uint8_t) (value >> (i * 8));
+        }
+    }
+
+    static inline uint64_t load_le(const uint8_t *ptr, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++) {
+            value |= (uint64_t) ptr[i] << (i * 8);
+        }
+        return value;
+    }
+
+    std::string dump_index_path(const std::string &path) {
+        return path + ".idx";
+    }
+
+    bool DumpWriter::open(const std::string &path) {
+        const auto index_path = dump_index_path(path);
+        std::error_code error;
+        if (std::filesystem::exists(path, error) || std::filesystem::exists(index_path, error)) {
+            return false;
+        }
+
+        this->dump.open(path, std::ios::out | std::ios::binary);
+        this->index.open(index_path, std::ios::out | std::ios::binary);
+        if (!this->dump.is_open() || !this->index.is_open()) {
+            this->dump.close();
+            this->index.close();
+            return false;
+        }
+
+        uint8_t header[DUMP_HEADER_SIZE] {};
+        memcpy(header, DUMP_MAGIC, sizeof(DUMP_MAGIC));
+        store_le(&header[8], DUMP_VERSION, 4);
+        this->dump.write(reinterpret_cast<const char *>(header), sizeof(header));
+        this->offset = DUMP_HEADER_SIZE;
+        return this->dump.good();
+    }
+
+    bool DumpWriter::append(const DumpRecord &record) {
+        uint8_t header[RECORD_HEADER_SIZE] {};
+        store_le(&header[0], record.data.size(), 4);
+        header[4] = (uint8_t) record.format;
+        store_le(&header[8], record.timestamp, 8);
+        this->dump.write(reinterpret_cast<const char *>(header), sizeof(header));
+        this->dump.write(reinterpret_cast<const char *>(record.data.data()), record.data.size());
+
+        uint8_t entry[INDEX_ENTRY_SIZE] {};
+        store_le(&entry[0], this->offset, 8);
+        store_le(&entry[8], record.data.size(), 4);
+        this->index.write(reinterpret_cast<const char *>(entry), sizeof(entry));
+
+        this->offset += RECORD_HEADER_SIZE + record.data.size();
+        return this->dump.good() && this->index.good();
+    }
+
+    void DumpWriter::flush() {
+
+        // the dump goes first, so the index never points past what is on disk
+        this->dump.flush();
+        this->index.flush();
+    }
+
+    static bool read_record(std::ifstream &file, uint64_t offset, uint64_t file_size, DumpRecord &record) {
+        if (offset + RECORD_HEADER_SIZE > file_size) {
+            return false;
+        }
+        uint8_t header[RECORD_HEADER_SIZE];
+        file.clear();
+        file.seekg((std::streamoff) offset);
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header))) {
+            return false;
+        }
+        const auto size = load_le(&header[0], 4);
+        if (offset + RECORD_HEADER_SIZE + size > file_size) {
+            return false;
+        }
+        record.format = (RecordFormat) header[4];
+        record.timestamp = load_le(&header[8], 8);
+        record.data.resize(size);
+        return size == 0 || (bool) file.read(reinterpret_cast<char *>(record.data.data()), size);
+    }
+
+    bool dump_read(const std::string &path, const std::function<void(const DumpRecord &)> &callback) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.seekg(0, std::ios::end);
+        const auto file_size = (uint64_t) file.tellg();
+        file.seekg(0);
+
+        uint8_t header[DUMP_HEADER_SIZE];
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header))
+                || memcmp(header, DUMP_MAGIC, sizeof(DUMP_MAGIC)) != 0
+                || load_le(&header[8], 4) != DUMP_VERSION) {
+            return false;
+        }
+
+        // indexed records, as long as the index agrees with the dump
+        DumpRecord record;
+        uint64_t next = DUMP_HEADER_SIZE;
+        std::ifstream index(dump_index_path(path), std::ios::in | std::ios::binary);
+        uint8_t entry[INDEX_ENTRY_SIZE];
+        while (index.is_open() && index.read(reinterpret_cast<char *>(entry), sizeof(entry))) {
+            const auto offset = load_le(&entry[0], 8);
+            const auto size = load_le(&entry[8], 4);
+            if (offset != next || !read_record(file, offset, file_size, record) || record.data.size() != size) {
+                break;
+            }
+            callback(record);
+            next = offset + RECORD_HEADER_SIZE + size;
+        }
+
+        // records written after the last index entry made it to disk
+        while (read_record(file, next, file_size, record)) {
+            callback(record);
+            next += RECORD_HEADER_SIZE + record.data.size();
+        }
+        return true;
+    }
+
+    std::string record_to_text(const DumpRecord &record, bool *pretty) {
+        if (pretty) {
+            *pretty = false;
+        }
+
+        if (record.format == RecordFormat::KBin) {
+            kbin::Document doc;
+            if (!kbin::decode(record.data.data(), record.data.size(), doc)) {
+                return "<!-- undecodable property, " + std::to_string(record.data.size()) + " bytes -->\n";
+            }
+            tinyxml2::XMLPrinter xml_printer;
+            kbin::print_xml(doc, xml_printer);
+            if (pretty) {
+                *pretty = true;
+            }
+            return std::string(xml_printer.CStr(), xml_printer.CStrSize() - 1);
+        }
+
+        // text is what AVS wrote, XML unless the capture was done in JSON
+        tinyxml2::XMLDocument document;
+        if (document.Parse(reinterpret_cast<const char *>(record.data.data()), record.data.size())
+                == tinyxml2::XMLError::XML_SUCCESS) {
+            tinyxml2::XMLPrinter xml_printer;
+            document.Print(&xml_printer);
+            if (pretty) {
+                *pretty = true;
+            }
+            return std::string(xml_printer.CStr(), xml_printer.CStrSize() - 1);
+        }
+        return std::string(reinterpret_cast<const char *>(record.data.data()), record.data.size());
+    }
+
+    bool dump_convert(const std::string &path, const std::string &out_path) {
+        std::ofstream out(out_path, std::ios::out | std::ios::binary);
+        if (!out.is_open()) {
+            return false;
+        }
+        bool pretty = false;
+        const bool read = dump_read(path, [&out, &pretty](const DumpRecord &record) {
+            out << record_to_text(record, &pretty);
+            if (pretty) {
+                out << '\n';
+            }
+        });
+        return read && out.good();
+    }
+}
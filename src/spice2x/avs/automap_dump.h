@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Automap dump files.
+ *
+ * A dump is an append-only sequence of captured properties, each behind a small record header,
+ * with a sidecar index next to it that holds the offset and size of every record so a reader
+ * can seek straight to one. Records are written before their index entry, and readers walk the
+ * record headers past the last indexed one, so a dump cut short by a crash stays readable.
+ *
+ * Properties are stored the way AVS wrote them, KBin for regular captures and text for JSON
+ * captures or when AVS could not write binary. Turning a record into the pretty printed text the
+ * log window shows is left to the reader, which keeps it out of the capture path entirely.
+ */
+
+namespace avs::automap {
+
+    enum class RecordFormat : uint8_t {
+        KBin = 0,
+        Text = 1,
+    };
+
+    struct DumpRecord {
+
+        // unix time in milliseconds
+        uint64_t timestamp = 0;
+        RecordFormat format = RecordFormat::KBin;
+        std::vector<uint8_t> data;
+    };
+
+    class DumpWriter {
+    public:
+
+        // creates both files, failing if either exists already
+        bool open(const std::string &path);
+        bool is_open() const {
+            return this->dump.is_open();
+        }
+
+        bool append(const DumpRecord &record);
+        void flush();
+
+    private:
+        std::ofstream dump;
+        std::ofstream index;
+        uint64_t offset = 0;
+    };
+
+    std::string dump_index_path(const std::string &path);
+
+    // calls `callback` for every complete record in order; false when the dump cannot be read
+    bool dump_read(const std::string &path, const std::function<void(const DumpRecord &)> &callback);
+
+    /*
+     * The text shown for a record: pretty printed XML when the record is a property or parses
+     * as XML, the record as it is otherwise. `pretty` tells which of the two it was.
+     */
+    std::string record_to_text(const DumpRecord &record, bool *pretty = nullptr);
+
+    // writes the text of every record to `out_path`, in the layout of the old XML dumps
+    bool dump_convert(const std::string &path, const std::string &out_path);
+}
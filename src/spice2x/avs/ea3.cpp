@@ -530,6 +530,7 @@ namespace avs {
             memcpy(avs::game::DEST, EA3_DEST, 2);
             memcpy(avs::game::SPEC, EA3_SPEC, 2);
             memcpy(avs::game::EXT, EA3_EXT, 11);
+            avs::game::update_identity();
 
             // hook AVS functions
             hooks::avs::init();
@@ -25,22 +25,20 @@ namespace avs {
         char SPEC[2] = {'0', '\x00'};
         char REV[2] = {'0', '\x00'};
         char EXT[11] = {'0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '\x00'};
+        uint32_t MODEL_ID = model_id("000");
+        long EXT_DATECODE = 0;
 
         // handle
         HINSTANCE DLL_INSTANCE;
         std::string DLL_NAME;
 
-        bool is_model(const char *model) {
-            return _stricmp(MODEL, model) == 0;
-        }
-
         bool is_model(const char *model, const char *ext) {
             return is_model(model) && is_ext(ext);
         }
 
         bool is_model(const std::initializer_list<const char *> model_list) {
             for (auto &model : model_list) {
-                if (is_model(model)) {
+                if (MODEL_ID == model_id(model)) {
                     return true;
                 }
             }
@@ -55,8 +53,12 @@ namespace avs {
         bool is_ext(int datecode_min, int datecode_max) {
 
             // range check
-            long datecode = strtol(EXT, NULL, 10);
-            return datecode_min <= datecode && datecode <= datecode_max;
+            return datecode_min <= EXT_DATECODE && EXT_DATECODE <= datecode_max;
+        }
+
+        void update_identity() {
+            MODEL_ID = model_id(MODEL);
+            EXT_DATECODE = strtol(EXT, NULL, 10);
         }
 
         std::string get_identifier() {
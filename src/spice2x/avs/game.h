@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
 #include <string>
 
 #include <windows.h>
 
+#include "model_id.h"
+
 namespace avs {
 
     /*
@@ -23,13 +26,23 @@ namespace avs {
         extern HINSTANCE DLL_INSTANCE;
         extern std::string DLL_NAME;
 
+        // cached copies of MODEL / EXT, must be refreshed via update_identity()
+        extern uint32_t MODEL_ID;
+        extern long EXT_DATECODE;
+
         // helpers
-        bool is_model(const char *model);
+        inline bool is_model(uint32_t id) {
+            return MODEL_ID == id;
+        }
+        inline bool is_model(const char *model) {
+            return is_model(model_id(model));
+        }
         bool is_model(const char *model, const char *ext);
         bool is_model(const std::initializer_list<const char *> model_list);
         bool is_ext(const char *ext);
         bool is_ext(int datecode_min, int datecode_max);
         std::string get_identifier();
+        void update_identity();
 
         // functions
         void load_dll();
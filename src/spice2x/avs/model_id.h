@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace avs::game {
+
+    /*
+     * packed model identity
+     * the three model characters are stored upper case in one integer so checks are a single compare.
+     * No Windows dependencies.
+     */
+    constexpr uint32_t MODEL_ID_INVALID = ~0u;
+
+    constexpr uint32_t model_id(const char *model) {
+        uint32_t id = 0;
+        for (size_t i = 0; i < 4; i++) {
+            char c = model[i];
+            if (c == '\0') {
+                return id;
+            }
+            if (i == 3) {
+                return MODEL_ID_INVALID;
+            }
+            if (c >= 'a' && c <= 'z') {
+                c -= 'a' - 'A';
+            }
+            id |= static_cast<uint32_t>(static_cast<uint8_t>(c)) << (i * 8);
+        }
+        return id;
+    }
+}
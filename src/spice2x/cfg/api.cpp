@@ -1103,9 +1103,11 @@ void GameAPI::Lights::writeLight(rawinput::RawInputManager *manager, rawinput::D
         }
         case rawinput::SEXTET_OUTPUT: {
             if (index < rawinput::SextetDevice::LIGHT_COUNT) {
-                device->sextetInfo->light_state[index] = value > 0;
-                device->sextetInfo->push_light_state();
-                device->output_pending = true;
+                auto new_state = value > 0;
+                if (device->sextetInfo->light_state[index] != new_state) {
+                    device->sextetInfo->light_state[index] = new_state;
+                    device->output_pending = true;
+                }
             } else {
                 log_warning("api", "invalid sextet light index: {}", index);
             }
@@ -1122,8 +1124,9 @@ void GameAPI::Lights::writeLight(rawinput::RawInputManager *manager, rawinput::D
         }
         case rawinput::SMX_STAGE: {
             if (index < rawinput::SmxStageDevice::TOTAL_LIGHT_COUNT) {
-                device->smxstageInfo->SetLightByIndex(index, static_cast<uint8_t>(value*255.f));
-                device->output_pending = true;
+                if (device->smxstageInfo->SetLightByIndex(index, static_cast<uint8_t>(value*255.f))) {
+                    device->output_pending = true;
+                }
             } else {
                 log_warning("api", "invalid smx stage light index: {}", index);
             }
@@ -1131,8 +1134,9 @@ void GameAPI::Lights::writeLight(rawinput::RawInputManager *manager, rawinput::D
         }
         case rawinput::SMX_DEDICAB: {
             if (index < rawinput::SmxDedicabDevice::LIGHTS_COUNT) {
-                device->smxdedicabInfo->SetLightByIndex(index, static_cast<uint8_t>(value * 255.f));
-                device->output_pending = true;
+                if (device->smxdedicabInfo->SetLightByIndex(index, static_cast<uint8_t>(value * 255.f))) {
+                    device->output_pending = true;
+                }
             } else {
                 log_warning("api", "invalid SMX dedicab light index: {}", index);
             }
@@ -1154,6 +1158,11 @@ void GameAPI::Lights::writeLight(rawinput::RawInputManager *manager, rawinput::D
             break;
     }
 
+    // have it sent with the next flush
+    if (device->output_pending) {
+        manager->device_output_mark(device);
+    }
+
     // unlock device
     device->mutex->unlock();
 }
@@ -1274,25 +1283,19 @@ std::vector<Option> GameAPI::Options::getOptions(const std::string &gameName) {
 }
 
 void GameAPI::Options::sortOptions(std::vector<Option> &options, const std::vector<OptionDefinition> &definitions) {
-    std::vector<Option> sorted;
-    bool option_found;
 
-    for (const auto &definition : definitions) {
-        option_found = false;
-
-        for (auto &option : options) {
-            if (definition.name == option.get_definition().name) {
-                option_found = true;
-
-                auto &new_option = sorted.emplace_back(option);
-                new_option.set_definition(definition);
-
-                break;
-            }
-        }
-
-        if (!option_found) {
-            sorted.emplace_back(definition);
+    // one option per definition in registry order, the first value found for each wins
+    std::vector<Option> sorted;
+    std::vector<bool> found(definitions.size(), false);
+    sorted.reserve(definitions.size());
+    for (size_t index = 0; index < definitions.size(); index++) {
+        sorted.emplace_back(index);
+    }
+    for (auto &option : options) {
+        const auto index = option.get_index();
+        if (index < definitions.size() && !found[index]) {
+            found[index] = true;
+            sorted[index] = std::move(option);
         }
     }
 
@@ -1,6 +1,7 @@
 #include "config.h"
 #include "util/logging.h"
 #include "cfg/button.h"
+#include "launcher/options.h"
 
 /*
  * This code absolutely sucks.
@@ -413,7 +414,7 @@ bool Config::addGame(Game &game, bool save) {
                 if (name == nullptr) {
                     gameOptionsNode->DeleteChild(gameOptionNode);
                     gameOptionNode = this->configFile.NewElement("options");
-                    gameOptionNode->SetAttribute("name", it.get_definition().name.c_str());
+                    gameOptionNode->SetAttribute("name", it.get_definition().name.data());
                     gameOptionNode->SetAttribute("value", it.value.c_str());
                     gameOptionsNode->InsertEndChild(gameOptionNode);
                 } else {
@@ -421,7 +422,7 @@ bool Config::addGame(Game &game, bool save) {
                 }
             } else {
                 gameOptionNode = this->configFile.NewElement("option");
-                gameOptionNode->SetAttribute("name", it.get_definition().name.c_str());
+                gameOptionNode->SetAttribute("name", it.get_definition().name.data());
                 gameOptionNode->SetAttribute("value", it.value.c_str());
                 gameOptionsNode->InsertEndChild(gameOptionNode);
             }
@@ -484,7 +485,7 @@ bool Config::addGame(Game &game, bool save) {
         gameNode->InsertEndChild(gameOptionsNode);
         for (auto &it : game.getOptions()) {
             tinyxml2::XMLElement *gameOptionNode = this->configFile.NewElement("option");
-            gameOptionNode->SetAttribute("name", it.get_definition().name.c_str());
+            gameOptionNode->SetAttribute("name", it.get_definition().name.data());
             gameOptionNode->SetAttribute("value", it.value.c_str());
             gameOptionsNode->InsertEndChild(gameOptionNode);
         }
@@ -918,7 +919,7 @@ bool Config::updateBinding(const Game &game, const Option &option) {
         gameOptionNode->SetAttribute("value", option.value.c_str());
     } else {
         gameOptionNode = this->configFile.NewElement("option");
-        gameOptionNode->SetAttribute("name", option.get_definition().name.c_str());
+        gameOptionNode->SetAttribute("name", option.get_definition().name.data());
         gameOptionNode->SetAttribute("value", option.value.c_str());
         gameOptionsNode->InsertEndChild(gameOptionNode);
     }
@@ -1294,12 +1295,12 @@ std::vector<Option> Config::getOptions(const std::string &gameName) {
             } else {
                 const char *value = gameOptionNode->Attribute("value");
 
-                options.emplace_back(OptionDefinition {
-                    .title = optionNodeName,
-                    .name = optionNodeName,
-                    .desc = "",
-                    .type = OptionType::Text,
-                }, value);
+                // options that are no longer in the registry are dropped
+                const auto index = launcher::find_option(optionNodeName);
+                if (index.has_value() &&
+                    launcher::get_option_definitions()[index.value()].name == optionNodeName) {
+                    options.emplace_back(index.value(), value ? value : "");
+                }
             }
 
             gameOptionNode = gameOptionNode->NextSiblingElement("option");
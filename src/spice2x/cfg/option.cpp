@@ -1,5 +1,6 @@
 #include "option.h"
 
+#include "launcher/options.h"
 #include "util/logging.h"
 #include "util/utils.h"
 
@@ -7,6 +8,10 @@ static auto format_as(OptionType f) {
     return fmt::underlying(f);
 }
 
+const OptionDefinition &Option::get_definition() const {
+    return launcher::get_option_definitions()[this->index];
+}
+
 void Option::value_add(std::string new_value) {
 
     // put in primary slot if possible
@@ -16,7 +21,7 @@ void Option::value_add(std::string new_value) {
     }
 
     // add new alternative
-    this->alternatives.emplace_back(this->definition, std::move(new_value));
+    this->alternatives.emplace_back(this->index, std::move(new_value));
 }
 
 bool Option::has_alternatives() const {
@@ -24,15 +29,15 @@ bool Option::has_alternatives() const {
 }
 
 bool Option::value_bool() const {
-    if (this->definition.type != OptionType::Bool) {
-        log_fatal("option", "value_bool() called on {}/{}", this->definition.title, this->definition.type);
+    if (this->get_definition().type != OptionType::Bool) {
+        log_fatal("option", "value_bool() called on {}/{}", this->get_definition().title, this->get_definition().type);
     }
     return !this->value.empty();
 }
 
 const std::string &Option::value_text() const {
-    if (this->definition.type != OptionType::Text && this->definition.type != OptionType::Enum) {
-        log_fatal("option", "value_text() called on {}/{}", this->definition.title, this->definition.type);
+    if (this->get_definition().type != OptionType::Text && this->get_definition().type != OptionType::Enum) {
+        log_fatal("option", "value_text() called on {}/{}", this->get_definition().title, this->get_definition().type);
     }
     return this->value;
 }
@@ -74,14 +79,14 @@ std::vector<std::string> Option::values_text() const {
 }
 
 uint32_t Option::value_uint32() const {
-    if (this->definition.type != OptionType::Integer && this->definition.type != OptionType::Enum) {
-        log_fatal("option", "invalid call: value_uint32() called on {}/{}", this->definition.title, this->definition.type);
+    if (this->get_definition().type != OptionType::Integer && this->get_definition().type != OptionType::Enum) {
+        log_fatal("option", "invalid call: value_uint32() called on {}/{}", this->get_definition().title, this->get_definition().type);
         return 0;
     }
     char *p;
     auto res = strtol(this->value.c_str(), &p, 10);
     if (*p) {
-        log_fatal("option", "failed to convert {} to unsigned integer (option: {})", this->value, this->definition.title);
+        log_fatal("option", "failed to convert {} to unsigned integer (option: {})", this->value, this->get_definition().title);
         return 0;
     } else {
         return res;
@@ -89,8 +94,8 @@ uint32_t Option::value_uint32() const {
 }
 
 uint64_t Option::value_hex64() const {
-    if (this->definition.type != OptionType::Hex) {
-        log_fatal("option", "invalid call: value_hex() called on {}/{}", this->definition.title, this->definition.type);
+    if (this->get_definition().type != OptionType::Hex) {
+        log_fatal("option", "invalid call: value_hex() called on {}/{}", this->get_definition().title, this->get_definition().type);
         return 0;
     }
 
@@ -98,19 +103,18 @@ uint64_t Option::value_hex64() const {
     try {
         affinity = std::stoull(this->value.c_str(), nullptr, 16);
     } catch (const std::exception &ex) {
-        log_fatal("option", "failed to parse {} as hexadecimal (option: {})", this->value, this->definition.title);
+        log_fatal("option", "failed to parse {} as hexadecimal (option: {})", this->value, this->get_definition().title);
     }
     return affinity;
 }
 
 bool Option::search_match(const std::string &query_in_lower_case) {
     if (this->search_string.empty()) {
-        const auto &param =
-            this->definition.display_name.empty() ?
-                this->definition.name : this->definition.display_name;
+        const auto &definition = this->get_definition();
+        const auto param =
+            definition.display_name.empty() ? definition.name : definition.display_name;
 
-        const auto s = this->definition.title + " -" + param;
-        this->search_string = strtolower(s);
+        this->search_string = strtolower(fmt::format("{} -{}", definition.title, param));
     }
     return this->search_string.find(query_in_lower_case) != std::string::npos;
 }
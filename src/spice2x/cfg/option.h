@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <cstdint>
@@ -23,36 +24,43 @@ enum class OptionPickerType {
     Monitor,
 };
 
+/*
+ * Static description of a launcher option. All definitions live in the registry returned by
+ * launcher::get_option_definitions() and every string points into a string literal, so the
+ * views are always null-terminated and .data() can be handed to C APIs.
+ */
 struct OptionDefinition {
-    std::string title;
+    std::string_view title;
     // unique identifier used for flag matching but also stored in config files
     // (should not be changed once published for compat)
-    std::string name;
+    std::string_view name;
     // what's displayed in the UI/logs as the flag name
-    std::string display_name = "";
+    std::string_view display_name = "";
     // slash-delimited list of strings that also work as flag
-    std::string aliases = "";
+    std::string_view aliases = "";
     // what's displayed in the UI/logs as the tooltip
-    std::string desc;
+    std::string_view desc;
     OptionType type;
     bool hidden = false;
-    std::string setting_name = "";
-    std::string game_name = "";
-    std::string category = "Development";
+    std::string_view setting_name = "";
+    std::string_view game_name = "";
+    std::string_view category = "Development";
     bool sensitive = false;
-    std::vector<std::pair<std::string, std::string>> elements = {};
+    std::vector<std::pair<std::string_view, std::string_view>> elements = {};
     bool disabled = false;
     OptionPickerType picker = OptionPickerType::None;
 
     // for OptionPickerType::FilePath
-    std::string file_extension = "";
+    std::string_view file_extension = "";
 
-    std::string quick_setting_category = "";
+    std::string_view quick_setting_category = "";
 };
 
 class Option {
 private:
-    OptionDefinition definition;
+
+    // index into launcher::get_option_definitions()
+    size_t index;
     std::string search_string;
 
 public:
@@ -61,15 +69,13 @@ public:
     bool disabled = false;
     bool conflicting = false;
 
-    explicit Option(OptionDefinition definition, std::string value = "") :
-        definition(std::move(definition)), value(std::move(value)) {
+    explicit Option(size_t index, std::string value = "") :
+        index(index), value(std::move(value)) {
     };
 
-    inline const OptionDefinition &get_definition() const {
-        return this->definition;
-    }
-    inline void set_definition(OptionDefinition definition) {
-        this->definition = std::move(definition);
+    const OptionDefinition &get_definition() const;
+    inline size_t get_index() const {
+        return this->index;
     }
 
     inline bool is_active() const {
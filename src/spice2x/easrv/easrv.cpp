@@ -1,4 +1,5 @@
 #include "easrv.h"
+#include "kbin.h"
 
 #include <sstream>
 #include <vector>
@@ -44,14 +45,14 @@ static thread_local enum header_state_t {
 static std::string HTTP_DEFAULT;
 static std::string EA_HEADER;
 static std::string EA_HEADER_PLAIN;
-static std::string EA_EMPTY;
+static std::vector<uint8_t> EA_EMPTY;
 static std::string EA_EMPTY_CRYPT;
 static std::string EA_SERVICES_GET_FULL;
 static std::string EA_MESSAGE_GET;
 static std::string EA_MESSAGE_GET_MAINTENANCE;
 static std::string EA_FACILITY_GET;
 static std::string EA_PCBEVENT_PUT;
-static std::string EA_PACKAGE_LIST;
+static std::vector<uint8_t> EA_PACKAGE_LIST;
 static std::string EA_TAX_GET_PHASE;
 static std::string EA_EVENTLOG_WRITE;
 static std::string EA_MACHINE_GET_CONTROL;
@@ -216,6 +217,14 @@ static inline void easrv_add_data_raw(std::vector<char> &send, const unsigned ch
     }
 }
 
+static inline void easrv_add_empty(std::vector<char> &send) {
+    if (HEADER_CRYPT) {
+        easrv_add_data(send, EA_EMPTY_CRYPT);
+    } else {
+        easrv_add_data_raw(send, EA_EMPTY.data(), EA_EMPTY.size());
+    }
+}
+
 static SOCKET easrv_worker_method() {
 
     // get connection
@@ -297,7 +306,7 @@ static SOCKET easrv_worker_method() {
             } else if (check_url("pcbevent", "put")) {
                 easrv_add_data(send_data, EA_PCBEVENT_PUT);
             } else if (check_url("package", "list")) {
-                easrv_add_data(send_data, EA_PACKAGE_LIST, false);
+                easrv_add_data_raw(send_data, EA_PACKAGE_LIST.data(), EA_PACKAGE_LIST.size(), false);
             } else if (check_url("tax", "get_phase")) {
                 easrv_add_data(send_data, EA_TAX_GET_PHASE);
             } else if (check_url("eventlog", "write")) {
@@ -332,7 +341,7 @@ static SOCKET easrv_worker_method() {
                     easrv_add_data(send_data, EA_I36_SYSTEM_GETMASTER);
                 } else {
                     log_warning("easrv", "system.getmaster not available for this game model");
-                    easrv_add_data(send_data, HEADER_CRYPT ? EA_EMPTY_CRYPT : EA_EMPTY);
+                    easrv_add_empty(send_data);
                 }
             } else if (check_url("hdkoperation", "get")) {
                 easrv_add_data(send_data, EA_KGG_HDKOPERATION_GET);
@@ -344,7 +353,7 @@ static SOCKET easrv_worker_method() {
                 );
             } else if (string_begins_with(std::string(URL_BUFFER), "//")) {
                 log_warning("easrv", "unknown URL: {}", std::string(URL_BUFFER, URL_BUFFER_LENGTH));
-                easrv_add_data(send_data, HEADER_CRYPT ? EA_EMPTY_CRYPT : EA_EMPTY);
+                easrv_add_empty(send_data);
             }
             break;
         }
@@ -458,6 +467,28 @@ void easrv_shutdown() {
     Sleep(100);
 }
 
+static std::vector<uint8_t> easrv_encode(const kbin::Document &doc) {
+    std::vector<uint8_t> encoded;
+    if (!kbin::encode(doc, encoded)) {
+        log_fatal("easrv", "could not encode response");
+    }
+    return encoded;
+}
+
+static std::vector<uint8_t> easrv_build_empty() {
+    kbin::Document doc;
+    doc.add(doc.add(kbin::NONE, "response"), "data");
+    return easrv_encode(doc);
+}
+
+static std::vector<uint8_t> easrv_build_package_list() {
+    kbin::Document doc;
+    auto package = doc.add(doc.add(kbin::NONE, "response"), "package");
+    doc.set_attr(package, "expire", "1200");
+    doc.set_attr(package, "status", "0");
+    return easrv_encode(doc);
+}
+
 static inline void easrv_init_messages() {
     HTTP_DEFAULT = std::string(
             "HTTP/1.1 200 OK\r\n"
@@ -484,10 +515,7 @@ static inline void easrv_init_messages() {
             "X-Compress: none\r\n"
             "Connection: close\r\n"
     );
-    EA_EMPTY = std::string(
-            "\xA0\x42\x80\x7F\x01\x02\x01\x02\x01\x02\x10\x01\x01\x08\xDE\xAE\x35\xD3\x3E\x2A\x01\x01\x04\xA6\x6E\x66"
-            "\xFE\xFE\xFF\x01\x02\x01\x02\x01\x02\x01\x02"
-    );
+    EA_EMPTY = easrv_build_empty();
     EA_EMPTY_CRYPT = std::string(
             "\x17\x7E\xFC\x8E\x1A\x15\x41\x0F\xAE\xD5\xA0\xF5\x2C\xA1\xB9\xD2\x53\xC6\xA2\xEA\x0D\x24\x89\x92\x87\x2E"
             "\x37\x9D"
@@ -576,12 +604,7 @@ static inline void easrv_init_messages() {
     EA_PCBEVENT_PUT = std::string(
             "\x17\x7e\x7c\x0e\x1a\x15\x41\x0b\xae\xd5\xa0\xf5\x2c\xa1\xb9\xd2\x53\xca\xd2\x0d\x81\x34\xdb\x94\x79\xd0"
             "\xc8\x9d\xb5\xfb\xef\x97");
-    EA_PACKAGE_LIST = std::string(
-            "\xA0\x42\x80\x7F\x01\x02\x01\x02\x01\x02\x24\x01\x01\x08\xDE\xAE\x35\xD3\x3E\x2A\x01\x01\x07\xD6\x6A\x30"
-            "\x9A\xCA\x80\x2E\x06\xAB\xDD\x6E\xDE\xA0\x2E\x06\xE3\x99\xB9\xEB\x80\xFE\xFE\xFF\x01\x02\x01\x02\x01\x02"
-            "\x01\x02\x01\x02\x01\x02\x14\x01\x02\x01\x02\x01\x02\x05\x31\x32\x30\x30\x01\x02\x01\x02\x01\x02\x01\x02"
-            "\x01\x02\x01\x02\x01\x02\x02\x30\x01\x02\x01\x02\x01\x02"
-    );
+    EA_PACKAGE_LIST = easrv_build_package_list();
     EA_TAX_GET_PHASE = std::string(
             "\x17\x7E\xFC\x8E\x1A\x15\x41\x07\xAE\xD5\xA0\xF5\x2C\xA1\xB9\xD2\x53\xC1\xE2\xEB\x2B\xDC\x72\xBB\x5E\x96"
             "\x9F\x63\x4B\x05\x10\x97\x0F\xC7\x2D\xBC\xA2\x7A\xFF\x85"
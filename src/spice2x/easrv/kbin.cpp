@@ -0,0 +1,947 @@
+#include "kbin.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+
+#include "external/fmt/include/fmt/format.h"
+#include "external/tinyxml2/tinyxml2.h"
+
+namespace kbin {
+
+    static const uint8_t SIGNATURE = 0xA0;
+    static const uint8_t NAMES_PACKED = 0x42;
+    static const uint8_t NAMES_PLAIN = 0x45;
+    static const uint8_t ARRAY_FLAG = 0x40;
+    static const uint8_t NODE_END = 0xBE;
+    static const uint8_t FILE_END = 0xBF;
+
+    // plain names store their length minus one below this flag, which caps them at 64 bytes
+    static const uint8_t PLAIN_NAME_FLAG = 0x40;
+    static const size_t PLAIN_NAME_MAX = 64;
+
+    static const char PACKED_ALPHABET[] = "0123456789:ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz";
+
+    enum Kind : uint8_t {
+        KIND_INVALID,
+        KIND_VOID,
+        KIND_SIGNED,
+        KIND_UNSIGNED,
+        KIND_FLOAT,
+        KIND_BOOL,
+        KIND_STR,
+        KIND_BIN,
+        KIND_ATTR,
+    };
+
+    struct TypeInfo {
+
+        // bytes per element and elements per value, 0 for variable sized values
+        uint8_t size;
+        uint8_t count;
+        Kind kind;
+    };
+
+    static constexpr std::array<TypeInfo, 64> make_types() {
+        constexpr TypeInfo scalars[] {
+            {1, 1, KIND_SIGNED}, {1, 1, KIND_UNSIGNED},
+            {2, 1, KIND_SIGNED}, {2, 1, KIND_UNSIGNED},
+            {4, 1, KIND_SIGNED}, {4, 1, KIND_UNSIGNED},
+            {8, 1, KIND_SIGNED}, {8, 1, KIND_UNSIGNED},
+            {4, 1, KIND_FLOAT}, {8, 1, KIND_FLOAT},
+        };
+        std::array<TypeInfo, 64> types {};
+        types[(int) Type::Void] = {0, 0, KIND_VOID};
+        for (int i = 0; i < 8; i++) {
+            types[(int) Type::S8 + i] = scalars[i];
+        }
+        types[(int) Type::Bin] = {1, 0, KIND_BIN};
+        types[(int) Type::Str] = {1, 0, KIND_STR};
+        types[(int) Type::Ip4] = {4, 1, KIND_UNSIGNED};
+        types[(int) Type::Time] = {4, 1, KIND_UNSIGNED};
+        types[(int) Type::Float] = scalars[8];
+        types[(int) Type::Double] = scalars[9];
+        for (int n = 2; n <= 4; n++) {
+            for (int i = 0; i < 10; i++) {
+                types[(int) Type::S8x2 + (n - 2) * 10 + i] = {scalars[i].size, (uint8_t) n, scalars[i].kind};
+            }
+        }
+        types[(int) Type::Attr] = {1, 0, KIND_ATTR};
+        types[(int) Type::S8x16] = {1, 16, KIND_SIGNED};
+        types[(int) Type::U8x16] = {1, 16, KIND_UNSIGNED};
+        types[(int) Type::S16x8] = {2, 8, KIND_SIGNED};
+        types[(int) Type::U16x8] = {2, 8, KIND_UNSIGNED};
+        for (int n = 1; n <= 4; n++) {
+            types[(int) Type::Bool + n - 1] = {1, (uint8_t) n, KIND_BOOL};
+        }
+        types[(int) Type::Boolx16] = {1, 16, KIND_BOOL};
+        return types;
+    }
+
+    static constexpr auto TYPES = make_types();
+
+    static constexpr std::array<uint8_t, 256> make_pack_table() {
+        std::array<uint8_t, 256> table {};
+        for (auto &entry : table) {
+            entry = 0xFF;
+        }
+        for (uint8_t i = 0; i < 64; i++) {
+            table[(uint8_t) PACKED_ALPHABET[i]] = i;
+        }
+        return table;
+    }
+
+    static constexpr auto PACK_TABLE = make_pack_table();
+
+    static const char *TYPE_NAMES[64] {
+        nullptr, "void", "s8", "u8", "s16", "u16", "s32", "u32", "s64", "u64",
+        "bin", "str", "ip4", "time", "float", "double",
+        "2s8", "2u8", "2s16", "2u16", "2s32", "2u32", "2s64", "2u64", "2f", "2d",
+        "3s8", "3u8", "3s16", "3u16", "3s32", "3u32", "3s64", "3u64", "3f", "3d",
+        "4s8", "4u8", "4s16", "4u16", "4s32", "4u32", "4s64", "4u64", "4f", "4d",
+        "attr", nullptr, "vs8", "vu8", "vs16", "vu16", "bool", "2b", "3b", "4b", "vb",
+    };
+
+    const char *type_name(Type type) {
+        return (uint8_t) type < 64 ? TYPE_NAMES[(uint8_t) type] : nullptr;
+    }
+
+    static inline const TypeInfo &type_info(Type type) {
+        return TYPES[(uint8_t) type & 63];
+    }
+
+    static inline bool is_numeric(Kind kind) {
+        return kind == KIND_SIGNED || kind == KIND_UNSIGNED || kind == KIND_FLOAT || kind == KIND_BOOL;
+    }
+
+    static inline size_t align4(size_t value) {
+        return (value + 3) & ~(size_t) 3;
+    }
+
+    static inline uint32_t load_be32(const uint8_t *ptr) {
+        return ((uint32_t) ptr[0] << 24) | ((uint32_t) ptr[1] << 16) | ((uint32_t) ptr[2] << 8) | ptr[3];
+    }
+
+    static inline void store_be32(uint8_t *ptr, uint32_t value) {
+        ptr[0] = (uint8_t) (value >> 24);
+        ptr[1] = (uint8_t) (value >> 16);
+        ptr[2] = (uint8_t) (value >> 8);
+        ptr[3] = (uint8_t) value;
+    }
+
+    static inline uint64_t load_be(const uint8_t *ptr, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++) {
+            value = (value << 8) | ptr[i];
+        }
+        return value;
+    }
+
+    static inline void store_be(uint8_t *ptr, size_t size, uint64_t value) {
+        for (size_t i = size; i > 0; i--) {
+            ptr[i - 1] = (uint8_t) value;
+            value >>= 8;
+        }
+    }
+
+    static inline size_t packed_name_size(size_t length) {
+        return (length * 6 + 7) / 8;
+    }
+
+    /*
+     * Document
+     */
+
+    void Document::clear() {
+        this->nodes.clear();
+        this->arena.clear();
+    }
+
+    void Document::reserve(size_t nodes, size_t bytes) {
+        this->nodes.reserve(nodes);
+        this->arena.reserve(bytes);
+    }
+
+    uint32_t Document::store(const void *data, size_t size) {
+        const auto offset = (uint32_t) this->arena.size();
+        const auto *bytes = static_cast<const uint8_t *>(data);
+
+        // the source may be a value of this very document, which the resize can move
+        const auto *begin = this->arena.data();
+        const bool inside = std::less_equal<>()(begin, bytes)
+                && std::less<>()(bytes, begin + this->arena.size());
+        const size_t source = inside ? (size_t) (bytes - begin) : 0;
+
+        this->arena.resize(offset + size);
+        if (inside) {
+            memmove(&this->arena[offset], &this->arena[source], size);
+        } else if (size > 0) {
+            memcpy(&this->arena[offset], bytes, size);
+        }
+        return offset;
+    }
+
+    NodeId Document::append(NodeId parent, std::string_view name, Type type, bool array, size_t value_size) {
+        if (name.empty() || name.size() > 255 || this->nodes.size() >= NONE - 1) {
+            return NONE;
+        }
+        if (parent == NONE && !this->nodes.empty()) {
+            return NONE;
+        }
+
+        Node node {};
+        node.name = this->store(name.data(), name.size());
+        node.name_size = (uint8_t) name.size();
+        node.value = (uint32_t) this->arena.size();
+        node.value_size = (uint32_t) value_size;
+        node.parent = parent;
+        node.first_child = NONE;
+        node.last_child = NONE;
+        node.first_attr = NONE;
+        node.last_attr = NONE;
+        node.next = NONE;
+        node.type = type;
+        node.array = array;
+        this->arena.resize(this->arena.size() + value_size);
+
+        // attributes and children are two lists threaded through the same link
+        const auto id = (NodeId) this->nodes.size();
+        if (parent != NONE) {
+            auto &owner = this->nodes[parent];
+            auto &first = type == Type::Attr ? owner.first_attr : owner.first_child;
+            auto &last = type == Type::Attr ? owner.last_attr : owner.last_child;
+            if (last == NONE) {
+                first = id;
+            } else {
+                this->nodes[last].next = id;
+            }
+            last = id;
+        }
+        this->nodes.push_back(node);
+        return id;
+    }
+
+    NodeId Document::add(NodeId parent, std::string_view name, Type type) {
+        const auto &info = type_info(type);
+        if (info.kind == KIND_INVALID || info.kind == KIND_ATTR || (uint8_t) type >= 64) {
+            return NONE;
+        }
+        return this->append(parent, name, type, false, (size_t) info.size * info.count);
+    }
+
+    NodeId Document::add_array(NodeId parent, std::string_view name, Type type, size_t length) {
+        const auto &info = type_info(type);
+        if (!is_numeric(info.kind) || (uint8_t) type >= 64 || length > 0xFFFFFFu) {
+            return NONE;
+        }
+        return this->append(parent, name, type, true, length * info.size * info.count);
+    }
+
+    NodeId Document::add_str(NodeId parent, std::string_view name, std::string_view value) {
+        auto node = this->add(parent, name, Type::Str);
+        if (node != NONE) {
+            this->set_str(node, value);
+        }
+        return node;
+    }
+
+    std::string_view Document::name(NodeId node) const {
+        const auto &entry = this->nodes[node];
+        return std::string_view(reinterpret_cast<const char *>(this->arena.data()) + entry.name, entry.name_size);
+    }
+
+    NodeId Document::child(NodeId node, std::string_view name) const {
+        for (auto it = this->nodes[node].first_child; it != NONE; it = this->nodes[it].next) {
+            if (this->name(it) == name) {
+                return it;
+            }
+        }
+        return NONE;
+    }
+
+    NodeId Document::find(NodeId node, std::string_view path) const {
+        while (node != NONE && !path.empty()) {
+            const auto split = path.find('/');
+            const auto part = path.substr(0, split);
+            path = split == std::string_view::npos ? std::string_view() : path.substr(split + 1);
+            if (!part.empty()) {
+                node = this->child(node, part);
+            }
+        }
+        return node;
+    }
+
+    size_t Document::count(NodeId node) const {
+        const auto &info = type_info(this->nodes[node].type);
+        return info.size ? this->nodes[node].value_size / info.size : 0;
+    }
+
+    std::string_view Document::str(NodeId node) const {
+        const auto &entry = this->nodes[node];
+        return std::string_view(reinterpret_cast<const char *>(this->arena.data()) + entry.value, entry.value_size);
+    }
+
+    static inline void replace_value(std::vector<uint8_t> &arena, uint32_t &offset, uint32_t &size,
+            const uint8_t *value, size_t value_size, uint32_t stored) {
+
+        // shrinking values are rewritten in place, growing ones move to the end of the arena
+        if (stored == NONE) {
+            memmove(arena.data() + offset, value, value_size);
+        } else {
+            offset = stored;
+        }
+        size = (uint32_t) value_size;
+    }
+
+    void Document::set_str(NodeId node, std::string_view value) {
+        const auto kind = type_info(this->nodes[node].type).kind;
+        if (kind != KIND_STR && kind != KIND_ATTR) {
+            return;
+        }
+        const auto *bytes = reinterpret_cast<const uint8_t *>(value.data());
+        const auto stored = value.size() > this->nodes[node].value_size ? this->store(bytes, value.size()) : NONE;
+        auto &entry = this->nodes[node];
+        replace_value(this->arena, entry.value, entry.value_size, bytes, value.size(), stored);
+    }
+
+    void Document::set_bin(NodeId node, const uint8_t *value, size_t size) {
+        if (type_info(this->nodes[node].type).kind != KIND_BIN) {
+            return;
+        }
+        const auto stored = size > this->nodes[node].value_size ? this->store(value, size) : NONE;
+        auto &entry = this->nodes[node];
+        replace_value(this->arena, entry.value, entry.value_size, value, size, stored);
+    }
+
+    std::string_view Document::attr(NodeId node, std::string_view name) const {
+        for (auto it = this->nodes[node].first_attr; it != NONE; it = this->nodes[it].next) {
+            if (this->name(it) == name) {
+                return this->str(it);
+            }
+        }
+        return {};
+    }
+
+    void Document::set_attr(NodeId node, std::string_view name, std::string_view value) {
+        if (this->nodes[node].type == Type::Attr) {
+            return;
+        }
+        for (auto it = this->nodes[node].first_attr; it != NONE; it = this->nodes[it].next) {
+            if (this->name(it) == name) {
+                this->set_str(it, value);
+                return;
+            }
+        }
+        auto attr = this->append(node, name, Type::Attr, false, 0);
+        if (attr != NONE) {
+            this->set_str(attr, value);
+        }
+    }
+
+    // element `index` of a numeric node, nullptr when there is none
+    static inline const uint8_t *element(const std::vector<uint8_t> &arena, uint32_t value, uint32_t value_size,
+            const TypeInfo &info, size_t index) {
+        if (!is_numeric(info.kind) || index >= value_size / info.size) {
+            return nullptr;
+        }
+        return arena.data() + value + index * info.size;
+    }
+
+    static inline double load_float(const uint8_t *ptr, size_t size) {
+        if (size == 4) {
+            return std::bit_cast<float>((uint32_t) load_be(ptr, 4));
+        }
+        return std::bit_cast<double>(load_be(ptr, 8));
+    }
+
+    static inline int64_t load_signed(const uint8_t *ptr, size_t size) {
+        const auto shift = 64 - size * 8;
+        return (int64_t) (load_be(ptr, size) << shift) >> shift;
+    }
+
+    int64_t Document::get_int(NodeId node, size_t index) const {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = element(this->arena, entry.value, entry.value_size, info, index);
+        if (!ptr) {
+            return 0;
+        }
+        switch (info.kind) {
+            case KIND_SIGNED:
+                return load_signed(ptr, info.size);
+            case KIND_FLOAT:
+                return (int64_t) load_float(ptr, info.size);
+            default:
+                return (int64_t) load_be(ptr, info.size);
+        }
+    }
+
+    uint64_t Document::get_uint(NodeId node, size_t index) const {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = element(this->arena, entry.value, entry.value_size, info, index);
+        if (!ptr) {
+            return 0;
+        }
+        switch (info.kind) {
+            case KIND_SIGNED:
+                return (uint64_t) load_signed(ptr, info.size);
+            case KIND_FLOAT:
+                return (uint64_t) load_float(ptr, info.size);
+            default:
+                return load_be(ptr, info.size);
+        }
+    }
+
+    double Document::get_double(NodeId node, size_t index) const {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = element(this->arena, entry.value, entry.value_size, info, index);
+        if (!ptr) {
+            return 0.0;
+        }
+        switch (info.kind) {
+            case KIND_SIGNED:
+                return (double) load_signed(ptr, info.size);
+            case KIND_FLOAT:
+                return load_float(ptr, info.size);
+            default:
+                return (double) load_be(ptr, info.size);
+        }
+    }
+
+    static inline void store_float(uint8_t *ptr, size_t size, double value) {
+        if (size == 4) {
+            store_be(ptr, 4, std::bit_cast<uint32_t>((float) value));
+        } else {
+            store_be(ptr, 8, std::bit_cast<uint64_t>(value));
+        }
+    }
+
+    void Document::set_int(NodeId node, int64_t value, size_t index) {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = const_cast<uint8_t *>(element(this->arena, entry.value, entry.value_size, info, index));
+        if (!ptr) {
+            return;
+        }
+        if (info.kind == KIND_FLOAT) {
+            store_float(ptr, info.size, (double) value);
+        } else if (info.kind == KIND_BOOL) {
+            *ptr = value != 0;
+        } else {
+            store_be(ptr, info.size, (uint64_t) value);
+        }
+    }
+
+    void Document::set_uint(NodeId node, uint64_t value, size_t index) {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = const_cast<uint8_t *>(element(this->arena, entry.value, entry.value_size, info, index));
+        if (!ptr) {
+            return;
+        }
+        if (info.kind == KIND_FLOAT) {
+            store_float(ptr, info.size, (double) value);
+        } else if (info.kind == KIND_BOOL) {
+            *ptr = value != 0;
+        } else {
+            store_be(ptr, info.size, value);
+        }
+    }
+
+    void Document::set_double(NodeId node, double value, size_t index) {
+        const auto &entry = this->nodes[node];
+        const auto &info = type_info(entry.type);
+        auto *ptr = const_cast<uint8_t *>(element(this->arena, entry.value, entry.value_size, info, index));
+        if (!ptr) {
+            return;
+        }
+        if (info.kind == KIND_FLOAT) {
+            store_float(ptr, info.size, value);
+        } else if (info.kind == KIND_BOOL) {
+            *ptr = value != 0.0;
+        } else if (info.kind == KIND_SIGNED) {
+            store_be(ptr, info.size, (uint64_t) (int64_t) value);
+        } else {
+            store_be(ptr, info.size, (uint64_t) value);
+        }
+    }
+
+    /*
+     * Data Section
+     *
+     * Values of one and two bytes are packed together: the first of them claims a four byte
+     * slot at the end of the section and the following ones fill it up, with separate slots
+     * for bytes and words. Everything else starts on a four byte boundary, and sized values
+     * (strings, binaries and arrays) are prefixed with their length in bytes.
+     */
+
+    struct DataCursor {
+        size_t pos = 0;
+        size_t byte_pos = 0;
+        size_t word_pos = 0;
+
+        // offset of the next fixed size value
+        size_t aligned(size_t size) {
+            size_t offset;
+            if (size == 1) {
+                if (this->byte_pos % 4 == 0) {
+                    this->byte_pos = this->pos;
+                    this->pos += 4;
+                }
+                offset = this->byte_pos++;
+            } else if (size == 2) {
+                if (this->word_pos % 4 == 0) {
+                    this->word_pos = this->pos;
+                    this->pos += 4;
+                }
+                offset = this->word_pos;
+                this->word_pos += 2;
+            } else {
+                offset = this->pos;
+                this->pos += align4(size);
+            }
+            return offset;
+        }
+    };
+
+    /*
+     * Decoding
+     */
+
+    static inline const uint8_t *read_name(const uint8_t *ptr, const uint8_t *end, bool packed,
+            std::vector<uint8_t> &arena, uint32_t &name, uint8_t &name_size) {
+        if (ptr >= end) {
+            return nullptr;
+        }
+
+        if (packed) {
+            const size_t length = *ptr++;
+            const size_t bytes = packed_name_size(length);
+            if (length == 0 || (size_t) (end - ptr) < bytes) {
+                return nullptr;
+            }
+
+            name = (uint32_t) arena.size();
+            name_size = (uint8_t) length;
+            arena.resize(arena.size() + length);
+            auto *out = &arena[name];
+            uint32_t bits = 0;
+            uint32_t accumulator = 0;
+            for (size_t i = 0; i < length; i++) {
+                if (bits < 6) {
+                    accumulator = (accumulator << 8) | *ptr++;
+                    bits += 8;
+                }
+                bits -= 6;
+                out[i] = (uint8_t) PACKED_ALPHABET[(accumulator >> bits) & 63];
+            }
+            return ptr;
+        }
+
+        const size_t length = (*ptr++ & ~PLAIN_NAME_FLAG) + 1;
+        if ((size_t) (end - ptr) < length) {
+            return nullptr;
+        }
+        name = (uint32_t) arena.size();
+        name_size = (uint8_t) length;
+        arena.insert(arena.end(), ptr, ptr + length);
+        return ptr + length;
+    }
+
+    bool decode(const uint8_t *data, size_t size, Document &doc) {
+        doc.clear();
+
+        // header
+        if (size < 12 || size > 0x7FFFFFFFu || data[0] != SIGNATURE
+                || (data[1] != NAMES_PACKED && data[1] != NAMES_PLAIN)
+                || data[3] != (uint8_t) ~data[2]) {
+            return false;
+        }
+        const bool packed = data[1] == NAMES_PACKED;
+        doc.encoding = (Encoding) data[2];
+
+        // sections
+        const size_t node_size = load_be32(&data[4]);
+        if (node_size > size - 12) {
+            return false;
+        }
+        const uint8_t *ptr = &data[8];
+        const uint8_t *node_end = ptr + node_size;
+        const size_t data_size = load_be32(node_end);
+        if (data_size > size - 12 - node_size) {
+            return false;
+        }
+        const uint8_t *data_section = node_end + 4;
+
+        // every node takes at least three bytes of the node section, names aside
+        doc.reserve(node_size / 4 + 1, node_size + node_size / 3 + data_size);
+
+        DataCursor cursor;
+        auto sized = [&](size_t &length) -> const uint8_t * {
+            if (cursor.pos > data_size || data_size - cursor.pos < 4) {
+                return nullptr;
+            }
+            length = load_be32(data_section + cursor.pos);
+            if (length > data_size - cursor.pos - 4) {
+                return nullptr;
+            }
+            const auto *value = data_section + cursor.pos + 4;
+            cursor.pos += 4 + align4(length);
+            return value;
+        };
+
+        NodeId current = NONE;
+        while (ptr < node_end) {
+            const uint8_t raw = *ptr++;
+            const bool array = (raw & ARRAY_FLAG) != 0;
+            const uint8_t type = raw & ~ARRAY_FLAG;
+
+            if (type == NODE_END) {
+                if (current == NONE) {
+                    return false;
+                }
+                current = doc.nodes[current].parent;
+                continue;
+            }
+            if (type == FILE_END) {
+                return current == NONE && !doc.nodes.empty();
+            }
+
+            const auto &info = TYPES[type & 63];
+            if (type >= 64 || info.kind == KIND_INVALID) {
+                return false;
+            }
+            if (current == NONE && !doc.nodes.empty()) {
+                return false;
+            }
+
+            uint32_t name;
+            uint8_t name_size;
+            ptr = read_name(ptr, node_end, packed, doc.arena, name, name_size);
+            if (!ptr) {
+                return false;
+            }
+
+            // value
+            const uint8_t *value = nullptr;
+            size_t value_size = 0;
+            if (array) {
+                if (!is_numeric(info.kind) || !(value = sized(value_size))
+                        || value_size % ((size_t) info.size * info.count) != 0) {
+                    return false;
+                }
+            } else if (info.kind == KIND_STR || info.kind == KIND_BIN || info.kind == KIND_ATTR) {
+                if (!(value = sized(value_size))) {
+                    return false;
+                }
+
+                // strings are stored without their terminator
+                if (info.kind != KIND_BIN && value_size > 0 && value[value_size - 1] == 0) {
+                    value_size--;
+                }
+            } else if (info.kind != KIND_VOID) {
+                value_size = (size_t) info.size * info.count;
+                const size_t offset = cursor.aligned(value_size);
+                if (offset > data_size || data_size - offset < value_size) {
+                    return false;
+                }
+                value = data_section + offset;
+            }
+            if (info.kind == KIND_ATTR && (current == NONE || array)) {
+                return false;
+            }
+
+            Document::Node node {};
+            node.name = name;
+            node.name_size = name_size;
+            node.value = (uint32_t) doc.arena.size();
+            node.value_size = (uint32_t) value_size;
+            node.parent = current;
+            node.first_child = NONE;
+            node.last_child = NONE;
+            node.first_attr = NONE;
+            node.last_attr = NONE;
+            node.next = NONE;
+            node.type = (Type) type;
+            node.array = array;
+            if (value_size > 0) {
+                doc.arena.insert(doc.arena.end(), value, value + value_size);
+            }
+
+            const auto id = (NodeId) doc.nodes.size();
+            if (current != NONE) {
+                auto &owner = doc.nodes[current];
+                auto &first = info.kind == KIND_ATTR ? owner.first_attr : owner.first_child;
+                auto &last = info.kind == KIND_ATTR ? owner.last_attr : owner.last_child;
+                if (last == NONE) {
+                    first = id;
+                } else {
+                    doc.nodes[last].next = id;
+                }
+                last = id;
+            }
+            doc.nodes.push_back(node);
+
+            // attributes have no end marker
+            if (info.kind != KIND_ATTR) {
+                current = id;
+            }
+        }
+
+        // ran out of nodes before the end marker
+        return false;
+    }
+
+    /*
+     * Encoding
+     */
+
+    static inline uint8_t *write_name(uint8_t *out, const uint8_t *name, size_t length, bool packed) {
+        if (!packed) {
+            *out++ = (uint8_t) ((length - 1) | PLAIN_NAME_FLAG);
+            memcpy(out, name, length);
+            return out + length;
+        }
+
+        *out++ = (uint8_t) length;
+        uint32_t bits = 0;
+        uint32_t accumulator = 0;
+        for (size_t i = 0; i < length; i++) {
+            accumulator = (accumulator << 6) | PACK_TABLE[name[i]];
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                *out++ = (uint8_t) (accumulator >> bits);
+            }
+        }
+        if (bits > 0) {
+            *out++ = (uint8_t) (accumulator << (8 - bits));
+        }
+        return out;
+    }
+
+    bool encode(const Document &doc, std::vector<uint8_t> &out) {
+        if (doc.nodes.empty()) {
+            return false;
+        }
+        const auto *arena = doc.arena.data();
+
+        // names decide the layout: pack them if every one fits the alphabet
+        bool packed = true;
+        for (const auto &node : doc.nodes) {
+            for (size_t i = 0; packed && i < node.name_size; i++) {
+                packed = PACK_TABLE[arena[node.name + i]] != 0xFF;
+            }
+            if (!packed && node.name_size > PLAIN_NAME_MAX) {
+                return false;
+            }
+        }
+
+        // type, name length and end marker per node, one less for attributes
+        size_t node_size = doc.nodes.size() * 3 + 1;
+        for (const auto &node : doc.nodes) {
+            node_size += packed ? packed_name_size(node.name_size) : node.name_size;
+            node_size -= node.type == Type::Attr;
+        }
+        node_size = align4(node_size);
+
+        // header and node section are written in place, the data section is appended behind
+        const size_t base = out.size();
+        const size_t data_base = base + 12 + node_size;
+        out.resize(data_base);
+        auto *header = &out[base];
+        header[0] = SIGNATURE;
+        header[1] = packed ? NAMES_PACKED : NAMES_PLAIN;
+        header[2] = (uint8_t) doc.encoding;
+        header[3] = (uint8_t) ~(uint8_t) doc.encoding;
+        store_be32(&header[4], (uint32_t) node_size);
+        size_t node_pos = base + 8;
+
+        DataCursor cursor;
+        auto reserve = [&](size_t end) {
+            if (data_base + end > out.size()) {
+                out.resize(data_base + end);
+            }
+        };
+        auto write_sized = [&](const uint8_t *value, size_t length, bool terminate) {
+            const size_t total = length + terminate;
+            const size_t offset = cursor.pos;
+            cursor.pos += 4 + align4(total);
+            reserve(cursor.pos);
+            store_be32(&out[data_base + offset], (uint32_t) total);
+            if (length > 0) {
+                memcpy(&out[data_base + offset + 4], value, length);
+            }
+        };
+        auto write_node = [&](const Document::Node &node) {
+            const auto &info = type_info(node.type);
+            out[node_pos] = (uint8_t) node.type | (node.array ? ARRAY_FLAG : 0);
+            node_pos = write_name(&out[node_pos + 1], arena + node.name, node.name_size, packed) - out.data();
+
+            const auto *value = arena + node.value;
+            if (node.array || info.kind == KIND_BIN) {
+                write_sized(value, node.value_size, false);
+            } else if (info.kind == KIND_STR || info.kind == KIND_ATTR) {
+                write_sized(value, node.value_size, true);
+            } else if (info.kind != KIND_VOID) {
+                const size_t offset = cursor.aligned(node.value_size);
+                reserve(std::max(cursor.pos, offset + node.value_size));
+                memcpy(&out[data_base + offset], value, node.value_size);
+            }
+        };
+
+        // depth first over the links, without a stack
+        NodeId id = 0;
+        while (true) {
+            const auto &node = doc.nodes[id];
+            write_node(node);
+            for (auto attr = node.first_attr; attr != NONE; attr = doc.nodes[attr].next) {
+                write_node(doc.nodes[attr]);
+            }
+            if (node.first_child != NONE) {
+                id = node.first_child;
+                continue;
+            }
+            while (true) {
+                out[node_pos++] = NODE_END | ARRAY_FLAG;
+                if (id == 0) {
+                    break;
+                }
+                if (doc.nodes[id].next != NONE) {
+                    id = doc.nodes[id].next;
+                    break;
+                }
+                id = doc.nodes[id].parent;
+            }
+            if (id == 0) {
+                break;
+            }
+        }
+        out[node_pos++] = FILE_END | ARRAY_FLAG;
+
+        // the rest of the node section is already zero from the resize
+        store_be32(&out[base + 8 + node_size], (uint32_t) cursor.pos);
+        reserve(cursor.pos);
+        return true;
+    }
+
+    /*
+     * XML
+     */
+
+    static const char *encoding_name(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::Ascii:
+                return "ASCII";
+            case Encoding::Latin1:
+                return "ISO-8859-1";
+            case Encoding::EucJp:
+                return "EUC-JP";
+            case Encoding::ShiftJis:
+                return "SHIFT_JIS";
+            case Encoding::Utf8:
+                return "UTF-8";
+            default:
+                return nullptr;
+        }
+    }
+
+    static void append_value_text(const Document &doc, NodeId node, std::string &text) {
+        const auto &info = type_info(doc.type(node));
+        const auto *data = doc.data(node);
+        const size_t size = doc.size(node);
+
+        if (info.kind == KIND_STR) {
+            text.append(reinterpret_cast<const char *>(data), size);
+            return;
+        }
+        if (info.kind == KIND_BIN) {
+            static const char HEX[] = "0123456789abcdef";
+            for (size_t i = 0; i < size; i++) {
+                text.push_back(HEX[data[i] >> 4]);
+                text.push_back(HEX[data[i] & 15]);
+            }
+            return;
+        }
+
+        const bool ip4 = doc.type(node) == Type::Ip4;
+        const size_t count = doc.count(node);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) {
+                text.push_back(' ');
+            }
+            const auto *element = data + i * info.size;
+            if (ip4) {
+                fmt::format_to(std::back_inserter(text), "{}.{}.{}.{}",
+                        element[0], element[1], element[2], element[3]);
+            } else if (info.kind == KIND_FLOAT) {
+                fmt::format_to(std::back_inserter(text), "{:.6f}", load_float(element, info.size));
+            } else if (info.kind == KIND_SIGNED) {
+                fmt::format_to(std::back_inserter(text), "{}", load_signed(element, info.size));
+            } else {
+                fmt::format_to(std::back_inserter(text), "{}", load_be(element, info.size));
+            }
+        }
+    }
+
+    void print_xml(const Document &doc, tinyxml2::XMLPrinter &printer) {
+        if (doc.root() == NONE) {
+            return;
+        }
+        if (auto encoding = encoding_name(doc.encoding)) {
+            printer.PushDeclaration(fmt::format("xml version=\"1.0\" encoding=\"{}\"", encoding).c_str());
+        } else {
+            printer.PushDeclaration("xml version=\"1.0\"");
+        }
+
+        // the printer keeps the element names until they are closed, deque entries stay put
+        std::deque<std::string> names;
+        std::string text;
+
+        NodeId node = doc.root();
+        while (true) {
+            const auto &info = type_info(doc.type(node));
+            names.emplace_back(doc.name(node));
+            printer.OpenElement(names.back().c_str());
+            if (info.kind != KIND_VOID) {
+                printer.PushAttribute("__type", type_name(doc.type(node)));
+                if (doc.is_array(node)) {
+                    printer.PushAttribute("__count", (unsigned) (doc.size(node) / ((size_t) info.size * info.count)));
+                } else if (info.kind == KIND_BIN) {
+                    printer.PushAttribute("__size", (unsigned) doc.size(node));
+                }
+            }
+            for (auto attr = doc.first_attr(node); attr != NONE; attr = doc.next(attr)) {
+                printer.PushAttribute(std::string(doc.name(attr)).c_str(), std::string(doc.str(attr)).c_str());
+            }
+            if (info.kind != KIND_VOID) {
+                text.clear();
+                append_value_text(doc, node, text);
+                printer.PushText(text.c_str());
+            }
+
+            if (doc.first_child(node) != NONE) {
+                node = doc.first_child(node);
+                continue;
+            }
+            while (true) {
+                printer.CloseElement();
+                names.pop_back();
+                if (node == doc.root()) {
+                    return;
+                }
+                if (doc.next(node) != NONE) {
+                    node = doc.next(node);
+                    break;
+                }
+                node = doc.parent(node);
+            }
+        }
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace tinyxml2 {
+    class XMLPrinter;
+}
+
+/*
+ * KBin, the binary property format used by e-amusement.
+ *
+ * A document is a flat table of nodes linked by index, with all names and values in one shared
+ * byte arena, so a decoded message costs two allocations no matter how many nodes it has.
+ * Values are kept the way they are on the wire, big endian, which makes encoding a plain copy;
+ * the typed accessors convert. Strings stay in the document's encoding and are stored without
+ * their terminator.
+ *
+ * Encryption and compression belong to the transport, this only deals with plain KBin.
+ */
+
+namespace kbin {
+
+    enum class Type : uint8_t {
+        Void = 1,
+        S8, U8, S16, U16, S32, U32, S64, U64,
+        Bin, Str, Ip4, Time, Float, Double,
+        S8x2, U8x2, S16x2, U16x2, S32x2, U32x2, S64x2, U64x2, Floatx2, Doublex2,
+        S8x3, U8x3, S16x3, U16x3, S32x3, U32x3, S64x3, U64x3, Floatx3, Doublex3,
+        S8x4, U8x4, S16x4, U16x4, S32x4, U32x4, S64x4, U64x4, Floatx4, Doublex4,
+        Attr,
+        S8x16 = 48, U8x16, S16x8, U16x8,
+        Bool, Boolx2, Boolx3, Boolx4, Boolx16,
+    };
+
+    enum class Encoding : uint8_t {
+        None = 0x00,
+        Ascii = 0x20,
+        Latin1 = 0x40,
+        EucJp = 0x60,
+        ShiftJis = 0x80,
+        Utf8 = 0xA0,
+    };
+
+    // the name AVS uses for a type in XML, e.g. "u8" or "3s16"; nullptr for unknown types
+    const char *type_name(Type type);
+
+    using NodeId = uint32_t;
+    constexpr NodeId NONE = 0xFFFFFFFFu;
+
+    class Document {
+    public:
+        Encoding encoding = Encoding::ShiftJis;
+
+        void clear();
+        void reserve(size_t nodes, size_t bytes);
+
+        // the top level node, NONE while the document is empty
+        NodeId root() const {
+            return this->nodes.empty() ? NONE : 0;
+        }
+
+        /*
+         * Appends a node to `parent`, or creates the root when `parent` is NONE. Value nodes
+         * start out zeroed, strings and binaries empty. Returns NONE for an empty name, a name
+         * longer than 255 bytes, a type that cannot be a node or a second root.
+         */
+        NodeId add(NodeId parent, std::string_view name, Type type = Type::Void);
+
+        // array node with `length` zeroed values of `type`
+        NodeId add_array(NodeId parent, std::string_view name, Type type, size_t length);
+
+        NodeId add_str(NodeId parent, std::string_view name, std::string_view value);
+
+        template<class T>
+        NodeId add_value(NodeId parent, std::string_view name, Type type, T value) {
+            auto node = this->add(parent, name, type);
+            if (node != NONE) {
+                this->set(node, value);
+            }
+            return node;
+        }
+
+        // navigation, NONE when there is nothing there
+        NodeId first_child(NodeId node) const {
+            return this->nodes[node].first_child;
+        }
+        NodeId first_attr(NodeId node) const {
+            return this->nodes[node].first_attr;
+        }
+        NodeId next(NodeId node) const {
+            return this->nodes[node].next;
+        }
+        NodeId parent(NodeId node) const {
+            return this->nodes[node].parent;
+        }
+        NodeId child(NodeId node, std::string_view name) const;
+
+        // follows a '/' separated path of child names, e.g. "pcbtracker/ecenable"
+        NodeId find(NodeId node, std::string_view path) const;
+
+        std::string_view name(NodeId node) const;
+        Type type(NodeId node) const {
+            return this->nodes[node].type;
+        }
+        bool is_array(NodeId node) const {
+            return this->nodes[node].array;
+        }
+
+        // number of scalar elements, e.g. 3 for a single 3u8 and 6 for an array of two of them
+        size_t count(NodeId node) const;
+
+        // raw value bytes as on the wire
+        const uint8_t *data(NodeId node) const {
+            return this->arena.data() + this->nodes[node].value;
+        }
+        size_t size(NodeId node) const {
+            return this->nodes[node].value_size;
+        }
+
+        std::string_view str(NodeId node) const;
+        void set_str(NodeId node, std::string_view value);
+        void set_bin(NodeId node, const uint8_t *value, size_t size);
+
+        // attributes, an empty view when missing
+        std::string_view attr(NodeId node, std::string_view name) const;
+        void set_attr(NodeId node, std::string_view name, std::string_view value);
+
+        /*
+         * Numeric element access, converting from and to the node's own type. Out of range
+         * indices read as 0 and are ignored on write, as are nodes without numeric values.
+         */
+        template<class T>
+        T get(NodeId node, size_t index = 0) const {
+            static_assert(std::is_arithmetic_v<T>);
+            if constexpr (std::is_floating_point_v<T>) {
+                return static_cast<T>(this->get_double(node, index));
+            } else if constexpr (std::is_signed_v<T>) {
+                return static_cast<T>(this->get_int(node, index));
+            } else {
+                return static_cast<T>(this->get_uint(node, index));
+            }
+        }
+
+        template<class T>
+        void set(NodeId node, T value, size_t index = 0) {
+            static_assert(std::is_arithmetic_v<T>);
+            if constexpr (std::is_floating_point_v<T>) {
+                this->set_double(node, static_cast<double>(value), index);
+            } else if constexpr (std::is_signed_v<T>) {
+                this->set_int(node, static_cast<int64_t>(value), index);
+            } else {
+                this->set_uint(node, static_cast<uint64_t>(value), index);
+            }
+        }
+
+    private:
+        friend bool decode(const uint8_t *data, size_t size, Document &doc);
+        friend bool encode(const Document &doc, std::vector<uint8_t> &out);
+
+        struct Node {
+            uint32_t name;
+            uint32_t value;
+            uint32_t value_size;
+            NodeId parent;
+            NodeId first_child;
+            NodeId last_child;
+            NodeId first_attr;
+            NodeId last_attr;
+            NodeId next;
+            uint8_t name_size;
+            Type type;
+            bool array;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<uint8_t> arena;
+
+        NodeId append(NodeId parent, std::string_view name, Type type, bool array, size_t value_size);
+        uint32_t store(const void *data, size_t size);
+
+        int64_t get_int(NodeId node, size_t index) const;
+        uint64_t get_uint(NodeId node, size_t index) const;
+        double get_double(NodeId node, size_t index) const;
+        void set_int(NodeId node, int64_t value, size_t index);
+        void set_uint(NodeId node, uint64_t value, size_t index);
+        void set_double(NodeId node, double value, size_t index);
+    };
+
+    // replaces the contents of `doc`; false on malformed input, with `doc` left unspecified
+    bool decode(const uint8_t *data, size_t size, Document &doc);
+
+    /*
+     * Appends the encoded document to `out`. Names are packed to six bits per character when
+     * all of them fit the packed alphabet and stored as they are otherwise. False when the
+     * document is empty or a name cannot be represented at all.
+     */
+    bool encode(const Document &doc, std::vector<uint8_t> &out);
+
+    /*
+     * Prints the document the way AVS writes properties as XML: value nodes carry their type
+     * in __type, arrays their length in __count and binaries their size in __size, numbers are
+     * separated by spaces and binaries written in hex.
+     */
+    void print_xml(const Document &doc, tinyxml2::XMLPrinter &printer);
+}
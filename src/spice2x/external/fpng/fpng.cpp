@@ -41,6 +41,15 @@
 	#include <emmintrin.h>		// SSE2
 	#include <smmintrin.h>		// SSE4.1
 	#include <wmmintrin.h>		// pclmul
+
+	// spice2x: the SIMD functions are built for SSE4.1/pclmul one by one instead of raising the
+	// instruction set of the whole unit, so nothing outside of them can pick up instructions an
+	// older CPU lacks. They are only called after the cpuid check in fpng_init().
+	#if defined(__GNUC__) || defined(__clang__)
+		#define FPNG_TARGET_SSE41 __attribute__((target("sse4.1,pclmul")))
+	#else
+		#define FPNG_TARGET_SSE41
+	#endif
 #endif
 
 #ifndef FPNG_NO_STDIO
@@ -252,7 +261,7 @@ namespace fpng
 	// See Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction":
 	// https://www.intel.com/content/dam/www/public/us/en/documents/white-papers/fast-crc-computation-generic-polynomials-pclmulqdq-paper.pdf
 	// Requires PCLMUL and SSE 4.1. This function skips Step 1 (fold by 4) for simplicity/less code.
-	static uint32_t crc32_pclmul(const uint8_t* p, size_t size, uint32_t crc)
+	FPNG_TARGET_SSE41 static uint32_t crc32_pclmul(const uint8_t* p, size_t size, uint32_t crc)
 	{
 		assert(size >= 16);
 
@@ -280,7 +289,7 @@ namespace fpng
 		return ~_mm_extract_epi32(_mm_xor_si128(b, _mm_clmulepi64_si128(_mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(b, z), u, 16), z), u, 0)), 1);
 	}
 
-	static uint32_t crc32_sse41_simd(const unsigned char* buf, size_t len, uint32_t prev_crc32)
+	FPNG_TARGET_SSE41 static uint32_t crc32_sse41_simd(const unsigned char* buf, size_t len, uint32_t prev_crc32)
 	{
 		if (len < 16)
 			return crc32_slice_by_4(buf, len, prev_crc32);
@@ -404,7 +413,7 @@ namespace fpng
 	// See "Fast Computation of Adler32 Checksums":
 	// https://www.intel.com/content/www/us/en/developer/articles/technical/fast-computation-of-adler32-checksums.html
 	// SSE 4.1, 16 bytes per iteration
-	static uint32_t adler32_sse_16(const uint8_t* p, size_t len, uint32_t initial)
+	FPNG_TARGET_SSE41 static uint32_t adler32_sse_16(const uint8_t* p, size_t len, uint32_t initial)
 	{
 		uint32_t s1 = initial & 0xFFFF, s2 = initial >> 16;
 		const uint32_t K = 65521;
@@ -1589,6 +1598,18 @@ do_literals:
 		}
 	}
 		
+#if FPNG_X86_OR_X64_CPU && !FPNG_NO_SSE
+	FPNG_TARGET_SSE41 static void sub_prev_scanline_sse41(uint32_t bytes_to_process, const uint8_t* pSrc, const uint8_t* pPrev_src, uint8_t* pDst)
+	{
+		uint32_t ofs = 0;
+		for (; bytes_to_process >= 16; bytes_to_process -= 16, ofs += 16)
+			_mm_storeu_si128((__m128i*)(pDst + ofs), _mm_sub_epi8(_mm_loadu_si128((const __m128i*)(pSrc + ofs)), _mm_loadu_si128((const __m128i*)(pPrev_src + ofs))));
+
+		for (; bytes_to_process; bytes_to_process--, ofs++)
+			pDst[ofs] = (uint8_t)(pSrc[ofs] - pPrev_src[ofs]);
+	}
+#endif
+
 	static void apply_filter(uint32_t filter, int w, int h, uint32_t num_chans, uint32_t bpl, const uint8_t* pSrc, const uint8_t* pPrev_src, uint8_t* pDst)
 	{
 		(void)h;
@@ -1611,14 +1632,7 @@ do_literals:
 
 #if FPNG_X86_OR_X64_CPU && !FPNG_NO_SSE
 			if (g_cpu_info.can_use_sse41())
-			{
-				uint32_t bytes_to_process = w * num_chans, ofs = 0;
-				for (; bytes_to_process >= 16; bytes_to_process -= 16, ofs += 16)
-					_mm_storeu_si128((__m128i*)(pDst + ofs), _mm_sub_epi8(_mm_loadu_si128((const __m128i*)(pSrc + ofs)), _mm_loadu_si128((const __m128i*)(pPrev_src + ofs))));
-
-				for (; bytes_to_process; bytes_to_process--, ofs++)
-					pDst[ofs] = (uint8_t)(pSrc[ofs] - pPrev_src[ofs]);
-			}
+				sub_prev_scanline_sse41(w * num_chans, pSrc, pPrev_src, pDst);
 			else
 #endif
 			{
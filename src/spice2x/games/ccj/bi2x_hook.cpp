@@ -392,6 +392,7 @@ namespace games::ccj {
         static struct TapeLedMapping {
             size_t data_size;
             int r, g, b;
+            tapeledutils::tape_cache cache;
 
             TapeLedMapping(size_t data_size, int r, int g, int b)
                 : data_size(data_size), r(r), g(g), b(b) {}
@@ -404,14 +405,16 @@ namespace games::ccj {
         if (tapeledutils::is_enabled() && i_TapeLed < std::size(mapping)) {
             auto &map = mapping[i_TapeLed];
 
-            // pick a color to use
-            const auto rgb = tapeledutils::pick_color_from_led_tape(i_pData, map.data_size);
+            // pick a color to use, unless the tape did not change since last time
+            tapeledutils::rgb_float3_t rgb;
+            if (tapeledutils::update_led_tape(map.cache, i_pData, map.data_size, 0, rgb)) {
 
-            // program the lights into API
-            auto &lights = get_lights();
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.r], rgb.r);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.g], rgb.g);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.b], rgb.b);
+                // program the lights into API
+                auto &lights = get_lights();
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.r], rgb.r);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.g], rgb.g);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.b], rgb.b);
+            }
         }
     }
 
@@ -386,11 +386,15 @@ namespace games::gitadora {
         if (tapeledutils::is_enabled() && 
             i_TapeLedCh == 0 && i_Offset == 0 && i_cntTapeLed == 62) {
 
-            auto &lights = get_lights();
-            const auto rgb = tapeledutils::pick_color_from_led_tape(i_pData, i_cntTapeLed);
-            GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgR], rgb.r);
-            GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgG], rgb.g);
-            GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgB], rgb.b);
+            // only pick a new color when the tape changed since last time
+            static tapeledutils::tape_cache cache;
+            tapeledutils::rgb_float3_t rgb;
+            if (tapeledutils::update_led_tape(cache, i_pData, i_cntTapeLed, 0, rgb)) {
+                auto &lights = get_lights();
+                GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgR], rgb.r);
+                GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgG], rgb.g);
+                GameAPI::Lights::writeLight(RI_MGR, lights[Lights::ArenaTitleAvgB], rgb.b);
+            }
         }
     }
 
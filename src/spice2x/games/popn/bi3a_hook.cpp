@@ -474,14 +474,16 @@ namespace games::popn {
             auto &map = TAPELED_MAPPING[i_CnPin];
             const auto data_size = std::min(map.data.capacity(), (size_t)number_of_leds / 3);
 
-            // pick a color to use
-            const auto rgb = tapeledutils::pick_color_from_led_tape(map, (uint8_t *)i_pData, data_size);
-
-            // program the lights into API
-            auto &lights = get_lights();
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_r], rgb.r);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_g], rgb.g);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_b], rgb.b);
+            // pick a color to use, unless the tape did not change since last time
+            tapeledutils::rgb_float3_t rgb;
+            if (tapeledutils::update_led_tape(map.cache, (uint8_t *)i_pData, data_size, map.max_value, rgb)) {
+
+                // program the lights into API
+                auto &lights = get_lights();
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_r], rgb.r);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_g], rgb.g);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_b], rgb.b);
+            }
 
             // tape LED output over API not implemented
             // for (size_t i = 0; i < data_size; i++) {
@@ -357,14 +357,16 @@ namespace games::sdvx {
             auto &map = TAPELED_MAPPING[index];
             const auto data_size = map.data.size();
 
-            // pick a color to use
-            const auto rgb = tapeledutils::pick_color_from_led_tape(data, data_size);
-
-            // program the lights into API
-            auto &lights = get_lights();
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_r], rgb.r);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_g], rgb.g);
-            GameAPI::Lights::writeLight(RI_MGR, lights[map.index_b], rgb.b);
+            // pick a color to use, unless the tape did not change since last time
+            tapeledutils::rgb_float3_t rgb;
+            if (tapeledutils::update_led_tape(map.cache, data, data_size, map.max_value, rgb)) {
+
+                // program the lights into API
+                auto &lights = get_lights();
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_r], rgb.r);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_g], rgb.g);
+                GameAPI::Lights::writeLight(RI_MGR, lights[map.index_b], rgb.b);
+            }
 
             if (api::has_clients()) {
                 for (size_t i = 0; i < data_size; ++i) {
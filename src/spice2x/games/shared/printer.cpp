@@ -1,7 +1,13 @@
 #include "printer.h"
 
-#include <vector>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
 #include "avs/game.h"
 #include "hooks/sleephook.h"
@@ -14,8 +20,7 @@
 #include "util/logging.h"
 #include "util/utils.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "external/stb_image_write.h"
+#include "printer_image.h"
 
 namespace games::shared {
 
@@ -205,8 +210,12 @@ namespace games::shared {
         return Error_NoError;
     }
 
+    static bool print_queue_idle();
+
     static DWORD __stdcall CPU9CheckPrintEnd(DWORD meminfo, PBOOL pbisEnd, PCPDIDinfo pIDInfo) {
-        *pbisEnd = true;
+
+        // the print has ended once its files are written
+        *pbisEnd = print_queue_idle();
         return Error_NoError;
     }
 
@@ -301,99 +310,66 @@ namespace games::shared {
         return "DUMMY";
     }
 
-    static inline bool process_image_print(const CPDBandImageParams *pBandImage) {
+    /*
+     * Print jobs.
+     *
+     * The game hands over an image in the print call and only expects it to be accepted, so
+     * the call just validates and copies it. Transforming, encoding and writing the files is
+     * done by a single background worker in submission order, which also keeps the filename
+     * probing in get_image_out_path single threaded. Each format is encoded once and the
+     * result written to every output path.
+     */
 
-        // log
-        log_info("printer", "processing incoming print job");
+    // jobs accepted but not yet written; the print call waits for a slot beyond this, which
+    // is what a real printer does too, instead of buffering photos without bound
+    static constexpr size_t PRINT_QUEUE_LIMIT = 4;
 
-        // get image bounds
-        int image_width = pBandImage->bounds.right - pBandImage->bounds.left;
-        int image_height = pBandImage->bounds.bottom - pBandImage->bounds.top;
-
-        // check bounds
-        if (image_width <= 0 || image_height <= 0) {
-            log_warning("printer", "invalid image size: {}x{}", image_width, image_height);
-            return false;
-        }
+    struct PrintJob {
+        std::vector<uint8_t> image_data;
+        int image_width;
+        int image_height;
+        std::promise<bool> done;
+    };
 
-        // check rowBytes
-        if (pBandImage->rowBytes < 0 || pBandImage->rowBytes != image_width * 3) {
-            log_warning("printer", "unsupported image data layout: {}", pBandImage->rowBytes);
-            return false;
-        }
+    static std::mutex PRINT_QUEUE_M;
+    static std::condition_variable PRINT_QUEUE_CV;
+    static std::deque<PrintJob> PRINT_QUEUE;
+    static size_t PRINT_JOBS_PENDING = 0;
+    static bool PRINT_WORKER_STARTED = false;
 
-        // make a copy of the image data
-        auto image_data = new uint8_t[image_width * image_height * 3];
-        memcpy(image_data, pBandImage->baseAddr, (size_t) (image_width * image_height * 3));
-
-        // convert BGR to RGB
-        log_misc("printer", "converting BGR to RGB...");
-        for (int pixel = 0; pixel < image_width * image_height; pixel++) {
-            int index = pixel * 3;
-            uint8_t tmp = image_data[index];
-            image_data[index] = image_data[index + 2];
-            image_data[index + 2] = tmp;
-        }
+    static bool process_print_job(PrintJob &job) {
+        int image_width = job.image_width;
+        int image_height = job.image_height;
 
+        std::vector<uint8_t> image_data;
         if (avs::game::is_model({"KLP", "KFC", "NCG"})) {
-            // rotate image clockwise
-            log_misc("printer", "rotate clockwise...");
-            auto rotated = new uint8_t[image_width * image_height * 3];
-            for (int x = 0; x < image_width; x++) {
-                for (int y = 0; y < image_height; y++) {
-                    int index1 = (y * image_width + x) * 3;
-                    int index2 = (x * image_height + y) * 3;
-                    rotated[index2 + 0] = image_data[index1 + 0];
-                    rotated[index2 + 1] = image_data[index1 + 1];
-                    rotated[index2 + 2] = image_data[index1 + 2];
-                }
-            }
-            delete[] image_data;
-            image_data = rotated;
+            log_misc("printer", "converting to RGB, rotate clockwise...");
+            image_data = transform_rotate(job.image_data.data(), image_width, image_height);
             std::swap(image_width, image_height);
-
         } else {
-            // flip horizontally
-            log_misc("printer", "flip horizontally...");
-            for (int x = 0; x < image_width / 2; x++) {
-                for (int y = 0; y < image_height; y++) {
-                    int index1 = (y * image_width + x) * 3;
-                    int index2 = (y * image_width + image_width - x - 1) * 3;
-                    uint8_t r = image_data[index1 + 0];
-                    uint8_t g = image_data[index1 + 1];
-                    uint8_t b = image_data[index1 + 2];
-                    image_data[index1 + 0] = image_data[index2 + 0];
-                    image_data[index1 + 1] = image_data[index2 + 1];
-                    image_data[index1 + 2] = image_data[index2 + 2];
-                    image_data[index2 + 0] = r;
-                    image_data[index2 + 1] = g;
-                    image_data[index2 + 2] = b;
-                }
-            }
+            log_misc("printer", "converting to RGB, flip horizontally...");
+            image_data = transform_flip(job.image_data.data(), image_width, image_height);
         }
 
-        // iterate folders
+        // the source copy is dead now, the encoders below need their own memory
+        job.image_data.clear();
+        job.image_data.shrink_to_fit();
+
+        // encode each format once and write it to every path
         log_misc("printer", "writing files...");
-        for (const auto &path : PRINTER_PATH) {
-            for (const auto &format : PRINTER_FORMAT) {
+        bool all_written = true;
+        std::vector<uint8_t> encoded;
+        for (const auto &format : PRINTER_FORMAT) {
+            const bool encoded_ok = encode_image(format, image_data.data(), image_width, image_height, PRINTER_JPG_QUALITY, encoded);
+            if (!encoded_ok) {
+                log_warning("printer", "failed to encode image as {}", format);
+            }
+
+            for (const auto &path : PRINTER_PATH) {
 
                 // get image path
                 std::string image_path = get_image_out_path(PRINTER_OVERWRITE_FILE, path, format);
-                bool success = false;
-
-                // call write function depending on format
-                if (format == "png" && stbi_write_png(
-                        image_path.c_str(), image_width, image_height, 3, image_data, image_width * 3))
-                    success = true;
-                if (format == "bmp" && stbi_write_bmp(
-                        image_path.c_str(), image_width, image_height, 3, image_data))
-                    success = true;
-                if (format == "tga" && stbi_write_tga(
-                        image_path.c_str(), image_width, image_height, 3, image_data))
-                    success = true;
-                if (format == "jpg" && stbi_write_jpg(
-                        image_path.c_str(), image_width, image_height, 3, image_data, PRINTER_JPG_QUALITY))
-                    success = true;
+                bool success = encoded_ok && fileutils::bin_write(image_path, encoded.data(), encoded.size());
 
                 // logging
                 if (success) {
@@ -402,6 +378,7 @@ namespace games::shared {
                             overlay::notifications::Severity::Success,
                             fmt::format("Printer: saved {}", fileutils::basename(image_path)));
                 } else {
+                    all_written = false;
                     log_warning("printer", "printer emulation failed to write image to {}", image_path);
                     overlay::notifications::add(
                             overlay::notifications::Severity::Error,
@@ -410,9 +387,89 @@ namespace games::shared {
             }
         }
 
-        // clean up
-        delete[] image_data;
-        return true;
+        return all_written;
+    }
+
+    static void print_worker() {
+        std::unique_lock<std::mutex> lock(PRINT_QUEUE_M);
+        while (true) {
+            PRINT_QUEUE_CV.wait(lock, [] { return !PRINT_QUEUE.empty(); });
+            auto job = std::move(PRINT_QUEUE.front());
+            PRINT_QUEUE.pop_front();
+            lock.unlock();
+
+            // an escape from here would end the worker and with it every later print
+            bool written = false;
+            try {
+                written = process_print_job(job);
+            } catch (const std::exception &e) {
+                log_warning("printer", "print job failed: {}", e.what());
+            } catch (...) {
+                log_warning("printer", "print job failed");
+            }
+            job.done.set_value(written);
+
+            lock.lock();
+            PRINT_JOBS_PENDING--;
+            PRINT_QUEUE_CV.notify_all();
+        }
+    }
+
+    static bool print_queue_idle() {
+        std::lock_guard<std::mutex> lock(PRINT_QUEUE_M);
+        return PRINT_JOBS_PENDING == 0;
+    }
+
+    /*
+     * Validates and copies the image, then queues it for the worker. The returned future is
+     * set once all files of the job are written, to whether every one of them was.
+     */
+    static std::optional<std::shared_future<bool>> process_image_print(const CPDBandImageParams *pBandImage) {
+
+        // log
+        log_info("printer", "processing incoming print job");
+
+        // get image bounds
+        int image_width = pBandImage->bounds.right - pBandImage->bounds.left;
+        int image_height = pBandImage->bounds.bottom - pBandImage->bounds.top;
+
+        // check bounds
+        if (image_width <= 0 || image_height <= 0) {
+            log_warning("printer", "invalid image size: {}x{}", image_width, image_height);
+            return std::nullopt;
+        }
+
+        // check rowBytes
+        if (pBandImage->rowBytes < 0 || pBandImage->rowBytes != image_width * 3) {
+            log_warning("printer", "unsupported image data layout: {}", pBandImage->rowBytes);
+            return std::nullopt;
+        }
+
+        // make a copy of the image data, the game may reuse its buffer once we return
+        PrintJob job;
+        auto image_bytes = static_cast<const uint8_t *>(pBandImage->baseAddr);
+        job.image_data.assign(image_bytes, image_bytes + static_cast<size_t>(image_width) * image_height * 3);
+        job.image_width = image_width;
+        job.image_height = image_height;
+        auto done = job.done.get_future().share();
+
+        // queue
+        std::unique_lock<std::mutex> lock(PRINT_QUEUE_M);
+        if (PRINT_JOBS_PENDING >= PRINT_QUEUE_LIMIT) {
+            log_warning("printer", "{} print jobs still being written, waiting", PRINT_JOBS_PENDING);
+            PRINT_QUEUE_CV.wait(lock, [] { return PRINT_JOBS_PENDING < PRINT_QUEUE_LIMIT; });
+        }
+        if (!PRINT_WORKER_STARTED) {
+            PRINT_WORKER_STARTED = true;
+
+            // detached, so a job still being written at exit does not block shutdown
+            std::thread(print_worker).detach();
+        }
+        PRINT_QUEUE.emplace_back(std::move(job));
+        PRINT_JOBS_PENDING++;
+        PRINT_QUEUE_CV.notify_all();
+
+        return done;
     }
 
     static DWORD __stdcall CPUASendImage(
@@ -421,7 +478,7 @@ namespace games::shared {
         const CPAImageEffectParams *piep,
         PCPDIDinfo pIDInfo
     ) {
-        // process image
+        // queue image
         if (!process_image_print(pBandImage)) {
             return Error_InvalidParam;
         }
@@ -451,8 +508,9 @@ namespace games::shared {
          * The address in the upper left of image data is usually set in baseAddr.
          */
 
-        // process image
-        if (!process_image_print(pBandImage)) {
+        // queue image
+        auto written = process_image_print(pBandImage);
+        if (!written) {
             return Error_InvalidParam;
         }
 
@@ -460,12 +518,18 @@ namespace games::shared {
         // the game fires up a listener around 4 seconds after the call
         WORD printCount = setP->printCount;
         short usbNo = pIDInfo->usbNo;
-        std::thread t([printCount, pfncb, usbNo, nJid]() {
+        std::thread t([printCount, pfncb, usbNo, nJid, written = std::move(*written)]() {
             for (int print_no = 1; print_no <= printCount; print_no++) {
 
                 // wait for game listener
                 Sleep(4000);
 
+                // a print only completes once its files exist; a failed write is still
+                // reported as printed, the error is shown to the user instead
+                if (print_no == 1) {
+                    written.wait();
+                }
+
                 // do logic
                 if (PRINTER_PAPER_REMAIN > 0) {
                     PRINTER_TOTAL_COUNT++;
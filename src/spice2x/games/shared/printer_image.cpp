@@ -0,0 +1,79 @@
+#include "printer_image.h"
+
+#include <algorithm>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "external/stb_image_write.h"
+
+namespace games::shared {
+
+    // transposing rotation runs in square tiles, so both the source rows and the output
+    // rows of a tile stay in cache instead of striding a full row for every pixel
+    static constexpr int TRANSFORM_TILE = 16;
+
+    std::vector<uint8_t> transform_rotate(const uint8_t *source, int image_width, int image_height) {
+        std::vector<uint8_t> result(static_cast<size_t>(image_width) * image_height * 3);
+        for (int tile_y = 0; tile_y < image_height; tile_y += TRANSFORM_TILE) {
+            const int y_end = std::min(tile_y + TRANSFORM_TILE, image_height);
+            for (int tile_x = 0; tile_x < image_width; tile_x += TRANSFORM_TILE) {
+                const int x_end = std::min(tile_x + TRANSFORM_TILE, image_width);
+                for (int x = tile_x; x < x_end; x++) {
+                    auto dst = &result[(static_cast<size_t>(x) * image_height + tile_y) * 3];
+                    auto src = &source[(static_cast<size_t>(tile_y) * image_width + x) * 3];
+                    for (int y = tile_y; y < y_end; y++) {
+                        dst[0] = src[2];
+                        dst[1] = src[1];
+                        dst[2] = src[0];
+                        dst += 3;
+                        src += static_cast<size_t>(image_width) * 3;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    // both sides are walked row by row already
+    std::vector<uint8_t> transform_flip(const uint8_t *source, int image_width, int image_height) {
+        std::vector<uint8_t> result(static_cast<size_t>(image_width) * image_height * 3);
+        for (int y = 0; y < image_height; y++) {
+            const size_t row = static_cast<size_t>(y) * image_width * 3;
+            auto src = &source[row + static_cast<size_t>(image_width - 1) * 3];
+            auto dst = &result[row];
+            for (int x = 0; x < image_width; x++) {
+                dst[0] = src[2];
+                dst[1] = src[1];
+                dst[2] = src[0];
+                dst += 3;
+                src -= 3;
+            }
+        }
+        return result;
+    }
+
+    static void append_encoded(void *context, void *data, int size) {
+        auto encoded = static_cast<std::vector<uint8_t> *>(context);
+        auto bytes = static_cast<const uint8_t *>(data);
+        encoded->insert(encoded->end(), bytes, bytes + size);
+    }
+
+    bool encode_image(const std::string &format, const uint8_t *image_data,
+            int image_width, int image_height, int jpg_quality, std::vector<uint8_t> &encoded) {
+        encoded.clear();
+        int result = 0;
+        if (format == "png") {
+            result = stbi_write_png_to_func(append_encoded, &encoded,
+                    image_width, image_height, 3, image_data, image_width * 3);
+        } else if (format == "bmp") {
+            result = stbi_write_bmp_to_func(append_encoded, &encoded,
+                    image_width, image_height, 3, image_data);
+        } else if (format == "tga") {
+            result = stbi_write_tga_to_func(append_encoded, &encoded,
+                    image_width, image_height, 3, image_data);
+        } else if (format == "jpg") {
+            result = stbi_write_jpg_to_func(append_encoded, &encoded,
+                    image_width, image_height, 3, image_data, jpg_quality);
+        }
+        return result != 0 && !encoded.empty();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// the image work of a print job, kept apart from the printer hooks so it builds without Windows
+
+namespace games::shared {
+
+    // BGR to RGB, rotated clockwise; the result is image_height pixels wide
+    std::vector<uint8_t> transform_rotate(const uint8_t *source, int image_width, int image_height);
+
+    // BGR to RGB, flipped horizontally
+    std::vector<uint8_t> transform_flip(const uint8_t *source, int image_width, int image_height);
+
+    // encodes packed RGB as png, bmp, tga or jpg into `encoded`; false for any other format
+    // or when the encoder fails
+    bool encode_image(const std::string &format, const uint8_t *image_data,
+            int image_width, int image_height, int jpg_quality, std::vector<uint8_t> &encoded);
+}
@@ -9,9 +9,13 @@
 
 #include "external/asio/asiolist.h"
 #include "hooks/audio/audio.h"
+#include "hooks/audio/buffer.h"
+#include "hooks/audio/telemetry.h"
 #include "util/logging.h"
 #include "util/utils.h"
 
+namespace telemetry = hooks::audio::telemetry;
+
 namespace {
 
     // readable name for an ASIO sample type (e.g. "ASIOSTInt32LSB"), falling back to the
@@ -79,6 +83,7 @@ namespace {
             case WrappedAsio::StereoDownmix::Center: return "center";
             case WrappedAsio::StereoDownmix::Rear: return "rear";
             case WrappedAsio::StereoDownmix::Side: return "side";
+            case WrappedAsio::StereoDownmix::AC4: return "ac4";
             default: return "unknown";
         }
     }
@@ -92,6 +97,19 @@ namespace {
         return (frames * 1000.0) / sample_rate;
     }
 
+    // the sample buffer type matching an ASIO sample type; only the native little endian
+    // formats are supported, everything else maps to UNSUPPORTED
+    SampleType asio_to_sample_type(AsioSampleType type) {
+        switch (type) {
+            case ASIOSTFloat32LSB: return SampleType::FLOAT_32;
+            case ASIOSTFloat64LSB: return SampleType::FLOAT_64;
+            case ASIOSTInt16LSB: return SampleType::SINT_16;
+            case ASIOSTInt24LSB: return SampleType::SINT_24;
+            case ASIOSTInt32LSB: return SampleType::SINT_32;
+            default: return SampleType::UNSUPPORTED;
+        }
+    }
+
     // scales one planar ASIO output buffer (frames samples of the given type) by gain in
     // place, clamping integer formats so a boost saturates instead of wrapping. unsupported
     // formats are left untouched. runs on the driver's realtime thread, so no allocation,
@@ -100,58 +118,13 @@ namespace {
         if (buffer == nullptr || frames <= 0) {
             return;
         }
-        switch (type) {
-            case ASIOSTFloat32LSB: {
-                auto p = static_cast<float *>(buffer);
-                for (long i = 0; i < frames; i++) {
-                    p[i] = std::clamp(p[i] * gain, -1.0f, 1.0f);
-                }
-                break;
-            }
-            case ASIOSTFloat64LSB: {
-                auto p = static_cast<double *>(buffer);
-                for (long i = 0; i < frames; i++) {
-                    p[i] = std::clamp(p[i] * static_cast<double>(gain), -1.0, 1.0);
-                }
-                break;
-            }
-            case ASIOSTInt16LSB: {
-                auto p = static_cast<int16_t *>(buffer);
-                for (long i = 0; i < frames; i++) {
-                    p[i] = static_cast<int16_t>(
-                        std::clamp(std::lround(p[i] * gain), -32768L, 32767L));
-                }
-                break;
-            }
-            case ASIOSTInt24LSB: {
-                // packed 24-bit little-endian, 3 bytes per sample
-                auto bytes = static_cast<uint8_t *>(buffer);
-                for (long i = 0; i < frames; i++) {
-                    uint8_t *s = bytes + i * 3;
-                    int32_t v = s[0] | (s[1] << 8) | (s[2] << 16);
-                    if (v & 0x800000) {
-                        v |= ~0xFFFFFF; // sign extend
-                    }
-                    int64_t scaled = std::clamp<int64_t>(
-                        std::llround(static_cast<double>(v) * gain), -8388608, 8388607);
-                    s[0] = scaled & 0xFF;
-                    s[1] = (scaled >> 8) & 0xFF;
-                    s[2] = (scaled >> 16) & 0xFF;
-                }
-                break;
-            }
-            case ASIOSTInt32LSB: {
-                auto p = static_cast<int32_t *>(buffer);
-                for (long i = 0; i < frames; i++) {
-                    p[i] = static_cast<int32_t>(std::clamp<int64_t>(
-                        std::llround(static_cast<double>(p[i]) * gain), INT32_MIN, INT32_MAX));
-                }
-                break;
-            }
-            default:
-                // unsupported format (MSB, aligned 32-bit, DSD): leave untouched
-                break;
+
+        // unsupported format (MSB, aligned 32-bit, DSD): leave untouched
+        const SampleType sample_type = asio_to_sample_type(type);
+        if (sample_type == SampleType::UNSUPPORTED) {
+            return;
         }
+        apply_gain(buffer, sample_type, static_cast<size_t>(frames), gain);
     }
 
     // one wrapper per CLSID, kept alive for the process lifetime. ASIO drivers are
@@ -244,6 +217,8 @@ WrappedAsio::StereoDownmix WrappedAsio::name_to_stereo_downmix(const char *name)
         return StereoDownmix::Rear;
     } else if (_stricmp(name, "side") == 0) {
         return StereoDownmix::Side;
+    } else if (_stricmp(name, "ac4") == 0) {
+        return StereoDownmix::AC4;
     }
 
     return StereoDownmix::None;
@@ -582,7 +557,7 @@ AsioCallbacks *WrappedAsio::install_proxy_callbacks(AsioCallbacks *game_callback
 
     const bool want_volume = (gain != 1.0f);
 
-    // front is the device's own pair, so selecting it (or None) means no copy is needed
+    // front is the device's own pair, so selecting it (or None) means no mix is needed
     const bool want_downmix = (STEREO_DOWNMIX != StereoDownmix::None
         && STEREO_DOWNMIX != StereoDownmix::Front);
 
@@ -654,15 +629,36 @@ void WrappedAsio::record_volume_output_channel(const AsioBufferInfo &info) {
 void WrappedAsio::record_downmix_channels(
     AsioBufferInfo *buffer_infos, long num_channels, long buffer_size)
 {
-    // map the selected pair to source channel indices (0-indexed, standard 7.1 layout);
-    // None and Front need no copy
+    // build the 7.1 -> 2.0 matrix for the selected mix (0-indexed standard 7.1 layout:
+    // L R C LFE RL RR SL SR); None and Front need no mix
+    hooks::audio::ChannelMatrix matrix;
+    matrix.resize(FORCED_OUTPUT_CHANNELS, 2);
     long src_left = 0, src_right = 0;
     switch (STEREO_DOWNMIX) {
         case StereoDownmix::Center: src_left = 2; src_right = 2; break;
         case StereoDownmix::Rear: src_left = 4; src_right = 5; break;
         case StereoDownmix::Side: src_left = 6; src_right = 7; break;
+        case StereoDownmix::AC4: {
+
+            // AC-4 stereo downmix (ETSI TS 103 190-1): front pair at unity, center and
+            // surrounds at -3 dB, LFE dropped
+            constexpr float att_3db = 0.70710678f;
+            src_left = 0;
+            src_right = 1;
+            for (long output = 0; output < 2; output++) {
+                matrix.set_gain(output, output, 1.0f);
+                matrix.set_gain(output, 2, att_3db);
+                matrix.set_gain(output, 4 + output, att_3db);
+                matrix.set_gain(output, 6 + output, att_3db);
+            }
+            break;
+        }
         default: return;
     }
+    if (STEREO_DOWNMIX != StereoDownmix::AC4) {
+        matrix.set_gain(0, src_left, 1.0f);
+        matrix.set_gain(1, src_right, 1.0f);
+    }
 
     // find the double-buffer pair for a given output channel among those the game created,
     // or nullptr if the device does not expose it
@@ -676,12 +672,15 @@ void WrappedAsio::record_downmix_channels(
         return nullptr;
     };
 
-    // destinations are device channels 0/1; sources are the selected pair
+    // destinations are device channels 0/1; every source with a non-zero gain must exist,
+    // except for AC4 which folds in whatever part of the 7.1 layout the game created
     void **dst0 = find_output(0);
     void **dst1 = find_output(1);
     void **src_l = find_output(src_left);
     void **src_r = find_output(src_right);
-    if (dst0 == nullptr || dst1 == nullptr || src_l == nullptr || src_r == nullptr) {
+    const bool sources_missing = STEREO_DOWNMIX != StereoDownmix::AC4
+        && (src_l == nullptr || src_r == nullptr);
+    if (dst0 == nullptr || dst1 == nullptr || sources_missing) {
         log_warning(
             "audio::wrappedasio",
             "stereo downmix disabled: device is missing the front pair or source channels "
@@ -692,31 +691,61 @@ void WrappedAsio::record_downmix_channels(
         return;
     }
 
-    // all device output channels share one sample format; query it to size the copy
+    // all device output channels share one sample format; query it to pick the mix format
     const AsioSampleType type = this->device_output_sample_type();
+    const SampleType sample_type = asio_to_sample_type(type);
     const int sample_bytes = asio_sample_bytes(type);
-    if (sample_bytes <= 0) {
-        log_warning(
+    if (sample_type == SampleType::UNSUPPORTED) {
+
+        // a selected pair can still be routed verbatim; folding needs decoded samples
+        if (sample_bytes <= 0 || STEREO_DOWNMIX == StereoDownmix::AC4) {
+            log_warning(
+                "audio::wrappedasio",
+                "stereo downmix disabled: unsupported sample format {} ({})",
+                asio_sample_type_name(type),
+                static_cast<long>(type));
+            return;
+        }
+        this->downmix_copies[0] = {{dst0[0], dst0[1]}, {src_l[0], src_l[1]}};
+        this->downmix_copies[1] = {{dst1[0], dst1[1]}, {src_r[0], src_r[1]}};
+        this->downmix_bytes = static_cast<size_t>(buffer_size) * sample_bytes;
+        this->downmix_raw = true;
+        this->downmix_active = true;
+
+        log_info(
             "audio::wrappedasio",
-            "stereo downmix disabled: unsupported sample format {} ({})",
+            "stereo downmix active: pair={} (src {}/{} -> device 0/1, raw copy of {}), {} frames",
+            stereo_downmix_name(STEREO_DOWNMIX),
+            src_left,
+            src_right,
             asio_sample_type_name(type),
-            static_cast<long>(type));
+            buffer_size);
         return;
     }
 
-    this->downmix_copies[0] = {{dst0[0], dst0[1]}, {src_l[0], src_l[1]}};
-    this->downmix_copies[1] = {{dst1[0], dst1[1]}, {src_r[0], src_r[1]}};
-    this->downmix_bytes = static_cast<size_t>(buffer_size) * sample_bytes;
+    for (long channel = 0; channel < FORCED_OUTPUT_CHANNELS; channel++) {
+        void **buffers = find_output(channel);
+        for (int index = 0; index < 2; index++) {
+            this->downmix_sources[index][channel] = buffers != nullptr ? buffers[index] : nullptr;
+        }
+    }
+    for (int index = 0; index < 2; index++) {
+        this->downmix_outputs[index][0] = dst0[index];
+        this->downmix_outputs[index][1] = dst1[index];
+    }
+    this->downmix_matrix = std::move(matrix);
+    this->downmix_sample_type = sample_type;
+    this->downmix_frames = buffer_size;
+    this->downmix_raw = false;
     this->downmix_active = true;
 
     log_info(
         "audio::wrappedasio",
-        "stereo downmix active: pair={} (src {}/{} -> device 0/1), {} frames, {} byte(s)/sample",
+        "stereo downmix active: mix={} ({} -> device 0/1 taps), {} frames, {}",
         stereo_downmix_name(STEREO_DOWNMIX),
-        src_left,
-        src_right,
+        this->downmix_matrix.taps(0) + this->downmix_matrix.taps(1),
         buffer_size,
-        sample_bytes);
+        sample_type_str(sample_type));
 }
 
 void WrappedAsio::publish_post_process(long buffer_size) {
@@ -724,6 +753,15 @@ void WrappedAsio::publish_post_process(long buffer_size) {
         return;
     }
 
+    // arm the stream telemetry with the period the driver should call us at
+    AsioSampleRate sample_rate = 0.0;
+    this->pReal->get_sample_rate(&sample_rate);
+    const double period_ms = frames_to_ms(buffer_size, sample_rate);
+    telemetry::configure(
+        this->telemetry,
+        period_ms > 0.0 ? static_cast<uint32_t>(period_ms * 1000.0) : 0,
+        0);
+
     // everything the realtime thread reads is now in place; make ourselves reachable
     this->volume_buffer_size = buffer_size;
     WrappedAsio::active_instance.store(this, std::memory_order_release);
@@ -784,15 +822,26 @@ void WrappedAsio::apply_downmix(long double_buffer_index) {
         return;
     }
 
-    // raw planar copy of the selected source channels onto device channels 0/1; for the
-    // center selection both copies share one source. skip self-copies (front)
-    for (const DownmixCopy &copy : this->downmix_copies) {
-        void *dst = copy.dst[double_buffer_index];
-        const void *src = copy.src[double_buffer_index];
-        if (dst != nullptr && src != nullptr && dst != src) {
-            std::memcpy(dst, src, this->downmix_bytes);
+    // raw planar copy of the selected source channels onto device channels 0/1 for formats
+    // we cannot decode; for the center selection both copies share one source
+    if (this->downmix_raw) {
+        for (const DownmixCopy &copy : this->downmix_copies) {
+            void *dst = copy.dst[double_buffer_index];
+            const void *src = copy.src[double_buffer_index];
+            if (dst != nullptr && src != nullptr && dst != src) {
+                std::memcpy(dst, src, this->downmix_bytes);
+            }
         }
+        return;
     }
+
+    // device channels 0/1 are sources as well; the mixer reads each block before writing it
+    this->downmix_matrix.process_planar(
+        this->downmix_sources[double_buffer_index],
+        this->downmix_sample_type,
+        this->downmix_outputs[double_buffer_index],
+        this->downmix_sample_type,
+        static_cast<size_t>(this->downmix_frames));
 }
 
 void __cdecl WrappedAsio::proxy_buffer_switch(long double_buffer_index, AsioBool direct_process) {
@@ -800,6 +849,7 @@ void __cdecl WrappedAsio::proxy_buffer_switch(long double_buffer_index, AsioBool
     if (self == nullptr) {
         return;
     }
+    telemetry::record_callback(self->telemetry, telemetry::now());
 
     // let the game write its samples into the driver buffers first, then rework them before
     // the driver plays this half on the next switch: downmix first (arrange channels 0/1),
@@ -807,6 +857,7 @@ void __cdecl WrappedAsio::proxy_buffer_switch(long double_buffer_index, AsioBool
     if (self->game_callbacks.buffer_switch != nullptr) {
         self->game_callbacks.buffer_switch(double_buffer_index, direct_process);
     }
+    telemetry::ProcessingScope processing(self->telemetry);
     self->apply_downmix(double_buffer_index);
     self->apply_output_volume(double_buffer_index);
 }
@@ -818,6 +869,7 @@ AsioTime * __cdecl WrappedAsio::proxy_buffer_switch_time_info(
     if (self == nullptr) {
         return params;
     }
+    telemetry::record_callback(self->telemetry, telemetry::now());
 
     AsioTime *ret = params;
     if (self->game_callbacks.buffer_switch_time_info != nullptr) {
@@ -826,6 +878,7 @@ AsioTime * __cdecl WrappedAsio::proxy_buffer_switch_time_info(
     } else if (self->game_callbacks.buffer_switch != nullptr) {
         self->game_callbacks.buffer_switch(double_buffer_index, direct_process);
     }
+    telemetry::ProcessingScope processing(self->telemetry);
     self->apply_downmix(double_buffer_index);
     self->apply_output_volume(double_buffer_index);
     return ret;
@@ -9,6 +9,8 @@
 
 #include "external/asio/asio.h"
 #include "external/asio/iasiodrv.h"
+#include "hooks/audio/mix.h"
+#include "hooks/audio/telemetry.h"
 
 namespace hooks::audio::asio {
 
@@ -50,14 +52,16 @@ struct WrappedAsio final : IAsio {
     // layout to the host so it proceeds to create_buffers, then opens only a two-channel
     // stream on the real device and routes the selected pair onto it (see create_buffers).
     // Front is the plain "force two channel" case (forward the device's own front pair);
-    // the others copy a different pair onto 0/1. assumes a standard 7.1 layout (0-indexed).
-    // set once at boot, before any wrapper exists, so it needs no synchronization
+    // the others mix a different pair (or, for AC4, every channel) onto 0/1. assumes a
+    // standard 7.1 layout (0-indexed). set once at boot, before any wrapper exists, so it
+    // needs no synchronization
     enum class StereoDownmix {
         None,   // feature disabled - full multichannel passthrough
-        Front,  // channels 0/1 - the device front pair is forwarded as-is (no copy)
+        Front,  // channels 0/1 - the device front pair is forwarded as-is (no mix)
         Center, // channel 2 duplicated to both 0 and 1
         Rear,   // channels 4/5 -> 0/1
         Side,   // channels 6/7 -> 0/1
+        AC4,    // all channels folded into 0/1 with AC-4 coefficients, LFE dropped
     };
     static StereoDownmix STEREO_DOWNMIX;
 
@@ -73,7 +77,7 @@ struct WrappedAsio final : IAsio {
     // stereo extraction is active
     static constexpr long FORCED_OUTPUT_CHANNELS = 8;
 
-    // maps an option string ("front", "center", "rear", "side") to a StereoDownmix value,
+    // maps an option string ("front", "center", "rear", "side", "ac4") to a StereoDownmix value,
     // returning None for anything unrecognized
     static StereoDownmix name_to_stereo_downmix(const char *name);
 
@@ -145,8 +149,8 @@ private:
     AsioSampleType device_output_sample_type();
 
     // locates the destination pair (device channels 0/1) and the configured source channels
-    // in the game's buffer set so the realtime path can copy the selected pair onto 0/1.
-    // a no-op unless STEREO_DOWNMIX selects a non-front pair. called at create_buffers time
+    // in the game's buffer set and builds the mix matrix the realtime path applies to them.
+    // a no-op unless STEREO_DOWNMIX selects a non-front mix. called at create_buffers time
     void record_downmix_channels(AsioBufferInfo *buffer_infos, long num_channels, long buffer_size);
 
     // publishes the captured post-process state to the realtime thread once the buffers
@@ -162,7 +166,7 @@ private:
     // by the volume boost. runs on the driver's realtime thread from our buffer switch
     void apply_output_volume(long double_buffer_index);
 
-    // copies the configured source channel pair onto device channels 0/1 for the given
+    // mixes the configured source channels onto device channels 0/1 for the given
     // double-buffer index. runs on the driver's realtime thread from our buffer switch
     void apply_downmix(long double_buffer_index);
 
@@ -224,7 +228,9 @@ private:
     std::vector<VolumeOutputChannel> volume_channels;
 
     // one device channel (0 or 1) fed by a source channel during stereo downmix; both
-    // buffer pointers are indexed by the ASIO double-buffer index, the same as the channels
+    // buffer pointers are indexed by the ASIO double-buffer index, the same as the channels.
+    // only used for sample formats the mixer cannot decode, where a selected pair is still
+    // routed with a raw copy
     struct DownmixCopy {
         void *dst[2];
         void *src[2];
@@ -232,9 +238,19 @@ private:
 
     // stereo downmix state, captured at create_buffers time and published alongside the
     // volume state; untouched while the stream runs. downmix_active gates whether the
-    // realtime path copies the selected source pair onto device channels 0/1. copies[0]
-    // feeds device channel 0, copies[1] feeds device channel 1
+    // realtime path touches device channels 0/1. source and output buffer sets are indexed
+    // by the ASIO double-buffer index, sources by 7.1 channel (null when the game did not
+    // create that channel). when downmix_raw is set, copies[0]/[1] feed device channels 0/1
     bool downmix_active = false;
+    bool downmix_raw = false;
+    hooks::audio::ChannelMatrix downmix_matrix;
+    SampleType downmix_sample_type = SampleType::UNSUPPORTED;
+    const void *downmix_sources[2][FORCED_OUTPUT_CHANNELS] {};
+    void *downmix_outputs[2][2] {};
+    long downmix_frames = 0;
     DownmixCopy downmix_copies[2] {};
     size_t downmix_bytes = 0;
+
+    // stream telemetry, armed alongside the effect state and recorded by the trampolines
+    hooks::audio::telemetry::Source telemetry { hooks::audio::telemetry::Stream::Asio };
 };
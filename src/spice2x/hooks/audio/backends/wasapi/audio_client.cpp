@@ -295,6 +295,23 @@ HRESULT STDMETHODCALLTYPE WrappedIAudioClient::Initialize(
     copy_wave_format(&hooks::audio::FORMAT, device_format);
     copy_wave_format(&this->device_format, device_format);
 
+    // arm the stream telemetry: the game is expected to release a buffer once per device
+    // period, and fill levels are measured against the real device buffer. custom backends
+    // never reach the device through us, they report on their own
+    if (!this->backend) {
+        UINT32 device_frames = 0;
+        REFERENCE_TIME default_period = 0, minimum_period = 0;
+        pReal->GetBufferSize(&device_frames);
+        if (hnsPeriodicity == 0) {
+            pReal->GetDevicePeriod(&default_period, &minimum_period);
+        }
+        const REFERENCE_TIME period = hnsPeriodicity != 0 ? hnsPeriodicity : default_period;
+        hooks::audio::telemetry::configure(
+                this->telemetry,
+                static_cast<uint32_t>(period / 10),
+                device_frames);
+    }
+
     // arm the shared-mode buffer bridge so the redirected game's full-buffer writes are paced to
     // the device instead of overflowing the shared buffer (AUDCLNT_E_BUFFER_TOO_LARGE).
     if (this->shared.redirected_from_exclusive) {
@@ -381,6 +398,11 @@ HRESULT STDMETHODCALLTYPE WrappedIAudioClient::GetCurrentPadding(UINT32 *pNumPad
 
     HRESULT ret = pReal->GetCurrentPadding(pNumPaddingFrames);
 
+    // device fill level, in device frames before any translation below
+    if (SUCCEEDED(ret) && pNumPaddingFrames) {
+        hooks::audio::telemetry::record_fill(this->telemetry, *pNumPaddingFrames);
+    }
+
     // the device buffer is at the resampled rate; report padding at the game's native rate so the
     // game's free-space calculation stays paced correctly.
     if (SUCCEEDED(ret) && this->resample.enabled && pNumPaddingFrames) {
@@ -6,6 +6,7 @@
 
 #include "hooks/audio/implementations/backend.h"
 #include "hooks/audio/audio_private.h"
+#include "hooks/audio/telemetry.h"
 #include "util/logging.h"
 
 #include "downmix.h"
@@ -113,4 +114,7 @@ struct WrappedIAudioClient : IAudioClient3 {
     // rate while the game keeps writing its native-rate audio into a scratch buffer that we
     // resample in the render client.
     hooks::audio::Resampler resample;
+
+    // stream telemetry of this client, armed in Initialize
+    hooks::audio::telemetry::Source telemetry { hooks::audio::telemetry::Stream::Wasapi };
 };
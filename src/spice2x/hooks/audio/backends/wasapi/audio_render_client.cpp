@@ -7,6 +7,7 @@
 
 #include "audio_client.h"
 #include "hooks/audio/audio.h"
+#include "hooks/audio/telemetry.h"
 #include "util.h"
 #include "wasapi_private.h"
 
@@ -109,6 +110,11 @@ HRESULT STDMETHODCALLTYPE WrappedIAudioRenderClient::ReleaseBuffer(UINT32 NumFra
         return S_OK;
     }
 
+    // one release per device period; everything below up to the device release is our own work
+    namespace telemetry = hooks::audio::telemetry;
+    telemetry::record_callback(this->client->telemetry, telemetry::now());
+    telemetry::ProcessingScope processing(this->client->telemetry);
+
     // downmix + resample chained: downmix the game's multi-channel scratch into the resampler's
     // stereo input scratch, then let the resampler convert and push it to the device. a silent
     // buffer skips the downmix and feeds silence straight through.
@@ -57,18 +57,26 @@ namespace hooks::audio {
         this->is_float = is_ieee_float(game_format);
 
         // supported: 16/24/32-bit integer PCM and 32-bit float; anything else mixes to silence
-        const bool supported = this->is_float
-            ? this->bytes_per_sample == 4
-            : (this->bytes_per_sample >= 2 && this->bytes_per_sample <= 4);
-        if (!supported) {
+        if (this->is_float) {
+            this->sample_type = this->bytes_per_sample == 4
+                ? SampleType::FLOAT_32
+                : SampleType::UNSUPPORTED;
+        } else {
+            switch (this->bytes_per_sample) {
+                case 2: this->sample_type = SampleType::SINT_16; break;
+                case 3: this->sample_type = SampleType::SINT_24; break;
+                case 4: this->sample_type = SampleType::SINT_32; break;
+                default: this->sample_type = SampleType::UNSUPPORTED; break;
+            }
+        }
+        if (this->sample_type == SampleType::UNSUPPORTED) {
             log_fatal(
                 "audio::downmix",
                 "unsupported sample format ({}-bit {}), downmix will output silence",
                 game_format->wBitsPerSample, this->is_float ? "float" : "int");
         }
 
-        this->left_mix.clear();
-        this->right_mix.clear();
+        this->mix.resize(game_format->nChannels, 2);
         this->build_layout_mix(game_format);
 
         make_stereo_format(game_format, stereo_out);
@@ -98,12 +106,12 @@ namespace hooks::audio {
 
     void Downmix::add_channel(int channel, DWORD speaker, float gain) {
         if (speaker & LEFT_SPEAKERS) {
-            this->left_mix.push_back({ channel, gain });
+            this->mix.add_gain(0, channel, gain);
         } else if (speaker & RIGHT_SPEAKERS) {
-            this->right_mix.push_back({ channel, gain });
+            this->mix.add_gain(1, channel, gain);
         } else { // center: feed both sides
-            this->left_mix.push_back({ channel, gain });
-            this->right_mix.push_back({ channel, gain });
+            this->mix.add_gain(0, channel, gain);
+            this->mix.add_gain(1, channel, gain);
         }
     }
 
@@ -135,12 +143,10 @@ namespace hooks::audio {
             }
         });
 
-        for (auto *mix : { &this->left_mix, &this->right_mix }) {
-            if (!mix->empty()) {
-                const float gain = 1.0f / mix->size();
-                for (auto &c : *mix) {
-                    c.gain = gain;
-                }
+        for (size_t output = 0; output < 2; output++) {
+            const size_t taps = this->mix.taps(output);
+            if (taps > 0) {
+                this->mix.scale_output(output, 1.0f / taps);
             }
         }
     }
@@ -148,7 +154,7 @@ namespace hooks::audio {
     // fallback when no speaker mask is present: fold interleaved L/R pairs (even->left, odd->right)
     void Downmix::build_pairs_mix(int channels, float gain) {
         for (int ch = 0; ch < channels; ch++) {
-            (((ch & 1) == 0) ? this->left_mix : this->right_mix).push_back({ ch, gain });
+            this->mix.add_gain(ch & 1, ch, gain);
         }
     }
 
@@ -187,30 +193,17 @@ namespace hooks::audio {
     }
 
     void Downmix::process(BYTE *dst, const BYTE *src, UINT32 frames) const {
-        const int bps = this->bytes_per_sample;
-        const int src_stride = this->game_frame_size;
-        const int dst_stride = 2 * bps;
+        if (dst == nullptr || src == nullptr || this->bytes_per_sample <= 0) {
+            return;
+        }
 
-        if (dst == nullptr || src == nullptr || bps <= 0) {
+        if (this->sample_type == SampleType::UNSUPPORTED) {
+            memset(dst, 0, (size_t) frames * 2 * this->bytes_per_sample);
             return;
         }
 
         // sum each speaker's source channels into the matching stereo output
-        for (UINT32 i = 0; i < frames; i++) {
-            const BYTE *in = src + (size_t) i * src_stride;
-            BYTE *out = dst + (size_t) i * dst_stride;
-
-            float left = 0.0f;
-            float right = 0.0f;
-            for (const auto &c : this->left_mix) {
-                left += read_sample(in + c.channel * bps, bps, this->is_float) * c.gain;
-            }
-            for (const auto &c : this->right_mix) {
-                right += read_sample(in + c.channel * bps, bps, this->is_float) * c.gain;
-            }
-            write_sample(out, bps, this->is_float, left);
-            write_sample(out + bps, bps, this->is_float, right);
-        }
+        this->mix.process_interleaved(src, this->sample_type, dst, this->sample_type, frames);
     }
 
     HRESULT Downmix::get_buffer(IAudioRenderClient *real, UINT32 frames, BYTE **ppData) {
@@ -8,6 +8,8 @@
 #include <audioclient.h>
 
 #include "hooks/audio/audio.h"
+#include "hooks/audio/buffer.h"
+#include "hooks/audio/mix.h"
 
 struct IAudioClient;
 struct IAudioRenderClient;
@@ -27,12 +29,6 @@ namespace hooks::audio {
     //               so its channels are equally loud, LFE dropped
     struct Downmix {
 
-        // a source channel routed into one output speaker at the given gain
-        struct Contribution {
-            int channel;
-            float gain;
-        };
-
         // map an option value (front/rear/side/ac4/normalize) to its algorithm.
         static std::optional<DownmixAlgorithm> name_to_algorithm(const char *value) {
             if (_stricmp(value, "front") == 0) {
@@ -77,6 +73,9 @@ namespace hooks::audio {
         // whether samples are IEEE floating point rather than integer PCM
         bool is_float = false;
 
+        // sample format of both the game and the device stream, UNSUPPORTED mixes to silence
+        SampleType sample_type = SampleType::UNSUPPORTED;
+
         // enable the downmix for the given game format and fill stereo_out with the equivalent
         // stereo format to open the real device with.
         void setup(const WAVEFORMATEX *game_format, WAVEFORMATEXTENSIBLE *stereo_out,
@@ -123,7 +122,7 @@ namespace hooks::audio {
         // build the mix from the source speaker layout for the selected algorithm
         void build_layout_mix(const WAVEFORMATEX *game_format);
 
-        // per-algorithm builders, each filling left_mix / right_mix from the speaker mask
+        // per-algorithm builders, each filling the stereo mix matrix from the speaker mask
         void build_ac4_mix(DWORD mask, int channels);
         void build_extract_mix(DWORD mask, int channels, DWORD keep);
         void build_normalize_mix(DWORD mask, int channels);
@@ -134,9 +133,8 @@ namespace hooks::audio {
         // append one source channel to the output side(s) matching its speaker, at `gain`
         void add_channel(int channel, DWORD speaker, float gain);
 
-        // source channels summed into each output speaker
-        std::vector<Contribution> left_mix;
-        std::vector<Contribution> right_mix;
+        // game channels -> stereo gains, output 0 is left and output 1 is right
+        ChannelMatrix mix;
 
         // buffer the game writes its multi-channel audio into between get/release
         std::vector<BYTE> scratch;
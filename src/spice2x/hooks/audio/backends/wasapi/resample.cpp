@@ -14,29 +14,6 @@
 
 namespace hooks::audio {
 
-    namespace {
-
-        constexpr double PI = 3.14159265358979323846;
-
-        // normalized sinc: sin(pi*x) / (pi*x), with the removable singularity at 0 filled in
-        inline double sinc(double x) {
-            if (x == 0.0) {
-                return 1.0;
-            }
-            const double px = PI * x;
-            return std::sin(px) / px;
-        }
-
-        // Blackman window across the kernel radius; zero at +/- radius
-        inline double blackman(double x, double radius) {
-            const double n = (x + radius) / (2.0 * radius);
-            if (n <= 0.0 || n >= 1.0) {
-                return 0.0;
-            }
-            return 0.42 - 0.5 * std::cos(2.0 * PI * n) + 0.08 * std::cos(4.0 * PI * n);
-        }
-    }
-
     std::optional<uint32_t> Resampler::resolve(const WAVEFORMATEX *game_format) {
         if (game_format == nullptr || !RESAMPLE_RATE.has_value()) {
             return std::nullopt;
@@ -56,6 +33,15 @@ namespace hooks::audio {
         this->game_frame_size = this->channels * this->bytes_per_sample;
 
         this->is_float = is_ieee_float(game_format);
+        if (this->is_float) {
+            this->sample_type = SampleType::FLOAT_32;
+        } else if (this->bytes_per_sample == 2) {
+            this->sample_type = SampleType::SINT_16;
+        } else if (this->bytes_per_sample == 3) {
+            this->sample_type = SampleType::SINT_24;
+        } else {
+            this->sample_type = SampleType::SINT_32;
+        }
 
         const bool supported = this->is_float
             ? this->bytes_per_sample == 4
@@ -70,16 +56,9 @@ namespace hooks::audio {
         this->src_rate = game_format->nSamplesPerSec;
         this->dst_rate = target_rate;
 
-        // anti-alias cutoff: full bandwidth when upsampling, scaled down when decimating
-        this->cutoff = std::min(1.0, (double) this->dst_rate / (double) this->src_rate);
-        this->half_taps = 16;
-
-        // precompute the windowed-sinc kernel now that cutoff is known
-        this->build_kernel();
-
-        // prime the queue with half a window of silence so the first outputs have left history
-        this->in_queue.assign((size_t) this->half_taps * this->channels, 0.0f);
-        this->in_pos = this->half_taps;
+        // the timer-driven path consumes at the exact src/dst ratio; event-driven streams switch
+        // to the advertised buffer ratio once the device buffer size is known (see initialize)
+        this->sinc.setup(this->channels, this->src_rate, this->dst_rate);
 
         this->make_device_format(game_format, device_out, target_rate);
     }
@@ -113,8 +92,19 @@ namespace hooks::audio {
         // they drain the pending output to the device's free space each call (flush_timer).
         this->event_driven = (stream_flags & AUDCLNT_STREAMFLAGS_EVENTCALLBACK) != 0;
 
-        return initialize_with_alignment_retry(real, "audio::resample", share_mode, stream_flags,
-                buffer_duration, periodicity, device_format, session_guid);
+        const HRESULT ret = initialize_with_alignment_retry(real, "audio::resample", share_mode,
+                stream_flags, buffer_duration, periodicity, device_format, session_guid);
+
+        // build the event-driven kernel here rather than on the first flush, which runs on the
+        // audio thread
+        if (SUCCEEDED(ret) && this->event_driven
+                && SUCCEEDED(real->GetBufferSize(&this->device_buffer_frames))
+                && this->device_buffer_frames > 0) {
+            this->sinc.set_step(this->frames_device_to_game(this->device_buffer_frames),
+                    this->device_buffer_frames);
+        }
+
+        return ret;
     }
 
     UINT32 Resampler::frames_device_to_game(UINT32 device_frames) const {
@@ -139,177 +129,42 @@ namespace hooks::audio {
             this->scratch.resize(needed);
         }
 
+        // make sure the input queue can take this block without growing on the audio thread
+        this->sinc.reserve(frames);
+
         *ppData = this->scratch.data();
 
         return S_OK;
     }
 
     void Resampler::enqueue_input(UINT32 frames, bool silent) {
-        const int bps = this->bytes_per_sample;
-        const int ch = this->channels;
-        const size_t base = this->in_queue.size();
-
-        this->in_queue.resize(base + (size_t) frames * ch);
-
-        if (silent || bps <= 0 || ch <= 0) {
-            std::fill(this->in_queue.begin() + base, this->in_queue.end(), 0.0f);
+        if (this->channels <= 0 || frames == 0) {
             return;
         }
 
-        const BYTE *src = this->scratch.data();
-        for (UINT32 f = 0; f < frames; f++) {
-            for (int c = 0; c < ch; c++) {
-                const size_t s = (size_t) f * ch + c;
-                this->in_queue[base + s] = read_sample(src + s * bps, bps, this->is_float);
-            }
+        float *dst = this->sinc.enqueue(frames);
+        const size_t samples = (size_t) frames * this->channels;
+        if (silent || this->bytes_per_sample <= 0) {
+            std::fill(dst, dst + samples, 0.0f);
+            return;
         }
-    }
 
-    void Resampler::build_kernel() {
-        const int taps = 2 * this->half_taps;
-        const int phases = this->kernel_phases;
-        const double cut = this->cutoff;
-        const double radius = (double) this->half_taps;
-
-        // one extra row at frac == 1.0 so emit_frame can interpolate against row p + 1 safely
-        this->kernel_table.resize((size_t) (phases + 1) * taps);
-
-        for (int p = 0; p <= phases; p++) {
-            const double frac = (double) p / (double) phases;
-            for (int k = 0; k < taps; k++) {
-                // tap k maps to input offset t = k - (half_taps - 1), matching emit_frame
-                const double x = frac - (double) (k - (this->half_taps - 1));
-                this->kernel_table[(size_t) p * taps + k] =
-                        (float) (cut * sinc(cut * x) * blackman(x, radius));
-            }
-        }
+        convert_samples(this->scratch.data(), this->sample_type, dst, SampleType::FLOAT_32, samples);
     }
 
-    void Resampler::emit_frame() {
-        const int ch = this->channels;
-        const int radius = this->half_taps;
-        const int taps = 2 * radius;
-        const long avail = (long) (this->in_queue.size() / ch);
-        const long center = (long) std::floor(this->in_pos);
-
-        // pick the two kernel rows bracketing this fractional position and the blend between them
-        const double frac = this->in_pos - (double) center;
-        const double fp = frac * (double) this->kernel_phases;
-        const int p0 = (int) fp;
-        const float blend = (float) (fp - (double) p0);
-        const float *row0 = &this->kernel_table[(size_t) p0 * taps];
-        const float *row1 = &this->kernel_table[(size_t) (p0 + 1) * taps];
-
-        // base input index for tap 0 (t = -(radius - 1))
-        const long base = center - (radius - 1);
-
-        for (int c = 0; c < ch; c++) {
-            double acc = 0.0;
-            for (int k = 0; k < taps; k++) {
-                const long idx = base + k;
-                if (idx < 0 || idx >= avail) {
-                    continue;
-                }
-                const float w = row0[k] + blend * (row1[k] - row0[k]);
-                acc += (double) this->in_queue[(size_t) idx * ch + c] * w;
-            }
-            this->out_float.push_back((float) acc);
-        }
-    }
-
-    void Resampler::drop_consumed() {
-        const int ch = this->channels;
-        const long drop = (long) std::floor(this->in_pos) - this->half_taps;
-        if (drop > 0) {
-            const size_t drop_samples = (size_t) drop * ch;
-            if (drop_samples <= this->in_queue.size()) {
-                this->in_queue.erase(this->in_queue.begin(),
-                        this->in_queue.begin() + drop_samples);
-                this->in_pos -= drop;
-            }
-        }
-    }
+    void Resampler::write_output(BYTE *dst, const float *src, UINT32 frames, float gain) const {
+        const size_t count = (size_t) frames * this->channels;
 
-    UINT32 Resampler::produce_exact(UINT32 out_frames) {
-        const int ch = this->channels;
-        this->out_float.clear();
-        if (ch <= 0 || out_frames == 0) {
-            return 0;
-        }
-        this->out_float.reserve((size_t) out_frames * ch);
-
-        // resample ratio. drive it from the buffer size actually advertised to the game rather
-        // than the nominal src/dst ratio: GetBufferSize reports floor(dev_buf * src/dst) game
-        // frames, so the game only ever delivers that many input frames per device period.
-        // consuming at the nominal ratio would eat slightly more input than arrives on any device
-        // where dev_buf * src/dst is non-integer (e.g. 144 -> 132.3, floored to 132), slowly
-        // draining the queue until it underruns to permanent silence. using the advertised integer
-        // ratio keeps input and output exactly balanced; the resulting pitch error is below 0.3%
-        // and inaudible, and it collapses to the exact ratio when the division is integer (160 ->
-        // 147 stays 147/160 = 44100/48000).
-        const double step = (double) this->frames_device_to_game(this->device_buffer_frames)
-                / (double) this->device_buffer_frames;
-
-        // input frames the block will touch: from in_pos through the right edge of the sinc kernel
-        // at the final output sample. if the queue is short of this, the kernel tail reads past the
-        // end and distorts every buffer, so buffer one extra block of input before the first output
-        // (emitting silence without consuming) to build a cushion the kernel can always reach into.
-        const long avail = (long) (this->in_queue.size() / ch);
-        const long need = (long) std::ceil(this->in_pos + step * (double) out_frames)
-                + this->half_taps;
-
-        if (this->priming) {
-            if (avail < need + (long) out_frames) {
-                this->out_float.assign((size_t) out_frames * ch, 0.0f);
-                return out_frames;
+        // float devices always get clamped output, like write_sample
+        if (this->is_float) {
+            auto out = reinterpret_cast<float *>(dst);
+            for (size_t i = 0; i < count; i++) {
+                out[i] = std::clamp(src[i] * gain, -1.0f, 1.0f);
             }
-            this->priming = false;
-        }
-
-        for (UINT32 o = 0; o < out_frames; o++) {
-            this->emit_frame();
-            this->in_pos += step;
-        }
-
-        this->drop_consumed();
-        return out_frames;
-    }
-
-    UINT32 Resampler::produce_variable() {
-        const int ch = this->channels;
-        if (ch <= 0) {
-            return 0;
-        }
-
-        // input frames consumed per output frame. timer-driven streams write variable partial
-        // chunks, so produce however many output frames the currently queued input can fully
-        // support and leave the rest for the next call; this keeps input and output balanced at
-        // the exact src/dst ratio over time without depending on the device buffer size.
-        const double step = (double) this->src_rate / (double) this->dst_rate;
-        const long avail = (long) (this->in_queue.size() / ch);
-
-        // emit only while the sinc kernel's right edge stays within the queued input. the kernel
-        // reaches from in_pos out to half_taps frames ahead, so stop once that would read past the
-        // end; the remaining input becomes the next block's lookahead.
-        UINT32 produced = 0;
-        while ((long) std::ceil(this->in_pos) + this->half_taps < avail) {
-            this->emit_frame();
-            this->in_pos += step;
-            produced++;
+            return;
         }
 
-        this->drop_consumed();
-        return produced;
-    }
-
-    void Resampler::write_output(BYTE *dst, UINT32 frames, float gain) const {
-        const int bps = this->bytes_per_sample;
-        const int ch = this->channels;
-        const size_t count = (size_t) frames * ch;
-
-        for (size_t i = 0; i < count; i++) {
-            write_sample(dst + i * bps, bps, this->is_float, this->out_float[i] * gain);
-        }
+        convert_samples(src, SampleType::FLOAT_32, dst, this->sample_type, count, gain);
     }
 
     HRESULT Resampler::flush(IAudioRenderClient *real, IAudioClient *client, UINT32 frames,
@@ -318,9 +173,13 @@ namespace hooks::audio {
             return S_OK;
         }
 
-        // cache the device buffer size once
+        // cache the device buffer size once (normally already done in initialize)
         if (this->device_buffer_frames == 0) {
             client->GetBufferSize(&this->device_buffer_frames);
+            if (this->event_driven && this->device_buffer_frames > 0) {
+                this->sinc.set_step(this->frames_device_to_game(this->device_buffer_frames),
+                        this->device_buffer_frames);
+            }
         }
         if (this->device_buffer_frames == 0) {
             return S_OK;
@@ -356,7 +215,7 @@ namespace hooks::audio {
         // event-driven exclusive streams must hand the device a full buffer every period and may
         // not push partial counts. resample the whole input block into exactly the device buffer
         // size.
-        const UINT32 produced = this->produce_exact(this->device_buffer_frames);
+        const auto produced = (UINT32) this->sinc.produce_exact(this->device_buffer_frames);
         if (produced == 0) {
             return S_OK;
         }
@@ -374,24 +233,19 @@ namespace hooks::audio {
             this->buffers_to_mute--;
         }
 
-        this->write_output(dev, produced, gain);
+        this->write_output(dev, this->sinc.output(), produced, gain);
 
         return real->ReleaseBuffer(produced, 0);
     }
 
     HRESULT Resampler::flush_timer(IAudioRenderClient *real, IAudioClient *client, float boost) {
 
-        // convert everything currently queued into the pending output FIFO (out_float). timer-
-        // driven games write variable partial chunks, so produce only what the queued input can
-        // fully support and keep the remainder for the next call.
-        this->produce_variable();
-
-        const int ch = this->channels;
-        if (ch <= 0) {
-            return S_OK;
-        }
+        // convert everything currently queued into the pending output FIFO. timer-driven games
+        // write variable partial chunks, so produce only what the queued input can fully support
+        // and keep the remainder for the next call.
+        this->sinc.produce_variable();
 
-        const UINT32 pending = (UINT32) (this->out_float.size() / ch);
+        const auto pending = (UINT32) this->sinc.output_frames();
         if (pending == 0) {
             return S_OK;
         }
@@ -425,12 +279,11 @@ namespace hooks::audio {
             this->buffers_to_mute--;
         }
 
-        this->write_output(dev, to_write, gain);
+        this->write_output(dev, this->sinc.output(), to_write, gain);
         ret = real->ReleaseBuffer(to_write, 0);
 
         // drop the frames just written from the front of the pending FIFO
-        this->out_float.erase(this->out_float.begin(),
-                this->out_float.begin() + (size_t) to_write * ch);
+        this->sinc.consume(to_write);
 
         return ret;
     }
@@ -9,6 +9,9 @@
 #include <audioclient.h>
 
 #include "hooks/audio/audio.h"
+#include "hooks/audio/buffer.h"
+
+#include "sinc_resampler.h"
 
 struct IAudioClient;
 struct IAudioRenderClient;
@@ -17,11 +20,10 @@ namespace hooks::audio {
 
     // Streaming sample-rate converter for the WASAPI render path. The real device is opened at the
     // target rate while the game keeps writing its native-rate audio into a scratch buffer; on
-    // release that buffer is converted with a windowed-sinc kernel and pushed to the device.
-    // Channel count and sample format are preserved; only the sample rate changes.
+    // release that buffer is converted with a windowed-sinc kernel (see SincResampler) and pushed
+    // to the device. Channel count and sample format are preserved; only the sample rate changes.
     //
-    // Frame counts differ between the two rates, so unlike the per-frame downmix this is stateful:
-    // a fractional read position and a window of input history carry across ReleaseBuffer calls,
+    // Frame counts differ between the two rates, so unlike the per-frame downmix this is stateful,
     // and the device buffer is only filled up to the space the device currently has free.
     struct Resampler {
 
@@ -82,60 +84,21 @@ namespace hooks::audio {
         // many frames as the device currently has free, keeping the remainder for the next call.
         HRESULT flush_timer(IAudioRenderClient *real, IAudioClient *client, float boost);
 
-        // produce exactly out_frames output frames using the fixed src/dst ratio. event-driven
-        // exclusive streams must fill the whole device buffer every period; a small input cushion
-        // is buffered first (see priming) so the sinc kernel always has lookahead.
-        UINT32 produce_exact(UINT32 out_frames);
-
-        // convert all input the kernel can fully support into the pending output FIFO (out_float),
-        // appending without clearing. returns the number of frames produced. used by the
-        // timer-driven path where output is drained to the device in device-paced chunks.
-        UINT32 produce_variable();
-
-        // convolve the windowed-sinc kernel at the current in_pos and append the resulting frame
-        // (one sample per channel) to out_float
-        void emit_frame();
-
-        // precompute the windowed-sinc kernel sampled at kernel_phases sub-sample positions, so
-        // emit_frame is a table lookup instead of recomputing sin/cos per tap (which is far too
-        // expensive to run per sample on the audio callback thread and causes underrun crackle).
-        void build_kernel();
-
-        // drop input frames that in_pos has advanced past, keeping a window of history for the
-        // next block's left context
-        void drop_consumed();
-
-        // convert the first `frames` of out_float to the device format, scaled by `gain`
-        void write_output(BYTE *dst, UINT32 frames, float gain) const;
+        // convert `frames` of interleaved float output to the device format, scaled by `gain`
+        void write_output(BYTE *dst, const float *src, UINT32 frames, float gain) const;
 
         // sample format of the stream
         int channels = 0;
         int bytes_per_sample = 0;
         bool is_float = false;
         int game_frame_size = 0;
+        SampleType sample_type = SampleType::UNSUPPORTED;
 
         uint32_t src_rate = 0;
         uint32_t dst_rate = 0;
 
-        // sinc low-pass cutoff (1.0 when upsampling, dst/src when downsampling) and window radius
-        double cutoff = 1.0;
-        int half_taps = 16;
-
-        // precomputed kernel: (kernel_phases + 1) rows of 2*half_taps weights, indexed by the
-        // fractional sample position (linearly interpolated between adjacent rows in emit_frame)
-        std::vector<float> kernel_table;
-        int kernel_phases = 1024;
-
-        // interleaved float input queue and the fractional read position within it (in frames)
-        std::vector<float> in_queue;
-        double in_pos = 0.0;
-
-        // emit silence until a full block of input lookahead has accumulated, so the sinc kernel
-        // never reads past the end of the queue (which would distort the tail of every buffer)
-        bool priming = true;
-
-        // interleaved float scratch for produced output
-        std::vector<float> out_float;
+        // the signal path
+        SincResampler sinc;
 
         // buffer the game writes its native-rate audio into between get_buffer / flush
         std::vector<BYTE> scratch;
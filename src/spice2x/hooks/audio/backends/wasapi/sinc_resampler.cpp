@@ -0,0 +1,364 @@
+#include "sinc_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
+namespace hooks::audio {
+
+    namespace {
+
+        constexpr double PI = 3.14159265358979323846;
+
+        // normalized sinc: sin(pi*x) / (pi*x), with the removable singularity at 0 filled in
+        inline double sinc(double x) {
+            if (x == 0.0) {
+                return 1.0;
+            }
+            const double px = PI * x;
+            return std::sin(px) / px;
+        }
+
+        // Blackman window across the kernel radius; zero at +/- radius
+        inline double blackman(double x, double radius) {
+            const double n = (x + radius) / (2.0 * radius);
+            if (n <= 0.0 || n >= 1.0) {
+                return 0.0;
+            }
+            return 0.42 - 0.5 * std::cos(2.0 * PI * n) + 0.08 * std::cos(4.0 * PI * n);
+        }
+
+        // weights for one fractional position; tap k maps to input offset k - (half_taps - 1)
+        void fill_kernel_row(float *row, double frac, double cutoff, int half_taps) {
+            const double radius = (double) half_taps;
+            for (int k = 0; k < 2 * half_taps; k++) {
+                const double x = frac - (double) (k - (half_taps - 1));
+                row[k] = (float) (cutoff * sinc(cutoff * x) * blackman(x, radius));
+            }
+        }
+
+        // dot products of one kernel row against `taps` consecutive interleaved frames. the
+        // callers guarantee all frames are in range, so there are no bounds checks here
+
+        void dot_generic(const float *in, const float *w, int taps, int ch, float *out) {
+            for (int c = 0; c < ch; c++) {
+                float acc[4] {};
+                for (int k = 0; k < taps; k += 4) {
+                    acc[0] += in[(k + 0) * ch + c] * w[k + 0];
+                    acc[1] += in[(k + 1) * ch + c] * w[k + 1];
+                    acc[2] += in[(k + 2) * ch + c] * w[k + 2];
+                    acc[3] += in[(k + 3) * ch + c] * w[k + 3];
+                }
+                out[c] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            }
+        }
+
+#if SIMD_X86
+        SIMD_TARGET_SSE2 void dot_mono_sse2(const float *in, const float *w, int taps, float *out) {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            for (int k = 0; k < taps; k += 8) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(in + k), _mm_loadu_ps(w + k)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(in + k + 4), _mm_loadu_ps(w + k + 4)));
+            }
+            __m128 acc = _mm_add_ps(acc0, acc1);
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+            out[0] = _mm_cvtss_f32(acc);
+        }
+
+        // two interleaved frames per register (L R L R), weights duplicated to match
+        SIMD_TARGET_SSE2 void dot_stereo_sse2(const float *in, const float *w, int taps, float *out) {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            for (int k = 0; k < taps; k += 4) {
+                const __m128 weights = _mm_loadu_ps(w + k);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(
+                        _mm_loadu_ps(in + k * 2), _mm_unpacklo_ps(weights, weights)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(
+                        _mm_loadu_ps(in + k * 2 + 4), _mm_unpackhi_ps(weights, weights)));
+            }
+            const __m128 acc = _mm_add_ps(acc0, acc1);
+            const __m128 sum = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            out[0] = _mm_cvtss_f32(sum);
+            out[1] = _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+        }
+#endif
+    }
+
+    void SincResampler::setup(int channels, uint32_t src_rate, uint32_t dst_rate) {
+        this->channels = channels;
+
+        // anti-alias cutoff: full bandwidth when upsampling, scaled down when decimating
+        this->cutoff = std::min(1.0, (double) dst_rate / (double) src_rate);
+
+#if SIMD_X86
+        this->use_sse2 = cpuutils::has_sse2();
+#endif
+
+        this->set_step(src_rate, dst_rate);
+
+        // prime the queue with half a window of silence so the first outputs have left history
+        this->in_buffer.assign((size_t) half_taps * this->channels, 0.0f);
+        this->in_start = 0;
+        this->in_end = half_taps;
+        this->in_index = half_taps;
+        this->in_phase = 0;
+        this->priming = true;
+        this->out_float.clear();
+        this->out_read = 0;
+    }
+
+    void SincResampler::reserve(size_t frames) {
+        const size_t queue_needed = (this->in_end - this->in_start + frames * 2 + taps)
+                * this->channels;
+        if (this->in_buffer.size() < queue_needed) {
+            this->in_buffer.resize(queue_needed);
+        }
+    }
+
+    float *SincResampler::enqueue(size_t frames) {
+        const int ch = this->channels;
+
+        // move the live window back to the front when the block does not fit behind it
+        const size_t capacity = this->in_buffer.size() / ch;
+        if (this->in_end + frames > capacity && this->in_start > 0) {
+            const size_t live = this->in_end - this->in_start;
+            memmove(this->in_buffer.data(), this->in_buffer.data() + this->in_start * ch,
+                    live * ch * sizeof(float));
+            this->in_start = 0;
+            this->in_end = live;
+        }
+        if (this->in_end + frames > this->in_buffer.size() / ch) {
+            this->in_buffer.resize((this->in_end + frames) * 2 * ch);
+        }
+
+        float *dst = this->in_buffer.data() + this->in_end * ch;
+        this->in_end += frames;
+        return dst;
+    }
+
+    void SincResampler::set_step(uint32_t num, uint32_t den) {
+        if (num == 0 || den == 0) {
+            return;
+        }
+        const uint32_t divisor = std::gcd(num, den);
+        num /= divisor;
+        den /= divisor;
+
+        // keep the current fractional position when the denominator changes
+        if (den != this->step_den) {
+            this->in_phase = (uint32_t) (((uint64_t) this->in_phase * den) / this->step_den);
+        }
+
+        this->step_num = num;
+        this->step_den = den;
+        this->step_whole = num / den;
+        this->step_rem = num % den;
+
+        if (den <= (uint32_t) kernel_phases) {
+            this->build_polyphase();
+        } else {
+            this->polyphase_table.clear();
+            if (this->kernel_table.empty()) {
+                this->build_kernel();
+            }
+        }
+    }
+
+    void SincResampler::build_kernel() {
+        const int phases = kernel_phases;
+
+        // one extra row at frac == 1.0 so emit_frame can interpolate against row p + 1 safely
+        this->kernel_table.resize((size_t) (phases + 1) * taps);
+
+        for (int p = 0; p <= phases; p++) {
+            fill_kernel_row(&this->kernel_table[(size_t) p * taps], (double) p / (double) phases,
+                    this->cutoff, half_taps);
+        }
+    }
+
+    void SincResampler::build_polyphase() {
+        const uint32_t phases = this->step_den;
+        this->polyphase_table.resize((size_t) phases * taps);
+
+        for (uint32_t p = 0; p < phases; p++) {
+            fill_kernel_row(&this->polyphase_table[(size_t) p * taps], (double) p / (double) phases,
+                    this->cutoff, half_taps);
+        }
+    }
+
+    void SincResampler::emit_frame(float *out) {
+        const int ch = this->channels;
+        const long avail = (long) (this->in_end - this->in_start);
+
+        // kernel row for this fractional position: exact from the polyphase bank, otherwise
+        // blended from the two bracketing rows of the fine table
+        const float *w;
+        if (!this->polyphase_table.empty()) {
+            w = &this->polyphase_table[(size_t) this->in_phase * taps];
+        } else {
+            const double fp = (double) this->in_phase * kernel_phases / (double) this->step_den;
+            const int p0 = (int) fp;
+            const float blend = (float) (fp - (double) p0);
+            const float *row0 = &this->kernel_table[(size_t) p0 * taps];
+            const float *row1 = &this->kernel_table[(size_t) (p0 + 1) * taps];
+            for (int k = 0; k < taps; k++) {
+                this->blended_row[k] = row0[k] + blend * (row1[k] - row0[k]);
+            }
+            w = this->blended_row.data();
+        }
+
+        // base input index for tap 0 (t = -(half_taps - 1))
+        const long base = this->in_index - (half_taps - 1);
+        const float *in = this->in_buffer.data() + this->in_start * ch;
+
+        // the window is fully inside the queue unless the input ran dry; drop_consumed always
+        // keeps half_taps frames of history, so only the right edge can fall short
+        if (base >= 0 && base + taps <= avail) {
+            const float *window = in + (size_t) base * ch;
+#if SIMD_X86
+            if (this->use_sse2 && ch == 2) {
+                dot_stereo_sse2(window, w, taps, out);
+                return;
+            }
+            if (this->use_sse2 && ch == 1) {
+                dot_mono_sse2(window, w, taps, out);
+                return;
+            }
+#endif
+            dot_generic(window, w, taps, ch, out);
+            return;
+        }
+
+        // starved: taps outside the queue contribute silence
+        for (int c = 0; c < ch; c++) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps; k++) {
+                const long idx = base + k;
+                if (idx < 0 || idx >= avail) {
+                    continue;
+                }
+                acc += in[(size_t) idx * ch + c] * w[k];
+            }
+            out[c] = acc;
+        }
+    }
+
+    void SincResampler::drop_consumed() {
+        const long drop = this->in_index - half_taps;
+        if (drop > 0 && (size_t) drop <= this->in_end - this->in_start) {
+            this->in_start += drop;
+            this->in_index -= drop;
+        }
+    }
+
+    size_t SincResampler::produce_exact(size_t out_frames) {
+        const int ch = this->channels;
+        this->out_float.clear();
+        this->out_read = 0;
+        if (ch <= 0 || out_frames == 0) {
+            return 0;
+        }
+        this->out_float.resize((size_t) out_frames * ch);
+
+        // resample ratio. drive it from the buffer size actually advertised to the game rather
+        // than the nominal src/dst ratio: GetBufferSize reports floor(dev_buf * src/dst) game
+        // frames, so the game only ever delivers that many input frames per device period.
+        // consuming at the nominal ratio would eat slightly more input than arrives on any device
+        // where dev_buf * src/dst is non-integer (e.g. 144 -> 132.3, floored to 132), slowly
+        // draining the queue until it underruns to permanent silence. using the advertised integer
+        // ratio keeps input and output exactly balanced; the resulting pitch error is below 0.3%
+        // and inaudible, and it collapses to the exact ratio when the division is integer (160 ->
+        // 147 stays 147/160 = 44100/48000). the step itself is set up in Resampler::initialize.
+
+        // input frames the block will touch: from the read position through the right edge of the
+        // sinc kernel at the final output sample. if the queue is short of this, the kernel tail
+        // reads past the end and distorts every buffer, so buffer one extra block of input before
+        // the first output (emitting silence without consuming) to build a cushion the kernel can
+        // always reach into.
+        const long avail = (long) (this->in_end - this->in_start);
+        const uint64_t end_phase = this->in_phase + (uint64_t) this->step_num * out_frames;
+        const long need = this->in_index
+                + (long) ((end_phase + this->step_den - 1) / this->step_den)
+                + half_taps;
+
+        if (this->priming) {
+            if (avail < need + (long) out_frames) {
+                std::fill(this->out_float.begin(), this->out_float.end(), 0.0f);
+                return out_frames;
+            }
+            this->priming = false;
+        }
+
+        float *out = this->out_float.data();
+        for (size_t o = 0; o < out_frames; o++) {
+            this->emit_frame(out + (size_t) o * ch);
+            this->advance();
+        }
+
+        this->drop_consumed();
+        return out_frames;
+    }
+
+    size_t SincResampler::produce_variable() {
+        const int ch = this->channels;
+        if (ch <= 0) {
+            return 0;
+        }
+
+        // input frames consumed per output frame. timer-driven streams write variable partial
+        // chunks, so produce however many output frames the currently queued input can fully
+        // support and leave the rest for the next call; this keeps input and output balanced at
+        // the exact src/dst ratio over time without depending on the device buffer size.
+        const long avail = (long) (this->in_end - this->in_start);
+
+        // move the unread output to the front and make room for every frame the queued input can
+        // support (an upper bound; the FIFO is trimmed to what was actually produced below)
+        const size_t pending = this->out_float.size() - this->out_read;
+        if (this->out_read > 0) {
+            memmove(this->out_float.data(), this->out_float.data() + this->out_read,
+                    pending * sizeof(float));
+            this->out_read = 0;
+        }
+        const long input_left = std::max(0L, avail - this->in_index);
+        const size_t max_frames = (size_t) (((uint64_t) input_left * this->step_den)
+                / this->step_num) + 1;
+        this->out_float.resize(pending + max_frames * ch);
+        float *out = this->out_float.data() + pending;
+
+        // emit only while the sinc kernel's right edge stays within the queued input. the kernel
+        // reaches from the read position out to half_taps frames ahead, so stop once that would
+        // read past the end; the remaining input becomes the next block's lookahead.
+        size_t produced = 0;
+        while (produced < max_frames
+                && this->in_index + (this->in_phase > 0 ? 1 : 0) + half_taps < avail) {
+            this->emit_frame(out + (size_t) produced * ch);
+            this->advance();
+            produced++;
+        }
+        this->out_float.resize(pending + (size_t) produced * ch);
+
+        this->drop_consumed();
+        return produced;
+    }
+
+    size_t SincResampler::output_frames() const {
+        if (this->channels <= 0) {
+            return 0;
+        }
+        return (this->out_float.size() - this->out_read) / this->channels;
+    }
+
+    void SincResampler::consume(size_t frames) {
+        this->out_read += frames * this->channels;
+        if (this->out_read >= this->out_float.size()) {
+            this->out_float.clear();
+            this->out_read = 0;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hooks::audio {
+
+    // Streaming windowed-sinc sample-rate converter on interleaved float frames, the signal path
+    // of the WASAPI Resampler. No Windows dependencies.
+    //
+    // Frame counts differ between the two rates, so this is stateful: a fractional read position
+    // and a window of input history carry across blocks.
+    //
+    // The read position advances by an exact rational step. When its denominator is small (e.g.
+    // 147/160 for 44.1k -> 48k) every sub-sample phase the stream can hit gets its own precomputed
+    // row of the polyphase filter bank; other ratios interpolate between rows of a finer table.
+    // Buffers only grow when the caller reserves a larger block, never in steady state.
+    class SincResampler {
+    public:
+
+        static constexpr int half_taps = 16;
+        static constexpr int taps = 2 * half_taps;
+
+        // start a stream of `channels` channels, consuming at src_rate / dst_rate. the queue is
+        // primed with half a window of silence so the first outputs have left history
+        void setup(int channels, uint32_t src_rate, uint32_t dst_rate);
+
+        // use step_num / step_den input frames per output frame and prepare the matching kernel
+        void set_step(uint32_t step_num, uint32_t step_den);
+
+        // make sure a block of `frames` can be queued next to the live window without growing
+        void reserve(size_t frames);
+
+        // append `frames` input frames to the queue, returns where to write their samples
+        float *enqueue(size_t frames);
+
+        // produce exactly out_frames output frames using the fixed step. a small input cushion
+        // is buffered first (see priming) so the sinc kernel always has lookahead; the output
+        // replaces whatever was pending
+        size_t produce_exact(size_t out_frames);
+
+        // convert all input the kernel can fully support, appending to the pending output.
+        // returns the number of frames produced
+        size_t produce_variable();
+
+        // pending output frames, oldest first
+        const float *output() const { return this->out_float.data() + this->out_read; }
+        size_t output_frames() const;
+
+        // drop `frames` frames from the front of the pending output
+        void consume(size_t frames);
+
+        int channel_count() const { return this->channels; }
+
+    private:
+
+        // convolve the windowed-sinc kernel at the current read position and write the resulting
+        // frame (one sample per channel) to out
+        void emit_frame(float *out);
+
+        // advance the read position by one output frame
+        void advance() {
+            this->in_index += this->step_whole;
+            this->in_phase += this->step_rem;
+            if (this->in_phase >= this->step_den) {
+                this->in_phase -= this->step_den;
+                this->in_index++;
+            }
+        }
+
+        // precompute the windowed-sinc kernel sampled at kernel_phases sub-sample positions, so
+        // emit_frame is a table lookup instead of recomputing sin/cos per tap (which is far too
+        // expensive to run per sample on the audio callback thread and causes underrun crackle).
+        void build_kernel();
+
+        // precompute one kernel row per phase of the current step (polyphase filter bank)
+        void build_polyphase();
+
+        // drop input frames that the read position has advanced past, keeping a window of history
+        // for the next block's left context
+        void drop_consumed();
+
+        int channels = 0;
+
+        // sinc low-pass cutoff (1.0 when upsampling, dst/src when downsampling) and window radius
+        double cutoff = 1.0;
+
+        // precomputed kernel: (kernel_phases + 1) rows of taps weights, indexed by the fractional
+        // sample position (linearly interpolated between adjacent rows in emit_frame)
+        std::vector<float> kernel_table;
+        static constexpr int kernel_phases = 1024;
+
+        // polyphase filter bank: step_den rows of taps weights, row p holding the kernel at the
+        // exact fraction p / step_den. empty when step_den is larger than kernel_phases
+        std::vector<float> polyphase_table;
+
+        // interleaved float input; frames [in_start, in_end) are queued. consumed frames are only
+        // skipped over, and the live window is moved back to the front when appending runs out of
+        // room, so consumption is O(1)
+        std::vector<float> in_buffer;
+        size_t in_start = 0;
+        size_t in_end = 0;
+
+        // read position within the queue: in_index + in_phase / step_den frames past in_start
+        long in_index = 0;
+        uint32_t in_phase = 0;
+
+        // input frames consumed per output frame, as step_whole + step_rem / step_den
+        uint32_t step_num = 1;
+        uint32_t step_den = 1;
+        uint32_t step_whole = 1;
+        uint32_t step_rem = 0;
+
+        // kernel row scratch for ratios without a polyphase bank
+        std::array<float, taps> blended_row {};
+
+        // stereo/mono dot products use SSE2 when available
+        bool use_sse2 = false;
+
+        // emit silence until a full block of input lookahead has accumulated, so the sinc kernel
+        // never reads past the end of the queue (which would distort the tail of every buffer)
+        bool priming = true;
+
+        // interleaved float scratch for produced output, a FIFO whose unread part starts at
+        // out_read (in samples)
+        std::vector<float> out_float;
+        size_t out_read = 0;
+    };
+}
@@ -1,10 +1,486 @@
 #include "buffer.h"
 
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
+namespace {
+
+    enum class KernelIsa {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    KernelIsa get_kernel_isa() {
+        static const KernelIsa isa = [] {
+#if SIMD_X86
+            if (cpuutils::has_avx2()) {
+                return KernelIsa::Avx2;
+            }
+            if (cpuutils::has_sse2()) {
+                return KernelIsa::Sse2;
+            }
+#endif
+            return KernelIsa::Scalar;
+        }();
+        return isa;
+    }
+
+    constexpr bool is_float_type(SampleType type) {
+        return type == SampleType::FLOAT_32 || type == SampleType::FLOAT_64;
+    }
+
+    // full scale of a sample type, i.e. the factor between the stored value and [-1, 1]
+    constexpr double sample_type_scale(SampleType type) {
+        switch (type) {
+            case SampleType::SINT_16:
+                return conversion_limits<int16_t>::absolute_max_value();
+            case SampleType::SINT_24:
+                return conversion_limits<int24_t>::absolute_max_value();
+            case SampleType::SINT_32:
+                return conversion_limits<int32_t>::absolute_max_value();
+            default:
+                return 1.0;
+        }
+    }
+
+    // saturation range for integer sample types
+    constexpr double sample_type_min(SampleType type) {
+        return -sample_type_scale(type);
+    }
+    constexpr double sample_type_max(SampleType type) {
+        return sample_type_scale(type) - 1.0;
+    }
+
+    inline int32_t load_s24(const uint8_t *p) {
+        return static_cast<int32_t>(
+                static_cast<uint32_t>(p[0]) << 8 |
+                static_cast<uint32_t>(p[1]) << 16 |
+                static_cast<uint32_t>(p[2]) << 24) >> 8;
+    }
+
+    inline void store_s24(uint8_t *p, int32_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+    }
+
+    /*
+     * scalar reference
+     */
+
+    template<SampleType S>
+    inline double load_sample(const uint8_t *p) {
+        if constexpr (S == SampleType::SINT_16) {
+            int16_t v;
+            memcpy(&v, p, sizeof(v));
+            return v / sample_type_scale(S);
+        } else if constexpr (S == SampleType::SINT_24) {
+            return load_s24(p) / sample_type_scale(S);
+        } else if constexpr (S == SampleType::SINT_32) {
+            int32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v / sample_type_scale(S);
+        } else if constexpr (S == SampleType::FLOAT_32) {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        } else {
+            double v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+    }
+
+    template<SampleType D>
+    inline void store_sample(uint8_t *p, double v, bool clamp) {
+        if constexpr (is_float_type(D)) {
+            if (clamp) {
+                v = std::clamp(v, -1.0, 1.0);
+            }
+            if constexpr (D == SampleType::FLOAT_32) {
+                const auto f = static_cast<float>(v);
+                memcpy(p, &f, sizeof(f));
+            } else {
+                memcpy(p, &v, sizeof(v));
+            }
+        } else {
+
+            // clamping before rounding is equivalent since the bounds are integers
+            v = std::clamp(v * sample_type_scale(D), sample_type_min(D), sample_type_max(D));
+            const auto i = static_cast<int32_t>(std::llround(v));
+            if constexpr (D == SampleType::SINT_16) {
+                const auto s = static_cast<int16_t>(i);
+                memcpy(p, &s, sizeof(s));
+            } else if constexpr (D == SampleType::SINT_24) {
+                store_s24(p, i);
+            } else {
+                memcpy(p, &i, sizeof(i));
+            }
+        }
+    }
+
+    template<SampleType S, SampleType D>
+    void convert_scalar(
+        const uint8_t *src, uint8_t *dst, size_t begin, size_t end, double gain, bool clamp, bool backward)
+    {
+        constexpr size_t SS = sample_type_size(S);
+        constexpr size_t DS = sample_type_size(D);
+        for (size_t n = begin; n < end; n++) {
+            const size_t i = backward ? end - 1 - (n - begin) : n;
+            store_sample<D>(dst + i * DS, load_sample<S>(src + i * SS) * gain, clamp);
+        }
+    }
+
+    /*
+     * SIMD kernels
+     *
+     * 16/24-bit and float sources are processed as floats: every value they can hold is exact
+     * in single precision, so without gain the results are identical to the scalar path.
+     * 32-bit integer sources need double precision for that and use a separate kernel.
+     */
+
+    template<SampleType S>
+    constexpr bool has_float_kernel() {
+        return S == SampleType::SINT_16 || S == SampleType::SINT_24 || S == SampleType::FLOAT_32;
+    }
+
+    template<SampleType D>
+    constexpr bool has_store_kernel() {
+        return D == SampleType::SINT_16 || D == SampleType::SINT_24 ||
+               D == SampleType::SINT_32 || D == SampleType::FLOAT_32;
+    }
+
+#if SIMD_X86
+
+    // SSE2, 4 samples per iteration
+
+    template<SampleType S>
+    SIMD_TARGET_SSE2 SIMD_INLINE __m128 sse2_load_ps(const uint8_t *p) {
+        if constexpr (S == SampleType::SINT_16) {
+            const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        } else if constexpr (S == SampleType::SINT_24) {
+            return _mm_cvtepi32_ps(_mm_setr_epi32(
+                    load_s24(p), load_s24(p + 3), load_s24(p + 6), load_s24(p + 9)));
+        } else {
+            return _mm_loadu_ps(reinterpret_cast<const float *>(p));
+        }
+    }
+
+    // rounds half away from zero after saturating to [lo, hi]; lanes at 2^31 or above would
+    // overflow the conversion and are saturated to INT32_MAX instead
+    SIMD_TARGET_SSE2 SIMD_INLINE __m128i sse2_round_ps(__m128 v, __m128 lo, __m128 hi) {
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        __m128i t = _mm_cvttps_epi32(v);
+        const __m128 frac = _mm_sub_ps(v, _mm_cvtepi32_ps(t));
+        t = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f))));
+        t = _mm_add_epi32(t, _mm_castps_si128(_mm_cmple_ps(frac, _mm_set1_ps(-0.5f))));
+        const __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.f)));
+        return _mm_or_si128(
+                _mm_andnot_si128(overflow, t),
+                _mm_and_si128(overflow, _mm_set1_epi32(INT32_MAX)));
+    }
+
+    // same as above for two doubles, result in the lower two 32-bit lanes
+    SIMD_TARGET_SSE2 SIMD_INLINE __m128i sse2_round_pd(__m128d v, __m128d lo, __m128d hi) {
+        v = _mm_min_pd(_mm_max_pd(v, lo), hi);
+        __m128d t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(v));
+        const __m128d frac = _mm_sub_pd(v, t);
+        const __m128d one = _mm_set1_pd(1.0);
+        t = _mm_add_pd(t, _mm_and_pd(_mm_cmpge_pd(frac, _mm_set1_pd(0.5)), one));
+        t = _mm_sub_pd(t, _mm_and_pd(_mm_cmple_pd(frac, _mm_set1_pd(-0.5)), one));
+        return _mm_cvttpd_epi32(t);
+    }
+
+    template<SampleType D>
+    SIMD_TARGET_SSE2 SIMD_INLINE void sse2_store_epi32(uint8_t *p, __m128i v) {
+        if constexpr (D == SampleType::SINT_16) {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(v, v));
+        } else if constexpr (D == SampleType::SINT_24) {
+            alignas(16) int32_t values[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(values), v);
+            for (size_t i = 0; i < 4; i++) {
+                store_s24(p + i * 3, values[i]);
+            }
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+        }
+    }
+
+    template<SampleType S, SampleType D>
+    SIMD_TARGET_SSE2 void sse2_convert(
+        const uint8_t *src, uint8_t *dst, size_t blocks, double gain, bool clamp, bool backward)
+    {
+        constexpr size_t SS = sample_type_size(S) * 4;
+        constexpr size_t DS = sample_type_size(D) * 4;
+        const __m128 lo = _mm_set1_ps(static_cast<float>(sample_type_min(D)));
+        const __m128 hi = _mm_set1_ps(static_cast<float>(sample_type_max(D)));
+        const __m128d lo_pd = _mm_set1_pd(sample_type_min(D));
+        const __m128d hi_pd = _mm_set1_pd(sample_type_max(D));
+
+        // gain and both full scales fused into a single multiplier
+        const double factor = gain * sample_type_scale(D) / sample_type_scale(S);
+        const __m128 factor_ps = _mm_set1_ps(static_cast<float>(factor));
+        const __m128d factor_pd = _mm_set1_pd(factor);
+
+        for (size_t n = 0; n < blocks; n++) {
+            const size_t b = backward ? blocks - 1 - n : n;
+            const uint8_t *s = src + b * SS;
+            uint8_t *d = dst + b * DS;
+
+            if constexpr (S == SampleType::SINT_32) {
+                const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+                const __m128d v0 = _mm_mul_pd(_mm_cvtepi32_pd(raw), factor_pd);
+                const __m128d v1 = _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(raw, 8)), factor_pd);
+                if constexpr (D == SampleType::FLOAT_32) {
+                    __m128 v = _mm_movelh_ps(_mm_cvtpd_ps(v0), _mm_cvtpd_ps(v1));
+                    if (clamp) {
+                        v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f));
+                    }
+                    _mm_storeu_ps(reinterpret_cast<float *>(d), v);
+                } else {
+                    sse2_store_epi32<D>(d, _mm_unpacklo_epi64(
+                            sse2_round_pd(v0, lo_pd, hi_pd),
+                            sse2_round_pd(v1, lo_pd, hi_pd)));
+                }
+            } else {
+                const __m128 v = _mm_mul_ps(sse2_load_ps<S>(s), factor_ps);
+                if constexpr (D == SampleType::FLOAT_32) {
+                    _mm_storeu_ps(reinterpret_cast<float *>(d), clamp
+                            ? _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f))
+                            : v);
+                } else {
+                    sse2_store_epi32<D>(d, sse2_round_ps(v, lo, hi));
+                }
+            }
+        }
+    }
+
+    // AVX2, 8 samples per iteration
+
+    template<SampleType S>
+    SIMD_TARGET_AVX2 SIMD_INLINE __m256 avx2_load_ps(const uint8_t *p) {
+        if constexpr (S == SampleType::SINT_16) {
+            return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+        } else if constexpr (S == SampleType::SINT_24) {
+            return _mm256_cvtepi32_ps(_mm256_setr_epi32(
+                    load_s24(p), load_s24(p + 3), load_s24(p + 6), load_s24(p + 9),
+                    load_s24(p + 12), load_s24(p + 15), load_s24(p + 18), load_s24(p + 21)));
+        } else {
+            return _mm256_loadu_ps(reinterpret_cast<const float *>(p));
+        }
+    }
+
+    SIMD_TARGET_AVX2 SIMD_INLINE __m256i avx2_round_ps(__m256 v, __m256 lo, __m256 hi) {
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        __m256i t = _mm256_cvttps_epi32(v);
+        const __m256 frac = _mm256_sub_ps(v, _mm256_cvtepi32_ps(t));
+        t = _mm256_sub_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(frac, _mm256_set1_ps(0.5f), _CMP_GE_OQ)));
+        t = _mm256_add_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(frac, _mm256_set1_ps(-0.5f), _CMP_LE_OQ)));
+        const __m256i overflow = _mm256_castps_si256(
+                _mm256_cmp_ps(v, _mm256_set1_ps(2147483648.f), _CMP_GE_OQ));
+        return _mm256_blendv_epi8(t, _mm256_set1_epi32(INT32_MAX), overflow);
+    }
+
+    SIMD_TARGET_AVX2 SIMD_INLINE __m128i avx2_round_pd(__m256d v, __m256d lo, __m256d hi) {
+        v = _mm256_min_pd(_mm256_max_pd(v, lo), hi);
+        __m256d t = _mm256_round_pd(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __m256d frac = _mm256_sub_pd(v, t);
+        const __m256d one = _mm256_set1_pd(1.0);
+        t = _mm256_add_pd(t, _mm256_and_pd(_mm256_cmp_pd(frac, _mm256_set1_pd(0.5), _CMP_GE_OQ), one));
+        t = _mm256_sub_pd(t, _mm256_and_pd(_mm256_cmp_pd(frac, _mm256_set1_pd(-0.5), _CMP_LE_OQ), one));
+        return _mm256_cvttpd_epi32(t);
+    }
+
+    template<SampleType D>
+    SIMD_TARGET_AVX2 SIMD_INLINE void avx2_store_epi32(uint8_t *p, __m256i v) {
+        if constexpr (D == SampleType::SINT_16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(
+                    _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+        } else if constexpr (D == SampleType::SINT_24) {
+            alignas(32) int32_t values[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(values), v);
+            for (size_t i = 0; i < 8; i++) {
+                store_s24(p + i * 3, values[i]);
+            }
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+        }
+    }
+
+    template<SampleType S, SampleType D>
+    SIMD_TARGET_AVX2 void avx2_convert(
+        const uint8_t *src, uint8_t *dst, size_t blocks, double gain, bool clamp, bool backward)
+    {
+        constexpr size_t SS = sample_type_size(S) * 8;
+        constexpr size_t DS = sample_type_size(D) * 8;
+        const __m256 lo = _mm256_set1_ps(static_cast<float>(sample_type_min(D)));
+        const __m256 hi = _mm256_set1_ps(static_cast<float>(sample_type_max(D)));
+        const __m256d lo_pd = _mm256_set1_pd(sample_type_min(D));
+        const __m256d hi_pd = _mm256_set1_pd(sample_type_max(D));
+        const __m256 neg_one = _mm256_set1_ps(-1.f);
+        const __m256 one = _mm256_set1_ps(1.f);
+
+        const double factor = gain * sample_type_scale(D) / sample_type_scale(S);
+        const __m256 factor_ps = _mm256_set1_ps(static_cast<float>(factor));
+        const __m256d factor_pd = _mm256_set1_pd(factor);
+
+        for (size_t n = 0; n < blocks; n++) {
+            const size_t b = backward ? blocks - 1 - n : n;
+            const uint8_t *s = src + b * SS;
+            uint8_t *d = dst + b * DS;
+
+            if constexpr (S == SampleType::SINT_32) {
+                const __m128i raw0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+                const __m128i raw1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 16));
+                const __m256d v0 = _mm256_mul_pd(_mm256_cvtepi32_pd(raw0), factor_pd);
+                const __m256d v1 = _mm256_mul_pd(_mm256_cvtepi32_pd(raw1), factor_pd);
+                if constexpr (D == SampleType::FLOAT_32) {
+                    __m256 v = _mm256_set_m128(_mm256_cvtpd_ps(v1), _mm256_cvtpd_ps(v0));
+                    if (clamp) {
+                        v = _mm256_min_ps(_mm256_max_ps(v, neg_one), one);
+                    }
+                    _mm256_storeu_ps(reinterpret_cast<float *>(d), v);
+                } else {
+                    avx2_store_epi32<D>(d, _mm256_set_m128i(
+                            avx2_round_pd(v1, lo_pd, hi_pd),
+                            avx2_round_pd(v0, lo_pd, hi_pd)));
+                }
+            } else {
+                const __m256 v = _mm256_mul_ps(avx2_load_ps<S>(s), factor_ps);
+                if constexpr (D == SampleType::FLOAT_32) {
+                    _mm256_storeu_ps(reinterpret_cast<float *>(d), clamp
+                            ? _mm256_min_ps(_mm256_max_ps(v, neg_one), one)
+                            : v);
+                } else {
+                    avx2_store_epi32<D>(d, avx2_round_ps(v, lo, hi));
+                }
+            }
+        }
+    }
+
+#endif
+
+    /*
+     * dispatch
+     */
+
+    template<SampleType S, SampleType D>
+    void convert_kernel(const uint8_t *src, uint8_t *dst, size_t count, float gain, bool backward) {
+        const bool clamp = gain != 1.f;
+        size_t width = 1;
+        void (*simd)(const uint8_t *, uint8_t *, size_t, double, bool, bool) = nullptr;
+
+#if SIMD_X86
+        if constexpr ((has_float_kernel<S>() || S == SampleType::SINT_32) && has_store_kernel<D>()) {
+            switch (get_kernel_isa()) {
+                case KernelIsa::Avx2:
+                    width = 8;
+                    simd = avx2_convert<S, D>;
+                    break;
+                case KernelIsa::Sse2:
+                    width = 4;
+                    simd = sse2_convert<S, D>;
+                    break;
+                default:
+                    break;
+            }
+        }
+#endif
+
+        if (simd == nullptr) {
+            convert_scalar<S, D>(src, dst, 0, count, gain, clamp, backward);
+            return;
+        }
+
+        // in place widening runs back to front so no source sample is overwritten before it was read
+        const size_t blocks = count / width;
+        const size_t tail = blocks * width;
+        if (backward) {
+            convert_scalar<S, D>(src, dst, tail, count, gain, clamp, true);
+            simd(src, dst, blocks, gain, clamp, true);
+        } else {
+            simd(src, dst, blocks, gain, clamp, false);
+            convert_scalar<S, D>(src, dst, tail, count, gain, clamp, false);
+        }
+    }
+
+    typedef void (*convert_kernel_t)(const uint8_t *, uint8_t *, size_t, float, bool);
+
+    template<SampleType S>
+    constexpr convert_kernel_t get_convert_kernel(SampleType dest_type) {
+        switch (dest_type) {
+            case SampleType::SINT_16:
+                return convert_kernel<S, SampleType::SINT_16>;
+            case SampleType::SINT_24:
+                return convert_kernel<S, SampleType::SINT_24>;
+            case SampleType::SINT_32:
+                return convert_kernel<S, SampleType::SINT_32>;
+            case SampleType::FLOAT_32:
+                return convert_kernel<S, SampleType::FLOAT_32>;
+            case SampleType::FLOAT_64:
+                return convert_kernel<S, SampleType::FLOAT_64>;
+            default:
+                return nullptr;
+        }
+    }
+
+    convert_kernel_t get_convert_kernel(SampleType source_type, SampleType dest_type) {
+        switch (source_type) {
+            case SampleType::SINT_16:
+                return get_convert_kernel<SampleType::SINT_16>(dest_type);
+            case SampleType::SINT_24:
+                return get_convert_kernel<SampleType::SINT_24>(dest_type);
+            case SampleType::SINT_32:
+                return get_convert_kernel<SampleType::SINT_32>(dest_type);
+            case SampleType::FLOAT_32:
+                return get_convert_kernel<SampleType::FLOAT_32>(dest_type);
+            case SampleType::FLOAT_64:
+                return get_convert_kernel<SampleType::FLOAT_64>(dest_type);
+            default:
+                return nullptr;
+        }
+    }
+}
+
+void convert_samples(
+    const void *source,
+    const SampleType source_type,
+    void *dest,
+    const SampleType dest_type,
+    const size_t count,
+    const float gain)
+{
+    const auto src = reinterpret_cast<const uint8_t *>(source);
+    const auto dst = reinterpret_cast<uint8_t *>(dest);
+
+    // nothing to do
+    if (count == 0 || (source_type == dest_type && gain == 1.f)) {
+        if (count > 0 && src != dst) {
+            memcpy(dst, src, count * sample_type_size(source_type));
+        }
+        return;
+    }
+
+    const auto kernel = get_convert_kernel(source_type, dest_type);
+    if (kernel == nullptr) {
+        return;
+    }
+
+    const bool backward = src == dst && sample_type_size(dest_type) > sample_type_size(source_type);
+    kernel(src, dst, count, gain, backward);
+}
+
+void apply_gain(void *buffer, const SampleType sample_type, const size_t count, const float gain) {
+    convert_samples(buffer, sample_type, buffer, sample_type, count, gain);
+}
+
 void convert_sample_type(
     const size_t channels,
     uint8_t *buffer,
     const size_t source_size,
-    std::vector<double> &temp_buffer,
     const SampleType source_type,
     const SampleType dest_type)
 {
@@ -14,86 +490,12 @@ void convert_sample_type(
     }
 
     const size_t source_sample_size = sample_type_size(source_type);
-
-    // number of samples *per channel*
-    const size_t num_samples = source_size / source_sample_size / channels;
-
-    // calculate the required size for the temporary buffer
-    // samples are converted to doubles and then converted to the target sample type
-    const size_t temp_size = num_samples * channels;
-
-    // resize temporary buffer if needed
-    if (temp_buffer.size() < temp_size) {
-        temp_buffer.resize(temp_size);
-    }
-
-#define SAMPLE_LOOP(VAR) for (size_t VAR = 0; VAR < num_samples * channels; VAR++)
-
-// converts to double in temporary buffer
-#define CONVERT_LOOP(TY) \
-    do { \
-        const auto source = reinterpret_cast<TY *>(buffer); \
-        SAMPLE_LOOP(i) { \
-            temp_buffer[i] = convert_number_to_double<TY>(source[i]); \
-        } \
-    } while (0)
-
-// converts double back to desired format
-#define STORE_LOOP(TY) \
-    do { \
-        const auto dest = reinterpret_cast<TY *>(buffer); \
-        SAMPLE_LOOP(i) { \
-            dest[i] = convert_double_to_number<TY>(temp_buffer[i]); \
-        } \
-    } while (0)
-
-// converts double to float
-#define STORE_LOOP_FLOAT() \
-    do { \
-        const auto dest = reinterpret_cast<float *>(buffer); \
-        SAMPLE_LOOP(i) { \
-            dest[i] = static_cast<float>(temp_buffer[i]); \
-        } \
-    } while (0)
-
-    if (source_type == SampleType::SINT_16) {
-        CONVERT_LOOP(int16_t);
-    } else if (source_type == SampleType::SINT_24) {
-        const auto source = reinterpret_cast<int24_t *>(buffer);
-
-        SAMPLE_LOOP(i) {
-            temp_buffer[i] = convert_number_to_double<int32_t, int24_t>(source[i].as_int());
-        }
-    } else if (source_type == SampleType::SINT_32) {
-        CONVERT_LOOP(int32_t);
-    } else if (source_type == SampleType::FLOAT_32) {
-        const auto source = reinterpret_cast<float *>(buffer);
-
-        SAMPLE_LOOP(i) {
-            temp_buffer[i] = source[i];
-        }
-    } else if (source_type == SampleType::FLOAT_64) {
-        memcpy(temp_buffer.data(), buffer, temp_size);
-    } else {
+    if (source_sample_size == 0 || channels == 0) {
         return;
     }
 
-    if (dest_type == SampleType::SINT_16) {
-        STORE_LOOP(int16_t);
-    } else if (dest_type == SampleType::SINT_24) {
-        STORE_LOOP(int24_t);
-    } else if (dest_type == SampleType::SINT_32) {
-        STORE_LOOP(int32_t);
-    } else if (dest_type == SampleType::FLOAT_32) {
-        STORE_LOOP_FLOAT();
-    } else if (dest_type == SampleType::FLOAT_64) {
-        memcpy(buffer, temp_buffer.data(), temp_size);
-    } else {
-        return;
-    }
+    // number of samples *per channel*
+    const size_t num_samples = source_size / source_sample_size / channels;
 
-#undef STORE_LOOP_FLOAT
-#undef STORE_LOOP
-#undef CONVERT_LOOP
-#undef SAMPLE_LOOP
+    convert_samples(buffer, source_type, buffer, dest_type, num_samples * channels);
 }
@@ -153,10 +153,30 @@ static constexpr size_t required_buffer_size(
     return num_frames * channels * sample_type_size(dest_sample_type);
 }
 
+/*
+ * Converts `count` samples from `source_type` to `dest_type`, scaling them by `gain` on the way.
+ *
+ * `source` and `dest` must either not overlap or point to the same buffer (in place conversion,
+ * in which case the buffer has to be large enough for the destination samples). Integer
+ * destinations saturate and round half away from zero like `convert_double_to_number`; float
+ * destinations are clamped to [-1, 1] only when a gain is applied. Uses SSE2/AVX2 when the CPU
+ * supports it and never allocates, so it is safe to call from realtime audio threads.
+ */
+void convert_samples(
+    const void *source,
+    const SampleType source_type,
+    void *dest,
+    const SampleType dest_type,
+    const size_t count,
+    const float gain = 1.f);
+
+// scales `count` samples of the given type in place, see `convert_samples`
+void apply_gain(void *buffer, const SampleType sample_type, const size_t count, const float gain);
+
+// in place conversion of an interleaved buffer of `source_size` bytes
 void convert_sample_type(
     const size_t channels,
     uint8_t *buffer,
     const size_t source_size,
-    std::vector<double> &temp_buffer,
     const SampleType source_type,
     const SampleType dest_type);
@@ -1077,7 +1077,6 @@ HRESULT AsioBackend::on_release_buffer(uint32_t num_frames_written, DWORD flags)
             channels,
             reinterpret_cast<uint8_t *>(this->active_sound_buffer),
             length,
-            this->conversion_sound_buffer,
             convert_windows_format(this->format_),
             sample_type);
 
@@ -148,6 +148,5 @@ private:
     WAVEFORMATEXTENSIBLE last_checked_format {};
 
     //std::vector<BYTE> last_sound_buffer;
-    std::vector<double> conversion_sound_buffer;
     BYTE *active_sound_buffer = nullptr;
 };
@@ -64,6 +64,12 @@ HRESULT WaveOutBackend::init(uint32_t buffer_size) {
         }
     }
 
+    // arm the stream telemetry; fill levels are counted in queued buffers, not frames
+    hooks::audio::telemetry::configure(
+            this->telemetry,
+            static_cast<uint32_t>(WASAPI_TARGET_REFTIME / 10),
+            _countof(this->hdrs));
+
     // mark as initialized
     this->initialized = true;
 
@@ -185,6 +191,19 @@ HRESULT WaveOutBackend::on_get_buffer(uint32_t num_frames_requested, BYTE **ppDa
     return S_OK;
 }
 HRESULT WaveOutBackend::on_release_buffer(uint32_t num_frames_written, DWORD dwFlags) {
+    namespace telemetry = hooks::audio::telemetry;
+    telemetry::record_callback(this->telemetry, telemetry::now());
+    telemetry::ProcessingScope processing(this->telemetry);
+
+    // buffers still queued on the device; none left means it ran dry
+    uint32_t queued = 0;
+    for (const WAVEHDR &hdr : this->hdrs) {
+        if ((hdr.dwFlags & WHDR_DONE) == 0) {
+            queued++;
+        }
+    }
+    telemetry::record_fill(this->telemetry, queued);
+
     bool written = false;
     timeutils::PreciseSleepTimer timer;
 
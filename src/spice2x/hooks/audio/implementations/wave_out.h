@@ -3,6 +3,8 @@
 #include <mmdeviceapi.h>
 #include <mmsystem.h>
 
+#include "hooks/audio/telemetry.h"
+
 #include "backend.h"
 
 #define WASAPI_BUFFER_COUNT 3
@@ -55,4 +57,6 @@ private:
     HWAVEOUT handle = nullptr;
     WAVEHDR hdrs[WASAPI_BUFFER_COUNT] {};
     BYTE *active_sound_buffer = nullptr;
+
+    hooks::audio::telemetry::Source telemetry { hooks::audio::telemetry::Stream::WaveOut };
 };
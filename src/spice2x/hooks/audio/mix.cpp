@@ -0,0 +1,353 @@
+#include "mix.h"
+
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
+namespace hooks::audio {
+
+    namespace {
+
+        // floats of scratch per block, split between the decoded inputs and the mixed outputs
+        constexpr size_t BLOCK_SAMPLES = 2048;
+
+        bool use_sse2() {
+#if SIMD_X86
+            static const bool sse2 = cpuutils::has_sse2();
+            return sse2;
+#else
+            return false;
+#endif
+        }
+
+        inline float clamp_unit(float v) {
+            return std::clamp(v, -1.f, 1.f);
+        }
+
+        /*
+         * scalar reference
+         */
+
+        void mix_interleaved_scalar(
+            const float *in, size_t inputs, float *out, size_t outputs,
+            const float *matrix, size_t stride, size_t frames)
+        {
+            for (size_t f = 0; f < frames; f++) {
+                const float *s = in + f * inputs;
+                float *d = out + f * outputs;
+                for (size_t o = 0; o < outputs; o++) {
+                    const float *row = matrix + o * stride;
+                    float acc = 0.f;
+                    for (size_t i = 0; i < inputs; i++) {
+                        acc += s[i] * row[i];
+                    }
+                    d[o] = clamp_unit(acc);
+                }
+            }
+        }
+
+        void mix_planar_scalar(
+            const float *const *planes, const float *gains, size_t count, float *out, size_t frames)
+        {
+            for (size_t f = 0; f < frames; f++) {
+                float acc = 0.f;
+                for (size_t p = 0; p < count; p++) {
+                    acc += planes[p][f] * gains[p];
+                }
+                out[f] = clamp_unit(acc);
+            }
+        }
+
+#if SIMD_X86
+
+        /*
+         * SSE2 kernels
+         */
+
+        // loads N floats (N <= 4) into the low lanes, zeroing the rest
+        template<size_t N>
+        SIMD_TARGET_SSE2 SIMD_INLINE __m128 sse2_load_partial(const float *p) {
+            if constexpr (N >= 4) {
+                return _mm_loadu_ps(p);
+            } else if constexpr (N == 3) {
+                return _mm_movelh_ps(
+                        _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p))),
+                        _mm_load_ss(p + 2));
+            } else if constexpr (N == 2) {
+                return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+            } else {
+                return _mm_load_ss(p);
+            }
+        }
+
+        // N interleaved channels to stereo, one frame per iteration: both rows are applied to the
+        // whole frame and the two dot products reduced together. covers 5.1/7.1 and AC-4 folds
+        template<size_t N>
+        SIMD_TARGET_SSE2 void sse2_mix_stereo(
+            const float *in, float *out, const float *matrix, size_t stride, size_t frames)
+        {
+            constexpr size_t VECTORS = (N + 3) / 4;
+            __m128 left[VECTORS], right[VECTORS];
+            for (size_t v = 0; v < VECTORS; v++) {
+                left[v] = _mm_loadu_ps(matrix + v * 4);
+                right[v] = _mm_loadu_ps(matrix + stride + v * 4);
+            }
+            const __m128 lo = _mm_set1_ps(-1.f);
+            const __m128 hi = _mm_set1_ps(1.f);
+
+            for (size_t f = 0; f < frames; f++) {
+                const float *s = in + f * N;
+                __m128 acc_l = _mm_setzero_ps();
+                __m128 acc_r = _mm_setzero_ps();
+                for (size_t v = 0; v < VECTORS; v++) {
+                    __m128 x;
+                    if (v + 1 < VECTORS) {
+                        x = _mm_loadu_ps(s + v * 4);
+                    } else {
+                        x = sse2_load_partial<N - (VECTORS - 1) * 4>(s + v * 4);
+                    }
+                    acc_l = _mm_add_ps(acc_l, _mm_mul_ps(x, left[v]));
+                    acc_r = _mm_add_ps(acc_r, _mm_mul_ps(x, right[v]));
+                }
+
+                // [l0+l2, r0+r2, l1+l3, r1+r3], then fold the upper half onto the lower
+                __m128 t = _mm_add_ps(_mm_unpacklo_ps(acc_l, acc_r), _mm_unpackhi_ps(acc_l, acc_r));
+                t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+                t = _mm_min_ps(_mm_max_ps(t, lo), hi);
+                _mm_storel_pi(reinterpret_cast<__m64 *>(out + f * 2), t);
+            }
+        }
+
+        typedef void (*stereo_kernel_t)(const float *, float *, const float *, size_t, size_t);
+
+        stereo_kernel_t get_stereo_kernel(size_t inputs) {
+            switch (inputs) {
+                case 1: return sse2_mix_stereo<1>;
+                case 2: return sse2_mix_stereo<2>;
+                case 3: return sse2_mix_stereo<3>;
+                case 4: return sse2_mix_stereo<4>;
+                case 5: return sse2_mix_stereo<5>;
+                case 6: return sse2_mix_stereo<6>;
+                case 7: return sse2_mix_stereo<7>;
+                case 8: return sse2_mix_stereo<8>;
+                default: return nullptr;
+            }
+        }
+
+        // sum of scaled planes, 4 frames per iteration
+        SIMD_TARGET_SSE2 void sse2_mix_planar(
+            const float *const *planes, const float *gains, size_t count, float *out, size_t frames)
+        {
+            const __m128 lo = _mm_set1_ps(-1.f);
+            const __m128 hi = _mm_set1_ps(1.f);
+            const size_t blocks = frames / 4;
+
+            for (size_t b = 0; b < blocks; b++) {
+                __m128 acc = _mm_setzero_ps();
+                for (size_t p = 0; p < count; p++) {
+                    acc = _mm_add_ps(acc, _mm_mul_ps(
+                            _mm_loadu_ps(planes[p] + b * 4), _mm_set1_ps(gains[p])));
+                }
+                _mm_storeu_ps(out + b * 4, _mm_min_ps(_mm_max_ps(acc, lo), hi));
+            }
+
+            // remaining frames
+            const size_t tail = blocks * 4;
+            const float *tail_planes[ChannelMatrix::MAX_CHANNELS];
+            for (size_t p = 0; p < count; p++) {
+                tail_planes[p] = planes[p] + tail;
+            }
+            mix_planar_scalar(tail_planes, gains, count, out + tail, frames - tail);
+        }
+
+#endif
+    }
+
+    void ChannelMatrix::resize(size_t inputs, size_t outputs) {
+        this->input_count = std::min(inputs, MAX_CHANNELS);
+        this->output_count = std::min(outputs, MAX_CHANNELS);
+        this->stride = (this->input_count + 3) & ~static_cast<size_t>(3);
+        this->matrix.assign(this->stride * this->output_count, 0.f);
+    }
+
+    void ChannelMatrix::set_gain(size_t output, size_t input, float gain) {
+        if (output < this->output_count && input < this->input_count) {
+            this->matrix[output * this->stride + input] = gain;
+        }
+    }
+
+    void ChannelMatrix::add_gain(size_t output, size_t input, float gain) {
+        if (output < this->output_count && input < this->input_count) {
+            this->matrix[output * this->stride + input] += gain;
+        }
+    }
+
+    void ChannelMatrix::scale_output(size_t output, float factor) {
+        if (output < this->output_count) {
+            for (size_t i = 0; i < this->input_count; i++) {
+                this->matrix[output * this->stride + i] *= factor;
+            }
+        }
+    }
+
+    float ChannelMatrix::gain(size_t output, size_t input) const {
+        if (output < this->output_count && input < this->input_count) {
+            return this->matrix[output * this->stride + input];
+        }
+        return 0.f;
+    }
+
+    size_t ChannelMatrix::taps(size_t output) const {
+        size_t count = 0;
+        for (size_t i = 0; i < this->input_count; i++) {
+            if (this->gain(output, i) != 0.f) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void ChannelMatrix::process_interleaved(
+        const void *src,
+        SampleType src_type,
+        void *dst,
+        SampleType dst_type,
+        size_t frames) const
+    {
+        const size_t inputs = this->input_count;
+        const size_t outputs = this->output_count;
+        const size_t src_frame = inputs * sample_type_size(src_type);
+        const size_t dst_frame = outputs * sample_type_size(dst_type);
+        if (src == nullptr || dst == nullptr || src_frame == 0 || dst_frame == 0) {
+            return;
+        }
+
+#if SIMD_X86
+        const auto stereo_kernel = (outputs == 2 && use_sse2()) ? get_stereo_kernel(inputs) : nullptr;
+#endif
+
+        // float buffers are mixed in place, everything else goes through the block scratch
+        float in_block[BLOCK_SAMPLES];
+        float out_block[BLOCK_SAMPLES];
+        const size_t block_frames = BLOCK_SAMPLES / std::max(inputs, outputs);
+
+        const auto in_bytes = reinterpret_cast<const uint8_t *>(src);
+        const auto out_bytes = reinterpret_cast<uint8_t *>(dst);
+        for (size_t done = 0; done < frames; done += block_frames) {
+            const size_t count = std::min(block_frames, frames - done);
+
+            const float *in;
+            if (src_type == SampleType::FLOAT_32) {
+                in = reinterpret_cast<const float *>(in_bytes + done * src_frame);
+            } else {
+                convert_samples(in_bytes + done * src_frame, src_type,
+                        in_block, SampleType::FLOAT_32, count * inputs);
+                in = in_block;
+            }
+
+            float *out = dst_type == SampleType::FLOAT_32
+                    ? reinterpret_cast<float *>(out_bytes + done * dst_frame)
+                    : out_block;
+
+#if SIMD_X86
+            if (stereo_kernel != nullptr) {
+                stereo_kernel(in, out, this->matrix.data(), this->stride, count);
+            } else
+#endif
+            {
+                mix_interleaved_scalar(in, inputs, out, outputs, this->matrix.data(), this->stride, count);
+            }
+
+            if (out == out_block) {
+                convert_samples(out_block, SampleType::FLOAT_32,
+                        out_bytes + done * dst_frame, dst_type, count * outputs);
+            }
+        }
+    }
+
+    void ChannelMatrix::process_planar(
+        const void *const *src,
+        SampleType src_type,
+        void *const *dst,
+        SampleType dst_type,
+        size_t frames) const
+    {
+        const size_t src_size = sample_type_size(src_type);
+        const size_t dst_size = sample_type_size(dst_type);
+        if (src == nullptr || dst == nullptr || src_size == 0 || dst_size == 0) {
+            return;
+        }
+
+        // only decode the inputs some output actually uses
+        size_t used[MAX_CHANNELS];
+        size_t used_count = 0;
+        for (size_t i = 0; i < this->input_count; i++) {
+            if (src[i] == nullptr) {
+                continue;
+            }
+            for (size_t o = 0; o < this->output_count; o++) {
+                if (this->gain(o, i) != 0.f) {
+                    used[used_count++] = i;
+                    break;
+                }
+            }
+        }
+
+        float in_block[BLOCK_SAMPLES];
+        float out_block[BLOCK_SAMPLES / 4];
+        const size_t block_frames = std::min(BLOCK_SAMPLES / std::max<size_t>(used_count, 1),
+                BLOCK_SAMPLES / 4);
+
+        for (size_t done = 0; done < frames; done += block_frames) {
+            const size_t count = std::min(block_frames, frames - done);
+
+            const float *planes[MAX_CHANNELS];
+            for (size_t p = 0; p < used_count; p++) {
+                const auto plane = reinterpret_cast<const uint8_t *>(src[used[p]]) + done * src_size;
+                if (src_type == SampleType::FLOAT_32) {
+                    planes[p] = reinterpret_cast<const float *>(plane);
+                } else {
+                    convert_samples(plane, src_type, in_block + p * block_frames,
+                            SampleType::FLOAT_32, count);
+                    planes[p] = in_block + p * block_frames;
+                }
+            }
+
+            // float sources are read straight from the caller's buffers, which may be written
+            // below when they alias a destination, so those are staged in the scratch as well
+            if (src_type == SampleType::FLOAT_32) {
+                for (size_t p = 0; p < used_count; p++) {
+                    for (size_t o = 0; o < this->output_count; o++) {
+                        if (dst[o] == src[used[p]]) {
+                            memcpy(in_block + p * block_frames, planes[p], count * sizeof(float));
+                            planes[p] = in_block + p * block_frames;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            for (size_t o = 0; o < this->output_count; o++) {
+                if (dst[o] == nullptr) {
+                    continue;
+                }
+
+                float gains[MAX_CHANNELS];
+                for (size_t p = 0; p < used_count; p++) {
+                    gains[p] = this->gain(o, used[p]);
+                }
+
+#if SIMD_X86
+                if (use_sse2()) {
+                    sse2_mix_planar(planes, gains, used_count, out_block, count);
+                } else
+#endif
+                {
+                    mix_planar_scalar(planes, gains, used_count, out_block, count);
+                }
+
+                convert_samples(out_block, SampleType::FLOAT_32,
+                        reinterpret_cast<uint8_t *>(dst[o]) + done * dst_size, dst_type, count);
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hooks/audio/buffer.h"
+
+namespace hooks::audio {
+
+    /*
+     * Channel mixing matrix shared by the WASAPI and ASIO downmix paths.
+     *
+     * Every output channel is a weighted sum of the input channels. Samples are decoded to float
+     * in fixed size blocks (see `convert_samples`), mixed, clamped to full scale and encoded back,
+     * so any supported SampleType can be used on either side. Stereo outputs fed from up to eight
+     * interleaved channels (5.1/7.1 folds, AC-4) and planar buffers use SSE2 kernels when the CPU
+     * has them. The process functions never allocate, so they are safe to call from realtime audio
+     * threads once the matrix is set up.
+     */
+    class ChannelMatrix {
+    public:
+
+        // channel count limit on either side, bounds the stack used for block scratch
+        static constexpr size_t MAX_CHANNELS = 32;
+
+        // reset to an all-zero matrix; counts above MAX_CHANNELS are clamped
+        void resize(size_t inputs, size_t outputs);
+
+        // set or accumulate the gain input `input` contributes to output `output`
+        void set_gain(size_t output, size_t input, float gain);
+        void add_gain(size_t output, size_t input, float gain);
+
+        // multiply every coefficient of one output
+        void scale_output(size_t output, float factor);
+
+        float gain(size_t output, size_t input) const;
+
+        // number of inputs contributing to `output` with a non-zero gain
+        size_t taps(size_t output) const;
+
+        size_t inputs() const { return this->input_count; }
+        size_t outputs() const { return this->output_count; }
+
+        /*
+         * mixes `frames` interleaved frames of `inputs()` channels into `outputs()` channels.
+         * `src` and `dst` must not overlap.
+         */
+        void process_interleaved(
+            const void *src,
+            SampleType src_type,
+            void *dst,
+            SampleType dst_type,
+            size_t frames) const;
+
+        /*
+         * mixes planar channel buffers, `src` holding `inputs()` and `dst` holding `outputs()`
+         * pointers. null sources are treated as silence and null destinations are skipped.
+         * destinations may alias sources: each block is fully read before it is written.
+         */
+        void process_planar(
+            const void *const *src,
+            SampleType src_type,
+            void *const *dst,
+            SampleType dst_type,
+            size_t frames) const;
+
+    private:
+
+        size_t input_count = 0;
+        size_t output_count = 0;
+
+        // row-major outputs x stride coefficients, rows zero padded to a multiple of 4
+        size_t stride = 0;
+        std::vector<float> matrix;
+    };
+}
@@ -0,0 +1,197 @@
+#include "telemetry.h"
+
+#include <algorithm>
+
+namespace hooks::audio::telemetry {
+
+    namespace {
+
+        template<typename T>
+        inline void bump(std::atomic<T> &counter, T amount = 1) {
+            counter.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        template<typename T>
+        inline void raise_max(std::atomic<T> &value, T candidate) {
+            T current = value.load(std::memory_order_relaxed);
+            while (candidate > current
+                    && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+            }
+        }
+
+        struct StreamState {
+            std::atomic<bool> active {false};
+            std::atomic<uint32_t> period_us {0};
+            std::atomic<uint32_t> capacity_frames {0};
+
+            std::atomic<uint64_t> callbacks {0};
+            std::atomic<uint64_t> missed_deadlines {0};
+            std::atomic<uint64_t> underruns {0};
+            std::atomic<uint32_t> period_max_us {0};
+            std::atomic<uint32_t> processing_max_us {0};
+
+            std::atomic<uint32_t> period[TIMING_BUCKETS] {};
+            std::atomic<uint32_t> processing[TIMING_BUCKETS] {};
+            std::atomic<uint64_t> fill[FILL_BUCKETS] {};
+        };
+
+        StreamState STREAMS[STREAM_COUNT];
+
+        inline StreamState &state(Stream stream) {
+            return STREAMS[static_cast<size_t>(stream)];
+        }
+
+        inline size_t timing_bucket(uint32_t us) {
+            if (us < 4) {
+                return us;
+            }
+
+            // index of the highest set bit, then the next two bits select the sub-bucket
+            uint32_t exponent = 2;
+            while (exponent < 31 && (us >> (exponent + 1)) != 0) {
+                exponent++;
+            }
+            const size_t sub = (us >> (exponent - 2)) & 3;
+            return std::min<size_t>((exponent - 1) * 4 + sub, TIMING_BUCKETS - 1);
+        }
+
+        inline uint32_t to_us(uint64_t ns) {
+            return static_cast<uint32_t>(std::min<uint64_t>(ns / 1000, UINT32_MAX));
+        }
+
+        // value below which `fraction` of the recorded samples fall
+        uint32_t percentile(const uint64_t *counts, uint64_t total, double fraction) {
+            if (total == 0) {
+                return 0;
+            }
+            const auto target = static_cast<uint64_t>(total * fraction);
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < TIMING_BUCKETS; bucket++) {
+                seen += counts[bucket];
+                if (seen > target) {
+                    return timing_bucket_limit(bucket);
+                }
+            }
+            return timing_bucket_limit(TIMING_BUCKETS - 1);
+        }
+    }
+
+    const char *stream_name(Stream stream) {
+        switch (stream) {
+            case Stream::Asio: return "asio";
+            case Stream::Wasapi: return "wasapi";
+            case Stream::WaveOut: return "waveout";
+            default: return "unknown";
+        }
+    }
+
+    uint32_t timing_bucket_limit(size_t bucket) {
+        if (bucket < 4) {
+            return static_cast<uint32_t>(bucket);
+        }
+        if (bucket >= TIMING_BUCKETS - 1) {
+            return UINT32_MAX;
+        }
+        const size_t exponent = bucket / 4 + 1;
+        const size_t sub = bucket % 4;
+        return static_cast<uint32_t>(((5 + sub) << (exponent - 2)) - 1);
+    }
+
+    void configure(Source &source, uint32_t period_us, uint32_t capacity_frames) {
+        source.period_us.store(period_us, std::memory_order_relaxed);
+        source.capacity_frames.store(capacity_frames, std::memory_order_relaxed);
+        source.last_callback.store(0, std::memory_order_relaxed);
+
+        auto &s = state(source.stream);
+        s.period_us.store(period_us, std::memory_order_relaxed);
+        s.capacity_frames.store(capacity_frames, std::memory_order_relaxed);
+        s.active.store(true, std::memory_order_release);
+    }
+
+    void record_callback(Source &source, uint64_t timestamp) {
+        auto &s = state(source.stream);
+        bump(s.callbacks);
+
+        // callbacks of one source come from its own audio thread
+        const uint64_t last = source.last_callback.load(std::memory_order_relaxed);
+        source.last_callback.store(timestamp, std::memory_order_relaxed);
+        if (last == 0 || timestamp < last) {
+            return;
+        }
+
+        const uint32_t period = to_us(timestamp - last);
+        bump(s.period[timing_bucket(period)]);
+        raise_max(s.period_max_us, period);
+
+        const uint32_t expected = source.period_us.load(std::memory_order_relaxed);
+        if (expected > 0 && period > expected * LATE_CALLBACK_FACTOR) {
+            bump(s.missed_deadlines);
+        }
+    }
+
+    void record_processing(Source &source, uint64_t start, uint64_t end) {
+        auto &s = state(source.stream);
+        const uint32_t elapsed = to_us(end > start ? end - start : 0);
+        bump(s.processing[timing_bucket(elapsed)]);
+        raise_max(s.processing_max_us, elapsed);
+
+        const uint32_t expected = source.period_us.load(std::memory_order_relaxed);
+        if (expected > 0 && elapsed > expected) {
+            bump(s.missed_deadlines);
+        }
+    }
+
+    void record_fill(Source &source, uint32_t filled_frames) {
+        auto &s = state(source.stream);
+        const uint32_t capacity = source.capacity_frames.load(std::memory_order_relaxed);
+        if (capacity > 0) {
+            const size_t bucket = std::min<size_t>(
+                    static_cast<uint64_t>(filled_frames) * FILL_BUCKETS / capacity, FILL_BUCKETS - 1);
+            bump(s.fill[bucket]);
+        }
+
+        // an empty device buffer once the source is running means the device ran dry
+        if (filled_frames == 0 && source.last_callback.load(std::memory_order_relaxed) != 0) {
+            bump(s.underruns);
+        }
+    }
+
+    Snapshot snapshot(Stream stream) {
+        const auto &s = state(stream);
+
+        Snapshot snap;
+        snap.active = s.active.load(std::memory_order_acquire);
+        snap.period_us = s.period_us.load(std::memory_order_relaxed);
+        snap.capacity_frames = s.capacity_frames.load(std::memory_order_relaxed);
+        snap.callbacks = s.callbacks.load(std::memory_order_relaxed);
+        snap.missed_deadlines = s.missed_deadlines.load(std::memory_order_relaxed);
+        snap.underruns = s.underruns.load(std::memory_order_relaxed);
+        snap.period_max_us = s.period_max_us.load(std::memory_order_relaxed);
+        snap.processing_max_us = s.processing_max_us.load(std::memory_order_relaxed);
+
+        uint64_t period[TIMING_BUCKETS];
+        uint64_t processing[TIMING_BUCKETS];
+        uint64_t period_total = 0;
+        uint64_t processing_total = 0;
+        for (size_t bucket = 0; bucket < TIMING_BUCKETS; bucket++) {
+            period[bucket] = s.period[bucket].load(std::memory_order_relaxed);
+            processing[bucket] = s.processing[bucket].load(std::memory_order_relaxed);
+            period_total += period[bucket];
+            processing_total += processing[bucket];
+        }
+        for (size_t bucket = 0; bucket < FILL_BUCKETS; bucket++) {
+            snap.fill[bucket] = s.fill[bucket].load(std::memory_order_relaxed);
+            snap.fill_samples += snap.fill[bucket];
+        }
+
+        // bucket bounds can exceed the true maximum, which is tracked exactly
+        snap.period_p50_us = std::min(percentile(period, period_total, 0.50), snap.period_max_us);
+        snap.period_p99_us = std::min(percentile(period, period_total, 0.99), snap.period_max_us);
+        snap.processing_p50_us = std::min(
+                percentile(processing, processing_total, 0.50), snap.processing_max_us);
+        snap.processing_p99_us = std::min(
+                percentile(processing, processing_total, 0.99), snap.processing_max_us);
+
+        return snap;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace hooks::audio::telemetry {
+
+    /*
+     * Lock-free per-stream audio telemetry.
+     *
+     * Realtime threads record callback periods, the time spent in our own processing and the
+     * device buffer fill level into fixed histograms made of relaxed atomics, with no locks and
+     * no allocation. A stream type can have several writers at once (every WASAPI client of the
+     * game, and padding queries from game threads next to the release thread), so counters are
+     * bumped with relaxed fetch_add. Periods are measured per Source, one per client instance,
+     * so clients with different periods do not cut into each other's intervals.
+     * Readers (overlay, API) take approximate snapshots at any time.
+     */
+
+    enum class Stream {
+        Asio,
+        Wasapi,
+        WaveOut,
+        Count,
+    };
+
+    constexpr size_t STREAM_COUNT = static_cast<size_t>(Stream::Count);
+
+    // timing histogram: four linear sub-buckets per power of two microseconds, the last bucket
+    // collects everything from ~65 ms up. percentiles are reported as bucket upper bounds, so
+    // they are accurate to within 25%
+    constexpr size_t TIMING_BUCKETS = 64;
+
+    // fill histogram: device buffer fill level in 10% steps
+    constexpr size_t FILL_BUCKETS = 10;
+
+    // a callback counts as a missed deadline when it arrives this much later than the expected
+    // period, or when our processing alone takes longer than a period
+    constexpr double LATE_CALLBACK_FACTOR = 1.5;
+
+    // monotonic timestamp in nanoseconds, the unit all recording functions take
+    inline uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // human readable stream name
+    const char *stream_name(Stream stream);
+
+    // one writer of a stream, e.g. an audio client instance. owns the state periods and fill
+    // levels are measured against
+    struct Source {
+        explicit Source(Stream stream) : stream(stream) {
+        }
+
+        Source(const Source &) = delete;
+        Source &operator=(const Source &) = delete;
+
+        const Stream stream;
+        std::atomic<uint32_t> period_us {0};
+        std::atomic<uint32_t> capacity_frames {0};
+        std::atomic<uint64_t> last_callback {0};
+    };
+
+    // (re)arm a source when its stream is opened: sets the expected callback period and the
+    // device buffer size used for fill levels (0 when unknown), and marks the stream active.
+    // counters of the stream keep accumulating across all its sources
+    void configure(Source &source, uint32_t period_us, uint32_t capacity_frames);
+
+    // records a callback arriving at `timestamp`, measuring the period since the previous one
+    // of the same source
+    void record_callback(Source &source, uint64_t timestamp);
+
+    // records our processing having run from `start` to `end`
+    void record_processing(Source &source, uint64_t start, uint64_t end);
+
+    // records the device buffer fill level; an empty buffer while running counts as an underrun
+    void record_fill(Source &source, uint32_t filled_frames);
+
+    // measures our processing for the lifetime of the scope
+    class ProcessingScope {
+    public:
+        explicit ProcessingScope(Source &source) : source(source), start(now()) {
+        }
+        ~ProcessingScope() {
+            record_processing(this->source, this->start, now());
+        }
+
+        ProcessingScope(const ProcessingScope &) = delete;
+        ProcessingScope &operator=(const ProcessingScope &) = delete;
+
+    private:
+        Source &source;
+        uint64_t start;
+    };
+
+    // point-in-time copy of a stream's counters, with derived percentiles
+    struct Snapshot {
+        bool active = false;
+
+        // of the most recently configured source
+        uint32_t period_us = 0;
+        uint32_t capacity_frames = 0;
+        uint64_t callbacks = 0;
+        uint64_t missed_deadlines = 0;
+        uint64_t underruns = 0;
+        uint64_t fill_samples = 0;
+
+        // callback period and processing time percentiles, in microseconds
+        uint32_t period_p50_us = 0;
+        uint32_t period_p99_us = 0;
+        uint32_t period_max_us = 0;
+        uint32_t processing_p50_us = 0;
+        uint32_t processing_p99_us = 0;
+        uint32_t processing_max_us = 0;
+
+        uint64_t fill[FILL_BUCKETS] {};
+    };
+
+    Snapshot snapshot(Stream stream);
+
+    // upper bound in microseconds of a timing histogram bucket
+    uint32_t timing_bucket_limit(size_t bucket);
+}
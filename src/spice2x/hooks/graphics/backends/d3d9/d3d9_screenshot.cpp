@@ -1,9 +1,10 @@
 #include "d3d9_screenshot.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
-#include <future>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -22,6 +23,7 @@
 #include "overlay/notifications.h"
 #include "util/fileutils.h"
 #include "util/logging.h"
+#include "util/pixelconv.h"
 #include "util/threadpool.h"
 
 #include "d3d9_device.h"
@@ -68,7 +70,7 @@ struct PendingCapture {
 // packed 24bpp RGB, what both the png encoder and the api capture consume
 constexpr size_t RGB_PIXEL_SIZE = 3;
 
-// the formats surface_to_rgb knows how to convert; the two must stay in sync
+// the formats surface_source_format knows how to convert; the two must stay in sync
 static std::optional<size_t> surface_pixel_size(D3DFORMAT format) {
     switch (format) {
         // what back buffers are actually created as in practice
@@ -162,23 +164,55 @@ CaptureBuffers &capture_buffers() {
     return *instance;
 }
 
-// encodes get their own pool: the dispatch below already occupies a worker on its
-// pool, so queueing onto that one and waiting could starve itself. never destroyed
-// for the same reason as the buffers above
-ThreadPool &encode_pool() {
-    static auto *instance = new ThreadPool(2);
-    return *instance;
+// screenshot encodes and capture conversions run on the shared pool, captures at high
+// priority since a client is waiting on every frame. it is never destroyed either, so the
+// read pool below can still queue onto it at process exit
+
+// screenshots waiting for their encode hold a raw copy of every screen, several megabytes
+// each at 4K, so a held screenshot key must not be able to queue them without bound. a request
+// beyond this waits briefly for a save to finish, and stays pending for a later frame if none
+// does, rather than holding up the game for a whole encode
+constexpr size_t MAX_SCREENSHOTS_IN_FLIGHT = 2;
+constexpr auto SCREENSHOT_SLOT_WAIT = std::chrono::milliseconds(20);
+std::mutex SCREENSHOTS_IN_FLIGHT_M;
+std::condition_variable SCREENSHOTS_IN_FLIGHT_CV;
+size_t SCREENSHOTS_IN_FLIGHT = 0;
+
+void screenshot_save_done() {
+    {
+        std::lock_guard<std::mutex> lock(SCREENSHOTS_IN_FLIGHT_M);
+        SCREENSHOTS_IN_FLIGHT--;
+    }
+    SCREENSHOTS_IN_FLIGHT_CV.notify_one();
 }
 
-// where a capture's pixels are converted and handed to the api. never destroyed: the read
-// pool below can still be working at process exit, and it queues onto this one
-ThreadPool &capture_save_pool() {
-    static auto *instance = new ThreadPool(2);
+// saves run one at a time anyway, under SCREENSHOT_SAVE_M. never destroyed for the same
+// reason as the buffers above
+ThreadPool &screenshot_save_pool() {
+    static auto *instance = new ThreadPool(1);
     return *instance;
 }
 
+// the pixelconv layout of each format surface_pixel_size accepts
+std::optional<pixelconv::SourceFormat> surface_source_format(D3DFORMAT format) {
+    switch (format) {
+        case D3DFMT_X8R8G8B8:
+        case D3DFMT_A8R8G8B8:
+            return pixelconv::SourceFormat::XRGB8888;
+        case D3DFMT_A2R10G10B10:
+            return pixelconv::SourceFormat::ARGB2101010;
+        case D3DFMT_R5G6B5:
+            return pixelconv::SourceFormat::RGB565;
+        case D3DFMT_X1R5G5B5:
+        case D3DFMT_A1R5G5B5:
+            return pixelconv::SourceFormat::XRGB1555;
+        default:
+            return std::nullopt;
+    }
+}
+
 // normalize the supported D3D formats to packed 24bpp RGB. callers screen the
-// format through surface_pixel_size first, so the black fill below is a fallback
+// format through surface_pixel_size first, so the black fill is a fallback
 void surface_to_rgb(
         D3DFORMAT format,
         UINT width,
@@ -187,72 +221,13 @@ void surface_to_rgb(
         size_t pitch,
         uint8_t *pixels) {
 
-    for (size_t row = 0; row < height; row++) {
-        size_t offset_row = row * width * 3;
-        switch (format) {
-            case D3DFMT_X8R8G8B8:
-            case D3DFMT_A8R8G8B8: {
-                for (size_t column = 0; column < width; column++) {
-                    auto cell = data + row * pitch + column * 4;
-                    auto pixel = &pixels[offset_row + column * 3];
-                    pixel[0] = cell[2];
-                    pixel[1] = cell[1];
-                    pixel[2] = cell[0];
-                }
-                break;
-            }
-            // the 5 and 6 bit channels are widened by bit replication so that
-            // full scale stays full scale
-            case D3DFMT_R5G6B5: {
-                auto cells = reinterpret_cast<const uint16_t *>(data + row * pitch);
-                for (size_t column = 0; column < width; column++) {
-                    const uint16_t cell = cells[column];
-                    const uint8_t red = (cell >> 11) & 0x1F;
-                    const uint8_t green = (cell >> 5) & 0x3F;
-                    const uint8_t blue = cell & 0x1F;
-                    auto pixel = &pixels[offset_row + column * 3];
-                    pixel[0] = (red << 3) | (red >> 2);
-                    pixel[1] = (green << 2) | (green >> 4);
-                    pixel[2] = (blue << 3) | (blue >> 2);
-                }
-                break;
-            }
-            case D3DFMT_X1R5G5B5:
-            case D3DFMT_A1R5G5B5: {
-                auto cells = reinterpret_cast<const uint16_t *>(data + row * pitch);
-                for (size_t column = 0; column < width; column++) {
-                    const uint16_t cell = cells[column];
-                    const uint8_t red = (cell >> 10) & 0x1F;
-                    const uint8_t green = (cell >> 5) & 0x1F;
-                    const uint8_t blue = cell & 0x1F;
-                    auto pixel = &pixels[offset_row + column * 3];
-                    pixel[0] = (red << 3) | (red >> 2);
-                    pixel[1] = (green << 3) | (green >> 2);
-                    pixel[2] = (blue << 3) | (blue >> 2);
-                }
-                break;
-            }
-            case D3DFMT_A2R10G10B10: {
-                auto cells = reinterpret_cast<const uint32_t *>(data + row * pitch);
-                for (size_t column = 0; column < width; column++) {
-                    const uint32_t cell = cells[column];
-                    auto pixel = &pixels[offset_row + column * 3];
-                    pixel[0] = static_cast<uint8_t>((cell >> 22) & 0xFF);
-                    pixel[1] = static_cast<uint8_t>((cell >> 12) & 0xFF);
-                    pixel[2] = static_cast<uint8_t>((cell >> 2) & 0xFF);
-                }
-                break;
-            }
-            default: {
-                for (size_t column = 0; column < width; column++) {
-                    auto pixel = &pixels[offset_row + column * 3];
-                    pixel[0] = 0;
-                    pixel[1] = 0;
-                    pixel[2] = 0;
-                }
-            }
-        }
+    const auto source = surface_source_format(format);
+    if (!source.has_value()) {
+        std::memset(pixels, 0, static_cast<size_t>(width) * height * RGB_PIXEL_SIZE);
+        return;
     }
+
+    pixelconv::image_to_rgb(*source, width, height, data, pitch, pixels);
 }
 
 } // namespace
@@ -382,7 +357,7 @@ static bool write_screenshot_png(
         UINT height,
         const std::vector<uint8_t> &pixels) {
 
-    // a no-op while FPNG_NO_SSE is set, but fpng requires it before any encode
+    // detects SSE4.1/pclmul for the filter, adler and crc paths; required before any encode
     static std::once_flag fpng_ready;
     std::call_once(fpng_ready, [] { fpng::fpng_init(); });
 
@@ -445,7 +420,7 @@ static void dispatch_capture_save(PendingCapture capture) {
     if (image_processing_must_be_inline()) {
         capture_process();
     } else {
-        capture_save_pool().add(std::move(capture_process));
+        ThreadPool::shared().post(std::move(capture_process), TaskPriority::High);
     }
 }
 
@@ -546,31 +521,13 @@ static void dispatch_screenshot_save(std::vector<PendingWrite> writes, size_t sc
             }
         };
 
-        {
-            // sized up front and assigned by index: storing a future must not be able
-            // to throw once its task is queued, or the screen would encode twice
-            std::vector<std::future<void>> pending(writes.empty() ? 0 : writes.size() - 1);
-            for (size_t i = 1; i < writes.size(); i++) {
-                try {
-                    pending[i - 1] = encode_pool().add([&writes, &encode_one, i] {
-                        encode_one(writes[i]);
-                    });
-                } catch (const std::exception &) {
-                    // nothing to queue onto; encoding it here still makes progress
-                    encode_one(writes[i]);
-                }
+        // one screen per chunk; this thread encodes alongside the pool, so a busy pool
+        // only makes it slower
+        ThreadPool::shared().parallel_for(0, writes.size(), 1, [&writes, &encode_one](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                encode_one(writes[i]);
             }
-
-            if (!writes.empty()) {
-                encode_one(writes.front());
-            }
-
-            for (auto &task : pending) {
-                if (task.valid()) {
-                    task.wait();
-                }
-            }
-        }
+        });
 
         std::string primary_path;
         std::string notify_path;
@@ -620,12 +577,37 @@ static void dispatch_screenshot_save(std::vector<PendingWrite> writes, size_t sc
 
     if (image_processing_must_be_inline()) {
         guarded();
-    } else {
-        static auto pool = ThreadPool(2);
-        pool.add(std::move(guarded));
+        return;
+    }
+
+    // the slot was taken by wait_for_screenshot_slot before the readback
+    auto counted = [process = std::move(guarded)]() mutable {
+        process();
+        screenshot_save_done();
+    };
+    try {
+        screenshot_save_pool().post(std::move(counted));
+    } catch (const std::exception &error) {
+        screenshot_save_done();
+        log_warning("graphics::d3d9", "failed to queue screenshot save: {}", error.what());
     }
 }
 
+// takes a save slot for the next screenshot, waiting up to `wait` for one
+static bool wait_for_screenshot_slot(std::chrono::milliseconds wait) {
+    if (image_processing_must_be_inline()) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(SCREENSHOTS_IN_FLIGHT_M);
+    if (!SCREENSHOTS_IN_FLIGHT_CV.wait_for(lock, wait, [] {
+        return SCREENSHOTS_IN_FLIGHT < MAX_SCREENSHOTS_IN_FLIGHT;
+    })) {
+        return false;
+    }
+    SCREENSHOTS_IN_FLIGHT++;
+    return true;
+}
+
 static void process_image_request(
         IDirect3DDevice9 *device,
         WrappedIDirect3DDevice9 *wrapped_device,
@@ -665,6 +647,9 @@ static void process_image_request(
     }
 
     if (copies.empty()) {
+        if (screenshot && !image_processing_must_be_inline()) {
+            screenshot_save_done();
+        }
         return;
     }
 
@@ -674,7 +659,7 @@ static void process_image_request(
 
         if (capture_read_off_thread(request.screen)) {
             try {
-                capture_read_pool().add(
+                capture_read_pool().post(
                         [screen = request.screen, copy = std::move(copy)]() mutable {
                     // an escape from here would cross a thread boundary and terminate
                     try {
@@ -726,12 +711,27 @@ static void process_image_request(
 void graphics_d3d9_process_screenshot(
         IDirect3DDevice9 *device,
         WrappedIDirect3DDevice9 *wrapped_device) {
-    if (graphics_screenshot_consume()) {
-        process_image_request(device, wrapped_device, ImageRequest {
-            .kind = ImageRequestKind::Screenshot,
-            .screen = 0,
-        });
+    if (!graphics_screenshot_consume()) {
+        return;
+    }
+
+    // checked before the readback, which is the part that costs the game a frame. a request
+    // that finds the saves still busy is kept for a later frame instead of dropped; only the
+    // first frame waits, the following ones just look for a free slot
+    static bool deferred = false;
+    if (!wait_for_screenshot_slot(deferred ? std::chrono::milliseconds(0) : SCREENSHOT_SLOT_WAIT)) {
+        if (!deferred) {
+            log_info("graphics::d3d9", "screenshot deferred, {} still saving", MAX_SCREENSHOTS_IN_FLIGHT);
+            deferred = true;
+        }
+        graphics_screenshot_trigger();
+        return;
     }
+    deferred = false;
+    process_image_request(device, wrapped_device, ImageRequest {
+        .kind = ImageRequestKind::Screenshot,
+        .screen = 0,
+    });
 }
 
 void graphics_d3d9_process_capture(
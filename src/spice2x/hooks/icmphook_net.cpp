@@ -1,4 +1,5 @@
 #include "icmphook_net.h"
+#include "icmphook_sockets.h"
 
 #include "util/detour.h"
 #include "util/logging.h"
@@ -10,8 +11,6 @@
 #include <chrono>
 #include <cstring>
 #include <atomic>
-#include <condition_variable>
-#include <unordered_map>
 
 void icmphook_iphlpapi_install();
 
@@ -187,19 +186,19 @@ uint32_t local_ipv4_for_peer(
 
 struct EmuSock {
     std::deque<std::vector<uint8_t>> queue;
-    std::condition_variable_any cv;
     DWORD rx_timeout_ms = INFINITE;
     bool nonblocking = false;
     bool has_bind = false;
     uint32_t bind_ip_host = 0;
 };
 
-std::recursive_mutex g_mu;
-std::unordered_map<SOCKET, std::unique_ptr<EmuSock>> g_socks;
-std::atomic<uint32_t> g_seq{1};
+// Calls on real sockets are told apart by their handle value and never
+// touch this; emulated sockets only ever lock their own slot.
+using EmuSockets = EmuSocketTable<EmuSock>;
+EmuSockets g_socks;
 
 // Fast-path flag so the bind() hook in networkhook.cpp can short-circuit
-// without taking g_mu when the ICMP feature was never enabled.
+// when the ICMP feature was never enabled.
 std::atomic<bool> g_installed{false};
 
 decltype(socket) *socket_orig = nullptr;
@@ -214,37 +213,18 @@ decltype(WSARecvFrom) *WSARecvFrom_orig = nullptr;
 decltype(ioctlsocket) *ioctlsocket_orig = nullptr;
 decltype(setsockopt) *setsockopt_orig = nullptr;
 
-EmuSock *lookup(SOCKET s) {
-    std::lock_guard<std::recursive_mutex> lock(g_mu);
-    auto it = g_socks.find(s);
-    if (it == g_socks.end()) {
-        return nullptr;
-    }
-    return it->second.get();
+bool is_emulated(SOCKET s) {
+    return g_socks.contains(static_cast<uint64_t>(s));
 }
 
 SOCKET alloc_icmp_socket() {
-    std::lock_guard<std::recursive_mutex> lock(g_mu);
-    for (;;) {
-        uint32_t x = g_seq.fetch_add(1, std::memory_order_relaxed);
-        SOCKET s = (SOCKET)(socket_uint)(0xE0000000u | (x & 0x0FFFFFFFu));
-        if (s == INVALID_SOCKET) {
-            continue;
-        }
-        if (g_socks.find(s) == g_socks.end()) {
-            g_socks[s] = std::make_unique<EmuSock>();
-            return s;
-        }
-    }
-}
-
-void release_icmp_socket(SOCKET s) {
-    std::lock_guard<std::recursive_mutex> lock(g_mu);
-    auto it = g_socks.find(s);
-    if (it != g_socks.end()) {
-        it->second->cv.notify_all();
-        g_socks.erase(it);
+    const uint32_t handle = g_socks.alloc();
+    if (handle == 0) {
+        log_warning("network", "ICMP emulation: all {} raw socket slots in use", k_emu_slot_count);
+        WSASetLastError(WSAEMFILE);
+        return INVALID_SOCKET;
     }
+    return (SOCKET)(socket_uint) handle;
 }
 
 bool process_icmp_send(SOCKET s, const uint8_t *buf, int len, const sockaddr *to, int tolen) {
@@ -281,19 +261,18 @@ bool process_icmp_send(SOCKET s, const uint8_t *buf, int len, const sockaddr *to
 
     std::vector<uint8_t> packet;
     {
-        std::lock_guard<std::recursive_mutex> lock(g_mu);
-        auto it = g_socks.find(s);
-        if (it == g_socks.end()) {
+        auto slot = g_socks.acquire(static_cast<uint64_t>(s));
+        if (!slot) {
             return true;
         }
-        EmuSock *es = it->second.get();
+        EmuSock *es = &slot->state;
         uint32_t local_host = local_ipv4_for_peer(peer_host, es->bind_ip_host, es->has_bind);
         if (!ipv4_encode_datagram(
                 packet, peer_host, local_host, icmp_reply.data(), icmp_reply.size())) {
             return true;
         }
         es->queue.push_back(std::move(packet));
-        es->cv.notify_all();
+        slot->cv.notify_all();
     }
     return true;
 }
@@ -301,7 +280,9 @@ bool process_icmp_send(SOCKET s, const uint8_t *buf, int len, const sockaddr *to
 SOCKET WINAPI socket_hook(int af, int type, int protocol) {
     if (af == AF_INET && type == SOCK_RAW && protocol == IPPROTO_ICMP) {
         SOCKET s = alloc_icmp_socket();
-        log_info("network", "ICMP emulation: allocated raw socket {}", (socket_uint) s);
+        if (s != INVALID_SOCKET) {
+            log_info("network", "ICMP emulation: allocated raw socket {}", (socket_uint) s);
+        }
         return s;
     }
     return socket_orig(af, type, protocol);
@@ -318,7 +299,9 @@ SOCKET WINAPI WSASocketW_hook(
             af == AF_INET && type == SOCK_RAW && protocol == IPPROTO_ICMP;
     if (lpProtocolInfo == nullptr && is_raw_icmp) {
         SOCKET s = alloc_icmp_socket();
-        log_info("network", "ICMP emulation: allocated raw WSASocketW {}", (socket_uint) s);
+        if (s != INVALID_SOCKET) {
+            log_info("network", "ICMP emulation: allocated raw WSASocketW {}", (socket_uint) s);
+        }
         return s;
     }
     return WSASocketW_orig(af, type, protocol, lpProtocolInfo, g, dwFlags);
@@ -335,33 +318,46 @@ SOCKET WINAPI WSASocketA_hook(
             af == AF_INET && type == SOCK_RAW && protocol == IPPROTO_ICMP;
     if (lpProtocolInfo == nullptr && is_raw_icmp) {
         SOCKET s = alloc_icmp_socket();
-        log_info("network", "ICMP emulation: allocated raw WSASocketA {}", (socket_uint) s);
+        if (s != INVALID_SOCKET) {
+            log_info("network", "ICMP emulation: allocated raw WSASocketA {}", (socket_uint) s);
+        }
         return s;
     }
     return WSASocketA_orig(af, type, protocol, lpProtocolInfo, g, dwFlags);
 }
 
 int WINAPI closesocket_hook(SOCKET s) {
-    if (lookup(s)) {
-        release_icmp_socket(s);
+    if (g_socks.release(static_cast<uint64_t>(s))) {
         return 0;
     }
     return closesocket_orig(s);
 }
 
+// Bind on a locked emulated socket: records the interface address instead
+// of binding in the kernel. Returns false when the address is left to the
+// real bind().
+bool emu_bind(EmuSock &es, const sockaddr *name, int namelen, int *out_result) {
+    if (!name || namelen < (int) sizeof(sockaddr_in)) {
+        return false;
+    }
+    auto *in = reinterpret_cast<const sockaddr_in *>(name);
+    if (in->sin_family != AF_INET) {
+        WSASetLastError(WSAEAFNOSUPPORT);
+        *out_result = SOCKET_ERROR;
+        return true;
+    }
+    es.has_bind = true;
+    es.bind_ip_host = ntohl(in->sin_addr.s_addr);
+    *out_result = 0;
+    return true;
+}
+
 int WINAPI bind_hook_ws2(SOCKET s, const sockaddr *name, int namelen) {
-    {
-        std::lock_guard<std::recursive_mutex> lock(g_mu);
-        auto it = g_socks.find(s);
-        if (it != g_socks.end() && name && namelen >= (int) sizeof(sockaddr_in)) {
-            auto *in = reinterpret_cast<const sockaddr_in *>(name);
-            if (in->sin_family != AF_INET) {
-                WSASetLastError(WSAEAFNOSUPPORT);
-                return SOCKET_ERROR;
-            }
-            it->second->has_bind = true;
-            it->second->bind_ip_host = ntohl(in->sin_addr.s_addr);
-            return 0;
+    if (emu_handle_tagged(s)) {
+        auto slot = g_socks.acquire(static_cast<uint64_t>(s));
+        int result;
+        if (slot && emu_bind(slot->state, name, namelen, &result)) {
+            return result;
         }
     }
     return bind_trampoline_orig(s, name, namelen);
@@ -369,8 +365,7 @@ int WINAPI bind_hook_ws2(SOCKET s, const sockaddr *name, int namelen) {
 
 int WINAPI sendto_hook(
         SOCKET s, const char *buf, int len, int flags, const sockaddr *to, int tolen) {
-    EmuSock *es = lookup(s);
-    if (!es) {
+    if (!is_emulated(s)) {
         return sendto_orig(s, buf, len, flags, to, tolen);
     }
     if (!buf || !to) {
@@ -391,8 +386,7 @@ int WINAPI WSASendTo_hook(
         int iTolen,
         LPWSAOVERLAPPED lpOverlapped,
         LPWSAOVERLAPPED_COMPLETION_ROUTINE lpCompletionRoutine) {
-    EmuSock *es = lookup(s);
-    if (!es) {
+    if (!is_emulated(s)) {
         return WSASendTo_orig(
                 s,
                 lpBuffers,
@@ -436,40 +430,38 @@ int emu_recv_dequeue(
 
     std::vector<uint8_t> pkt;
     {
-        std::unique_lock<std::recursive_mutex> lock(g_mu);
-        auto it = g_socks.find(s);
-        if (it == g_socks.end()) {
+        const auto handle = static_cast<uint64_t>(s);
+        auto slot = g_socks.acquire(handle);
+        if (!slot) {
             WSASetLastError(WSAENOTSOCK);
             return SOCKET_ERROR;
         }
 
+        // closing the socket wakes this up too, and the slot may be reused by then
         auto wait_pred = [&] {
-            auto j = g_socks.find(s);
-            return j == g_socks.end() || !j->second->queue.empty();
+            return !EmuSockets::open(*slot.slot, handle) || !slot->state.queue.empty();
         };
 
-        EmuSock *es = it->second.get();
+        EmuSock *es = &slot->state;
         if (es->nonblocking) {
             if (es->queue.empty()) {
                 WSASetLastError(WSAEWOULDBLOCK);
                 return SOCKET_ERROR;
             }
         } else if (es->rx_timeout_ms == INFINITE || es->rx_timeout_ms == 0) {
-            it->second->cv.wait(lock, wait_pred);
+            slot->cv.wait(slot.lock, wait_pred);
         } else {
             const auto timeout = std::chrono::milliseconds(es->rx_timeout_ms);
-            if (!it->second->cv.wait_for(lock, timeout, wait_pred)) {
+            if (!slot->cv.wait_for(slot.lock, timeout, wait_pred)) {
                 WSASetLastError(WSAETIMEDOUT);
                 return SOCKET_ERROR;
             }
         }
 
-        it = g_socks.find(s);
-        if (it == g_socks.end()) {
+        if (!EmuSockets::open(*slot.slot, handle)) {
             WSASetLastError(WSAENOTSOCK);
             return SOCKET_ERROR;
         }
-        es = it->second.get();
         if (es->queue.empty()) {
             WSASetLastError(WSAENOTSOCK);
             return SOCKET_ERROR;
@@ -500,7 +492,7 @@ int emu_recv_dequeue(
 
 int WINAPI recvfrom_hook(
         SOCKET s, char *buf, int len, int flags, sockaddr *from, int *fromlen) {
-    if (!lookup(s)) {
+    if (!is_emulated(s)) {
         return recvfrom_orig(s, buf, len, flags, from, fromlen);
     }
     return emu_recv_dequeue(s, buf, len, from, fromlen, nullptr);
@@ -516,7 +508,7 @@ int WINAPI WSARecvFrom_hook(
         LPINT lpFromlen,
         LPWSAOVERLAPPED lpOverlapped,
         LPWSAOVERLAPPED_COMPLETION_ROUTINE lpCompletionRoutine) {
-    if (!lookup(s)) {
+    if (!is_emulated(s)) {
         return WSARecvFrom_orig(
                 s,
                 lpBuffers,
@@ -565,11 +557,10 @@ int WINAPI WSARecvFrom_hook(
 }
 
 int WINAPI ioctlsocket_hook(SOCKET s, long cmd, u_long *argp) {
-    {
-        std::lock_guard<std::recursive_mutex> lock(g_mu);
-        auto it = g_socks.find(s);
-        if (it != g_socks.end()) {
-            EmuSock *es = it->second.get();
+    if (emu_handle_tagged(s)) {
+        auto slot = g_socks.acquire(static_cast<uint64_t>(s));
+        if (slot) {
+            EmuSock *es = &slot->state;
             if (argp && static_cast<u_long>(cmd) == FIONBIO) {
                 es->nonblocking = (*argp != 0);
                 return 0;
@@ -583,13 +574,12 @@ int WINAPI ioctlsocket_hook(SOCKET s, long cmd, u_long *argp) {
 
 int WINAPI setsockopt_hook(
         SOCKET s, int level, int optname, const char *optval, int optlen) {
-    {
-        std::lock_guard<std::recursive_mutex> lock(g_mu);
-        auto it = g_socks.find(s);
-        if (it != g_socks.end()) {
+    if (emu_handle_tagged(s)) {
+        auto slot = g_socks.acquire(static_cast<uint64_t>(s));
+        if (slot) {
             const bool deref_optval = level == SOL_SOCKET && optlen >= (int) sizeof(DWORD);
             if (deref_optval && optval) {
-                EmuSock *es = it->second.get();
+                EmuSock *es = &slot->state;
                 auto v = reinterpret_cast<const DWORD *>(optval);
                 if (optname == SO_RCVTIMEO) {
                     DWORD ms = *v;
@@ -670,19 +660,21 @@ bool icmphook_is_emulated_socket(SOCKET s) {
     if (!icmphook_internal::g_installed.load(std::memory_order_acquire)) {
         return false;
     }
-    std::lock_guard<std::recursive_mutex> lock(icmphook_internal::g_mu);
-    return icmphook_internal::g_socks.find(s) != icmphook_internal::g_socks.end();
+    return icmphook_internal::is_emulated(s);
 }
 
 bool icmphook_try_bind(SOCKET s, const struct sockaddr *name, int namelen, int *out_result) {
-    if (!icmphook_internal::g_installed.load(std::memory_order_acquire)) {
+    if (!icmphook_internal::g_installed.load(std::memory_order_acquire) ||
+            !icmphook_internal::emu_handle_tagged(s)) {
         return false;
     }
-    std::lock_guard<std::recursive_mutex> lock(icmphook_internal::g_mu);
-    if (icmphook_internal::g_socks.find(s) == icmphook_internal::g_socks.end()) {
+    auto slot = icmphook_internal::g_socks.acquire(static_cast<uint64_t>(s));
+    if (!slot) {
         return false;
     }
-    *out_result = icmphook_internal::bind_hook_ws2(s, name, namelen);
+    if (!icmphook_internal::emu_bind(slot->state, name, namelen, out_result)) {
+        *out_result = icmphook_internal::bind_trampoline_orig(s, name, namelen);
+    }
     return true;
 }
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+/*
+ * Handles and storage of emulated ICMP sockets.
+ *
+ * Emulated handles are tagged with 0xE in their top nibble, a range kernel socket handles never
+ * reach, so the hooks can tell real sockets apart from the value alone and pass them straight
+ * through without touching any shared state. Below the tag a handle carries the index of its
+ * slot in a fixed table and a per-slot generation, so a handle that was closed never matches
+ * the socket that reuses its slot. Each slot has its own lock and condition variable; sockets
+ * never wait on each other.
+ *
+ * Nothing in here depends on Winsock, handles are plain 32 bit values.
+ */
+
+namespace icmphook_internal {
+
+    constexpr uint32_t k_emu_handle_tag = 0xE0000000u;
+    constexpr uint32_t k_emu_handle_tag_mask = 0xF0000000u;
+    constexpr uint32_t k_emu_slot_bits = 6;
+    constexpr uint32_t k_emu_slot_count = 1u << k_emu_slot_bits;
+    constexpr uint32_t k_emu_generation_mask = (1u << (28 - k_emu_slot_bits)) - 1;
+
+    // whether a handle is in the emulated range at all. pure, this is the whole cost of a hook
+    // on a real socket
+    template<class Handle>
+    constexpr bool emu_handle_tagged(Handle handle) {
+        const auto value = static_cast<uint64_t>(handle);
+        return value <= 0xFFFFFFFFu && (static_cast<uint32_t>(value) & k_emu_handle_tag_mask) == k_emu_handle_tag;
+    }
+
+    template<class State>
+    class EmuSocketTable {
+    public:
+
+        struct Slot {
+            std::mutex mutex;
+            std::condition_variable cv;
+            State state {};
+
+            // the handle currently living here, 0 when free. written under the lock
+            std::atomic<uint32_t> handle {0};
+
+        private:
+            friend class EmuSocketTable;
+
+            std::atomic<bool> claimed {false};
+            uint32_t generation = 0;
+        };
+
+        // a slot locked for the caller, empty when the handle is not an open emulated socket
+        class Locked {
+        public:
+            Locked() = default;
+            Locked(Slot *slot, std::unique_lock<std::mutex> lock) : slot(slot), lock(std::move(lock)) {
+            }
+
+            explicit operator bool() const {
+                return this->slot != nullptr;
+            }
+            Slot *operator->() const {
+                return this->slot;
+            }
+
+            Slot *slot = nullptr;
+            std::unique_lock<std::mutex> lock;
+        };
+
+        // new handle with a default constructed state, 0 when every slot is taken
+        uint32_t alloc() {
+            for (uint32_t index = 0; index < k_emu_slot_count; index++) {
+                auto &slot = this->slots[index];
+                bool expected = false;
+                if (slot.claimed.load(std::memory_order_relaxed) ||
+                        !slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                slot.generation = (slot.generation + 1) & k_emu_generation_mask;
+                slot.state = State {};
+                const uint32_t handle = k_emu_handle_tag | (slot.generation << k_emu_slot_bits) | index;
+                slot.handle.store(handle, std::memory_order_release);
+                return handle;
+            }
+            return 0;
+        }
+
+        // whether the handle is an open emulated socket. lock free, for classification only,
+        // the answer can change before the caller acts on it
+        bool contains(uint64_t handle) const {
+            if (!emu_handle_tagged(handle)) {
+                return false;
+            }
+            const auto &slot = this->slots[handle & (k_emu_slot_count - 1)];
+            return slot.handle.load(std::memory_order_acquire) == handle;
+        }
+
+        Locked acquire(uint64_t handle) {
+            if (!emu_handle_tagged(handle)) {
+                return {};
+            }
+            auto &slot = this->slots[handle & (k_emu_slot_count - 1)];
+            std::unique_lock<std::mutex> lock(slot.mutex);
+            if (slot.handle.load(std::memory_order_relaxed) != handle) {
+                return {};
+            }
+            return Locked(&slot, std::move(lock));
+        }
+
+        // whether `handle` still lives in a slot acquired through it, for wait predicates
+        static bool open(const Slot &slot, uint64_t handle) {
+            return slot.handle.load(std::memory_order_relaxed) == handle;
+        }
+
+        // closes the socket and wakes everything waiting on it; false when it was not open
+        bool release(uint64_t handle) {
+            if (!emu_handle_tagged(handle)) {
+                return false;
+            }
+            auto &slot = this->slots[handle & (k_emu_slot_count - 1)];
+            {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                if (slot.handle.load(std::memory_order_relaxed) != handle) {
+                    return false;
+                }
+                slot.handle.store(0, std::memory_order_release);
+                slot.state = State {};
+                slot.cv.notify_all();
+            }
+            slot.claimed.store(false, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        Slot slots[k_emu_slot_count];
+    };
+}
@@ -0,0 +1,310 @@
+#include "boot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+#include <windows.h>
+
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+#include "util/fileutils.h"
+#include "util/logging.h"
+#include "util/threadpool.h"
+
+namespace launcher::boot {
+
+    namespace {
+
+        struct Event {
+            std::atomic<bool> ready {false};
+            const char *name;
+            char detail[MAX_DETAIL];
+            DWORD thread_id;
+            int64_t start;
+            int64_t end;
+        };
+
+        struct ThreadName {
+            std::atomic<DWORD> thread_id {0};
+            const char *name;
+        };
+
+        Event EVENTS[MAX_EVENTS];
+        std::atomic<size_t> EVENT_COUNT {0};
+
+        ThreadName THREAD_NAMES[16];
+        std::atomic<size_t> THREAD_NAME_COUNT {0};
+
+        thread_local std::optional<Phase> THREAD_STAGE;
+        thread_local bool THREAD_NAMED = false;
+
+        int64_t qpc_frequency() {
+            static const int64_t frequency = [] {
+                LARGE_INTEGER value;
+                QueryPerformanceFrequency(&value);
+                return value.QuadPart;
+            }();
+            return frequency;
+        }
+
+        int64_t qpc_now() {
+            LARGE_INTEGER value;
+            QueryPerformanceCounter(&value);
+            return value.QuadPart;
+        }
+
+        // all timestamps are relative to the first one taken, which is the start of main
+        int64_t qpc_origin() {
+            static const int64_t origin = qpc_now();
+            return origin;
+        }
+
+        double to_us(int64_t ticks) {
+            return static_cast<double>(ticks - qpc_origin()) * 1000000.0 / qpc_frequency();
+        }
+
+        void copy_detail(char (&destination)[MAX_DETAIL], std::string_view detail) {
+            const size_t length = std::min(detail.size(), MAX_DETAIL - 1);
+            if (length > 0) {
+                memcpy(destination, detail.data(), length);
+            }
+            destination[length] = '\0';
+        }
+
+        void record(const char *name, const char *detail, int64_t start, int64_t end) {
+            const size_t index = EVENT_COUNT.fetch_add(1, std::memory_order_relaxed);
+            if (index >= MAX_EVENTS) {
+                return;
+            }
+            auto &event = EVENTS[index];
+            event.name = name;
+            memcpy(event.detail, detail, MAX_DETAIL);
+            event.thread_id = GetCurrentThreadId();
+            event.start = start;
+            event.end = end;
+            event.ready.store(true, std::memory_order_release);
+        }
+    }
+
+    Phase::Phase(const char *name, std::string_view detail) : name(name) {
+        copy_detail(this->detail, detail);
+        qpc_origin();
+        this->start = qpc_now();
+    }
+
+    Phase::~Phase() {
+        this->end();
+    }
+
+    void Phase::end() {
+        if (this->open) {
+            this->open = false;
+            record(this->name, this->detail, this->start, qpc_now());
+        }
+    }
+
+    void stage(const char *name, std::string_view detail) {
+        THREAD_STAGE.reset();
+        if (name) {
+            THREAD_STAGE.emplace(name, detail);
+        }
+    }
+
+    void name_thread(const char *name) {
+        const size_t index = THREAD_NAME_COUNT.fetch_add(1, std::memory_order_relaxed);
+        if (index >= std::size(THREAD_NAMES)) {
+            return;
+        }
+        THREAD_NAMES[index].name = name;
+        THREAD_NAMES[index].thread_id.store(GetCurrentThreadId(), std::memory_order_release);
+    }
+
+    double elapsed_us() {
+        return to_us(qpc_now());
+    }
+
+    bool write_trace(const std::filesystem::path &path) {
+        const auto pid = GetCurrentProcessId();
+        const size_t count = std::min(EVENT_COUNT.load(std::memory_order_relaxed), MAX_EVENTS);
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        // thread names
+        for (size_t i = 0; i < std::min(THREAD_NAME_COUNT.load(), std::size(THREAD_NAMES)); i++) {
+            const auto thread_id = THREAD_NAMES[i].thread_id.load(std::memory_order_acquire);
+            if (thread_id == 0) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("name");
+            writer.String("thread_name");
+            writer.Key("ph");
+            writer.String("M");
+            writer.Key("pid");
+            writer.Uint(pid);
+            writer.Key("tid");
+            writer.Uint(thread_id);
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(THREAD_NAMES[i].name);
+            writer.EndObject();
+            writer.EndObject();
+        }
+
+        // complete events; spans still being written by other threads are skipped
+        for (size_t i = 0; i < count; i++) {
+            const auto &event = EVENTS[i];
+            if (!event.ready.load(std::memory_order_acquire)) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(event.name);
+            writer.Key("cat");
+            writer.String("boot");
+            writer.Key("ph");
+            writer.String("X");
+            writer.Key("ts");
+            writer.Double(to_us(event.start));
+            writer.Key("dur");
+            writer.Double(to_us(event.end) - to_us(event.start));
+            writer.Key("pid");
+            writer.Uint(pid);
+            writer.Key("tid");
+            writer.Uint(event.thread_id);
+            if (event.detail[0] != '\0') {
+                writer.Key("args");
+                writer.StartObject();
+                writer.Key("detail");
+                writer.String(event.detail);
+                writer.EndObject();
+            }
+            writer.EndObject();
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+
+        if (EVENT_COUNT.load(std::memory_order_relaxed) > MAX_EVENTS) {
+            log_warning("launcher", "boot trace is missing {} events",
+                    EVENT_COUNT.load(std::memory_order_relaxed) - MAX_EVENTS);
+        }
+
+        return fileutils::text_write(path, std::string(buffer.GetString(), buffer.GetSize()));
+    }
+
+    TaskGraph::TaskGraph(size_t threads) : pool(std::make_unique<ThreadPool>(std::max<size_t>(threads, 1))) {
+    }
+
+    TaskGraph::~TaskGraph() {
+
+        // errors are only reported through wait(), unobserved ones are dropped here
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->cv.wait(lock, [this] {
+            return std::all_of(this->tasks.begin(), this->tasks.end(), [](const Task &task) {
+                return task.done;
+            });
+        });
+        lock.unlock();
+        this->pool.reset();
+    }
+
+    TaskGraph::Id TaskGraph::add(
+            const char *name,
+            std::function<void()> func,
+            std::initializer_list<Id> dependencies) {
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        const Id id = this->tasks.size();
+        auto &task = this->tasks.emplace_back();
+        task.name = name;
+        task.func = std::move(func);
+        for (const auto dependency : dependencies) {
+            if (dependency >= id) {
+                log_fatal("launcher", "boot task {} depends on unknown task {}", name, dependency);
+            }
+            auto &parent = this->tasks[dependency];
+            if (!parent.done) {
+                task.pending++;
+                parent.dependents.push_back(id);
+            }
+        }
+        if (task.pending == 0) {
+            this->schedule(id);
+        }
+        return id;
+    }
+
+    void TaskGraph::schedule(Id id) {
+        this->pool->post([this, id] {
+            this->execute(id);
+        });
+    }
+
+    void TaskGraph::execute(Id id) {
+        if (!THREAD_NAMED) {
+            THREAD_NAMED = true;
+            name_thread("boot worker");
+        }
+
+        // deque elements stay in place while other tasks are added
+        Task *task;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            task = &this->tasks[id];
+        }
+
+        std::exception_ptr error;
+        {
+            Phase phase(task->name);
+            try {
+                task->func();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        task->done = true;
+        task->error = error;
+        task->func = nullptr;
+        for (const auto dependent : task->dependents) {
+            if (--this->tasks[dependent].pending == 0) {
+                this->schedule(dependent);
+            }
+        }
+        this->cv.notify_all();
+    }
+
+    void TaskGraph::wait(Id id) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        auto &task = this->tasks.at(id);
+        if (!task.done) {
+            Phase phase("wait", task.name);
+            this->cv.wait(lock, [&task] { return task.done; });
+        }
+        if (task.error) {
+            std::rethrow_exception(std::exchange(task.error, nullptr));
+        }
+    }
+
+    void TaskGraph::wait_all() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        const size_t count = this->tasks.size();
+        lock.unlock();
+        for (Id id = 0; id < count; id++) {
+            this->wait(id);
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+namespace launcher::boot {
+
+    /*
+     * Boot timeline.
+     *
+     * Startup phases are recorded as spans with QPC timestamps into a fixed event table, from
+     * any thread and without allocating. Spans nest per thread by time, which is how the
+     * Chrome trace viewer (chrome://tracing, ui.perfetto.dev) draws them, so the table is
+     * written out in that format once the game is about to be entered.
+     */
+
+    // names must be string literals, details are copied and truncated
+    constexpr size_t MAX_EVENTS = 512;
+    constexpr size_t MAX_DETAIL = 64;
+
+    // records a span from construction until end() or destruction
+    class Phase {
+    public:
+        explicit Phase(const char *name, std::string_view detail = {});
+        ~Phase();
+
+        Phase(const Phase &) = delete;
+        Phase &operator=(const Phase &) = delete;
+
+        void end();
+
+    private:
+        const char *name;
+        char detail[MAX_DETAIL];
+        int64_t start;
+        bool open = true;
+    };
+
+    // ends the calling thread's current stage and begins the next one, for long functions
+    // that are split into consecutive stages. nullptr ends the current stage only
+    void stage(const char *name, std::string_view detail = {});
+
+    // names the calling thread in the trace
+    void name_thread(const char *name);
+
+    // microseconds since the first recorded timestamp
+    double elapsed_us();
+
+    // writes all spans recorded so far as Chrome trace JSON
+    bool write_trace(const std::filesystem::path &path);
+
+    /*
+     * Startup task graph.
+     *
+     * Independent startup work is added with the tasks it depends on and runs on a small
+     * thread pool as soon as those have finished, each task recorded as a phase on its
+     * worker. The launcher waits on a task right before it needs the result, so everything
+     * in between overlaps with it. Exceptions thrown by a task are rethrown by wait().
+     */
+    class TaskGraph {
+    public:
+        using Id = size_t;
+
+        explicit TaskGraph(size_t threads);
+        ~TaskGraph();
+
+        TaskGraph(const TaskGraph &) = delete;
+        TaskGraph &operator=(const TaskGraph &) = delete;
+
+        Id add(const char *name, std::function<void()> func, std::initializer_list<Id> dependencies = {});
+
+        void wait(Id id);
+        void wait_all();
+
+    private:
+        struct Task {
+            const char *name;
+            std::function<void()> func;
+            size_t pending = 0;
+            std::vector<Id> dependents;
+            bool done = false;
+            std::exception_ptr error;
+        };
+
+        void schedule(Id id);
+        void execute(Id id);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Task> tasks;
+        std::unique_ptr<ThreadPool> pool;
+    };
+}
@@ -85,6 +85,7 @@
 #include "hooks/networkhook.h"
 #include "hooks/icmphook_net.h"
 #include "hooks/unisintrhook.h"
+#include "launcher/boot.h"
 #include "launcher/launcher.h"
 #include "launcher/logger.h"
 #include "launcher/signal.h"
@@ -118,6 +119,7 @@
 #include "util/libutils.h"
 #include "util/logging.h"
 #include "util/peb.h"
+#include "util/peimage.h"
 #include "util/precise_timer.h"
 #include "util/socd_cleaner.h"
 #include "util/sysutils.h"
@@ -180,6 +182,11 @@ int main_implementation(int argc, char *argv[]) {
     LAUNCHER_ARGC = argc;
     LAUNCHER_ARGV = argv;
 
+    // boot timeline, written next to the log file right before the game is entered
+    launcher::boot::name_thread("launcher");
+    launcher::boot::Phase boot_phase("boot");
+    launcher::boot::stage("early init");
+
     // register exception handler and control handler
     launcher::signal::init();
 
@@ -270,6 +277,7 @@ int main_implementation(int argc, char *argv[]) {
     std::optional<rawinput::MidiNoteAlgorithm> midi_algo;
 
     // parse arguments
+    launcher::boot::stage("options");
     LAUNCHER_OPTIONS = launcher::parse_options(argc, argv);
 
     // command line override (must be done before merging options with cfg)
@@ -277,6 +285,12 @@ int main_implementation(int argc, char *argv[]) {
         launcher::USE_CMD_OVERRIDE = true;
     }
 
+    // automap dump conversion runs offline, nothing else to do
+    const auto &automap_convert = LAUNCHER_OPTIONS->at(launcher::Options::EAAutomapConvert);
+    if (automap_convert.is_active()) {
+        exit(avs::automap::convert(automap_convert.value_text()) ? 0 : 1);
+    }
+
     // determine config file path - must be done before anything else
     const auto &cfg_path = LAUNCHER_OPTIONS->at(launcher::Options::ConfigurationPath);
     if (cfg_path.is_active()) {
@@ -302,6 +316,7 @@ int main_implementation(int argc, char *argv[]) {
             strcpy(avs::game::EXT, options_version.ext.c_str());
         }
         strcpy(avs::game::MODEL, options_version.model.c_str());
+        avs::game::update_identity();
         eamuse_autodetect_game();
     }
 
@@ -1402,6 +1417,10 @@ int main_implementation(int argc, char *argv[]) {
             tapeledutils::TAPE_LED_ALGORITHM = tapeledutils::TAPE_LED_USE_FIRST;
         } else if (text == "last") {
             tapeledutils::TAPE_LED_ALGORITHM = tapeledutils::TAPE_LED_USE_LAST;
+        } else if (text == "perceptual") {
+            tapeledutils::TAPE_LED_ALGORITHM = tapeledutils::TAPE_LED_USE_PERCEPTUAL;
+        } else if (text == "dominant") {
+            tapeledutils::TAPE_LED_ALGORITHM = tapeledutils::TAPE_LED_USE_DOMINANT;
         }
     }
     if (options[launcher::Options::CCJTrackballSensitivity].is_active()) {
@@ -1532,6 +1551,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // delay
+    launcher::boot::stage("delay");
     if (!cfg::CONFIGURATOR_STANDALONE) {
         DWORD delayInSeconds = 0;
         if (options[launcher::Options::spice2x_DelayByNSeconds].is_active()) {
@@ -1547,6 +1567,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // create log file
+    launcher::boot::stage("logging");
     // configurator does not write a log file because it tends to cause the
     // config file to be corrupt...
     if (!cfg::CONFIGURATOR_STANDALONE) {
@@ -1780,6 +1801,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // disable automatic system/monitor sleep
+    launcher::boot::stage("system setup");
     if (!SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED | ES_DISPLAY_REQUIRED)) {
         log_warning("launcher", "could not set thread execution state: {}", GetLastError());
     }
@@ -1830,8 +1852,10 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // early hooks
+    launcher::boot::stage("early hooks");
     if (!cfg_run) {
         for (auto &hook : early_hooks) {
+            launcher::boot::Phase phase("early hook", hook);
             log_info("launcher", "loading early hook DLL {}", hook);
             libutils::print_dll_info(hook);
             HMODULE module;
@@ -1846,6 +1870,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // auto detect game if not specified
+    launcher::boot::stage("game detection");
     if (avs::game::DLL_NAME.empty()) {
         bool module_path_tried = false;
         do {
@@ -2293,6 +2318,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // set error mode to show all errors
+    launcher::boot::stage("game setup");
     SetErrorMode(0);
 
     // set the AVS heap size to a default value varying by game
@@ -2449,44 +2475,66 @@ int main_implementation(int argc, char *argv[]) {
         exit(spicecfg_run(sextet_devices));
     }
 
+    // independent startup work runs in the background while the main thread carries on,
+    // each task is waited on right before its result is needed
+    launcher::boot::stage("environment checks");
+    auto boot_tasks = std::make_unique<launcher::boot::TaskGraph>(4);
+
     // log some DLLs found in path (purely for troubleshooting purposes to detect
     // dxvk, ForceD3D9On12, ifs_layeredfs, etc)
-    libutils::warn_if_dll_exists("d3d8.dll");
-    libutils::warn_if_dll_exists("d3d9.dll");
-    libutils::warn_if_dll_exists("d3d10core.dll");
-    libutils::warn_if_dll_exists("d3d11.dll");
-    libutils::warn_if_dll_exists("d3d12.dll");
-    libutils::warn_if_dll_exists("dxgi.dll");
-    libutils::warn_if_dll_exists("opengl32.dll");
-    libutils::warn_if_dll_exists("nvcuda.dll");
-    libutils::warn_if_dll_exists("nvcuvid.dll");
-    libutils::warn_if_dll_exists("nvEncodeAPI64.dll");
-    libutils::warn_if_dll_exists("msvcr100.dll");
-    libutils::warn_if_dll_exists("dsound.dll");
-
-    // complain loudly & early about dll load ordering issue
-    libutils::check_duplicate_dlls();
+    boot_tasks->add("dll checks", [] {
+        libutils::warn_if_dll_exists("d3d8.dll");
+        libutils::warn_if_dll_exists("d3d9.dll");
+        libutils::warn_if_dll_exists("d3d10core.dll");
+        libutils::warn_if_dll_exists("d3d11.dll");
+        libutils::warn_if_dll_exists("d3d12.dll");
+        libutils::warn_if_dll_exists("dxgi.dll");
+        libutils::warn_if_dll_exists("opengl32.dll");
+        libutils::warn_if_dll_exists("nvcuda.dll");
+        libutils::warn_if_dll_exists("nvcuvid.dll");
+        libutils::warn_if_dll_exists("nvEncodeAPI64.dll");
+        libutils::warn_if_dll_exists("msvcr100.dll");
+        libutils::warn_if_dll_exists("dsound.dll");
+
+        // complain loudly & early about dll load ordering issue
+        libutils::check_duplicate_dlls();
+    });
 
     // print cpu features
     if (!cfg::CONFIGURATOR_STANDALONE && dump_sysinfo) {
-        cpuutils::print_cpu_features();
-        sysutils::print_os();
-        sysutils::print_smbios();
-        sysutils::print_gpus();
+        boot_tasks->add("system info", [] {
+            cpuutils::print_cpu_features();
+            sysutils::print_os();
+            sysutils::print_smbios();
+            sysutils::print_gpus();
+        });
     }
 
+    // initialize raw input; device enumeration (HID, MIDI, XInput) is the slow part.
+    // the hotkey thread doesn't touch RI_MGR before enable_raw_input()
+    const auto rawinput_task = boot_tasks->add("rawinput", [&sextet_devices] {
+        RI_MGR = std::make_unique<rawinput::RawInputManager>();
+        for (const auto &device : sextet_devices) {
+            RI_MGR->sextet_register(device);
+        }
+    });
+
+    // identify the game DLLs and parse their patch files ahead of the patch manager
+    const auto patches_task = boot_tasks->add("patch prefetch", [] {
+        patcher::prefetch_local_patches();
+    });
+
     // fix up monitor
+    launcher::boot::stage("monitor");
     if (options[launcher::Options::PrimaryMonitor].is_active()) {
         change_primary_monitor(options[launcher::Options::PrimaryMonitor].value_text());
     }
     update_monitor_on_boot(monitor_orientation, GRAPHICS_FORCE_REFRESH, monitor_resolution);
 
-    // initialize raw input
-    RI_MGR = std::make_unique<rawinput::RawInputManager>();
+    // raw input is needed from here on
+    launcher::boot::stage("input setup");
+    boot_tasks->wait(rawinput_task);
     hotkeys::enable_raw_input();
-    for (const auto &device : sextet_devices) {
-        RI_MGR->sextet_register(device);
-    }
 
     // print devices
     RI_MGR->devices_print();
@@ -2540,6 +2588,7 @@ int main_implementation(int argc, char *argv[]) {
     timeutils::set_timer_resolution();
 
     // load DLLs
+    launcher::boot::stage("avs boot");
     avs::core::load_dll();
     avs::ea3::load_dll();
 
@@ -2565,11 +2614,15 @@ int main_implementation(int argc, char *argv[]) {
     avs::core::copy_defaults();
 
     // prepare patches (registers the DLL-load notification before the game DLL loads)
+    launcher::boot::stage("game load");
+    boot_tasks->wait(patches_task);
     patcher::init();
 
     // load game
     avs::game::load_dll();
 
+    launcher::boot::stage("game attach");
+
     // attach games
     for (auto game : games) {
         game->attach();
@@ -2587,6 +2640,7 @@ int main_implementation(int argc, char *argv[]) {
 #endif
 
     // attach stub functions
+    launcher::boot::stage("module attach");
     if (!load_stubs) {
         stubs::attach();
     }
@@ -2664,7 +2718,9 @@ int main_implementation(int argc, char *argv[]) {
     update_msvcrt_args(argc, argv);
 
     // load hooks
+    launcher::boot::stage("hooks");
     for (auto &hook : game_hooks) {
+        launcher::boot::Phase phase("hook", hook);
         log_info("launcher", "loading hook DLL {}", hook);
         libutils::print_dll_info(hook);
         HMODULE module;
@@ -2693,9 +2749,11 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // apply patches
+    launcher::boot::stage("patches");
     patcher::apply_patches_on_start();
 
     // load AVS-EA3
+    launcher::boot::stage("ea3 boot");
     avs::ea3::boot(easrv_port, easrv_maint, easrv_smart);
 
     // eamuse init
@@ -2728,6 +2786,7 @@ int main_implementation(int argc, char *argv[]) {
     }
 
     // init SDK
+    launcher::boot::stage("late init");
     sdk::init_sdk_modules();
 
     // API
@@ -2793,10 +2852,35 @@ int main_implementation(int argc, char *argv[]) {
     rawinput::set_midi_algorithm(midi_algo.value());
 
     // attach games
+    launcher::boot::stage("post attach");
     for (auto game : games) {
         game->post_attach();
     }
 
+    // background startup work is done by now, but surface anything that went wrong
+    boot_tasks->wait_all();
+    boot_tasks.reset();
+
+    // PE files inspected during boot
+    {
+        const auto pe_stats = util::PEImage::stats();
+        log_misc("launcher", "PE images: {} files mapped ({} bytes), {} cache hits",
+                pe_stats.opens, pe_stats.bytes_mapped, pe_stats.cache_hits);
+    }
+
+    // boot timeline
+    launcher::boot::stage(nullptr);
+    boot_phase.end();
+    if (!LOG_FILE_PATH.empty()) {
+        const auto boot_ms = launcher::boot::elapsed_us() / 1000.0;
+        const auto trace_path = std::filesystem::path(LOG_FILE_PATH).replace_filename("boot_trace.json");
+        if (launcher::boot::write_trace(trace_path)) {
+            log_misc("launcher", "boot took {:.1f} ms, timeline written to {}", boot_ms, trace_path);
+        } else {
+            log_warning("launcher", "failed to write boot timeline to {}", trace_path);
+        }
+    }
+
     // game start
     log_info("launcher", "calling game entry");
     avs::game::entry_main();
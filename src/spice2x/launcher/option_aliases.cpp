@@ -0,0 +1,130 @@
+#include "option_aliases.h"
+
+#include <algorithm>
+#include <map>
+
+#include "util/logging.h"
+#include "util/utils.h"
+
+namespace {
+
+    inline char ascii_lower(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    bool equals_ignore_case(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (ascii_lower(a[i]) != ascii_lower(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // FNV-1a over the lowercase key with a seeded basis, finalized so all bits mix
+    uint64_t alias_hash(std::string_view key, uint32_t seed) {
+        uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+        for (const char c : key) {
+            hash ^= static_cast<uint8_t>(ascii_lower(c));
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}
+
+launcher::OptionAliasTable::OptionAliasTable(const std::vector<OptionDefinition> &definitions) {
+
+    // collect names and aliases; an alias repeating the option's own name is fine
+    std::vector<std::pair<std::string_view, size_t>> keys;
+    std::map<std::string, size_t> seen;
+    auto add_key = [&](std::string_view key, size_t index) {
+        if (key.empty()) {
+            return;
+        }
+        auto [it, inserted] = seen.emplace(strtolower(std::string(key)), index);
+        if (!inserted) {
+            if (it->second != index) {
+                log_fatal("options", "option alias -{} is used by both -{} and -{}",
+                        key, definitions[it->second].name, definitions[index].name);
+            }
+            return;
+        }
+        keys.emplace_back(key, index);
+    };
+    for (size_t index = 0; index < definitions.size(); index++) {
+        const auto &definition = definitions[index];
+        add_key(definition.name, index);
+        std::string_view aliases = definition.aliases;
+        while (!aliases.empty()) {
+            const auto separator = aliases.find('/');
+            add_key(aliases.substr(0, separator), index);
+            aliases.remove_prefix(separator == std::string_view::npos ? aliases.size() : separator + 1);
+        }
+    }
+
+    // bucket the keys, biggest buckets are placed first while the table is empty
+    this->seeds.assign(std::max<size_t>(keys.size() / 2, 1), 0);
+    this->slots.assign(std::max<size_t>(keys.size(), 1), {});
+    std::vector<std::vector<size_t>> buckets(this->seeds.size());
+    for (size_t key = 0; key < keys.size(); key++) {
+        buckets[alias_hash(keys[key].first, 0) % buckets.size()].push_back(key);
+    }
+    std::vector<size_t> order(buckets.size());
+    for (size_t bucket = 0; bucket < order.size(); bucket++) {
+        order[bucket] = bucket;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    // find a seed per bucket that moves all of its keys into free, distinct slots
+    std::vector<bool> used(this->slots.size(), false);
+    std::vector<size_t> targets;
+    for (const auto bucket : order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+        for (uint32_t seed = 1;; seed++) {
+            if (seed == 0) {
+                log_fatal("options", "failed to build option lookup table");
+            }
+            targets.clear();
+            for (const auto key : buckets[bucket]) {
+                const size_t slot = alias_hash(keys[key].first, seed) % this->slots.size();
+                if (used[slot] || std::find(targets.begin(), targets.end(), slot) != targets.end()) {
+                    break;
+                }
+                targets.push_back(slot);
+            }
+            if (targets.size() == buckets[bucket].size()) {
+                for (size_t i = 0; i < targets.size(); i++) {
+                    used[targets[i]] = true;
+                    this->slots[targets[i]] = {
+                        .alias = keys[buckets[bucket][i]].first,
+                        .index = keys[buckets[bucket][i]].second,
+                    };
+                }
+                this->seeds[bucket] = seed;
+                break;
+            }
+        }
+    }
+}
+
+std::optional<size_t> launcher::OptionAliasTable::find(std::string_view alias) const {
+    const uint32_t seed = this->seeds[alias_hash(alias, 0) % this->seeds.size()];
+    if (seed == 0) {
+        return std::nullopt;
+    }
+    const auto &slot = this->slots[alias_hash(alias, seed) % this->slots.size()];
+    if (!equals_ignore_case(slot.alias, alias)) {
+        return std::nullopt;
+    }
+    return slot.index;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "cfg/option.h"
+
+/*
+ * Flag lookup
+ *
+ * Every option name and alias maps to its registry index through a minimal perfect hash
+ * (hash and displace): keys are spread over small buckets, and each bucket stores the seed
+ * that places all of its keys into free slots of a table with exactly one slot per key.
+ * A lookup hashes the argument twice and does a single case-insensitive compare.
+ */
+namespace launcher {
+
+    class OptionAliasTable {
+    public:
+
+        // the keys are views into `definitions`, which has to outlive the table. log_fatal
+        // when two different options share a name or alias
+        explicit OptionAliasTable(const std::vector<OptionDefinition> &definitions);
+
+        // registry index for a name or alias, case-insensitive and without dashes
+        std::optional<size_t> find(std::string_view alias) const;
+
+    private:
+
+        struct Slot {
+            std::string_view alias;
+            size_t index = 0;
+        };
+
+        std::vector<uint32_t> seeds;
+        std::vector<Slot> slots;
+    };
+}
@@ -1,4 +1,5 @@
 #include "options.h"
+#include "option_aliases.h"
 
 #include "external/tinyxml2/tinyxml2.h"
 #include "util/utils.h"
@@ -2235,13 +2236,15 @@ static const std::vector<OptionDefinition> OPTION_DEFINITIONS = {
         // AsioDownmixToStereo
         .title = "ASIO 7.1 to Stereo Downmix",
         .name = "asiodownmix",
-        .desc = "Extracts a single stereo channel pair from a multi-channel ASIO output, "
-            "mapping the selected pair to the device's first two channels.\n\n"
+        .desc = "Mixes a multi-channel ASIO output down to the device's first two channels, "
+            "either by extracting a single stereo channel pair or by folding in every channel.\n\n"
             "Channel pairs assume a standard 7.1 ASIO layout (0-indexed):\n\n"
             "front: channels 0/1 (front left/right).\n\n"
             "center: channel 2 (front center, duplicated to both outputs).\n\n"
             "rear: channels 4/5 (rear left/right).\n\n"
-            "side: channels 6/7 (side left/right).",
+            "side: channels 6/7 (side left/right).\n\n"
+            "ac4: all channels, front pair at full volume, center and surrounds at -3 dB, "
+            "LFE dropped.",
         .type = OptionType::Enum,
         .category = "Audio Conversion",
         .elements = {
@@ -2249,6 +2252,7 @@ static const std::vector<OptionDefinition> OPTION_DEFINITIONS = {
             {"center", "Center (ch 2)"},
             {"rear", "Rear (ch 4/5)"},
             {"side", "Side (ch 6/7)"},
+            {"ac4", "AC-4 Downmix (all channels)"},
         },
     },
     {
@@ -2336,6 +2340,16 @@ static const std::vector<OptionDefinition> OPTION_DEFINITIONS = {
         .type = OptionType::Bool,
         .category = "Network Dev",
     },
+    {
+        .title = "EA Automap Convert",
+        .name = "automapconvert",
+        .desc = "Converts an automap dump to pretty printed XML next to it, then exits. "
+            "This can only be used via the command line (spice -automapconvert automap_0.bin).",
+        .type = OptionType::Text,
+        .hidden = true,
+        .setting_name = "automap_0.bin",
+        .category = "Network Dev",
+    },
     {
         .title = "Blocking Logger",
         .name = "logblock",
@@ -2995,6 +3009,8 @@ static const std::vector<OptionDefinition> OPTION_DEFINITIONS = {
         .display_name = "tapeledalgo",
         .aliases= "tapeledalgo",
         .desc = "For games with light arrays, determine the algorithm that is used to translate them into a single light binding in Lights tab. "
+            "Averages look at the whole array; perceptual averages the light instead of the values so a few bright LEDs are "
+            "not washed out by dark ones, dominant picks the most common lit color. "
             "Default: mid.",
         .type = OptionType::Enum,
         .category = "I/O Options",
@@ -3004,6 +3020,8 @@ static const std::vector<OptionDefinition> OPTION_DEFINITIONS = {
             {"mid", "Middle LED"},
             {"last", "Last LED"},
             {"avg", "Average color"},
+            {"perceptual", "Perceptual average"},
+            {"dominant", "Dominant color"},
         },
     },
     {
@@ -3490,150 +3508,99 @@ void launcher::validate_option_categories() {
     // shows up under Search, never in the grouped Options nav/content. treat this
     // as fatal so it is caught immediately during development.
     for (const auto &definition : get_option_definitions()) {
-        if (!valid.contains(definition.category)) {
+        if (!valid.contains(std::string(definition.category))) {
             log_fatal("options", "option -{} has orphaned category \"{}\"",
                 definition.name, definition.category);
         }
     }
 }
 
+std::optional<size_t> launcher::find_option(std::string_view alias) {
+    static const launcher::OptionAliasTable table(get_option_definitions());
+    return table.find(alias);
+}
+
 std::unique_ptr<std::vector<Option>> launcher::parse_options(int argc, char *argv[]) {
 
     // one-time sanity check that every option lands in a known nav category
     static std::once_flag validate_once;
     std::call_once(validate_once, validate_option_categories);
 
-    // generate options
+    // generate options, one per definition in registry order
     auto &definitions = get_option_definitions();
     auto options = std::make_unique<std::vector<Option>>();
-
     options->reserve(definitions.size());
-
-    for (auto &definition : definitions) {
-
-        // create aliases
-        std::vector<std::string> aliases;
-        aliases.push_back(definition.name);
-        if (!definition.aliases.empty()) {
-            strsplit(definition.aliases, aliases, '/');
-        }
-
-        // create option
-        auto &option = options->emplace_back(definition, "");
-
-        // check if enabled
-        for (int i = 1; i < argc; i++) {
-
-            // ignore leading '-' characters
-            auto argument = argv[i];
-            while (argument[0] == '-') {
-                argument++;
-            }
-
-            // check aliases
-            for (const auto &alias : aliases) {
-                if (_stricmp(alias.c_str(), argument) == 0) {
-                    switch (definition.type) {
-                        case OptionType::Bool: {
-                            option.value_add("/ENABLED");
-                            break;
-                        }
-                        case OptionType::Integer: {
-                            if (++i >= argc) {
-                                log_fatal("options", "missing parameter for -{}", alias);
-                            } else {
-                                // validate it is an integer
-                                char *p;
-                                strtol(argv[i], &p, 10);
-                                if (*p) {
-                                    log_fatal("options", "parameter for -{} is not a number: {}", alias, argv[i]);
-                                } else {
-                                    option.value_add(argv[i]);
-                                }
-                            }
-                            break;
-                        }
-                        case OptionType::Hex: {
-                            if (++i >= argc) {
-                                log_fatal("options", "missing parameter for -{}", alias);
-                            } else {
-                                // validate it is an integer
-                                try {
-                                    auto _ = std::stoull(argv[i], nullptr, 16);
-                                } catch (const std::exception &ex) {
-                                    log_fatal("options", "parameter for -{} is not a hex number: {}", alias, argv[i]);
-                                }
-                            }
-                            break;
-                        }
-                        case OptionType::Enum:
-                        case OptionType::Text: {
-                            if (++i >= argc) {
-                                log_fatal("options", "missing parameter for -{}", alias);
-                            } else {
-                                option.value_add(argv[i]);
-                            }
-                            break;
-                        }
-                        default: {
-                            log_warning("options", "unknown option type: {} (-{})", definition.type, alias);
-                            break;
-                        }
-                    }
-                    break;
-                }
-            }
-        }
+    for (size_t index = 0; index < definitions.size(); index++) {
+        options->emplace_back(index);
     }
 
-    // positional arguments
+    // flags consume their parameter, anything else not starting with '-' is positional
     std::vector<std::string> positional;
     for (int i = 1; i < argc; i++) {
 
-        // check if enabled
-        bool found = false;
-        for (auto &definition : definitions) {
+        // ignore leading '-' characters
+        auto argument = argv[i];
+        while (argument[0] == '-') {
+            argument++;
+        }
 
-            // create aliases
-            std::vector<std::string> aliases;
-            aliases.push_back(definition.name);
-            if (!definition.aliases.empty()) {
-                strsplit(definition.aliases, aliases, '/');
+        const auto index = find_option(argument);
+        if (!index.has_value()) {
+            if (*argv[i] != '-') {
+                positional.emplace_back(argv[i]);
             }
+            continue;
+        }
 
-            // ignore leading '-' characters
-            auto argument = argv[i];
-            while (argument[0] == '-') {
-                argument++;
+        auto &option = options->at(index.value());
+        auto &definition = option.get_definition();
+        switch (definition.type) {
+            case OptionType::Bool: {
+                option.value_add("/ENABLED");
+                break;
             }
-
-            // check aliases
-            for (const auto &alias : aliases) {
-                if (_stricmp(alias.c_str(), argument) == 0) {
-                    found = true;
-                    switch (definition.type) {
-                        case OptionType::Bool:
-                            break;
-                        case OptionType::Integer:
-                        case OptionType::Hex:
-                        case OptionType::Text:
-                        case OptionType::Enum:
-                            i++;
-                            break;
+            case OptionType::Integer: {
+                if (++i >= argc) {
+                    log_fatal("options", "missing parameter for -{}", argument);
+                } else {
+                    // validate it is an integer
+                    char *p;
+                    strtol(argv[i], &p, 10);
+                    if (*p) {
+                        log_fatal("options", "parameter for -{} is not a number: {}", argument, argv[i]);
+                    } else {
+                        option.value_add(argv[i]);
                     }
-                    break;
                 }
+                break;
             }
-
-            // early quit
-            if (found) {
+            case OptionType::Hex: {
+                if (++i >= argc) {
+                    log_fatal("options", "missing parameter for -{}", argument);
+                } else {
+                    // validate it is an integer
+                    try {
+                        auto _ = std::stoull(argv[i], nullptr, 16);
+                        option.value_add(argv[i]);
+                    } catch (const std::exception &ex) {
+                        log_fatal("options", "parameter for -{} is not a hex number: {}", argument, argv[i]);
+                    }
+                }
+                break;
+            }
+            case OptionType::Enum:
+            case OptionType::Text: {
+                if (++i >= argc) {
+                    log_fatal("options", "missing parameter for -{}", argument);
+                } else {
+                    option.value_add(argv[i]);
+                }
+                break;
+            }
+            default: {
+                log_warning("options", "unknown option type: {} (-{})", definition.type, argument);
                 break;
             }
-        }
-
-        // positional argument
-        if (!found && *argv[i] != '-') {
-            positional.emplace_back(argv[i]);
         }
     }
 
@@ -3652,46 +3619,51 @@ std::vector<Option> launcher::merge_options(
 {
     std::vector<Option> merged;
 
-    for (const auto &option : options) {
-        for (const auto &override : overrides) {
-            if (option.get_definition().name == override.get_definition().name) {
-                if (override.is_active()) {
-                    if (option.is_active()) {
-                        auto &new_option = merged.emplace_back(option.get_definition(), "");
-                        new_option.disabled = true;
+    // first override for each registry index
+    std::vector<const Option *> overrides_by_index(get_option_definitions().size(), nullptr);
+    for (const auto &override : overrides) {
+        auto &slot = overrides_by_index[override.get_index()];
+        if (slot == nullptr) {
+            slot = &override;
+        }
+    }
 
-                        if (USE_CMD_OVERRIDE) {
-                            // command-line arguments take precedence (opt-in)
-                            for (auto &value : override.values()) {
-                                new_option.value_add(value);
-                            }
-                            for (auto &value : option.values()) {
-                                new_option.value_add(value);
-                            }
-                        } else {
-                            // spicecfg options take precedence (default)
-                            // this sucks, but it's the default for legacy spicetools compat
-                            for (auto &value : option.values()) {
-                                new_option.value_add(value);
-                            }
-                            for (auto &value : override.values()) {
-                                new_option.value_add(value);
-                            }
-                        }
-                        new_option.conflicting = true;
-                    } else {
-                        auto &new_option = merged.emplace_back(override.get_definition(), "");
-                        new_option.disabled = true;
+    for (const auto &option : options) {
+        const auto *override = overrides_by_index[option.get_index()];
+        if (override == nullptr) {
+            continue;
+        }
+        if (override->is_active()) {
+            auto &new_option = merged.emplace_back(option.get_index());
+            new_option.disabled = true;
 
-                        for (auto &value : override.values()) {
-                            new_option.value_add(value);
-                        }
+            if (option.is_active()) {
+                if (USE_CMD_OVERRIDE) {
+                    // command-line arguments take precedence (opt-in)
+                    for (auto &value : override->values()) {
+                        new_option.value_add(value);
+                    }
+                    for (auto &value : option.values()) {
+                        new_option.value_add(value);
                     }
                 } else {
-                    merged.push_back(option);
+                    // spicecfg options take precedence (default)
+                    // this sucks, but it's the default for legacy spicetools compat
+                    for (auto &value : option.values()) {
+                        new_option.value_add(value);
+                    }
+                    for (auto &value : override->values()) {
+                        new_option.value_add(value);
+                    }
+                }
+                new_option.conflicting = true;
+            } else {
+                for (auto &value : override->values()) {
+                    new_option.value_add(value);
                 }
-                break;
             }
+        } else {
+            merged.push_back(option);
         }
     }
     return merged;
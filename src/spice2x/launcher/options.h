@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 #include "cfg/option.h"
@@ -225,6 +227,7 @@ namespace launcher {
             LogLevel,
             EAAutomap,
             EANetdump,
+            EAAutomapConvert,
             BlockingLogger,
             DebugCreateFile,
             VerboseGraphicsLogging,
@@ -344,6 +347,10 @@ namespace launcher {
     const std::vector<std::string> &get_categories(Options::OptionsCategory category);
     const std::vector<std::string> &get_quick_setting_categories();
     const std::vector<OptionDefinition> &get_option_definitions();
+
+    // registry index of the option with this name or alias (case-insensitive, without dashes)
+    std::optional<size_t> find_option(std::string_view alias);
+
     void validate_option_categories();
     std::unique_ptr<std::vector<Option>> parse_options(int argc, char *argv[]);
     std::vector<Option> merge_options(const std::vector<Option> &options, const std::vector<Option> &overrides);
@@ -0,0 +1,219 @@
+#include "cardfile.h"
+
+#include <cstring>
+#include <fstream>
+
+static inline bool is_hex_digit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+static inline uint8_t hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return c - 'a' + 10;
+}
+
+CardFile card_file_parse(const char *data, size_t size) {
+    CardFile file;
+    const auto length = size < 16 ? size : 16;
+    memcpy(file.text, data, length);
+    file.text[length] = 0;
+
+    // check size
+    if (size < 16) {
+        file.status = CardFileStatus::TooShort;
+        return file;
+    }
+
+    // verify card
+    for (size_t n = 0; n < 16; n++) {
+        if (!is_hex_digit(data[n])) {
+            file.status = CardFileStatus::InvalidCharacter;
+            file.invalid_pos = n;
+            return file;
+        }
+    }
+
+    // convert hex to bytes
+    for (size_t n = 0; n < 8; n++) {
+        file.card[n] = (uint8_t) (hex_value(data[n * 2]) << 4 | hex_value(data[n * 2 + 1]));
+    }
+    file.status = CardFileStatus::Ok;
+    return file;
+}
+
+struct FileStat {
+    bool exists = false;
+    uintmax_t size = 0;
+    int64_t mtime = 0;
+};
+
+static FileStat file_stat(const std::filesystem::path &path) {
+    FileStat stat;
+    std::error_code error;
+    stat.size = std::filesystem::file_size(path, error);
+    if (error) {
+        return stat;
+    }
+    auto mtime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return stat;
+    }
+    stat.exists = true;
+    stat.mtime = (int64_t) mtime.time_since_epoch().count();
+    return stat;
+}
+
+CardFileStore::CardFileStore(std::chrono::milliseconds refresh_interval)
+        : refresh_interval(refresh_interval) {
+}
+
+CardFileStore::~CardFileStore() {
+    {
+        std::lock_guard<std::mutex> lock(this->watcher_mutex);
+        this->watcher_stop = true;
+    }
+    this->watcher_cv.notify_all();
+    if (this->watcher) {
+        this->watcher->join();
+    }
+}
+
+CardFileStore::Slot *CardFileStore::find(const std::filesystem::path::string_type &path) {
+    const auto count = this->slot_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (this->slots[i].path == path) {
+            return &this->slots[i];
+        }
+    }
+    return nullptr;
+}
+
+// reads and parses the file; `stat` is taken before reading so a change while reading is seen next time
+static void read_entry(const std::filesystem::path &path, const FileStat &stat, CardFile &file) {
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    if (!stat.exists || !f) {
+        file = CardFile {};
+        return;
+    }
+    char buffer[16];
+    f.read(buffer, sizeof(buffer));
+    file = card_file_parse(buffer, (size_t) f.gcount());
+}
+
+// the count pairs with the check in refresh(): either this sees the entry published after
+// the one refresh() frees, or refresh() sees this lookup and keeps the retire list
+CardFile CardFileStore::read(const Slot &slot) {
+    this->readers.fetch_add(1);
+    const auto file = slot.entry.load()->file;
+    this->readers.fetch_sub(1, std::memory_order_release);
+    return file;
+}
+
+void CardFileStore::publish(Slot &slot, std::unique_ptr<const Entry> entry) {
+    slot.entry.store(entry.get());
+    if (slot.owned) {
+        this->retired.emplace_back(std::move(slot.owned));
+    }
+    slot.owned = std::move(entry);
+}
+
+CardFile CardFileStore::get(const std::filesystem::path &path, bool reload) {
+
+    // fast path, no lock and no disk access
+    const auto &key = path.native();
+    auto slot = this->find(key);
+    if (slot && !reload) {
+        return this->read(*slot);
+    }
+
+    // first time this path is used, or a reload
+    std::lock_guard<std::mutex> lock(this->mutex);
+    slot = this->find(key);
+    if (slot && !reload) {
+        return this->read(*slot);
+    }
+    auto entry = std::make_unique<Entry>();
+    const auto stat = file_stat(path);
+    entry->exists = stat.exists;
+    entry->size = stat.size;
+    entry->mtime = stat.mtime;
+    read_entry(path, stat, entry->file);
+    this->loads.fetch_add(1, std::memory_order_relaxed);
+    const auto file = entry->file;
+    if (slot) {
+        this->publish(*slot, std::move(entry));
+        return file;
+    }
+
+    // out of slots, this path stays uncached
+    const auto count = this->slot_count.load(std::memory_order_relaxed);
+    if (count >= SLOT_COUNT) {
+        return file;
+    }
+    auto &new_slot = this->slots[count];
+    new_slot.path = key;
+    this->publish(new_slot, std::move(entry));
+    this->slot_count.store(count + 1, std::memory_order_release);
+
+    this->start_watcher();
+    return file;
+}
+
+void CardFileStore::refresh() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // everything on the list was unpublished before this point, so with no lookup running
+    // nobody can still be looking at it
+    if (!this->retired.empty() && this->readers.load() == 0) {
+        this->retired.clear();
+    }
+
+    const auto count = this->slot_count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        auto &slot = this->slots[i];
+        const auto previous = slot.owned.get();
+        const std::filesystem::path path(slot.path);
+        const auto stat = file_stat(path);
+        if (stat.exists == previous->exists && stat.size == previous->size && stat.mtime == previous->mtime) {
+            continue;
+        }
+
+        // publish the new contents, the old ones stay valid for readers still holding them
+        auto entry = std::make_unique<Entry>();
+        entry->exists = stat.exists;
+        entry->size = stat.size;
+        entry->mtime = stat.mtime;
+        read_entry(path, stat, entry->file);
+        this->loads.fetch_add(1, std::memory_order_relaxed);
+        this->publish(slot, std::move(entry));
+    }
+}
+
+size_t CardFileStore::retired_count() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->retired.size();
+}
+
+void CardFileStore::start_watcher() {
+    if (this->refresh_interval.count() <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(this->watcher_mutex);
+    if (this->watcher_started) {
+        return;
+    }
+    this->watcher_started = true;
+    this->watcher = std::make_unique<std::thread>([this] {
+        std::unique_lock<std::mutex> lock(this->watcher_mutex);
+        while (!this->watcher_cv.wait_for(lock, this->refresh_interval, [this] { return this->watcher_stop; })) {
+            lock.unlock();
+            this->refresh();
+            lock.lock();
+        }
+    });
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Card files (card0.txt and friends), parsed once and kept in memory.
+ *
+ * Every path that was asked for gets a slot holding the parsed contents of the file. A watcher
+ * thread compares size and modification time of the watched files every now and then and
+ * reparses the ones that changed, so looking a card up never touches the disk except for the
+ * very first time a path is used. Parsed contents are immutable and published through an
+ * atomic pointer, lookups take no lock. Replaced contents go on a retire list which the next
+ * refresh frees, unless a lookup is in the middle of copying contents out right then; lookups
+ * only count themselves in and out around that copy.
+ *
+ * No Windows dependencies, logging is left to the caller.
+ */
+
+enum class CardFileStatus : uint8_t {
+    Ok,
+    OpenFailed,
+    TooShort,
+    InvalidCharacter,
+};
+
+struct CardFile {
+    CardFileStatus status = CardFileStatus::OpenFailed;
+
+    // the card ID, valid when status is Ok
+    uint8_t card[8] {};
+
+    // up to the first 16 characters of the file as they are, null terminated
+    char text[17] {};
+
+    // position of the first character that is not a hex digit, for InvalidCharacter
+    size_t invalid_pos = 0;
+};
+
+// parses card file contents, only the first 16 characters matter
+CardFile card_file_parse(const char *data, size_t size);
+
+class CardFileStore {
+public:
+
+    // how often the watcher looks for changes; zero disables it, leaving refresh() to the caller
+    explicit CardFileStore(std::chrono::milliseconds refresh_interval = std::chrono::milliseconds(500));
+    ~CardFileStore();
+
+    CardFileStore(const CardFileStore &) = delete;
+    CardFileStore &operator=(const CardFileStore &) = delete;
+
+    /*
+     * Current contents of the file at `path`, loading it the first time it is asked for.
+     * `reload` reads the file again right away, for files that may have been swapped out
+     * underneath, like the ones on a freshly plugged in drive.
+     */
+    CardFile get(const std::filesystem::path &path, bool reload = false);
+
+    // checks all watched files for changes and reparses the ones that changed
+    void refresh();
+
+    // number of times a file was actually read and parsed, for diagnostics
+    size_t load_count() const {
+        return this->loads.load(std::memory_order_relaxed);
+    }
+
+    // replaced contents not freed yet, for diagnostics
+    size_t retired_count();
+
+private:
+    static constexpr size_t SLOT_COUNT = 64;
+
+    struct Entry {
+        CardFile file;
+        bool exists = false;
+        uintmax_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    struct Slot {
+
+        // set once before `entry` is first published, never changed afterwards
+        std::filesystem::path::string_type path;
+        std::atomic<const Entry *> entry {nullptr};
+
+        // writers only, owns what `entry` points to
+        std::unique_ptr<const Entry> owned;
+    };
+
+    Slot slots[SLOT_COUNT];
+    std::atomic<size_t> slot_count {0};
+
+    // writers only: slot registration, reloads and the retire list
+    std::mutex mutex;
+    std::vector<std::unique_ptr<const Entry>> retired;
+    std::atomic<size_t> loads {0};
+
+    // lookups currently copying contents out of an entry
+    std::atomic<size_t> readers {0};
+
+    // watcher thread
+    std::chrono::milliseconds refresh_interval;
+    std::mutex watcher_mutex;
+    std::condition_variable watcher_cv;
+    bool watcher_started = false;
+    bool watcher_stop = false;
+    std::unique_ptr<std::thread> watcher;
+
+    Slot *find(const std::filesystem::path::string_type &path);
+    CardFile read(const Slot &slot);
+    void publish(Slot &slot, std::unique_ptr<const Entry> entry);
+    void start_watcher();
+};
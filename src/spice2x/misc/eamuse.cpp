@@ -2,7 +2,6 @@
 
 #include <atomic>
 #include <chrono>
-#include <fstream>
 #include <thread>
 
 #include "avs/game.h"
@@ -17,6 +16,7 @@
 #include "overlay/notifications.h"
 
 #include "bt5api.h"
+#include "cardfile.h"
 
 // state
 static constexpr double NOTIFICATION_THROTTLE_SECONDS = 3.0;
@@ -35,6 +35,9 @@ static uint16_t KEYPAD_STATE_OVERRIDES_OVERLAY[] = {0, 0};
 static std::string EAMUSE_GAME_NAME;
 static ConfigKeypadBindings KEYPAD_BINDINGS {};
 
+// card files, never destroyed so the watcher outlives everyone inserting cards
+static CardFileStore *CARD_FILES = new CardFileStore();
+
 // auto card
 bool AUTO_INSERT_CARD[2] = {false, false};
 float AUTO_INSERT_CARD_COOLDOWN = 8.f; // seconds
@@ -149,68 +152,46 @@ bool eamuse_get_card(const std::filesystem::path &path, uint8_t *card, int index
     return eamuse_get_card_from_file(path, card, index);
 }
 
-bool eamuse_get_card_from_file(const std::filesystem::path &path, uint8_t *card, int index) {
-
-    // open file
-    std::ifstream f(path);
-    if (!f) {
-        log_warning("eamuse", "{} can not be opened!", path);
-        overlay::notifications::add_throttled(
-            overlay::notifications::Severity::Error,
-            fmt::format("eamuse.card_file_error.p{}", index + 1),
-            NOTIFICATION_THROTTLE_SECONDS,
-            fmt::format("[P{}] can't open card file", index + 1));
-        return false;
-    }
-
-    // get size
-    f.seekg(0, f.end);
-    auto length = (size_t) f.tellg();
-    f.seekg(0, f.beg);
-
-    // check size
-    if (length < 16) {
-        log_warning("eamuse", "{} is too small (must be at least 16 characters)", path);
-        overlay::notifications::add_throttled(
-            overlay::notifications::Severity::Error,
-            fmt::format("eamuse.card_file_error.p{}", index + 1),
-            NOTIFICATION_THROTTLE_SECONDS,
-            fmt::format("[P{}] card file error", index + 1));
-
-        return false;
-    }
-
-    // read file
-    char buffer[17];
-    f.read(buffer, 16);
-    buffer[16] = 0;
+bool eamuse_get_card_from_file(const std::filesystem::path &path, uint8_t *card, int index, bool reload) {
 
-    // verify card
-    for (int n = 0; n < 16; n++) {
-        char c = buffer[n];
-        bool digit = c >= '0' && c <= '9';
-        bool character_big = c >= 'A' && c <= 'F';
-        bool character_small = c >= 'a' && c <= 'f';
-        if (!digit && !character_big && !character_small) {
+    // get parsed file contents
+    const auto file = CARD_FILES->get(path, reload);
+    switch (file.status) {
+        case CardFileStatus::Ok:
+            break;
+        case CardFileStatus::OpenFailed:
+            log_warning("eamuse", "{} can not be opened!", path);
+            overlay::notifications::add_throttled(
+                overlay::notifications::Severity::Error,
+                fmt::format("eamuse.card_file_error.p{}", index + 1),
+                NOTIFICATION_THROTTLE_SECONDS,
+                fmt::format("[P{}] can't open card file", index + 1));
+            return false;
+        case CardFileStatus::TooShort:
+            log_warning("eamuse", "{} is too small (must be at least 16 characters)", path);
+            overlay::notifications::add_throttled(
+                overlay::notifications::Severity::Error,
+                fmt::format("eamuse.card_file_error.p{}", index + 1),
+                NOTIFICATION_THROTTLE_SECONDS,
+                fmt::format("[P{}] card file error", index + 1));
+            return false;
+        case CardFileStatus::InvalidCharacter:
             log_warning("eamuse",
                 "{} contains an invalid character sequence at byte {} (16 characters, 0-9/A-F only)",
-                path, n);
-
+                path, file.invalid_pos);
             overlay::notifications::add_throttled(
                 overlay::notifications::Severity::Error,
                 fmt::format("eamuse.card_file_error.p{}", index + 1),
                 NOTIFICATION_THROTTLE_SECONDS,
                 fmt::format("[P{}] card file error", index + 1));
             return false;
-        }
     }
+    const char *buffer = file.text;
+    memcpy(card, file.card, 8);
 
     // info
     log_info("eamuse", "[P{}] Inserted {}: {}", index+1, path, buffer);
 
-    // convert hex to bytes
-    hex2bin(buffer, card);
-
     // cache it for auto-insert
     if (AUTO_INSERT_CARD[index] && !AUTO_INSERT_CARD_CACHED[index]) {
         memcpy(AUTO_INSERT_CARD_CACHED_DATA[index], card, 8);
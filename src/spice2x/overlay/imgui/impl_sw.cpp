@@ -7,10 +7,18 @@
 #include "impl_sw.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "external/imgui/imgui.h"
+#include "util/cpuutils.h"
+#include "util/simd.h"
+#include "util/threadpool.h"
 
 namespace imgui_sw {
 namespace {
@@ -28,8 +36,15 @@ struct PaintTarget
 	int       width;
 	int       height;
 	ImVec2    scale; // Multiply ImGui (point) coordinates with this to get pixel coordinates.
+
+	// Pixel region [min, max) this pass may write to, i.e. the tile being painted.
+	int       min_x, min_y;
+	int       max_x, max_y;
 };
 
+// Screen tiles are this many pixels wide and high.
+constexpr int kTileSize = 64;
+
 // ----------------------------------------------------------------------------
 
 struct ColorInt
@@ -56,16 +71,197 @@ struct ColorInt
 	}
 };
 
+// x / 255 for x in [0, 255 * 255], without a divide.
+inline uint32_t div255(uint32_t x)
+{
+	return (x + 1 + (x >> 8)) >> 8;
+}
+
 ColorInt blend(ColorInt target, ColorInt source)
 {
 	ColorInt result;
 	result.a = 0; // Whatever.
-	result.b = (source.b * source.a + target.b * (255 - source.a)) / 255;
-	result.g = (source.g * source.a + target.g * (255 - source.a)) / 255;
-	result.r = (source.r * source.a + target.r * (255 - source.a)) / 255;
+	result.b = div255(source.b * source.a + target.b * (255 - source.a));
+	result.g = div255(source.g * source.a + target.g * (255 - source.a));
+	result.r = div255(source.r * source.a + target.r * (255 - source.a));
 	return result;
 }
 
+// ----------------------------------------------------------------------------
+// Span blending. The SSE2 versions give the exact same results as blend().
+
+bool use_sse2()
+{
+#if SIMD_X86
+	static const bool sse2 = cpuutils::has_sse2();
+	return sse2;
+#else
+	return false;
+#endif
+}
+
+constexpr uint32_t kColorMask = ~(0xFFu << IM_COL32_A_SHIFT);
+
+#if SIMD_X86
+
+SIMD_TARGET_SSE2 SIMD_INLINE __m128i sse2_div255(__m128i x)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), one), 8);
+}
+
+// Blends two pixels unpacked to 16 bits per channel, with the alphas broadcast over all four
+// channels and `source` premultiplied. The alpha channel of the result is garbage, callers
+// clear it like blend() does.
+SIMD_TARGET_SSE2 SIMD_INLINE __m128i sse2_blend2(__m128i target, __m128i source, __m128i alpha)
+{
+	const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return sse2_div255(_mm_add_epi16(source, _mm_mullo_epi16(target, inverse)));
+}
+
+// Two pixels of `color` premultiplied by its alpha and unpacked to 16 bits per channel, with
+// a zero alpha channel.
+SIMD_TARGET_SSE2 SIMD_INLINE __m128i sse2_premultiplied(ColorInt color)
+{
+	alignas(16) uint16_t lanes[8] {};
+	for (int pixel = 0; pixel < 2; ++pixel) {
+		lanes[pixel * 4 + IM_COL32_B_SHIFT / 8] = static_cast<uint16_t>(color.b * color.a);
+		lanes[pixel * 4 + IM_COL32_G_SHIFT / 8] = static_cast<uint16_t>(color.g * color.a);
+		lanes[pixel * 4 + IM_COL32_R_SHIFT / 8] = static_cast<uint16_t>(color.r * color.a);
+	}
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+}
+
+SIMD_TARGET_SSE2 void sse2_blend_span(uint32_t* pixels, int count, ColorInt color)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color_mask = _mm_set1_epi32(static_cast<int>(kColorMask));
+	const __m128i source = sse2_premultiplied(color);
+	const __m128i alpha = _mm_set1_epi16(static_cast<short>(color.a));
+
+	// Most spans cover a background of a single color, which only needs blending once:
+	__m128i last_target = _mm_set1_epi32(static_cast<int>(pixels[0]));
+	__m128i last_output = _mm_set1_epi32(static_cast<int>(blend(ColorInt(pixels[0]), color).toUint32()));
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(target, last_target)) == 0xFFFF) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), last_output);
+			continue;
+		}
+		const __m128i lo = sse2_blend2(_mm_unpacklo_epi8(target, zero), source, alpha);
+		const __m128i hi = sse2_blend2(_mm_unpackhi_epi8(target, zero), source, alpha);
+		const __m128i result = _mm_and_si128(_mm_packus_epi16(lo, hi), color_mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), result);
+		last_target = _mm_shuffle_epi32(target, _MM_SHUFFLE(3, 3, 3, 3));
+		last_output = _mm_shuffle_epi32(result, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	for (; x < count; ++x) {
+		pixels[x] = blend(ColorInt(pixels[x]), color).toUint32();
+	}
+}
+
+// Blends `color` with its alpha scaled by a coverage value per pixel. Pixels without coverage
+// are left untouched.
+SIMD_TARGET_SSE2 void sse2_blend_coverage_span(uint32_t* pixels, const uint8_t* coverage, int count, ColorInt color)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color_mask = _mm_set1_epi32(static_cast<int>(kColorMask));
+	const __m128i color_alpha = _mm_set1_epi16(static_cast<short>(color.a));
+
+	// Source channels unpacked, without premultiplication since the alpha varies:
+	ColorInt opaque = color;
+	opaque.a = 0;
+	const __m128i source = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(opaque.toUint32())), zero);
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		uint32_t texels;
+		memcpy(&texels, coverage + x, sizeof(texels));
+		if (texels == 0) {
+			continue;
+		}
+
+		// per pixel alpha, broadcast over the four channels of each pixel
+		const __m128i texel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(texels)), zero);
+		const __m128i alpha = sse2_div255(_mm_mullo_epi16(texel, color_alpha));
+		const __m128i alpha_pairs = _mm_unpacklo_epi16(alpha, alpha);
+		const __m128i alpha_lo = _mm_unpacklo_epi32(alpha_pairs, alpha_pairs);
+		const __m128i alpha_hi = _mm_unpackhi_epi32(alpha_pairs, alpha_pairs);
+
+		const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		const __m128i lo = sse2_blend2(_mm_unpacklo_epi8(target, zero), _mm_mullo_epi16(source, alpha_lo), alpha_lo);
+		const __m128i hi = sse2_blend2(_mm_unpackhi_epi8(target, zero), _mm_mullo_epi16(source, alpha_hi), alpha_hi);
+		const __m128i blended = _mm_and_si128(_mm_packus_epi16(lo, hi), color_mask);
+
+		// keep the pixels without coverage
+		const __m128i keep = _mm_cmpeq_epi32(_mm_unpacklo_epi16(texel, zero), zero);
+		const __m128i result = _mm_or_si128(_mm_and_si128(keep, target), _mm_andnot_si128(keep, blended));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), result);
+	}
+	for (; x < count; ++x) {
+		if (coverage[x] == 0) { continue; }
+		ColorInt source_color = color;
+		source_color.a = div255(source_color.a * coverage[x]);
+		pixels[x] = blend(ColorInt(pixels[x]), source_color).toUint32();
+	}
+}
+
+#endif
+
+void blend_span(uint32_t* pixels, int count, const ColorInt& color)
+{
+	if (count <= 0) { return; }
+
+	// Opaque, no blending needed:
+	if (color.a == 255) {
+		std::fill_n(pixels, count, color.toUint32() & kColorMask);
+		return;
+	}
+
+#if SIMD_X86
+	// Short spans like the rows of vertical lines aren't worth the setup:
+	if (count >= 8 && use_sse2()) {
+		sse2_blend_span(pixels, count, color);
+		return;
+	}
+#endif
+
+	// We often blend the same colors over and over again, so optimize for this (saves 25% total cpu):
+	uint32_t last_target_pixel = pixels[0];
+	uint32_t last_output = blend(ColorInt(last_target_pixel), color).toUint32();
+	for (int x = 0; x < count; ++x) {
+		uint32_t& target_pixel = pixels[x];
+		if (target_pixel == last_target_pixel) {
+			target_pixel = last_output;
+			continue;
+		}
+		last_target_pixel = target_pixel;
+		target_pixel = blend(ColorInt(target_pixel), color).toUint32();
+		last_output = target_pixel;
+	}
+}
+
+void blend_coverage_span(uint32_t* pixels, const uint8_t* coverage, int count, const ColorInt& color)
+{
+#if SIMD_X86
+	if (use_sse2()) {
+		sse2_blend_coverage_span(pixels, coverage, count, color);
+		return;
+	}
+#endif
+
+	for (int x = 0; x < count; ++x) {
+		// The font texture is all black or all white, so optimize for this:
+		if (coverage[x] == 0) { continue; }
+
+		ColorInt source_color = color;
+		source_color.a = div255(source_color.a * coverage[x]);
+		pixels[x] = blend(ColorInt(pixels[x]), source_color).toUint32();
+	}
+}
+
 // ----------------------------------------------------------------------------
 // Used for interpolating vertex attributes (color and texture coordinates) in a triangle.
 
@@ -207,12 +403,188 @@ inline uint8_t sample_texture(const Texture& texture, const ImVec2& uv)
 	return texture.pixels[ty * texture.width + tx];
 }
 
-void paint_uniform_rectangle(
+inline uint64_t hash_mix(uint64_t hash, uint64_t value)
+{
+	hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+	return hash ^ (hash >> 29);
+}
+
+uint64_t hash_float2(uint64_t hash, float a, float b)
+{
+	uint32_t bits[2];
+	memcpy(&bits[0], &a, sizeof(a));
+	memcpy(&bits[1], &b, sizeof(b));
+	return hash_mix(hash, (static_cast<uint64_t>(bits[1]) << 32) | bits[0]);
+}
+
+// ----------------------------------------------------------------------------
+// Texture coordinates of a textured rectangle, stepped per pixel from the top left of its
+// (clipped) bounding box.
+
+struct UvMapping
+{
+	ImVec2 topleft;
+	ImVec2 per_pixel;
+};
+
+UvMapping uv_mapping(
 	const PaintTarget& target,
-	const ImVec2&      min_f,
-	const ImVec2&      max_f,
-	const ColorInt&    color,
-	Stats*             stats)
+	const ImDrawVert&  min_v,
+	const ImDrawVert&  max_v,
+	int                min_x_i,
+	int                min_y_i)
+{
+	const ImVec2 min_p = ImVec2(target.scale.x * min_v.pos.x, target.scale.y * min_v.pos.y);
+	const ImVec2 max_p = ImVec2(target.scale.x * max_v.pos.x, target.scale.y * max_v.pos.y);
+
+	const auto topleft = ImVec2(min_x_i + 0.5f * target.scale.x,
+	                            min_y_i + 0.5f * target.scale.y);
+
+	const ImVec2 delta_uv_per_pixel = {
+		(max_v.uv.x - min_v.uv.x) / (max_p.x - min_p.x),
+		(max_v.uv.y - min_v.uv.y) / (max_p.y - min_p.y),
+	};
+	const ImVec2 uv_topleft = {
+		min_v.uv.x + (topleft.x - min_v.pos.x) * delta_uv_per_pixel.x,
+		min_v.uv.y + (topleft.y - min_v.pos.y) * delta_uv_per_pixel.y,
+	};
+	return UvMapping{uv_topleft, delta_uv_per_pixel};
+}
+
+// ----------------------------------------------------------------------------
+// Text is made of small textured rectangles, and the same glyphs are drawn over and over
+// again. Their coverage is sampled once into a cache keyed by everything sample_texture()
+// gets to see, so blitting a cached glyph gives exactly the pixels sampling it again would.
+
+// Only rectangles up to this size are cached, bigger ones are sampled directly.
+constexpr int kMaxGlyphSize = 64;
+
+// The cache is dropped when it grows past this many entries, which takes lots of different
+// glyph sizes or subpixel offsets.
+constexpr size_t kMaxGlyphs = 4096;
+
+struct GlyphKey
+{
+	const Texture* texture;
+	UvMapping      uv;
+	int            width;
+	int            height;
+
+	bool operator==(const GlyphKey& other) const
+	{
+		return texture == other.texture &&
+		       uv.topleft.x == other.uv.topleft.x &&
+		       uv.topleft.y == other.uv.topleft.y &&
+		       uv.per_pixel.x == other.uv.per_pixel.x &&
+		       uv.per_pixel.y == other.uv.per_pixel.y &&
+		       width == other.width &&
+		       height == other.height;
+	}
+};
+
+struct GlyphKeyHash
+{
+	size_t operator()(const GlyphKey& key) const
+	{
+		uint64_t hash = hash_mix(reinterpret_cast<uintptr_t>(key.texture), (static_cast<uint64_t>(key.width) << 32) | key.height);
+		hash = hash_float2(hash, key.uv.topleft.x, key.uv.topleft.y);
+		return static_cast<size_t>(hash_float2(hash, key.uv.per_pixel.x, key.uv.per_pixel.y));
+	}
+};
+
+struct Glyph
+{
+	int                  width;
+	int                  height;
+	std::vector<uint8_t> coverage;  // Texels, one per pixel.
+	std::vector<uint8_t> row_begin; // First covered pixel of each row.
+	std::vector<uint8_t> row_end;   // One past the last covered pixel, equal to row_begin when empty.
+};
+
+// Node based, so glyphs stay in place while others are added.
+using GlyphCache = std::unordered_map<GlyphKey, Glyph, GlyphKeyHash>;
+
+const Glyph* find_glyph(GlyphCache& cache, const Texture& texture, const UvMapping& uv, int width, int height)
+{
+	const auto [it, inserted] = cache.try_emplace(GlyphKey{&texture, uv, width, height});
+	Glyph& glyph = it->second;
+	if (!inserted) { return &glyph; }
+
+	glyph.width = width;
+	glyph.height = height;
+	glyph.coverage.resize(width * height);
+	glyph.row_begin.resize(height);
+	glyph.row_end.resize(height);
+
+	ImVec2 current_uv = uv.topleft;
+	for (int y = 0; y < height; ++y, current_uv.y += uv.per_pixel.y) {
+		current_uv.x = uv.topleft.x;
+		int begin = width;
+		int end = 0;
+		for (int x = 0; x < width; ++x, current_uv.x += uv.per_pixel.x) {
+			const uint8_t texel = sample_texture(texture, current_uv);
+			glyph.coverage[y * width + x] = texel;
+			if (texel != 0) {
+				begin = std::min(begin, x);
+				end = x + 1;
+			}
+		}
+		glyph.row_begin[y] = static_cast<uint8_t>(std::min(begin, end));
+		glyph.row_end[y] = static_cast<uint8_t>(end);
+	}
+	return &glyph;
+}
+
+// ----------------------------------------------------------------------------
+// Draw commands are decoded into primitives once per frame. Each primitive is then binned
+// into the screen tiles its bounding box touches, and painted once for each of them.
+
+struct Primitive
+{
+	enum class Kind : uint8_t
+	{
+		UniformRectangle,
+		UniformTexturedRectangle,
+		Triangle,
+	};
+
+	Kind              kind;
+	uint32_t          color;   // Uniform rectangles only.
+	const ImDrawVert* v0;      // Textured rectangles: top left.
+	const ImDrawVert* v1;      // Textured rectangles: bottom right.
+	const ImDrawVert* v2;
+	const Texture*    texture; // Null for untextured triangles.
+	const Glyph*      glyph;   // Textured rectangles with cached coverage, or null.
+
+	// Pixel bounding box [min, max), clipped against the clip rect and the render target:
+	int               min_x, min_y;
+	int               max_x, max_y;
+
+	uint64_t          hash;
+};
+
+// Bounding box of a primitive clipped to the region of the target, false when nothing is left.
+bool clip_to_target(
+	const PaintTarget& target,
+	const Primitive&   primitive,
+	int&               min_x_i,
+	int&               min_y_i,
+	int&               max_x_i,
+	int&               max_y_i)
+{
+	min_x_i = std::max(primitive.min_x, target.min_x);
+	min_y_i = std::max(primitive.min_y, target.min_y);
+	max_x_i = std::min(primitive.max_x, target.max_x);
+	max_y_i = std::min(primitive.max_y, target.max_y);
+	return min_x_i < max_x_i && min_y_i < max_y_i;
+}
+
+void add_uniform_rectangle(
+	const PaintTarget&      target,
+	const ImVec2&           min_f,
+	const ImVec2&           max_f,
+	uint32_t                color,
+	std::vector<Primitive>& primitives)
 {
 	// Integer bounding box [min, max):
 	int min_x_i = static_cast<int>(target.scale.x * min_f.x + 0.5f);
@@ -226,33 +598,36 @@ void paint_uniform_rectangle(
 	max_x_i = std::min(max_x_i, target.width);
 	max_y_i = std::min(max_y_i, target.height);
 
-	stats->uniform_rectangle_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
+	if (min_x_i >= max_x_i || min_y_i >= max_y_i) { return; }
 
-	// We often blend the same colors over and over again, so optimize for this (saves 25% total cpu):
-	uint32_t last_target_pixel = target.pixels[min_y_i * target.width + min_x_i];
-	uint32_t last_output = blend(ColorInt(last_target_pixel), color).toUint32();
+	primitives.push_back(Primitive{Primitive::Kind::UniformRectangle, color, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                               min_x_i, min_y_i, max_x_i, max_y_i, 0});
+}
+
+void paint_uniform_rectangle(
+	const PaintTarget& target,
+	const Primitive&   rect,
+	Stats*             stats)
+{
+	int min_x_i, min_y_i, max_x_i, max_y_i;
+	if (!clip_to_target(target, rect, min_x_i, min_y_i, max_x_i, max_y_i)) { return; }
 
+	stats->uniform_rectangle_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
+
+	const ColorInt color(rect.color);
 	for (int y = min_y_i; y < max_y_i; ++y) {
-		for (int x = min_x_i; x < max_x_i; ++x) {
-			uint32_t& target_pixel = target.pixels[y * target.width + x];
-			if (target_pixel == last_target_pixel) {
-				target_pixel = last_output;
-				continue;
-			}
-			last_target_pixel = target_pixel;
-			target_pixel = blend(ColorInt(target_pixel), color).toUint32();
-			last_output = target_pixel;
-		}
+		blend_span(&target.pixels[y * target.width + min_x_i], max_x_i - min_x_i, color);
 	}
 }
 
-void paint_uniform_textured_rectangle(
-	const PaintTarget& target,
-	const Texture&     texture,
-	const ImVec4&      clip_rect,
-	const ImDrawVert&  min_v,
-	const ImDrawVert&  max_v,
-	Stats*             stats)
+void add_uniform_textured_rectangle(
+	const PaintTarget&      target,
+	const Texture&          texture,
+	const ImVec4&           clip_rect,
+	const ImDrawVert&       min_v,
+	const ImDrawVert&       max_v,
+	GlyphCache*             glyphs,
+	std::vector<Primitive>& primitives)
 {
 	const ImVec2 min_p = ImVec2(target.scale.x * min_v.pos.x, target.scale.y * min_v.pos.y);
 	const ImVec2 max_p = ImVec2(target.scale.x * max_v.pos.x, target.scale.y * max_v.pos.y);
@@ -281,34 +656,75 @@ void paint_uniform_textured_rectangle(
 	max_x_i = std::min(max_x_i, target.width);
 	max_y_i = std::min(max_y_i, target.height);
 
+	if (min_x_i >= max_x_i || min_y_i >= max_y_i) { return; }
+
+	const Glyph* glyph = nullptr;
+	const int width = max_x_i - min_x_i;
+	const int height = max_y_i - min_y_i;
+	if (glyphs && width <= kMaxGlyphSize && height <= kMaxGlyphSize) {
+		glyph = find_glyph(*glyphs, texture, uv_mapping(target, min_v, max_v, min_x_i, min_y_i), width, height);
+	}
+
+	primitives.push_back(Primitive{Primitive::Kind::UniformTexturedRectangle, min_v.col, &min_v, &max_v, nullptr, &texture, glyph,
+	                               min_x_i, min_y_i, max_x_i, max_y_i, 0});
+}
+
+void paint_uniform_textured_rectangle(
+	const PaintTarget& target,
+	const Primitive&   rect,
+	Stats*             stats)
+{
+	const Texture&    texture = *rect.texture;
+	const ImDrawVert& min_v   = *rect.v0;
+	const ImDrawVert& max_v   = *rect.v1;
+
+	int min_x_i, min_y_i, max_x_i, max_y_i;
+	if (!clip_to_target(target, rect, min_x_i, min_y_i, max_x_i, max_y_i)) { return; }
+
 	stats->font_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
 
-	const auto topleft = ImVec2(min_x_i + 0.5f * target.scale.x,
-	                            min_y_i + 0.5f * target.scale.y);
+	const auto uv = uv_mapping(target, min_v, max_v, rect.min_x, rect.min_y);
+	const ImVec2 delta_uv_per_pixel = uv.per_pixel;
+	ImVec2 uv_topleft = uv.topleft;
 
-	const ImVec2 delta_uv_per_pixel = {
-		(max_v.uv.x - min_v.uv.x) / (max_p.x - min_p.x),
-		(max_v.uv.y - min_v.uv.y) / (max_p.y - min_p.y),
-	};
-	const ImVec2 uv_topleft = {
-		min_v.uv.x + (topleft.x - min_v.pos.x) * delta_uv_per_pixel.x,
-		min_v.uv.y + (topleft.y - min_v.pos.y) * delta_uv_per_pixel.y,
-	};
+	// Step to the part inside the tile the same way as when painting the whole rectangle,
+	// so each tile samples exactly the same texels:
+	for (int x = rect.min_x; x < min_x_i; ++x) { uv_topleft.x += delta_uv_per_pixel.x; }
+	for (int y = rect.min_y; y < min_y_i; ++y) { uv_topleft.y += delta_uv_per_pixel.y; }
 	ImVec2 current_uv = uv_topleft;
 
+	const ColorInt color(min_v.col);
+	uint8_t coverage[kTileSize];
+
 	for (int y = min_y_i; y < max_y_i; ++y, current_uv.y += delta_uv_per_pixel.y) {
 		current_uv.x = uv_topleft.x;
 		for (int x = min_x_i; x < max_x_i; ++x, current_uv.x += delta_uv_per_pixel.x) {
-			uint32_t& target_pixel = target.pixels[y * target.width + x];
-			const uint8_t texel = sample_texture(texture, current_uv);
+			coverage[x - min_x_i] = sample_texture(texture, current_uv);
+		}
+		blend_coverage_span(&target.pixels[y * target.width + min_x_i], coverage, max_x_i - min_x_i, color);
+	}
+}
 
-			// The font texture is all black or all white, so optimize for this:
-			if (texel == 0) { continue; }
+void paint_glyph(
+	const PaintTarget& target,
+	const Primitive&   rect,
+	Stats*             stats)
+{
+	const Glyph& glyph = *rect.glyph;
 
-			// Other textured rectangles
-			ColorInt source_color = ColorInt(min_v.col);
-			source_color.a = source_color.a * texel / 255;
-			target_pixel = blend(ColorInt(target_pixel), source_color).toUint32();
+	int min_x_i, min_y_i, max_x_i, max_y_i;
+	if (!clip_to_target(target, rect, min_x_i, min_y_i, max_x_i, max_y_i)) { return; }
+
+	stats->font_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
+
+	const ColorInt color(rect.color);
+	for (int y = min_y_i; y < max_y_i; ++y) {
+		const int row = y - rect.min_y;
+		const int begin = std::max(min_x_i, rect.min_x + glyph.row_begin[row]);
+		const int end = std::min(max_x_i, rect.min_x + glyph.row_end[row]);
+		if (begin < end) {
+			const uint8_t* coverage = &glyph.coverage[row * glyph.width + begin - rect.min_x];
+			blend_coverage_span(&target.pixels[y * target.width + begin], coverage, end - begin, color);
 		}
 	}
 }
@@ -324,14 +740,14 @@ bool is_dominant_edge(ImVec2 edge)
 }
 
 // Handles triangles in any winding order (CW/CCW)
-void paint_triangle(
-	const PaintTarget& target,
-	const Texture*     texture,
-	const ImVec4&      clip_rect,
-	const ImDrawVert&  v0,
-	const ImDrawVert&  v1,
-	const ImDrawVert&  v2,
-	Stats*             stats)
+void add_triangle(
+	const PaintTarget&      target,
+	const Texture*          texture,
+	const ImVec4&           clip_rect,
+	const ImDrawVert&       v0,
+	const ImDrawVert&       v1,
+	const ImDrawVert&       v2,
+	std::vector<Primitive>& primitives)
 {
 	const ImVec2 p0 = ImVec2(target.scale.x * v0.pos.x, target.scale.y * v0.pos.y);
 	const ImVec2 p1 = ImVec2(target.scale.x * v1.pos.x, target.scale.y * v1.pos.y);
@@ -339,7 +755,6 @@ void paint_triangle(
 
 	const auto rect_area = barycentric(p0, p1, p2); // Can be positive or negative depending on winding order
 	if (rect_area == 0.0f) { return; }
-	// if (rect_area < 0.0f) { return paint_triangle(target, texture, clip_rect, v0, v2, v1, stats); }
 
 	// Find bounding box:
 	float min_x_f = min3(p0.x, p1.x, p2.x);
@@ -365,11 +780,93 @@ void paint_triangle(
 	max_x_i = std::min(max_x_i, target.width);
 	max_y_i = std::min(max_y_i, target.height);
 
+	if (min_x_i >= max_x_i || min_y_i >= max_y_i) { return; }
+
+	primitives.push_back(Primitive{Primitive::Kind::Triangle, v0.col, &v0, &v1, &v2, texture, nullptr,
+	                               min_x_i, min_y_i, max_x_i, max_y_i, 0});
+}
+
+void paint_triangle(
+	const PaintTarget& target,
+	const Primitive&   triangle,
+	Stats*             stats)
+{
+	const Texture*    texture = triangle.texture;
+	const ImDrawVert& v0      = *triangle.v0;
+	const ImDrawVert& v1      = *triangle.v1;
+	const ImDrawVert& v2      = *triangle.v2;
+
+	int min_x_i, min_y_i, max_x_i, max_y_i;
+	if (!clip_to_target(target, triangle, min_x_i, min_y_i, max_x_i, max_y_i)) { return; }
+
+	const ImVec2 p0 = ImVec2(target.scale.x * v0.pos.x, target.scale.y * v0.pos.y);
+	const ImVec2 p1 = ImVec2(target.scale.x * v1.pos.x, target.scale.y * v1.pos.y);
+	const ImVec2 p2 = ImVec2(target.scale.x * v2.pos.x, target.scale.y * v2.pos.y);
+
+	const auto rect_area = barycentric(p0, p1, p2); // Can be positive or negative depending on winding order
+
 	// ------------------------------------------------------------------------
-	// Set up interpolation of barycentric coordinates:
+	// For pixel-perfect inside/outside testing:
 
-	const auto topleft = ImVec2(min_x_i + 0.5f * target.scale.x,
-	                            min_y_i + 0.5f * target.scale.y);
+	const int sign = rect_area > 0 ? 1 : -1; // winding order?
+
+	const int bias0i = is_dominant_edge(p2 - p1) ? 0 : -1;
+	const int bias1i = is_dominant_edge(p0 - p2) ? 0 : -1;
+	const int bias2i = is_dominant_edge(p1 - p0) ? 0 : -1;
+
+	const auto p0i = as_point(p0);
+	const auto p1i = as_point(p1);
+	const auto p2i = as_point(p2);
+
+	// The edge functions change by a constant amount per pixel, so step them instead of
+	// evaluating them for every pixel:
+	const auto p_topleft = Point{kFixedBias * min_x_i + kFixedBias / 2, kFixedBias * min_y_i + kFixedBias / 2};
+	Int w0i_row = sign * orient2d(p1i, p2i, p_topleft) + bias0i;
+	Int w1i_row = sign * orient2d(p2i, p0i, p_topleft) + bias1i;
+	Int w2i_row = sign * orient2d(p0i, p1i, p_topleft) + bias2i;
+
+	const Int w0i_dx = -sign * (p2i.y - p1i.y) * kFixedBias;
+	const Int w1i_dx = -sign * (p0i.y - p2i.y) * kFixedBias;
+	const Int w2i_dx = -sign * (p1i.y - p0i.y) * kFixedBias;
+
+	const Int w0i_dy = sign * (p2i.x - p1i.x) * kFixedBias;
+	const Int w1i_dy = sign * (p0i.x - p2i.x) * kFixedBias;
+	const Int w2i_dy = sign * (p1i.x - p0i.x) * kFixedBias;
+
+	// ------------------------------------------------------------------------
+
+	const bool has_uniform_color = (v0.col == v1.col && v0.col == v2.col);
+
+	if (has_uniform_color && !texture) {
+		// Each row of the triangle is a single span:
+		const ColorInt color(v0.col);
+		for (int y = min_y_i; y < max_y_i; ++y, w0i_row += w0i_dy, w1i_row += w1i_dy, w2i_row += w2i_dy) {
+			Int w0i = w0i_row;
+			Int w1i = w1i_row;
+			Int w2i = w2i_row;
+			int x = min_x_i;
+			for (; x < max_x_i && (w0i < 0 || w1i < 0 || w2i < 0); ++x) {
+				w0i += w0i_dx;
+				w1i += w1i_dx;
+				w2i += w2i_dx;
+			}
+			const int span_start = x;
+			for (; x < max_x_i && w0i >= 0 && w1i >= 0 && w2i >= 0; ++x) {
+				w0i += w0i_dx;
+				w1i += w1i_dx;
+				w2i += w2i_dx;
+			}
+			stats->uniform_triangle_pixels += x - span_start;
+			blend_span(&target.pixels[y * target.width + span_start], x - span_start, color);
+		}
+		return;
+	}
+
+	// ------------------------------------------------------------------------
+	// Set up interpolation of barycentric coordinates, from the top left of the whole triangle:
+
+	const auto topleft = ImVec2(triangle.min_x + 0.5f * target.scale.x,
+	                            triangle.min_y + 0.5f * target.scale.y);
 	const auto dx = ImVec2(1, 0);
 	const auto dy = ImVec2(0, 1);
 
@@ -396,72 +893,43 @@ void paint_triangle(
 
 	Barycentric bary_current_row = bary_topleft;
 
-	// ------------------------------------------------------------------------
-	// For pixel-perfect inside/outside testing:
-
-	const int sign = rect_area > 0 ? 1 : -1; // winding order?
-
-	const int bias0i = is_dominant_edge(p2 - p1) ? 0 : -1;
-	const int bias1i = is_dominant_edge(p0 - p2) ? 0 : -1;
-	const int bias2i = is_dominant_edge(p1 - p0) ? 0 : -1;
-
-	const auto p0i = as_point(p0);
-	const auto p1i = as_point(p1);
-	const auto p2i = as_point(p2);
+	// Step to the part inside the tile the same way as when painting the whole triangle,
+	// so each tile interpolates exactly the same colors and texture coordinates:
+	for (int y = triangle.min_y; y < min_y_i; ++y) { bary_current_row += bary_dy; }
 
 	// ------------------------------------------------------------------------
 
-	const bool has_uniform_color = (v0.col == v1.col && v0.col == v2.col);
-
 	const ImVec4 c0 = color_convert_u32_to_float4(v0.col);
 	const ImVec4 c1 = color_convert_u32_to_float4(v1.col);
 	const ImVec4 c2 = color_convert_u32_to_float4(v2.col);
 
-	// We often blend the same colors over and over again, so optimize for this (saves 10% total cpu):
-	uint32_t last_target_pixel = 0;
-	uint32_t last_output = blend(ColorInt(last_target_pixel), ColorInt(v0.col)).toUint32();
-
-	for (int y = min_y_i; y < max_y_i; ++y) {
+	for (int y = min_y_i; y < max_y_i; ++y, w0i_row += w0i_dy, w1i_row += w1i_dy, w2i_row += w2i_dy) {
 		auto bary = bary_current_row;
+		for (int x = triangle.min_x; x < min_x_i; ++x) { bary += bary_dx; }
+		Int w0i = w0i_row;
+		Int w1i = w1i_row;
+		Int w2i = w2i_row;
 
 		bool has_been_inside_this_row = false;
 
-		for (int x = min_x_i; x < max_x_i; ++x) {
+		for (int x = min_x_i; x < max_x_i; ++x, w0i += w0i_dx, w1i += w1i_dx, w2i += w2i_dx) {
 			const auto w0 = bary.w0;
 			const auto w1 = bary.w1;
 			const auto w2 = bary.w2;
 			bary += bary_dx;
 
-			{
-				// Inside/outside test:
-				const auto p = Point{kFixedBias * x + kFixedBias / 2, kFixedBias * y + kFixedBias / 2};
-				const auto w0i = sign * orient2d(p1i, p2i, p) + bias0i;
-				const auto w1i = sign * orient2d(p2i, p0i, p) + bias1i;
-				const auto w2i = sign * orient2d(p0i, p1i, p) + bias2i;
-				if (w0i < 0 || w1i < 0 || w2i < 0) {
-					if (has_been_inside_this_row) {
-						break; // Gives a nice 10% speedup
-					} else {
-						continue;
-					}
+			// Inside/outside test:
+			if (w0i < 0 || w1i < 0 || w2i < 0) {
+				if (has_been_inside_this_row) {
+					break; // Gives a nice 10% speedup
+				} else {
+					continue;
 				}
 			}
 			has_been_inside_this_row = true;
 
 			uint32_t& target_pixel = target.pixels[y * target.width + x];
 
-			if (has_uniform_color && !texture) {
-				stats->uniform_triangle_pixels += 1;
-				if (target_pixel == last_target_pixel) {
-					target_pixel = last_output;
-					continue;
-				}
-				last_target_pixel = target_pixel;
-				target_pixel = blend(ColorInt(target_pixel), ColorInt(v0.col)).toUint32();
-				last_output = target_pixel;
-				continue;
-			}
-
 			ImVec4 src_color;
 
 			if (has_uniform_color) {
@@ -493,13 +961,34 @@ void paint_triangle(
 	}
 }
 
-void paint_draw_cmd(
-	const PaintTarget& target,
-	const ImDrawVert*  vertices,
-	const ImDrawIdx*   idx_buffer,
-	const ImDrawCmd&   pcmd,
-	const SwOptions&   options,
-	Stats*             stats)
+void paint_primitive(const PaintTarget& target, const Primitive& primitive, Stats* stats)
+{
+	switch (primitive.kind) {
+		case Primitive::Kind::UniformRectangle:
+			paint_uniform_rectangle(target, primitive, stats);
+			break;
+		case Primitive::Kind::UniformTexturedRectangle:
+			if (primitive.glyph) {
+				paint_glyph(target, primitive, stats);
+			} else {
+				paint_uniform_textured_rectangle(target, primitive, stats);
+			}
+			break;
+		case Primitive::Kind::Triangle:
+			paint_triangle(target, primitive, stats);
+			break;
+	}
+}
+
+void decode_draw_cmd(
+	const PaintTarget&      target,
+	const ImDrawVert*       vertices,
+	const ImDrawIdx*        idx_buffer,
+	const ImDrawCmd&        pcmd,
+	const SwOptions&        options,
+	GlyphCache*             glyphs,
+	std::vector<Primitive>& primitives,
+	Stats*                  stats)
 {
 	const auto texture = reinterpret_cast<const Texture*>(pcmd.GetTexID());
     const auto offset = pcmd.IdxOffset;
@@ -541,7 +1030,7 @@ void paint_draw_cmd(
 
 				if (has_uniform_color && has_texture)
 				{
-					paint_uniform_textured_rectangle(target, *texture, pcmd.ClipRect, v0, v2, stats);
+					add_uniform_textured_rectangle(target, *texture, pcmd.ClipRect, v0, v2, glyphs, primitives);
 					i += 6;
 					continue;
 				}
@@ -605,7 +1094,7 @@ void paint_draw_cmd(
 					if (has_texture) {
 						stats->textured_rectangle_pixels += num_pixels;
 					} else {
-						paint_uniform_rectangle(target, min, max, ColorInt(v0.col), stats);
+						add_uniform_rectangle(target, min, max, v0.col, primitives);
 						i += 6;
 						continue;
 					}
@@ -622,24 +1111,129 @@ void paint_draw_cmd(
 		}
 
 		const bool has_texture = (v0.uv != white_uv || v1.uv != white_uv || v2.uv != white_uv);
-		paint_triangle(target, has_texture ? texture : nullptr, pcmd.ClipRect, v0, v1, v2, stats);
+		add_triangle(target, has_texture ? texture : nullptr, pcmd.ClipRect, v0, v1, v2, primitives);
 		i += 3;
 	}
 }
 
-void paint_draw_list(const PaintTarget& target, const ImDrawList* cmd_list, const SwOptions& options, Stats* stats)
+// ----------------------------------------------------------------------------
+// Tiles
+
+struct Tile
 {
-	const ImDrawIdx* idx_buffer = &cmd_list->IdxBuffer[0];
-	const ImDrawVert* vertices = cmd_list->VtxBuffer.Data;
+	std::vector<uint32_t> primitives; // Indices, in painting order.
+	uint64_t              hash = 0;   // Of the primitives last painted into the buffer.
+};
 
-	for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.size(); cmd_i++)
-	{
-		const ImDrawCmd& pcmd = cmd_list->CmdBuffer[cmd_i];
-		if (pcmd.UserCallback) {
-			pcmd.UserCallback(cmd_list, &pcmd);
-		} else {
-			paint_draw_cmd(target, vertices, idx_buffer, pcmd, options, stats);
+struct Renderer
+{
+	// The buffer painted by the previous incremental call, tile hashes are only valid for it:
+	uint32_t*              pixels = nullptr;
+	int                    width = 0;
+	int                    height = 0;
+	bool                   valid = false;
+
+	int                    tiles_x = 0;
+	int                    tiles_y = 0;
+	std::vector<Tile>      tiles;
+	std::vector<uint32_t>  dirty;
+	std::vector<Primitive> primitives;
+	GlyphCache             glyphs;
+};
+
+Renderer s_renderer;
+
+uint64_t hash_vertex(uint64_t hash, const ImDrawVert* vertex)
+{
+	if (!vertex) { return hash; }
+	hash = hash_float2(hash, vertex->pos.x, vertex->pos.y);
+	hash = hash_float2(hash, vertex->uv.x, vertex->uv.y);
+	return hash_mix(hash, vertex->col);
+}
+
+// Everything that decides which pixels a primitive paints, and how.
+uint64_t hash_primitive(const Primitive& primitive)
+{
+	uint64_t hash = hash_mix(static_cast<uint64_t>(primitive.kind), primitive.color);
+	hash = hash_mix(hash, reinterpret_cast<uintptr_t>(primitive.texture));
+	hash = hash_mix(hash, (static_cast<uint64_t>(primitive.min_x) << 32) | static_cast<uint32_t>(primitive.min_y));
+	hash = hash_mix(hash, (static_cast<uint64_t>(primitive.max_x) << 32) | static_cast<uint32_t>(primitive.max_y));
+	hash = hash_vertex(hash, primitive.v0);
+	hash = hash_vertex(hash, primitive.v1);
+	return hash_vertex(hash, primitive.v2);
+}
+
+void add_stats(Stats& stats, const Stats& other)
+{
+	stats.uniform_triangle_pixels            += other.uniform_triangle_pixels;
+	stats.textured_triangle_pixels           += other.textured_triangle_pixels;
+	stats.gradient_triangle_pixels           += other.gradient_triangle_pixels;
+	stats.font_pixels                        += other.font_pixels;
+	stats.uniform_rectangle_pixels           += other.uniform_rectangle_pixels;
+	stats.textured_rectangle_pixels          += other.textured_rectangle_pixels;
+	stats.gradient_rectangle_pixels          += other.gradient_rectangle_pixels;
+	stats.gradient_textured_rectangle_pixels += other.gradient_textured_rectangle_pixels;
+}
+
+void paint_tile(const Renderer& renderer, const PaintTarget& screen, uint32_t tile_index, bool clear, Stats* stats)
+{
+	PaintTarget target = screen;
+	target.min_x = static_cast<int>(tile_index % renderer.tiles_x) * kTileSize;
+	target.min_y = static_cast<int>(tile_index / renderer.tiles_x) * kTileSize;
+	target.max_x = std::min(target.min_x + kTileSize, screen.width);
+	target.max_y = std::min(target.min_y + kTileSize, screen.height);
+
+	if (clear) {
+		for (int y = target.min_y; y < target.max_y; ++y) {
+			memset(&target.pixels[y * target.width + target.min_x], 0, (target.max_x - target.min_x) * sizeof(uint32_t));
+		}
+	}
+
+	for (const auto index : renderer.tiles[tile_index].primitives) {
+		paint_primitive(target, renderer.primitives[index], stats);
+	}
+}
+
+// Tiles are painted by the calling thread plus up to this many helper threads.
+constexpr size_t kMaxHelpers = 3;
+
+// Frames with fewer dirty tiles per thread than this are not worth waking up helpers for.
+constexpr size_t kMinTilesPerThread = 4;
+
+size_t helper_count()
+{
+	static const size_t count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u) - 1, kMaxHelpers);
+	return count;
+}
+
+ThreadPool& helper_pool()
+{
+	static auto* instance = new ThreadPool(helper_count());
+	return *instance;
+}
+
+void paint_tiles(const Renderer& renderer, const PaintTarget& screen, bool clear, Stats* stats)
+{
+	const auto& dirty = renderer.dirty;
+	const size_t helpers = std::min(helper_count(), dirty.size() / kMinTilesPerThread);
+
+	// Tiles are handed out one at a time, which balances text heavy tiles against empty ones:
+	std::atomic<size_t> next_tile = 0;
+	const auto work = [&](Stats* worker_stats) {
+		for (size_t i = next_tile++; i < dirty.size(); i = next_tile++) {
+			paint_tile(renderer, screen, dirty[i], clear, worker_stats);
 		}
+	};
+
+	Stats helper_stats[kMaxHelpers];
+	std::future<void> helper_futures[kMaxHelpers];
+	for (size_t i = 0; i < helpers; ++i) {
+		helper_futures[i] = helper_pool().add(work, &helper_stats[i]);
+	}
+	work(stats);
+	for (size_t i = 0; i < helpers; ++i) {
+		helper_futures[i].get();
+		add_stats(*stats, helper_stats[i]);
 	}
 }
 
@@ -663,14 +1257,15 @@ void restore_style()
 	style.WindowRounding = default_style.WindowRounding;
 }
 
+static bool s_bound = false;
+
 void bind_imgui_painting()
 {
-    // make sure it doesn't get called twice
-    static bool done = false;
-    if (done) {
+    // make sure it doesn't get called twice, until unbind_imgui_painting() for the next context
+    if (s_bound) {
         return;
     }
-    done = true;
+    s_bound = true;
 
 	// Load default font (embedded in code):
     ImGuiIO& io = ImGui::GetIO();
@@ -688,13 +1283,89 @@ void paint_imgui(uint32_t* pixels, int width_pixels, int height_pixels, const Sw
 	const float width_points = ImGui::GetIO().DisplaySize.x;
 	const float height_points = ImGui::GetIO().DisplaySize.y;
 	const ImVec2 scale{width_pixels / width_points, height_pixels / height_points};
-	PaintTarget target{pixels, width_pixels, height_pixels, scale};
+	PaintTarget target{pixels, width_pixels, height_pixels, scale, 0, 0, width_pixels, height_pixels};
 	const ImDrawData* draw_data = ImGui::GetDrawData();
+	auto& renderer = s_renderer;
 
 	s_stats = Stats{};
+
+	// Decode everything up front, user callbacks run here in submission order:
+	renderer.primitives.clear();
+	if (renderer.glyphs.size() > kMaxGlyphs) {
+		renderer.glyphs.clear();
+	}
 	for (int i = 0; i < draw_data->CmdListsCount; ++i) {
-		paint_draw_list(target, draw_data->CmdLists[i], options, &s_stats);
+		const ImDrawList* cmd_list = draw_data->CmdLists[i];
+		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.size(); cmd_i++) {
+			const ImDrawCmd& pcmd = cmd_list->CmdBuffer[cmd_i];
+			if (pcmd.UserCallback) {
+				pcmd.UserCallback(cmd_list, &pcmd);
+			} else {
+				decode_draw_cmd(target, cmd_list->VtxBuffer.Data, cmd_list->IdxBuffer.Data, pcmd, options,
+				                options.cache_glyphs ? &renderer.glyphs : nullptr, renderer.primitives, &s_stats);
+			}
+		}
+	}
+
+	// Bin the primitives into the tiles they touch:
+	renderer.tiles_x = (width_pixels + kTileSize - 1) / kTileSize;
+	renderer.tiles_y = (height_pixels + kTileSize - 1) / kTileSize;
+	const size_t tile_count = static_cast<size_t>(renderer.tiles_x) * renderer.tiles_y;
+	renderer.tiles.resize(tile_count);
+	for (auto& tile : renderer.tiles) {
+		tile.primitives.clear();
+	}
+	for (size_t i = 0; i < renderer.primitives.size(); ++i) {
+		const auto& primitive = renderer.primitives[i];
+		const int tile_max_x = (primitive.max_x - 1) / kTileSize;
+		const int tile_max_y = (primitive.max_y - 1) / kTileSize;
+		for (int tile_y = primitive.min_y / kTileSize; tile_y <= tile_max_y; ++tile_y) {
+			for (int tile_x = primitive.min_x / kTileSize; tile_x <= tile_max_x; ++tile_x) {
+				renderer.tiles[tile_y * renderer.tiles_x + tile_x].primitives.push_back(static_cast<uint32_t>(i));
+			}
+		}
 	}
+
+	// Decide what needs painting. Incremental calls skip the tiles which would be painted
+	// exactly like last time, everything else is painted over what the caller left:
+	renderer.dirty.clear();
+	if (options.incremental) {
+		const bool same_buffer = renderer.valid &&
+			renderer.pixels == pixels &&
+			renderer.width == width_pixels &&
+			renderer.height == height_pixels;
+
+		for (auto& primitive : renderer.primitives) {
+			primitive.hash = hash_primitive(primitive);
+		}
+		const uint64_t seed = hash_float2(0, scale.x, scale.y);
+		for (size_t i = 0; i < tile_count; ++i) {
+			auto& tile = renderer.tiles[i];
+			uint64_t hash = seed;
+			for (const auto index : tile.primitives) {
+				hash = hash_mix(hash, renderer.primitives[index].hash);
+			}
+			if (!same_buffer || hash != tile.hash) {
+				renderer.dirty.push_back(static_cast<uint32_t>(i));
+			}
+			tile.hash = hash;
+		}
+	} else {
+		for (size_t i = 0; i < tile_count; ++i) {
+			if (!renderer.tiles[i].primitives.empty()) {
+				renderer.dirty.push_back(static_cast<uint32_t>(i));
+			}
+		}
+	}
+	renderer.pixels = pixels;
+	renderer.width = width_pixels;
+	renderer.height = height_pixels;
+	renderer.valid = options.incremental;
+
+	paint_tiles(renderer, target, options.incremental, &s_stats);
+
+	s_stats.tiles_painted = static_cast<int>(renderer.dirty.size());
+	s_stats.tiles_total = static_cast<int>(tile_count);
 }
 
 void unbind_imgui_painting()
@@ -702,6 +1373,8 @@ void unbind_imgui_painting()
 	ImGuiIO& io = ImGui::GetIO();
 	delete reinterpret_cast<Texture*>(io.Fonts->TexID.GetTexID());
 	io.Fonts = nullptr;
+	s_renderer = Renderer{};
+	s_bound = false;
 }
 
 bool show_options(SwOptions* io_options)
@@ -709,6 +1382,7 @@ bool show_options(SwOptions* io_options)
 	bool changed = false;
 	changed |= ImGui::Checkbox("optimize_text", &io_options->optimize_text);
 	changed |= ImGui::Checkbox("optimize_rectangles", &io_options->optimize_rectangles);
+	changed |= ImGui::Checkbox("cache_glyphs", &io_options->cache_glyphs);
 	return changed;
 }
 
@@ -722,6 +1396,7 @@ void show_stats()
 	ImGui::Text("textured_rectangle_pixels:          %7.0f", s_stats.textured_rectangle_pixels);
 	ImGui::Text("gradient_rectangle_pixels:          %7.0f", s_stats.gradient_rectangle_pixels);
 	ImGui::Text("gradient_textured_rectangle_pixels: %7.0f", s_stats.gradient_textured_rectangle_pixels);
+	ImGui::Text("tiles_painted:                      %3d/%3d", s_stats.tiles_painted, s_stats.tiles_total);
 }
 
 Stats get_stats() {
@@ -21,6 +21,12 @@ struct SwOptions
 {
 	bool optimize_text = true;  // No reason to turn this off.
 	bool optimize_rectangles = true; // No reason to turn this off.
+	bool cache_glyphs = true; // Blit text from sampled coverage, no reason to turn this off.
+
+	// The renderer owns the contents of the buffer between calls: only the screen tiles whose
+	// draw commands changed since the previous call on the same buffer are cleared and painted
+	// again. When off, everything is painted on top of what the caller left in the buffer.
+	bool incremental = false;
 };
 
 
@@ -34,6 +40,8 @@ struct Stats
     double textured_rectangle_pixels          = 0;
     double gradient_rectangle_pixels          = 0;
     double gradient_textured_rectangle_pixels = 0;
+    int    tiles_painted                      = 0;
+    int    tiles_total                        = 0;
 };
 
 /// Optional: tweak ImGui style to make it render faster.
@@ -42,13 +50,15 @@ void make_style_fast();
 /// Undo what make_style_fast did.
 void restore_style();
 
-/// Call once a the start of your program.
+/// Call once a the start of your program, and again after unbind_imgui_painting for a new context.
 void bind_imgui_painting();
 
 /// The buffer is assumed to follow how ImGui packs pixels, i.e. ABGR by default.
 /// Change with IMGUI_USE_BGRA_PACKED_COLOR.
 /// If width/height differs from ImGui::GetIO().DisplaySize then
 /// the function scales the UI to fit the given pixel buffer.
+/// The screen is split into tiles which are painted in parallel, user callbacks of draw
+/// commands are invoked on the calling thread before any painting starts.
 void paint_imgui(uint32_t* pixels, int width_pixels, int height_pixels, const SwOptions& options = {});
 
 /// Free the resources allocated by bind_imgui_painting.
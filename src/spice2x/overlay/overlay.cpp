@@ -765,13 +765,11 @@ void overlay::SpiceOverlay::render() {
                 this->pixel_data.resize(pixels, 0);
             }
 
-            // reset buffer
-            memset(&this->pixel_data[0], 0, width * height * sizeof(uint32_t));
-
-            // render to pixel data
+            // render to pixel data, only the tiles that changed are cleared and painted again
             imgui_sw::SwOptions options {
                 .optimize_text = true,
                 .optimize_rectangles = true,
+                .incremental = true,
             };
             imgui_sw::paint_imgui(&this->pixel_data[0], width, height, options);
             pixel_data_width = width;
@@ -314,9 +314,9 @@ namespace overlay::windows {
                 if (!definition.game_name.empty() && definition.game_name != this->games_selected_name) {
                     continue;
                 }
-                visible_categories.insert(definition.category);
+                visible_categories.emplace(definition.category);
                 if (!definition.quick_setting_category.empty()) {
-                    quick_categories.insert(definition.quick_setting_category);
+                    quick_categories.emplace(definition.quick_setting_category);
                 }
             }
         }
@@ -4904,7 +4904,7 @@ namespace overlay::windows {
 
                         std::wstring extensions;
                         if (!definition.file_extension.empty()) {
-                            const std::wstring ext = s2ws(definition.file_extension);
+                            const std::wstring ext = s2ws(std::string(definition.file_extension));
                             // filter to file extension preferred by the option (e.g., DLL)
                             extensions = ext + L" Files (*." + ext + L")";
                             extensions.push_back(L'\0');
@@ -5132,20 +5132,20 @@ namespace overlay::windows {
                 if (option.is_active()) {
                     // active option
                     if (option.disabled || definition.disabled) {
-                        ImGui::TextColored(ImVec4(1.f, 0.4f, 0.f, 1.f), "%s", definition.title.c_str());
+                        ImGui::TextColored(ImVec4(1.f, 0.4f, 0.f, 1.f), "%s", definition.title.data());
                     } else {
-                        ImGui::TextColored(TEXT_COLOR_GREEN, "%s", definition.title.c_str());
+                        ImGui::TextColored(TEXT_COLOR_GREEN, "%s", definition.title.data());
                     }
                 } else if (definition.hidden ||
                         (!definition.game_name.empty() && definition.game_name != this->games_selected_name)) {
                     // wrong game - grayed out
-                    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.f), "%s", definition.title.c_str());
+                    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.f), "%s", definition.title.data());
                 } else {
                     // normal text
-                    ImGui::TextUnformatted(definition.title.c_str());
+                    ImGui::TextUnformatted(definition.title.data());
                 }
                 if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                    ImGui::HelpTooltip(definition.desc.c_str());
+                    ImGui::HelpTooltip(definition.desc.data());
                 }
 
                 // command line parameter
@@ -5202,7 +5202,7 @@ namespace overlay::windows {
                             ::Config::getInstance().updateBinding(games_list[games_selected], option);
                         }
                         if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                            ImGui::HelpTooltip(definition.desc.c_str());
+                            ImGui::HelpTooltip(definition.desc.data());
                         }
                         break;
                     }
@@ -5218,7 +5218,7 @@ namespace overlay::windows {
                         };
 
                         const char *hint = definition.setting_name.empty() ? "Enter number..."
-                                : definition.setting_name.c_str();
+                                : definition.setting_name.data();
 
                         ImGui::InputTextWithHint(
                             "", hint,
@@ -5231,7 +5231,7 @@ namespace overlay::windows {
                             ::Config::getInstance().updateBinding(games_list[games_selected], option);
                         }
                         if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                            ImGui::HelpTooltip(definition.desc.c_str());
+                            ImGui::HelpTooltip(definition.desc.data());
                         }
                         break;
                     }
@@ -5255,7 +5255,7 @@ namespace overlay::windows {
                             return 1; // discard
                         };
                         const char *hint = definition.setting_name.empty() ? "Enter hex..."
-                                : definition.setting_name.c_str();
+                                : definition.setting_name.data();
 
                         ImGui::InputTextWithHint("", hint,
                             buffer, sizeof(buffer) - 1,
@@ -5267,7 +5267,7 @@ namespace overlay::windows {
                             ::Config::getInstance().updateBinding(games_list[games_selected], option);
                         }
                         if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                            ImGui::HelpTooltip(definition.desc.c_str());
+                            ImGui::HelpTooltip(definition.desc.data());
                         }
                         break;
                     }
@@ -5277,7 +5277,7 @@ namespace overlay::windows {
                         buffer[sizeof(buffer) - 1] = '\0';
 
                         const char *hint = definition.setting_name.empty() ? "Enter value..."
-                                : definition.setting_name.c_str();
+                                : definition.setting_name.data();
 
                         ImGui::InputTextWithHint("", hint, buffer, sizeof(buffer) - 1);
                         // would like to use IsItemDeactivatedAfterEdit but can't handle the case when window is closed while editing
@@ -5287,7 +5287,7 @@ namespace overlay::windows {
                             ::Config::getInstance().updateBinding(games_list[games_selected], option);
                         }
                         if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                            ImGui::HelpTooltip(definition.desc.c_str());
+                            ImGui::HelpTooltip(definition.desc.data());
                         }
                         break;
                     }
@@ -5306,7 +5306,7 @@ namespace overlay::windows {
                         }
                         if (ImGui::BeginCombo("##combo", current_item.c_str(), 0)) {
                             for (auto &element : definition.elements) {
-                                std::string label = element.first;
+                                std::string label(element.first);
                                 if (!element.second.empty()) {
                                     label += fmt::format(" ({})", element.second);
                                 }
@@ -5324,7 +5324,7 @@ namespace overlay::windows {
                             ImGui::EndCombo();
                         }
                         if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                            ImGui::HelpTooltip(definition.desc.c_str());
+                            ImGui::HelpTooltip(definition.desc.data());
                         }
                         break;
                     }
@@ -5351,7 +5351,7 @@ namespace overlay::windows {
                         ImGui::OpenPopup(option_popup_id.c_str());
                     }
                     if (ImGui::IsItemHovered(ImGui::TOOLTIP_FLAGS)) {
-                        ImGui::HelpTooltip(definition.desc.c_str());
+                        ImGui::HelpTooltip(definition.desc.data());
                     }
                 }
 
@@ -5379,7 +5379,7 @@ namespace overlay::windows {
                             nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
                         // for min width enforcement
                         ImGui::Dummy(ImVec2(320.f, 0.f));
-                        ImGui::TextColored(ImVec4(1, 0.7f, 0, 1), "%s", definition.title.c_str());
+                        ImGui::TextColored(ImVec4(1, 0.7f, 0, 1), "%s", definition.title.data());
 
                         ImGui::TextUnformatted("");
 
@@ -18,6 +18,7 @@
 #include "games/io.h"
 #include "games/iidx/io.h"
 #include "games/shared/lcdhandle.h"
+#include "hooks/audio/telemetry.h"
 #include "hooks/graphics/graphics.h"
 #include "launcher/launcher.h"
 #include "launcher/shutdown.h"
@@ -59,6 +60,7 @@ namespace overlay::windows {
         avs_info_view();
         acio_view();
         cpu_view();
+        audio_view();
         graphics_view();
         buttons_view();
         analogs_view();
@@ -298,6 +300,53 @@ namespace overlay::windows {
         }
     }
 
+    void Control::audio_view() {
+        namespace telemetry = hooks::audio::telemetry;
+        if (ImGui::CollapsingHeader("Audio")) {
+            bool any_active = false;
+            for (size_t index = 0; index < telemetry::STREAM_COUNT; index++) {
+                const auto stream = static_cast<telemetry::Stream>(index);
+                const auto snap = telemetry::snapshot(stream);
+                if (!snap.active) {
+                    continue;
+                }
+                any_active = true;
+
+                ImGui::PushID((int) index);
+                if (ImGui::TreeNodeEx(telemetry::stream_name(stream), ImGuiTreeNodeFlags_DefaultOpen)) {
+                    ImGui::BulletText("Expected period: %.2f ms", snap.period_us / 1000.f);
+                    ImGui::BulletText("Callbacks: %llu", (unsigned long long) snap.callbacks);
+                    ImGui::BulletText("Period p50/p99/max: %.2f / %.2f / %.2f ms",
+                            snap.period_p50_us / 1000.f,
+                            snap.period_p99_us / 1000.f,
+                            snap.period_max_us / 1000.f);
+                    ImGui::BulletText("Processing p50/p99/max: %u / %u / %u us",
+                            snap.processing_p50_us,
+                            snap.processing_p99_us,
+                            snap.processing_max_us);
+                    ImGui::BulletText("Missed deadlines: %llu", (unsigned long long) snap.missed_deadlines);
+                    ImGui::BulletText("Underruns: %llu", (unsigned long long) snap.underruns);
+
+                    // buffer fill histogram, only for streams that report padding
+                    if (snap.fill_samples > 0) {
+                        float fill[telemetry::FILL_BUCKETS];
+                        for (size_t bucket = 0; bucket < telemetry::FILL_BUCKETS; bucket++) {
+                            fill[bucket] = (float) snap.fill[bucket] / snap.fill_samples;
+                        }
+                        ImGui::BulletText("Buffer fill (0%% - 100%%):");
+                        ImGui::PlotHistogram("##fill", fill, (int) telemetry::FILL_BUCKETS,
+                                0, nullptr, 0.f, 1.f, ImVec2(200, 40));
+                    }
+                    ImGui::TreePop();
+                }
+                ImGui::PopID();
+            }
+            if (!any_active) {
+                ImGui::TextUnformatted("No audio stream is being monitored.");
+            }
+        }
+    }
+
     void Control::graphics_view() {
         if (ImGui::CollapsingHeader("Graphics")) {
 
@@ -35,6 +35,7 @@ namespace overlay::windows {
         void avs_info_view();
         void acio_view();
         void cpu_view();
+        void audio_view();
         void graphics_view();
         void buttons_view();
         void analogs_view();
@@ -1,7 +1,6 @@
 #include "eadev.h"
 
 #include "avs/automap.h"
-#include "util/fileutils.h"
 #include "overlay/imgui/extensions.h"
 
 
@@ -18,16 +17,8 @@ namespace overlay::windows {
                 ImGui::GetIO().DisplaySize.y / 2 - this->init_size.y / 2);
         this->active = true;
 
-        // read existing automap contents from file
-        if (avs::automap::DUMP_FILENAME.length() > 0) {
-            auto contents = fileutils::text_read(avs::automap::DUMP_FILENAME);
-            if (contents.length() > 0) {
-                this->automap_hook(this, contents.c_str());
-            }
-        }
-
-        // add hook for receiving automap messages
-        avs::automap::hook_add(automap_hook, this);
+        // add hook for receiving automap messages, starting with what is already dumped
+        avs::automap::hook_add(automap_hook, this, true);
     }
 
     EADevWindow::~EADevWindow() {
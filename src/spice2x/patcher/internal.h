@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <utility>
 
 #include "patch_manager.h"
@@ -23,10 +24,11 @@ namespace patcher {
 
     // internal helpers
     void append_patches(
-        std::string& patches_json,
+        rapidjson::Document& doc,
         bool apply_patches = false,
         std::function<bool(const PatchData&)> filter = std::function<bool(const PatchData&)>(),
         std::string pe_identifier_for_patch = "");
+    std::unique_ptr<rapidjson::Document> read_patch_file(const std::filesystem::path& path);
     bool is_game_id_wildcard_matched(const std::string& id_from_config);
     std::string getFromUrl(const std::string& dll_name, const std::string& url);
     bool load_from_patches_json(bool apply_patches);
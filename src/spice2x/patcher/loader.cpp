@@ -1,9 +1,11 @@
 #include "internal.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <windows.h>
 #include <winhttp.h>
@@ -22,6 +24,7 @@
 #include "util/netutils.h"
 #include "util/resutils.h"
 #include "util/sigscan.h"
+#include "util/threadpool.h"
 #include "util/utils.h"
 
 using namespace rapidjson;
@@ -609,6 +612,91 @@ namespace patcher {
         return false;
     }
 
+    // patch files parsed ahead of time by prefetch_local_patches(), handed out once
+    struct PrefetchedPatchFile {
+        std::filesystem::file_time_type write_time;
+        std::unique_ptr<Document> doc;
+    };
+    static std::mutex prefetched_mutex;
+    static std::map<std::filesystem::path, PrefetchedPatchFile> prefetched_patch_files;
+
+    static std::unique_ptr<Document> parse_patch_file(const std::filesystem::path &path) {
+        auto doc = std::make_unique<Document>();
+        const std::string content = fileutils::text_read(path);
+        doc->Parse(content.c_str());
+        return doc;
+    }
+
+    std::unique_ptr<Document> read_patch_file(const std::filesystem::path &path) {
+        std::unique_lock<std::mutex> lock(prefetched_mutex);
+        auto it = prefetched_patch_files.find(path);
+        if (it != prefetched_patch_files.end()) {
+            auto entry = std::move(it->second);
+            prefetched_patch_files.erase(it);
+            lock.unlock();
+
+            // only use it if the file hasn't been touched since
+            std::error_code ec;
+            if (std::filesystem::last_write_time(path, ec) == entry.write_time && !ec) {
+                return std::move(entry.doc);
+            }
+        } else {
+            lock.unlock();
+        }
+        return parse_patch_file(path);
+    }
+
+    static void prefetch_patch_file(const std::filesystem::path &path) {
+        std::error_code ec;
+        const auto write_time = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return;
+        }
+        auto doc = parse_patch_file(path);
+        std::lock_guard<std::mutex> lock(prefetched_mutex);
+        prefetched_patch_files[path] = PrefetchedPatchFile {
+            .write_time = write_time,
+            .doc = std::move(doc),
+        };
+    }
+
+    void prefetch_local_patches() {
+
+        // same file selection as reload_local_patches(), minus the logging. identifying a DLL
+        // and parsing its patch file is independent of the others, so they are spread out
+        const std::string first_dll = avs::game::DLL_NAME;
+        std::vector<std::string> dlls { first_dll };
+        for (const std::string &dll : getExtraDlls(first_dll)) {
+            dlls.push_back(dll);
+        }
+        std::atomic<bool> found = false;
+        ThreadPool::shared().parallel_for(0, dlls.size(), 1, [&dlls, &found](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const auto identifier = get_game_identifier(MODULE_PATH / dlls[i]);
+                const auto path = std::filesystem::path(fmt::format("patches/{}.json", identifier));
+                if ((i == 0 || !identifier.empty()) && fileutils::file_exists(path)) {
+                    prefetch_patch_file(path);
+                    found = true;
+                }
+            }
+        });
+        if (found) {
+            return;
+        }
+
+        // shared patches.json, the first location that exists is usually the one used
+        for (const std::filesystem::path &path : {
+                std::filesystem::path("patches/patches.json"),
+                std::filesystem::path("patches.json"),
+                MODULE_PATH / "patches.json",
+                std::filesystem::path("..") / "patches.json" }) {
+            if (fileutils::file_exists(path)) {
+                prefetch_patch_file(path);
+                break;
+            }
+        }
+    }
+
     bool load_from_patches_json(bool apply_patches) {
         bool ret = false;
 
@@ -653,8 +741,8 @@ namespace patcher {
             }
 
             log_misc("patchmanager", "reading from patches.json: {}", patches_json_path);
-            std::string content = fileutils::text_read(patches_json_path);
-            append_patches(content, apply_patches, filter);
+            auto doc = read_patch_file(patches_json_path);
+            append_patches(*doc, apply_patches, filter);
 
             const auto new_patches = patches.size() - patches_size_previous;
             log_info("patchmanager", "loaded {} patches from: {}", new_patches, patches_json_path);
@@ -700,16 +788,16 @@ namespace patcher {
         if (fileutils::file_exists(firstPath) || !extraDlls.empty()) {
             if (fileutils::file_exists(firstPath)) {
                 log_info("patchmanager", "loaded patches for {} from {}", firstDll, firstPath);
-                std::string content = fileutils::text_read(firstPath);
-                append_patches(content, apply_patches, nullptr, first_id);
+                auto doc = read_patch_file(firstPath);
+                append_patches(*doc, apply_patches, nullptr, first_id);
                 ACTIVE_JSON_FILE = displayPath(firstPath);
             }
             for (const std::string& dll : extraDlls) {
                 auto extraId = get_game_identifier(MODULE_PATH / dll);
                 auto extraPath = std::filesystem::path(fmt::format("patches/{}.json", extraId));
                 log_info("patchmanager", "loaded patches for {} from {}", dll, extraPath);
-                std::string content = fileutils::text_read(extraPath);
-                append_patches(content, apply_patches, nullptr, extraId);
+                auto doc = read_patch_file(extraPath);
+                append_patches(*doc, apply_patches, nullptr, extraId);
                 if (ACTIVE_JSON_FILE.empty()) {
                     ACTIVE_JSON_FILE = displayPath(extraPath);
                 } else {
@@ -750,15 +838,11 @@ namespace patcher {
     }
 
     void append_patches(
-        std::string &patches_json,
+        Document &doc,
         bool apply_patches,
         std::function<bool(const PatchData&)> filter,
         std::string pe_identifier_for_patch) {
 
-        // parse document
-        Document doc;
-        doc.Parse(patches_json.c_str());
-
         // check parse error
         const auto error = doc.GetParseError();
         const auto error_offset = doc.GetErrorOffset();
@@ -115,6 +115,10 @@ namespace patcher {
 
     // patch load / apply operations (also driven by the overlay window)
     void reload_local_patches(bool apply_patches = false);
+
+    // reads and parses the local patch files of the current game, so that the next
+    // reload_local_patches() doesn't have to. safe to run on another thread
+    void prefetch_local_patches();
     bool import_remote_patches_to_disk();
     void hard_apply_patches();
     void config_load();
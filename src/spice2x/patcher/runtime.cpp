@@ -15,6 +15,7 @@
 #include "util/libutils.h"
 #include "util/logging.h"
 #include "util/memutils.h"
+#include "util/peimage.h"
 #include "util/sigscan.h"
 #include "util/utils.h"
 
@@ -38,14 +39,23 @@ namespace patcher {
         DLL_MAP_ORG.clear();
     }
 
+    // mutable copy of a DLL on disk, served from the shared mapping so the file is only opened
+    // once no matter how many patch lists and lookups touch it; empty if it can't be read
+    static std::unique_ptr<std::vector<uint8_t>> read_dll_file(const std::filesystem::path &path) {
+        const auto image = util::PEImage::open(path);
+        if (!image) {
+            return std::make_unique<std::vector<uint8_t>>();
+        }
+        return std::make_unique<std::vector<uint8_t>>(image->data(), image->data() + image->size());
+    }
+
     void hard_apply_patches() {
         std::vector<std::filesystem::path> written_list;
 
         // dll_name -> in-memory image; populated lazily, written back once at
         // the end. Avoids re-reading and re-writing the full DLL per patch,
         // which used to dominate the cost of "Overwrite game files" on games
-        // with large patch lists (and leaked a vector per call via bin_read's
-        // raw new'd return).
+        // with large patch lists.
         robin_hood::unordered_map<std::string, std::unique_ptr<std::vector<uint8_t>>> dll_cache;
         std::unordered_set<std::string> dirty;
 
@@ -56,7 +66,7 @@ namespace patcher {
             }
             const auto dll_path = MODULE_PATH / dll_name;
             create_dll_backup(written_list, dll_path);
-            std::unique_ptr<std::vector<uint8_t>> owned(fileutils::bin_read(dll_path));
+            auto owned = read_dll_file(dll_path);
             if (!owned || owned->empty()) {
                 // remember the miss so subsequent patches don't re-read/backup
                 dll_cache.emplace(dll_name, nullptr);
@@ -137,6 +147,9 @@ namespace patcher {
         for (const auto &dll_name : dirty) {
             const auto &data = dll_cache.at(dll_name);
             if (data) {
+
+                // the file can't be rewritten while it is still mapped
+                util::PEImage::evict(MODULE_PATH / dll_name);
                 fileutils::bin_write(MODULE_PATH / dll_name, data->data(), data->size());
             }
         }
@@ -744,9 +757,7 @@ namespace patcher {
 
             auto it = DLL_MAP.find(dll_name);
             if (it == DLL_MAP.end()) {
-                DLL_MAP[dll_name] =
-                        std::unique_ptr<std::vector<uint8_t>>(
-                                fileutils::bin_read(dll_path));
+                DLL_MAP[dll_name] = read_dll_file(dll_path);
                 it = DLL_MAP.find(dll_name);
             }
 
@@ -848,8 +859,7 @@ namespace patcher {
         auto dlls = DLL_MAP.find(dll_name);
         if (dlls == DLL_MAP.end()) {
             // not found; load DLL into map
-            DLL_MAP[dll_name] =
-                std::unique_ptr<std::vector<uint8_t>>(fileutils::bin_read(MODULE_PATH / dll_name));
+            DLL_MAP[dll_name] = read_dll_file(MODULE_PATH / dll_name);
         }
 
         // find file
@@ -869,8 +879,7 @@ namespace patcher {
         auto dlls = DLL_MAP_ORG.find(dll_name);
         if (dlls == DLL_MAP_ORG.end()) {
             // not found; load DLL into map
-            DLL_MAP_ORG[dll_name] =
-                std::unique_ptr<std::vector<uint8_t>>(fileutils::bin_read(MODULE_PATH / dll_name));
+            DLL_MAP_ORG[dll_name] = read_dll_file(MODULE_PATH / dll_name);
         }
 
         // find file
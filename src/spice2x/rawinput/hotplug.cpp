@@ -108,7 +108,7 @@ namespace rawinput {
                                     std::string path = to_string(drive) + ":\\card" + to_string(player) + ".txt";
                                     if (fileutils::file_exists(path)) {
                                         uint8_t card_data[8];
-                                        if (eamuse_get_card_from_file(path, card_data, player)) {
+                                        if (eamuse_get_card_from_file(path, card_data, player, true)) {
                                             eamuse_card_insert(player, card_data);
                                         }
                                     }
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rawinput {
+
+    /*
+     * Coalesces light output into as few device writes as possible.
+     *
+     * Light writes only change the shadow state of a device and mark it here. Once the game is
+     * done with a batch of writes it kicks the scheduler, whose thread then hands every marked
+     * device to the sink once, no matter how many writes it got. Each device also has a minimum
+     * time between two writes; a device kicked again before that ran out keeps collecting
+     * changes and goes out as soon as it may, so a game updating its lights per LED or faster
+     * than the device can take it never queues up writes or blocks on them.
+     *
+     * Devices that used to be written through on every light change go in with push() instead,
+     * which does not wait for a kick, since not every caller flushes after writing lights.
+     *
+     * Targets have to stay valid until they are forgotten. No Windows dependencies.
+     */
+    template<class Target>
+    class OutputScheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+        using Sink = std::function<void(Target *target)>;
+
+        struct Stats {
+
+            // state changes marked, and writes they ended up in
+            uint64_t marks = 0;
+            uint64_t writes = 0;
+
+            // time from the first change of a write until it went out
+            clock::duration latency_total {};
+            clock::duration latency_max {};
+        };
+
+        explicit OutputScheduler(Sink sink) : sink(std::move(sink)) {
+        }
+
+        ~OutputScheduler() {
+            this->stop();
+        }
+
+        OutputScheduler(const OutputScheduler &) = delete;
+        OutputScheduler &operator=(const OutputScheduler &) = delete;
+
+        void start() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->thread) {
+                this->running = true;
+                this->thread = std::make_unique<std::thread>([this] { this->run(); });
+            }
+        }
+
+        // stops the thread, whatever is still pending is not written
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->running = false;
+            }
+            this->cv.notify_all();
+            if (this->thread) {
+                this->thread->join();
+                this->thread.reset();
+            }
+        }
+
+        // `target` has new state, to be written after the next kick
+        void mark(Target *target, clock::duration min_interval) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            auto &entry = this->entry(target);
+            entry.min_interval = min_interval;
+            if (!entry.pending) {
+                entry.pending = true;
+                entry.first_mark = clock::now();
+            }
+            this->stats_.marks++;
+        }
+
+        // marks `target` and writes it as soon as its rate limit allows, without waiting for a kick
+        void push(Target *target, clock::duration min_interval) {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                auto &entry = this->entry(target);
+                entry.min_interval = min_interval;
+                if (!entry.pending) {
+                    entry.pending = true;
+                    entry.first_mark = clock::now();
+                }
+                entry.requested = true;
+                this->pushed = true;
+                this->stats_.marks++;
+            }
+            this->cv.notify_one();
+        }
+
+        // writes everything marked so far, as soon as the rate limits allow
+        void kick() {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->kicked = true;
+            }
+            this->cv.notify_one();
+        }
+
+        // drops `target`, waiting for a write to it that is in progress
+        void forget(Target *target) {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->idle_cv.wait(lock, [this, target] {
+                return std::none_of(this->writing.begin(), this->writing.end(),
+                        [target](Target *t) { return t == target; });
+            });
+            this->entries.erase(
+                    std::remove_if(this->entries.begin(), this->entries.end(),
+                            [target](const Entry &e) { return e.target == target; }),
+                    this->entries.end());
+        }
+
+        // drops all targets, waiting for writes in progress
+        void clear() {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->idle_cv.wait(lock, [this] { return this->writing.empty(); });
+            this->entries.clear();
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            return this->stats_;
+        }
+
+    private:
+        struct Entry {
+            Target *target = nullptr;
+            clock::duration min_interval {};
+            clock::time_point last_write {};
+            clock::time_point first_mark {};
+            bool pending = false;
+            bool requested = false;
+        };
+
+        Sink sink;
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::condition_variable idle_cv;
+        std::unique_ptr<std::thread> thread;
+        std::vector<Entry> entries;
+        std::vector<Target *> writing;
+        Stats stats_;
+        bool running = false;
+        bool kicked = false;
+        bool pushed = false;
+
+        // there are only a handful of output devices, a linear search beats anything fancier
+        Entry &entry(Target *target) {
+            for (auto &entry : this->entries) {
+                if (entry.target == target) {
+                    return entry;
+                }
+            }
+            auto &entry = this->entries.emplace_back();
+            entry.target = target;
+            return entry;
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (this->running) {
+
+                // everything marked up to the kick is due now, pushed targets already are
+                this->pushed = false;
+                if (this->kicked) {
+                    this->kicked = false;
+                    for (auto &entry : this->entries) {
+                        entry.requested |= entry.pending;
+                    }
+                }
+
+                // pick what may go out, remember when the rest may
+                const auto now = clock::now();
+                auto next = clock::time_point::max();
+                for (auto &entry : this->entries) {
+                    if (!entry.requested) {
+                        continue;
+                    }
+                    const auto allowed = entry.last_write + entry.min_interval;
+                    if (now < allowed) {
+                        next = std::min(next, allowed);
+                        continue;
+                    }
+                    const auto latency = now - entry.first_mark;
+                    this->stats_.writes++;
+                    this->stats_.latency_total += latency;
+                    this->stats_.latency_max = std::max(this->stats_.latency_max, latency);
+                    entry.pending = false;
+                    entry.requested = false;
+                    entry.last_write = now;
+                    this->writing.push_back(entry.target);
+                }
+
+                // write without holding the lock, marks keep coming in meanwhile
+                if (!this->writing.empty()) {
+                    lock.unlock();
+                    for (auto target : this->writing) {
+                        this->sink(target);
+                    }
+                    lock.lock();
+                    this->writing.clear();
+                    this->idle_cv.notify_all();
+                    continue;
+                }
+
+                // sleep until kicked or the next rate limited write is allowed
+                const auto wake = [this] { return !this->running || this->kicked || this->pushed; };
+                if (next == clock::time_point::max()) {
+                    this->cv.wait(lock, wake);
+                } else {
+                    this->cv.wait_until(lock, next, wake);
+                }
+            }
+        }
+    };
+}
@@ -1108,46 +1108,19 @@ void rawinput::RawInputManager::flush_stop() {
 }
 
 void rawinput::RawInputManager::output_start() {
-
-    // start thread if required
-    if (!output_thread) {
-        output_thread_running = true;
-        output_thread = new std::thread([this] {
-            std::unique_lock<std::mutex> lock(output_thread_m);
-            while (output_thread_running) {
-
-                // wait for CV
-                output_thread_cv.wait(lock, [this] {
-                    return output_thread_ready;
-                });
-
-                // check for exit
-                if (!output_thread_running) {
-                    break;
-                }
-
-                // iterate all devices
-                do {
-                    output_thread_ready = false;
-                    this->devices_write_output_snapshot(true);
-                } while (output_thread_ready);
-            }
-        });
-    }
+    this->output_scheduler.start();
 }
 
 void rawinput::RawInputManager::output_stop() {
+    this->output_scheduler.stop();
 
-    // stop output thread
-    this->output_thread_running = false;
-    if (this->output_thread) {
-        this->output_thread_m.lock();
-        this->output_thread_ready = true;
-        this->output_thread_m.unlock();
-        this->output_thread_cv.notify_all();
-        this->output_thread->join();
-        delete this->output_thread;
-        this->output_thread = nullptr;
+    // tell how much the coalescing saved
+    const auto stats = this->output_scheduler.stats();
+    if (stats.writes > 0) {
+        log_misc("rawinput", "light output: {} updates sent in {} writes, latency {}us avg / {}us max",
+                stats.marks, stats.writes,
+                std::chrono::duration_cast<std::chrono::microseconds>(stats.latency_total).count() / stats.writes,
+                std::chrono::duration_cast<std::chrono::microseconds>(stats.latency_max).count());
     }
 }
 
@@ -1479,6 +1452,7 @@ void rawinput::RawInputManager::devices_destruct() {
         // dispose devices (if there is anything to dispose)
         if (!this->devices.empty()) {
             log_info("rawinput", "disposing devices");
+            this->output_scheduler.clear();
             for (auto &device : this->devices) {
                 this->devices_destruct(&device, false);
                 delete device.mutex;
@@ -1503,6 +1477,9 @@ void rawinput::RawInputManager::devices_destruct(Device *device, bool log) {
         return;
     }
 
+    // no more light output, waits for a write in progress
+    this->output_scheduler.forget(device);
+
     // optionally log
     if (log) {
         log_info("rawinput", "destroying device: {} / {}", device->desc, device->name);
@@ -2253,14 +2230,44 @@ void rawinput::RawInputManager::device_write_output(Device *device, bool only_up
 
 }
 
+void rawinput::RawInputManager::device_output_mark(Device *device) {
+
+    /*
+     * Minimum time between two writes to a device. Lights written meanwhile are merged into
+     * the next write, which keeps games updating per LED or per frame from flooding devices.
+     * The SMX SDK asks for no more than 30 light updates per second.
+     */
+    static const auto HID_INTERVAL = std::chrono::milliseconds(4);
+    static const auto SEXTET_INTERVAL = std::chrono::milliseconds(8);
+    static const auto SMX_INTERVAL = std::chrono::milliseconds(33);
+
+    switch (device->type) {
+        case HID:
+            this->output_scheduler.mark(device, HID_INTERVAL);
+            break;
+        case SEXTET_OUTPUT:
+
+            // was written through on every change, some callers never flush
+            this->output_scheduler.push(device, SEXTET_INTERVAL);
+            break;
+        case SMX_STAGE:
+        case SMX_DEDICAB:
+            this->output_scheduler.mark(device, SMX_INTERVAL);
+            break;
+        default:
+
+            // PIUIO and XInput send on their own
+            break;
+    }
+}
+
 void rawinput::RawInputManager::devices_flush_output(bool optimized) {
 
     // optimized routine
     if (optimized) {
 
-        // notify thread
-        output_thread_ready = true;
-        output_thread_cv.notify_one();
+        // send what got marked
+        this->output_scheduler.kick();
         return;
     }
 
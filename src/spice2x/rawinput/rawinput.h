@@ -12,6 +12,7 @@
 
 #include "device.h"
 #include "hotplug.h"
+#include "output_scheduler.h"
 #include "rawinput_handles.h"
 #include "rawinput/xinput.h"
 #include "util/scope_guard.h"
@@ -105,11 +106,11 @@ namespace rawinput {
         bool flush_thread_running = false;
         std::mutex flush_thread_m;
         std::condition_variable flush_thread_cv;
-        std::thread *output_thread = nullptr;
-        std::mutex output_thread_m;
-        bool output_thread_ready = false;
-        bool output_thread_running = false;
-        std::condition_variable output_thread_cv;
+
+        // light writes only update the shadow state of a device, this sends it
+        OutputScheduler<Device> output_scheduler {[](Device *device) {
+            device_write_output(device);
+        }};
         std::vector<DeviceCallback> callback_add;
         std::vector<DeviceCallback> callback_change;
         std::vector<MidiCallback> callback_midi;
@@ -167,6 +168,7 @@ namespace rawinput {
         void devices_unregister();
 
         static void device_write_output(Device *device, bool only_updated = true);
+        void device_output_mark(Device *device);
         void devices_flush_output(bool optimized = true);
 
         void __stdcall devices_print();
@@ -69,16 +69,21 @@ namespace rawinput {
         return true;
     }
 
-    void SmxDedicabDevice::SetLightByIndex(size_t index, uint8_t value) {
+    bool SmxDedicabDevice::SetLightByIndex(size_t index, uint8_t value) {
         const size_t subpixel = index % 3;
         const size_t device = (index / 3);
         const size_t numLeds = DEVICE_LED_COUNTS[device];
 
+        // all LEDs of a device always get the same value, the first one tells if anything changes
         m_lightDataMutex.lock();
-        for (size_t i = 0; i < numLeds; i++) {
-            m_lightData[device][(i * 3) + subpixel] = value;
+        const bool changed = m_lightData[device][subpixel] != value;
+        if (changed) {
+            for (size_t i = 0; i < numLeds; i++) {
+                m_lightData[device][(i * 3) + subpixel] = value;
+            }
         }
         m_lightDataMutex.unlock();
+        return changed;
     }
 
     void SmxDedicabDevice::Update() {
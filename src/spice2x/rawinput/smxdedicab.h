@@ -13,7 +13,7 @@ namespace rawinput {
 
         SmxDedicabDevice();
         bool Initialize();
-        void SetLightByIndex(size_t index, uint8_t value);
+        bool SetLightByIndex(size_t index, uint8_t value);
         void Update();
     private:
         uint8_t* m_lightData[DEVICE_COUNT];
@@ -41,16 +41,22 @@ namespace rawinput {
         return true;
     }
 
-    void SmxStageDevice::SetLightByIndex(size_t index, uint8_t value) {
+    bool SmxStageDevice::SetLightByIndex(size_t index, uint8_t value) {
         const size_t subpixel = index%3;
         const size_t panel = (index/3)%PANEL_COUNT;
         const size_t pad = (index/3)/PANEL_COUNT;
+        const size_t base = (pad*PANEL_COUNT*LEDS_PER_PAD*3)+(panel*LEDS_PER_PAD*3)+subpixel;
 
+        // all LEDs of a panel always get the same value, the first one tells if anything changes
         m_lightDataMutex.lock();
-        for(size_t i = 0; i < LEDS_PER_PAD; ++i) {
-            m_lightData[(pad*PANEL_COUNT*LEDS_PER_PAD*3)+(panel*LEDS_PER_PAD*3)+(i*3)+subpixel] = value;
+        const bool changed = m_lightData[base] != value;
+        if (changed) {
+            for(size_t i = 0; i < LEDS_PER_PAD; ++i) {
+                m_lightData[base+(i*3)] = value;
+            }
         }
         m_lightDataMutex.unlock();
+        return changed;
     }
 
     void SmxStageDevice::Update() {
@@ -21,7 +21,7 @@ namespace rawinput {
 
         SmxStageDevice();
         bool Initialize();
-        void SetLightByIndex(size_t index, uint8_t value);
+        bool SetLightByIndex(size_t index, uint8_t value);
         void Update();
     private:
         std::vector<uint8_t> m_lightData;
@@ -0,0 +1,32 @@
+#include "frame.h"
+
+static inline size_t put_escaped(uint8_t *out, size_t pos, uint8_t b) {
+    if (b == READER_FRAME_START || b == READER_FRAME_ESCAPE) {
+        out[pos++] = READER_FRAME_ESCAPE;
+        out[pos++] = ~b;
+    } else {
+        out[pos++] = b;
+    }
+    return pos;
+}
+
+size_t reader_frame_encode(uint8_t node, uint8_t param, uint8_t cmd, uint8_t packet_id,
+        const uint8_t *data, size_t size, uint8_t *out) {
+    if (size > READER_FRAME_DATA_MAX) {
+        size = READER_FRAME_DATA_MAX;
+    }
+    const uint8_t header[READER_FRAME_HEADER_SIZE] { node, param, cmd, packet_id, (uint8_t) size };
+
+    size_t pos = 0;
+    uint8_t checksum = 0;
+    out[pos++] = READER_FRAME_START;
+    for (const uint8_t b : header) {
+        pos = put_escaped(out, pos, b);
+        checksum += b;
+    }
+    for (size_t i = 0; i < size; i++) {
+        pos = put_escaped(out, pos, data[i]);
+        checksum += data[i];
+    }
+    return put_escaped(out, pos, checksum);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Framing of the card reader protocol.
+ *
+ * A frame is 0xAA followed by node, param, command, packet id, data length, the data and a
+ * checksum (the sum of everything in between). 0xAA and 0xFF inside a frame are sent as 0xFF
+ * followed by the inverted byte, and a bare 0xAA always starts a new frame.
+ *
+ * The decoder is fed one byte at a time and keeps its state between calls, so a frame split
+ * over several reads is put together again. Frames are decoded in place and handed out by
+ * reference, nothing is allocated. No Windows dependencies, to keep it testable on its own.
+ */
+
+constexpr uint8_t READER_FRAME_START = 0xAA;
+constexpr uint8_t READER_FRAME_ESCAPE = 0xFF;
+constexpr size_t READER_FRAME_HEADER_SIZE = 5;
+constexpr size_t READER_FRAME_DATA_MAX = 255;
+
+// largest frame on the wire, with every byte after the start escaped
+constexpr size_t READER_FRAME_ENCODED_MAX = 1 + (READER_FRAME_HEADER_SIZE + READER_FRAME_DATA_MAX + 1) * 2;
+
+struct ReaderFrame {
+
+    // header followed by the data, without escapes and checksum
+    uint8_t bytes[READER_FRAME_HEADER_SIZE + READER_FRAME_DATA_MAX];
+    size_t size = 0;
+
+    inline uint8_t node() const { return bytes[0]; }
+    inline uint8_t param() const { return bytes[1]; }
+    inline uint8_t cmd() const { return bytes[2]; }
+    inline uint8_t packet_id() const { return bytes[3]; }
+    inline uint8_t length() const { return bytes[4]; }
+    inline const uint8_t *data() const { return &bytes[READER_FRAME_HEADER_SIZE]; }
+};
+
+class ReaderFrameDecoder {
+public:
+
+    /*
+     * Feeds one byte. Returns true when it completed a frame with a valid checksum, which is
+     * then available from frame() until the next call.
+     */
+    inline bool push(uint8_t b) {
+        if (b == READER_FRAME_START) {
+            if (this->in_frame) {
+                this->dropped++;
+            }
+            this->in_frame = true;
+            this->escape = false;
+            this->current.size = 0;
+            this->checksum = 0;
+            return false;
+        }
+        if (!this->in_frame) {
+            return false;
+        }
+        if (b == READER_FRAME_ESCAPE && !this->escape) {
+            this->escape = true;
+            return false;
+        }
+        if (this->escape) {
+            b = ~b;
+            this->escape = false;
+        }
+
+        // the checksum follows the header and the announced data
+        const auto size = this->current.size;
+        if (size < READER_FRAME_HEADER_SIZE || size < READER_FRAME_HEADER_SIZE + this->current.length()) {
+            this->current.bytes[size] = b;
+            this->current.size = size + 1;
+            this->checksum += b;
+            return false;
+        }
+        this->in_frame = false;
+        if (b != this->checksum) {
+            this->dropped++;
+            return false;
+        }
+        return true;
+    }
+
+    inline const ReaderFrame &frame() const {
+        return this->current;
+    }
+
+    // discards a partial frame
+    inline void reset() {
+        this->in_frame = false;
+        this->escape = false;
+    }
+
+    // frames cut short or failing their checksum so far
+    size_t dropped = 0;
+
+private:
+    ReaderFrame current;
+    uint8_t checksum = 0;
+    bool in_frame = false;
+    bool escape = false;
+};
+
+// writes a complete frame to `out`, which must hold READER_FRAME_ENCODED_MAX bytes; returns its size
+size_t reader_frame_encode(uint8_t node, uint8_t param, uint8_t cmd, uint8_t packet_id,
+        const uint8_t *data, size_t size, uint8_t *out);
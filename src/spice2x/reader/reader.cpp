@@ -9,11 +9,22 @@
 #include "util/logging.h"
 #include "misc/eamuse.h"
 #include "util/utils.h"
-#include "structuredmessage.h"
 
 static std::vector<std::thread *> READER_THREADS;
 static bool READER_THREAD_RUNNING = false;
 
+// how long a single read waits for the first byte, bounds how quickly the thread notices a stop
+static const DWORD READ_WAIT_MS = 50;
+
+// how long a command waits for its response
+static const auto RESPONSE_TIMEOUT = std::chrono::milliseconds(1000);
+
+// an RFID scan is restarted this often while no card shows up
+static const auto RFID_SCAN_INTERVAL = std::chrono::milliseconds(200);
+
+// the same card is not inserted again within this time
+static const auto CARD_REPEAT_DELAY = std::chrono::milliseconds(2500);
+
 Reader::Reader(const std::string &port) : port(port) {
 
     // open port using an NT path to support COM ports past 9
@@ -50,48 +61,41 @@ bool Reader::is_valid() {
 }
 
 bool Reader::initialize() {
-    if (!this->set_comm_state(CBR_57600) || !this->wait_for_handshake())
+    if (!this->set_comm_state(CBR_57600) || !this->wait_for_handshake() || !this->set_event_timeouts())
         return false;
 
     log_info("reader", "{}: card reader connected", this->port);
 
     // assign reader ID
-    std::vector<uint8_t> set_id_data;
-    set_id_data.push_back(0x00);
-    if (this->msg_write_read(StructuredMessage(
-            0,
-            this->reinitialized,
-            READER_CMD_SET_ID,
-            this->gen_msg_id(),
-            set_id_data)).empty())
+    const uint8_t set_id_data[] { 0x00 };
+    if (!this->msg_write(0, READER_CMD_SET_ID, set_id_data, sizeof(set_id_data))
+            || !this->msg_read(READER_CMD_SET_ID))
         return false;
 
     // get version
-    std::vector<Message> ret = this->msg_write_cmd_read(READER_CMD_VERSION);
-    if (ret.empty())
+    auto version = this->msg_write_cmd_read(READER_CMD_VERSION);
+    if (!version)
         return false;
 
     // print version info
-    std::vector<uint8_t> version_data = ret[ret.size() - 1].get_data();
-    std::ostringstream model;
-    model << version_data[13] << version_data[14] << version_data[15] << version_data[16];
-    log_info("reader", "{}: card reader model: {}", this->port, model.str());
-    std::ostringstream date;
-    date << (const char *) &version_data[17];
-    log_info("reader", "{}: card reader date:  {}", this->port, date.str());
-    std::ostringstream clock;
-    clock << (const char *) &version_data[33];
-    log_info("reader", "{}: card reader clock: {}", this->port, clock.str());
+    if (version->size >= 49) {
+        auto version_str = [version](size_t offset, size_t max_len) {
+            auto str = (const char *) &version->bytes[offset];
+            return std::string(str, strnlen(str, max_len));
+        };
+        log_info("reader", "{}: card reader model: {}", this->port, version_str(13, 4));
+        log_info("reader", "{}: card reader date:  {}", this->port, version_str(17, 16));
+        log_info("reader", "{}: card reader clock: {}", this->port, version_str(33, 16));
+    }
 
     // init 2
-    if (this->msg_write_cmd_read(READER_CMD_INIT2).empty())
+    if (!this->msg_write_cmd_read(READER_CMD_INIT2))
         return false;
 
     // reinitialize
     this->reinitialized = 1;
-    std::vector<uint8_t> reinitialize_data;
-    reinitialize_data.push_back(0x00);
-    if (this->msg_write_cmd_read(READER_CMD_REINITIALIZE, reinitialize_data).empty())
+    const uint8_t reinitialize_data[] { 0x00 };
+    if (!this->msg_write_cmd_read(READER_CMD_REINITIALIZE, reinitialize_data, sizeof(reinitialize_data)))
         return false;
 
     log_info("reader", "{}: card reader init done", this->port);
@@ -101,19 +105,18 @@ bool Reader::initialize() {
 bool Reader::init_crypt() {
 
     // generate game key
-    std::vector<uint8_t> gk;
-    for (int i = 0; i < 4; i++)
-        gk.push_back((uint8_t) (rand() % 256));
+    uint8_t gk[4];
+    for (auto &b : gk)
+        b = (uint8_t) (rand() % 256);
 
     // reader crypt init
-    std::vector<Message> ret = this->msg_write_cmd_read(READER_CMD_KEY_EXCHANGE, gk);
-    if (ret.empty())
+    auto msg = this->msg_write_cmd_read(READER_CMD_KEY_EXCHANGE, gk, sizeof(gk));
+    if (!msg)
         return false;
 
     // validate message
-    Message msg = ret[ret.size() - 1];
-    std::vector<uint8_t> md = msg.get_data();
-    if (md.size() != 9)
+    const uint8_t *md = msg->bytes;
+    if (msg->size != 9)
         return false;
 
     // convert keys to int32
@@ -132,32 +135,32 @@ bool Reader::init_crypt() {
 
 bool Reader::read_card() {
 
-    // read card UID
-    std::vector<uint8_t> status_ruid_data;
-    status_ruid_data.push_back(0x00);
-    status_ruid_data.push_back(0x03);
-    status_ruid_data.push_back(0xFF);
-    status_ruid_data.push_back(0xFF);
-    if (this->msg_write_cmd_read(READER_CMD_RFID_READ_UID, status_ruid_data).empty()) {
-        this->valid = false;
-        return false;
+    // (re)start reading the card UID; the status polls below run back to back in the meantime,
+    // each one paced by the reader's response instead of a sleep
+    auto now = std::chrono::steady_clock::now();
+    if (!this->rfid_scanning || now - this->rfid_scan_start >= RFID_SCAN_INTERVAL) {
+        const uint8_t status_ruid_data[] { 0x00, 0x03, 0xFF, 0xFF };
+        if (!this->msg_write_cmd_read(READER_CMD_RFID_READ_UID, status_ruid_data, sizeof(status_ruid_data))) {
+            this->valid = false;
+            return false;
+        }
+        this->rfid_scan_start = now;
+        this->rfid_scanning = true;
     }
-    Sleep(200);
 
     // get reader status
-    std::vector<uint8_t> status_req_data;
-    status_req_data.push_back(0x10);
-    std::vector<Message> ret = this->msg_write_cmd_read(READER_CMD_GET_STATUS_ENC, status_req_data);
-    if (ret.empty()) {
+    const uint8_t status_req_data[] { 0x10 };
+    auto status_msg = this->msg_write_cmd_read(READER_CMD_GET_STATUS_ENC, status_req_data, sizeof(status_req_data));
+    if (!status_msg) {
         this->valid = false;
         return false;
     }
 
     // get data
-    Message status_msg = ret[ret.size() - 1];
-    std::vector<uint8_t> status_data = status_msg.get_data();
-    if (status_data.size() != 23)
+    if (status_msg->size != 23)
         return false;
+    uint8_t status_data[23];
+    memcpy(status_data, status_msg->bytes, sizeof(status_data));
 
     // decrypt data
     this->crypt.crypt(&status_data[5], 18);
@@ -177,6 +180,7 @@ bool Reader::read_card() {
     // check for card input
     if (status_data[5] == 2) {
         memcpy(this->card_uid, &status_data[7], 8);
+        this->rfid_scanning = false;
         return true;
     }
 
@@ -217,6 +221,28 @@ bool Reader::set_comm_state(DWORD BaudRate) {
     return true;
 }
 
+bool Reader::set_event_timeouts() {
+
+    // reads return as soon as anything arrived and only block while nothing did
+    COMMTIMEOUTS timeouts{};
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = READ_WAIT_MS;
+    timeouts.WriteTotalTimeoutConstant = 30;
+    timeouts.WriteTotalTimeoutMultiplier = 5;
+    if (!SetCommTimeouts(this->serial_handle, &timeouts)) {
+        log_warning("reader", "{}: unable to set COM port timeouts: 0x{:x}", this->port, GetLastError());
+        return false;
+    }
+
+    // whatever is left over from the handshake is not a message
+    PurgeComm(this->serial_handle, PURGE_RXCLEAR);
+    this->decoder.reset();
+    this->rx_pos = 0;
+    this->rx_size = 0;
+    return true;
+}
+
 bool Reader::wait_for_handshake() {
     // baud rates
     DWORD baud_rates[] = { CBR_57600, CBR_38400, CBR_19200, CBR_9600 };
@@ -279,29 +305,18 @@ bool Reader::wait_for_handshake() {
     return false;
 }
 
-bool Reader::msg_write(Message msg) {
-
-    // get message data
-    std::vector<uint8_t> msg_encoded = msg.get_data_encoded();
-    uint8_t chk_sum = msg.chk_sum();
-
-    // create write buffer
-    uint8_t write_buffer[512];
-    DWORD write_buffer_len = 0;
-
-    // fill write buffer
-    write_buffer[write_buffer_len++] = 0xAA;
-    for (const uint8_t c : msg_encoded) {
-        write_buffer[write_buffer_len++] = c;
-    }
+bool Reader::msg_write(uint8_t node, uint8_t cmd, const uint8_t *data, size_t size) {
 
-    // write checksum
-    if (chk_sum == 0xAA || chk_sum == 0xFF) {
-        write_buffer[write_buffer_len++] = 0xFF;
-        write_buffer[write_buffer_len++] = ~chk_sum;
-    } else {
-        write_buffer[write_buffer_len++] = chk_sum;
-    }
+    // encode frame
+    uint8_t write_buffer[READER_FRAME_ENCODED_MAX];
+    auto write_buffer_len = (DWORD) reader_frame_encode(
+            node,
+            this->reinitialized,
+            cmd,
+            this->gen_msg_id(),
+            data,
+            size,
+            write_buffer);
 
     // write buffer
     DWORD bytes_written = 0;
@@ -312,93 +327,43 @@ bool Reader::msg_write(Message msg) {
             nullptr) != 0;
 }
 
-std::vector<Message> Reader::msg_write_read(Message msg) {
-    this->msg_write(msg);
-    return this->msg_read();
+const ReaderFrame *Reader::msg_write_cmd_read(uint8_t cmd, const uint8_t *data, size_t size) {
+    if (!this->msg_write(this->node, cmd, data, size))
+        return nullptr;
+    return this->msg_read(cmd);
 }
 
-std::vector<Message> Reader::msg_write_cmd_read(uint8_t cmd) {
-    return this->msg_write_cmd_read(cmd, std::vector<uint8_t>());
-}
+const ReaderFrame *Reader::msg_read(uint8_t cmd) {
+    auto deadline = std::chrono::steady_clock::now() + RESPONSE_TIMEOUT;
+    while (true) {
 
-std::vector<Message> Reader::msg_write_cmd_read(uint8_t cmd, std::vector<uint8_t> data) {
-    this->msg_write(StructuredMessage(
-            this->node,
-            this->reinitialized,
-            cmd,
-            this->gen_msg_id(),
-            data
-    ));
-    return this->msg_read();
-}
-
-std::vector<Message> Reader::msg_read() {
-
-    // create buffer
-    std::vector<Message> msgs;
-    uint8_t read_buffer[4096];
-    DWORD read_buffer_len = 0;
-
-    // read to buffer
-    if (ReadFile(
-                this->serial_handle,
-                read_buffer,
-                sizeof(read_buffer),
-                &read_buffer_len,
-                nullptr) && read_buffer_len > 0)
-    {
-        std::vector<uint8_t> msg_data;
-        size_t msg_remaining = 0;
-        bool escape = false;
-        for (size_t i = 0; i < read_buffer_len; i++) {
-            uint8_t b = read_buffer[i];
-            if (msg_remaining > 0) {
-
-                // add msg data length
-                if (msg_data.size() < 6 && msg_remaining == 1)
-                    msg_remaining += msg_data[4];
-
-                if (escape) { // escaped byte
-                    b = ~b;
-                    msg_data.push_back(b);
-                    msg_remaining--;
-                    escape = false;
-                } else if (b == 0xAA) { // message start
-                    msg_remaining = 6;
-                    msg_data.clear();
-                } else if (b == 0xFF) { // escape
-                    escape = true;
-                } else { // normal data
-                    msg_data.push_back(b);
-                    msg_remaining--;
+        // decode what was received so far, leaving the rest for the next message
+        while (this->rx_pos < this->rx_size) {
+            if (this->decoder.push(this->rx_buffer[this->rx_pos++])) {
+                auto &frame = this->decoder.frame();
+                if (frame.cmd() == cmd) {
+                    return &frame;
                 }
-            } else if (b == 0xAA) { // message start
-                msg_remaining = 6;
-                msg_data.clear();
             }
+        }
 
-            if (msg_remaining == 0 && msg_data.size() >= 6) { // message done
-                std::vector<uint8_t> msg_ext_data;
-                for (size_t n = 0; n < msg_data[4] && n < msg_data.size() - 6; n++) {
-                    msg_ext_data.push_back(msg_data[5 + n]);
-                }
-                StructuredMessage msg(
-                        msg_data[0],
-                        msg_data[1],
-                        msg_data[2],
-                        msg_data[3],
-                        msg_ext_data
-                );
-                if (msg.chk_sum() == msg_data[msg_data.size() - 1]) {
-                    msgs.push_back(msg);
-                }
-                msg_data.clear();
-            }
+        // wait for more
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return nullptr;
+        }
+        this->rx_pos = 0;
+        this->rx_size = 0;
+        if (!ReadFile(
+                    this->serial_handle,
+                    this->rx_buffer,
+                    sizeof(this->rx_buffer),
+                    &this->rx_size,
+                    nullptr))
+        {
+            this->rx_size = 0;
+            return nullptr;
         }
     }
-
-    // return message buffer
-    return msgs;
 }
 
 void start_reader_thread(const std::string &port, int id) {
@@ -418,10 +383,24 @@ void start_reader_thread(const std::string &port, int id) {
                 log_warning("reader", "{}: unable to initialize reader", port);
             } else if (reader.init_crypt()) {
 
-                // reader loop
+                // reader loop, paced by the reader's responses
+                uint8_t last_uid[8] {};
+                std::chrono::steady_clock::time_point last_insert;
                 while (READER_THREAD_RUNNING && reader.is_valid()) {
                     bool did_read_card = reader.read_card();
 
+                    // a card left on the reader is only inserted again after a while
+                    if (did_read_card) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (memcmp(last_uid, reader.get_card_uid(), sizeof(last_uid)) == 0
+                                && now - last_insert < CARD_REPEAT_DELAY) {
+                            did_read_card = false;
+                        } else {
+                            memcpy(last_uid, reader.get_card_uid(), sizeof(last_uid));
+                            last_insert = now;
+                        }
+                    }
+
                     if (did_read_card) {
                         const uint8_t *uid = reader.get_card_uid();
                         log_info("reader", "{}: reader input: {}", port, bin2hex(uid, 8));
@@ -440,12 +419,6 @@ void start_reader_thread(const std::string &port, int id) {
                             eamuse_set_keypad_overrides_reader(unit, reader.keypad_state);
                         }
                     }
-
-                    if (did_read_card) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(2500));
-                    }
-
-                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
                 }
             }
 
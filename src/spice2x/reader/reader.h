@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <string>
 
 #include <windows.h>
 
 #include "crypt.h"
-#include "message.h"
+#include "frame.h"
 
 enum reader_cmd {
     READER_CMD_SET_ID         = 0x01,
@@ -56,16 +58,28 @@ private:
     uint8_t cur_msg_id = 0;
     Crypt crypt;
 
+    // receive state, kept across reads so frames split between them survive
+    ReaderFrameDecoder decoder;
+    uint8_t rx_buffer[512];
+    DWORD rx_pos = 0, rx_size = 0;
+
+    // when the running RFID scan was started
+    std::chrono::steady_clock::time_point rfid_scan_start;
+    bool rfid_scanning = false;
+
     inline uint8_t gen_msg_id() { return ++cur_msg_id; }
 
     bool set_comm_state(DWORD BaudRate);
+    bool set_event_timeouts();
     bool wait_for_handshake();
-    bool msg_write(Message msg);
-
-    std::vector<Message> msg_write_read(Message msg);
-    std::vector<Message> msg_write_cmd_read(uint8_t cmd);
-    std::vector<Message> msg_write_cmd_read(uint8_t cmd, std::vector<uint8_t> data);
-    std::vector<Message> msg_read();
+    bool msg_write(uint8_t node, uint8_t cmd, const uint8_t *data, size_t size);
+
+    /*
+     * Sends a command and waits for its response, which stays valid until the next message
+     * is read. nullptr when the reader did not answer in time.
+     */
+    const ReaderFrame *msg_write_cmd_read(uint8_t cmd, const uint8_t *data = nullptr, size_t size = 0);
+    const ReaderFrame *msg_read(uint8_t cmd);
 };
 
 void start_reader_thread(const std::string &serial_str, int id);
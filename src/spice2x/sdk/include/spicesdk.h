@@ -264,17 +264,207 @@ typedef struct SPICE_SDK_V0 {
 
 } SPICE_SDK_V0;
 
+typedef struct SPICE_SDK_IO_COUNTS {
+    uint32_t buttons;
+    uint32_t analogs;
+    uint32_t lights;
+} SPICE_SDK_IO_COUNTS;
+
+typedef struct SPICE_SDK_BUTTON_OVERRIDE {
+    uint32_t button_id;
+    bool pressed;   // same meaning as in set_button
+    float velocity; // same meaning as in set_button
+} SPICE_SDK_BUTTON_OVERRIDE;
+
+typedef struct SPICE_SDK_VALUE_OVERRIDE {
+    uint32_t id;          // analog ID for set_analogs, light ID for set_lights
+    bool override_active; // same meaning as in set_analog / set_light
+    float value;          // same meaning as in set_analog / set_light
+} SPICE_SDK_VALUE_OVERRIDE;
+
+typedef struct SPICE_SDK_IO_CHANGE {
+    uint32_t id;    // button, analog or light ID, depending on the callback type
+    bool pressed;   // buttons only: is the button pressed?
+    float value;    // buttons: MIDI velocity; analogs and lights: the new value
+} SPICE_SDK_IO_CHANGE;
+
+typedef enum SPICE_SDK_CALLBACK_TYPE {
+    // called once per poll, with no changes
+    SPICE_SDK_CALLBACK_POLL = 0,
+
+    // called once per poll in which at least one item changed, with all changed items
+    SPICE_SDK_CALLBACK_BUTTONS_CHANGED = 1,
+    SPICE_SDK_CALLBACK_ANALOGS_CHANGED = 2,
+    SPICE_SDK_CALLBACK_LIGHTS_CHANGED = 3,
+} SPICE_SDK_CALLBACK_TYPE;
+
+// get_io_counts (v1.0 and up)
+// gets the number of buttons, analogs and lights of the running game
+// IDs passed to all other I/O functions are below these counts
+//
+//   counts: receives the counts
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_get_io_counts_func)(
+    SPICE_SDK_IO_COUNTS *counts
+);
+
+// get_buttons (v1.0 and up)
+// gets the state of a range of buttons in one call
+//
+//   first_id: ID of the first button
+//   count: number of buttons; first_id + count must not exceed the button count
+//   pressed: (optional) array of count entries, receives the pressed state
+//   velocity: (optional) array of count entries, receives the MIDI velocity
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_get_buttons_func)(
+    uint32_t first_id,
+    uint32_t count,
+    bool *pressed,
+    float *velocity
+);
+
+// get_analogs (v1.0 and up)
+// gets the state of a range of analogs in one call
+//
+//   first_id: ID of the first analog
+//   count: number of analogs; first_id + count must not exceed the analog count
+//   values: array of count entries, receives the analog states
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_get_analogs_func)(
+    uint32_t first_id,
+    uint32_t count,
+    float *values
+);
+
+// get_lights (v1.0 and up)
+// gets the last observed values of a range of lights in one call
+//
+//   first_id: ID of the first light
+//   count: number of lights; first_id + count must not exceed the light count
+//   values: array of count entries, receives the light values; 0.0 to 1.0
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_get_lights_func)(
+    uint32_t first_id,
+    uint32_t count,
+    float *values
+);
+
+// set_buttons (v1.0 and up)
+// sets or clears many button overrides in one call
+// all IDs are validated before anything is applied, so either all or none take effect
+//
+//   overrides: array of button overrides
+//   count: number of entries in the array
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_set_buttons_func)(
+    const SPICE_SDK_BUTTON_OVERRIDE *overrides,
+    uint32_t count
+);
+
+// set_analogs (v1.0 and up)
+// sets or clears many analog overrides in one call
+// all IDs are validated before anything is applied, so either all or none take effect
+//
+//   overrides: array of analog overrides
+//   count: number of entries in the array
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_set_analogs_func)(
+    const SPICE_SDK_VALUE_OVERRIDE *overrides,
+    uint32_t count
+);
+
+// set_lights (v1.0 and up)
+// sets or clears many light overrides in one call
+// all IDs are validated before anything is applied, so either all or none take effect
+//
+//   overrides: array of light overrides
+//   count: number of entries in the array
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_set_lights_func)(
+    const SPICE_SDK_VALUE_OVERRIDE *overrides,
+    uint32_t count
+);
+
+// I/O callback (v1.0 and up)
+// called on a dedicated spice thread, never concurrently with itself
+// the changes array is only valid for the duration of the call
+// SDK functions may be called from inside the callback, but keep it short;
+// a slow callback delays all other callbacks
+//
+//   type: the type the callback was registered with
+//   changes: changed items; NULL for SPICE_SDK_CALLBACK_POLL
+//   count: number of entries in changes
+//   context: the context pointer passed to register_callback
+
+typedef void (__cdecl spice_sdk_io_callback_func)(
+    SPICE_SDK_CALLBACK_TYPE type,
+    const SPICE_SDK_IO_CHANGE *changes,
+    uint32_t count,
+    void *context
+);
+
+// register_callback (v1.0 and up)
+// registers a callback that is called on the SDK callback thread
+// the thread polls at the smallest interval of all registered callbacks
+// the first call of a change callback reports every item, to provide the initial state
+//
+//   type: see SPICE_SDK_CALLBACK_TYPE
+//   callback: function to call
+//   context: (optional) passed back to the callback as-is
+//   interval_ms: poll interval, 1 to 1000
+//   handle: receives a handle for unregister_callback
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_register_callback_func)(
+    SPICE_SDK_CALLBACK_TYPE type,
+    spice_sdk_io_callback_func *callback,
+    void *context,
+    uint32_t interval_ms,
+    uint32_t *handle
+);
+
+// unregister_callback (v1.0 and up)
+// removes a callback; once this returns, the callback is no longer running and will not be
+// called again, unless this is called from inside a callback (then it takes effect after it returns)
+// all callbacks are removed automatically before the destroy callback is called
+//
+//   handle: handle returned by register_callback
+
+typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_unregister_callback_func)(
+    uint32_t handle
+);
+
+typedef struct SPICE_SDK_V1 {
+    // all of v0, unchanged; v0.size must be set to sizeof(SPICE_SDK_V1)
+    SPICE_SDK_V0 v0;
+
+    spice_sdk_get_io_counts_func *get_io_counts;
+
+    spice_sdk_get_buttons_func *get_buttons;
+    spice_sdk_get_analogs_func *get_analogs;
+    spice_sdk_get_lights_func *get_lights;
+
+    spice_sdk_set_buttons_func *set_buttons;
+    spice_sdk_set_analogs_func *set_analogs;
+    spice_sdk_set_lights_func *set_lights;
+
+    spice_sdk_register_callback_func *register_callback;
+    spice_sdk_unregister_callback_func *unregister_callback;
+
+} SPICE_SDK_V1;
+
 typedef void (__cdecl spice_sdk_destroy_callback_func)(
     void
 );
 
 // init (v0.1 and up)
 //
-//   version: supply 0
+//   version: supply 0 for SPICE_SDK_V0, or 1 for SPICE_SDK_V1 (v1.0 and up)
+//            if init returns NOT_SUPPORTED for 1, the spice executable is older; fall back to 0
 //   destroy_callback: supply a function pointer that will be called when spice
 //                     is shutting down
-//   sdk_functions: supply a pointer to SPICE_SDK_V0; ensure size field is initialized
-//                  to sizeof(SPICE_SDK_V0) before calling this function
+//   sdk_functions: supply a pointer to SPICE_SDK_V0 (or SPICE_SDK_V1); ensure size field is
+//                  initialized to sizeof(SPICE_SDK_V0) (or sizeof(SPICE_SDK_V1)) before calling
+//                  this function
 
 typedef SPICE_SDK_STATUS_CODE (__cdecl spice_sdk_init_func)(
     uint32_t version,
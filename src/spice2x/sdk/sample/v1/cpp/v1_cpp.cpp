@@ -0,0 +1,128 @@
+#include <format>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <windows.h>
+
+#include "sdk/include/spicesdk.h"
+
+// this sample works with any game; it compares reading every light with the per-item v0
+// calls against one bulk v1 call, then follows light changes through a callback
+
+#define LOG_INFO(message) spice.v0.log(SPICE_SDK_LOG_LEVEL_INFO, "sample_v1_cpp", message)
+
+static SPICE_SDK_V1 spice = {};
+static SPICE_SDK_IO_COUNTS io_counts = {};
+static uint32_t light_callback_handle = 0;
+
+static spice_sdk_destroy_callback_func destroy_callback;
+static spice_sdk_io_callback_func light_callback;
+static std::jthread worker_thread;
+static void worker_thread_main(std::stop_token stop_token);
+
+SPICE_SDK_ENTRY_POINT
+spice_sdk_entry_point(
+    spice_sdk_init_func *init
+)
+{
+    // SPICE_SDK_V1 must be zeroed AND the size field (inside v0) must be set
+    spice.v0.size = sizeof(spice);
+
+    // NOT_SUPPORTED means this spice executable only knows v0
+    const auto status = init(1, destroy_callback, &spice);
+    if (status != SPICE_SDK_STATUS_SUCCESS) {
+        return 0;
+    }
+
+    LOG_INFO("plugin loaded");
+
+    if (spice.get_io_counts(&io_counts) != SPICE_SDK_STATUS_SUCCESS || io_counts.lights == 0) {
+        LOG_INFO("game has no lights");
+        return 1;
+    }
+
+    // benchmark on a worker thread, the entry point should return quickly
+    worker_thread = std::jthread(worker_thread_main);
+    return 1;
+}
+
+void
+__cdecl
+destroy_callback(
+    void
+)
+{
+    // the callback is already unregistered at this point, only the worker needs stopping
+    LOG_INFO("plugin unloading");
+    if (worker_thread.joinable()) {
+        worker_thread.request_stop();
+        worker_thread.join();
+    }
+}
+
+// called on the SDK callback thread; the first call contains every light
+void
+__cdecl
+light_callback(
+    SPICE_SDK_CALLBACK_TYPE type,
+    const SPICE_SDK_IO_CHANGE *changes,
+    uint32_t count,
+    void *context
+)
+{
+    static uint64_t calls = 0;
+    calls++;
+
+    // keep callbacks short: just log now and then
+    if (calls % 1000 == 1) {
+        LOG_INFO(std::format("light callback #{}: {} lights changed, first is light {} = {:.2f}",
+            calls, count, changes[0].id, changes[0].value).c_str());
+    }
+}
+
+static void benchmark_lights() {
+    constexpr int ROUNDS = 1000;
+    std::vector<float> values(io_counts.lights);
+
+    // v0: one call, and one lock of the SDK, per light
+    const auto v0_start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (uint32_t light = 0; light < io_counts.lights; light++) {
+            spice.v0.get_light(light, &values[light]);
+        }
+    }
+    const auto v0_end = std::chrono::steady_clock::now();
+
+    // v1: one call for all of them
+    for (int round = 0; round < ROUNDS; round++) {
+        spice.get_lights(0, io_counts.lights, values.data());
+    }
+    const auto v1_end = std::chrono::steady_clock::now();
+
+    const auto v0_us = std::chrono::duration<double, std::micro>(v0_end - v0_start).count() / ROUNDS;
+    const auto v1_us = std::chrono::duration<double, std::micro>(v1_end - v0_end).count() / ROUNDS;
+    LOG_INFO(std::format("reading {} lights: v0 per-item {:.1f} us, v1 bulk {:.1f} us ({:.1f}x)",
+        io_counts.lights, v0_us, v1_us, v1_us > 0 ? v0_us / v1_us : 0.0).c_str());
+}
+
+static void worker_thread_main(std::stop_token stop_token) {
+    benchmark_lights();
+
+    // from now on get notified instead of polling ourselves
+    const auto status = spice.register_callback(
+        SPICE_SDK_CALLBACK_LIGHTS_CHANGED, light_callback, nullptr, 16, &light_callback_handle);
+    if (status != SPICE_SDK_STATUS_SUCCESS) {
+        LOG_INFO("failed to register light callback");
+        return;
+    }
+
+    // repeat the benchmark every now and then, e.g. once the game is under load
+    while (!stop_token.stop_requested()) {
+        for (int i = 0; i < 300 && !stop_token.stop_requested(); i++) {
+            Sleep(100);
+        }
+        if (!stop_token.stop_requested()) {
+            benchmark_lights();
+        }
+    }
+}
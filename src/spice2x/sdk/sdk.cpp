@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <vector>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 
 #include "sdk.h"
 #include "avs/game.h"
@@ -31,6 +35,15 @@ static spice_sdk_clear_touch_func sdk_clear_touch;
 static spice_sdk_insert_card_func sdk_insert_card;
 static spice_sdk_set_keypad_func sdk_set_keypad;
 static spice_sdk_add_toast_func sdk_add_toast;
+static spice_sdk_get_io_counts_func sdk_get_io_counts;
+static spice_sdk_get_buttons_func sdk_get_buttons;
+static spice_sdk_get_analogs_func sdk_get_analogs;
+static spice_sdk_get_lights_func sdk_get_lights;
+static spice_sdk_set_buttons_func sdk_set_buttons;
+static spice_sdk_set_analogs_func sdk_set_analogs;
+static spice_sdk_set_lights_func sdk_set_lights;
+static spice_sdk_register_callback_func sdk_register_callback;
+static spice_sdk_unregister_callback_func sdk_unregister_callback;
 
 struct SdkModule {
     std::string dll;
@@ -53,6 +66,32 @@ static std::vector<Light> *lights;
 static std::mutex sdk_callback_registration_mutex;
 static std::vector<spice_sdk_destroy_callback_func *> callbacks_destroy;
 
+// I/O callbacks (v1), delivered on their own thread which only runs while any are registered
+struct SdkIoCallback {
+    uint32_t handle;
+    SPICE_SDK_CALLBACK_TYPE type;
+    spice_sdk_io_callback_func *callback;
+    void *context;
+    uint32_t interval_ms;
+
+    // set once the callback got the full state, after that it only sees changes
+    bool primed = false;
+};
+
+// the dispatch mutex is taken before the callbacks mutex, which is never held while waiting
+// for the global mutex
+static std::mutex sdk_io_callbacks_mutex;
+static std::mutex sdk_io_dispatch_mutex;
+static std::condition_variable sdk_io_callbacks_cv;
+static std::vector<SdkIoCallback> sdk_io_callbacks;
+static uint32_t sdk_io_callbacks_next_handle = 1;
+static std::thread sdk_io_thread;
+static bool sdk_io_thread_stop = false;
+static thread_local bool sdk_io_thread_current = false;
+
+static void sdk_io_thread_main();
+static void sdk_io_thread_shutdown();
+
 void register_sdk_hooks(std::string dll, HINSTANCE module) {
     sdk_modules_list.emplace_back(std::move(dll), module);
     sdk_modules_count += 1;
@@ -100,6 +139,9 @@ void fini_sdk_modules() {
         sdk_shutting_down = true;
     }
 
+    // I/O callbacks point into the DLLs, so they must be done before the DLLs are told to clean up
+    sdk_io_thread_shutdown();
+
     // call into destroy callback of each DLL
     // this may call back into SDK functions (e.g., for logging)
     // so we leave sdk_initialized as-is
@@ -132,7 +174,7 @@ sdk_init(
     }
 
     uint32_t size;
-    if (version != 0) {
+    if (version != 0 && version != 1) {
         log_warning("sdk", "sdk_init returning NOT_SUPPORTED due to invalid version: {}", version);
         return SPICE_SDK_STATUS_NOT_SUPPORTED;
     }
@@ -151,6 +193,10 @@ sdk_init(
         log_warning("sdk", "sdk_init returning TOO_SMALL due to size field of SPICE_SDK_V0 not being set");
         return SPICE_SDK_STATUS_TOO_SMALL;
     }
+    if (version == 1 && v0->size < RTL_SIZEOF_THROUGH_FIELD(SPICE_SDK_V1, unregister_callback)) {
+        log_warning("sdk", "sdk_init returning TOO_SMALL due to size field of SPICE_SDK_V1 not being set");
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
 
     // we are trusting the size passed in by the caller
     size = v0->size;
@@ -179,6 +225,21 @@ sdk_init(
     // end of 0.2
     // any newer minor iterations will need to check the size
 
+    if (version == 1) {
+        auto *v1 = reinterpret_cast<SPICE_SDK_V1 *>(sdk_functions);
+        v1->get_io_counts = sdk_get_io_counts;
+        v1->get_buttons = sdk_get_buttons;
+        v1->get_analogs = sdk_get_analogs;
+        v1->get_lights = sdk_get_lights;
+        v1->set_buttons = sdk_set_buttons;
+        v1->set_analogs = sdk_set_analogs;
+        v1->set_lights = sdk_set_lights;
+        v1->register_callback = sdk_register_callback;
+        v1->unregister_callback = sdk_unregister_callback;
+
+        // end of 1.0
+    }
+
     {
         // destroy callbacks are only called upon successful return from this routine
         std::lock_guard lock(sdk_callback_registration_mutex);
@@ -272,6 +333,28 @@ sdk_get_game_info(
     return SPICE_SDK_STATUS_SUCCESS;
 }
 
+static void apply_button_override(Button &button, bool pressed, float velocity) {
+    if (pressed) {
+        button.override_state = GameAPI::Buttons::BUTTON_PRESSED;
+        button.override_velocity = std::clamp(velocity, 0.f, 1.f);
+    }
+    button.override_enabled = pressed;
+}
+
+static void apply_analog_override(Analog &analog, bool override_active, float value) {
+    if (override_active) {
+        analog.override_state = std::clamp(value, 0.f, 1.f);
+    }
+    analog.override_enabled = override_active;
+}
+
+static void apply_light_override(Light &light, bool override_active, float value) {
+    if (override_active) {
+        light.override_state = std::clamp(value, 0.f, 1.f);
+    }
+    light.override_enabled = override_active;
+}
+
 SPICE_SDK_STATUS_CODE
 __cdecl
 sdk_get_button (
@@ -322,16 +405,8 @@ sdk_set_button (
     if (button_id >= buttons->size()) {
         return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
     }
-    if (pressed) {
-        velocity = std::clamp(velocity, 0.f, 1.f);
-    }
 
-    Button &button = (*buttons)[button_id];
-    if (pressed) {
-        button.override_state = pressed ? GameAPI::Buttons::BUTTON_PRESSED : GameAPI::Buttons::BUTTON_NOT_PRESSED;
-        button.override_velocity = velocity;
-    }
-    button.override_enabled = pressed;
+    apply_button_override((*buttons)[button_id], pressed, velocity);
     mdxf_poll(true);
     return SPICE_SDK_STATUS_SUCCESS;
 }
@@ -382,15 +457,8 @@ sdk_set_analog (
     if (analog_id >= analogs->size()) {
         return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
     }
-    if (override_active) {
-        value = std::clamp(value, 0.f, 1.f);
-    }
 
-    Analog &analog = (*analogs)[analog_id];
-    if (override_active) {
-        analog.override_state = value;
-    }
-    analog.override_enabled = override_active;
+    apply_analog_override((*analogs)[analog_id], override_active, value);
     mdxf_poll(true);
     return SPICE_SDK_STATUS_SUCCESS;
 }
@@ -440,15 +508,8 @@ sdk_set_light(
     if (light_id >= lights->size()) {
         return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
     }
-    if (override_active) {
-        value = std::clamp(value, 0.f, 1.f);
-    }
 
-    Light &light = (*lights)[light_id];
-    if (override_active) {
-        light.override_state = value;
-    }
-    light.override_enabled = override_active;
+    apply_light_override((*lights)[light_id], override_active, value);
     return SPICE_SDK_STATUS_SUCCESS;
 }
 
@@ -641,4 +702,479 @@ sdk_add_toast(
 }
 
 
-} // namespace sdk
\ No newline at end of file
+/*
+ * v1: bulk I/O
+ *
+ * each call takes the global lock once for the whole range instead of once per item, and
+ * writes trigger a single MDXF poll no matter how many overrides they touch
+ */
+
+static bool range_valid(uint32_t first_id, uint32_t count, size_t size) {
+    return count <= size && first_id <= size - count;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_get_io_counts(
+    SPICE_SDK_IO_COUNTS *counts
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!counts) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+
+    counts->buttons = buttons ? static_cast<uint32_t>(buttons->size()) : 0;
+    counts->analogs = analogs ? static_cast<uint32_t>(analogs->size()) : 0;
+    counts->lights = lights ? static_cast<uint32_t>(lights->size()) : 0;
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_get_buttons(
+    uint32_t first_id,
+    uint32_t count,
+    bool *pressed,
+    float *velocity
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!buttons) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    if (!range_valid(first_id, count, buttons->size())) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        Button &button = (*buttons)[first_id + i];
+        if (pressed) {
+            pressed[i] = (GameAPI::Buttons::getState(RI_MGR, button) == GameAPI::Buttons::BUTTON_PRESSED);
+        }
+        if (velocity) {
+            velocity[i] = GameAPI::Buttons::getVelocity(RI_MGR, button);
+        }
+    }
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_get_analogs(
+    uint32_t first_id,
+    uint32_t count,
+    float *values
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!analogs) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    if (!range_valid(first_id, count, analogs->size())) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+    if (!values) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_3;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = GameAPI::Analogs::getState(RI_MGR, (*analogs)[first_id + i]);
+    }
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_get_lights(
+    uint32_t first_id,
+    uint32_t count,
+    float *values
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!lights) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    if (!range_valid(first_id, count, lights->size())) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+    if (!values) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_3;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = GameAPI::Lights::readLight(RI_MGR, (*lights)[first_id + i]);
+    }
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_set_buttons(
+    const SPICE_SDK_BUTTON_OVERRIDE *overrides,
+    uint32_t count
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!buttons) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0 || !overrides) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (overrides[i].button_id >= buttons->size()) {
+            return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const auto &entry = overrides[i];
+        apply_button_override((*buttons)[entry.button_id], entry.pressed, entry.velocity);
+    }
+    mdxf_poll(true);
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_set_analogs(
+    const SPICE_SDK_VALUE_OVERRIDE *overrides,
+    uint32_t count
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!analogs) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0 || !overrides) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (overrides[i].id >= analogs->size()) {
+            return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const auto &entry = overrides[i];
+        apply_analog_override((*analogs)[entry.id], entry.override_active, entry.value);
+    }
+    mdxf_poll(true);
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_set_lights(
+    const SPICE_SDK_VALUE_OVERRIDE *overrides,
+    uint32_t count
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (!sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    if (!lights) {
+        return SPICE_SDK_STATUS_NOT_INITIALIZED;
+    }
+    if (count == 0 || !overrides) {
+        return SPICE_SDK_STATUS_TOO_SMALL;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (overrides[i].id >= lights->size()) {
+            return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const auto &entry = overrides[i];
+        apply_light_override((*lights)[entry.id], entry.override_active, entry.value);
+    }
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+/*
+ * v1: I/O callbacks
+ */
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_register_callback(
+    SPICE_SDK_CALLBACK_TYPE type,
+    spice_sdk_io_callback_func *callback,
+    void *context,
+    uint32_t interval_ms,
+    uint32_t *handle
+)
+{
+    std::shared_lock lock(sdk_global_mutex);
+    if (sdk_shutting_down || !sdk_initialized) {
+        return SPICE_SDK_STATUS_TOO_LATE;
+    }
+
+    switch (type) {
+        case SPICE_SDK_CALLBACK_POLL:
+        case SPICE_SDK_CALLBACK_BUTTONS_CHANGED:
+        case SPICE_SDK_CALLBACK_ANALOGS_CHANGED:
+        case SPICE_SDK_CALLBACK_LIGHTS_CHANGED:
+            break;
+        default:
+            return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+    if (!callback) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_2;
+    }
+    if (interval_ms < 1 || interval_ms > 1000) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_4;
+    }
+    if (!handle) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_5;
+    }
+
+    std::lock_guard callbacks_lock(sdk_io_callbacks_mutex);
+    *handle = sdk_io_callbacks_next_handle++;
+    sdk_io_callbacks.push_back(SdkIoCallback {
+        .handle = *handle,
+        .type = type,
+        .callback = callback,
+        .context = context,
+        .interval_ms = interval_ms,
+    });
+
+    // start the thread with the first callback, or wake it up to pick up a shorter interval
+    if (!sdk_io_thread.joinable()) {
+        sdk_io_thread_stop = false;
+        sdk_io_thread = std::thread(sdk_io_thread_main);
+    } else {
+        sdk_io_callbacks_cv.notify_all();
+    }
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+SPICE_SDK_STATUS_CODE
+__cdecl
+sdk_unregister_callback(
+    uint32_t handle
+)
+{
+    // wait for a running dispatch to finish, unless we are called from inside of it
+    std::unique_lock<std::mutex> dispatch_lock;
+    if (!sdk_io_thread_current) {
+        dispatch_lock = std::unique_lock(sdk_io_dispatch_mutex);
+    }
+
+    std::lock_guard callbacks_lock(sdk_io_callbacks_mutex);
+    const auto it = std::find_if(sdk_io_callbacks.begin(), sdk_io_callbacks.end(),
+            [handle](const SdkIoCallback &entry) { return entry.handle == handle; });
+    if (it == sdk_io_callbacks.end()) {
+        return SPICE_SDK_STATUS_INVALID_ARGUMENT_1;
+    }
+    sdk_io_callbacks.erase(it);
+    return SPICE_SDK_STATUS_SUCCESS;
+}
+
+static void sdk_io_thread_shutdown() {
+    {
+        std::lock_guard lock(sdk_io_callbacks_mutex);
+        sdk_io_thread_stop = true;
+        sdk_io_callbacks.clear();
+    }
+    sdk_io_callbacks_cv.notify_all();
+
+    // registration is closed by now, so nothing can restart the thread
+    if (sdk_io_thread.joinable()) {
+        log_info("sdk", "stopping callback thread...");
+        sdk_io_thread.join();
+    }
+}
+
+// appends an entry for every item that differs from the previous poll, or every item when `all`
+template<typename T, typename F>
+static void collect_changes(
+    const std::vector<T> &current,
+    const std::vector<T> &previous,
+    bool all,
+    std::vector<SPICE_SDK_IO_CHANGE> &changes,
+    F make_change)
+{
+    changes.clear();
+    for (size_t i = 0; i < current.size(); i++) {
+        if (all || i >= previous.size() || !(current[i] == previous[i])) {
+            changes.push_back(make_change(static_cast<uint32_t>(i), current[i]));
+        }
+    }
+}
+
+static void sdk_io_thread_main() {
+    sdk_io_thread_current = true;
+
+    struct ButtonState {
+        bool pressed;
+        float velocity;
+
+        bool operator==(const ButtonState &other) const {
+            return pressed == other.pressed && velocity == other.velocity;
+        }
+    };
+
+    // all buffers are reused between polls, so a steady state poll does not allocate
+    std::vector<SdkIoCallback> active;
+    std::vector<ButtonState> button_states, button_states_previous;
+    std::vector<float> analog_states, analog_states_previous;
+    std::vector<float> light_states, light_states_previous;
+    std::vector<SPICE_SDK_IO_CHANGE> changes[4], changes_all[4];
+
+    auto next_poll = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock lock(sdk_io_callbacks_mutex);
+            if (sdk_io_thread_stop) {
+                break;
+            }
+
+            // sleep for the shortest interval of all callbacks; registrations may shorten it
+            uint32_t interval_ms = 1000;
+            for (const auto &entry : sdk_io_callbacks) {
+                interval_ms = std::min(interval_ms, entry.interval_ms);
+            }
+            const auto deadline = next_poll + std::chrono::milliseconds(interval_ms);
+            if (sdk_io_callbacks_cv.wait_until(lock, deadline, [] { return sdk_io_thread_stop; })) {
+                break;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            next_poll = (now - deadline < std::chrono::milliseconds(interval_ms)) ? deadline : now;
+        }
+
+        // held until all callbacks ran, unregister_callback waits on it
+        std::lock_guard dispatch_lock(sdk_io_dispatch_mutex);
+        {
+            std::lock_guard lock(sdk_io_callbacks_mutex);
+            if (sdk_io_thread_stop) {
+                break;
+            }
+            active.assign(sdk_io_callbacks.begin(), sdk_io_callbacks.end());
+            for (auto &entry : sdk_io_callbacks) {
+                entry.primed = true;
+            }
+        }
+
+        bool wanted[4] {};
+        bool wanted_all[4] {};
+        for (const auto &entry : active) {
+            wanted[entry.type] = true;
+            wanted_all[entry.type] |= !entry.primed;
+        }
+
+        // read everything needed under a single lock, callbacks may call back into the SDK
+        {
+            std::shared_lock lock(sdk_global_mutex);
+            if (!sdk_initialized) {
+                continue;
+            }
+            if (wanted[SPICE_SDK_CALLBACK_BUTTONS_CHANGED] && buttons) {
+                button_states.resize(buttons->size());
+                for (size_t i = 0; i < buttons->size(); i++) {
+                    auto &button = (*buttons)[i];
+                    button_states[i].pressed =
+                        GameAPI::Buttons::getState(RI_MGR, button) == GameAPI::Buttons::BUTTON_PRESSED;
+                    button_states[i].velocity = GameAPI::Buttons::getVelocity(RI_MGR, button);
+                }
+            }
+            if (wanted[SPICE_SDK_CALLBACK_ANALOGS_CHANGED] && analogs) {
+                analog_states.resize(analogs->size());
+                for (size_t i = 0; i < analogs->size(); i++) {
+                    analog_states[i] = GameAPI::Analogs::getState(RI_MGR, (*analogs)[i]);
+                }
+            }
+            if (wanted[SPICE_SDK_CALLBACK_LIGHTS_CHANGED] && lights) {
+                light_states.resize(lights->size());
+                for (size_t i = 0; i < lights->size(); i++) {
+                    light_states[i] = GameAPI::Lights::readLight(RI_MGR, (*lights)[i]);
+                }
+            }
+        }
+
+        // changes since the last poll for primed callbacks, the full state for new ones
+        auto collect = [&](SPICE_SDK_CALLBACK_TYPE type, const auto &current, const auto &previous,
+                auto make_change) {
+            if (wanted[type]) {
+                collect_changes(current, previous, false, changes[type], make_change);
+            }
+            if (wanted_all[type]) {
+                collect_changes(current, previous, true, changes_all[type], make_change);
+            }
+        };
+        collect(SPICE_SDK_CALLBACK_BUTTONS_CHANGED, button_states, button_states_previous,
+                [](uint32_t id, const ButtonState &state) {
+                    return SPICE_SDK_IO_CHANGE { id, state.pressed, state.velocity };
+                });
+        collect(SPICE_SDK_CALLBACK_ANALOGS_CHANGED, analog_states, analog_states_previous,
+                [](uint32_t id, float value) {
+                    return SPICE_SDK_IO_CHANGE { id, false, value };
+                });
+        collect(SPICE_SDK_CALLBACK_LIGHTS_CHANGED, light_states, light_states_previous,
+                [](uint32_t id, float value) {
+                    return SPICE_SDK_IO_CHANGE { id, false, value };
+                });
+        if (wanted[SPICE_SDK_CALLBACK_BUTTONS_CHANGED]) {
+            button_states_previous.swap(button_states);
+        }
+        if (wanted[SPICE_SDK_CALLBACK_ANALOGS_CHANGED]) {
+            analog_states_previous.swap(analog_states);
+        }
+        if (wanted[SPICE_SDK_CALLBACK_LIGHTS_CHANGED]) {
+            light_states_previous.swap(light_states);
+        }
+
+        // a new callback gets the full state first, after that only polls with changes are reported
+        for (const auto &entry : active) {
+            if (entry.type == SPICE_SDK_CALLBACK_POLL) {
+                entry.callback(entry.type, nullptr, 0, entry.context);
+                continue;
+            }
+            const auto &list = entry.primed ? changes[entry.type] : changes_all[entry.type];
+            if (!list.empty()) {
+                entry.callback(entry.type, list.data(), static_cast<uint32_t>(list.size()), entry.context);
+            }
+        }
+    }
+}
+
+
+} // namespace sdk
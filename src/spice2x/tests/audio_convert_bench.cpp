@@ -0,0 +1,67 @@
+/*
+ * hooks/audio/buffer: sample conversion throughput
+ *
+ * before: every sample went through a double temp buffer and back, one at a time.
+ * after: convert_samples converts pairwise with SIMD kernels and applies the gain on the way.
+ */
+
+#include <vector>
+
+#include "hooks/audio/buffer.h"
+#include "test.h"
+
+namespace {
+
+    // the old two pass conversion through a double buffer
+    template<typename S, typename D>
+    void convert_before(const S *source, D *dest, std::vector<double> &temp, size_t count, float gain) {
+        if (temp.size() < count) {
+            temp.resize(count);
+        }
+        for (size_t i = 0; i < count; i++) {
+            temp[i] = convert_number_to_double<S>(source[i]) * gain;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if constexpr (std::is_floating_point_v<D>) {
+                dest[i] = static_cast<D>(temp[i]);
+            } else {
+                dest[i] = convert_double_to_number<D>(temp[i]);
+            }
+        }
+    }
+
+    template<typename S, typename D>
+    void run(const char *name, SampleType source_type, SampleType dest_type, float gain) {
+
+        // one 10 ms stereo period at 48 kHz
+        constexpr size_t count = 960;
+        constexpr size_t iterations = 200'000;
+        std::vector<S> source(count);
+        std::vector<D> dest(count);
+        std::vector<double> temp;
+        for (size_t i = 0; i < count; i++) {
+            source[i] = static_cast<S>(i % 200);
+        }
+
+        const auto before = test::time_ns(iterations, [&](size_t) {
+            convert_before<S, D>(source.data(), dest.data(), temp, count, gain);
+            test::keep(dest[0]);
+        });
+        const auto after = test::time_ns(iterations, [&](size_t) {
+            convert_samples(source.data(), source_type, dest.data(), dest_type, count, gain);
+            test::keep(dest[0]);
+        });
+        printf("%-28s before %7.2f ns/sample  after %6.3f ns/sample  (%.1fx)\n",
+                name, before / count, after / count, before / after);
+    }
+}
+
+int main() {
+    run<int16_t, float>("s16 -> f32", SampleType::SINT_16, SampleType::FLOAT_32, 1.f);
+    run<float, int16_t>("f32 -> s16", SampleType::FLOAT_32, SampleType::SINT_16, 1.f);
+    run<float, int32_t>("f32 -> s32", SampleType::FLOAT_32, SampleType::SINT_32, 1.f);
+    run<int32_t, float>("s32 -> f32", SampleType::SINT_32, SampleType::FLOAT_32, 1.f);
+    run<int16_t, int16_t>("s16 -> s16, gain 2", SampleType::SINT_16, SampleType::SINT_16, 2.f);
+    run<float, float>("f32 -> f32, gain 2", SampleType::FLOAT_32, SampleType::FLOAT_32, 2.f);
+    return 0;
+}
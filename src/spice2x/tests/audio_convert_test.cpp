@@ -0,0 +1,238 @@
+/*
+ * hooks/audio/buffer: convert_samples against a double precision reference, and the signal to
+ * noise ratio of the conversions a game stream actually goes through.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "hooks/audio/buffer.h"
+#include "test.h"
+
+namespace {
+
+    const SampleType TYPES[] = {
+        SampleType::SINT_16,
+        SampleType::SINT_24,
+        SampleType::SINT_32,
+        SampleType::FLOAT_32,
+        SampleType::FLOAT_64,
+    };
+
+    bool is_float(SampleType type) {
+        return type == SampleType::FLOAT_32 || type == SampleType::FLOAT_64;
+    }
+
+    double scale(SampleType type) {
+        switch (type) {
+            case SampleType::SINT_16:
+                return conversion_limits<int16_t>::absolute_max_value();
+            case SampleType::SINT_24:
+                return conversion_limits<int24_t>::absolute_max_value();
+            case SampleType::SINT_32:
+                return conversion_limits<int32_t>::absolute_max_value();
+            default:
+                return 1.0;
+        }
+    }
+
+    double load(const uint8_t *buffer, SampleType type, size_t i) {
+        const auto p = buffer + i * sample_type_size(type);
+        switch (type) {
+            case SampleType::SINT_16: {
+                int16_t v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            case SampleType::SINT_24: {
+                int24_t v;
+                memcpy(&v, p, sizeof(v));
+                return v.as_int();
+            }
+            case SampleType::SINT_32: {
+                int32_t v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            case SampleType::FLOAT_32: {
+                float v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            case SampleType::FLOAT_64: {
+                double v;
+                memcpy(&v, p, sizeof(v));
+                return v;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    void store(uint8_t *buffer, SampleType type, size_t i, double v) {
+        const auto p = buffer + i * sample_type_size(type);
+        switch (type) {
+            case SampleType::SINT_16: {
+                const auto s = static_cast<int16_t>(v);
+                memcpy(p, &s, sizeof(s));
+                break;
+            }
+            case SampleType::SINT_24: {
+                int24_t s(static_cast<int>(v));
+                memcpy(p, &s, sizeof(s));
+                break;
+            }
+            case SampleType::SINT_32: {
+                const auto s = static_cast<int32_t>(v);
+                memcpy(p, &s, sizeof(s));
+                break;
+            }
+            case SampleType::FLOAT_32: {
+                const auto s = static_cast<float>(v);
+                memcpy(p, &s, sizeof(s));
+                break;
+            }
+            case SampleType::FLOAT_64:
+                memcpy(p, &v, sizeof(v));
+                break;
+            default:
+                break;
+        }
+    }
+
+    // the expected sample in destination units: scaled, rounded half away from zero, saturated
+    double reference(double source, SampleType source_type, SampleType dest_type, float gain) {
+        double v = source / scale(source_type) * gain;
+        if (is_float(dest_type)) {
+            return gain != 1.f ? std::clamp(v, -1.0, 1.0) : v;
+        }
+        const double max = scale(dest_type) - 1.0;
+        return std::clamp((double) std::llround(v * scale(dest_type)), -max - 1.0, max);
+    }
+
+    std::vector<uint8_t> random_samples(SampleType type, size_t count, std::mt19937 &rng) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        std::vector<uint8_t> buffer(count * sample_type_size(type));
+        for (size_t i = 0; i < count; i++) {
+            const auto v = dist(rng);
+            store(buffer.data(), type, i, is_float(type) ? v : std::round(v * (scale(type) - 1.0)));
+        }
+        return buffer;
+    }
+
+    // every type pair with counts around the SIMD block widths, out of place and in place
+    void test_against_reference() {
+        std::mt19937 rng(1234);
+        for (auto source_type : TYPES) {
+            for (auto dest_type : TYPES) {
+                for (float gain : { 1.f, 0.5f, 2.5f }) {
+                    for (size_t count : { 1, 3, 4, 7, 8, 9, 15, 16, 17, 33, 1000 }) {
+                        auto source = random_samples(source_type, count, rng);
+                        const auto source_size = sample_type_size(source_type);
+                        const auto dest_size = sample_type_size(dest_type);
+
+                        std::vector<uint8_t> dest(count * dest_size);
+                        std::vector<uint8_t> in_place(count * std::max(source_size, dest_size));
+                        memcpy(in_place.data(), source.data(), source.size());
+                        convert_samples(source.data(), source_type, dest.data(), dest_type, count, gain);
+                        convert_samples(in_place.data(), source_type, in_place.data(), dest_type, count, gain);
+
+                        // integer results may be one step off where the kernel rounds in float,
+                        // float results by the precision of a float. float sources are scaled
+                        // in float, which only resolves 24 bits of a 32-bit destination
+                        double tolerance = is_float(dest_type) ? 1e-6 : 1.0;
+                        if (source_type == SampleType::FLOAT_32 && !is_float(dest_type)) {
+                            tolerance = std::max(tolerance, scale(dest_type) / (1 << 23));
+                        }
+                        for (size_t i = 0; i < count; i++) {
+                            const auto expected = reference(load(source.data(), source_type, i),
+                                    source_type, dest_type, gain);
+                            const auto actual = load(dest.data(), dest_type, i);
+                            if (std::fabs(actual - expected) > tolerance) {
+                                fprintf(stderr, "%s -> %s gain %g count %zu [%zu]: %f != %f\n",
+                                        sample_type_str(source_type), sample_type_str(dest_type),
+                                        gain, count, i, actual, expected);
+                                test::failures()++;
+                                break;
+                            }
+                            CHECK_EQ(load(in_place.data(), dest_type, i), actual);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // full scale and beyond saturate instead of wrapping
+    void test_saturation() {
+        const double values[] = { -4.0, -1.0, 1.0, 4.0 };
+        int16_t s16[4];
+        convert_samples(values, SampleType::FLOAT_64, s16, SampleType::SINT_16, 4);
+        CHECK_EQ(s16[0], -32768);
+        CHECK_EQ(s16[1], -32768);
+        CHECK_EQ(s16[2], 32767);
+        CHECK_EQ(s16[3], 32767);
+
+        int32_t s32[4] = { INT32_MIN, -1, 1, INT32_MAX };
+        convert_samples(s32, SampleType::SINT_32, s32, SampleType::SINT_32, 4, 4.f);
+        CHECK_EQ(s32[0], INT32_MIN);
+        CHECK_EQ(s32[1], -4);
+        CHECK_EQ(s32[2], 4);
+        CHECK_EQ(s32[3], INT32_MAX);
+    }
+
+    double snr_db(const std::vector<double> &signal, const std::vector<double> &actual) {
+        double power = 0, noise = 0;
+        for (size_t i = 0; i < signal.size(); i++) {
+            power += signal[i] * signal[i];
+            noise += (actual[i] - signal[i]) * (actual[i] - signal[i]);
+        }
+        return noise == 0 ? INFINITY : 10.0 * std::log10(power / noise);
+    }
+
+    // a -1 dBFS sine through the integer formats must keep the SNR of the format
+    void test_snr() {
+        const size_t count = 48000;
+        std::vector<double> signal(count);
+        for (size_t i = 0; i < count; i++) {
+            signal[i] = 0.891 * std::sin(2.0 * M_PI * 997.0 * i / 48000.0);
+        }
+
+        const struct {
+            SampleType type;
+            double min_db;
+        } formats[] = {
+            { SampleType::SINT_16, 96.0 },
+            { SampleType::SINT_24, 144.0 },
+            { SampleType::SINT_32, 140.0 },
+            { SampleType::FLOAT_32, 140.0 },
+        };
+        for (auto &format : formats) {
+            std::vector<uint8_t> buffer(count * sizeof(double));
+            std::vector<double> result(count);
+            convert_samples(signal.data(), SampleType::FLOAT_64, buffer.data(), format.type, count);
+            convert_samples(buffer.data(), format.type, result.data(), SampleType::FLOAT_64, count);
+            const auto snr = snr_db(signal, result);
+            printf("%s round trip: %.1f dB SNR\n", sample_type_str(format.type), snr);
+            CHECK(snr >= format.min_db);
+        }
+
+        // widening is lossless
+        std::vector<int16_t> s16(count);
+        std::vector<float> f32(count);
+        std::vector<int16_t> back(count);
+        convert_samples(signal.data(), SampleType::FLOAT_64, s16.data(), SampleType::SINT_16, count);
+        convert_samples(s16.data(), SampleType::SINT_16, f32.data(), SampleType::FLOAT_32, count);
+        convert_samples(f32.data(), SampleType::FLOAT_32, back.data(), SampleType::SINT_16, count);
+        CHECK(s16 == back);
+    }
+}
+
+int main() {
+    test_against_reference();
+    test_saturation();
+    test_snr();
+    return test::result();
+}
@@ -0,0 +1,107 @@
+/*
+ * hooks/audio/telemetry: several sources recording into one stream from different threads at
+ * once must neither lose counts nor mix up each other's callback periods.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "hooks/audio/telemetry.h"
+#include "test.h"
+
+namespace telemetry = hooks::audio::telemetry;
+
+namespace {
+
+    // two clients of one stream with different periods, each recording callbacks on its own
+    // thread while a third thread queries the fill level of both
+    void test_concurrent_sources() {
+        constexpr uint64_t fast_callbacks = 200'000;
+        constexpr uint64_t slow_callbacks = 20'000;
+        constexpr uint64_t fill_queries = 300'000;
+
+        telemetry::Source fast(telemetry::Stream::Wasapi);
+        telemetry::Source slow(telemetry::Stream::Wasapi);
+        telemetry::configure(fast, 1000, 480);
+        telemetry::configure(slow, 10000, 4800);
+
+        // timestamps are synthetic, so the measured periods are exact
+        std::thread fast_thread([&] {
+            for (uint64_t i = 1; i <= fast_callbacks; i++) {
+                telemetry::record_callback(fast, i * 1'000'000);
+                telemetry::record_processing(fast, 0, 50'000);
+            }
+        });
+        std::thread slow_thread([&] {
+            for (uint64_t i = 1; i <= slow_callbacks; i++) {
+                telemetry::record_callback(slow, i * 10'000'000);
+                telemetry::record_processing(slow, 0, 50'000);
+            }
+        });
+        std::thread fill_thread([&] {
+            for (uint64_t i = 0; i < fill_queries; i++) {
+                telemetry::record_fill(i & 1 ? fast : slow, i & 1 ? 240 : 4799);
+            }
+        });
+        fast_thread.join();
+        slow_thread.join();
+        fill_thread.join();
+
+        const auto snap = telemetry::snapshot(telemetry::Stream::Wasapi);
+        CHECK(snap.active);
+        CHECK_EQ(snap.callbacks, fast_callbacks + slow_callbacks);
+        CHECK_EQ(snap.fill_samples, fill_queries);
+        CHECK_EQ(snap.fill[5], fill_queries / 2);
+        CHECK_EQ(snap.fill[9], fill_queries / 2);
+        CHECK_EQ(snap.underruns, (uint64_t) 0);
+
+        // neither source is ever late against its own period, and no interval is cut short by
+        // the other client's callbacks
+        CHECK_EQ(snap.missed_deadlines, (uint64_t) 0);
+        CHECK_EQ(snap.period_max_us, (uint32_t) 10000);
+        CHECK(snap.period_p50_us >= 1000 && snap.period_p50_us < 1250);
+        CHECK(snap.period_p99_us >= 10000);
+        CHECK(snap.processing_p50_us >= 50 && snap.processing_p50_us < 63);
+        CHECK_EQ(snap.processing_max_us, (uint32_t) 50);
+    }
+
+    void test_deadlines_and_underruns() {
+        telemetry::Source source(telemetry::Stream::WaveOut);
+        telemetry::configure(source, 10000, 3);
+
+        // no underrun before the stream is running
+        telemetry::record_fill(source, 0);
+        telemetry::record_callback(source, 1'000'000);
+        telemetry::record_callback(source, 11'000'000);
+        telemetry::record_callback(source, 31'000'000);
+        telemetry::record_processing(source, 0, 12'000'000);
+        telemetry::record_fill(source, 0);
+        telemetry::record_fill(source, 3);
+
+        const auto snap = telemetry::snapshot(telemetry::Stream::WaveOut);
+        CHECK_EQ(snap.callbacks, (uint64_t) 3);
+        CHECK_EQ(snap.missed_deadlines, (uint64_t) 2);
+        CHECK_EQ(snap.underruns, (uint64_t) 1);
+        CHECK_EQ(snap.fill[0], (uint64_t) 2);
+        CHECK_EQ(snap.fill[9], (uint64_t) 1);
+        CHECK_EQ(snap.period_max_us, (uint32_t) 20000);
+        CHECK_EQ(snap.period_us, (uint32_t) 10000);
+    }
+
+    void test_buckets() {
+        CHECK_EQ(telemetry::timing_bucket_limit(0), (uint32_t) 0);
+        CHECK_EQ(telemetry::timing_bucket_limit(3), (uint32_t) 3);
+        CHECK_EQ(telemetry::timing_bucket_limit(telemetry::TIMING_BUCKETS - 1), UINT32_MAX);
+        for (size_t bucket = 1; bucket < telemetry::TIMING_BUCKETS; bucket++) {
+            CHECK(telemetry::timing_bucket_limit(bucket) > telemetry::timing_bucket_limit(bucket - 1));
+        }
+        CHECK(!telemetry::snapshot(telemetry::Stream::Asio).active);
+    }
+}
+
+int main() {
+    test_concurrent_sources();
+    test_deadlines_and_underruns();
+    test_buckets();
+    return test::result();
+}
@@ -0,0 +1,81 @@
+/*
+ * avs/automap_dump: cost of capturing a property on the game thread, and of the worker
+ * appending it to the dump.
+ *
+ * before: the hook had AVS write the property as XML, parsed it with tinyxml, pretty printed
+ *         it and wrote it to the log file. AVS' writer is stood in for by print_xml
+ * after:  the hook copies the binary property into the queue, the worker appends it
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "avs/automap_dump.h"
+#include "easrv/kbin.h"
+#include "external/tinyxml2/tinyxml2.h"
+#include "util/rc4.h"
+#include "test.h"
+
+#include "easrv/responses/op2_common_get_music_info.h"
+#include "easrv/responses/pcbtracker_alive.h"
+
+using namespace avs::automap;
+
+// see kbin_test.cpp
+static uint8_t EAMUSE_KEY[] = {
+    0x27, 0x16, 0xde, 0x9a, 0x77, 0xb5, 0xa9, 0x5d,
+    0x34, 0x41, 0xac, 0x06, 0xd3, 0x93, 0x50, 0x81,
+};
+
+static void run(const char *name, const unsigned char *payload, size_t size, size_t iterations) {
+    std::vector<uint8_t> data(payload, payload + size);
+    util::RC4(EAMUSE_KEY, sizeof(EAMUSE_KEY)).crypt(data.data(), data.size());
+    kbin::Document doc;
+    kbin::decode(data.data(), data.size(), doc);
+
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto xml_path = directory / "spice_automap_bench.xml";
+    const auto dump_path = (directory / "spice_automap_bench.bin").string();
+    std::filesystem::remove(xml_path);
+    std::filesystem::remove(dump_path);
+    std::filesystem::remove(dump_index_path(dump_path));
+
+    std::ofstream log(xml_path, std::ios::binary);
+    const auto before = test::time_ns(iterations, [&](size_t) {
+        tinyxml2::XMLPrinter avs_writer;
+        kbin::print_xml(doc, avs_writer);
+        tinyxml2::XMLDocument document;
+        document.Parse(avs_writer.CStr());
+        tinyxml2::XMLPrinter pretty;
+        document.Print(&pretty);
+        log << pretty.CStr() << '\n';
+        log.flush();
+    });
+
+    std::vector<DumpRecord> queue;
+    queue.reserve(iterations);
+    const auto hook = test::time_ns(iterations, [&](size_t i) {
+        queue.push_back(DumpRecord { .timestamp = i, .format = RecordFormat::KBin, .data = data });
+    });
+
+    DumpWriter writer;
+    writer.open(dump_path);
+    const auto worker = test::time_ns(iterations, [&](size_t i) {
+        writer.append(queue[i]);
+        writer.flush();
+    });
+
+    printf("%-28s before %9.2f us  hook %7.2f us  worker %7.2f us (%5.0f MB/s)\n", name,
+            before / 1000.0, hook / 1000.0, worker / 1000.0, size * 1000.0 / worker);
+
+    std::filesystem::remove(xml_path);
+    std::filesystem::remove(dump_path);
+    std::filesystem::remove(dump_index_path(dump_path));
+}
+
+int main() {
+    run("op2_common_get_music_info", OP2_COMMON_GET_MUSIC_INFO_BIN, OP2_COMMON_GET_MUSIC_INFO_BIN_LEN, 200);
+    run("pcbtracker_alive", PCBTRACKER_ALIVE_BIN, PCBTRACKER_ALIVE_BIN_LEN, 50'000);
+    return 0;
+}
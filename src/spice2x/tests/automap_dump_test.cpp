@@ -0,0 +1,230 @@
+/*
+ * avs/automap_dump: records round trip through the dump and its index, dumps with a missing,
+ * short or disagreeing index or cut off anywhere stay readable up to the last complete record,
+ * and records render as the old pretty printed text.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "avs/automap_dump.h"
+#include "easrv/kbin.h"
+#include "test.h"
+
+using namespace avs::automap;
+
+namespace {
+
+    std::filesystem::path DIRECTORY;
+
+    std::string path_for(const char *name) {
+        return (DIRECTORY / name).string();
+    }
+
+    std::vector<uint8_t> text_bytes(const std::string &text) {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    std::vector<uint8_t> property(unsigned value) {
+        kbin::Document doc;
+        const auto root = doc.add(kbin::NONE, "response");
+        doc.add_value(doc.add(root, "pcbtracker"), "expire", kbin::Type::U32, value);
+        std::vector<uint8_t> out;
+        kbin::encode(doc, out);
+        return out;
+    }
+
+    std::vector<DumpRecord> sample_records() {
+        std::vector<DumpRecord> records;
+        for (unsigned i = 0; i < 20; i++) {
+            DumpRecord record;
+            record.timestamp = 1700000000000ULL + i;
+            if (i % 5 == 4) {
+                record.format = RecordFormat::Text;
+                record.data = text_bytes("{\"call\": " + std::to_string(i) + "}");
+            } else {
+                record.data = property(i);
+            }
+            records.push_back(std::move(record));
+        }
+
+        // an empty record is legal
+        records.push_back(DumpRecord { .timestamp = 1, .format = RecordFormat::Text, .data = {} });
+        return records;
+    }
+
+    std::string write_dump(const char *name, const std::vector<DumpRecord> &records) {
+        const auto path = path_for(name);
+        DumpWriter writer;
+        CHECK(writer.open(path));
+        for (auto &record : records) {
+            CHECK(writer.append(record));
+        }
+        writer.flush();
+        return path;
+    }
+
+    std::vector<DumpRecord> read_all(const std::string &path, bool *ok = nullptr) {
+        std::vector<DumpRecord> records;
+        const bool read = dump_read(path, [&records](const DumpRecord &record) {
+            records.push_back(record);
+        });
+        if (ok) {
+            *ok = read;
+        }
+        return records;
+    }
+
+    bool same(const std::vector<DumpRecord> &a, const std::vector<DumpRecord> &b, size_t count) {
+        if (a.size() < count || b.size() < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (a[i].timestamp != b[i].timestamp || a[i].format != b[i].format || a[i].data != b[i].data) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<char> file_bytes(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void put_file(const std::string &path, const char *data, size_t size) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data, size);
+    }
+
+    void test_round_trip() {
+        const auto records = sample_records();
+        const auto path = write_dump("round_trip.bin", records);
+        bool ok = false;
+        const auto back = read_all(path, &ok);
+        CHECK(ok);
+        CHECK_EQ(back.size(), records.size());
+        CHECK(same(back, records, records.size()));
+
+        // never overwrites
+        DumpWriter again;
+        CHECK(!again.open(path));
+        std::filesystem::remove(path);
+        CHECK(!again.open(path));
+    }
+
+    void test_damaged_index() {
+        const auto records = sample_records();
+        const auto path = write_dump("index.bin", records);
+        const auto index = file_bytes(dump_index_path(path));
+
+        // missing and short: the rest is found by walking the record headers
+        std::filesystem::remove(dump_index_path(path));
+        CHECK(same(read_all(path), records, records.size()));
+        CHECK_EQ(read_all(path).size(), records.size());
+        for (size_t entries = 0; entries <= records.size(); entries++) {
+            put_file(dump_index_path(path), index.data(), entries * 16 + (entries % 2) * 7);
+            const auto back = read_all(path);
+            CHECK_EQ(back.size(), records.size());
+            CHECK(same(back, records, records.size()));
+        }
+
+        // an entry that disagrees with the dump stops the index there, not the reading
+        auto bad = index;
+        bad[5 * 16] ^= 0x40;
+        put_file(dump_index_path(path), bad.data(), bad.size());
+        CHECK(same(read_all(path), records, records.size()));
+        CHECK_EQ(read_all(path).size(), records.size());
+    }
+
+    void test_truncated() {
+        const auto records = sample_records();
+        const auto path = write_dump("truncated.bin", records);
+        const auto dump = file_bytes(path);
+
+        // offsets where each record ends
+        std::vector<size_t> ends;
+        size_t offset = 16;
+        for (auto &record : records) {
+            offset += 16 + record.data.size();
+            ends.push_back(offset);
+        }
+        CHECK_EQ(offset, dump.size());
+
+        for (size_t length = 0; length < dump.size(); length++) {
+            put_file(path, dump.data(), length);
+            bool ok = false;
+            const auto back = read_all(path, &ok);
+            CHECK_EQ(ok, length >= 16);
+            size_t complete = 0;
+            while (complete < ends.size() && ends[complete] <= length) {
+                complete++;
+            }
+            CHECK_EQ(back.size(), complete);
+            CHECK(same(back, records, complete));
+        }
+
+        // not a dump at all
+        put_file(path, "AUTOMAP\0\2\0\0\0\0\0\0\0", 16);
+        bool ok = true;
+        read_all(path, &ok);
+        CHECK(!ok);
+        read_all(path_for("missing.bin"), &ok);
+        CHECK(!ok);
+    }
+
+    void test_text() {
+        bool pretty = false;
+        DumpRecord record;
+        record.data = property(1200);
+        CHECK_EQ(record_to_text(record, &pretty), std::string(
+                "<?xml version=\"1.0\" encoding=\"SHIFT_JIS\"?>\n"
+                "<response>\n"
+                "    <pcbtracker>\n"
+                "        <expire __type=\"u32\">1200</expire>\n"
+                "    </pcbtracker>\n"
+                "</response>\n"));
+        CHECK(pretty);
+
+        record.data.resize(record.data.size() / 2);
+        CHECK(record_to_text(record, &pretty).find("undecodable") != std::string::npos);
+        CHECK(!pretty);
+
+        record.format = RecordFormat::Text;
+        record.data = text_bytes("<a><b>1</b></a>");
+        CHECK_EQ(record_to_text(record, &pretty), std::string("<a>\n    <b>1</b>\n</a>\n"));
+        CHECK(pretty);
+
+        record.data = text_bytes("{\"json\": true}");
+        CHECK_EQ(record_to_text(record, &pretty), std::string("{\"json\": true}"));
+        CHECK(!pretty);
+    }
+
+    void test_convert() {
+        const auto path = write_dump("convert.bin", sample_records());
+        const auto out = path_for("convert.xml");
+        CHECK(dump_convert(path, out));
+        const auto bytes = file_bytes(out);
+        const std::string text(bytes.begin(), bytes.end());
+        CHECK(text.find("<expire __type=\"u32\">18</expire>") != std::string::npos);
+        CHECK(text.find("{\"call\": 9}") != std::string::npos);
+        CHECK(!dump_convert(path_for("missing.bin"), path_for("missing.xml")));
+    }
+}
+
+int main() {
+    DIRECTORY = std::filesystem::temp_directory_path() / "spice_automap_dump_test";
+    std::filesystem::remove_all(DIRECTORY);
+    std::filesystem::create_directories(DIRECTORY);
+
+    test_round_trip();
+    test_damaged_index();
+    test_truncated();
+    test_text();
+    test_convert();
+
+    std::filesystem::remove_all(DIRECTORY);
+    return test::result();
+}
@@ -0,0 +1,47 @@
+/*
+ * misc/cardfile: cost of a card lookup through the store against opening and parsing the file
+ * every time, and of a refresh that finds nothing changed.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "misc/cardfile.h"
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+int main() {
+    std::random_device random;
+    const auto dir = fs::temp_directory_path() / ("spice_cardfile_" + std::to_string(random()));
+    fs::create_directories(dir);
+    const auto path = dir / "card0.txt";
+    {
+        std::ofstream f(path, std::ios::out | std::ios::binary);
+        f << "E004010203040506";
+    }
+
+    const auto open = test::time_ns(20'000, [&](size_t) {
+        std::ifstream f(path, std::ios::in | std::ios::binary);
+        char buffer[16];
+        f.read(buffer, sizeof(buffer));
+        test::keep(card_file_parse(buffer, (size_t) f.gcount()).card[0]);
+    });
+
+    CardFileStore store(std::chrono::milliseconds(0));
+    store.get(path);
+    const auto lookup = test::time_ns(10'000'000, [&](size_t) {
+        test::keep(store.get(path).card[0]);
+    });
+    const auto refresh = test::time_ns(20'000, [&](size_t) {
+        store.refresh();
+    });
+
+    printf("open+parse %8.1f ns  store lookup %6.1f ns  refresh %8.1f ns\n", open, lookup, refresh);
+
+    std::error_code error;
+    fs::remove_all(dir, error);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * misc/cardfile: parsing of card file contents, the store picking up changed, removed and
+ * reloaded files on refresh, replaced contents being freed again instead of piling up, and
+ * lookups racing a writer that keeps rewriting the file.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "misc/cardfile.h"
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    CardFile parse(const std::string &text) {
+        return card_file_parse(text.data(), text.size());
+    }
+
+    void test_parse() {
+        auto ok = parse("E004010203040506\r\n");
+        CHECK(ok.status == CardFileStatus::Ok);
+        const uint8_t card[] = { 0xE0, 0x04, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+        CHECK(memcmp(ok.card, card, sizeof(card)) == 0);
+        CHECK_EQ(std::string(ok.text), std::string("E004010203040506"));
+        CHECK(parse("e004abcdefABCDEF").status == CardFileStatus::Ok);
+
+        auto short_file = parse("E00401");
+        CHECK(short_file.status == CardFileStatus::TooShort);
+        CHECK_EQ(std::string(short_file.text), std::string("E00401"));
+        CHECK(parse("").status == CardFileStatus::TooShort);
+
+        auto invalid = parse("E0040102030G0506");
+        CHECK(invalid.status == CardFileStatus::InvalidCharacter);
+        CHECK_EQ(invalid.invalid_pos, (size_t) 11);
+    }
+
+    class TempDir {
+    public:
+        fs::path path;
+
+        TempDir() {
+            std::random_device random;
+            this->path = fs::temp_directory_path() / ("spice_cardfile_" + std::to_string(random()));
+            fs::create_directories(this->path);
+        }
+
+        ~TempDir() {
+            std::error_code error;
+            fs::remove_all(this->path, error);
+        }
+    };
+
+    // bumps the modification time as well, so a rewrite with the same size is still seen
+    void write(const fs::path &path, const std::string &text, int generation = 0) {
+        {
+            std::ofstream f(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            f << text;
+        }
+        fs::last_write_time(path, fs::file_time_type(std::chrono::seconds(1'000'000 + generation)));
+    }
+
+    void test_store() {
+        TempDir dir;
+        const auto path = dir.path / "card0.txt";
+        write(path, "E004010203040506");
+
+        CardFileStore store(std::chrono::milliseconds(0));
+        CHECK(store.get(path).status == CardFileStatus::Ok);
+        CHECK(store.get(path).card[7] == 0x06);
+        CHECK_EQ(store.load_count(), (size_t) 1);
+
+        // nothing changed, nothing read
+        store.refresh();
+        CHECK_EQ(store.load_count(), (size_t) 1);
+
+        // same size, new time
+        write(path, "E004010203040507", 1);
+        CHECK(store.get(path).card[7] == 0x06);
+        store.refresh();
+        CHECK(store.get(path).card[7] == 0x07);
+        CHECK_EQ(store.load_count(), (size_t) 2);
+
+        // new size
+        write(path, "E00401", 1);
+        store.refresh();
+        CHECK(store.get(path).status == CardFileStatus::TooShort);
+
+        // gone and back
+        fs::remove(path);
+        store.refresh();
+        CHECK(store.get(path).status == CardFileStatus::OpenFailed);
+        write(path, "E004010203040508", 2);
+        store.refresh();
+        CHECK(store.get(path).card[7] == 0x08);
+
+        // a reload reads right away
+        write(path, "E004010203040509", 3);
+        CHECK(store.get(path, true).card[7] == 0x09);
+        CHECK_EQ(store.load_count(), (size_t) 6);
+
+        // missing files get a slot too
+        CHECK(store.get(dir.path / "card1.txt").status == CardFileStatus::OpenFailed);
+        write(dir.path / "card1.txt", "E004000000000001");
+        store.refresh();
+        CHECK(store.get(dir.path / "card1.txt").status == CardFileStatus::Ok);
+    }
+
+    void test_retired() {
+        TempDir dir;
+        const auto path = dir.path / "card0.txt";
+        write(path, "E004010203040506");
+
+        CardFileStore store(std::chrono::milliseconds(0));
+        store.get(path);
+        for (int generation = 1; generation <= 1000; generation++) {
+            write(path, "E004010203040506", generation);
+            if (generation % 2) {
+                store.refresh();
+            } else {
+                store.get(path, true);
+            }
+
+            // only what was replaced since the last refresh is still around
+            CHECK(store.retired_count() <= 2);
+        }
+        store.refresh();
+        CHECK_EQ(store.retired_count(), (size_t) 0);
+        CHECK_EQ(store.load_count(), (size_t) 1001);
+    }
+
+    // readers must only ever see whole contents, and nothing they look at may be freed under them
+    void test_race() {
+        TempDir dir;
+        const auto path = dir.path / "card0.txt";
+        write(path, "E004000000000000");
+
+        CardFileStore store(std::chrono::milliseconds(0));
+        store.get(path);
+        std::atomic<bool> stop {false};
+        std::atomic<size_t> torn {0};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 3; i++) {
+            readers.emplace_back([&] {
+                while (!stop.load()) {
+                    const auto file = store.get(path);
+                    if (file.status != CardFileStatus::Ok
+                            || file.card[0] != 0xE0 || file.card[1] != 0x04 || file.card[7] != file.card[6]) {
+                        torn++;
+                    }
+                }
+            });
+        }
+        for (int generation = 1; generation <= 300; generation++) {
+            char text[17];
+            snprintf(text, sizeof(text), "E00400000000%02X%02X", generation & 0xFF, generation & 0xFF);
+            write(path, text, generation);
+            store.refresh();
+        }
+        stop = true;
+        for (auto &thread : readers) {
+            thread.join();
+        }
+        CHECK_EQ(torn.load(), (size_t) 0);
+        CHECK(store.get(path).card[7] == (300 & 0xFF));
+    }
+}
+
+int main() {
+    test_parse();
+    test_store();
+    test_retired();
+    test_race();
+    return test::result();
+}
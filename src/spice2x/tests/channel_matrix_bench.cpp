@@ -0,0 +1,114 @@
+/*
+ * hooks/audio/mix: downmix throughput
+ *
+ * before: every frame read each source sample through the generic sample reader and summed the
+ * per-side channel lists (the old WASAPI Downmix::process).
+ * after: ChannelMatrix decodes blocks with convert_samples and mixes them with SSE2 kernels.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "hooks/audio/mix.h"
+#include "test.h"
+
+using hooks::audio::ChannelMatrix;
+
+namespace {
+
+    struct MixChannel {
+        int channel;
+        float gain;
+    };
+
+    float read_sample(const uint8_t *p, bool is_float) {
+        if (is_float) {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v / 32768.f;
+    }
+
+    void write_sample(uint8_t *p, bool is_float, float v) {
+        v = std::clamp(v, -1.f, 1.f);
+        if (is_float) {
+            memcpy(p, &v, sizeof(v));
+        } else {
+            const auto s = static_cast<int16_t>(std::lround(v * 32767.f));
+            memcpy(p, &s, sizeof(s));
+        }
+    }
+
+    void process_before(const std::vector<MixChannel> &left, const std::vector<MixChannel> &right,
+            uint8_t *dst, const uint8_t *src, size_t frames, int channels, int bps, bool is_float) {
+        for (size_t i = 0; i < frames; i++) {
+            const uint8_t *in = src + i * channels * bps;
+            uint8_t *out = dst + i * 2 * bps;
+            float l = 0.f;
+            float r = 0.f;
+            for (const auto &c : left) {
+                l += read_sample(in + c.channel * bps, is_float) * c.gain;
+            }
+            for (const auto &c : right) {
+                r += read_sample(in + c.channel * bps, is_float) * c.gain;
+            }
+            write_sample(out, is_float, l);
+            write_sample(out + bps, is_float, r);
+        }
+    }
+
+    // AC-4 style 7.1 fold: fronts at unity, everything but the LFE at -3 dB
+    void run(const char *name, SampleType type) {
+        constexpr int channels = 8;
+        constexpr size_t frames = 480;
+        constexpr size_t iterations = 100'000;
+        const int bps = (int) sample_type_size(type);
+        const bool is_float = type == SampleType::FLOAT_32;
+
+        const float att = 0.70710678f;
+        std::vector<MixChannel> left = { { 0, 1.f }, { 2, att }, { 4, att }, { 6, att } };
+        std::vector<MixChannel> right = { { 1, 1.f }, { 2, att }, { 5, att }, { 7, att } };
+        ChannelMatrix matrix;
+        matrix.resize(channels, 2);
+        for (auto &c : left) {
+            matrix.set_gain(0, c.channel, c.gain);
+        }
+        for (auto &c : right) {
+            matrix.set_gain(1, c.channel, c.gain);
+        }
+
+        std::vector<uint8_t> src(frames * channels * bps);
+        std::vector<uint8_t> dst(frames * 2 * bps);
+        for (size_t i = 0; i < src.size(); i++) {
+            src[i] = (uint8_t) (i * 37);
+        }
+        if (is_float) {
+            auto samples = reinterpret_cast<float *>(src.data());
+            for (size_t i = 0; i < frames * channels; i++) {
+                samples[i] = (float) (i % 100) / 400.f;
+            }
+        }
+
+        const auto before = test::time_ns(iterations, [&](size_t) {
+            process_before(left, right, dst.data(), src.data(), frames, channels, bps, is_float);
+            test::keep(dst[0]);
+        });
+        const auto after = test::time_ns(iterations, [&](size_t) {
+            matrix.process_interleaved(src.data(), type, dst.data(), type, frames);
+            test::keep(dst[0]);
+        });
+        printf("%-16s before %6.2f ns/frame  after %5.2f ns/frame  (%.1fx)\n",
+                name, before / frames, after / frames, before / after);
+    }
+}
+
+int main() {
+    run("7.1 -> 2.0 s16", SampleType::SINT_16);
+    run("7.1 -> 2.0 f32", SampleType::FLOAT_32);
+    return 0;
+}
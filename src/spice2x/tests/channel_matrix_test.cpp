@@ -0,0 +1,161 @@
+/*
+ * hooks/audio/mix: ChannelMatrix interleaved and planar mixing against a per-frame reference,
+ * for the stereo kernels (1 to 8 inputs) and the generic path.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "hooks/audio/mix.h"
+#include "test.h"
+
+using hooks::audio::ChannelMatrix;
+
+namespace {
+
+    ChannelMatrix random_matrix(size_t inputs, size_t outputs, std::mt19937 &rng) {
+        std::uniform_real_distribution<float> gain(-0.8f, 0.8f);
+        std::bernoulli_distribution used(0.7);
+        ChannelMatrix matrix;
+        matrix.resize(inputs, outputs);
+        for (size_t o = 0; o < outputs; o++) {
+            for (size_t i = 0; i < inputs; i++) {
+                if (used(rng)) {
+                    matrix.set_gain(o, i, gain(rng));
+                }
+            }
+        }
+        return matrix;
+    }
+
+    std::vector<float> random_signal(size_t count, std::mt19937 &rng) {
+        std::uniform_real_distribution<float> sample(-1.f, 1.f);
+        std::vector<float> signal(count);
+        for (auto &s : signal) {
+            s = sample(rng);
+        }
+        return signal;
+    }
+
+    float reference(const ChannelMatrix &matrix, const float *frame, size_t output) {
+        double acc = 0;
+        for (size_t i = 0; i < matrix.inputs(); i++) {
+            acc += (double) frame[i] * matrix.gain(output, i);
+        }
+        return (float) std::clamp(acc, -1.0, 1.0);
+    }
+
+    void test_interleaved() {
+        std::mt19937 rng(7);
+        const struct {
+            size_t inputs;
+            size_t outputs;
+        } shapes[] = {
+            { 1, 2 }, { 2, 2 }, { 3, 2 }, { 4, 2 }, { 5, 2 }, { 6, 2 }, { 7, 2 }, { 8, 2 },
+            { 10, 2 }, { 2, 1 }, { 3, 3 }, { 6, 4 }, { 2, 8 },
+        };
+        for (auto &shape : shapes) {
+            for (size_t frames : { 1, 3, 5, 1000, 3001 }) {
+                const auto matrix = random_matrix(shape.inputs, shape.outputs, rng);
+                const auto in = random_signal(frames * shape.inputs, rng);
+                std::vector<float> out(frames * shape.outputs);
+                matrix.process_interleaved(in.data(), SampleType::FLOAT_32,
+                        out.data(), SampleType::FLOAT_32, frames);
+
+                for (size_t f = 0; f < frames; f++) {
+                    for (size_t o = 0; o < shape.outputs; o++) {
+                        const auto expected = reference(matrix, &in[f * shape.inputs], o);
+                        if (std::fabs(out[f * shape.outputs + o] - expected) > 1e-5f) {
+                            fprintf(stderr, "%zu -> %zu, %zu frames [%zu][%zu]: %f != %f\n",
+                                    shape.inputs, shape.outputs, frames, f, o,
+                                    out[f * shape.outputs + o], expected);
+                            test::failures()++;
+                            f = frames;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // integer formats go through the block scratch and saturate at full scale
+    void test_interleaved_int() {
+        ChannelMatrix matrix;
+        matrix.resize(6, 2);
+        for (size_t i = 0; i < 6; i++) {
+            matrix.set_gain(i & 1, i, 1.f);
+        }
+
+        const size_t frames = 5000;
+        std::vector<int16_t> in(frames * 6);
+        for (size_t f = 0; f < frames; f++) {
+            for (size_t i = 0; i < 6; i++) {
+                in[f * 6 + i] = (int16_t) ((f % 2 == 0 ? 1000 : 20000) * (i & 1 ? -1 : 1));
+            }
+        }
+        std::vector<int16_t> out(frames * 2);
+        matrix.process_interleaved(in.data(), SampleType::SINT_16, out.data(), SampleType::SINT_16, frames);
+        for (size_t f = 0; f < frames; f++) {
+            const int16_t expected = f % 2 == 0 ? 3000 : 32767;
+            CHECK_EQ(out[f * 2], expected);
+            CHECK_EQ(out[f * 2 + 1], (int16_t) (f % 2 == 0 ? -3000 : -32768));
+        }
+
+        std::vector<int32_t> wide(frames * 2);
+        matrix.process_interleaved(in.data(), SampleType::SINT_16, wide.data(), SampleType::SINT_32, frames);
+        CHECK_EQ(wide[0], 3000 << 16);
+    }
+
+    // planar buffers, with null planes and a destination aliasing a source
+    void test_planar() {
+        std::mt19937 rng(11);
+        const size_t frames = 2500;
+        const auto matrix = random_matrix(4, 2, rng);
+        std::vector<std::vector<float>> planes;
+        for (size_t i = 0; i < 4; i++) {
+            planes.push_back(random_signal(frames, rng));
+        }
+        const auto original = planes;
+
+        std::vector<float> right(frames);
+        const void *src[4] = { planes[0].data(), planes[1].data(), nullptr, planes[3].data() };
+        void *dst[2] = { planes[0].data(), right.data() };
+        matrix.process_planar(src, SampleType::FLOAT_32, dst, SampleType::FLOAT_32, frames);
+
+        for (size_t f = 0; f < frames; f++) {
+            const float frame[4] = { original[0][f], original[1][f], 0.f, original[3][f] };
+            CHECK(std::fabs(planes[0][f] - reference(matrix, frame, 0)) < 1e-5f);
+            CHECK(std::fabs(right[f] - reference(matrix, frame, 1)) < 1e-5f);
+        }
+
+        // null destinations are skipped
+        void *only_right[2] = { nullptr, right.data() };
+        matrix.process_planar(src, SampleType::FLOAT_32, only_right, SampleType::FLOAT_32, frames);
+    }
+
+    void test_helpers() {
+        ChannelMatrix matrix;
+        matrix.resize(40, 2);
+        CHECK_EQ(matrix.inputs(), ChannelMatrix::MAX_CHANNELS);
+        matrix.set_gain(0, 0, 0.5f);
+        matrix.add_gain(0, 0, 0.25f);
+        matrix.set_gain(0, 3, 1.f);
+        matrix.set_gain(5, 0, 1.f);
+        matrix.scale_output(0, 2.f);
+        CHECK_EQ(matrix.gain(0, 0), 1.5f);
+        CHECK_EQ(matrix.gain(0, 3), 2.f);
+        CHECK_EQ(matrix.gain(5, 0), 0.f);
+        CHECK_EQ(matrix.taps(0), (size_t) 2);
+        CHECK_EQ(matrix.taps(1), (size_t) 0);
+    }
+}
+
+int main() {
+    test_interleaved();
+    test_interleaved_int();
+    test_planar();
+    test_helpers();
+    return test::result();
+}
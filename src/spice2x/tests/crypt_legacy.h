@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * util/crypt and util/rc4 as they were before the SSSE3 encoder and the block keystream,
+ * the reference for crypt_test and the before numbers of the base64 and rc4 benchmarks
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace legacy {
+
+    // util/crypt.cpp before the pointer variant
+    inline std::string base64_encode(const uint8_t *ptr, size_t length) {
+        static const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        static size_t mod[] = {0, 2, 1 };
+        std::string result(4 * ((length + 2) / 3), '=');
+        if (ptr && length) {
+            for (size_t i = 0, j = 0, triplet = 0; i < length; triplet = 0) {
+                for (size_t k = 0; k < 3; ++k) {
+                    triplet = (triplet << 8) | (i < length ? ptr[i++] : 0);
+                }
+                for (size_t k = 4; k--;) {
+                    result[j++] = table[(triplet >> k * 6) & 0x3F];
+                }
+            }
+            for (size_t i = 0; i < mod[length % 3]; i++) {
+                result[result.length() - 1 - i] = '=';
+            }
+        }
+        return result;
+    }
+
+    // util/rc4.cpp before the block keystream
+    class RC4 {
+    private:
+        uint8_t s_box[256];
+        uint8_t a = 0, b = 0;
+
+    public:
+
+        RC4(uint8_t *key, size_t key_size) {
+            for (size_t i = 0; i < std::size(s_box); i++)
+                s_box[i] = (uint8_t) i;
+            if (!key_size)
+                return;
+            size_t j = 0;
+            for (size_t i = 0; i < std::size(s_box); i++) {
+                j = (j + s_box[i] + key[i % key_size]) % std::size(s_box);
+                auto tmp = s_box[i];
+                s_box[i] = s_box[j];
+                s_box[j] = tmp;
+            }
+        }
+
+        void crypt(uint8_t *data, size_t size) {
+            for (size_t pos = 0; pos < size; pos++) {
+                a = (a + 1) % std::size(s_box);
+                b = (b + s_box[a]) % std::size(s_box);
+                auto tmp = s_box[a];
+                s_box[a] = s_box[b];
+                s_box[b] = tmp;
+                data[pos] ^= s_box[(s_box[a] + s_box[b]) % std::size(s_box)];
+            }
+        }
+    };
+}
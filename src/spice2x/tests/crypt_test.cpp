@@ -0,0 +1,176 @@
+/*
+ * util/crypt, util/rc4: the base64 encoder against the std::string one it replaced for every
+ * length up to 300 and every source alignment, decode round trips and malformed input, and the
+ * block RC4 against the byte at a time one, with the data split across several crypt() calls.
+ * run with SPICE_TEST_SCALAR=1 as well so both encoder paths are compared.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/crypt.h"
+#include "util/rc4.h"
+#include "crypt_legacy.h"
+#include "test.h"
+
+namespace {
+
+    void test_base64_encode(std::mt19937 &rng) {
+        std::vector<uint8_t> source(300 + 16);
+        for (auto &b : source) {
+            b = (uint8_t) rng();
+        }
+
+        // every alignment of the source, the SSSE3 path loads 16 bytes unaligned
+        for (size_t offset = 0; offset < 16; offset++) {
+            for (size_t length = 0; length <= 300; length++) {
+                const auto data = source.data() + offset;
+                const auto expected = legacy::base64_encode(data, length);
+                CHECK_EQ(crypt::base64_encoded_size(length), expected.size());
+                CHECK(crypt::base64_encode(data, length) == expected);
+
+                // the pointer variant writes exactly the encoded size and nothing past it
+                std::string out(expected.size() + 4, '#');
+                crypt::base64_encode(data, length, out.data());
+                CHECK(out.compare(0, expected.size(), expected) == 0);
+                CHECK(out.compare(expected.size(), 4, "####") == 0);
+            }
+        }
+
+        // every byte value in every triplet position
+        std::vector<uint8_t> all(256 * 3);
+        for (size_t i = 0; i < all.size(); i++) {
+            all[i] = (uint8_t) (i / 3 + i % 3 * 85);
+        }
+        CHECK(crypt::base64_encode(all.data(), all.size()) == legacy::base64_encode(all.data(), all.size()));
+
+        CHECK(crypt::base64_encode(nullptr, 0).empty());
+        CHECK(crypt::base64_encode((const uint8_t *) "foobar", 6) == "Zm9vYmFy");
+        CHECK(crypt::base64_encode((const uint8_t *) "fooba", 5) == "Zm9vYmE=");
+        CHECK(crypt::base64_encode((const uint8_t *) "foob", 4) == "Zm9vYg==");
+    }
+
+    bool decode(const std::string &text, std::vector<uint8_t> &out) {
+        return crypt::base64_decode(text.data(), text.size(), out);
+    }
+
+    void test_base64_decode(std::mt19937 &rng) {
+        for (size_t length = 0; length <= 300; length++) {
+            std::vector<uint8_t> data(length);
+            for (auto &b : data) {
+                b = (uint8_t) rng();
+            }
+
+            // appends behind what is already there
+            std::vector<uint8_t> out { 0xAA, 0xBB };
+            CHECK(decode(crypt::base64_encode(data.data(), data.size()), out));
+            CHECK_EQ(out.size(), length + 2);
+            CHECK(out[0] == 0xAA && out[1] == 0xBB);
+            CHECK(std::equal(data.begin(), data.end(), out.begin() + 2));
+        }
+
+        // malformed input fails and leaves the buffer as it was
+        const char *malformed[] = {
+            "Zm9",          // not a multiple of four
+            "Zm9vY",
+            "Zm9v!mFy",     // outside the alphabet
+            "Zm9v YmF",
+            "Zm9vYm\xc3\xa9",
+            "Zm=vYmFy",     // padding before the end
+            "Zm9vY=Fy",
+            "Zm9vYmF=Zm9v",
+            "Zm9vY===",     // too much padding
+            "====",
+            "Z=9v",
+        };
+        for (auto text : malformed) {
+            std::vector<uint8_t> out { 0x01, 0x02, 0x03 };
+            CHECK(!decode(text, out));
+            CHECK_EQ(out.size(), (size_t) 3);
+            CHECK(out[0] == 0x01 && out[1] == 0x02 && out[2] == 0x03);
+        }
+
+        std::vector<uint8_t> out;
+        CHECK(decode("", out) && out.empty());
+        CHECK(decode("Zm9vYg==", out));
+        CHECK(std::string(out.begin(), out.end()) == "foob");
+    }
+
+    void test_rc4(std::mt19937 &rng) {
+        std::vector<uint8_t> plain(70'000);
+        for (auto &b : plain) {
+            b = (uint8_t) rng();
+        }
+
+        for (size_t key_size : { 0, 1, 5, 16, 32, 256 }) {
+            std::vector<uint8_t> key(key_size);
+            for (auto &b : key) {
+                b = (uint8_t) rng();
+            }
+
+            // one call
+            {
+                auto expected = plain;
+                legacy::RC4(key.data(), key.size()).crypt(expected.data(), expected.size());
+                auto actual = plain;
+                util::RC4(key.data(), key.size()).crypt(actual.data(), actual.size());
+                CHECK(actual == expected);
+            }
+
+            // the same stream in pieces around the 256 byte keystream block and the 8 byte
+            // words, the indices have to carry over between calls
+            const size_t pieces[] = { 0, 1, 7, 8, 9, 255, 256, 257, 3, 511, 513, 1024, 4099 };
+            for (size_t round = 0; round < 4; round++) {
+                auto expected = plain;
+                legacy::RC4(key.data(), key.size()).crypt(expected.data(), expected.size());
+                auto actual = plain;
+                util::RC4 rc4(key.data(), key.size());
+                size_t pos = 0;
+                for (size_t i = 0; pos < actual.size(); i++) {
+                    const size_t piece = round == 0 ? pieces[i % std::size(pieces)] : rng() % 2000;
+                    const size_t size = std::min(piece, actual.size() - pos);
+                    rc4.crypt(actual.data() + pos, size);
+                    pos += size;
+                }
+                CHECK(actual == expected);
+            }
+
+            // crypt_until stops right behind the terminator and continues the same stream
+            {
+                auto expected = plain;
+                legacy::RC4(key.data(), key.size()).crypt(expected.data(), expected.size());
+                auto actual = plain;
+                util::RC4 rc4(key.data(), key.size());
+                size_t pos = 0;
+                while (pos < actual.size()) {
+                    const size_t size = std::min<size_t>(1000, actual.size() - pos);
+                    const size_t done = rc4.crypt_until(actual.data() + pos, size, 0x5A);
+                    CHECK(done > 0 && done <= size);
+                    CHECK(done == size || actual[pos + done - 1] == 0x5A);
+                    CHECK(memchr(actual.data() + pos, 0x5A, done - 1) == nullptr);
+                    pos += done;
+                }
+                CHECK(actual == expected);
+            }
+        }
+
+        // known answer, "Key" / "Plaintext"
+        uint8_t key[] = { 'K', 'e', 'y' };
+        uint8_t text[] = { 'P', 'l', 'a', 'i', 'n', 't', 'e', 'x', 't' };
+        const uint8_t cipher[] = { 0xBB, 0xF3, 0x16, 0xE8, 0xD9, 0x40, 0xAF, 0x0A, 0xD3 };
+        util::RC4(key, sizeof(key)).crypt(text, sizeof(text));
+        CHECK(memcmp(text, cipher, sizeof(cipher)) == 0);
+    }
+}
+
+int main() {
+    std::mt19937 rng(39);
+    test_base64_encode(rng);
+    test_base64_decode(rng);
+    test_rc4(rng);
+    return test::result();
+}
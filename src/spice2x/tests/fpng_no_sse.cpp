@@ -0,0 +1,6 @@
+// fpng once more with its SSE4.1 paths compiled out, under its own namespace, so the screenshot
+// benchmark can time both builds in one process. see fpng_no_sse.h
+
+#define FPNG_NO_SSE 1
+#define fpng fpng_no_sse
+#include "external/fpng/fpng.cpp"
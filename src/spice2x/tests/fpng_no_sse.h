@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// the parts of external/fpng/fpng.h the benchmarks use, for the copy built by fpng_no_sse.cpp
+
+namespace fpng_no_sse {
+    void fpng_init();
+    bool fpng_encode_image_to_memory(const void *pImage, uint32_t w, uint32_t h, uint32_t num_chans,
+            std::vector<uint8_t> &out_buf, uint32_t flags = 0);
+}
@@ -0,0 +1,77 @@
+/*
+ * hooks/icmphook_sockets: classifying a real socket handle in a hooked Winsock call, from
+ * several threads at once.
+ *
+ * before: a process wide recursive mutex and a lookup in the map of emulated sockets
+ * after:  the tag check on the handle value
+ */
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "hooks/icmphook_sockets.h"
+#include "test.h"
+
+using namespace icmphook_internal;
+
+namespace {
+
+    struct State {
+        int value = 0;
+    };
+
+    std::recursive_mutex g_mu;
+    std::unordered_map<uint64_t, std::unique_ptr<State>> g_socks;
+
+    std::unique_ptr<EmuSocketTable<State>> g_table;
+
+    bool is_emulated_locked(uint64_t handle) {
+        std::lock_guard<std::recursive_mutex> lock(g_mu);
+        return g_socks.find(handle) != g_socks.end();
+    }
+
+    bool is_emulated_tagged(uint64_t handle) {
+        return g_table->contains(handle);
+    }
+
+    // called through a volatile pointer like the hooks are, so the check is not hoisted
+    // out of the loop
+    double run_threads(size_t threads, size_t iterations, bool (*function)(uint64_t)) {
+        bool (*volatile classify)(uint64_t) = function;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                size_t emulated = 0;
+                for (size_t i = 0; i < iterations; i++) {
+                    emulated += classify(0x100 + ((t * iterations + i) & 0xFFFF) * 4);
+                }
+                test::keep(emulated);
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (threads * iterations);
+    }
+}
+
+int main() {
+    g_table = std::make_unique<EmuSocketTable<State>>();
+    for (int i = 0; i < 4; i++) {
+        const auto handle = g_table->alloc();
+        g_socks.emplace(handle, std::make_unique<State>());
+    }
+
+    constexpr size_t iterations = 1'000'000;
+    for (size_t threads : { 1, 4 }) {
+        const auto before = run_threads(threads, iterations, is_emulated_locked);
+        const auto after = run_threads(threads, iterations, is_emulated_tagged);
+        printf("%zu thread(s)  mutex+map %6.2f ns/call  tag %6.2f ns/call\n", threads, before, after);
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * hooks/icmphook_sockets: handle tagging, slot reuse with stale handles, table exhaustion, and
+ * many threads allocating, exchanging data through and closing emulated sockets at once.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "hooks/icmphook_sockets.h"
+#include "test.h"
+
+using namespace icmphook_internal;
+
+namespace {
+
+    struct State {
+        std::deque<int> packets;
+        bool bound = false;
+    };
+
+    using Table = EmuSocketTable<State>;
+
+    void test_tagging() {
+
+        // kernel handles are small multiples of four, none of them may look emulated
+        for (uint64_t handle = 0; handle < 0x100000; handle += 4) {
+            CHECK(!emu_handle_tagged(handle));
+        }
+        CHECK(!emu_handle_tagged(~uint64_t(0)));
+        CHECK(!emu_handle_tagged(uint64_t(k_emu_handle_tag) | (uint64_t(1) << 32)));
+        CHECK(emu_handle_tagged(k_emu_handle_tag));
+        CHECK(emu_handle_tagged(0xEFFFFFFFu));
+        CHECK(!emu_handle_tagged(0xF0000000u));
+    }
+
+    void test_lifecycle() {
+        auto table = std::make_unique<Table>();
+        const auto handle = table->alloc();
+        CHECK(emu_handle_tagged(handle));
+        CHECK(table->contains(handle));
+        CHECK(!table->contains(0x1234));
+        {
+            auto slot = table->acquire(handle);
+            CHECK(slot);
+            CHECK(slot->state.packets.empty() && !slot->state.bound);
+            slot->state.bound = true;
+            slot->state.packets.push_back(1);
+        }
+        CHECK(table->acquire(handle)->state.bound);
+        CHECK(!table->acquire(0x1234));
+
+        // the slot comes back empty and under a new handle, the old one stays closed
+        CHECK(table->release(handle));
+        CHECK(!table->release(handle));
+        CHECK(!table->contains(handle));
+        CHECK(!table->acquire(handle));
+        const auto reused = table->alloc();
+        CHECK(reused != handle);
+        CHECK_EQ(reused & (k_emu_slot_count - 1), handle & (k_emu_slot_count - 1));
+        CHECK(!table->contains(handle));
+        auto slot = table->acquire(reused);
+        CHECK(slot && !slot->state.bound && slot->state.packets.empty());
+    }
+
+    void test_exhaustion() {
+        auto table = std::make_unique<Table>();
+        std::vector<uint32_t> handles;
+        for (uint32_t i = 0; i < k_emu_slot_count; i++) {
+            handles.push_back(table->alloc());
+            CHECK(handles.back() != 0);
+        }
+        CHECK_EQ(table->alloc(), 0u);
+        CHECK(table->release(handles[17]));
+        const auto handle = table->alloc();
+        CHECK(handle != 0 && handle != handles[17]);
+        CHECK_EQ(table->alloc(), 0u);
+    }
+
+    void test_close_wakes_receiver() {
+        auto table = std::make_unique<Table>();
+        const auto handle = table->alloc();
+        std::atomic<bool> woke {false};
+        std::thread receiver([&] {
+            auto slot = table->acquire(handle);
+            slot->cv.wait(slot.lock, [&] {
+                return !Table::open(*slot.slot, handle) || !slot->state.packets.empty();
+            });
+            woke.store(!Table::open(*slot.slot, handle));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(table->release(handle));
+        receiver.join();
+        CHECK(woke.load());
+    }
+
+    void test_threads() {
+
+        // pairs of sockets: one thread sends into the other's slot and waits for the echo
+        auto table = std::make_unique<Table>();
+        std::atomic<int> errors {0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&] {
+                for (int round = 0; round < 500; round++) {
+                    const auto a = table->alloc();
+                    const auto b = table->alloc();
+                    if (!a || !b) {
+                        errors++;
+                        continue;
+                    }
+                    std::thread peer([&table, a, b] {
+                        auto slot = table->acquire(b);
+                        slot->cv.wait(slot.lock, [&] { return !slot->state.packets.empty(); });
+                        const int value = slot->state.packets.front();
+                        slot.lock.unlock();
+                        auto reply = table->acquire(a);
+                        reply->state.packets.push_back(value + 1);
+                        reply->cv.notify_all();
+                    });
+                    {
+                        auto slot = table->acquire(b);
+                        slot->state.packets.push_back(round);
+                        slot->cv.notify_all();
+                    }
+                    {
+                        auto slot = table->acquire(a);
+                        slot->cv.wait(slot.lock, [&] { return !slot->state.packets.empty(); });
+                        if (slot->state.packets.front() != round + 1) {
+                            errors++;
+                        }
+                    }
+                    peer.join();
+                    if (!table->release(a) || !table->release(b) || table->contains(a) || table->acquire(b)) {
+                        errors++;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        CHECK_EQ(errors.load(), 0);
+        for (uint32_t i = 0; i < k_emu_slot_count; i++) {
+            CHECK(table->alloc() != 0);
+        }
+    }
+}
+
+int main() {
+    test_tagging();
+    test_lifecycle();
+    test_exhaustion();
+    test_close_wakes_receiver();
+    test_threads();
+    return test::result();
+}
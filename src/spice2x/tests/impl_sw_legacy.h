@@ -0,0 +1,16 @@
+#pragma once
+
+/*
+ * overlay/imgui/impl_sw before the tiled renderer, see impl_sw_legacy.cpp
+ */
+
+#include "overlay/imgui/impl_sw.h"
+
+namespace imgui_sw_legacy {
+
+    using imgui_sw::SwOptions;
+    using imgui_sw::Stats;
+
+    // paints the current draw data on top of the buffer, SwOptions::incremental is ignored
+    void paint_imgui(uint32_t *pixels, int width_pixels, int height_pixels, const SwOptions &options = {});
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+/*
+ * frames for the software renderer test and benchmark: a configurator tab with a table of 300
+ * bindings, buttons, progress bars and a color edit, and a window full of log lines.
+ */
+
+#include <cstdlib>
+
+#include "external/imgui/imgui.h"
+#include "overlay/imgui/impl_sw.h"
+
+namespace scene {
+
+    constexpr int WIDTH = 1280;
+    constexpr int HEIGHT = 720;
+
+    enum class Kind {
+        Scrolling,  // the bindings table scrolled a bit further every frame
+        Counter,    // one line of text changing every frame
+        Static,     // the same frame over and over
+        Log,        // text only
+        Window,     // the bindings in a window that leaves most of the screen empty
+    };
+
+    inline void *allocate(size_t size, void *) {
+        return malloc(size);
+    }
+
+    inline void release(void *ptr, void *) {
+        free(ptr);
+    }
+
+    // a new context with the default font bound to the software renderer
+    inline void create() {
+        ImGui::SetAllocatorFunctions(allocate, release);
+        ImGui::CreateContext();
+        auto &io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(WIDTH, HEIGHT);
+        io.DeltaTime = 1.f / 60.f;
+        io.Fonts->AddFontDefault();
+        io.Fonts->Build();
+        imgui_sw::bind_imgui_painting();
+    }
+
+    inline void destroy() {
+        imgui_sw::unbind_imgui_painting();
+        ImGui::DestroyContext();
+    }
+
+    inline void log_lines(int frame) {
+        for (int i = 0; i < 45; i++) {
+            ImGui::Text("[%04d] I:launcher: loading module %d, hooking avs2-core.dll at 0x%08X (frame %d)",
+                    i, i * 7, 0x10000000 + i * 4096, frame % 3);
+        }
+    }
+
+    inline void bindings(Kind kind, int frame) {
+        static bool check = true;
+        static float slider = 0.4f;
+        static float color[4] { 0.3f, 0.6f, 0.2f, 0.8f };
+
+        ImGui::Text("frame counter %d", kind == Kind::Counter ? frame : 0);
+        ImGui::Checkbox("Enable feature", &check);
+        ImGui::SameLine();
+        ImGui::SliderFloat("volume", &slider, 0.f, 1.f);
+        ImGui::ColorEdit4("color", color);
+
+        ImGui::BeginChild("bindings", ImVec2(0, 0), true);
+        if (kind == Kind::Scrolling) {
+            ImGui::SetScrollY(frame * 7.f);
+        }
+        if (ImGui::BeginTable("table", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            for (int i = 0; i < 300; i++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("Button %d - Service Test Coin", i);
+                ImGui::TableNextColumn();
+                ImGui::Text("Keyboard: VK_%c%d", 'A' + i % 26, i);
+                ImGui::TableNextColumn();
+                ImGui::PushID(i);
+                ImGui::Button("Bind");
+                ImGui::SameLine();
+                ImGui::Button("Clear");
+                ImGui::PopID();
+                ImGui::TableNextColumn();
+                ImGui::ProgressBar((i % 10) / 10.f, ImVec2(-1, 0));
+            }
+            ImGui::EndTable();
+        }
+        ImGui::EndChild();
+    }
+
+    // builds the draw data of one frame
+    inline void build(Kind kind, int frame) {
+        ImGui::NewFrame();
+        if (kind == Kind::Window) {
+            ImGui::SetNextWindowPos(ImVec2(100, 80));
+            ImGui::SetNextWindowSize(ImVec2(640, 400));
+        } else {
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(ImVec2(WIDTH, HEIGHT));
+        }
+        ImGui::Begin("spicecfg", nullptr, ImGuiWindowFlags_NoTitleBar);
+        if (kind == Kind::Log) {
+            log_lines(frame);
+        } else if (ImGui::BeginTabBar("tabs")) {
+            if (ImGui::BeginTabItem("Buttons")) {
+                bindings(kind, frame);
+                ImGui::EndTabItem();
+            }
+            ImGui::EndTabBar();
+        }
+        ImGui::End();
+        ImGui::Render();
+    }
+
+    // a few frames for the layout to settle, tables and tabs size themselves on the first ones
+    inline void warm_up(Kind kind) {
+        for (int frame = 0; frame < 3; frame++) {
+            build(kind, 0);
+        }
+    }
+}
@@ -0,0 +1,311 @@
+/*
+ * overlay/imgui/impl_sw: the tiled renderer against the one it replaced (impl_sw_legacy.cpp),
+ * replaying configurator and log frames with full and incremental painting, with and without
+ * anti-aliasing, at 1x, 1.5x and an uneven scale. div255 for every input and the spans
+ * against blend().
+ * incremental painting into another buffer, after a resize, after a full paint and after a
+ * rebind has to repaint every tile instead of trusting what the buffer held before. text from
+ * the glyph cache against sampling the font texture, with glyphs split across tiles, and the
+ * cache dropped once it grows past 4096 glyphs.
+ * run with SPICE_TEST_SCALAR=1 as well so the scalar spans are compared too.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// div255, blend() and the spans are internal to the renderer
+#include "overlay/imgui/impl_sw.cpp"
+
+#include "impl_sw_legacy.h"
+#include "impl_sw_scene.h"
+#include "test.h"
+
+using scene::Kind;
+using scene::WIDTH;
+using scene::HEIGHT;
+
+namespace {
+
+    using Buffer = std::vector<uint32_t>;
+
+    // what the old renderer paints for the current draw data on top of `background`
+    Buffer reference(int width, int height, uint32_t background = 0) {
+        Buffer pixels(width * height, background);
+        imgui_sw_legacy::paint_imgui(pixels.data(), width, height);
+        return pixels;
+    }
+
+    bool same(const Buffer &pixels, const Buffer &expected) {
+        return memcmp(pixels.data(), expected.data(), expected.size() * sizeof(uint32_t)) == 0;
+    }
+
+    void paint(Buffer &pixels, int width, int height, bool incremental) {
+        imgui_sw::SwOptions options;
+        options.incremental = incremental;
+        imgui_sw::paint_imgui(pixels.data(), width, height, options);
+    }
+
+    bool all_tiles_painted() {
+        const auto stats = imgui_sw::get_stats();
+        return stats.tiles_total > 0 && stats.tiles_painted == stats.tiles_total;
+    }
+
+    void test_div255() {
+        size_t mismatches = 0;
+        for (uint32_t x = 0; x <= 255 * 255; x++) {
+            mismatches += imgui_sw::div255(x) != x / 255;
+        }
+        CHECK_EQ(mismatches, (size_t) 0);
+    }
+
+    void test_spans(std::mt19937 &rng) {
+        size_t mismatches = 0;
+        for (int round = 0; round < 100'000; round++) {
+            const int count = static_cast<int>(rng() % 40) + 1;
+            const imgui_sw::ColorInt color(rng());
+
+            // runs of one background color take the shortcut of the span blends
+            Buffer pixels(count);
+            uint8_t coverage[40];
+            for (int x = 0; x < count; x++) {
+                pixels[x] = rng() % 3 == 0 ? 0x12345678u : rng();
+                coverage[x] = rng() % 3 ? static_cast<uint8_t>(rng()) : 0;
+            }
+            auto expected = pixels;
+
+            if (round % 2) {
+                imgui_sw::blend_span(pixels.data(), count, color);
+                for (auto &pixel : expected) {
+                    pixel = imgui_sw::blend(imgui_sw::ColorInt(pixel), color).toUint32();
+                }
+            } else {
+                imgui_sw::blend_coverage_span(pixels.data(), coverage, count, color);
+                for (int x = 0; x < count; x++) {
+                    if (coverage[x]) {
+                        auto source = color;
+                        source.a = source.a * coverage[x] / 255;
+                        expected[x] = imgui_sw::blend(imgui_sw::ColorInt(expected[x]), source).toUint32();
+                    }
+                }
+            }
+            mismatches += !same(pixels, expected);
+        }
+        CHECK_EQ(mismatches, (size_t) 0);
+    }
+
+    // every call paints on top of what is in the buffer, like the old renderer
+    void test_full() {
+        for (const auto kind : { Kind::Scrolling, Kind::Counter, Kind::Log }) {
+            scene::warm_up(kind);
+            for (int frame = 0; frame < 6; frame++) {
+                scene::build(kind, frame);
+                const int sizes[][2] = {
+                    { WIDTH, HEIGHT },
+                    { WIDTH * 3 / 2, HEIGHT * 3 / 2 },
+                    { 1000, 700 },
+                };
+                for (const auto &[width, height] : sizes) {
+                    for (const uint32_t background : { 0u, 0xFF336699u }) {
+                        const auto expected = reference(width, height, background);
+                        Buffer pixels(width * height, background);
+                        paint(pixels, width, height, false);
+                        CHECK(same(pixels, expected));
+                    }
+                }
+            }
+        }
+    }
+
+    // the buffer is kept between frames and only the tiles that changed are painted again
+    void test_incremental(Buffer &pixels) {
+        for (const auto kind : { Kind::Scrolling, Kind::Counter, Kind::Static, Kind::Log }) {
+            scene::warm_up(kind);
+            for (int frame = 0; frame < 20; frame++) {
+                scene::build(kind, frame);
+                paint(pixels, WIDTH, HEIGHT, true);
+                CHECK(same(pixels, reference(WIDTH, HEIGHT)));
+
+                const auto stats = imgui_sw::get_stats();
+                if (kind == Kind::Static && frame > 0) {
+                    CHECK_EQ(stats.tiles_painted, 0);
+                }
+                if (kind == Kind::Counter && frame > 0) {
+                    CHECK(stats.tiles_painted < stats.tiles_total / 4);
+                }
+            }
+        }
+    }
+
+    void test_buffer_switch(Buffer &front, Buffer &back) {
+        scene::warm_up(Kind::Counter);
+        scene::build(Kind::Counter, 0);
+        const auto first = reference(WIDTH, HEIGHT);
+        paint(front, WIDTH, HEIGHT, true);
+        CHECK(same(front, first));
+
+        // the same frame into another buffer, nothing in there was painted by the renderer
+        std::fill(back.begin(), back.end(), 0xDEADBEEF);
+        paint(back, WIDTH, HEIGHT, true);
+        CHECK(same(back, first));
+        CHECK(all_tiles_painted());
+
+        // double buffering, the front buffer still holds the frame before
+        scene::build(Kind::Counter, 1);
+        const auto second = reference(WIDTH, HEIGHT);
+        paint(back, WIDTH, HEIGHT, true);
+        CHECK(same(back, second));
+        paint(front, WIDTH, HEIGHT, true);
+        CHECK(same(front, second));
+        CHECK(all_tiles_painted());
+
+        // a full paint on top of other contents in between
+        std::fill(front.begin(), front.end(), 0xDEADBEEF);
+        paint(front, WIDTH, HEIGHT, false);
+        paint(front, WIDTH, HEIGHT, true);
+        CHECK(same(front, second));
+        CHECK(all_tiles_painted());
+    }
+
+    // one buffer reused at other sizes, with the display following it like in the overlay. the
+    // tiles of the window keep their primitives while the rows under them move
+    void test_resize(Buffer &pixels) {
+        scene::warm_up(Kind::Window);
+        scene::build(Kind::Window, 0);
+        paint(pixels, WIDTH, HEIGHT, true);
+        CHECK(same(pixels, reference(WIDTH, HEIGHT)));
+
+        const int sizes[][2] = {
+            { WIDTH - 64, HEIGHT },
+            { WIDTH - 64, HEIGHT - 1 },
+            { WIDTH / 2, HEIGHT / 2 },
+            { WIDTH, HEIGHT },
+        };
+        for (const auto &[width, height] : sizes) {
+            ImGui::GetIO().DisplaySize = ImVec2(width, height);
+            scene::build(Kind::Window, 0);
+            paint(pixels, width, height, true);
+            CHECK(same(pixels, reference(width, height)));
+            CHECK(all_tiles_painted());
+        }
+    }
+
+    // text blitted from the glyph cache against sampling the font texture again, glyphs on a
+    // tile edge are blitted in parts, one per tile
+    void test_glyph_cache() {
+        size_t glyphs = 0, split = 0;
+        for (const auto kind : { Kind::Log, Kind::Counter }) {
+            scene::warm_up(kind);
+            for (int frame = 0; frame < 3; frame++) {
+                scene::build(kind, frame);
+                const int sizes[][2] = {
+                    { WIDTH, HEIGHT },
+                    { WIDTH * 3 / 2, HEIGHT * 3 / 2 },
+                    { 1000, 700 },
+                };
+                for (const auto &[width, height] : sizes) {
+                    imgui_sw::SwOptions options;
+                    options.cache_glyphs = false;
+                    Buffer expected(width * height, 0xFF336699);
+                    imgui_sw::paint_imgui(expected.data(), width, height, options);
+                    Buffer pixels(width * height, 0xFF336699);
+                    imgui_sw::paint_imgui(pixels.data(), width, height);
+                    CHECK(same(pixels, expected));
+
+                    for (const auto &primitive : imgui_sw::s_renderer.primitives) {
+                        if (primitive.glyph) {
+                            glyphs++;
+                            split += primitive.min_x / imgui_sw::kTileSize != (primitive.max_x - 1) / imgui_sw::kTileSize
+                                    || primitive.min_y / imgui_sw::kTileSize != (primitive.max_y - 1) / imgui_sw::kTileSize;
+                        }
+                    }
+                }
+            }
+        }
+        CHECK(glyphs > 0);
+        CHECK(split > 0);
+    }
+
+    // every scale gives every glyph a new key, so the cache fills up and has to be dropped
+    void test_glyph_cache_drop() {
+        scene::warm_up(Kind::Log);
+        scene::build(Kind::Log, 0);
+        const auto &cache = imgui_sw::s_renderer.glyphs;
+        size_t previous = cache.size();
+        size_t drops = 0;
+        for (int step = 0; step < 40; step++) {
+            const int width = 1000 + step * 7;
+            const int height = 600 + step * 3;
+            Buffer pixels(width * height, 0);
+            imgui_sw::paint_imgui(pixels.data(), width, height);
+            CHECK(same(pixels, reference(width, height)));
+
+            // kept below the limit plus what a single frame adds
+            size_t frame_glyphs = 0;
+            for (const auto &primitive : imgui_sw::s_renderer.primitives) {
+                frame_glyphs += primitive.glyph != nullptr;
+            }
+            CHECK(frame_glyphs > 0);
+            CHECK(cache.size() <= imgui_sw::kMaxGlyphs + frame_glyphs);
+            if (previous > imgui_sw::kMaxGlyphs) {
+                drops++;
+                CHECK(cache.size() <= frame_glyphs);
+            } else {
+                CHECK(cache.size() >= previous);
+            }
+            previous = cache.size();
+        }
+        CHECK(drops > 0);
+    }
+
+    // the overlay unbinds and destroys its context, then binds a new one on the same buffer.
+    // the tiles around the window are empty in both, only the rebind tells the renderer that
+    // the buffer was scribbled over in between
+    void test_rebind(Buffer &pixels) {
+        scene::destroy();
+        scene::create();
+        scene::warm_up(Kind::Window);
+        scene::build(Kind::Window, 0);
+        paint(pixels, WIDTH, HEIGHT, true);
+        CHECK(same(pixels, reference(WIDTH, HEIGHT)));
+
+        scene::destroy();
+        std::fill(pixels.begin(), pixels.end(), 0x12345678);
+        scene::create();
+        scene::warm_up(Kind::Window);
+        scene::build(Kind::Window, 0);
+        paint(pixels, WIDTH, HEIGHT, true);
+        CHECK(same(pixels, reference(WIDTH, HEIGHT)));
+        CHECK(all_tiles_painted());
+    }
+}
+
+int main() {
+    std::mt19937 rng(35);
+    test_div255();
+    test_spans(rng);
+
+    // alive for the whole run, the renderer owns their contents between incremental calls and
+    // a new buffer at the address of an old one would look like the old one
+    Buffer front(WIDTH * HEIGHT, 0);
+    Buffer back(WIDTH * HEIGHT, 0);
+
+    scene::create();
+    for (const bool anti_aliased : { false, true }) {
+        if (anti_aliased) {
+            imgui_sw::restore_style();
+        } else {
+            imgui_sw::make_style_fast();
+        }
+        test_full();
+        test_incremental(front);
+        test_buffer_switch(front, back);
+        test_resize(front);
+        test_glyph_cache();
+    }
+    test_glyph_cache_drop();
+    test_rebind(front);
+    scene::destroy();
+    return test::result();
+}
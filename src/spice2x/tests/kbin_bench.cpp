@@ -0,0 +1,43 @@
+/*
+ * easrv/kbin: decode and encode throughput on the captured payloads, the 76 KB music info
+ * response and the 112 byte pcbtracker alive.
+ */
+
+#include <vector>
+
+#include "easrv/kbin.h"
+#include "util/rc4.h"
+#include "test.h"
+
+#include "easrv/responses/op2_common_get_music_info.h"
+#include "easrv/responses/pcbtracker_alive.h"
+
+// see kbin_test.cpp
+static uint8_t EAMUSE_KEY[] = {
+    0x27, 0x16, 0xde, 0x9a, 0x77, 0xb5, 0xa9, 0x5d,
+    0x34, 0x41, 0xac, 0x06, 0xd3, 0x93, 0x50, 0x81,
+};
+
+static void run(const char *name, const unsigned char *payload, size_t size, size_t iterations) {
+    std::vector<uint8_t> data(payload, payload + size);
+    util::RC4(EAMUSE_KEY, sizeof(EAMUSE_KEY)).crypt(data.data(), data.size());
+
+    kbin::Document doc;
+    const auto decode = test::time_ns(iterations, [&](size_t) {
+        test::keep(kbin::decode(data.data(), data.size(), doc));
+    });
+    std::vector<uint8_t> out;
+    out.reserve(size);
+    const auto encode = test::time_ns(iterations, [&](size_t) {
+        out.clear();
+        test::keep(kbin::encode(doc, out));
+    });
+    printf("%-28s decode %9.2f us (%5.0f MB/s)  encode %9.2f us (%5.0f MB/s)\n", name,
+            decode / 1000.0, size * 1000.0 / decode, encode / 1000.0, size * 1000.0 / encode);
+}
+
+int main() {
+    run("op2_common_get_music_info", OP2_COMMON_GET_MUSIC_INFO_BIN, OP2_COMMON_GET_MUSIC_INFO_BIN_LEN, 2'000);
+    run("pcbtracker_alive", PCBTRACKER_ALIVE_BIN, PCBTRACKER_ALIVE_BIN_LEN, 200'000);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * easrv/kbin: the captured e-amusement payloads decode and re-encode byte for byte, documents
+ * built through the API survive a round trip with their values, attributes and names, XML
+ * printing matches AVS, and truncated or mutated input is rejected or re-encodes stably.
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "easrv/kbin.h"
+#include "external/tinyxml2/tinyxml2.h"
+#include "util/rc4.h"
+#include "test.h"
+
+#include "easrv/responses/bs_info2_common.h"
+#include "easrv/responses/bs_pcb2_boot.h"
+#include "easrv/responses/bs_pcb2_error.h"
+#include "easrv/responses/op2_common_get_music_info.h"
+#include "easrv/responses/pcbtracker_alive.h"
+
+namespace {
+
+    struct Payload {
+        const char *name;
+        const unsigned char *data;
+        unsigned int size;
+        bool encrypted;
+    };
+
+    const Payload PAYLOADS[] = {
+        { "bs_info2_common", BS_INFO2_COMMON_BIN, BS_INFO2_COMMON_BIN_LEN, false },
+        { "bs_pcb2_boot", BS_PCB2_BOOT_BIN, BS_PCB2_BOOT_BIN_LEN, false },
+        { "bs_pcb2_error", BS_PCB2_ERROR_BIN, BS_PCB2_ERROR_BIN_LEN, false },
+        { "op2_common_get_music_info", OP2_COMMON_GET_MUSIC_INFO_BIN, OP2_COMMON_GET_MUSIC_INFO_BIN_LEN, true },
+        { "pcbtracker_alive", PCBTRACKER_ALIVE_BIN, PCBTRACKER_ALIVE_BIN_LEN, true },
+    };
+
+    // RC4 key easrv answers with, for "X-Eamuse-Info: 1-53d121c7-a8b3": the MD5 of the info
+    // bytes followed by the e-amusement secret
+    uint8_t EAMUSE_KEY[] = {
+        0x27, 0x16, 0xde, 0x9a, 0x77, 0xb5, 0xa9, 0x5d,
+        0x34, 0x41, 0xac, 0x06, 0xd3, 0x93, 0x50, 0x81,
+    };
+
+    std::vector<uint8_t> plain(const Payload &payload) {
+        std::vector<uint8_t> data(payload.data, payload.data + payload.size);
+        if (payload.encrypted) {
+            util::RC4(EAMUSE_KEY, sizeof(EAMUSE_KEY)).crypt(data.data(), data.size());
+        }
+        return data;
+    }
+
+    std::string xml(const kbin::Document &doc) {
+        tinyxml2::XMLPrinter printer;
+        kbin::print_xml(doc, printer);
+        return printer.CStr();
+    }
+
+    void test_payloads() {
+        for (auto &payload : PAYLOADS) {
+            const auto data = plain(payload);
+            kbin::Document doc;
+            const bool decoded = kbin::decode(data.data(), data.size(), doc);
+            CHECK(decoded);
+            if (!decoded) {
+                fprintf(stderr, "  %s\n", payload.name);
+                continue;
+            }
+            CHECK(doc.root() != kbin::NONE);
+            CHECK_EQ(doc.name(doc.root()), std::string_view("response"));
+
+            std::vector<uint8_t> encoded;
+            CHECK(kbin::encode(doc, encoded));
+            CHECK(encoded == data);
+        }
+
+        // a few values to be sure the round trip is not just copying garbage
+        const auto data = plain(PAYLOADS[4]);
+        kbin::Document doc;
+        CHECK(kbin::decode(data.data(), data.size(), doc));
+        const auto alive = doc.find(doc.root(), "pcbtracker");
+        CHECK(alive != kbin::NONE);
+        CHECK(!xml(doc).empty());
+    }
+
+    void test_build() {
+        kbin::Document doc;
+        const auto root = doc.add(kbin::NONE, "response");
+        CHECK(doc.add(kbin::NONE, "second") == kbin::NONE);
+        CHECK(doc.add(root, "") == kbin::NONE);
+        CHECK(doc.add(root, std::string(256, 'a')) == kbin::NONE);
+
+        const auto game = doc.add(root, "game");
+        doc.set_attr(game, "status", "0");
+        doc.set_attr(game, "method", "get_music_info");
+        doc.add_value(game, "s8", kbin::Type::S8, -5);
+        doc.add_value(game, "u16", kbin::Type::U16, 0xBEEF);
+        doc.add_value(game, "s64", kbin::Type::S64, -1234567890123LL);
+        doc.add_value(game, "f", kbin::Type::Float, 1.5f);
+        doc.add_value(game, "b", kbin::Type::Bool, 1);
+        doc.add_str(game, "name", "beatmania IIDX");
+        doc.add_value(game, "ip", kbin::Type::Ip4, 0xC0A80001u);
+        const auto array = doc.add_array(game, "scores", kbin::Type::U32, 5);
+        for (unsigned i = 0; i < 5; i++) {
+            doc.set(array, i * 1000, i);
+        }
+        doc.set(array, 7u, 5);
+        const auto pair = doc.add(game, "pos", kbin::Type::S16x2);
+        doc.set(pair, -1, 0);
+        doc.set(pair, 2, 1);
+        const uint8_t blob[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x00 };
+        doc.set_bin(doc.add(game, "blob", kbin::Type::Bin), blob, sizeof(blob));
+
+        // names outside the packed alphabet force plain names
+        kbin::Document plain_names = doc;
+        doc.add(root, "end");
+        plain_names.add(plain_names.root(), "with-dash");
+
+        for (auto *source : { &doc, &plain_names }) {
+            std::vector<uint8_t> encoded;
+            CHECK(kbin::encode(*source, encoded));
+            kbin::Document back;
+            CHECK(kbin::decode(encoded.data(), encoded.size(), back));
+            const auto node = back.find(back.root(), "game");
+            CHECK(node != kbin::NONE);
+            if (node == kbin::NONE) {
+                continue;
+            }
+            CHECK_EQ(back.attr(node, "method"), std::string_view("get_music_info"));
+            CHECK(back.attr(node, "missing").empty());
+            CHECK_EQ(back.get<int>(back.child(node, "s8")), -5);
+            CHECK_EQ(back.get<unsigned>(back.child(node, "u16")), 0xBEEFu);
+            CHECK_EQ(back.get<int64_t>(back.child(node, "s64")), -1234567890123LL);
+            CHECK_EQ(back.get<float>(back.child(node, "f")), 1.5f);
+            CHECK_EQ(back.get<int>(back.child(node, "b")), 1);
+            CHECK_EQ(back.str(back.child(node, "name")), std::string_view("beatmania IIDX"));
+            CHECK_EQ(back.get<unsigned>(back.child(node, "ip")), 0xC0A80001u);
+            const auto scores = back.child(node, "scores");
+            CHECK(back.is_array(scores));
+            CHECK_EQ(back.count(scores), (size_t) 5);
+            CHECK_EQ(back.get<unsigned>(scores, 4), 4000u);
+            CHECK_EQ(back.get<unsigned>(scores, 5), 0u);
+            CHECK_EQ(back.get<int>(back.child(node, "pos"), 0), -1);
+            const auto bin = back.child(node, "blob");
+            CHECK(back.size(bin) == sizeof(blob) && memcmp(back.data(bin), blob, sizeof(blob)) == 0);
+        }
+        CHECK(plain_names.find(plain_names.root(), "with-dash") != kbin::NONE);
+
+        // 64 bytes is the longest plain name
+        kbin::Document long_name;
+        long_name.add(long_name.add(kbin::NONE, "response"), std::string(65, '-'));
+        std::vector<uint8_t> encoded;
+        CHECK(!kbin::encode(long_name, encoded));
+        CHECK(!kbin::encode(kbin::Document {}, encoded));
+    }
+
+    void test_xml() {
+        kbin::Document doc;
+        const auto root = doc.add(kbin::NONE, "response");
+        const auto node = doc.add(root, "pcbtracker");
+        doc.set_attr(node, "ecenable", "1");
+        doc.add_value(node, "expire", kbin::Type::U32, 1200u);
+        const auto array = doc.add_array(node, "list", kbin::Type::S8, 3);
+        doc.set(array, -1, 0);
+        doc.set(array, 2, 2);
+        const uint8_t blob[] = { 0x01, 0xAB };
+        doc.set_bin(doc.add(node, "bin", kbin::Type::Bin), blob, sizeof(blob));
+        doc.add_str(node, "s", "text");
+        CHECK_EQ(xml(doc), std::string(
+                "<?xml version=\"1.0\" encoding=\"SHIFT_JIS\"?>\n"
+                "<response>\n"
+                "    <pcbtracker ecenable=\"1\">\n"
+                "        <expire __type=\"u32\">1200</expire>\n"
+                "        <list __type=\"s8\" __count=\"3\">-1 0 2</list>\n"
+                "        <bin __type=\"bin\" __size=\"2\">01ab</bin>\n"
+                "        <s __type=\"str\">text</s>\n"
+                "    </pcbtracker>\n"
+                "</response>\n"));
+    }
+
+    void test_malformed() {
+        const auto original = plain(PAYLOADS[1]);
+
+        // every truncation, then random mutations of a real message
+        for (size_t length = 0; length < original.size(); length++) {
+            kbin::Document doc;
+            CHECK(!kbin::decode(original.data(), length, doc));
+        }
+        std::mt19937 rng(7);
+        size_t accepted = 0;
+        for (int round = 0; round < 20000; round++) {
+            auto data = original;
+            for (int flips = 1 + rng() % 3; flips > 0; flips--) {
+                data[rng() % data.size()] = (uint8_t) rng();
+            }
+            kbin::Document doc;
+            if (!kbin::decode(data.data(), data.size(), doc)) {
+                continue;
+            }
+            accepted++;
+
+            // whatever decodes must re-encode to something that decodes to the same again
+            std::vector<uint8_t> first, second;
+            if (kbin::encode(doc, first)) {
+                kbin::Document again;
+                CHECK(kbin::decode(first.data(), first.size(), again));
+                CHECK(kbin::encode(again, second));
+                CHECK(first == second);
+            }
+            test::keep(xml(doc).size());
+        }
+        test::keep(accepted);
+    }
+}
+
+int main() {
+    test_payloads();
+    test_build();
+    test_xml();
+    test_malformed();
+    return test::result();
+}
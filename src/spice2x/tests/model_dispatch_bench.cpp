@@ -0,0 +1,458 @@
+/*
+ * status buffer updates of acio/kfca, acio/bi2a and acio/mdxf, per device and game
+ *
+ * the hook bodies are mirrored here with the same button reads, knob cleaning and buffer
+ * writes. Only Buttons::getState() and the clock are stand-ins, the real ones need the
+ * rawinput manager; both stay out of line like the real calls into other units.
+ *
+ * before: every hook walked its chain of is_model() checks, each a case-insensitive string
+ *         compare in avs/game.cpp.
+ * after:  one switch on the packed MODEL_ID into the per-game specialization.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <strings.h>
+#include <vector>
+
+#include "avs/model_id.h"
+#include "util/socd_cleaner.h"
+#include "test.h"
+
+#define ARRAY_SETB(A, k) ((A)[((k) / 8)] |= (1 << ((k) % 8)))
+
+using avs::game::model_id;
+
+namespace {
+
+    char MODEL[4] = "KFC";
+    uint32_t MODEL_ID = model_id(MODEL);
+
+    // avs::game::is_model() before the packed id, it lived in another unit
+    __attribute__((noinline)) bool is_model(const char *model) {
+        return strcasecmp(MODEL, model) == 0;
+    }
+
+    /*
+     * stand-ins for the rawinput side
+     */
+
+    struct Button {
+        bool pressed = false;
+    };
+    struct Analog {
+        bool set = false;
+    };
+    std::vector<Button> BUTTONS(32);
+    std::vector<Analog> ANALOGS(2);
+    double NOW = 0;
+
+    __attribute__((noinline)) bool get_state(const Button &button) {
+        return *(volatile bool *) &button.pressed;
+    }
+
+    __attribute__((noinline)) double get_performance_milliseconds() {
+        return NOW += 1.0;
+    }
+
+    bool pressed(size_t button) {
+        return get_state(BUTTONS.at(button));
+    }
+
+    // button indices shared by all games here, the hooks only care about the reads
+    enum {
+        TEST, SERVICE, COIN, START, B1, B2, B3, B4, B5, B6, B7, B8, B9, B10, KNOB_L_CCW, KNOB_L_CW,
+        KNOB_R_CCW, KNOB_R_CW,
+    };
+
+    constexpr unsigned int DIGITAL_KNOB_SENS = 16;
+
+    // knob handling as in the KFC hooks, writes the 10-bit positions
+    void knobs(unsigned int &vol_l, unsigned int &vol_r, unsigned int &left, unsigned int &right) {
+        const auto now = get_performance_milliseconds();
+        const auto vol_l_state = socd::socd_clean(0, pressed(KNOB_L_CCW), pressed(KNOB_L_CW), now);
+        if (vol_l_state == socd::SocdCCW) {
+            vol_l = (vol_l - DIGITAL_KNOB_SENS) & 1023;
+        } else if (vol_l_state == socd::SocdCW) {
+            vol_l = (vol_l + DIGITAL_KNOB_SENS) & 1023;
+        }
+        const auto vol_r_state = socd::socd_clean(1, pressed(KNOB_R_CCW), pressed(KNOB_R_CW), now);
+        if (vol_r_state == socd::SocdCCW) {
+            vol_r = (vol_r - DIGITAL_KNOB_SENS) & 1023;
+        } else if (vol_r_state == socd::SocdCW) {
+            vol_r = (vol_r + DIGITAL_KNOB_SENS) & 1023;
+        }
+        left = vol_l;
+        right = vol_r;
+        if (ANALOGS.at(0).set || ANALOGS.at(1).set) {
+            left += 512;
+            right += 512;
+        }
+        left %= 1024;
+        right %= 1024;
+    }
+
+    /*
+     * acio/kfca
+     */
+
+    uint8_t KFCA_BUFFER[64];
+    unsigned int KFCA_VOLL = 0, KFCA_VOLR = 0;
+
+    template<uint32_t Model>
+    void kfca_game() {
+    }
+
+    template<>
+    void kfca_game<model_id("KFC")>() {
+        auto buffer = &KFCA_BUFFER[4];
+        if (pressed(TEST)) buffer[1] |= 0x20;
+        if (pressed(SERVICE)) buffer[1] |= 0x10;
+        if (pressed(COIN)) buffer[1] |= 0x04;
+        if (pressed(START)) buffer[9] |= 0x08;
+        if (pressed(B1)) buffer[9] |= 0x04;
+        if (pressed(B2)) buffer[9] |= 0x02;
+        if (pressed(B3)) buffer[9] |= 0x01;
+        if (pressed(B4)) buffer[11] |= 0x20;
+        if (pressed(B5)) buffer[11] |= 0x10;
+        if (pressed(B6)) buffer[11] |= 0x08;
+        if (pressed(B7)) buffer[9] |= 0x20;
+        unsigned int left, right;
+        knobs(KFCA_VOLL, KFCA_VOLR, left, right);
+        buffer[16] |= (uint8_t) (left << 6);
+        buffer[17] |= (uint8_t) (left >> 2);
+        buffer[18] |= (uint8_t) (right << 6);
+        buffer[19] |= (uint8_t) (right >> 2);
+    }
+
+    template<>
+    void kfca_game<model_id("NBT")>() {
+        if (pressed(TEST)) KFCA_BUFFER[5] |= 0x20;
+        if (pressed(SERVICE)) KFCA_BUFFER[5] |= 0x10;
+        if (pressed(COIN)) KFCA_BUFFER[5] |= 0x04;
+    }
+
+    template<>
+    void kfca_game<model_id("PAN")>() {
+        if (pressed(SERVICE)) KFCA_BUFFER[5] |= 0x10;
+        if (pressed(TEST)) KFCA_BUFFER[5] |= 0x20;
+        if (pressed(COIN)) KFCA_BUFFER[5] |= 0x04;
+    }
+
+    template<>
+    void kfca_game<model_id("NSC")>() {
+        if (pressed(TEST)) KFCA_BUFFER[5] |= 0x20;
+        if (pressed(SERVICE)) KFCA_BUFFER[5] |= 0x10;
+        if (pressed(COIN)) KFCA_BUFFER[5] |= 0x04;
+        if (pressed(START)) KFCA_BUFFER[13] |= 0x20;
+        if (pressed(B1)) KFCA_BUFFER[13] |= 0x10;
+        if (pressed(B2)) KFCA_BUFFER[13] |= 0x08;
+    }
+
+    char kfca_update_before() {
+        memset(KFCA_BUFFER, 0, sizeof(KFCA_BUFFER));
+        if (is_model("KFC")) kfca_game<model_id("KFC")>();
+        if (is_model("NBT")) kfca_game<model_id("NBT")>();
+        if (is_model("PAN")) kfca_game<model_id("PAN")>();
+        if (is_model("NSC")) kfca_game<model_id("NSC")>();
+        return true;
+    }
+
+    char kfca_update_after() {
+        memset(KFCA_BUFFER, 0, sizeof(KFCA_BUFFER));
+        switch (MODEL_ID) {
+            case model_id("KFC"): kfca_game<model_id("KFC")>(); break;
+            case model_id("NBT"): kfca_game<model_id("NBT")>(); break;
+            case model_id("PAN"): kfca_game<model_id("PAN")>(); break;
+            case model_id("NSC"): kfca_game<model_id("NSC")>(); break;
+            default: break;
+        }
+        return true;
+    }
+
+    /*
+     * acio/bi2a
+     */
+
+    uint8_t BI2A_BUFFER[272];
+    unsigned int BI2A_VOLL = 0, BI2A_VOLR = 0;
+
+    template<uint32_t Model>
+    void bi2a_game() {
+    }
+
+    template<>
+    void bi2a_game<model_id("KFC")>() {
+        memset(BI2A_BUFFER, 0, std::size(BI2A_BUFFER));
+        BI2A_BUFFER[0] = 1;
+        if (pressed(TEST)) ARRAY_SETB(BI2A_BUFFER, 19);
+        if (pressed(SERVICE)) ARRAY_SETB(BI2A_BUFFER, 18);
+        if (pressed(COIN)) ARRAY_SETB(BI2A_BUFFER, 17);
+        if (pressed(START)) ARRAY_SETB(BI2A_BUFFER, 85);
+        if (pressed(B1)) ARRAY_SETB(BI2A_BUFFER, 84);
+        if (pressed(B2)) ARRAY_SETB(BI2A_BUFFER, 83);
+        if (pressed(B3)) ARRAY_SETB(BI2A_BUFFER, 82);
+        if (pressed(B4)) ARRAY_SETB(BI2A_BUFFER, 81);
+        if (pressed(B5)) ARRAY_SETB(BI2A_BUFFER, 80);
+        if (pressed(B6)) ARRAY_SETB(BI2A_BUFFER, 95);
+        if (pressed(B7)) ARRAY_SETB(BI2A_BUFFER, 87);
+        unsigned int left, right;
+        knobs(BI2A_VOLL, BI2A_VOLR, left, right);
+        const auto vol_left = (uint16_t) (left << 2);
+        const auto vol_right = (uint16_t) (right << 2);
+        memcpy(&BI2A_BUFFER[17], &vol_left, 2);
+        memcpy(&BI2A_BUFFER[19], &vol_right, 2);
+    }
+
+    template<>
+    void bi2a_game<model_id("MDX")>() {
+        memset(BI2A_BUFFER, 0, std::size(BI2A_BUFFER));
+        BI2A_BUFFER[0] = 1;
+        if (pressed(COIN)) BI2A_BUFFER[2] |= 1 << 1;
+        if (pressed(SERVICE)) BI2A_BUFFER[2] |= 1 << 2;
+        if (pressed(TEST)) BI2A_BUFFER[2] |= 1 << 3;
+        if (pressed(START)) BI2A_BUFFER[10] |= 1 << 7;
+        if (pressed(B1)) BI2A_BUFFER[10] |= 1 << 6;
+        if (pressed(B2)) BI2A_BUFFER[10] |= 1 << 5;
+        if (pressed(B3)) BI2A_BUFFER[10] |= 1 << 4;
+        if (pressed(B4)) BI2A_BUFFER[10] |= 1 << 3;
+        if (pressed(B5)) BI2A_BUFFER[11] |= 1 << 5;
+        if (pressed(B6)) BI2A_BUFFER[11] |= 1 << 4;
+        if (pressed(B7)) BI2A_BUFFER[11] |= 1 << 3;
+        if (pressed(B8)) BI2A_BUFFER[11] |= 1 << 2;
+        if (pressed(B9)) BI2A_BUFFER[11] |= 1 << 1;
+    }
+
+    template<>
+    void bi2a_game<model_id("REC")>() {
+        memset(BI2A_BUFFER, 0, std::size(BI2A_BUFFER));
+        BI2A_BUFFER[0] = 1;
+        if (pressed(TEST)) ARRAY_SETB(BI2A_BUFFER, 19);
+        if (pressed(SERVICE)) ARRAY_SETB(BI2A_BUFFER, 18);
+        if (pressed(COIN)) ARRAY_SETB(BI2A_BUFFER, 17);
+        if (pressed(START)) ARRAY_SETB(BI2A_BUFFER, 87);
+        if (pressed(B1)) ARRAY_SETB(BI2A_BUFFER, 86);
+        if (pressed(B2)) ARRAY_SETB(BI2A_BUFFER, 85);
+        if (pressed(B3)) ARRAY_SETB(BI2A_BUFFER, 84);
+        if (pressed(B4)) ARRAY_SETB(BI2A_BUFFER, 83);
+        if (pressed(B5)) ARRAY_SETB(BI2A_BUFFER, 93);
+        if (pressed(B6)) ARRAY_SETB(BI2A_BUFFER, 92);
+        if (pressed(B7)) ARRAY_SETB(BI2A_BUFFER, 91);
+        if (pressed(B8)) ARRAY_SETB(BI2A_BUFFER, 90);
+        if (pressed(B9)) ARRAY_SETB(BI2A_BUFFER, 89);
+    }
+
+    bool bi2a_update_before() {
+        if (is_model("KFC")) bi2a_game<model_id("KFC")>();
+        if (is_model("MDX")) bi2a_game<model_id("MDX")>();
+        if (is_model("REC")) bi2a_game<model_id("REC")>();
+        return true;
+    }
+
+    bool bi2a_update_after() {
+        switch (MODEL_ID) {
+            case model_id("KFC"): bi2a_game<model_id("KFC")>(); break;
+            case model_id("MDX"): bi2a_game<model_id("MDX")>(); break;
+            case model_id("REC"): bi2a_game<model_id("REC")>(); break;
+            default: break;
+        }
+        return true;
+    }
+
+    /*
+     * acio/mdxf, polled by the game for both players: update, then read back the newest entry
+     */
+
+    constexpr size_t STATUS_BUFFER_SIZE = 32;
+    constexpr size_t STATUS_BUFFER_NUM_ENTRIES = 16;
+    constexpr uint64_t BACKFILL_INTERVAL_MS = 4;
+    constexpr uint64_t BACKFILL_PADDING_MS = 2;
+
+    struct Player {
+        std::mutex mutex;
+        uint8_t head = 0;
+        uint16_t prev_state = 0;
+        uint64_t prev_time = 0;
+        uint8_t buffer[STATUS_BUFFER_NUM_ENTRIES][STATUS_BUFFER_SIZE] {};
+    };
+    Player PLAYERS[2];
+
+    Player *player_of(int node) {
+        switch (node) {
+            case 17:
+            case 25:
+                return &PLAYERS[0];
+            case 18:
+            case 26:
+                return &PLAYERS[1];
+            default:
+                return nullptr;
+        }
+    }
+
+    uint64_t mdxf_error_value(int node) {
+        return static_cast<uint64_t>(node - 0x11) & 0xFFFFFFFFFFFFFF00;
+    }
+
+    template<uint32_t Model>
+    uint64_t mdxf_get_game(int node, void *, uint8_t, uint8_t) {
+        return mdxf_error_value(node);
+    }
+
+    template<>
+    uint64_t mdxf_get_game<model_id("MDX")>(int node, void *out, uint8_t index, uint8_t head_in) {
+        const auto player = player_of(node);
+        if (player == nullptr) {
+            memset(out, 0, STATUS_BUFFER_SIZE);
+            return mdxf_error_value(node);
+        }
+        std::lock_guard<std::mutex> lock(player->mutex);
+        const uint8_t start_index = head_in == 0xFF ? player->head : head_in;
+        const size_t mask = STATUS_BUFFER_NUM_ENTRIES - 1;
+        const size_t i = ((size_t) start_index - ((size_t) index & mask) + STATUS_BUFFER_NUM_ENTRIES) & mask;
+        memcpy(out, player->buffer[i], STATUS_BUFFER_SIZE);
+        return start_index;
+    }
+
+    template<uint32_t Model>
+    bool mdxf_update_game(int, uint64_t) {
+        return true;
+    }
+
+    // the game's own poll, which reuses the state the last input event left
+    template<>
+    bool mdxf_update_game<model_id("MDX")>(int node, uint64_t current_time) {
+        const auto player = player_of(node);
+        if (player == nullptr) {
+            return false;
+        }
+        const uint16_t current_state = player->prev_state;
+        std::lock_guard<std::mutex> lock(player->mutex);
+        if (player->prev_time >= current_time) {
+            return true;
+        }
+        uint64_t start_time = player->prev_time;
+        const uint64_t stop_time = current_time - std::min<uint64_t>(current_time, BACKFILL_PADDING_MS);
+        if (start_time == 0) {
+            start_time = current_time - std::min<uint64_t>(current_time, BACKFILL_INTERVAL_MS);
+        }
+        const uint64_t min_time = current_time
+                - std::min<uint64_t>(current_time, BACKFILL_INTERVAL_MS * STATUS_BUFFER_NUM_ENTRIES);
+        start_time = std::max(start_time, min_time);
+        uint64_t time = start_time;
+        uint16_t state = player->prev_state;
+        while (time < stop_time) {
+            player->head = (player->head + 1) % STATUS_BUFFER_NUM_ENTRIES;
+            auto entry = player->buffer[player->head];
+            memset(entry, 0, STATUS_BUFFER_SIZE);
+            time += BACKFILL_INTERVAL_MS;
+            if (time >= stop_time) {
+                state = current_state;
+                time = current_time;
+            }
+            entry[4] = (uint8_t) (state >> 8);
+            entry[5] = (uint8_t) state;
+            memcpy(&entry[0x18], &time, sizeof(time));
+        }
+        player->prev_state = current_state;
+        player->prev_time = current_time;
+        return true;
+    }
+
+    uint64_t mdxf_get_before(int node, void *out, uint8_t index, uint8_t head_in) {
+        if (is_model("MDX")) {
+            return mdxf_get_game<model_id("MDX")>(node, out, index, head_in);
+        }
+        return mdxf_error_value(node);
+    }
+
+    bool mdxf_update_before(int node, uint64_t time) {
+        if (is_model("MDX")) {
+            return mdxf_update_game<model_id("MDX")>(node, time);
+        }
+        return true;
+    }
+
+    uint64_t mdxf_get_after(int node, void *out, uint8_t index, uint8_t head_in) {
+        switch (MODEL_ID) {
+            case model_id("MDX"):
+                return mdxf_get_game<model_id("MDX")>(node, out, index, head_in);
+            default:
+                return mdxf_error_value(node);
+        }
+    }
+
+    bool mdxf_update_after(int node, uint64_t time) {
+        switch (MODEL_ID) {
+            case model_id("MDX"):
+                return mdxf_update_game<model_id("MDX")>(node, time);
+            default:
+                return true;
+        }
+    }
+
+    void set_model(const char *model) {
+        strcpy(MODEL, model);
+        MODEL_ID = model_id(model);
+
+        // a few buttons held, so both sides of the reads get taken
+        for (size_t i = 0; i < BUTTONS.size(); i++) {
+            BUTTONS[i].pressed = i % 3 == 0;
+        }
+    }
+
+    void report(const char *device, const char *model, double before, double after) {
+        printf("%-5s %s  is_model chain %6.2f ns  MODEL_ID switch %6.2f ns  (%.2fx)\n",
+                device, model, before, after, before / after);
+    }
+}
+
+int main() {
+    constexpr size_t iterations = 4'000'000;
+
+    // the game calls the hooks through pointers, so nothing gets inlined into its poll loop
+    for (const char *model : { "KFC", "NBT", "PAN", "NSC" }) {
+        set_model(model);
+        char (*volatile before_fn)() = kfca_update_before;
+        char (*volatile after_fn)() = kfca_update_after;
+        const auto before = test::time_ns(iterations, [&](size_t) { before_fn(); });
+        const auto after = test::time_ns(iterations, [&](size_t) { after_fn(); });
+        report("kfca", model, before, after);
+    }
+    test::keep(KFCA_BUFFER);
+
+    for (const char *model : { "KFC", "MDX", "REC" }) {
+        set_model(model);
+        bool (*volatile before_fn)() = bi2a_update_before;
+        bool (*volatile after_fn)() = bi2a_update_after;
+        const auto before = test::time_ns(iterations, [&](size_t) { before_fn(); });
+        const auto after = test::time_ns(iterations, [&](size_t) { after_fn(); });
+        report("bi2a", model, before, after);
+    }
+    test::keep(BI2A_BUFFER);
+
+    // one poll of the game: update and read back both players, 8 ms apart
+    set_model("MDX");
+    uint8_t out[STATUS_BUFFER_SIZE];
+    const auto poll = [&](auto update, auto get, size_t i) {
+        const auto time = 1000 + i * 8;
+        update(17, time);
+        update(18, time);
+        get(17, out, 0, 0xFF);
+        get(18, out, 0, 0xFF);
+    };
+    bool (*volatile update_before)(int, uint64_t) = mdxf_update_before;
+    uint64_t (*volatile get_before)(int, void *, uint8_t, uint8_t) = mdxf_get_before;
+    bool (*volatile update_after)(int, uint64_t) = mdxf_update_after;
+    uint64_t (*volatile get_after)(int, void *, uint8_t, uint8_t) = mdxf_get_after;
+    const auto before = test::time_ns(iterations, [&](size_t i) { poll(update_before, get_before, i); });
+    for (auto &player : PLAYERS) {
+        player.prev_time = 0;
+    }
+    const auto after = test::time_ns(iterations, [&](size_t i) { poll(update_after, get_after, i); });
+    test::keep(out);
+    report("mdxf", "MDX", before, after);
+    return 0;
+}
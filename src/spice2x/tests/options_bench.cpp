@@ -0,0 +1,256 @@
+/*
+ * launcher/options: parse_options on a 26 argument command line, time and heap allocations per
+ * call, and a single flag lookup.
+ *
+ * before: every Option held its own copy of its definition, all std::string, and every argument
+ *         was compared against every option, splitting each alias list through an
+ *         istringstream, once for the flags and once more for the positional arguments.
+ * after:  Options refer to the registry by index, and each argument is one perfect hash lookup
+ *         in a single pass.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+#include "launcher/options.h"
+#include "test.h"
+
+namespace {
+
+    std::atomic<bool> COUNTING {false};
+    size_t ALLOCATIONS = 0;
+    size_t ALLOCATED_BYTES = 0;
+
+    void *allocate(size_t size) {
+        if (COUNTING.load(std::memory_order_relaxed)) {
+            ALLOCATIONS++;
+            ALLOCATED_BYTES += size;
+        }
+        if (auto ptr = malloc(size ? size : 1)) {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void *operator new(size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace {
+
+    // cfg/option.h before the registry indices
+    struct LegacyDefinition {
+        std::string title;
+        std::string name;
+        std::string display_name = "";
+        std::string aliases = "";
+        std::string desc;
+        OptionType type;
+        bool hidden = false;
+        std::string setting_name = "";
+        std::string game_name = "";
+        std::string category = "Development";
+        bool sensitive = false;
+        std::vector<std::pair<std::string, std::string>> elements = {};
+        bool disabled = false;
+        OptionPickerType picker = OptionPickerType::None;
+        std::string file_extension = "";
+        std::string quick_setting_category = "";
+    };
+
+    class LegacyOption {
+    private:
+        LegacyDefinition definition;
+        std::string search_string;
+
+    public:
+        std::string value;
+        std::vector<LegacyOption> alternatives;
+        bool disabled = false;
+        bool conflicting = false;
+
+        explicit LegacyOption(LegacyDefinition definition, std::string value = "") :
+            definition(std::move(definition)), value(std::move(value)) {
+        };
+
+        void value_add(std::string new_value) {
+            if (this->value.empty()) {
+                this->value = std::move(new_value);
+                return;
+            }
+            this->alternatives.emplace_back(this->definition, std::move(new_value));
+        }
+    };
+
+    std::vector<LegacyDefinition> legacy_registry() {
+        std::vector<LegacyDefinition> registry;
+        for (const auto &definition : launcher::get_option_definitions()) {
+            auto &legacy = registry.emplace_back(LegacyDefinition {
+                .title = std::string(definition.title),
+                .name = std::string(definition.name),
+                .display_name = std::string(definition.display_name),
+                .aliases = std::string(definition.aliases),
+                .desc = std::string(definition.desc),
+                .type = definition.type,
+                .hidden = definition.hidden,
+                .setting_name = std::string(definition.setting_name),
+                .game_name = std::string(definition.game_name),
+                .category = std::string(definition.category),
+                .sensitive = definition.sensitive,
+                .disabled = definition.disabled,
+                .picker = definition.picker,
+                .file_extension = std::string(definition.file_extension),
+                .quick_setting_category = std::string(definition.quick_setting_category),
+            });
+            for (const auto &[first, second] : definition.elements) {
+                legacy.elements.emplace_back(first, second);
+            }
+        }
+        return registry;
+    }
+
+    void strsplit(const std::string &str, std::vector<std::string> &cont, char delim) {
+        std::istringstream ss(str);
+        std::string token;
+        while (std::getline(ss, token, delim)) {
+            cont.push_back(token);
+        }
+    }
+
+    // launcher::parse_options before the single pass, parameter validation left out
+    std::vector<LegacyOption> legacy_parse(const std::vector<LegacyDefinition> &definitions,
+            int argc, char *argv[]) {
+        std::vector<LegacyOption> options;
+        options.reserve(definitions.size());
+        for (auto &definition : definitions) {
+            std::vector<std::string> aliases;
+            aliases.push_back(definition.name);
+            if (!definition.aliases.empty()) {
+                strsplit(definition.aliases, aliases, '/');
+            }
+            auto &option = options.emplace_back(definition, "");
+            for (int i = 1; i < argc; i++) {
+                auto argument = argv[i];
+                while (argument[0] == '-') {
+                    argument++;
+                }
+                for (const auto &alias : aliases) {
+                    if (strcasecmp(alias.c_str(), argument) == 0) {
+                        if (definition.type == OptionType::Bool) {
+                            option.value_add("/ENABLED");
+                        } else if (++i < argc && definition.type != OptionType::Hex) {
+                            option.value_add(argv[i]);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::string> positional;
+        for (int i = 1; i < argc; i++) {
+            bool found = false;
+            for (auto &definition : definitions) {
+                std::vector<std::string> aliases;
+                aliases.push_back(definition.name);
+                if (!definition.aliases.empty()) {
+                    strsplit(definition.aliases, aliases, '/');
+                }
+                auto argument = argv[i];
+                while (argument[0] == '-') {
+                    argument++;
+                }
+                for (const auto &alias : aliases) {
+                    if (strcasecmp(alias.c_str(), argument) == 0) {
+                        found = true;
+                        if (definition.type != OptionType::Bool) {
+                            i++;
+                        }
+                        break;
+                    }
+                }
+                if (found) {
+                    break;
+                }
+            }
+            if (!found && *argv[i] != '-') {
+                positional.emplace_back(argv[i]);
+            }
+        }
+        if (!positional.empty()) {
+            options.at(launcher::Options::GameExecutable).value = positional[0];
+        }
+        return options;
+    }
+
+    template<typename Fn>
+    void measure(const char *name, size_t iterations, Fn &&fn) {
+        fn();
+        ALLOCATIONS = 0;
+        ALLOCATED_BYTES = 0;
+        COUNTING = true;
+        fn();
+        COUNTING = false;
+        const size_t allocations = ALLOCATIONS, bytes = ALLOCATED_BYTES;
+        const auto ns = test::time_ns(iterations, [&](size_t) {
+            fn();
+        });
+        printf("%-7s %9.2f us, %5zu allocations, %7zu bytes\n", name, ns / 1000.0, allocations, bytes);
+    }
+}
+
+int main() {
+    const char *arguments[] = {
+        "spice.exe", "-ea", "-url", "ea", "-p", "01201000000000010101", "-w",
+        "-card0", "E004010000000000", "-mainmonitor", "1", "-overlayscale", "150",
+        "-processaffinity", "0x1ff00", "-iidx", "-iidxflipcams", "-richpresence",
+        "-sp2x-autofps", "-nolegacy", "-http11", "-ssldisable", "-toast", "1",
+        "-iidxledcolor", "ff0000", "bm2dx.dll",
+    };
+    std::vector<char *> argv;
+    for (auto argument : arguments) {
+        argv.push_back(const_cast<char *>(argument));
+    }
+    const int argc = static_cast<int>(argv.size());
+
+    const auto registry = legacy_registry();
+    printf("%d arguments, %zu options\n", argc - 1, registry.size());
+    measure("before", 200, [&] {
+        test::keep(legacy_parse(registry, argc, argv.data()).size());
+    });
+    measure("after", 20'000, [&] {
+        test::keep(launcher::parse_options(argc, argv.data())->size());
+    });
+
+    const auto lookup = test::time_ns(1'000'000, [&](size_t i) {
+        test::keep(launcher::find_option(i % 2 ? "IIDXLEDCOLOR" : "nosuchoption"));
+    });
+    printf("find_option %6.1f ns\n", lookup);
+    return 0;
+}
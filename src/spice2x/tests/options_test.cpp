@@ -0,0 +1,185 @@
+/*
+ * launcher/options, launcher/option_aliases: the flag lookup built from the real registry,
+ * every name and alias case-insensitively and misses for anything else, and parse_options on
+ * the cases the single pass fixed. alias collisions are checked in a child process, since
+ * log_fatal aborts.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "launcher/options.h"
+#include "launcher/option_aliases.h"
+#include "test.h"
+
+using launcher::OptionAliasTable;
+
+namespace {
+
+    std::vector<std::string> keys_of(const OptionDefinition &definition) {
+        std::vector<std::string> keys { std::string(definition.name) };
+        std::string_view aliases = definition.aliases;
+        while (!aliases.empty()) {
+            const auto separator = aliases.find('/');
+            keys.emplace_back(aliases.substr(0, separator));
+            aliases.remove_prefix(separator == std::string_view::npos ? aliases.size() : separator + 1);
+        }
+        return keys;
+    }
+
+    std::string with_case(std::string key, bool upper, bool alternate) {
+        for (size_t i = 0; i < key.size(); i++) {
+            if (!alternate || i % 2 == 0) {
+                key[i] = upper ? toupper(key[i]) : tolower(key[i]);
+            }
+        }
+        return key;
+    }
+
+    void test_registry_lookup() {
+        const auto &definitions = launcher::get_option_definitions();
+        const OptionAliasTable table(definitions);
+        size_t keys = 0;
+        for (size_t index = 0; index < definitions.size(); index++) {
+            for (const auto &key : keys_of(definitions[index])) {
+                keys++;
+                for (const auto &variant : {
+                        key, with_case(key, true, false), with_case(key, false, false),
+                        with_case(key, true, true) }) {
+                    CHECK(table.find(variant) == index);
+                    CHECK(launcher::find_option(variant) == index);
+                }
+
+                // near misses
+                CHECK(!table.find(key + "x").has_value());
+                CHECK(!table.find("-" + key).has_value());
+            }
+        }
+        CHECK(keys > definitions.size());
+
+        for (const char *unknown : { "", "-", "nosuchoption", "url ", " url", "eaa", "ure" }) {
+            CHECK(!table.find(unknown).has_value());
+        }
+    }
+
+    std::unique_ptr<std::vector<Option>> parse(std::vector<const char *> arguments) {
+        std::vector<char *> argv { const_cast<char *>("spice.exe") };
+        for (auto argument : arguments) {
+            argv.push_back(const_cast<char *>(argument));
+        }
+        return launcher::parse_options(static_cast<int>(argv.size()), argv.data());
+    }
+
+    void test_parse() {
+        using namespace launcher::Options;
+
+        // a parameter naming another option is only the parameter
+        {
+            auto options = parse({ "-url", "ea", "game.dll" });
+            CHECK(options->at(ServiceURL).value == "ea");
+            CHECK(!options->at(EAmusementEmulation).is_active());
+            CHECK(options->at(GameExecutable).value == "game.dll");
+        }
+        {
+            auto options = parse({ "--EA", "-URL", "http://localhost/" });
+            CHECK(options->at(EAmusementEmulation).value_bool());
+            CHECK(options->at(ServiceURL).value == "http://localhost/");
+            CHECK(!options->at(GameExecutable).is_active());
+        }
+
+        // hex parameters are kept, by name and by alias
+        {
+            auto options = parse({ "-processaffinity", "0x1ff00", "-sp2x-iidxledcolor", "ff00ff" });
+            CHECK(options->at(spice2x_ProcessAffinity).value == "0x1ff00");
+            CHECK_EQ(options->at(spice2x_ProcessAffinity).value_hex64(), (uint64_t) 0x1ff00);
+            CHECK_EQ(options->at(spice2x_IIDXLEDColor).value_hex64(), (uint64_t) 0xff00ff);
+        }
+
+        // repeats become alternatives, unknown flags are skipped without eating the next one
+        {
+            auto options = parse({ "-nosuchflag", "-url", "a", "-url", "b", "game.dll", "extra" });
+            const auto values = options->at(ServiceURL).values();
+            CHECK(values.size() == 2 && values[0] == "a" && values[1] == "b");
+            CHECK(options->at(GameExecutable).value == "game.dll");
+        }
+    }
+
+    // runs `fn` in a child, returns whether it aborted and what it wrote to stderr
+    template<typename Fn>
+    bool aborts(Fn &&fn, std::string &output) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) {
+            return false;
+        }
+        const pid_t pid = fork();
+        if (pid == 0) {
+            dup2(pipe_fds[1], STDERR_FILENO);
+            close(pipe_fds[0]);
+            fn();
+            _exit(0);
+        }
+        close(pipe_fds[1]);
+        char buffer[512];
+        ssize_t size;
+        while ((size = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) {
+            output.append(buffer, size);
+        }
+        close(pipe_fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+    }
+
+    OptionDefinition definition(std::string_view name, std::string_view aliases) {
+        return OptionDefinition {
+            .title = name,
+            .name = name,
+            .aliases = aliases,
+            .desc = "",
+            .type = OptionType::Bool,
+        };
+    }
+
+    void test_collisions() {
+
+        // slash separated aliases, and an alias repeating its own option's name, are fine
+        const std::vector<OptionDefinition> fine {
+            definition("alpha", "a/first/ALPHA"),
+            definition("beta", "b"),
+        };
+        const OptionAliasTable table(fine);
+        CHECK(table.find("first") == (size_t) 0);
+        CHECK(table.find("A") == (size_t) 0);
+        CHECK(table.find("b") == (size_t) 1);
+        CHECK(!table.find("a/first").has_value());
+
+        const std::vector<std::vector<OptionDefinition>> colliding {
+            { definition("alpha", "shared"), definition("beta", "SHARED") },
+            { definition("alpha", ""), definition("beta", "Alpha") },
+            { definition("alpha", "x/y"), definition("Alpha", "") },
+        };
+        for (const auto &definitions : colliding) {
+            std::string output;
+            CHECK(aborts([&] {
+                const OptionAliasTable table(definitions);
+            }, output));
+            CHECK(output.find("is used by both -alpha and -") != std::string::npos);
+        }
+
+        std::string output;
+        CHECK(!aborts([] {
+            const OptionAliasTable table(launcher::get_option_definitions());
+        }, output));
+    }
+}
+
+int main() {
+    test_registry_lookup();
+    test_parse();
+    test_collisions();
+    return test::result();
+}
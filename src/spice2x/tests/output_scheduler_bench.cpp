@@ -0,0 +1,97 @@
+/*
+ * rawinput/output_scheduler: a 1 kHz game loop writing 8 lights over 3 devices per poll into
+ * a sink that blocks 300 us per device write, like a slow HID or serial device. Reports the
+ * device writes, the time the game thread spends per poll and the latency of a change.
+ *
+ * write-through: what the game thread would pay calling the sink on every light change
+ * kick:          marks plus one kick per poll, devices limited to a write every 4 ms
+ * push:          no kick at all, every change pushed, like sextet devices
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "rawinput/output_scheduler.h"
+#include "test.h"
+
+using namespace std::chrono_literals;
+using rawinput::OutputScheduler;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+    struct Device {
+        int lights[8] {};
+    };
+
+    std::atomic<size_t> WRITES {0};
+
+    void slow_write(Device *) {
+        const auto end = clock_type::now() + 300us;
+        while (clock_type::now() < end) {
+        }
+        WRITES++;
+    }
+
+    enum class Mode {
+        WriteThrough,
+        Kick,
+        Push,
+    };
+
+    void run(const char *name, Mode mode) {
+        constexpr int polls = 500;
+        Device devices[3];
+        OutputScheduler<Device> scheduler(slow_write);
+        scheduler.start();
+        WRITES = 0;
+
+        clock_type::duration busy {};
+        auto next = clock_type::now();
+        for (int poll = 0; poll < polls; poll++) {
+            const auto start = clock_type::now();
+            for (int light = 0; light < 8; light++) {
+                auto &device = devices[light % 3];
+                device.lights[light] = poll;
+                switch (mode) {
+                    case Mode::WriteThrough:
+                        slow_write(&device);
+                        break;
+                    case Mode::Kick:
+                        scheduler.mark(&device, 4ms);
+                        break;
+                    case Mode::Push:
+                        scheduler.push(&device, 4ms);
+                        break;
+                }
+            }
+            if (mode == Mode::Kick) {
+                scheduler.kick();
+            }
+            busy += clock_type::now() - start;
+            next += 1ms;
+            std::this_thread::sleep_until(next);
+        }
+        std::this_thread::sleep_for(20ms);
+        scheduler.stop();
+
+        const auto stats = scheduler.stats();
+        const auto us = [](clock_type::duration d) {
+            return std::chrono::duration<double, std::micro>(d).count();
+        };
+        printf("%-14s %5zu writes  %8.1f us per poll", name, WRITES.load(), us(busy) / polls);
+        if (stats.writes > 0) {
+            printf("  latency %6.0f us avg / %6.0f us max", us(stats.latency_total) / stats.writes,
+                    us(stats.latency_max));
+        }
+        printf("\n");
+    }
+}
+
+int main() {
+    run("write-through", Mode::WriteThrough);
+    run("kick", Mode::Kick);
+    run("push", Mode::Push);
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * rawinput/output_scheduler: marks only going out after a kick and once per target, the
+ * minimum time between writes merging later changes, push() not waiting for a kick nor taking
+ * other targets along, forget() waiting for a write in progress, and stats.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "rawinput/output_scheduler.h"
+#include "test.h"
+
+using namespace std::chrono_literals;
+using rawinput::OutputScheduler;
+
+namespace {
+
+    struct Target {
+        std::atomic<int> writes {0};
+        std::atomic<int> state {0};
+        std::atomic<int> written_state {-1};
+        OutputScheduler<Target>::clock::time_point last_write {};
+    };
+
+    void sink(Target *target) {
+        target->last_write = OutputScheduler<Target>::clock::now();
+        target->written_state = target->state.load();
+        target->writes++;
+    }
+
+    // polls until `done` holds or a generous timeout runs out, so slow CI hosts do not flake
+    template<class F>
+    bool wait_for(F &&done, std::chrono::milliseconds timeout = 2000ms) {
+        const auto end = std::chrono::steady_clock::now() + timeout;
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > end) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+
+    void test_kick() {
+        Target a, b, c;
+        OutputScheduler<Target> scheduler(sink);
+        scheduler.start();
+
+        // nothing goes out before the kick
+        for (int i = 1; i <= 10; i++) {
+            a.state = i;
+            scheduler.mark(&a, 0ms);
+        }
+        b.state = 5;
+        scheduler.mark(&b, 0ms);
+        std::this_thread::sleep_for(30ms);
+        CHECK_EQ(a.writes.load(), 0);
+
+        // one write per target with the latest state, c was never marked
+        scheduler.kick();
+        CHECK(wait_for([&] { return a.writes == 1 && b.writes == 1; }));
+        CHECK_EQ(a.written_state.load(), 10);
+        CHECK_EQ(b.written_state.load(), 5);
+        CHECK_EQ(c.writes.load(), 0);
+
+        // a kick with nothing marked writes nothing
+        scheduler.kick();
+        std::this_thread::sleep_for(30ms);
+        CHECK_EQ(a.writes.load(), 1);
+
+        const auto stats = scheduler.stats();
+        CHECK_EQ(stats.marks, (uint64_t) 11);
+        CHECK_EQ(stats.writes, (uint64_t) 2);
+        CHECK(stats.latency_max >= 30ms);
+    }
+
+    void test_rate_limit() {
+        Target a;
+        OutputScheduler<Target> scheduler(sink);
+        scheduler.start();
+
+        a.state = 1;
+        scheduler.mark(&a, 100ms);
+        scheduler.kick();
+        CHECK(wait_for([&] { return a.writes == 1; }));
+        const auto first = a.last_write;
+
+        // changes within the interval are merged into one write once it runs out
+        for (int i = 2; i <= 20; i++) {
+            a.state = i;
+            scheduler.mark(&a, 100ms);
+            scheduler.kick();
+            std::this_thread::sleep_for(1ms);
+        }
+        CHECK(wait_for([&] { return a.writes == 2; }));
+        CHECK(a.last_write - first >= 100ms);
+        CHECK_EQ(a.written_state.load(), 20);
+        std::this_thread::sleep_for(150ms);
+        CHECK_EQ(a.writes.load(), 2);
+    }
+
+    void test_push() {
+        Target pushed, marked;
+        OutputScheduler<Target> scheduler(sink);
+        scheduler.start();
+
+        // goes out without a kick, and leaves the other target for the next kick
+        marked.state = 1;
+        scheduler.mark(&marked, 0ms);
+        pushed.state = 7;
+        scheduler.push(&pushed, 0ms);
+        CHECK(wait_for([&] { return pushed.writes == 1; }));
+        CHECK_EQ(pushed.written_state.load(), 7);
+        std::this_thread::sleep_for(30ms);
+        CHECK_EQ(marked.writes.load(), 0);
+        scheduler.kick();
+        CHECK(wait_for([&] { return marked.writes == 1; }));
+
+        // pushes within the interval are merged like kicked marks
+        for (int i = 8; i < 20; i++) {
+            pushed.state = i;
+            scheduler.push(&pushed, 50ms);
+        }
+        CHECK(wait_for([&] { return pushed.written_state == 19; }));
+        CHECK(pushed.writes <= 3);
+    }
+
+    void test_forget() {
+        std::atomic<bool> writing {false};
+        std::atomic<bool> release {false};
+        Target a;
+        OutputScheduler<Target> scheduler([&](Target *target) {
+            writing = true;
+            while (!release) {
+                std::this_thread::sleep_for(1ms);
+            }
+            sink(target);
+        });
+        scheduler.start();
+        scheduler.push(&a, 0ms);
+        CHECK(wait_for([&] { return writing.load(); }));
+
+        // forget has to wait for the write to finish
+        std::atomic<bool> forgotten {false};
+        std::thread forget([&] {
+            scheduler.forget(&a);
+            forgotten = true;
+        });
+        std::this_thread::sleep_for(30ms);
+        CHECK(!forgotten);
+        release = true;
+        forget.join();
+        CHECK_EQ(a.writes.load(), 1);
+
+        // stopping drops what is pending
+        Target b;
+        scheduler.mark(&b, 0ms);
+        scheduler.stop();
+        scheduler.kick();
+        std::this_thread::sleep_for(20ms);
+        CHECK_EQ(b.writes.load(), 0);
+    }
+}
+
+int main() {
+    test_kick();
+    test_rate_limit();
+    test_push();
+    test_forget();
+    return test::result();
+}
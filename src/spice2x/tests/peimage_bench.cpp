@@ -0,0 +1,67 @@
+/*
+ * util/peimage: cost of an RVA lookup and a version query.
+ *
+ * before: every rva2offset(path) / version_pe call read the file and parsed the headers again
+ * after:  the image is parsed once and the lookups run against it
+ *
+ * the host has no file mapping cache, so "before" reads the file into memory with stdio, which
+ * is cheaper than the CreateFile + MapViewOfFile it stands in for.
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "util/peimage.h"
+#include "peimage_sample.h"
+#include "test.h"
+
+using util::PEImage;
+
+static std::vector<uint8_t> read_file(const std::filesystem::path &path) {
+    std::vector<uint8_t> data;
+    if (FILE *file = fopen(path.c_str(), "rb")) {
+        data.resize(std::filesystem::file_size(path));
+        data.resize(fread(data.data(), 1, data.size(), file));
+        fclose(file);
+    }
+    return data;
+}
+
+int main() {
+    const auto path = std::filesystem::temp_directory_path() / "spice_peimage_bench.dll";
+    {
+        const auto data = test::pe::build(true);
+        FILE *file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return 1;
+        }
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    constexpr size_t iterations = 200'000;
+    const auto before_rva = test::time_ns(iterations, [&](size_t i) {
+        test::keep(PEImage::parse(read_file(path))->rva2offset(0x1000 + (i & 0xFF)));
+    });
+    const auto before_version = test::time_ns(iterations / 10, [&](size_t) {
+        test::keep(PEImage::parse(read_file(path))->version().product_name.size());
+    });
+
+    const auto image = PEImage::parse(read_file(path));
+    const auto after_rva = test::time_ns(iterations, [&](size_t i) {
+        test::keep(image->rva2offset(0x1000 + (i & 0xFF)));
+    });
+    const auto after_version = test::time_ns(iterations, [&](size_t) {
+        test::keep(image->version().product_name.size());
+    });
+    const auto find_export = test::time_ns(iterations, [&](size_t) {
+        test::keep(image->find_export("dll_entry_main"));
+    });
+
+    printf("rva2offset     before %8.1f ns  after %6.1f ns\n", before_rva, after_rva);
+    printf("version        before %8.1f ns  after %6.1f ns\n", before_version, after_version);
+    printf("find_export    %6.1f ns\n", find_export);
+    std::filesystem::remove(path);
+    return 0;
+}
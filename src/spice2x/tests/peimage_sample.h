@@ -0,0 +1,230 @@
+#pragma once
+
+/*
+ * builds small synthetic PE files for the util/peimage test and benchmark
+ *
+ *   headers  0x000 - 0x400
+ *   .text    rva 0x1000, file 0x400, 0x200 bytes
+ *   .rdata   rva 0x2000, file 0x600, 0x400 bytes: imports at 0x2000, exports at 0x2200
+ *   .rsrc    rva 0x3000, file 0xA00, 0x400 bytes: RT_VERSION tree at 0x3000, blob at 0x3100
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <windows.h>
+
+namespace test::pe {
+
+    constexpr uint32_t ENTRY_POINT = 0x1000;
+
+    struct VersionTable {
+        std::u16string language;
+        std::vector<std::pair<std::u16string, std::u16string>> strings;
+    };
+
+    class Writer {
+    public:
+        std::vector<uint8_t> data;
+
+        explicit Writer(size_t size = 0) : data(size) {}
+
+        template<typename T>
+        void put(size_t offset, const T &value) {
+            if (this->data.size() < offset + sizeof(T)) {
+                this->data.resize(offset + sizeof(T));
+            }
+            memcpy(&this->data[offset], &value, sizeof(T));
+        }
+
+        void put_string(size_t offset, const std::string &text) {
+            if (this->data.size() < offset + text.size() + 1) {
+                this->data.resize(offset + text.size() + 1);
+            }
+            memcpy(&this->data[offset], text.c_str(), text.size() + 1);
+        }
+
+        void append(const std::vector<uint8_t> &bytes) {
+            this->data.insert(this->data.end(), bytes.begin(), bytes.end());
+        }
+
+        void align4() {
+            this->data.resize((this->data.size() + 3) & ~size_t(3));
+        }
+    };
+
+    // one VS_VERSIONINFO node, the length covers the node up to the end of its last child
+    inline std::vector<uint8_t> version_node(const std::u16string &key, uint16_t type,
+            const std::vector<uint8_t> &value, uint16_t value_length,
+            const std::vector<std::vector<uint8_t>> &children) {
+        Writer node;
+        node.put<uint16_t>(0, 0);
+        node.put<uint16_t>(2, value_length);
+        node.put<uint16_t>(4, type);
+        for (auto c : key) {
+            node.put<char16_t>(node.data.size(), c);
+        }
+        node.put<char16_t>(node.data.size(), 0);
+        node.align4();
+        node.append(value);
+        for (auto &child : children) {
+            node.align4();
+            node.append(child);
+        }
+        node.put<uint16_t>(0, (uint16_t) node.data.size());
+        return node.data;
+    }
+
+    inline std::vector<uint8_t> text_value(const std::u16string &text) {
+        std::vector<uint8_t> value((text.size() + 1) * sizeof(char16_t));
+        memcpy(value.data(), text.c_str(), value.size());
+        return value;
+    }
+
+    inline std::vector<uint8_t> version_blob(const std::vector<VersionTable> &tables) {
+        VS_FIXEDFILEINFO fixed {};
+        fixed.dwSignature = 0xFEEF04BD;
+        fixed.dwStrucVersion = 0x10000;
+        fixed.dwFileVersionMS = 0x00020003;
+        fixed.dwFileVersionLS = 0x00040005;
+        std::vector<uint8_t> fixed_bytes(sizeof(fixed));
+        memcpy(fixed_bytes.data(), &fixed, sizeof(fixed));
+
+        std::vector<std::vector<uint8_t>> table_nodes;
+        for (auto &table : tables) {
+            std::vector<std::vector<uint8_t>> strings;
+            for (auto &[key, text] : table.strings) {
+                strings.push_back(version_node(key, 1, text_value(text), (uint16_t) (text.size() + 1), {}));
+            }
+            table_nodes.push_back(version_node(table.language, 1, {}, 0, strings));
+        }
+        return version_node(u"VS_VERSION_INFO", 0, fixed_bytes, sizeof(fixed), {
+            version_node(u"StringFileInfo", 1, {}, 0, table_nodes),
+        });
+    }
+
+    inline std::vector<uint8_t> build(bool pe32_plus, const std::vector<VersionTable> &tables = {
+            { u"040904b0", {
+                { u"CompanyName", u"Konami Amusement" },
+                { u"ProductName", u"beatmania IIDX" },
+                { u"FileVersion", u"2.3.4.5" },
+            } },
+    }) {
+        Writer pe(0xE00);
+
+        // DOS and NT headers
+        IMAGE_DOS_HEADER dos {};
+        dos.e_magic = IMAGE_DOS_SIGNATURE;
+        dos.e_lfanew = 0x80;
+        pe.put(0, dos);
+        pe.put<DWORD>(0x80, IMAGE_NT_SIGNATURE);
+
+        IMAGE_FILE_HEADER file {};
+        file.Machine = pe32_plus ? IMAGE_FILE_MACHINE_AMD64 : IMAGE_FILE_MACHINE_I386;
+        file.NumberOfSections = 3;
+        file.TimeDateStamp = 0x5F000000;
+        file.SizeOfOptionalHeader = pe32_plus ? sizeof(IMAGE_OPTIONAL_HEADER64) : sizeof(IMAGE_OPTIONAL_HEADER32);
+        pe.put(0x84, file);
+
+        IMAGE_DATA_DIRECTORY directories[IMAGE_NUMBEROF_DIRECTORY_ENTRIES] {};
+        directories[IMAGE_DIRECTORY_ENTRY_EXPORT] = { 0x2200, 0x100 };
+        directories[IMAGE_DIRECTORY_ENTRY_IMPORT] = { 0x2000, 0x3C };
+        directories[IMAGE_DIRECTORY_ENTRY_RESOURCE] = { 0x3000, 0x400 };
+        const size_t optional_offset = 0x84 + sizeof(IMAGE_FILE_HEADER);
+        if (pe32_plus) {
+            IMAGE_OPTIONAL_HEADER64 optional {};
+            optional.Magic = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+            optional.AddressOfEntryPoint = ENTRY_POINT;
+            optional.ImageBase = 0x180000000ULL;
+            optional.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+            memcpy(optional.DataDirectory, directories, sizeof(directories));
+            pe.put(optional_offset, optional);
+        } else {
+            IMAGE_OPTIONAL_HEADER32 optional {};
+            optional.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+            optional.AddressOfEntryPoint = ENTRY_POINT;
+            optional.ImageBase = 0x10000000;
+            optional.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+            memcpy(optional.DataDirectory, directories, sizeof(directories));
+            pe.put(optional_offset, optional);
+        }
+
+        // section table
+        const struct {
+            const char *name;
+            DWORD rva;
+            DWORD offset;
+            DWORD size;
+        } sections[] = {
+            { ".text", 0x1000, 0x400, 0x200 },
+            { ".rdata", 0x2000, 0x600, 0x400 },
+            { ".rsrc", 0x3000, 0xA00, 0x400 },
+        };
+        size_t section_offset = optional_offset + file.SizeOfOptionalHeader;
+        for (auto &entry : sections) {
+            IMAGE_SECTION_HEADER section {};
+            char name[IMAGE_SIZEOF_SHORT_NAME] {};
+            memcpy(name, entry.name, strlen(entry.name));
+            memcpy(section.Name, name, sizeof(name));
+            section.Misc.VirtualSize = entry.size;
+            section.VirtualAddress = entry.rva;
+            section.SizeOfRawData = entry.size;
+            section.PointerToRawData = entry.offset;
+            pe.put(section_offset, section);
+            section_offset += sizeof(IMAGE_SECTION_HEADER);
+        }
+        auto at = [](DWORD rva) {
+            return rva >= 0x3000 ? rva - 0x3000 + 0xA00 : rva - 0x2000 + 0x600;
+        };
+
+        // two imports and the terminating descriptor
+        IMAGE_IMPORT_DESCRIPTOR import {};
+        import.Name = 0x2100;
+        pe.put(at(0x2000), import);
+        import.Name = 0x2110;
+        pe.put(at(0x2014), import);
+        pe.put_string(at(0x2100), "KERNEL32.dll");
+        pe.put_string(at(0x2110), "avs2-core.dll");
+
+        // ordinals 5 to 8, 7 is an unused slot and 6 is exported by ordinal only
+        IMAGE_EXPORT_DIRECTORY exports {};
+        exports.Base = 5;
+        exports.NumberOfFunctions = 4;
+        exports.NumberOfNames = 2;
+        exports.AddressOfFunctions = 0x2240;
+        exports.AddressOfNames = 0x2260;
+        exports.AddressOfNameOrdinals = 0x2270;
+        pe.put(at(0x2200), exports);
+        const DWORD functions[] = { 0x1010, 0x1020, 0, 0x1040 };
+        pe.put(at(0x2240), functions);
+        const DWORD names[] = { 0x2280, 0x2290 };
+        pe.put(at(0x2260), names);
+        const WORD name_ordinals[] = { 0, 3 };
+        pe.put(at(0x2270), name_ordinals);
+        pe.put_string(at(0x2280), "dll_entry_init");
+        pe.put_string(at(0x2290), "dll_entry_main");
+
+        // RT_VERSION -> ID 1 -> language 0x409 -> data entry
+        if (!tables.empty()) {
+            auto directory = [&](DWORD offset, DWORD id, DWORD target) {
+                IMAGE_RESOURCE_DIRECTORY header {};
+                header.NumberOfIdEntries = 1;
+                pe.put(at(0x3000 + offset), header);
+                pe.put<DWORD>(at(0x3000 + offset + 16), id);
+                pe.put<DWORD>(at(0x3000 + offset + 20), target);
+            };
+            directory(0x00, 16, 0x80000000 | 0x18);
+            directory(0x18, 1, 0x80000000 | 0x30);
+            directory(0x30, 0x409, 0x48);
+
+            const auto blob = version_blob(tables);
+            IMAGE_RESOURCE_DATA_ENTRY data {};
+            data.OffsetToData = 0x3100;
+            data.Size = (DWORD) blob.size();
+            pe.put(at(0x3048), data);
+            memcpy(&pe.data[at(0x3100)], blob.data(), std::min<size_t>(blob.size(), 0x300));
+        }
+        return pe.data;
+    }
+}
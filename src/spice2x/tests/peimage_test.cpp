@@ -0,0 +1,173 @@
+/*
+ * util/peimage: headers, RVA/offset conversion, imports, exports and the version resource of
+ * synthetic PE32 and PE32+ images, and that truncated or corrupted images read as invalid or
+ * empty instead of faulting.
+ */
+
+#include <cstring>
+#include <random>
+
+#include "util/peimage.h"
+#include "peimage_sample.h"
+#include "test.h"
+
+using util::PEImage;
+
+namespace {
+
+    void test_headers(bool pe32_plus) {
+        const auto image = PEImage::parse(test::pe::build(pe32_plus));
+        CHECK(image->valid());
+        CHECK_EQ(image->is_64bit(), pe32_plus);
+        CHECK_EQ(image->size(), (size_t) 0xE00);
+        CHECK_EQ(image->file_header().Machine,
+                (WORD) (pe32_plus ? IMAGE_FILE_MACHINE_AMD64 : IMAGE_FILE_MACHINE_I386));
+        CHECK_EQ(image->file_header().TimeDateStamp, (DWORD) 0x5F000000);
+        CHECK_EQ(image->entry_point(), test::pe::ENTRY_POINT);
+        CHECK_EQ(image->section_count(), (size_t) 3);
+        CHECK(memcmp(image->sections()[1].Name, ".rdata", 7) == 0);
+        CHECK_EQ(image->directory(IMAGE_DIRECTORY_ENTRY_IMPORT).VirtualAddress, (DWORD) 0x2000);
+        CHECK_EQ(image->directory(IMAGE_DIRECTORY_ENTRY_EXPORT).Size, (DWORD) 0x100);
+        CHECK_EQ(image->directory(IMAGE_NUMBEROF_DIRECTORY_ENTRIES).VirtualAddress, (DWORD) 0);
+
+        // RVA <-> file offset
+        CHECK_EQ(image->rva2offset(0x1010), (intptr_t) 0x410);
+        CHECK_EQ(image->rva2offset(0x33FF), (intptr_t) 0xDFF);
+        CHECK_EQ(image->rva2offset(0x3400), (intptr_t) -1);
+        CHECK_EQ(image->rva2offset(0x0500), (intptr_t) -1);
+        CHECK_EQ(image->offset2rva(0x610), (intptr_t) 0x2010);
+        CHECK_EQ(image->offset2rva(0x10), (intptr_t) -1);
+        CHECK(image->at_rva(0x2100, 13) == image->data() + 0x700);
+        CHECK(image->at_rva(0x33FF, 1) != nullptr);
+        CHECK(image->at_rva(0x33FF, 2) == nullptr);
+        CHECK(image->at_rva(0x3400, 1) == nullptr);
+    }
+
+    void test_imports_exports(bool pe32_plus) {
+        const auto image = PEImage::parse(test::pe::build(pe32_plus));
+        const auto &imports = image->imports();
+        CHECK_EQ(imports.size(), (size_t) 2);
+        CHECK(imports.size() == 2 && imports[0] == "KERNEL32.dll" && imports[1] == "avs2-core.dll");
+
+        // the unused slot is dropped, the ordinal only export has no name
+        const auto &exports = image->exports();
+        CHECK_EQ(exports.size(), (size_t) 3);
+        if (exports.size() == 3) {
+            CHECK(exports[0].name == "dll_entry_init" && exports[0].ordinal == 5 && exports[0].rva == 0x1010);
+            CHECK(exports[1].name.empty() && exports[1].ordinal == 6 && exports[1].rva == 0x1020);
+            CHECK(exports[2].name == "dll_entry_main" && exports[2].ordinal == 8 && exports[2].rva == 0x1040);
+        }
+        auto entry = image->find_export("dll_entry_main");
+        CHECK(entry != nullptr && entry->ordinal == 8);
+        CHECK(image->find_export("dll_entry") == nullptr);
+        CHECK(image->find_export("") == nullptr);
+    }
+
+    void test_version() {
+        const auto image = PEImage::parse(test::pe::build(false));
+        const auto &version = image->version();
+        CHECK(version.has_fixed_info);
+        CHECK_EQ(version.fixed_info.dwFileVersionMS, (DWORD) 0x00020003);
+        CHECK_EQ(version.company_name, std::string("Konami Amusement"));
+        CHECK_EQ(version.product_name, std::string("beatmania IIDX"));
+        CHECK_EQ(version.file_version, std::string("2.3.4.5"));
+
+        // the english table wins wherever it is, otherwise the first one is used
+        const auto japanese = test::pe::VersionTable { u"041104b0", {
+            { u"ProductName", u"コナミ \U0001F3B5" },
+        } };
+        const auto english = test::pe::VersionTable { u"040904b0", {
+            { u"ProductName", u"KONAMI" },
+        } };
+        CHECK_EQ(PEImage::parse(test::pe::build(true, { japanese, english }))->version().product_name,
+                std::string("KONAMI"));
+        CHECK_EQ(PEImage::parse(test::pe::build(true, { japanese }))->version().product_name,
+                std::string("\xe3\x82\xb3\xe3\x83\x8a\xe3\x83\x9f \xf0\x9f\x8e\xb5"));
+
+        // no resource directory at all
+        const auto bare = PEImage::parse(test::pe::build(false, {}));
+        CHECK(!bare->version().has_fixed_info);
+        CHECK(bare->version().product_name.empty());
+    }
+
+    // parse everything lazily parsed, the result does not matter
+    void touch(const PEImage &image) {
+        if (image.valid()) {
+            test::keep(image.entry_point());
+            test::keep(image.rva2offset(0x2000));
+        }
+        test::keep(image.imports().size());
+        test::keep(image.exports().size());
+        test::keep(image.find_export("dll_entry_main"));
+        test::keep(image.version().product_name.size());
+    }
+
+    void test_truncated() {
+        const auto full = test::pe::build(true);
+        for (size_t length = 0; length < full.size(); length++) {
+            const auto image = PEImage::parse(std::vector<uint8_t>(full.begin(), full.begin() + length));
+
+            // headers and section table end at 0x200
+            CHECK_EQ(image->valid(), length >= 0x200);
+            touch(*image);
+        }
+        CHECK(PEImage::parse({})->imports().empty());
+    }
+
+    void test_malformed() {
+        auto corrupt = [](size_t offset, auto value) {
+            test::pe::Writer pe;
+            pe.data = test::pe::build(false);
+            pe.put(offset, value);
+            return PEImage::parse(std::move(pe.data));
+        };
+        CHECK(!corrupt(0x00, (WORD) 0x4D5B)->valid());            // DOS signature
+        CHECK(!corrupt(0x3C, (LONG) 0x7FFFFFF0)->valid());        // e_lfanew past the end
+        CHECK(!corrupt(0x3C, (LONG) -4)->valid());                // negative e_lfanew
+        CHECK(!corrupt(0x80, (DWORD) 0x00004551)->valid());       // NT signature
+        CHECK(!corrupt(0x86, (WORD) 0xFFFF)->valid());            // section count
+        CHECK(!corrupt(0x98, (WORD) 0x10c)->valid());             // optional header magic
+        CHECK(!corrupt(0x94, (WORD) 0x10)->valid());              // optional header too small
+
+        // fewer directories than the header has room for
+        auto directories = corrupt(0x98 + offsetof(IMAGE_OPTIONAL_HEADER32, NumberOfRvaAndSizes), (DWORD) 1);
+        CHECK(directories->valid());
+        CHECK(directories->imports().empty());
+        CHECK_EQ(directories->exports().size(), (size_t) 3);
+
+        // export and import tables pointing into nowhere
+        CHECK(corrupt(0x600 + 0x200 + offsetof(IMAGE_EXPORT_DIRECTORY, NumberOfFunctions), (DWORD) 0xFFFFFFFF)
+                ->exports().empty());
+        CHECK(corrupt(0x600 + 0x200 + offsetof(IMAGE_EXPORT_DIRECTORY, AddressOfFunctions), (DWORD) 0x9000)
+                ->exports().empty());
+        auto names = corrupt(0x600 + 0x200 + offsetof(IMAGE_EXPORT_DIRECTORY, AddressOfNames), (DWORD) 0x9000);
+        CHECK_EQ(names->exports().size(), (size_t) 3);
+        CHECK(names->find_export("dll_entry_main") == nullptr);
+        CHECK(corrupt(0x600 + offsetof(IMAGE_IMPORT_DESCRIPTOR, Name), (DWORD) 0x9000)->imports().size() == 1);
+
+        // resource data entry past the end of the section
+        CHECK(!corrupt(0xA00 + 0x48, (DWORD) 0x33F0)->version().has_fixed_info);
+
+        // random byte flips anywhere
+        std::mt19937 rng(1);
+        const auto original = test::pe::build(true);
+        for (int round = 0; round < 3000; round++) {
+            auto data = original;
+            for (int flips = 1 + rng() % 4; flips > 0; flips--) {
+                data[rng() % data.size()] = (uint8_t) rng();
+            }
+            touch(*PEImage::parse(std::move(data)));
+        }
+    }
+}
+
+int main() {
+    test_headers(false);
+    test_headers(true);
+    test_imports_exports(false);
+    test_imports_exports(true);
+    test_version();
+    test_truncated();
+    test_malformed();
+    return test::result();
+}
@@ -0,0 +1,121 @@
+/*
+ * util/pixelconv: the SSSE3 row kernels against the scalar path for every source format at
+ * widths 1 to 100, from unaligned rows into unaligned output, without writing past the row, and
+ * whole images with padded pitches. run with SPICE_TEST_SCALAR=1 as well.
+ */
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "util/pixelconv.h"
+#include "test.h"
+
+using pixelconv::SourceFormat;
+
+namespace {
+
+    constexpr struct {
+        SourceFormat format;
+        size_t pixel_size;
+    } FORMATS[] = {
+        { SourceFormat::XRGB8888, 4 },
+        { SourceFormat::RGB565, 2 },
+        { SourceFormat::XRGB1555, 2 },
+        { SourceFormat::ARGB2101010, 4 },
+    };
+
+    constexpr uint8_t GUARD = 0xCD;
+
+    void test_rows(std::mt19937 &rng) {
+        for (auto &entry : FORMATS) {
+            for (size_t width = 1; width <= 100; width++) {
+
+                // one byte in, so neither side is aligned to anything
+                std::vector<uint8_t> source(width * entry.pixel_size + 1);
+                for (auto &b : source) {
+                    b = (uint8_t) rng();
+                }
+                const auto data = source.data() + 1;
+
+                std::vector<uint8_t> expected(width * 3 + 17, GUARD);
+                std::vector<uint8_t> actual(width * 3 + 17, GUARD);
+                pixelconv::row_to_rgb_scalar(entry.format, data, expected.data() + 1, 0, width);
+                pixelconv::row_to_rgb(entry.format, data, actual.data() + 1, width);
+                CHECK(actual == expected);
+                CHECK(actual[0] == GUARD);
+                for (size_t i = width * 3 + 1; i < actual.size(); i++) {
+                    CHECK(actual[i] == GUARD);
+                }
+            }
+        }
+    }
+
+    void test_images(std::mt19937 &rng) {
+        for (auto &entry : FORMATS) {
+            for (size_t width : { 1, 15, 16, 17, 33, 100 }) {
+                const size_t height = 7;
+                const size_t pitch = width * entry.pixel_size + 12;
+                std::vector<uint8_t> source(pitch * height);
+                for (auto &b : source) {
+                    b = (uint8_t) rng();
+                }
+
+                std::vector<uint8_t> expected(width * 3 * height);
+                for (size_t row = 0; row < height; row++) {
+                    pixelconv::row_to_rgb_scalar(entry.format, source.data() + row * pitch,
+                            expected.data() + row * width * 3, 0, width);
+                }
+                std::vector<uint8_t> actual(width * 3 * height);
+                pixelconv::image_to_rgb(entry.format, width, height, source.data(), pitch, actual.data());
+                CHECK(actual == expected);
+            }
+        }
+    }
+
+    // single pixels run through a 32 pixel row, so the SSSE3 path sees them too
+    template<typename T>
+    void check_pixel(SourceFormat format, T cell, uint8_t r, uint8_t g, uint8_t b) {
+        std::vector<T> row(32, cell);
+        uint8_t pixels[32 * 3];
+        pixelconv::row_to_rgb(format, reinterpret_cast<const uint8_t *>(row.data()), pixels, 32);
+        for (size_t i = 0; i < 32; i++) {
+            CHECK(pixels[i * 3] == r && pixels[i * 3 + 1] == g && pixels[i * 3 + 2] == b);
+        }
+    }
+
+    void test_channels() {
+        check_pixel<uint32_t>(SourceFormat::XRGB8888, 0xFF123456, 0x12, 0x34, 0x56);
+        check_pixel<uint32_t>(SourceFormat::XRGB8888, 0x00ABCDEF, 0xAB, 0xCD, 0xEF);
+
+        // full scale stays full scale, bit replication below it
+        check_pixel<uint16_t>(SourceFormat::RGB565, 0xFFFF, 255, 255, 255);
+        check_pixel<uint16_t>(SourceFormat::RGB565, 0xF800, 255, 0, 0);
+        check_pixel<uint16_t>(SourceFormat::RGB565, 0x07E0, 0, 255, 0);
+        check_pixel<uint16_t>(SourceFormat::RGB565, 0x001F, 0, 0, 255);
+        check_pixel<uint16_t>(SourceFormat::RGB565, (16 << 11) | (32 << 5) | 1, 132, 130, 8);
+
+        // the top bit is alpha or unused
+        check_pixel<uint16_t>(SourceFormat::XRGB1555, 0x7FFF, 255, 255, 255);
+        check_pixel<uint16_t>(SourceFormat::XRGB1555, 0x8000, 0, 0, 0);
+        check_pixel<uint16_t>(SourceFormat::XRGB1555, 0x7C00, 255, 0, 0);
+        check_pixel<uint16_t>(SourceFormat::XRGB1555, 0x03E0, 0, 255, 0);
+        check_pixel<uint16_t>(SourceFormat::XRGB1555, 0x001F, 0, 0, 255);
+
+        // the top 8 of each 10 bits
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, 0x3FFFFFFF, 255, 255, 255);
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, 0xC0000000, 0, 0, 0);
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, 0x3FF00000, 255, 0, 0);
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, 0x000FFC00, 0, 255, 0);
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, 0x000003FF, 0, 0, 255);
+        check_pixel<uint32_t>(SourceFormat::ARGB2101010, (0x201u << 20) | (0x0FFu << 10) | 0x3u, 0x80, 0x3F, 0x00);
+    }
+}
+
+int main() {
+    std::mt19937 rng(37);
+    test_rows(rng);
+    test_images(rng);
+    test_channels();
+    return test::result();
+}
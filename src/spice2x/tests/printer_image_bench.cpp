@@ -0,0 +1,125 @@
+/*
+ * games/shared/printer_image: the work of one print job off the game thread, the transform of
+ * a photo into RGB and its encode as PNG and JPG. sizes are the SDVX/NCG card (rotated) and a
+ * larger flipped print.
+ *
+ * before: an in place BGR to RGB pass, then a column major rotation striding a whole row per
+ *         pixel or a column major flip.
+ * after:  one pass converting and rotating in 16 pixel tiles or flipping row by row.
+ * the encodes are the same stb_image_write calls either way, timed for scale: they are what
+ * the print queue spends most of a job on.
+ */
+
+#include <random>
+#include <vector>
+
+#include "games/shared/printer_image.h"
+#include "test.h"
+
+using namespace games::shared;
+
+namespace {
+
+    // see printer_image_test.cpp
+    std::vector<uint8_t> legacy_rotate(std::vector<uint8_t> image_data, int image_width, int image_height) {
+        for (int pixel = 0; pixel < image_width * image_height; pixel++) {
+            int index = pixel * 3;
+            uint8_t tmp = image_data[index];
+            image_data[index] = image_data[index + 2];
+            image_data[index + 2] = tmp;
+        }
+        std::vector<uint8_t> rotated(image_data.size());
+        for (int x = 0; x < image_width; x++) {
+            for (int y = 0; y < image_height; y++) {
+                int index1 = (y * image_width + x) * 3;
+                int index2 = (x * image_height + y) * 3;
+                rotated[index2 + 0] = image_data[index1 + 0];
+                rotated[index2 + 1] = image_data[index1 + 1];
+                rotated[index2 + 2] = image_data[index1 + 2];
+            }
+        }
+        return rotated;
+    }
+
+    std::vector<uint8_t> legacy_flip(std::vector<uint8_t> image_data, int image_width, int image_height) {
+        for (int pixel = 0; pixel < image_width * image_height; pixel++) {
+            int index = pixel * 3;
+            uint8_t tmp = image_data[index];
+            image_data[index] = image_data[index + 2];
+            image_data[index + 2] = tmp;
+        }
+        for (int x = 0; x < image_width / 2; x++) {
+            for (int y = 0; y < image_height; y++) {
+                int index1 = (y * image_width + x) * 3;
+                int index2 = (y * image_width + image_width - x - 1) * 3;
+                uint8_t r = image_data[index1 + 0];
+                uint8_t g = image_data[index1 + 1];
+                uint8_t b = image_data[index1 + 2];
+                image_data[index1 + 0] = image_data[index2 + 0];
+                image_data[index1 + 1] = image_data[index2 + 1];
+                image_data[index1 + 2] = image_data[index2 + 2];
+                image_data[index2 + 0] = r;
+                image_data[index2 + 1] = g;
+                image_data[index2 + 2] = b;
+            }
+        }
+        return image_data;
+    }
+
+    // a photo-like gradient with noise, so the encoders have realistic work
+    std::vector<uint8_t> make_photo(int width, int height) {
+        std::mt19937 rng(38);
+        std::vector<uint8_t> image(static_cast<size_t>(width) * height * 3);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                auto pixel = &image[(static_cast<size_t>(y) * width + x) * 3];
+                pixel[0] = (uint8_t) (x / 4 + rng() % 6);
+                pixel[1] = (uint8_t) (y / 3 + rng() % 6);
+                pixel[2] = (uint8_t) ((x + y) / 5 + rng() % 6);
+            }
+        }
+        return image;
+    }
+}
+
+int main() {
+    const struct {
+        int width, height;
+        bool rotate;
+        const char *name;
+    } prints[] = {
+        { 1080, 720, true, "1080x720 rotate" },
+        { 1600, 1200, false, "1600x1200 flip" },
+    };
+
+    for (auto &print : prints) {
+        const auto photo = make_photo(print.width, print.height);
+        const auto before = test::time_ns(20, [&](size_t) {
+            const auto out = print.rotate
+                    ? legacy_rotate(photo, print.width, print.height)
+                    : legacy_flip(photo, print.width, print.height);
+            test::keep(out[0]);
+        });
+        const auto after = test::time_ns(20, [&](size_t) {
+            const auto out = print.rotate
+                    ? transform_rotate(photo.data(), print.width, print.height)
+                    : transform_flip(photo.data(), print.width, print.height);
+            test::keep(out[0]);
+        });
+        printf("%-17s transform %7.2f ms before, %7.2f ms after\n", print.name, before / 1e6, after / 1e6);
+
+        const auto image = print.rotate
+                ? transform_rotate(photo.data(), print.width, print.height)
+                : transform_flip(photo.data(), print.width, print.height);
+        const int width = print.rotate ? print.height : print.width;
+        const int height = print.rotate ? print.width : print.height;
+        std::vector<uint8_t> encoded;
+        for (const char *format : { "png", "jpg" }) {
+            const auto ns = test::time_ns(5, [&](size_t) {
+                test::keep(encode_image(format, image.data(), width, height, 85, encoded));
+            });
+            printf("%-17s encode %s %7.2f ms, %zu bytes\n", print.name, format, ns / 1e6, encoded.size());
+        }
+    }
+    return 0;
+}
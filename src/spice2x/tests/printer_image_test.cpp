@@ -0,0 +1,144 @@
+/*
+ * games/shared/printer_image: the tiled rotation and the row flip against the column major
+ * loops they replaced, on odd, non-square, single row and single column images and sizes
+ * around the 16 pixel tile, and encode_image for every format the printer writes.
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "games/shared/printer_image.h"
+#include "test.h"
+
+using namespace games::shared;
+
+namespace {
+
+    // games/shared/printer.cpp before the print queue: BGR to RGB in place, then the rotation
+    // into a new image or the flip in place
+    std::vector<uint8_t> legacy_transform(const std::vector<uint8_t> &source, int image_width,
+            int image_height, bool rotate) {
+        std::vector<uint8_t> image_data = source;
+        for (int pixel = 0; pixel < image_width * image_height; pixel++) {
+            int index = pixel * 3;
+            uint8_t tmp = image_data[index];
+            image_data[index] = image_data[index + 2];
+            image_data[index + 2] = tmp;
+        }
+
+        if (rotate) {
+            std::vector<uint8_t> rotated(image_data.size());
+            for (int x = 0; x < image_width; x++) {
+                for (int y = 0; y < image_height; y++) {
+                    int index1 = (y * image_width + x) * 3;
+                    int index2 = (x * image_height + y) * 3;
+                    rotated[index2 + 0] = image_data[index1 + 0];
+                    rotated[index2 + 1] = image_data[index1 + 1];
+                    rotated[index2 + 2] = image_data[index1 + 2];
+                }
+            }
+            return rotated;
+        }
+
+        for (int x = 0; x < image_width / 2; x++) {
+            for (int y = 0; y < image_height; y++) {
+                int index1 = (y * image_width + x) * 3;
+                int index2 = (y * image_width + image_width - x - 1) * 3;
+                uint8_t r = image_data[index1 + 0];
+                uint8_t g = image_data[index1 + 1];
+                uint8_t b = image_data[index1 + 2];
+                image_data[index1 + 0] = image_data[index2 + 0];
+                image_data[index1 + 1] = image_data[index2 + 1];
+                image_data[index1 + 2] = image_data[index2 + 2];
+                image_data[index2 + 0] = r;
+                image_data[index2 + 1] = g;
+                image_data[index2 + 2] = b;
+            }
+        }
+        return image_data;
+    }
+
+    void test_transforms(std::mt19937 &rng) {
+        const struct {
+            int width, height;
+        } sizes[] = {
+            { 1, 1 }, { 1, 37 }, { 37, 1 }, { 2, 3 }, { 15, 17 }, { 16, 16 }, { 17, 15 },
+            { 17, 33 }, { 33, 17 }, { 31, 64 }, { 100, 7 }, { 7, 100 }, { 257, 129 },
+        };
+        for (auto &size : sizes) {
+            std::vector<uint8_t> source(static_cast<size_t>(size.width) * size.height * 3);
+            for (auto &b : source) {
+                b = (uint8_t) rng();
+            }
+            CHECK(transform_rotate(source.data(), size.width, size.height)
+                    == legacy_transform(source, size.width, size.height, true));
+            CHECK(transform_flip(source.data(), size.width, size.height)
+                    == legacy_transform(source, size.width, size.height, false));
+        }
+
+        // a 2x3 BGR image by hand: the rotation writes source column x as output row x, top to
+        // bottom, and the flip reverses every row
+        const uint8_t image[] = {
+            1, 2, 3,     4, 5, 6,
+            7, 8, 9,     10, 11, 12,
+            13, 14, 15,  16, 17, 18,
+        };
+        const std::vector<uint8_t> rotated {
+            3, 2, 1,    9, 8, 7,    15, 14, 13,
+            6, 5, 4,    12, 11, 10, 18, 17, 16,
+        };
+        const std::vector<uint8_t> flipped {
+            6, 5, 4,    3, 2, 1,
+            12, 11, 10, 9, 8, 7,
+            18, 17, 16, 15, 14, 13,
+        };
+        CHECK(transform_rotate(image, 2, 3) == rotated);
+        CHECK(transform_flip(image, 2, 3) == flipped);
+    }
+
+    bool starts_with(const std::vector<uint8_t> &data, const char *magic, size_t size) {
+        return data.size() >= size && memcmp(data.data(), magic, size) == 0;
+    }
+
+    void test_encode(std::mt19937 &rng) {
+        const int width = 61, height = 47;
+        std::vector<uint8_t> image(width * height * 3);
+        for (auto &b : image) {
+            b = (uint8_t) rng();
+        }
+
+        std::vector<uint8_t> encoded { 1, 2, 3 };
+        CHECK(encode_image("png", image.data(), width, height, 85, encoded));
+        CHECK(starts_with(encoded, "\x89PNG\r\n\x1a\n", 8));
+        CHECK(encode_image("jpg", image.data(), width, height, 85, encoded));
+        CHECK(starts_with(encoded, "\xff\xd8\xff", 3));
+        CHECK(encode_image("bmp", image.data(), width, height, 85, encoded));
+        CHECK(starts_with(encoded, "BM", 2));
+
+        // rows are padded to four bytes and stored bottom up in BGR
+        CHECK_EQ(encoded.size(), (size_t) 54 + (width * 3 + 3) / 4 * 4 * height);
+        const auto last_row = &encoded[54];
+        CHECK(last_row[0] == image[(height - 1) * width * 3 + 2]);
+        CHECK(last_row[2] == image[(height - 1) * width * 3]);
+        CHECK(encode_image("tga", image.data(), width, height, 85, encoded));
+        CHECK(encoded.size() > 18);
+
+        // jpg quality reaches the encoder
+        std::vector<uint8_t> low, high;
+        CHECK(encode_image("jpg", image.data(), width, height, 10, low));
+        CHECK(encode_image("jpg", image.data(), width, height, 100, high));
+        CHECK(low.size() < high.size());
+
+        CHECK(!encode_image("gif", image.data(), width, height, 85, encoded));
+        CHECK(encoded.empty());
+    }
+}
+
+int main() {
+    std::mt19937 rng(38);
+    test_transforms(rng);
+    test_encode(rng);
+    return test::result();
+}
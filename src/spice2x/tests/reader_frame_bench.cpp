@@ -0,0 +1,47 @@
+/*
+ * reader/frame: cost per frame of decoding a stream of typical status and card responses and
+ * of encoding a request.
+ */
+
+#include <random>
+#include <vector>
+
+#include "reader/frame.h"
+#include "test.h"
+
+int main() {
+    std::mt19937 rng(5);
+    std::vector<uint8_t> stream;
+    constexpr size_t frames = 10'000;
+    for (size_t i = 0; i < frames; i++) {
+        uint8_t data[24];
+        const size_t size = i % 2 ? 16 : 8;
+        for (size_t b = 0; b < size; b++) {
+            data[b] = (uint8_t) rng();
+        }
+        uint8_t out[READER_FRAME_ENCODED_MAX];
+        const auto encoded = reader_frame_encode(0x01, 0x00, 0x34, (uint8_t) i, data, size, out);
+        stream.insert(stream.end(), out, out + encoded);
+    }
+
+    constexpr size_t rounds = 100;
+    ReaderFrameDecoder decoder;
+    size_t decoded = 0;
+    const auto decode = test::time_ns(rounds, [&](size_t) {
+        for (const auto b : stream) {
+            if (decoder.push(b)) {
+                decoded++;
+                test::keep(decoder.frame().cmd());
+            }
+        }
+    }) / frames;
+
+    const uint8_t request[] = { 0x00, 0x03 };
+    uint8_t out[READER_FRAME_ENCODED_MAX];
+    const auto encode = test::time_ns(1'000'000, [&](size_t i) {
+        test::keep(reader_frame_encode(0x01, 0x00, 0x31, (uint8_t) i, request, sizeof(request), out));
+    });
+
+    printf("decode %6.1f ns/frame (%zu frames)  encode %6.1f ns/frame\n", decode, decoded, encode);
+    return 0;
+}
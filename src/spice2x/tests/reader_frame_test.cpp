@@ -0,0 +1,182 @@
+/*
+ * reader/frame: frames round trip through the encoder and the incremental decoder with every
+ * byte value in every field, survive being split over arbitrary reads and line noise, and bad
+ * checksums or frames cut short by a new start are dropped and counted.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "reader/frame.h"
+#include "test.h"
+
+namespace {
+
+    struct Sent {
+        uint8_t header[READER_FRAME_HEADER_SIZE];
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<uint8_t> encode(const Sent &frame) {
+        uint8_t out[READER_FRAME_ENCODED_MAX];
+        const auto size = reader_frame_encode(frame.header[0], frame.header[1], frame.header[2],
+                frame.header[3], frame.data.data(), frame.data.size(), out);
+        return std::vector<uint8_t>(out, out + size);
+    }
+
+    bool matches(const ReaderFrame &frame, const Sent &sent) {
+        return frame.size == READER_FRAME_HEADER_SIZE + sent.data.size()
+            && memcmp(frame.bytes, sent.header, 4) == 0
+            && frame.length() == sent.data.size()
+            && memcmp(frame.data(), sent.data.data(), sent.data.size()) == 0;
+    }
+
+    void test_round_trip() {
+
+        // every byte value in every header field and in the data, which exercises the escapes
+        // and makes the checksum itself take every value
+        for (int value = 0; value < 256; value++) {
+            for (size_t field = 0; field < 5; field++) {
+                Sent sent { { 0x01, 0x02, 0x03, 0x04, 0x00 }, {} };
+                if (field < 4) {
+                    sent.header[field] = (uint8_t) value;
+                } else {
+                    sent.data.assign(3, (uint8_t) value);
+                }
+                sent.header[4] = (uint8_t) sent.data.size();
+                const auto bytes = encode(sent);
+
+                // only the start byte may be a bare 0xAA
+                CHECK(std::count(bytes.begin() + 1, bytes.end(), READER_FRAME_START) == 0);
+
+                ReaderFrameDecoder decoder;
+                size_t complete = 0;
+                for (size_t i = 0; i < bytes.size(); i++) {
+                    if (decoder.push(bytes[i])) {
+                        complete++;
+                        CHECK_EQ(i, bytes.size() - 1);
+                        CHECK(matches(decoder.frame(), sent));
+                    }
+                }
+                CHECK_EQ(complete, (size_t) 1);
+                CHECK_EQ(decoder.dropped, (size_t) 0);
+            }
+        }
+
+        // the longest frame fits the encode buffer even when every byte is escaped
+        Sent longest { { 0xAA, 0xFF, 0xAA, 0xFF, 255 }, std::vector<uint8_t>(255, 0xFF) };
+        CHECK(encode(longest).size() <= READER_FRAME_ENCODED_MAX);
+        Sent clamped { { 1, 2, 3, 4, 0 }, std::vector<uint8_t>(300, 0x11) };
+        uint8_t out[READER_FRAME_ENCODED_MAX];
+        const auto size = reader_frame_encode(1, 2, 3, 4, clamped.data.data(), clamped.data.size(), out);
+        ReaderFrameDecoder decoder;
+        bool done = false;
+        for (size_t i = 0; i < size; i++) {
+            done = decoder.push(out[i]);
+        }
+        CHECK(done && decoder.frame().length() == 255);
+    }
+
+    void test_stream() {
+
+        // 20000 frames back to back with line noise between some of them, fed in reads of
+        // random size the way ReadFile returns them
+        std::mt19937 rng(3);
+        std::vector<Sent> sent;
+        std::vector<uint8_t> stream;
+        for (int i = 0; i < 20000; i++) {
+            Sent frame;
+            for (auto &b : frame.header) {
+                b = (uint8_t) rng();
+            }
+            frame.data.resize(rng() % 24);
+            for (auto &b : frame.data) {
+                b = (uint8_t) (rng() % 4 == 0 ? 0xAA + (rng() & 1) * 0x55 : rng());
+            }
+            frame.header[4] = (uint8_t) frame.data.size();
+            const auto bytes = encode(frame);
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+            sent.push_back(std::move(frame));
+
+            // noise without a start byte is skipped between frames
+            if (rng() % 8 == 0) {
+                for (int n = rng() % 6; n > 0; n--) {
+                    stream.push_back((uint8_t) (rng() % 0xAA));
+                }
+            }
+        }
+
+        for (size_t max_read : { 1, 16, 512 }) {
+            ReaderFrameDecoder decoder;
+            size_t received = 0;
+            bool intact = true;
+            for (size_t pos = 0; pos < stream.size();) {
+                const size_t read = std::min(1 + rng() % max_read, stream.size() - pos);
+                for (size_t i = 0; i < read; i++) {
+                    if (decoder.push(stream[pos + i])) {
+                        intact = intact && received < sent.size() && matches(decoder.frame(), sent[received]);
+                        received++;
+                    }
+                }
+                pos += read;
+            }
+            CHECK_EQ(received, sent.size());
+            CHECK(intact);
+            CHECK_EQ(decoder.dropped, (size_t) 0);
+        }
+    }
+
+    void test_errors() {
+        const Sent sent { { 0x01, 0x00, 0x31, 0x07, 2 }, { 0x10, 0x20 } };
+        const auto good = encode(sent);
+
+        // corrupted checksum
+        auto bad = good;
+        bad.back() ^= 0x01;
+        ReaderFrameDecoder decoder;
+        for (auto b : bad) {
+            CHECK(!decoder.push(b));
+        }
+        CHECK_EQ(decoder.dropped, (size_t) 1);
+
+        // a frame cut short by the next start, which still decodes
+        size_t complete = 0;
+        for (size_t i = 0; i < 4; i++) {
+            decoder.push(good[i]);
+        }
+        for (auto b : good) {
+            complete += decoder.push(b);
+        }
+        CHECK_EQ(complete, (size_t) 1);
+        CHECK_EQ(decoder.dropped, (size_t) 2);
+        CHECK(matches(decoder.frame(), sent));
+
+        // reset throws away a partial frame without counting it
+        for (size_t i = 0; i < 4; i++) {
+            decoder.push(good[i]);
+        }
+        decoder.reset();
+        for (size_t i = 4; i < good.size(); i++) {
+            CHECK(!decoder.push(good[i]));
+        }
+        CHECK_EQ(decoder.dropped, (size_t) 2);
+
+        // an escape right before the start byte does not swallow it
+        decoder.push(READER_FRAME_START);
+        decoder.push(READER_FRAME_ESCAPE);
+        complete = 0;
+        for (auto b : good) {
+            complete += decoder.push(b);
+        }
+        CHECK_EQ(complete, (size_t) 1);
+    }
+}
+
+int main() {
+    test_round_trip();
+    test_stream();
+    test_errors();
+    return test::result();
+}
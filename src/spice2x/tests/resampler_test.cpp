@@ -0,0 +1,142 @@
+/*
+ * hooks/audio/backends/wasapi/sinc_resampler: conversion accuracy and input/output balance for
+ * ratios with a polyphase bank and ratios interpolating the fine kernel table.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "hooks/audio/backends/wasapi/sinc_resampler.h"
+#include "test.h"
+
+using hooks::audio::SincResampler;
+
+namespace {
+
+    // resamples a stereo 1 kHz sine in random sized blocks, returns the output
+    std::vector<float> resample_sine(uint32_t src_rate, uint32_t dst_rate, size_t in_frames,
+            std::vector<size_t> *produced_per_block = nullptr) {
+        SincResampler resampler;
+        resampler.setup(2, src_rate, dst_rate);
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> block(1, 700);
+        std::vector<float> output;
+        size_t position = 0;
+        while (position < in_frames) {
+            const size_t frames = std::min(block(rng), in_frames - position);
+            resampler.reserve(frames);
+            float *in = resampler.enqueue(frames);
+            for (size_t i = 0; i < frames; i++) {
+                const double v = 0.5 * std::sin(2.0 * M_PI * 1000.0 * (position + i) / src_rate);
+                in[i * 2 + 0] = (float) v;
+                in[i * 2 + 1] = (float) -v;
+            }
+            position += frames;
+
+            const auto produced = resampler.produce_variable();
+            CHECK_EQ(produced, resampler.output_frames());
+            if (produced_per_block) {
+                produced_per_block->push_back(produced);
+            }
+            output.insert(output.end(), resampler.output(), resampler.output() + produced * 2);
+            resampler.consume(produced);
+            CHECK_EQ(resampler.output_frames(), (size_t) 0);
+        }
+        return output;
+    }
+
+    // output frame o sits at input frame o * src / dst
+    double sine_snr_db(const std::vector<float> &output, uint32_t dst_rate) {
+        double power = 0, noise = 0;
+        const size_t frames = output.size() / 2;
+        for (size_t o = SincResampler::taps; o < frames; o++) {
+            const double expected = 0.5 * std::sin(2.0 * M_PI * 1000.0 * o / dst_rate);
+            power += expected * expected * 2;
+            noise += std::pow(output[o * 2] - expected, 2) + std::pow(output[o * 2 + 1] + expected, 2);
+        }
+        return 10.0 * std::log10(power / noise);
+    }
+
+    void test_accuracy() {
+        const struct {
+            uint32_t src;
+            uint32_t dst;
+        } ratios[] = {
+            { 44100, 48000 },  // polyphase 147/160
+            { 48000, 44100 },  // polyphase, decimating
+            { 32000, 48000 },  // polyphase 2/3
+            { 44100, 47999 },  // fine table
+            { 48000, 44101 },  // fine table, decimating
+        };
+        for (auto &ratio : ratios) {
+            const size_t in_frames = ratio.src;
+            auto output = resample_sine(ratio.src, ratio.dst, in_frames);
+
+            // the kernel keeps half a window of lookahead queued
+            const double expected = (double) in_frames * ratio.dst / ratio.src;
+            const double frames = output.size() / 2.0;
+            CHECK(frames <= expected && frames >= expected - SincResampler::taps);
+
+            const auto snr = sine_snr_db(output, ratio.dst);
+            printf("%u -> %u Hz: %.0f frames, %.1f dB SNR\n", ratio.src, ratio.dst, frames, snr);
+            CHECK(snr > 90.0);
+        }
+    }
+
+    // a fixed ratio stays balanced over many blocks, so the queue neither drains nor grows
+    void test_exact_balance() {
+        SincResampler resampler;
+        resampler.setup(2, 44100, 48000);
+
+        // a 480 frame device buffer takes 441 game frames per period
+        resampler.set_step(441, 480);
+        size_t silent_periods = 0;
+        for (size_t period = 0; period < 2000; period++) {
+            resampler.reserve(441);
+            float *in = resampler.enqueue(441);
+            std::fill(in, in + 441 * 2, 0.25f);
+
+            CHECK_EQ(resampler.produce_exact(480), (size_t) 480);
+            CHECK_EQ(resampler.output_frames(), (size_t) 480);
+
+            // silence while priming, then the DC level passes through
+            const float last = resampler.output()[479 * 2];
+            if (last == 0.0f) {
+                silent_periods++;
+                CHECK_EQ(period + 1, silent_periods);
+            } else if (period > 4) {
+                CHECK(std::fabs(last - 0.25f) < 1e-3f);
+            }
+        }
+        CHECK(silent_periods >= 1 && silent_periods <= 2);
+    }
+
+    // more channels than the SIMD kernels handle go through the generic dot product
+    void test_multichannel() {
+        SincResampler resampler;
+        resampler.setup(6, 48000, 44100);
+        size_t total = 0;
+        for (size_t block = 0; block < 100; block++) {
+            resampler.reserve(480);
+            float *in = resampler.enqueue(480);
+            for (size_t i = 0; i < 480 * 6; i++) {
+                in[i] = (float) (i % 6) * 0.1f;
+            }
+            total += resampler.produce_variable();
+        }
+        const float *out = resampler.output() + (resampler.output_frames() - 1) * 6;
+        for (size_t c = 0; c < 6; c++) {
+            CHECK(std::fabs(out[c] - c * 0.1f) < 1e-3f);
+        }
+        CHECK(total <= 48000 * 441 / 480 && total >= 48000 * 441 / 480 - SincResampler::taps);
+    }
+}
+
+int main() {
+    test_accuracy();
+    test_exact_balance();
+    test_multichannel();
+    return test::result();
+}
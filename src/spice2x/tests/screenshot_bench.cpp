@@ -0,0 +1,106 @@
+/*
+ * util/pixelconv, external/fpng: the two halves of a screenshot save at 1080p and 4K, converting
+ * the back buffer to RGB and encoding it as PNG.
+ *
+ * before: every row converted by the scalar loop, fpng built with FPNG_NO_SSE.
+ * after:  sixteen pixel SSSE3 blocks with the scalar loop on the tail, fpng with its SSE4.1
+ *         crc32, adler32 and filter kernels picked at runtime.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <external/fpng/fpng.h>
+
+#include "util/pixelconv.h"
+#include "fpng_no_sse.h"
+#include "test.h"
+
+using pixelconv::SourceFormat;
+
+namespace {
+
+    // smooth gradients with some noise and flat panels, closer to a game frame than pure noise
+    // which no PNG encoder gets anywhere with
+    std::vector<uint8_t> make_frame(size_t width, size_t height, size_t pixel_size) {
+        std::mt19937 rng(37);
+        std::vector<uint8_t> frame(width * height * pixel_size);
+        for (size_t y = 0; y < height; y++) {
+            for (size_t x = 0; x < width; x++) {
+                const bool panel = (x / 256 + y / 128) % 3 == 0;
+                const uint32_t value = panel ? 0x40 : (uint32_t) (x * 7 + y * 3 + rng() % 8);
+                for (size_t i = 0; i < pixel_size; i++) {
+                    frame[(y * width + x) * pixel_size + i] = (uint8_t) (value >> i * 2);
+                }
+            }
+        }
+        return frame;
+    }
+}
+
+int main() {
+    fpng::fpng_init();
+    fpng_no_sse::fpng_init();
+    printf("fpng SSE4.1 path %s\n", fpng::fpng_cpu_supports_sse41() ? "available" : "unavailable");
+
+    const struct {
+        SourceFormat format;
+        size_t pixel_size;
+        const char *name;
+    } formats[] = {
+        { SourceFormat::XRGB8888, 4, "8888" },
+        { SourceFormat::RGB565, 2, "565" },
+        { SourceFormat::XRGB1555, 2, "555" },
+        { SourceFormat::ARGB2101010, 4, "2-10-10-10" },
+    };
+
+    const struct {
+        size_t width, height;
+        const char *name;
+    } sizes[] = {
+        { 1920, 1080, "1080p" },
+        { 3840, 2160, "4K" },
+    };
+
+    for (auto &size : sizes) {
+        const size_t iterations = size.width == 1920 ? 40 : 10;
+        std::vector<uint8_t> rgb(size.width * size.height * 3);
+
+        for (auto &format : formats) {
+            const auto frame = make_frame(size.width, size.height, format.pixel_size);
+            const size_t pitch = size.width * format.pixel_size;
+            const auto before = test::time_ns(iterations, [&](size_t) {
+                for (size_t row = 0; row < size.height; row++) {
+                    pixelconv::row_to_rgb_scalar(format.format, frame.data() + row * pitch,
+                            rgb.data() + row * size.width * 3, 0, size.width);
+                }
+                test::keep(rgb[0]);
+            });
+            const auto after = test::time_ns(iterations, [&](size_t) {
+                pixelconv::image_to_rgb(format.format, size.width, size.height, frame.data(), pitch,
+                        rgb.data());
+                test::keep(rgb[0]);
+            });
+            printf("%-5s convert %-10s %7.2f ms before, %7.2f ms after\n", size.name, format.name,
+                    before / 1e6, after / 1e6);
+        }
+
+        // what the last conversion left in rgb, the 2-10-10-10 frame
+        std::vector<uint8_t> png;
+        size_t before_size = 0, after_size = 0;
+        const auto before = test::time_ns(iterations / 2, [&](size_t) {
+            png.clear();
+            fpng_no_sse::fpng_encode_image_to_memory(rgb.data(), size.width, size.height, 3, png);
+            before_size = png.size();
+        });
+        const auto after = test::time_ns(iterations / 2, [&](size_t) {
+            png.clear();
+            fpng::fpng_encode_image_to_memory(rgb.data(), size.width, size.height, 3, png);
+            after_size = png.size();
+        });
+        printf("%-5s fpng encode        %7.2f ms before, %7.2f ms after (%zu and %zu bytes)\n",
+                size.name, before / 1e6, after / 1e6, before_size, after_size);
+    }
+    return 0;
+}
@@ -0,0 +1,404 @@
+/*
+ * api/serial_framer: requests split over arbitrary reads and wrapping around the ring, keys
+ * switching right after a request, the keystream running through requests and answers alike
+ * so encrypted requests cannot be pipelined, session resets split over reads, overflow, and
+ * whole sessions over a pty against the loop of api/serial.cpp: plain requests pipelined and
+ * their answers batched, encrypted requests answered one at a time, a key change and a reset
+ * halfway through an encrypted session.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <poll.h>
+#include <pty.h>
+#include <random>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "api/serial_framer.h"
+#include "test.h"
+
+using api::SerialFramer;
+
+namespace {
+
+    std::string make_request(int id, size_t padding = 0) {
+        return "{\"id\":" + std::to_string(id) + ",\"module\":\"buttons\",\"function\":\"write\","
+                "\"params\":[[\"Test\",1]]}" + std::string(padding, ' ');
+    }
+
+    std::vector<uint8_t> terminated(const std::string &text) {
+        std::vector<uint8_t> bytes(text.begin(), text.end());
+        bytes.push_back(0);
+        return bytes;
+    }
+
+    void test_split_reads() {
+        std::mt19937 rng(3);
+        uint8_t key[] = "password";
+        uint8_t other_key[] = "other";
+        for (int round = 0; round < 200; round++) {
+            const bool encrypted = round % 2;
+            util::RC4 client(key, 8), server(key, 8);
+            util::RC4 client_other(other_key, 5), server_other(other_key, 5);
+            util::RC4 *cipher = encrypted ? &server : nullptr;
+
+            // request 50 switches both sides to another key right after it
+            std::vector<uint8_t> stream;
+            std::vector<std::string> sent;
+            for (int i = 0; i < 200; i++) {
+                sent.push_back(make_request(i, rng() % 300));
+                auto bytes = terminated(sent.back());
+                if (encrypted) {
+                    (i <= 50 ? client : client_other).crypt(bytes.data(), bytes.size());
+                }
+                stream.insert(stream.end(), bytes.begin(), bytes.end());
+            }
+
+            SerialFramer framer(1024 + rng() % 4096);
+            size_t pos = 0;
+            size_t received = 0;
+            while (pos < stream.size()) {
+                size_t capacity;
+                const auto buffer = framer.receive_buffer(capacity);
+                if (buffer == nullptr) {
+                    CHECK(buffer != nullptr);
+                    break;
+                }
+                const auto size = std::min({ capacity, stream.size() - pos, (size_t) (1 + rng() % 700) });
+                memcpy(buffer, stream.data() + pos, size);
+                pos += size;
+                CHECK(!framer.received(size));
+
+                const char *data;
+                size_t data_size;
+                while (framer.next(cipher, data, data_size)) {
+                    CHECK(received < sent.size() && std::string(data, data_size) == sent[received]);
+                    if (encrypted && received == 50) {
+                        cipher = &server_other;
+                    }
+                    received++;
+                }
+            }
+            CHECK_EQ(received, sent.size());
+        }
+    }
+
+    // requests and answers share the keystream, the next request only decrypts once the client
+    // went past the answer, which it can only do after receiving it
+    void test_shared_keystream() {
+        uint8_t key[] = "password";
+        const auto first = terminated(make_request(1));
+        const auto second = terminated(make_request(2));
+        std::string answer = "{\"id\":1,\"errors\":[],\"data\":[]}";
+        answer.push_back(0);
+
+        for (const bool waited : { false, true }) {
+            util::RC4 client(key, 8), server(key, 8);
+            std::vector<uint8_t> stream = first;
+            client.crypt(stream.data(), stream.size());
+            if (waited) {
+                std::vector<uint8_t> received(answer.size());
+                client.crypt(received.data(), received.size());
+            }
+            auto next = second;
+            client.crypt(next.data(), next.size());
+            stream.insert(stream.end(), next.begin(), next.end());
+
+            SerialFramer framer;
+            size_t capacity;
+            memcpy(framer.receive_buffer(capacity), stream.data(), stream.size());
+            framer.received(stream.size());
+            const char *data;
+            size_t size;
+            CHECK(framer.next(&server, data, size) && std::string(data, size) == make_request(1));
+            std::vector<uint8_t> out(answer.begin(), answer.end());
+            server.crypt(out.data(), out.size());
+            const bool decrypted = framer.next(&server, data, size) && std::string(data, size) == make_request(2);
+            CHECK_EQ(decrypted, waited);
+        }
+    }
+
+    void test_reset_and_overflow() {
+
+        // eight zero bytes split over two reads, behind a request that never finished
+        SerialFramer framer;
+        const std::string half = "{\"half";
+        const uint8_t zeros[8] {};
+        size_t capacity;
+        memcpy(framer.receive_buffer(capacity), half.data(), half.size());
+        CHECK(!framer.received(half.size()));
+        memcpy(framer.receive_buffer(capacity), zeros, 3);
+        CHECK(!framer.received(3));
+        const char *data;
+        size_t size;
+        CHECK(framer.next(nullptr, data, size) && std::string(data, size) == half);
+        while (framer.next(nullptr, data, size)) {
+            CHECK_EQ(size, (size_t) 0);
+        }
+        memcpy(framer.receive_buffer(capacity), zeros, 5);
+        CHECK(framer.received(5));
+        const auto request = terminated(make_request(7));
+        memcpy(framer.receive_buffer(capacity), request.data(), request.size());
+        framer.received(request.size());
+        CHECK(framer.next(nullptr, data, size) && std::string(data, size) == make_request(7));
+        CHECK(!framer.next(nullptr, data, size));
+
+        // a request as large as the ring can never complete
+        SerialFramer small(64);
+        auto buffer = small.receive_buffer(capacity);
+        memset(buffer, 'x', capacity);
+        small.received(capacity);
+        CHECK(small.receive_buffer(capacity) == nullptr);
+        CHECK(!small.next(nullptr, data, size));
+        CHECK(small.overflowed());
+        small.clear();
+        CHECK(small.receive_buffer(capacity) != nullptr && capacity == 64);
+    }
+
+    // the loop of api/serial.cpp with read() and write() for ReadFile() and WriteFile(). requests
+    // starting with "key:" switch to the key after it once answered, a reset goes back to
+    // `password`, and an empty one is no encryption
+    struct Port {
+        int fd;
+        std::string password = "password";
+        std::atomic<int> writes {0};
+
+        void run() {
+            SerialFramer framer;
+            util::RC4 *cipher = nullptr;
+            std::string next_password = this->password;
+            bool password_change = true;
+            const auto change_password = [&] {
+                if (password_change) {
+                    password_change = false;
+                    delete cipher;
+                    cipher = next_password.empty() ? nullptr
+                            : new util::RC4((uint8_t *) next_password.data(), next_password.size());
+                }
+            };
+            change_password();
+
+            std::vector<char> batch;
+            const auto write_batch = [&] {
+                if (!batch.empty() && write(this->fd, batch.data(), batch.size()) != (ssize_t) batch.size()) {
+                    return false;
+                }
+                if (!batch.empty()) {
+                    this->writes++;
+                }
+                batch.clear();
+                return true;
+            };
+            while (true) {
+                size_t capacity;
+                const auto buffer = framer.receive_buffer(capacity);
+                const auto received = read(this->fd, buffer, capacity);
+                if (received <= 0) {
+                    break;
+                }
+                if (framer.received(received)) {
+                    next_password = this->password;
+                    password_change = true;
+                    change_password();
+                }
+                const char *request;
+                size_t size;
+                bool failed = false;
+                while (framer.next(cipher, request, size)) {
+                    if (size == 0) {
+                        continue;
+                    }
+                    const std::string text(request, size);
+                    std::string out = "ok:" + text;
+                    out.push_back(0);
+                    if (text.rfind("key:", 0) == 0) {
+                        next_password = text.substr(4);
+                        password_change = true;
+                    }
+                    const bool encrypted = cipher != nullptr;
+                    if (encrypted) {
+                        cipher->crypt((uint8_t *) out.data(), out.size());
+                    }
+                    batch.insert(batch.end(), out.begin(), out.end());
+                    change_password();
+                    if (encrypted && !write_batch()) {
+                        failed = true;
+                        break;
+                    }
+                }
+                if (failed || !write_batch()) {
+                    break;
+                }
+            }
+            delete cipher;
+        }
+    };
+
+    // a raw pty, the serial port stand-in; the server gets the slave side
+    bool open_pty(int &master, int &slave) {
+        if (openpty(&master, &slave, nullptr, nullptr, nullptr) != 0) {
+            return false;
+        }
+        for (auto fd : { master, slave }) {
+            termios attributes;
+            tcgetattr(fd, &attributes);
+            cfmakeraw(&attributes);
+            tcsetattr(fd, TCSANOW, &attributes);
+        }
+        return true;
+    }
+
+    // reads one answer of the client side, decrypting it if there is a cipher
+    class Reader {
+    public:
+        explicit Reader(int fd) : fd(fd) {
+        }
+
+        bool next(util::RC4 *cipher, std::string &answer) {
+            answer.clear();
+            while (true) {
+                if (this->pending.empty()) {
+                    pollfd poll_fd { this->fd, POLLIN, 0 };
+                    uint8_t chunk[4096];
+                    if (poll(&poll_fd, 1, 2000) <= 0) {
+                        return false;
+                    }
+                    const auto received = read(this->fd, chunk, sizeof(chunk));
+                    if (received <= 0) {
+                        return false;
+                    }
+                    this->pending.assign(chunk, chunk + received);
+                }
+                size_t length = this->pending.size();
+                if (cipher) {
+                    length = cipher->crypt_until(this->pending.data(), length, 0);
+                } else {
+                    const auto terminator = std::find(this->pending.begin(), this->pending.end(), 0);
+                    length = std::min<size_t>(terminator - this->pending.begin() + 1, length);
+                }
+                const bool complete = this->pending[length - 1] == 0;
+                answer.append((const char *) this->pending.data(), length - (complete ? 1 : 0));
+                this->pending.erase(this->pending.begin(), this->pending.begin() + length);
+                if (complete) {
+                    return true;
+                }
+            }
+        }
+
+    private:
+        int fd;
+        std::vector<uint8_t> pending;
+    };
+
+    void test_pty_pipelined() {
+        int master, slave;
+        if (!open_pty(master, slave)) {
+            fprintf(stderr, "no pty, skipping\n");
+            return;
+        }
+        Port port { slave };
+        port.password.clear();
+        std::thread server([&] {
+            port.run();
+        });
+
+        // everything goes out in one go, the answers are read on another thread meanwhile
+        constexpr int count = 500;
+        std::vector<uint8_t> burst;
+        for (int i = 0; i < count; i++) {
+            const auto request = terminated(make_request(i));
+            burst.insert(burst.end(), request.begin(), request.end());
+        }
+        int in_order = 0;
+        std::thread reader([&] {
+            Reader answers(master);
+            std::string answer;
+            while (in_order < count && answers.next(nullptr, answer) && answer == "ok:" + make_request(in_order)) {
+                in_order++;
+            }
+        });
+        for (size_t pos = 0; pos < burst.size();) {
+            const auto written = write(master, burst.data() + pos, burst.size() - pos);
+            if (written <= 0) {
+                break;
+            }
+            pos += written;
+        }
+        reader.join();
+        CHECK_EQ(in_order, count);
+        close(master);
+        server.join();
+        close(slave);
+        CHECK(port.writes.load() < count);
+    }
+
+    void test_pty_encrypted() {
+        int master, slave;
+        if (!open_pty(master, slave)) {
+            fprintf(stderr, "no pty, skipping\n");
+            return;
+        }
+        Port port { slave };
+        std::thread server([&] {
+            port.run();
+        });
+
+        // requests go out a few bytes at a time, each only once the last answer is decrypted
+        std::mt19937 rng(9);
+        std::string password = port.password;
+        util::RC4 *cipher = new util::RC4((uint8_t *) password.data(), password.size());
+        Reader answers(master);
+        int answered = 0;
+        constexpr int count = 300;
+        for (int i = 0; i < count; i++) {
+            std::string text = make_request(i, rng() % 200);
+            if (i == 100) {
+                text = "key:another password";
+            }
+            if (i == 200) {
+
+                // a reset starts over with the first key
+                const uint8_t zeros[8] {};
+                CHECK_EQ(write(master, zeros, sizeof(zeros)), (ssize_t) sizeof(zeros));
+                delete cipher;
+                cipher = new util::RC4((uint8_t *) port.password.data(), port.password.size());
+            }
+            auto bytes = terminated(text);
+            cipher->crypt(bytes.data(), bytes.size());
+            for (size_t pos = 0; pos < bytes.size();) {
+                const auto size = std::min<size_t>(1 + rng() % 64, bytes.size() - pos);
+                CHECK_EQ(write(master, bytes.data() + pos, size), (ssize_t) size);
+                pos += size;
+            }
+            std::string answer;
+            if (!answers.next(cipher, answer) || answer != "ok:" + text) {
+                break;
+            }
+            answered++;
+            if (i == 100) {
+                delete cipher;
+                cipher = new util::RC4((uint8_t *) "another password", 16);
+            }
+        }
+        delete cipher;
+        CHECK_EQ(answered, count);
+        close(master);
+        server.join();
+        close(slave);
+        CHECK_EQ(port.writes.load(), count);
+    }
+}
+
+int main() {
+    test_split_reads();
+    test_shared_keystream();
+    test_reset_and_overflow();
+    test_pty_pipelined();
+    test_pty_encrypted();
+    return test::result();
+}
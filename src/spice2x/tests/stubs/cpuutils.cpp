@@ -0,0 +1,48 @@
+#include "util/cpuutils.h"
+
+#include <cstdlib>
+
+// host stand-in, the real one queries through the Windows API.
+// SPICE_TEST_SCALAR=1 hides every extension so the scalar fallbacks get tested as well
+
+namespace cpuutils {
+
+    static bool scalar_only() {
+        static const bool scalar = getenv("SPICE_TEST_SCALAR") != nullptr;
+        return scalar;
+    }
+
+#if defined(__i386__) || defined(__x86_64__)
+    bool has_sse2() {
+        return !scalar_only() && __builtin_cpu_supports("sse2");
+    }
+
+    bool has_ssse3() {
+        return !scalar_only() && __builtin_cpu_supports("ssse3");
+    }
+
+    bool has_sse4_1() {
+        return !scalar_only() && __builtin_cpu_supports("sse4.1");
+    }
+
+    bool has_avx2() {
+        return !scalar_only() && __builtin_cpu_supports("avx2");
+    }
+#else
+    bool has_sse2() {
+        return false;
+    }
+
+    bool has_ssse3() {
+        return false;
+    }
+
+    bool has_sse4_1() {
+        return false;
+    }
+
+    bool has_avx2() {
+        return false;
+    }
+#endif
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+ * host stand-in for util/fileutils.h: the existence checks through std::filesystem instead of
+ * the Windows API.
+ */
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace fileutils {
+
+    inline bool file_exists(const std::filesystem::path &file_path) {
+        std::error_code error;
+        return std::filesystem::is_regular_file(file_path, error);
+    }
+
+    inline bool file_exists(const std::string &file_path) {
+        return file_exists(std::filesystem::path(file_path));
+    }
+
+    inline bool file_exists(const char *file_path) {
+        return file_exists(std::filesystem::path(file_path));
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+ * host stand-in for util/logging.h: same macros, printed to stderr with the real formatting.
+ * log_fatal aborts instead of stopping the launcher.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "external/fmt/include/fmt/format.h"
+#include "external/fmt/include/fmt/compile.h"
+#include "external/fmt/include/fmt/std.h"
+
+#define LOG_FORMAT(level, module, fmt_str, ...) fmt::format(FMT_COMPILE("[{}] {}: " fmt_str "\n"), \
+    level, module, ## __VA_ARGS__)
+
+#define log_misc(module, format_str, ...) fputs(LOG_FORMAT("M", module, format_str, ## __VA_ARGS__).c_str(), stderr)
+#define log_info(module, format_str, ...) fputs(LOG_FORMAT("I", module, format_str, ## __VA_ARGS__).c_str(), stderr)
+#define log_warning(module, format_str, ...) fputs(LOG_FORMAT("W", module, format_str, ## __VA_ARGS__).c_str(), stderr)
+#define log_special(module, format_str, ...) fputs(LOG_FORMAT("W", module, format_str, ## __VA_ARGS__).c_str(), stderr)
+#define log_fatal(module, format_str, ...) { \
+    fputs(LOG_FORMAT("F", module, format_str, ## __VA_ARGS__).c_str(), stderr); \
+    std::abort(); \
+} ((void) 0 )
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * host stand-in for util/utils.h: only the string helpers the host built units use, copied
+ * from the real header, which includes windows.h for the rest.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+#include "util/logging.h"
+
+static inline std::string strtrim(const std::string& input) {
+    std::string output = input;
+    // trim spaces
+    output.erase(0, output.find_first_not_of("\t\n\v\f\r "));
+    output.erase(output.find_last_not_of("\t\n\v\f\r ") + 1);
+    return output;
+}
+
+static inline std::string strtolower(const std::string& input) {
+    std::string output = strtrim(input);
+    // replace with lower case
+    std::transform(
+        output.begin(), output.end(), output.begin(),
+        [](unsigned char c){ return std::tolower(c); });
+    return output;
+}
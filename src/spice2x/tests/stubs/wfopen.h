@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * the bundled tinyxml2 opens files by wide path through the MSVCRT _wfopen. forced into its
+ * translation unit on host builds; paths are narrowed byte by byte, which covers ASCII.
+ */
+
+#include <cstdio>
+#include <string>
+
+inline FILE *_wfopen(const wchar_t *path, const wchar_t *mode) {
+    const std::wstring wide_path(path), wide_mode(mode);
+    return fopen(std::string(wide_path.begin(), wide_path.end()).c_str(),
+            std::string(wide_mode.begin(), wide_mode.end()).c_str());
+}
@@ -0,0 +1,53 @@
+/*
+ * util/tapeled: cost of picking one color for a tape per algorithm, for a short tape like the
+ * ones on cabinet side panels and a long one, and of update_led_tape when the game resends an
+ * unchanged tape.
+ */
+
+#include <random>
+#include <vector>
+
+#include "util/tapeled.h"
+#include "test.h"
+
+using namespace tapeledutils;
+
+int main() {
+    std::mt19937 rng(2);
+    const struct {
+        led_tape_color_pick_algorithm algorithm;
+        const char *name;
+    } algorithms[] = {
+        { TAPE_LED_USE_MIDDLE, "middle" },
+        { TAPE_LED_USE_AVERAGE, "average" },
+        { TAPE_LED_USE_PERCEPTUAL, "perceptual" },
+        { TAPE_LED_USE_DOMINANT, "dominant" },
+    };
+
+    for (size_t count : { 74, 1024 }) {
+        std::vector<uint8_t> tape(count * 3);
+        for (auto &b : tape) {
+            b = (uint8_t) rng();
+        }
+        for (auto &entry : algorithms) {
+            TAPE_LED_ALGORITHM = entry.algorithm;
+            const auto ns = test::time_ns(200'000, [&](size_t) {
+                test::keep(pick_color_from_led_tape(tape.data(), count).r);
+            });
+            printf("%4zu LEDs  %-10s %8.1f ns\n", count, entry.name, ns);
+        }
+
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_AVERAGE;
+        tape_cache cache;
+        rgb_float3_t color;
+        const auto unchanged = test::time_ns(200'000, [&](size_t) {
+            test::keep(update_led_tape(cache, tape.data(), count, 0, color));
+        });
+        const auto changed = test::time_ns(200'000, [&](size_t i) {
+            tape[0] = (uint8_t) i;
+            test::keep(update_led_tape(cache, tape.data(), count, 0, color));
+        });
+        printf("%4zu LEDs  update     %8.1f ns unchanged, %8.1f ns changed\n", count, unchanged, changed);
+    }
+    return 0;
+}
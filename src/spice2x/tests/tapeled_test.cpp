@@ -0,0 +1,205 @@
+/*
+ * util/tapeled: every color pick algorithm against a straightforward double precision
+ * reference, for tape lengths around the SIMD block size and the 4096 LED sum blocks, saturated
+ * tapes, zone splitting, max_value scaling and update_led_tape skipping unchanged tapes.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "util/tapeled.h"
+#include "test.h"
+
+using namespace tapeledutils;
+
+namespace {
+
+    rgb_float3_t reference(const uint8_t *data, size_t count, uint8_t divisor) {
+        double r = 0, g = 0, b = 0;
+        if (count == 0) {
+            return { 0.f, 0.f, 0.f };
+        }
+        switch (TAPE_LED_ALGORITHM) {
+            case TAPE_LED_USE_FIRST:
+            case TAPE_LED_USE_MIDDLE:
+            case TAPE_LED_USE_LAST: {
+                const size_t index = TAPE_LED_ALGORITHM == TAPE_LED_USE_FIRST ? 0
+                        : TAPE_LED_ALGORITHM == TAPE_LED_USE_LAST ? count - 1 : count / 2;
+                r = data[index * 3];
+                g = data[index * 3 + 1];
+                b = data[index * 3 + 2];
+                break;
+            }
+            case TAPE_LED_USE_AVERAGE:
+            case TAPE_LED_USE_PERCEPTUAL: {
+                const bool squares = TAPE_LED_ALGORITHM == TAPE_LED_USE_PERCEPTUAL;
+                for (size_t i = 0; i < count; i++) {
+                    const double cr = data[i * 3], cg = data[i * 3 + 1], cb = data[i * 3 + 2];
+                    r += squares ? cr * cr : cr;
+                    g += squares ? cg * cg : cg;
+                    b += squares ? cb * cb : cb;
+                }
+                r /= count;
+                g /= count;
+                b /= count;
+                if (squares) {
+                    r = std::sqrt(r);
+                    g = std::sqrt(g);
+                    b = std::sqrt(b);
+                }
+                break;
+            }
+            case TAPE_LED_USE_DOMINANT: {
+
+                // largest bucket of top three bits per channel, ties go to the one that got
+                // there first
+                std::map<int, size_t> counts;
+                int best = -1;
+                size_t best_count = 0;
+                for (size_t i = 0; i < count; i++) {
+                    const auto c = &data[i * 3];
+                    if (c[0] < 16 && c[1] < 16 && c[2] < 16) {
+                        continue;
+                    }
+                    const int bucket = (c[0] >> 5) << 6 | (c[1] >> 5) << 3 | (c[2] >> 5);
+                    if (++counts[bucket] > best_count) {
+                        best_count = counts[bucket];
+                        best = bucket;
+                    }
+                }
+                size_t members = 0;
+                for (size_t i = 0; i < count; i++) {
+                    const auto c = &data[i * 3];
+                    const int bucket = (c[0] >> 5) << 6 | (c[1] >> 5) << 3 | (c[2] >> 5);
+                    if (best < 0 || bucket == best) {
+                        r += c[0];
+                        g += c[1];
+                        b += c[2];
+                        members++;
+                    }
+                }
+                r /= members;
+                g /= members;
+                b /= members;
+                break;
+            }
+            default:
+                return { 0.f, 0.f, 0.f };
+        }
+        return { (float) (r / divisor), (float) (g / divisor), (float) (b / divisor) };
+    }
+
+    bool close(const rgb_float3_t &a, const rgb_float3_t &b) {
+        return std::fabs(a.r - b.r) < 1e-4f && std::fabs(a.g - b.g) < 1e-4f && std::fabs(a.b - b.b) < 1e-4f;
+    }
+
+    const led_tape_color_pick_algorithm ALGORITHMS[] = {
+        TAPE_LED_USE_NONE, TAPE_LED_USE_FIRST, TAPE_LED_USE_MIDDLE, TAPE_LED_USE_LAST,
+        TAPE_LED_USE_AVERAGE, TAPE_LED_USE_PERCEPTUAL, TAPE_LED_USE_DOMINANT,
+    };
+
+    void test_algorithms() {
+        std::mt19937 rng(11);
+        for (auto algorithm : ALGORITHMS) {
+            TAPE_LED_ALGORITHM = algorithm;
+            for (size_t count : { 0, 1, 2, 15, 16, 17, 47, 48, 49, 100, 4095, 4096, 4097, 9000 }) {
+                std::vector<uint8_t> tape(count * 3);
+
+                // a few colors repeated with some noise, so the dominant one is not a coin toss
+                const uint8_t palette[4][3] = { { 255, 0, 0 }, { 0, 200, 40 }, { 8, 4, 2 }, { 90, 90, 250 } };
+                for (size_t i = 0; i < count; i++) {
+                    const auto &color = palette[rng() % 4];
+                    for (int c = 0; c < 3; c++) {
+                        tape[i * 3 + c] = (uint8_t) std::clamp<int>(color[c] + (int) (rng() % 9) - 4, 0, 255);
+                    }
+                }
+                for (uint8_t divisor : { 0xFF, 0x7F }) {
+                    tape_led light(count, 0, 1, 2, divisor, "tape");
+                    const auto color = pick_color_from_led_tape(light, tape.data(), count);
+                    const auto expected = reference(tape.data(), count, divisor);
+                    if (!close(color, expected)) {
+                        fprintf(stderr, "algorithm %d, %zu LEDs, max %d: %f %f %f != %f %f %f\n",
+                                (int) algorithm, count, divisor, color.r, color.g, color.b,
+                                expected.r, expected.g, expected.b);
+                        test::failures()++;
+                    }
+                }
+            }
+        }
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_MIDDLE;
+    }
+
+    // the widest tapes there are, all on, must not overflow any lane
+    void test_saturated() {
+        std::vector<uint8_t> tape(20000 * 3, 0xFF);
+        for (auto algorithm : { TAPE_LED_USE_AVERAGE, TAPE_LED_USE_PERCEPTUAL, TAPE_LED_USE_DOMINANT }) {
+            TAPE_LED_ALGORITHM = algorithm;
+            const auto color = pick_color_from_led_tape(tape.data(), 20000);
+            CHECK(close(color, { 1.f, 1.f, 1.f }));
+        }
+
+        // all off is still a color for the dominant pick
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_DOMINANT;
+        std::vector<uint8_t> dark = { 2, 4, 6, 4, 6, 8 };
+        CHECK(close(pick_color_from_led_tape(dark.data(), 2), { 3.f / 255, 5.f / 255, 7.f / 255 }));
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_MIDDLE;
+    }
+
+    void test_zones() {
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_AVERAGE;
+        std::vector<uint8_t> tape;
+        for (int i = 0; i < 10; i++) {
+            const uint8_t value = i < 5 ? 50 : 250;
+            tape.insert(tape.end(), { value, 0, value });
+        }
+        rgb_float3_t colors[3];
+        pick_zone_colors_from_led_tape(tape.data(), 10, 0, colors, 2);
+        CHECK(close(colors[0], { 50.f / 255, 0.f, 50.f / 255 }));
+        CHECK(close(colors[1], { 250.f / 255, 0.f, 250.f / 255 }));
+
+        // uneven splits still cover every LED exactly once: 3 + 3 + 4
+        pick_zone_colors_from_led_tape(tape.data(), 10, 0, colors, 3);
+        CHECK(close(colors[0], { 50.f / 255, 0.f, 50.f / 255 }));
+        CHECK(close(colors[1], { (50.f * 2 + 250.f) / 3 / 255, 0.f, (50.f * 2 + 250.f) / 3 / 255 }));
+        CHECK(close(colors[2], { 250.f / 255, 0.f, 250.f / 255 }));
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_MIDDLE;
+    }
+
+    void test_update() {
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_AVERAGE;
+        tape_cache cache;
+        std::vector<uint8_t> tape(60 * 3, 100);
+        rgb_float3_t color { -1.f, -1.f, -1.f };
+        CHECK(update_led_tape(cache, tape.data(), 60, 200, color));
+        CHECK(close(color, { 0.5f, 0.5f, 0.5f }));
+
+        // unchanged, color left alone
+        color = { -1.f, -1.f, -1.f };
+        CHECK(!update_led_tape(cache, tape.data(), 60, 200, color));
+        CHECK_EQ(color.r, -1.f);
+
+        // one byte changed, and a different length with the same prefix
+        tape[179] = 0;
+        CHECK(update_led_tape(cache, tape.data(), 60, 200, color));
+        CHECK(update_led_tape(cache, tape.data(), 59, 200, color));
+        CHECK(!update_led_tape(cache, tape.data(), 59, 200, color));
+
+        rgb_float3_t zones[4];
+        tape_cache zone_cache;
+        CHECK(update_led_tape(zone_cache, tape.data(), 60, 0, zones, 4));
+        CHECK(!update_led_tape(zone_cache, tape.data(), 60, 0, zones, 4));
+        CHECK(close(zones[3], { 100.f / 255, 100.f / 255, (100.f * 14) / 15 / 255 }));
+        TAPE_LED_ALGORITHM = TAPE_LED_USE_MIDDLE;
+    }
+}
+
+int main() {
+    test_algorithms();
+    test_saturated();
+    test_zones();
+    test_update();
+    return test::result();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ * minimal helpers for the host tests and benchmarks
+ * a test is a main() using CHECK, the exit code tells ctest whether everything passed.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace test {
+
+    inline int &failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result() {
+        if (failures() > 0) {
+            fprintf(stderr, "%d check(s) failed\n", failures());
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // runs `fn` `iterations` times and returns the nanoseconds per iteration
+    template<typename Fn>
+    double time_ns(size_t iterations, Fn &&fn) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            fn(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+
+    // keeps the compiler from optimizing a value away
+    template<typename T>
+    inline void keep(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile T sink;
+        sink = value;
+#endif
+    }
+}
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        test::failures()++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    auto _a = (a); \
+    auto _b = (b); \
+    if (!(_a == _b)) { \
+        fprintf(stderr, "%s:%d: check failed: %s == %s\n", __FILE__, __LINE__, #a, #b); \
+        test::failures()++; \
+    } \
+} while (0)
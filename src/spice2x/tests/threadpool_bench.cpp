@@ -0,0 +1,178 @@
+/*
+ * util/threadpool: spawn and complete throughput of add() and post() at 1 and 4 workers, the
+ * latency of a post to an idle worker, and the cost of a small parallel_for.
+ *
+ * before: one std::queue of std::function under a mutex, every task a packaged_task held by a
+ *         shared_ptr; fire and forget callers went through add() and dropped the future.
+ *         kept below as LegacyThreadPool.
+ * after:  per-worker deques with stealing, an injection queue for outside posts, tasks in a
+ *         move-only wrapper with inline storage, and post() without a future.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "util/threadpool.h"
+#include "test.h"
+
+namespace {
+
+    // util/threadpool.h before the work-stealing scheduler
+    class LegacyThreadPool {
+    private:
+        std::vector<std::thread> threads;
+        std::queue<std::function<void()>> queue;
+        std::mutex mut;
+        std::condition_variable cv;
+        bool exit = false;
+
+    public:
+
+        LegacyThreadPool(size_t size) {
+            for (size_t i = 0; i < size; i++) {
+                threads.emplace_back([this] {
+                    while (true) {
+                        std::function<void()> func;
+                        std::unique_lock<std::mutex> lock(mut);
+                        cv.wait(lock, [this] { return exit || !queue.empty(); });
+                        if (exit && queue.empty()) return;
+                        func = std::move(queue.front());
+                        queue.pop();
+                        lock.unlock();
+                        func();
+                    }
+                });
+            }
+        }
+
+        ~LegacyThreadPool() {
+            exit = true;
+            mut.lock();
+            mut.unlock();
+            cv.notify_all();
+            for (auto &thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+
+        template<class T, class... Args>
+        auto add(T&& func, Args&&... args)
+        -> std::future<typename std::invoke_result<T, Args...>::type> {
+            using ret_t = typename std::invoke_result<T, Args...>::type;
+            auto task = std::make_shared<std::packaged_task<ret_t()>>(
+                    std::bind(std::forward<T>(func), std::forward<Args>(args)...));
+            std::future<ret_t> fut = task->get_future();
+            std::unique_lock<std::mutex> lock(mut);
+            queue.emplace([task] () { (*task)(); });
+            lock.unlock();
+            cv.notify_one();
+            return fut;
+        }
+    };
+
+    constexpr size_t BURSTS = 2'000;
+    constexpr size_t BURST_SIZE = 64;
+
+    // bursts of add() from outside, each waited for through its futures; ns per task
+    template<class Pool>
+    double add_throughput(Pool &pool) {
+        std::vector<std::future<size_t>> futures;
+        futures.reserve(BURST_SIZE);
+        size_t sum = 0;
+        const auto result = test::time_ns(BURSTS, [&](size_t) {
+            for (size_t task = 0; task < BURST_SIZE; task++) {
+                futures.push_back(pool.add([task] {
+                    return task;
+                }));
+            }
+            for (auto &future : futures) {
+                sum += future.get();
+            }
+            futures.clear();
+        }) / BURST_SIZE;
+        test::keep(sum);
+        return result;
+    }
+
+    // bursts of fire and forget tasks counting themselves done; ns per task
+    template<class Post>
+    double post_throughput(Post &&post) {
+        std::atomic<size_t> done {0};
+        return test::time_ns(BURSTS, [&](size_t i) {
+            for (size_t task = 0; task < BURST_SIZE; task++) {
+                post([&done] {
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            while (done.load(std::memory_order_acquire) != (i + 1) * BURST_SIZE) {
+                std::this_thread::yield();
+            }
+        }) / BURST_SIZE;
+    }
+
+    // one task at a time, waiting for it to run, so the workers are asleep on every post
+    template<class Post>
+    double idle_latency(Post &&post) {
+        constexpr size_t round_trips = 20'000;
+        std::atomic<size_t> done {0};
+        return test::time_ns(round_trips, [&](size_t i) {
+            post([&done] {
+                done.fetch_add(1, std::memory_order_release);
+            });
+            while (done.load(std::memory_order_acquire) != i + 1) {
+                std::this_thread::yield();
+            }
+        });
+    }
+}
+
+int main() {
+    for (size_t workers : { 1, 4 }) {
+        double legacy_add, legacy_post, legacy_idle;
+        {
+            LegacyThreadPool pool(workers);
+            const auto post = [&pool](auto &&func) {
+                pool.add(func);
+            };
+            legacy_add = add_throughput(pool);
+            legacy_post = post_throughput(post);
+            legacy_idle = idle_latency(post);
+        }
+        double pool_add, pool_post, pool_idle;
+        {
+            ThreadPool pool(workers);
+            const auto post = [&pool](auto &&func) {
+                pool.post(func);
+            };
+            pool_add = add_throughput(pool);
+            pool_post = post_throughput(post);
+            pool_idle = idle_latency(post);
+        }
+        printf("%zu worker(s)\n", workers);
+        printf("  add() burst          %8.1f ns/task before, %8.1f ns/task after\n", legacy_add, pool_add);
+        printf("  post() burst         %8.1f ns/task before, %8.1f ns/task after\n", legacy_post, pool_post);
+        printf("  post to idle worker  %8.1f ns before,      %8.1f ns after\n", legacy_idle, pool_idle);
+    }
+
+    // chunks about the size of a screenshot row block
+    ThreadPool pool(4);
+    constexpr size_t loops = 5'000;
+    std::atomic<size_t> sum {0};
+    const auto parallel = test::time_ns(loops, [&](size_t) {
+        pool.parallel_for(0, 64, 8, [&sum](size_t begin, size_t end) {
+            sum.fetch_add(end - begin, std::memory_order_relaxed);
+        });
+    });
+    test::keep(sum.load());
+    printf("parallel_for 8x8 on 4 workers %8.1f ns\n", parallel);
+    return 0;
+}
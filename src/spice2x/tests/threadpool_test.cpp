@@ -0,0 +1,140 @@
+/*
+ * util/threadpool: every posted task runs, external posts to a single worker keep their order,
+ * queue_size drains back to zero, parallel_for covers its range and rethrows, and posts racing
+ * with workers going to sleep are never lost.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "util/threadpool.h"
+#include "test.h"
+
+namespace {
+
+    template<typename Fn>
+    bool wait_until(Fn &&done) {
+        for (int i = 0; i < 5'000'000 && !done(); i++) {
+            std::this_thread::yield();
+        }
+        return done();
+    }
+
+    void test_order() {
+        ThreadPool pool(1);
+        std::vector<int> order;
+        std::atomic<int> done {0};
+        for (int i = 0; i < 1000; i++) {
+            pool.post([&order, &done, i] {
+                order.push_back(i);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        CHECK(wait_until([&] { return done.load(std::memory_order_acquire) == 1000; }));
+        bool ordered = true;
+        for (int i = 0; i < (int) order.size(); i++) {
+            ordered = ordered && order[i] == i;
+        }
+        CHECK(ordered);
+        CHECK(wait_until([&] { return pool.queue_size() == 0; }));
+    }
+
+    void test_lost_wakeups() {
+
+        // single posts from several threads, each waited for, so workers keep going back to
+        // sleep while the next post arrives
+        ThreadPool pool(3);
+        std::atomic<size_t> done {0};
+        std::vector<std::thread> posters;
+        for (int t = 0; t < 3; t++) {
+            posters.emplace_back([&pool, &done] {
+                for (int i = 0; i < 2000; i++) {
+                    std::atomic<bool> ran {false};
+                    pool.post([&ran, &done] {
+                        done.fetch_add(1, std::memory_order_relaxed);
+                        ran.store(true, std::memory_order_release);
+                    }, i % 7 == 0 ? TaskPriority::High : TaskPriority::Normal);
+                    while (!ran.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto &poster : posters) {
+            poster.join();
+        }
+        CHECK_EQ(done.load(), (size_t) 6000);
+        CHECK(wait_until([&] { return pool.queue_size() == 0; }));
+    }
+
+    void test_nested() {
+
+        // tasks posting tasks go through the local deques and get stolen
+        ThreadPool pool(2);
+        std::atomic<size_t> done {0};
+        for (int i = 0; i < 100; i++) {
+            pool.post([&pool, &done] {
+                for (int j = 0; j < 10; j++) {
+                    pool.post([&done] {
+                        done.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+            });
+        }
+        CHECK(wait_until([&] { return done.load() == 1000; }));
+    }
+
+    void test_parallel_for() {
+        ThreadPool pool(2);
+        std::vector<std::atomic<int>> hits(1000);
+        pool.parallel_for(0, hits.size(), 7, [&hits](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                hits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        bool once = true;
+        for (auto &hit : hits) {
+            once = once && hit.load() == 1;
+        }
+        CHECK(once);
+
+        bool thrown = false;
+        try {
+            pool.parallel_for(0, 100, 1, [](size_t begin, size_t) {
+                if (begin == 42) {
+                    throw std::runtime_error("chunk");
+                }
+            });
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        auto future = pool.add([](int a, int b) { return a + b; }, 2, 3);
+        CHECK_EQ(future.get(), 5);
+    }
+
+    void test_drain_on_exit() {
+        std::atomic<size_t> done {0};
+        {
+            ThreadPool pool(2);
+            for (int i = 0; i < 500; i++) {
+                pool.post([&done] {
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        }
+        CHECK_EQ(done.load(), (size_t) 500);
+    }
+}
+
+int main() {
+    test_order();
+    test_lost_wakeups();
+    test_nested();
+    test_parallel_for();
+    test_drain_on_exit();
+    return test::result();
+}
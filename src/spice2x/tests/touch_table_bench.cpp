@@ -0,0 +1,111 @@
+/*
+ * touch/touch_table and util/spsc_ring: cost of a move on a point, of a game poll copying all
+ * points out with and without a writer busy on the same table, and of an event through the ring.
+ *
+ * before: a vector behind a mutex, searched linearly on every write and copied under the lock
+ *         on every poll (reproduced here as the baseline)
+ * after:  slot table with per slot generation counters, event ring without locks
+ */
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "touch/touch_table.h"
+#include "util/spsc_ring.h"
+#include "test.h"
+
+namespace {
+
+    struct Point {
+        uint32_t id;
+        int32_t x, y;
+        bool mouse;
+        double down_ms = 0.0;
+    };
+
+    // the old layout
+    struct LockedPoints {
+        std::mutex mutex;
+        std::vector<Point> points;
+
+        void write(const Point &point) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            for (auto &existing : this->points) {
+                if (existing.id == point.id) {
+                    existing = point;
+                    return;
+                }
+            }
+            this->points.push_back(point);
+        }
+
+        void snapshot(std::vector<Point> &out) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            out.insert(out.end(), this->points.begin(), this->points.end());
+        }
+    };
+
+    constexpr uint32_t POINTS = 10;
+
+    template<class Table>
+    void run(const char *name, Table &table) {
+        for (uint32_t id = 0; id < POINTS; id++) {
+            table.put({ id * 17 + 1, 0, 0, false });
+        }
+        const auto move = test::time_ns(2'000'000, [&](size_t i) {
+            table.put({ (uint32_t) (i % POINTS) * 17 + 1, (int32_t) i, (int32_t) i, false });
+        });
+
+        std::vector<Point> points;
+        points.reserve(64);
+        const auto poll = test::time_ns(1'000'000, [&](size_t) {
+            points.clear();
+            table.snapshot(points);
+            test::keep(points.size());
+        });
+
+        // a writer moving points the whole time
+        std::atomic<bool> stop {false};
+        std::thread writer([&] {
+            for (size_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+                table.put({ (uint32_t) (i % POINTS) * 17 + 1, (int32_t) i, (int32_t) i, false });
+            }
+        });
+        const auto contended = test::time_ns(1'000'000, [&](size_t) {
+            points.clear();
+            table.snapshot(points);
+            test::keep(points.size());
+        });
+        stop = true;
+        writer.join();
+
+        printf("%-12s move %6.1f ns  poll %6.1f ns  poll with writer %7.1f ns\n",
+                name, move, poll, contended);
+    }
+
+    struct LockedTable : LockedPoints {
+        void put(const Point &point) {
+            this->write(point);
+        }
+    };
+}
+
+int main() {
+    LockedTable locked;
+    run("mutex+vector", locked);
+    TouchPointTable<Point> table;
+    run("slot table", table);
+
+    // one event in and out on the same thread, the cost either side pays
+    spsc_ring<Point, 1024> ring;
+    Point event {};
+    const auto ring_ns = test::time_ns(10'000'000, [&](size_t i) {
+        ring.push({ (uint32_t) i, 0, 0, false });
+        ring.pop(event);
+        test::keep(event.id);
+    });
+    printf("ring push+pop %6.1f ns\n", ring_ns);
+    return 0;
+}
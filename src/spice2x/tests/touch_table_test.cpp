@@ -0,0 +1,238 @@
+/*
+ * touch/touch_table and util/spsc_ring: the table against a plain map under random puts,
+ * updates and removes (including the hash index probe chains), landing order of snapshots, a
+ * full table, readers copying points while a writer keeps rewriting them, and the ring keeping
+ * order and dropping nothing with a producer and consumer on separate threads.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "touch/touch_table.h"
+#include "util/spsc_ring.h"
+#include "test.h"
+
+namespace {
+
+    // same layout as TouchPoint, which needs windows.h
+    struct Point {
+        uint32_t id;
+        int32_t x, y;
+        bool mouse;
+        double down_ms = 0.0;
+    };
+
+    void test_basic() {
+        TouchPointTable<Point> table;
+        CHECK(table.find(1) == nullptr);
+        CHECK(table.put({ 7, 10, 20, false }));
+        CHECK(table.put({ 3, 30, 40, true }));
+        CHECK(table.put({ 9, 50, 60, false }));
+        CHECK_EQ(table.size(), (size_t) 3);
+
+        // replacing keeps the landing order
+        CHECK(table.put({ 7, 11, 21, false }));
+        CHECK_EQ(table.size(), (size_t) 3);
+        CHECK(table.update(3, [](Point &point) { point.x = 31; }));
+        CHECK(!table.update(4, [](Point &point) { point.x = 0; }));
+        CHECK_EQ(table.find(3)->x, 31);
+
+        std::vector<Point> points;
+        table.snapshot(points);
+        CHECK_EQ(points.size(), (size_t) 3);
+        if (points.size() == 3) {
+            CHECK(points[0].id == 7 && points[0].x == 11 && points[0].y == 21);
+            CHECK(points[1].id == 3 && points[1].x == 31 && points[1].mouse);
+            CHECK(points[2].id == 9);
+        }
+
+        // a freed slot is reused, but the new point still lands last
+        Point removed {};
+        CHECK(table.remove(7, &removed));
+        CHECK_EQ(removed.x, 11);
+        CHECK(!table.remove(7));
+        CHECK(table.put({ 12, 0, 0, false }));
+        points.clear();
+        table.snapshot(points);
+        CHECK(points.size() == 3 && points[0].id == 3 && points[1].id == 9 && points[2].id == 12);
+
+        // snapshots append
+        table.snapshot(points);
+        CHECK_EQ(points.size(), (size_t) 6);
+    }
+
+    void test_full() {
+        TouchPointTable<Point, 16> table;
+        for (uint32_t id = 0; id < 16; id++) {
+            CHECK(table.put({ id * 1000, (int32_t) id, 0, false }));
+        }
+        CHECK(!table.put({ 99, 0, 0, false }));
+        CHECK(table.put({ 5000, 55, 0, false }));
+        CHECK_EQ(table.find(5000)->x, 55);
+        CHECK(table.remove(3000));
+        CHECK(table.put({ 99, 0, 0, false }));
+        CHECK_EQ(table.size(), (size_t) 16);
+    }
+
+    void test_random() {
+        std::mt19937 rng(3);
+        TouchPointTable<Point> table;
+        std::map<uint32_t, Point> model;
+        std::vector<Point> points;
+
+        // few distinct IDs so probe chains collide and wrap all the time
+        for (int step = 0; step < 200'000; step++) {
+            const uint32_t id = rng() % 96;
+            switch (rng() % 3) {
+                case 0: {
+                    const Point point { id, (int32_t) rng(), (int32_t) rng(), false, (double) step };
+                    const bool fits = model.count(id) || model.size() < table.capacity();
+                    CHECK_EQ(table.put(point), fits);
+                    if (fits) {
+                        model[id] = point;
+                    }
+                    break;
+                }
+                case 1: {
+                    const auto x = (int32_t) rng();
+                    CHECK_EQ(table.update(id, [x](Point &point) { point.x = x; }), model.count(id) > 0);
+                    if (model.count(id)) {
+                        model[id].x = x;
+                    }
+                    break;
+                }
+                default:
+                    CHECK_EQ(table.remove(id), model.erase(id) > 0);
+                    break;
+            }
+
+            if (step % 1000 == 0) {
+                CHECK_EQ(table.size(), model.size());
+                for (uint32_t check = 0; check < 96; check++) {
+                    auto point = table.find(check);
+                    auto it = model.find(check);
+                    CHECK_EQ(point != nullptr, it != model.end());
+                    if (point && it != model.end()) {
+                        CHECK(point->x == it->second.x && point->y == it->second.y);
+                    }
+                }
+                points.clear();
+                table.snapshot(points);
+                CHECK_EQ(points.size(), model.size());
+            }
+        }
+    }
+
+    // every point the writer publishes has y == ~x and down_ms == x, a torn copy breaks that
+    void test_concurrent_table() {
+        TouchPointTable<Point> table;
+        std::atomic<bool> stop {false};
+        std::atomic<size_t> torn {0};
+        std::atomic<size_t> snapshots {0};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 2; i++) {
+            readers.emplace_back([&] {
+                std::vector<Point> points;
+                while (!stop.load()) {
+                    points.clear();
+                    table.snapshot(points);
+                    for (size_t n = 0; n < points.size(); n++) {
+                        auto &point = points[n];
+                        if (point.y != ~point.x || point.down_ms != (double) point.x) {
+                            torn++;
+                        }
+                        for (size_t other = 0; other < n; other++) {
+                            if (points[other].id == point.id) {
+                                torn++;
+                            }
+                        }
+                    }
+                    snapshots++;
+                }
+            });
+        }
+
+        std::mt19937 rng(4);
+        for (int32_t step = 0; step < 300'000; step++) {
+            const uint32_t id = rng() % 10;
+            if (rng() % 8 == 0) {
+                table.remove(id);
+            } else {
+                table.put({ id, step, ~step, false, (double) step });
+            }
+        }
+        stop = true;
+        for (auto &thread : readers) {
+            thread.join();
+        }
+        CHECK_EQ(torn.load(), (size_t) 0);
+        CHECK(snapshots.load() > 0);
+    }
+
+    void test_ring() {
+        spsc_ring<int, 8> ring;
+        int value = 0;
+        CHECK(ring.empty());
+        CHECK(!ring.pop(value));
+
+        // wrap around a few times
+        for (int round = 0; round < 5; round++) {
+            for (int i = 0; i < 8; i++) {
+                CHECK(ring.push(round * 10 + i));
+            }
+            CHECK(ring.full());
+            CHECK(!ring.push(-1));
+            for (int i = 0; i < 5; i++) {
+                CHECK(ring.pop(value) && value == round * 10 + i);
+            }
+            CHECK_EQ(ring.size(), (size_t) 3);
+            ring.clear();
+            CHECK(ring.empty());
+        }
+    }
+
+    void test_concurrent_ring() {
+        spsc_ring<uint64_t, 64> ring;
+        constexpr uint64_t count = 1'000'000;
+        std::thread producer([&] {
+            for (uint64_t i = 0; i < count;) {
+                if (ring.push(i)) {
+                    i++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        uint64_t expected = 0;
+        size_t out_of_order = 0;
+        while (expected < count) {
+            uint64_t value;
+            if (ring.pop(value)) {
+                if (value != expected) {
+                    out_of_order++;
+                }
+                expected = value + 1;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        CHECK_EQ(out_of_order, (size_t) 0);
+        CHECK(ring.empty());
+    }
+}
+
+int main() {
+    test_basic();
+    test_full();
+    test_random();
+    test_concurrent_table();
+    test_ring();
+    test_concurrent_ring();
+    return test::result();
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+/*
+ * a blocking WebSocket client over BSD sockets, for the api/websocket_server test and benchmark
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "api/websocket_deflate.h"
+#include "api/websocket_protocol.h"
+
+namespace test::ws {
+
+    using api::ws::Opcode;
+
+    inline int connect_loopback(uint16_t port) {
+        const int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        return fd;
+    }
+
+    // a masked client frame
+    inline std::vector<uint8_t> frame(Opcode opcode, const uint8_t *payload, size_t size,
+            bool fin = true, bool compressed = false) {
+        std::vector<uint8_t> out;
+        out.push_back((fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (uint8_t) opcode);
+        if (size < 126) {
+            out.push_back((uint8_t) (0x80 | size));
+        } else if (size < 65536) {
+            out.push_back(0x80 | 126);
+            out.push_back((uint8_t) (size >> 8));
+            out.push_back((uint8_t) size);
+        } else {
+            out.push_back(0x80 | 127);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                out.push_back((uint8_t) ((uint64_t) size >> shift));
+            }
+        }
+        const uint8_t mask[4] { 0x12, 0x34, 0x56, 0x78 };
+        out.insert(out.end(), mask, mask + 4);
+        const auto start = out.size();
+        out.insert(out.end(), payload, payload + size);
+        for (size_t i = 0; i < size; i++) {
+            out[start + i] ^= mask[i & 3];
+        }
+        return out;
+    }
+
+    class Client {
+    public:
+        int fd = -1;
+        bool deflate = false;
+
+        ~Client() {
+            this->close();
+        }
+
+        // `bytewise` sends the handshake a byte at a time
+        bool connect(uint16_t port, bool offer_deflate = false, bool bytewise = false) {
+            this->fd = connect_loopback(port);
+            if (this->fd < 0) {
+                return false;
+            }
+            std::string request = "GET /x HTTP/1.1\r\nHost: h\r\nUpgrade: WebSocket\r\n"
+                    "Connection: keep-alive, Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                    "Sec-WebSocket-Version: 13\r\n";
+            if (offer_deflate) {
+                request += "Sec-WebSocket-Extensions: x-webkit-foo, permessage-deflate; client_max_window_bits\r\n";
+            }
+            request += "\r\n";
+            if (bytewise) {
+                for (char c : request) {
+                    ::send(this->fd, &c, 1, 0);
+                    usleep(50);
+                }
+            } else {
+                this->send_raw(request.data(), request.size());
+            }
+
+            std::string response;
+            char c;
+            while (response.find("\r\n\r\n") == std::string::npos) {
+                if (recv(this->fd, &c, 1, 0) != 1) {
+                    return false;
+                }
+                response += c;
+            }
+            this->deflate = response.find("permessage-deflate") != std::string::npos;
+            return response.find(" 101 ") != std::string::npos
+                    && response.find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos;
+        }
+
+        void close() {
+            if (this->fd >= 0) {
+                ::close(this->fd);
+                this->fd = -1;
+            }
+        }
+
+        void send_raw(const void *data, size_t size) {
+            ::send(this->fd, data, size, MSG_NOSIGNAL);
+        }
+
+        void send(Opcode opcode, const std::vector<uint8_t> &payload) {
+            const auto out = frame(opcode, payload.data(), payload.size());
+            this->send_raw(out.data(), out.size());
+        }
+
+        // the next message, inflated if need be. false when the connection ended
+        bool read(Opcode &opcode, std::vector<uint8_t> &payload) {
+            while (true) {
+                const auto available = this->buffer.size() - this->offset;
+                if (available >= 2) {
+                    const auto data = &this->buffer[this->offset];
+                    size_t header = 2;
+                    uint64_t size = data[1] & 0x7F;
+                    if (size == 126) {
+                        header = 4;
+                    } else if (size == 127) {
+                        header = 10;
+                    }
+                    if (available >= header) {
+                        if (size == 126) {
+                            size = data[2] << 8 | data[3];
+                        } else if (size == 127) {
+                            size = 0;
+                            for (int i = 0; i < 8; i++) {
+                                size = size << 8 | data[2 + i];
+                            }
+                        }
+                        if (available >= header + size) {
+                            opcode = (Opcode) (data[0] & 0x0F);
+                            const bool compressed = data[0] & 0x40;
+                            payload.assign(data + header, data + header + size);
+                            this->offset += header + size;
+                            if (this->offset > 65536) {
+                                this->buffer.erase(this->buffer.begin(), this->buffer.begin() + this->offset);
+                                this->offset = 0;
+                            }
+                            if (compressed) {
+                                std::vector<uint8_t> inflated;
+                                if (!api::ws::inflate_message(payload.data(), payload.size(), 1 << 26, inflated)) {
+                                    return false;
+                                }
+                                payload.swap(inflated);
+                            }
+                            return true;
+                        }
+                    }
+                }
+                uint8_t chunk[65536];
+                const auto received = recv(this->fd, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    return false;
+                }
+                this->buffer.insert(this->buffer.end(), chunk, chunk + received);
+            }
+        }
+
+        // bytes received so far, including what was already read
+        size_t received() const {
+            return this->buffer.size();
+        }
+
+    private:
+        std::vector<uint8_t> buffer;
+        size_t offset = 0;
+    };
+}
@@ -0,0 +1,274 @@
+/*
+ * api/websocket_server: loopback echo throughput and round trip latency for a few client
+ * counts and pipelining depths, against a thread per client server sending each frame with
+ * its own send() like headsocket did, plus broadcast fan-out.
+ *
+ * usage: bench_websocket_server [seconds per run, default 2]
+ *
+ * before: every request went through a worker, one client with one request in flight paid
+ *         for the hop there and back (72k msgs/s against 114k for the old server)
+ * after:  a lone request of a lone client is answered on the I/O thread
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#include "api/websocket_server.h"
+#include "websocket_client.h"
+#include "test.h"
+
+using namespace api::ws;
+using test::ws::Client;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+    struct Echo : ServerHandler {
+        Server *server = nullptr;
+
+        void on_open(ClientId, const std::string &) override {
+        }
+
+        void on_message(ClientId client, Opcode opcode, std::vector<uint8_t> &message) override {
+            this->server->send(client, opcode, std::move(message));
+        }
+
+        void on_close(ClientId, const std::string &) override {
+        }
+    };
+
+    // thread per client with blocking sockets, handling on the reading thread
+    class ThreadServer {
+    public:
+        uint16_t port = 0;
+
+        ThreadServer() {
+            this->listener = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            setsockopt(this->listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            bind(this->listener, (sockaddr *) &address, sizeof(address));
+            listen(this->listener, 128);
+            socklen_t size = sizeof(address);
+            getsockname(this->listener, (sockaddr *) &address, &size);
+            this->port = ntohs(address.sin_port);
+            this->acceptor = std::thread([this] { this->accept_run(); });
+        }
+
+        ~ThreadServer() {
+            shutdown(this->listener, SHUT_RDWR);
+            ::close(this->listener);
+            this->acceptor.join();
+            for (auto &thread : this->threads) {
+                thread.join();
+            }
+        }
+
+    private:
+        int listener;
+        std::thread acceptor;
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+
+        struct Handler : FrameParser::Handler {
+            int fd;
+
+            void on_message(Opcode opcode, std::vector<uint8_t> &payload, bool) override {
+                std::vector<uint8_t> out(10);
+                out.resize(write_frame_header(out.data(), opcode, payload.size()));
+                out.insert(out.end(), payload.begin(), payload.end());
+                ::send(this->fd, out.data(), out.size(), MSG_NOSIGNAL);
+            }
+
+            void on_control(Opcode, const uint8_t *, size_t) override {
+            }
+        };
+
+        void accept_run() {
+            while (true) {
+                const int fd = accept(this->listener, nullptr, nullptr);
+                if (fd < 0) {
+                    return;
+                }
+                int no_delay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->threads.emplace_back([fd] { client_run(fd); });
+            }
+        }
+
+        static void client_run(int fd) {
+
+            // byte by byte handshake, like headsocket
+            std::string head;
+            char c;
+            while (head.find("\r\n\r\n") == std::string::npos) {
+                if (recv(fd, &c, 1, 0) != 1) {
+                    ::close(fd);
+                    return;
+                }
+                head += c;
+            }
+            HandshakeParser handshake;
+            size_t consumed;
+            handshake.push(head.data(), head.size(), consumed);
+            const auto response = handshake.response(false);
+            ::send(fd, response.data(), response.size(), 0);
+
+            FrameParser frames(1 << 22);
+            Handler handler;
+            handler.fd = fd;
+            uint8_t buffer[65536];
+            while (true) {
+                const auto received = recv(fd, buffer, sizeof(buffer), 0);
+                if (received <= 0 || !frames.push(buffer, received, handler)) {
+                    break;
+                }
+            }
+            ::close(fd);
+        }
+    };
+
+    // every client keeps `depth` messages in flight, each answer is replaced by a new request
+    void throughput(const char *name, uint16_t port, int clients, int depth, size_t size, double seconds) {
+        std::atomic<uint64_t> total {0};
+        std::vector<std::vector<double>> latencies(clients);
+        std::vector<std::thread> threads;
+        const auto end = clock_type::now() + std::chrono::duration<double>(seconds);
+        for (int c = 0; c < clients; c++) {
+            threads.emplace_back([&, c] {
+                Client client;
+                if (!client.connect(port)) {
+                    fprintf(stderr, "could not connect\n");
+                    return;
+                }
+                std::vector<uint8_t> payload(size, 'a');
+                const auto stamp = [&] {
+                    const auto now = clock_type::now().time_since_epoch().count();
+                    memcpy(payload.data(), &now, sizeof(now));
+                };
+
+                std::vector<uint8_t> burst;
+                for (int i = 0; i < depth; i++) {
+                    stamp();
+                    const auto wire = test::ws::frame(Opcode::Binary, payload.data(), payload.size());
+                    burst.insert(burst.end(), wire.begin(), wire.end());
+                }
+                client.send_raw(burst.data(), burst.size());
+
+                auto &latency = latencies[c];
+                latency.reserve(1 << 20);
+                Opcode opcode;
+                std::vector<uint8_t> message;
+                uint64_t count = 0;
+                while (clock_type::now() < end && client.read(opcode, message)) {
+                    int64_t sent;
+                    memcpy(&sent, message.data(), sizeof(sent));
+                    latency.push_back((clock_type::now().time_since_epoch().count() - sent) / 1000.0);
+                    count++;
+                    stamp();
+                    client.send(Opcode::Binary, payload);
+                }
+                total += count;
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        std::vector<double> all;
+        for (auto &latency : latencies) {
+            all.insert(all.end(), latency.begin(), latency.end());
+        }
+        std::sort(all.begin(), all.end());
+        const auto percentile = [&](size_t p) {
+            return all.empty() ? 0.0 : all[all.size() * p / 100];
+        };
+        printf("%-7s clients %2d  depth %2d  size %5zu  %9.0f msgs/s  p50 %7.1f us  p99 %7.1f us\n",
+                name, clients, depth, size, total / seconds, percentile(50), percentile(99));
+    }
+
+    void fan_out(Server &server) {
+        constexpr int clients = 32;
+        constexpr int messages = 5000;
+        std::string json;
+        for (int i = 0; i < 60; i++) {
+            json += "{\"name\":\"light " + std::to_string(i) + "\",\"value\":0.25},";
+        }
+
+        std::vector<std::thread> threads;
+        std::atomic<int> complete {0};
+        std::atomic<int> connected {0};
+        for (int i = 0; i < clients; i++) {
+            threads.emplace_back([&, i] {
+                Client client;
+                client.connect(server.port(), i % 2 == 0);
+                connected++;
+                Opcode opcode;
+                std::vector<uint8_t> payload;
+                int count = 0;
+                while (count < messages && client.read(opcode, payload)) {
+                    count++;
+                }
+                if (count == messages && payload.size() == json.size()) {
+                    complete++;
+                }
+            });
+        }
+        while (connected < clients) {
+            usleep(1000);
+        }
+        usleep(20000);
+
+        const auto before = server.stats();
+        const auto start = clock_type::now();
+        for (int i = 0; i < messages; i++) {
+            server.broadcast(Opcode::Text, std::vector<uint8_t>(json.begin(), json.end()));
+            if (i % 64 == 0) {
+                usleep(200);
+            }
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        const auto seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        const auto after = server.stats();
+        printf("broadcast %zu B to %d clients, half with deflate: %d/%d complete, %.0f deliveries/s, "
+                "%.1f frames per send\n", json.size(), clients, complete.load(), clients,
+                clients * messages / seconds,
+                (double) (after.messages_out - before.messages_out) / (after.send_calls - before.send_calls));
+    }
+}
+
+int main(int argc, char **argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+
+    Echo echo;
+    ServerConfig config;
+    config.worker_count = 4;
+    Server server(config, echo);
+    echo.server = &server;
+    if (!server.start()) {
+        fprintf(stderr, "could not start the server\n");
+        return 1;
+    }
+    ThreadServer threaded;
+
+    const std::tuple<int, int, size_t> runs[] = {
+        { 1, 1, 64 }, { 1, 8, 64 }, { 16, 1, 256 }, { 16, 16, 256 }, { 64, 8, 256 }, { 8, 8, 16384 },
+    };
+    for (auto [clients, depth, size] : runs) {
+        throughput("thread", threaded.port, clients, depth, size, seconds);
+        throughput("engine", server.port(), clients, depth, size, seconds);
+    }
+    fan_out(server);
+
+    server.stop();
+    return 0;
+}
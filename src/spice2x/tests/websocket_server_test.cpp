@@ -0,0 +1,286 @@
+/*
+ * api/websocket_server: handshakes (byte by byte, rejected, with frames right behind them,
+ * never finished), fragmented messages with a ping in between, close, protocol errors, deflate
+ * both ways, answers to pipelined requests keeping their order whether served on the I/O thread
+ * or a worker, a slow request not holding up other clients, and a client that never reads
+ * getting dropped while the others still get everything.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "api/websocket_server.h"
+#include "websocket_client.h"
+#include "test.h"
+
+using namespace api::ws;
+using test::ws::Client;
+
+namespace {
+
+    // echoes everything, messages starting with "slow" take 300 ms
+    struct Echo : ServerHandler {
+        Server *server = nullptr;
+        std::atomic<int> opens {0};
+        std::atomic<int> closes {0};
+
+        void on_open(ClientId, const std::string &) override {
+            this->opens++;
+        }
+
+        void on_message(ClientId client, Opcode opcode, std::vector<uint8_t> &message) override {
+            if (message.size() >= 4 && memcmp(message.data(), "slow", 4) == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            }
+            this->server->send(client, opcode, std::move(message));
+        }
+
+        void on_close(ClientId, const std::string &) override {
+            this->closes++;
+        }
+    };
+
+    std::vector<uint8_t> bytes(const std::string &text) {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    void test_frames(uint16_t port) {
+        Client client;
+        CHECK(client.connect(port, false, true));
+
+        // a fragmented message with a ping in the middle, trickling in a few bytes at a time
+        std::vector<uint8_t> message(70000);
+        for (size_t i = 0; i < message.size(); i++) {
+            message[i] = (uint8_t) (i * 7);
+        }
+        auto wire = test::ws::frame(Opcode::Binary, message.data(), 30000, false);
+        const auto ping = test::ws::frame(Opcode::Ping, (const uint8_t *) "hi", 2);
+        const auto rest = test::ws::frame(Opcode::Continuation, message.data() + 30000, 40000);
+        wire.insert(wire.end(), ping.begin(), ping.end());
+        wire.insert(wire.end(), rest.begin(), rest.end());
+        for (size_t i = 0; i < wire.size();) {
+            const auto size = std::min<size_t>(1 + i % 13, wire.size() - i);
+            client.send_raw(wire.data() + i, size);
+            i += size;
+            if (i < 200) {
+                usleep(100);
+            }
+        }
+        Opcode opcode;
+        std::vector<uint8_t> payload;
+        CHECK(client.read(opcode, payload) && opcode == Opcode::Pong && payload == bytes("hi"));
+        CHECK(client.read(opcode, payload) && opcode == Opcode::Binary && payload == message);
+
+        // close is answered with the same code, then the server hangs up
+        const auto close = test::ws::frame(Opcode::Close, (const uint8_t *) "\x03\xe8", 2);
+        client.send_raw(close.data(), close.size());
+        CHECK(client.read(opcode, payload) && opcode == Opcode::Close && payload == bytes("\x03\xe8"));
+        uint8_t byte;
+        CHECK(recv(client.fd, &byte, 1, 0) == 0);
+    }
+
+    void test_errors(uint16_t port) {
+
+        // not a WebSocket handshake
+        const int fd = test::ws::connect_loopback(port);
+        const char request[] = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+        ::send(fd, request, sizeof(request) - 1, 0);
+        char response[256] {};
+        recv(fd, response, sizeof(response) - 1, 0);
+        CHECK(strstr(response, " 400 ") != nullptr);
+        ::close(fd);
+
+        // clients have to mask their frames
+        Client client;
+        CHECK(client.connect(port));
+        const uint8_t unmasked[] = { 0x82, 0x01, 'x' };
+        client.send_raw(unmasked, sizeof(unmasked));
+        Opcode opcode;
+        std::vector<uint8_t> payload;
+        CHECK(client.read(opcode, payload) && opcode == Opcode::Close);
+        CHECK(payload.size() == 2 && (payload[0] << 8 | payload[1]) == CLOSE_PROTOCOL_ERROR);
+    }
+
+    void test_deflate(uint16_t port) {
+        Client client;
+        CHECK(client.connect(port, true));
+        CHECK(client.deflate);
+        std::string json;
+        for (int i = 0; i < 200; i++) {
+            json += "{\"state\":0.5,\"name\":\"button " + std::to_string(i % 10) + "\"},";
+        }
+        std::vector<uint8_t> compressed;
+        deflate_message((const uint8_t *) json.data(), json.size(), 15, compressed);
+        const auto wire = test::ws::frame(Opcode::Text, compressed.data(), compressed.size(), true, true);
+        client.send_raw(wire.data(), wire.size());
+        Opcode opcode;
+        std::vector<uint8_t> payload;
+        CHECK(client.read(opcode, payload) && payload == bytes(json));
+        CHECK(client.received() < json.size() / 4);
+    }
+
+    // frames in the same packet as the handshake, and a client that never finishes it
+    void test_handshake_edges() {
+        Echo echo;
+        ServerConfig config;
+        config.handshake_timeout_ms = 300;
+        Server server(config, echo);
+        echo.server = &server;
+        CHECK(server.start());
+
+        const int fd = test::ws::connect_loopback(server.port());
+        std::string request = "GET / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        const auto early = test::ws::frame(Opcode::Binary, (const uint8_t *) "abc", 3);
+        request.append((const char *) early.data(), early.size());
+        ::send(fd, request.data(), request.size(), 0);
+        std::string response;
+        char chunk[512];
+        while (response.size() < 5 || response.compare(response.size() - 5, 5, "\x82\x03" "abc") != 0) {
+            const auto received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                break;
+            }
+            response.append(chunk, received);
+        }
+        CHECK(response.find("\r\n\r\n\x82\x03" "abc") != std::string::npos);
+
+        const int silent = test::ws::connect_loopback(server.port());
+        timeval timeout { 3, 0 };
+        setsockopt(silent, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        CHECK(recv(silent, chunk, 1, 0) == 0);
+        ::close(silent);
+        ::close(fd);
+        server.stop();
+        CHECK_EQ(echo.opens.load(), echo.closes.load());
+    }
+
+    // one client alone gets its requests served on the I/O thread, order has to hold all the same
+    void test_pipelined(uint16_t port, int clients) {
+        std::vector<std::thread> threads;
+        std::atomic<int> in_order {0};
+        for (int c = 0; c < clients; c++) {
+            threads.emplace_back([&] {
+                Client client;
+                if (!client.connect(port)) {
+                    return;
+                }
+                constexpr uint32_t count = 2000;
+                std::vector<uint8_t> burst;
+                for (uint32_t i = 0; i < count; i++) {
+                    const auto wire = test::ws::frame(Opcode::Binary, (const uint8_t *) &i, sizeof(i));
+                    burst.insert(burst.end(), wire.begin(), wire.end());
+
+                    // a mix of lone requests and bursts
+                    if (i % 50 < 10 || i % 50 == 49) {
+                        client.send_raw(burst.data(), burst.size());
+                        burst.clear();
+                    }
+                }
+                client.send_raw(burst.data(), burst.size());
+                Opcode opcode;
+                std::vector<uint8_t> payload;
+                uint32_t i = 0;
+                for (; i < count && client.read(opcode, payload); i++) {
+                    uint32_t value;
+                    memcpy(&value, payload.data(), sizeof(value));
+                    if (value != i) {
+                        break;
+                    }
+                }
+                if (i == count) {
+                    in_order++;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        CHECK_EQ(in_order.load(), clients);
+    }
+
+    void test_slow_request(uint16_t port) {
+        Client slow, fast;
+        CHECK(slow.connect(port));
+        CHECK(fast.connect(port));
+        usleep(20000);
+
+        slow.send(Opcode::Text, bytes("slow"));
+        usleep(20000);
+        const auto start = std::chrono::steady_clock::now();
+        fast.send(Opcode::Text, bytes("fast"));
+        Opcode opcode;
+        std::vector<uint8_t> payload;
+        CHECK(fast.read(opcode, payload) && payload == bytes("fast"));
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200));
+        CHECK(slow.read(opcode, payload) && payload == bytes("slow"));
+    }
+
+    void test_slow_reader() {
+        Echo echo;
+        ServerConfig config;
+        config.backpressure_bytes = 256 * 1024;
+        config.drop_bytes = 2 * 1024 * 1024;
+        Server server(config, echo);
+        echo.server = &server;
+        CHECK(server.start());
+
+        Client stuck, reader;
+        CHECK(stuck.connect(server.port()));
+        CHECK(reader.connect(server.port()));
+        usleep(20000);
+
+        constexpr int count = 400;
+        std::atomic<int> received {0};
+        std::thread thread([&] {
+            Opcode opcode;
+            std::vector<uint8_t> payload;
+            while (received < count && reader.read(opcode, payload)) {
+                received++;
+            }
+        });
+        std::vector<uint8_t> big(64 * 1024);
+        for (size_t i = 0; i < big.size(); i++) {
+            big[i] = (uint8_t) (i * 31 + i / 7);
+        }
+        for (int i = 0; i < count; i++) {
+            server.broadcast(Opcode::Binary, big);
+            if (i % 16 == 0) {
+                usleep(1000);
+            }
+        }
+        thread.join();
+        CHECK_EQ(received.load(), count);
+        CHECK_EQ(server.stats().clients_dropped, (uint64_t) 1);
+        server.stop();
+    }
+}
+
+int main() {
+    Echo echo;
+    ServerConfig config;
+    config.worker_count = 4;
+    Server server(config, echo);
+    echo.server = &server;
+    if (!server.start()) {
+        fprintf(stderr, "could not start the server\n");
+        return 1;
+    }
+
+    test_frames(server.port());
+    test_errors(server.port());
+    test_deflate(server.port());
+    test_pipelined(server.port(), 1);
+    test_pipelined(server.port(), 8);
+    test_slow_request(server.port());
+    usleep(100000);
+    server.stop();
+    CHECK(echo.opens.load() > 0);
+    CHECK_EQ(echo.opens.load(), echo.closes.load());
+
+    test_handshake_edges();
+    test_slow_reader();
+    return test::result();
+}
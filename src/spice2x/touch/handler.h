@@ -5,11 +5,6 @@
 
 #include "touch.h"
 
-// touch states
-extern std::mutex TOUCH_POINTS_M;
-extern std::mutex TOUCH_EVENTS_M;
-extern std::vector<TouchPoint> TOUCH_POINTS;
-
 enum msg_handler_action {
     /*
      * The message was unhandled by the touch handler. This is the default value set when
@@ -55,6 +50,12 @@ public:
     virtual void handle_message(msg_handler_result &result, HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) = 0;
 };
 
-void add_touch_event(TouchEvent *te);
+/*
+ * Touch point changes, each one also queues the matching event. Safe to call from any thread,
+ * writers only ever wait on other writers.
+ */
+void touch_point_down(const TouchPoint &tp);
+void touch_point_move(DWORD id, LONG x, LONG y);
+void touch_point_up(DWORD id);
 
 void update_card_button();
@@ -16,16 +16,17 @@
 #include "misc/eamuse.h"
 #include "overlay/overlay.h"
 #include "rawinput/touch.h"
-#include "util/circular_buffer.h"
 #include "util/detour.h"
 #include "util/libutils.h"
 #include "util/logging.h"
+#include "util/spsc_ring.h"
 #include "util/time.h"
 #include "util/utils.h"
 
 #include "gdi_overlay.h"
 #include "handler.h"
 #include "touch_gestures.h"
+#include "touch_table.h"
 #include "win7.h"
 #include "win8.h"
 
@@ -59,10 +60,12 @@ int SPICETOUCH_TOUCH_WIDTH = 0;
 int SPICETOUCH_TOUCH_HEIGHT = 0;
 
 // touch states
-std::vector<TouchPoint> TOUCH_POINTS;
-std::mutex TOUCH_POINTS_M;
-static circular_buffer<TouchEvent> TOUCH_EVENTS(TOUCH_EVENT_BUFFER_SIZE);
-std::mutex TOUCH_EVENTS_M;
+// writers (window procs, API, raw input) serialize on TOUCH_WRITE_M, readers on TOUCH_READ_M,
+// neither ever waits on the other
+static TouchPointTable<TouchPoint> TOUCH_POINTS;
+static spsc_ring<TouchEvent, TOUCH_EVENT_BUFFER_SIZE> TOUCH_EVENTS;
+static std::mutex TOUCH_WRITE_M;
+static std::mutex TOUCH_READ_M;
 
 // general states
 static bool SPICETOUCH_INITIALIZED = false;
@@ -101,9 +104,9 @@ public:
 
 /*
  * Add touch event but take care of buffer size
- * Be careful, this doesn't lock the mutex on it's own
+ * Be careful, this doesn't lock the writer mutex on it's own
  */
-void add_touch_event(TouchEvent *te) {
+static void add_touch_event(TouchEvent *te) {
 
     // check if first threshold is passed
     if (TOUCH_EVENTS.size() > TOUCH_EVENT_BUFFER_THRESHOLD1) {
@@ -117,7 +120,7 @@ void add_touch_event(TouchEvent *te) {
 
                 // add move event if we're not over the second threshold
                 if (TOUCH_EVENTS.size() <= TOUCH_EVENT_BUFFER_THRESHOLD2) {
-                    TOUCH_EVENTS.put(*te);
+                    TOUCH_EVENTS.push(*te);
                 }
 
                 return;
@@ -132,7 +135,7 @@ void add_touch_event(TouchEvent *te) {
                 }
 
                 // when the buffer isn't full yet, add the touch up event
-                TOUCH_EVENTS.put(*te);
+                TOUCH_EVENTS.push(*te);
                 return;
 
             default:
@@ -141,7 +144,84 @@ void add_touch_event(TouchEvent *te) {
     }
 
     // add the touch up event
-    TOUCH_EVENTS.put(*te);
+    TOUCH_EVENTS.push(*te);
+}
+
+static void touch_point_down_locked(TouchPoint tp) {
+
+    // add touch point, replacing a stale one with the same ID
+    if (!TOUCH_POINTS.put(tp)) {
+        return;
+    }
+
+    // add touch down event
+    TouchEvent te {
+        .id = tp.id,
+        .x = tp.x,
+        .y = tp.y,
+        .type = TOUCH_DOWN,
+        .mouse = tp.mouse,
+    };
+    add_touch_event(&te);
+}
+
+static bool touch_point_move_locked(DWORD id, LONG x, LONG y, bool mouse) {
+
+    // update touch point position
+    if (!TOUCH_POINTS.update(id, [x, y](TouchPoint &tp) {
+        tp.x = x;
+        tp.y = y;
+    })) {
+        return false;
+    }
+
+    // add touch move event
+    TouchEvent te {
+        .id = id,
+        .x = x,
+        .y = y,
+        .type = TOUCH_MOVE,
+        .mouse = mouse,
+    };
+    add_touch_event(&te);
+    return true;
+}
+
+static void touch_point_up_locked(DWORD id) {
+
+    // remove touch point
+    TouchPoint tp {};
+    if (!TOUCH_POINTS.remove(id, &tp)) {
+        return;
+    }
+
+    // add touch up event
+    TouchEvent te {
+        .id = id,
+        .x = tp.x,
+        .y = tp.y,
+        .type = TOUCH_UP,
+        .mouse = tp.mouse,
+    };
+    add_touch_event(&te);
+}
+
+void touch_point_down(const TouchPoint &tp) {
+    std::lock_guard<std::mutex> lock(TOUCH_WRITE_M);
+    touch_point_down_locked(tp);
+}
+
+void touch_point_move(DWORD id, LONG x, LONG y) {
+    std::lock_guard<std::mutex> lock(TOUCH_WRITE_M);
+    auto tp = TOUCH_POINTS.find(id);
+    if (tp) {
+        touch_point_move_locked(id, x, y, tp->mouse);
+    }
+}
+
+void touch_point_up(DWORD id) {
+    std::lock_guard<std::mutex> lock(TOUCH_WRITE_M);
+    touch_point_up_locked(id);
 }
 
 static void touch_initialize() {
@@ -218,7 +298,9 @@ void update_card_button() {
     }
 
     // check touch points
-    for (TouchPoint touchPoint : TOUCH_POINTS) {
+    std::vector<TouchPoint> touch_points;
+    TOUCH_POINTS.snapshot(touch_points);
+    for (TouchPoint touchPoint : touch_points) {
         POINT pt {};
         pt.x = touchPoint.x;
         pt.y = touchPoint.y;
@@ -230,27 +312,9 @@ void update_card_button() {
 }
 
 static void release_all_mouse_touch_points() {
-    std::lock_guard<std::mutex> lock_points(TOUCH_POINTS_M);
-    std::lock_guard<std::mutex> lock_events(TOUCH_EVENTS_M);
-
-    for (size_t x = 0; x < TOUCH_POINTS.size();) {
-        TouchPoint *tp = &TOUCH_POINTS[x];
-
-        if (tp->id == 0u) {
-            TouchEvent te {
-                .id = tp->id,
-                .x = tp->x,
-                .y = tp->y,
-                .type = TOUCH_UP,
-                .mouse = tp->mouse,
-            };
-            add_touch_event(&te);
-
-            TOUCH_POINTS.erase(TOUCH_POINTS.begin() + x);
-        } else {
-            x++;
-        }
-    }
+
+    // the mouse always uses ID 0
+    touch_point_up(0);
 }
 
 static LRESULT CALLBACK SpiceTouchWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -553,10 +617,6 @@ static LRESULT CALLBACK SpiceTouchWndProc(HWND hWnd, UINT msg, WPARAM wParam, LP
                     // release all old events before inserting a new one
                     release_all_mouse_touch_points();
 
-                    // lock touch points
-                    std::lock_guard<std::mutex> lock_points(TOUCH_POINTS_M);
-                    std::lock_guard<std::mutex> lock_events(TOUCH_EVENTS_M);
-
                     // create touch point
                     TouchPoint tp {
                         .id = 0,
@@ -565,17 +625,7 @@ static LRESULT CALLBACK SpiceTouchWndProc(HWND hWnd, UINT msg, WPARAM wParam, LP
                         .mouse = true,
                         .down_ms = get_performance_milliseconds(),
                     };
-                    TOUCH_POINTS.push_back(tp);
-
-                    // add touch down event
-                    TouchEvent te {
-                        .id = tp.id,
-                        .x = tp.x,
-                        .y = tp.y,
-                        .type = TOUCH_DOWN,
-                        .mouse = tp.mouse,
-                    };
-                    add_touch_event(&te);
+                    touch_point_down(tp);
 
                     // card button
                     update_card_button();
@@ -590,34 +640,8 @@ static LRESULT CALLBACK SpiceTouchWndProc(HWND hWnd, UINT msg, WPARAM wParam, LP
                         return 0;
                     }
 
-                    // lock touch points
-                    std::lock_guard<std::mutex> lock_points(TOUCH_POINTS_M);
-                    std::lock_guard<std::mutex> lock_events(TOUCH_EVENTS_M);
-
-                    // update point
-                    for (auto &x : TOUCH_POINTS) {
-                        TouchPoint *tp = &x;
-
-                        // find ID 0
-                        if (tp->id == 0u) {
-
-                            // update touch point position
-                            tp->x = GET_X_LPARAM(lParam);
-                            tp->y = GET_Y_LPARAM(lParam);
-
-                            // add touch move event
-                            TouchEvent te {
-                                .id = tp->id,
-                                .x = tp->x,
-                                .y = tp->y,
-                                .type = TOUCH_MOVE,
-                                .mouse = tp->mouse,
-                            };
-                            add_touch_event(&te);
-
-                            break;
-                        }
-                    }
+                    // update point with ID 0
+                    touch_point_move(0, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
                 }
 
                 break;
@@ -844,54 +868,17 @@ void touch_write_points(std::vector<TouchPoint> *touch_points) {
     }
 
     // lock
-    std::lock_guard<std::mutex> points(TOUCH_POINTS_M);
-    std::lock_guard<std::mutex> events(TOUCH_EVENTS_M);
+    std::lock_guard<std::mutex> lock(TOUCH_WRITE_M);
 
     // iterate through all the provided touch points
     for (auto &tp : *touch_points) {
 
-        // find touch point to update
-        bool found = false;
-        for (auto &arr_tp : TOUCH_POINTS) {
-            if (arr_tp.id == tp.id) {
-
-                // mark as found
-                found = true;
-
-                // update position
-                arr_tp.x = tp.x;
-                arr_tp.y = tp.y;
-
-                // add touch move event
-                TouchEvent te {
-                    .id = tp.id,
-                    .x = tp.x,
-                    .y = tp.y,
-                    .type = TOUCH_MOVE,
-                    .mouse = tp.mouse,
-                };
-                add_touch_event(&te);
-            }
-        }
-
-        // create new touch point when not found
-        if (!found) {
+        // update touch point, or create a new one when not found
+        if (!touch_point_move_locked(tp.id, tp.x, tp.y, tp.mouse)) {
 
             // stamp the landing time so debounce can measure the contact's age
             tp.down_ms = get_performance_milliseconds();
-
-            // add touch point
-            TOUCH_POINTS.push_back(tp);
-
-            // add touch down event
-            TouchEvent te {
-                .id = tp.id,
-                .x = tp.x,
-                .y = tp.y,
-                .type = TOUCH_DOWN,
-                .mouse = tp.mouse,
-            };
-            add_touch_event(&te);
+            touch_point_down_locked(tp);
         }
     }
 }
@@ -904,32 +891,11 @@ void touch_remove_points(std::vector<DWORD> *touch_point_ids) {
     }
 
     // lock
-    std::lock_guard<std::mutex> points(TOUCH_POINTS_M);
-    std::lock_guard<std::mutex> events(TOUCH_EVENTS_M);
+    std::lock_guard<std::mutex> lock(TOUCH_WRITE_M);
 
-    // find the touch points to remove
+    // remove the touch points
     for (auto id : *touch_point_ids) {
-        for (size_t x = 0; x < TOUCH_POINTS.size(); x++) {
-            TouchPoint *tp = &TOUCH_POINTS[x];
-
-            // check if the IDs match
-            if (tp->id == id) {
-
-                // add touch up event
-                TouchEvent te {
-                    .id = id,
-                    .x = tp->x,
-                    .y = tp->y,
-                    .type = TOUCH_UP,
-                    .mouse = tp->mouse,
-                };
-                add_touch_event(&te);
-
-                // delete touch point
-                TOUCH_POINTS.erase(TOUCH_POINTS.begin() + x);
-                break;
-            }
-        }
+        touch_point_up_locked(id);
     }
 }
 
@@ -950,11 +916,8 @@ void touch_get_points(std::vector<TouchPoint> &touch_points, bool overlay) {
         return;
     }
 
-    // lock
-    std::lock_guard<std::mutex> lock(TOUCH_POINTS_M);
-
-    // append touch points
-    touch_points.insert(touch_points.end(), TOUCH_POINTS.begin(), TOUCH_POINTS.end());
+    // append touch points, lock free
+    TOUCH_POINTS.snapshot(touch_points);
 }
 
 void touch_get_events(std::vector<TouchEvent> &touch_events, bool overlay) {
@@ -964,8 +927,8 @@ void touch_get_events(std::vector<TouchEvent> &touch_events, bool overlay) {
         rawinput::touch::update_timeouts(RI_MGR.get());
     }
 
-    // lock
-    std::lock_guard<std::mutex> lock(TOUCH_EVENTS_M);
+    // lock, only against other readers
+    std::lock_guard<std::mutex> lock(TOUCH_READ_M);
 
     // overlay override
     if (!overlay &&
@@ -974,13 +937,14 @@ void touch_get_events(std::vector<TouchEvent> &touch_events, bool overlay) {
         !overlay::OVERLAY->has_subscreen_touch_transform() &&
         ImGui::GetIO().WantCaptureMouse) {
 
-        TOUCH_EVENTS.reset();
+        TOUCH_EVENTS.clear();
         return;
     }
 
-    // append touch points
-    while (!TOUCH_EVENTS.empty()) {
-        touch_events.push_back(TOUCH_EVENTS.get());
+    // append touch events
+    TouchEvent te;
+    while (TOUCH_EVENTS.pop(te)) {
+        touch_events.push_back(te);
     }
 }
 
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Fixed capacity table of active touch points, keyed by touch ID.
+ *
+ * Every point lives in a slot of its own. Readers copy slots out lock free: each slot is guarded
+ * by a generation counter that is odd while the slot is being written and moves on with every
+ * write, so a reader that raced a writer sees the counter change and simply reads the slot
+ * again. Points are stored as atomic words, which keeps those racing reads well defined.
+ *
+ * All writes go through a single writer at a time, the caller serializes them. The writer keeps
+ * its own plain copy of every point plus a small hash index from touch ID to slot, so looking a
+ * point up or changing it never reads shared state.
+ *
+ * `Point` needs to be trivially copyable and have an `id` member.
+ */
+template<class Point, size_t Capacity = 64>
+class TouchPointTable {
+    static_assert(std::is_trivially_copyable_v<Point>);
+    static_assert(Capacity > 0 && Capacity <= 64 && (Capacity & (Capacity - 1)) == 0,
+            "capacity must be a power of two no larger than 64");
+
+public:
+
+    TouchPointTable() {
+        for (auto &entry : this->index) {
+            entry = INDEX_EMPTY;
+        }
+    }
+
+    /*
+     * Writer side.
+     */
+
+    // the point with the given ID, nullptr when there is none. valid until the next write
+    const Point *find(uint32_t id) const {
+        const auto slot = this->lookup(id);
+        return slot < 0 ? nullptr : &this->shadow[slot];
+    }
+
+    // adds a point, or replaces the one with the same ID. false when the table is full
+    bool put(const Point &point) {
+        auto slot = this->lookup(point.id);
+        if (slot < 0) {
+            if (this->used == FULL_MASK) {
+                return false;
+            }
+            slot = std::countr_one(this->used);
+            this->used |= uint64_t(1) << slot;
+            this->index_insert(point.id, slot);
+            this->order[slot] = ++this->next_order;
+        }
+        this->shadow[slot] = point;
+        this->publish(slot);
+        this->active.store(this->used, std::memory_order_release);
+        return true;
+    }
+
+    // applies `modify` to the point with the given ID; false when there is none
+    template<class F>
+    bool update(uint32_t id, F &&modify) {
+        const auto slot = this->lookup(id);
+        if (slot < 0) {
+            return false;
+        }
+        modify(this->shadow[slot]);
+        this->publish(slot);
+        return true;
+    }
+
+    // removes the point with the given ID, copying it to `removed` first; false when there is none
+    bool remove(uint32_t id, Point *removed = nullptr) {
+        const auto slot = this->lookup(id);
+        if (slot < 0) {
+            return false;
+        }
+        if (removed) {
+            *removed = this->shadow[slot];
+        }
+        this->index_remove(id);
+        this->used &= ~(uint64_t(1) << slot);
+        this->active.store(this->used, std::memory_order_release);
+        this->order[slot] = 0;
+        this->publish(slot);
+        return true;
+    }
+
+    size_t size() const {
+        return std::popcount(this->used);
+    }
+
+    /*
+     * Reader side, callable from any thread at any time.
+     */
+
+    /*
+     * Appends all points to `out`, oldest first. Every point is consistent on its own, but slots
+     * are read one after the other: a point lifted and put down again while this runs can show
+     * up in its old and its new slot, so only the newer copy of an ID is kept.
+     */
+    void snapshot(std::vector<Point> &out) const {
+        auto mask = this->active.load(std::memory_order_acquire);
+        if (!mask) {
+            return;
+        }
+
+        // points stay as the words they were read as and only the indices get sorted, copying
+        // whole points around right after their words were stored stalls on every one of them
+        uint64_t words[Capacity][WORDS];
+        uint64_t orders[Capacity];
+        uint32_t ids[Capacity];
+        uint8_t sorted[Capacity];
+        size_t read = 0;
+        size_t count = 0;
+
+        while (mask) {
+            const auto slot = std::countr_zero(mask);
+            mask &= mask - 1;
+
+            uint64_t point_order;
+            if (!this->read(slot, point_order, words[read]) || point_order == 0) {
+                continue;
+            }
+            decltype(Point::id) id;
+            memcpy(&id, reinterpret_cast<const char *>(words[read]) + offsetof(Point, id), sizeof(id));
+
+            // same ID seen already, keep whichever landed last
+            size_t pos = 0;
+            while (pos < count && ids[pos] != (uint32_t) id) {
+                pos++;
+            }
+            if (pos < count) {
+                if (orders[pos] > point_order) {
+                    continue;
+                }
+                for (; pos + 1 < count; pos++) {
+                    orders[pos] = orders[pos + 1];
+                    ids[pos] = ids[pos + 1];
+                    sorted[pos] = sorted[pos + 1];
+                }
+                count--;
+            }
+
+            // keep them sorted by landing order, there are only ever a few
+            pos = count++;
+            while (pos > 0 && orders[pos - 1] > point_order) {
+                orders[pos] = orders[pos - 1];
+                ids[pos] = ids[pos - 1];
+                sorted[pos] = sorted[pos - 1];
+                pos--;
+            }
+            orders[pos] = point_order;
+            ids[pos] = (uint32_t) id;
+            sorted[pos] = (uint8_t) read++;
+        }
+
+        const auto base = out.size();
+        out.resize(base + count);
+        for (size_t i = 0; i < count; i++) {
+            memcpy(&out[base + i], words[sorted[i]], sizeof(Point));
+        }
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    static constexpr uint64_t FULL_MASK = Capacity == 64 ? ~uint64_t(0) : (uint64_t(1) << Capacity) - 1;
+    static constexpr size_t WORDS = (sizeof(Point) + 7) / 8;
+    static constexpr size_t INDEX_SIZE = Capacity * 2;
+    static constexpr int INDEX_BITS = std::countr_zero(INDEX_SIZE);
+    static constexpr int8_t INDEX_EMPTY = -1;
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> sequence {0};
+        std::atomic<uint64_t> order {0};
+        std::atomic<uint64_t> words[WORDS] {};
+    };
+
+    // shared with readers
+    Slot slots[Capacity];
+    std::atomic<uint64_t> active {0};
+
+    // writer only
+    Point shadow[Capacity] {};
+    uint64_t order[Capacity] {};
+    uint64_t used = 0;
+    uint64_t next_order = 0;
+    int8_t index[INDEX_SIZE];
+
+    static size_t home(uint32_t id) {
+        return (size_t) ((id * 0x9E3779B1u) >> (32 - INDEX_BITS));
+    }
+
+    int lookup(uint32_t id) const {
+        for (size_t pos = home(id);; pos = (pos + 1) & (INDEX_SIZE - 1)) {
+            const auto slot = this->index[pos];
+            if (slot == INDEX_EMPTY) {
+                return -1;
+            }
+            if ((uint32_t) this->shadow[slot].id == id) {
+                return slot;
+            }
+        }
+    }
+
+    void index_insert(uint32_t id, int slot) {
+        auto pos = home(id);
+        while (this->index[pos] != INDEX_EMPTY) {
+            pos = (pos + 1) & (INDEX_SIZE - 1);
+        }
+        this->index[pos] = (int8_t) slot;
+    }
+
+    // linear probing removal, moving later entries of the probe chain back into the hole
+    void index_remove(uint32_t id) {
+        auto pos = home(id);
+        while ((uint32_t) this->shadow[this->index[pos]].id != id) {
+            pos = (pos + 1) & (INDEX_SIZE - 1);
+        }
+        auto hole = pos;
+        for (pos = (hole + 1) & (INDEX_SIZE - 1); this->index[pos] != INDEX_EMPTY; pos = (pos + 1) & (INDEX_SIZE - 1)) {
+            const auto entry_home = home((uint32_t) this->shadow[this->index[pos]].id);
+            if (((pos - entry_home) & (INDEX_SIZE - 1)) >= ((pos - hole) & (INDEX_SIZE - 1))) {
+                this->index[hole] = this->index[pos];
+                hole = pos;
+            }
+        }
+        this->index[hole] = INDEX_EMPTY;
+    }
+
+    void publish(size_t slot) {
+        uint64_t words[WORDS] {};
+        memcpy(words, &this->shadow[slot], sizeof(Point));
+
+        auto &target = this->slots[slot];
+        const auto sequence = target.sequence.load(std::memory_order_relaxed);
+        target.sequence.store(sequence + 1, std::memory_order_relaxed);
+
+        // release keeps the odd sequence ahead of the data for readers
+        target.order.store(this->order[slot], std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            target.words[i].store(words[i], std::memory_order_release);
+        }
+        target.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool read(size_t slot, uint64_t &point_order, uint64_t (&words)[WORDS]) const {
+        const auto &source = this->slots[slot];
+        for (int attempt = 0; attempt < 1000; attempt++) {
+            const auto before = source.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+
+            // acquire keeps the second sequence read behind the data
+            point_order = source.order.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                words[i] = source.words[i].load(std::memory_order_acquire);
+            }
+            if (source.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+
+        // the writer kept this slot busy the whole time, skip it for this read
+        return false;
+    }
+};
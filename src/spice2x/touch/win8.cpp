@@ -200,10 +200,6 @@ void Win8Handler::handle_message(msg_handler_result &result, HWND hWnd, UINT msg
                 break;
             }
 
-            // lock touch points
-            std::lock_guard<std::mutex> lock_points(TOUCH_POINTS_M);
-            std::lock_guard<std::mutex> lock_events(TOUCH_EVENTS_M);
-
             // iterate all inputs
             static long prev_x, prev_y;
             for (size_t i = 0; i < entries_count * pointer_count; i++) {
@@ -223,17 +219,7 @@ void Win8Handler::handle_message(msg_handler_result &result, HWND hWnd, UINT msg
                         .mouse = false,
                         .down_ms = get_performance_milliseconds(),
                     };
-                    TOUCH_POINTS.push_back(tp);
-
-                    // add touch down event
-                    TouchEvent te {
-                        .id = tp.id,
-                        .x = tp.x,
-                        .y = tp.y,
-                        .type = TOUCH_DOWN,
-                        .mouse = tp.mouse,
-                    };
-                    add_touch_event(&te);
+                    touch_point_down(tp);
 
                     // set prev coordinates
                     prev_x = point.x;
@@ -251,26 +237,7 @@ void Win8Handler::handle_message(msg_handler_result &result, HWND hWnd, UINT msg
                     if (point.x != prev_x || point.y != prev_y) {
 
                         // update point
-                        for (auto &tp : TOUCH_POINTS) {
-                            if (tp.id == pi.pointerId) {
-
-                                // update values
-                                tp.x = point.x;
-                                tp.y = point.y;
-
-                                // add touch move event
-                                TouchEvent te {
-                                    .id = tp.id,
-                                    .x = tp.x,
-                                    .y = tp.y,
-                                    .type = TOUCH_MOVE,
-                                    .mouse = tp.mouse,
-                                };
-                                add_touch_event(&te);
-
-                                break;
-                            }
-                        }
+                        touch_point_move(pi.pointerId, point.x, point.y);
                     }
 
                     // set prev coordinates
@@ -282,27 +249,7 @@ void Win8Handler::handle_message(msg_handler_result &result, HWND hWnd, UINT msg
                 if ((pi.pointerFlags & POINTER_FLAG_UP) != 0) {
 
                     // remove point
-                    for (size_t x = 0; x < TOUCH_POINTS.size(); x++) {
-                        auto &tp = TOUCH_POINTS[x];
-
-                        if (tp.id == pi.pointerId) {
-
-                            // add touch up event
-                            TouchEvent te {
-                                .id = pi.pointerId,
-                                .x = tp.x,
-                                .y = tp.y,
-                                .type = TOUCH_UP,
-                                .mouse = tp.mouse,
-                            };
-                            add_touch_event(&te);
-
-                            // remove from active touch points
-                            TOUCH_POINTS.erase(TOUCH_POINTS.begin() + x);
-
-                            break;
-                        }
-                    }
+                    touch_point_up(pi.pointerId);
                 }
             }
 
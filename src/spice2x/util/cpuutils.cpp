@@ -164,6 +164,27 @@ namespace cpuutils {
         log_misc("cpuinfo", "  AVX2   : {}", cpu.features.avx2 ? "supported" : "NOT supported");
     }
 
+    static const X86Features &get_features() {
+        static const X86Info info = GetX86Info();
+        return info.features;
+    }
+
+    bool has_sse2() {
+        return get_features().sse2;
+    }
+
+    bool has_ssse3() {
+        return get_features().ssse3;
+    }
+
+    bool has_sse4_1() {
+        return get_features().sse4_1;
+    }
+
+    bool has_avx2() {
+        return get_features().avx2;
+    }
+
     std::vector<float> get_load() {
 
         // lazy init
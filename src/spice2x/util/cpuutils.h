@@ -12,6 +12,10 @@ namespace cpuutils {
 
     std::vector<float> get_load();
     void print_cpu_features();
+    bool has_sse2();
+    bool has_ssse3();
+    bool has_sse4_1();
+    bool has_avx2();
     void set_processor_priority(std::string priority);
     void set_processor_affinity(uint64_t affinity, bool is_user_override);
     void set_processor_affinity(CpuEfficiencyClass eff_class);
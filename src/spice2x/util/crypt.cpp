@@ -46,25 +46,4 @@ namespace crypt {
     void random_bytes(void *data, size_t length) {
         CryptGenRandom(PROVIDER, (DWORD) length, (BYTE*) data);
     }
-
-    std::string base64_encode(const uint8_t *ptr, size_t length) {
-        static const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        static size_t mod[] = {0, 2, 1 };
-        std::string result(4 * ((length + 2) / 3), '=');
-        if (ptr && length) {
-            for (size_t i = 0, j = 0, triplet = 0; i < length; triplet = 0) {
-                for (size_t k = 0; k < 3; ++k) {
-                    triplet = (triplet << 8) | (i < length ? ptr[i++] : 0);
-                }
-                for (size_t k = 4; k--;) {
-                    result[j++] = table[(triplet >> k * 6) & 0x3F];
-                }
-            }
-            for (size_t i = 0; i < mod[length % 3]; i++) {
-                result[result.length() - 1 - i] = '=';
-            }
-        }
-        return result;
-    }
-
 }
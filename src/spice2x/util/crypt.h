@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace crypt {
     extern bool INITIALIZED;
@@ -10,5 +11,14 @@ namespace crypt {
     void init();
     void dispose();
     void random_bytes(void *data, size_t length);
+
+    // base64 with padding. the pointer variant writes exactly base64_encoded_size(length)
+    // characters to `out`, without a terminator, so callers can encode straight into a buffer
+    // they already own
+    size_t base64_encoded_size(size_t length);
+    void base64_encode(const uint8_t *ptr, size_t length, char *out);
     std::string base64_encode(const uint8_t *ptr, size_t length);
+
+    // appends the decoded bytes to `out`; false on invalid input, with `out` left as it was
+    bool base64_decode(const char *ptr, size_t length, std::vector<uint8_t> &out);
 }
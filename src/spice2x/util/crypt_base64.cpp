@@ -0,0 +1,146 @@
+#include "crypt.h"
+
+#include <array>
+
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
+// the base64 half of crypt, kept apart from the CryptoAPI calls so it builds without Windows
+
+namespace crypt {
+
+    static const char BASE64_TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if SIMD_X86
+
+    static bool use_ssse3() {
+        static const bool ssse3 = cpuutils::has_ssse3();
+        return ssse3;
+    }
+
+    /*
+     * 12 input bytes to 16 characters per iteration (W. Muła, "Base64 encoding with SIMD
+     * instructions"): the bytes are spread so that each 32 bit lane holds one triplet, the four
+     * 6 bit indices are moved into their own bytes with two multiplies, and the alphabet offset
+     * of each index range is looked up with pshufb. 16 bytes are loaded per step, so the last
+     * few triplets are left to the scalar path. returns the input bytes consumed
+     */
+    SIMD_TARGET_SSSE3 static size_t base64_encode_ssse3(const uint8_t *ptr, size_t length, char *out) {
+        const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m128i shift_lut = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+        size_t consumed = 0;
+        for (; consumed + 16 <= length; consumed += 12, out += 16) {
+            const __m128i in = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + consumed)), spread);
+
+            // indices
+            const __m128i high = _mm_mulhi_epu16(
+                    _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+            const __m128i low = _mm_mullo_epi16(
+                    _mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+            const __m128i indices = _mm_or_si128(high, low);
+
+            // ranges: 0 for a-z, 1-10 for digits, 11 for '+', 12 for '/', 13 for A-Z
+            __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                    _mm_add_epi8(indices, _mm_shuffle_epi8(shift_lut, range)));
+        }
+        return consumed;
+    }
+
+#endif
+
+    size_t base64_encoded_size(size_t length) {
+        return 4 * ((length + 2) / 3);
+    }
+
+    void base64_encode(const uint8_t *ptr, size_t length, char *out) {
+        if (!ptr || !length) {
+            return;
+        }
+
+        size_t i = 0;
+#if SIMD_X86
+        if (use_ssse3()) {
+            i = base64_encode_ssse3(ptr, length, out);
+            out += i / 3 * 4;
+        }
+#endif
+
+        // whole triplets
+        for (; i + 3 <= length; i += 3, out += 4) {
+            const uint32_t triplet = (ptr[i] << 16) | (ptr[i + 1] << 8) | ptr[i + 2];
+            out[0] = BASE64_TABLE[(triplet >> 18) & 0x3F];
+            out[1] = BASE64_TABLE[(triplet >> 12) & 0x3F];
+            out[2] = BASE64_TABLE[(triplet >> 6) & 0x3F];
+            out[3] = BASE64_TABLE[triplet & 0x3F];
+        }
+
+        // padded tail
+        if (i < length) {
+            const bool two = i + 1 < length;
+            const uint32_t triplet = (ptr[i] << 16) | (two ? ptr[i + 1] << 8 : 0);
+            out[0] = BASE64_TABLE[(triplet >> 18) & 0x3F];
+            out[1] = BASE64_TABLE[(triplet >> 12) & 0x3F];
+            out[2] = two ? BASE64_TABLE[(triplet >> 6) & 0x3F] : '=';
+            out[3] = '=';
+        }
+    }
+
+    std::string base64_encode(const uint8_t *ptr, size_t length) {
+        std::string result(base64_encoded_size(length), '=');
+        base64_encode(ptr, length, result.data());
+        return result;
+    }
+
+    bool base64_decode(const char *ptr, size_t length, std::vector<uint8_t> &out) {
+        if (length % 4 != 0) {
+            return false;
+        }
+        if (length == 0) {
+            return true;
+        }
+
+        // alphabet index per character, 0xFF for everything else
+        static const auto values = [] {
+            std::array<uint8_t, 256> table {};
+            table.fill(0xFF);
+            for (uint8_t i = 0; i < 64; i++) {
+                table[static_cast<uint8_t>(BASE64_TABLE[i])] = i;
+            }
+            return table;
+        }();
+
+        size_t padding = 0;
+        if (ptr[length - 1] == '=') {
+            padding = ptr[length - 2] == '=' ? 2 : 1;
+        }
+
+        const size_t start = out.size();
+        out.resize(start + length / 4 * 3);
+        auto dst = out.data() + start;
+        for (size_t i = 0; i < length; i += 4, dst += 3) {
+            const bool last = i + 4 == length;
+            const uint8_t a = values[static_cast<uint8_t>(ptr[i])];
+            const uint8_t b = values[static_cast<uint8_t>(ptr[i + 1])];
+            const uint8_t c = last && padding >= 2 ? 0 : values[static_cast<uint8_t>(ptr[i + 2])];
+            const uint8_t d = last && padding >= 1 ? 0 : values[static_cast<uint8_t>(ptr[i + 3])];
+            if ((a | b | c | d) & 0xC0) {
+                out.resize(start);
+                return false;
+            }
+            const uint32_t triplet = (a << 18) | (b << 12) | (c << 6) | d;
+            dst[0] = static_cast<uint8_t>(triplet >> 16);
+            dst[1] = static_cast<uint8_t>(triplet >> 8);
+            dst[2] = static_cast<uint8_t>(triplet);
+        }
+        out.resize(out.size() - padding);
+        return true;
+    }
+}
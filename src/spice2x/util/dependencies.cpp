@@ -1,7 +1,7 @@
 #include <set>
 #include "logging.h"
 #include "libutils.h"
-#include "scope_guard.h"
+#include "peimage.h"
 #include "dependencies.h"
 
 using loader_hint = std::tuple<std::string, std::string, std::string>;
@@ -45,50 +45,13 @@ namespace {
 
     auto read_imports(const std::filesystem::path& path) -> std::vector<std::filesystem::path> {
         auto result = std::vector<std::filesystem::path> {};
-        auto const file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+        auto const image = util::PEImage::open(path);
 
-        if (file == INVALID_HANDLE_VALUE) {
+        if (!image || !image->valid()) {
             return result;
         }
 
-        auto const file_ = scope_guard { [file] { CloseHandle(file); } };
-        auto const mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
-
-        if (!mapping) {
-            return result;
-        }
-
-        auto const mapping_ = scope_guard { [mapping] { CloseHandle(mapping); } };
-        auto const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
-
-        if (!view) {
-            return result;
-        }
-
-        auto const view_ = scope_guard { [view] { UnmapViewOfFile(view); } };
-        auto const dos = static_cast<PIMAGE_DOS_HEADER>(view);
-
-        if (dos->e_magic != IMAGE_DOS_SIGNATURE) {
-            return result;
-        }
-
-        auto const base = static_cast<std::uint8_t*>(view);
-        auto const nt = reinterpret_cast<PIMAGE_NT_HEADERS>(base + dos->e_lfanew);
-
-        if (nt->Signature != IMAGE_NT_SIGNATURE) {
-            return result;
-        }
-
-        auto const imports = nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
-
-        if (imports.VirtualAddress == 0) {
-            return result;
-        }
-
-        auto desc = reinterpret_cast<PIMAGE_IMPORT_DESCRIPTOR>(base + libutils::rva2offset(nt, imports.VirtualAddress));
-
-        while (desc->Name != 0) {
-            auto const filename = reinterpret_cast<char*>(base + libutils::rva2offset(nt, desc->Name));
+        for (auto const& filename : image->imports()) {
             auto entry_path = path.parent_path().append(filename);
 
             // try to use library in the same directory if one exists
@@ -98,7 +61,6 @@ namespace {
             }
 
             result.emplace_back(entry_path);
-            desc++;
         }
 
         return result;
@@ -7,6 +7,7 @@
 #include <direct.h>
 
 #include "logging.h"
+#include "peimage.h"
 
 bool fileutils::file_exists(LPCSTR szPath) {
     DWORD dwAttrib = GetFileAttributesA(szPath);
@@ -35,105 +36,48 @@ std::string fileutils::basename(std::string_view path) {
 }
 
 bool fileutils::verify_header_pe(const std::filesystem::path &file_path) {
-    if (!file_exists(file_path)) {
+    const auto image = util::PEImage::open(file_path);
+    if (!image || !image->valid()) {
         return false;
     }
 
-    // open file
-    HANDLE dll_file;
-    dll_file = CreateFileW(
-            file_path.c_str(),
-            GENERIC_READ,
-            FILE_SHARE_READ,
-            NULL,
-            OPEN_EXISTING,
-            FILE_ATTRIBUTE_NORMAL,
-            0);
-    if (!dll_file) {
-        return false;
-    }
-
-    // get size
-    LARGE_INTEGER dll_file_size;
-    if (!GetFileSizeEx(dll_file, &dll_file_size) || (size_t) dll_file_size.QuadPart < sizeof(PIMAGE_DOS_HEADER)) {
-        CloseHandle(dll_file);
-        return false;
-    }
-
-    // create file mapping
-    HANDLE dll_mapping = CreateFileMappingW(dll_file, NULL, PAGE_READONLY, 0, 0, NULL);
-    if (!dll_mapping) {
-        CloseHandle(dll_file);
-        return false;
-    }
-
-    // map view of file
-    LPVOID dll_file_base = MapViewOfFile(dll_mapping, FILE_MAP_READ, 0, 0, 0);
-    if (!dll_file_base) {
-        CloseHandle(dll_file);
-        CloseHandle(dll_mapping);
-        return false;
-    }
-
-    // verify header
-    bool valid = false;
-    auto dll_dos = reinterpret_cast<PIMAGE_DOS_HEADER>(dll_file_base);
-    if (dll_dos->e_magic == IMAGE_DOS_SIGNATURE) {
-
-        // verify architecture
-        auto dll_nt = (PIMAGE_NT_HEADERS) ((uint8_t*) dll_dos + dll_dos->e_lfanew);
-        if ((size_t) dll_nt - (size_t) dll_file_base < (size_t) dll_file_size.QuadPart) {
-            auto dll_file_header = (PIMAGE_FILE_HEADER) &dll_nt->FileHeader;
-            if ((size_t) dll_file_header - (size_t) dll_file_base < (size_t) dll_file_size.QuadPart) {
+    // verify architecture
+    const auto machine = image->file_header().Machine;
 #if SPICE64
-                valid = dll_file_header->Machine == IMAGE_FILE_MACHINE_AMD64;
-                if (!valid) {
-                    log_fatal("fileutils",
-                            "{} (32 bit) can't be loaded using spice64.exe - please use spice.exe for this game.",
-                            file_path);
-                }
+    const bool valid = machine == IMAGE_FILE_MACHINE_AMD64;
+    if (!valid) {
+        log_fatal("fileutils",
+                "{} (32 bit) can't be loaded using spice64.exe - please use spice.exe for this game.",
+                file_path);
+    }
 #else
-                valid = dll_file_header->Machine == IMAGE_FILE_MACHINE_I386;
-                if (!valid) {
-                    log_fatal("fileutils",
-                            "{} (64 bit) can't be loaded using spice.exe - please use spice64.exe for this game.",
-                            file_path);
-                }
-#endif
-            }
-        }
+    const bool valid = machine == IMAGE_FILE_MACHINE_I386;
+    if (!valid) {
+        log_fatal("fileutils",
+                "{} (64 bit) can't be loaded using spice.exe - please use spice64.exe for this game.",
+                file_path);
     }
-
-    // clean up and return
-    UnmapViewOfFile(dll_file_base);
-    CloseHandle(dll_file);
-    CloseHandle(dll_mapping);
+#endif
     return valid;
 }
 
 bool fileutils::version_pe(const std::filesystem::path &file_path, char *ver) {
-    DWORD dwHandle = 0;
-    DWORD dwLen = GetFileVersionInfoSizeW(file_path.c_str(), &dwHandle);
-    if (!dwLen) {
-        return false;
-    }
-
-    auto buf = std::make_unique<uint8_t[]>(dwLen);
-    if (!GetFileVersionInfoW(file_path.c_str(), dwHandle, dwLen, buf.get())) {
+    const auto image = util::PEImage::open(file_path);
+    if (!image) {
         return false;
     }
 
-    VS_FIXEDFILEINFO *pvi = nullptr;
-    UINT uLen = 0;
-    if (!VerQueryValueW(buf.get(), L"\\", reinterpret_cast<void **>(&pvi), &uLen)) {
+    const auto &version = image->version();
+    if (!version.has_fixed_info) {
         return false;
     }
 
+    const auto &pvi = version.fixed_info;
     sprintf(ver, "%d.%d.%d.%d",
-            (int) (pvi->dwProductVersionMS >> 16),
-            (int) (pvi->dwFileVersionMS & 0xFFFF),
-            (int) (pvi->dwFileVersionLS >> 16),
-            (int) (pvi->dwFileVersionLS & 0xFFFF));
+            (int) (pvi.dwProductVersionMS >> 16),
+            (int) (pvi.dwFileVersionMS & 0xFFFF),
+            (int) (pvi.dwFileVersionLS >> 16),
+            (int) (pvi.dwFileVersionLS & 0xFFFF));
 
     return true;
 }
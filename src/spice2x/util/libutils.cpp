@@ -9,8 +9,8 @@
 #include "utils.h"
 #include "peb.h"
 #include "util/fileutils.h"
+#include "util/peimage.h"
 #include "util/dependencies.h"
-#include "util/unique_plain_ptr.h"
 
 #define DEBUG_VERBOSE 0
 
@@ -219,50 +219,11 @@ intptr_t libutils::rva2offset(IMAGE_NT_HEADERS *nt_headers, intptr_t rva) {
 
 
 intptr_t libutils::rva2offset(const std::filesystem::path &path, intptr_t rva) {
-
-    // open file
-    HANDLE dll_file = CreateFileW(
-            path.c_str(),
-            GENERIC_READ,
-            FILE_SHARE_READ,
-            NULL,
-            OPEN_EXISTING,
-            FILE_ATTRIBUTE_NORMAL,
-            0);
-    if (!dll_file) {
-        return ~0;
-    }
-
-    // create file mapping
-    HANDLE dll_mapping = CreateFileMappingW(dll_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
-    if (!dll_mapping) {
-        CloseHandle(dll_file);
-        log_warning("libutils", "could not create file mapping for {}", path);
+    const auto image = util::PEImage::open(path);
+    if (!image || !image->valid()) {
         return -1;
     }
-
-    // map view of file
-    LPVOID dll_file_base = MapViewOfFile(dll_mapping, FILE_MAP_READ, 0, 0, 0);
-    if (!dll_file_base) {
-        CloseHandle(dll_file);
-        CloseHandle(dll_mapping);
-        log_warning("libutils", "could not map view of file for {}", path);
-        return -1;
-    }
-
-    // get offset
-    intptr_t offset = -1;
-    auto dll_dos = reinterpret_cast<PIMAGE_DOS_HEADER>(dll_file_base);
-    if (dll_dos->e_magic == IMAGE_DOS_SIGNATURE) {
-        auto dll_nt = reinterpret_cast<PIMAGE_NT_HEADERS>(reinterpret_cast<uint8_t *>(dll_dos) + dll_dos->e_lfanew);
-        offset = libutils::rva2offset(dll_nt, rva);
-    }
-
-    // clean up and return
-    UnmapViewOfFile(dll_file_base);
-    CloseHandle(dll_file);
-    CloseHandle(dll_mapping);
-    return offset;
+    return image->rva2offset(rva);
 }
 
 intptr_t libutils::offset2rva(IMAGE_NT_HEADERS *nt_headers, intptr_t offset) {
@@ -290,51 +251,11 @@ intptr_t libutils::offset2rva(IMAGE_NT_HEADERS *nt_headers, intptr_t offset) {
 }
 
 intptr_t libutils::offset2rva(const std::filesystem::path &path, intptr_t offset) {
-
-    // open file
-    HANDLE dll_file = CreateFileW(
-            path.c_str(),
-            GENERIC_READ,
-            FILE_SHARE_READ,
-            nullptr,
-            OPEN_EXISTING,
-            FILE_ATTRIBUTE_NORMAL,
-            0);
-    if (!dll_file) {
+    const auto image = util::PEImage::open(path);
+    if (!image || !image->valid()) {
         return -1;
     }
-
-    // create file mapping
-    HANDLE dll_mapping = CreateFileMappingW(dll_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
-    if (!dll_mapping) {
-        log_warning("libutils", "could not create file mapping for {}: {}", path, get_last_error_string());
-        CloseHandle(dll_file);
-        return -1;
-    }
-
-    // map view of file
-    LPVOID dll_file_base = MapViewOfFile(dll_mapping, FILE_MAP_READ, 0, 0, 0);
-    if (!dll_file_base) {
-        log_warning("libutils", "could not map view of file for {}: {}", path, get_last_error_string());
-        CloseHandle(dll_file);
-        CloseHandle(dll_mapping);
-        return -1;
-    }
-
-    // get RVA
-    intptr_t rva = -1;
-    auto dll_dos = reinterpret_cast<PIMAGE_DOS_HEADER>(dll_file_base);
-    if (dll_dos->e_magic == IMAGE_DOS_SIGNATURE) {
-        auto dll_nt = reinterpret_cast<PIMAGE_NT_HEADERS>(reinterpret_cast<uint8_t *>(dll_dos) + dll_dos->e_lfanew);
-        rva = libutils::offset2rva(dll_nt, offset);
-    }
-
-    // clean up
-    UnmapViewOfFile(dll_file_base);
-    CloseHandle(dll_file);
-    CloseHandle(dll_mapping);
-
-    return rva;
+    return image->offset2rva(offset);
 }
 
 void libutils::check_duplicate_dlls() {
@@ -384,94 +305,24 @@ void libutils::warn_if_dll_exists(const std::string &file_name) {
 }
 
 void libutils::print_dll_info(std::filesystem::path filename) {
-    DWORD handle;
-    const auto size = GetFileVersionInfoSizeW(filename.wstring().c_str(), &handle);
-    if (size == 0) {
-        log_debug(
-            "libutils",
-            "GetFileVersionInfoSizeA failed for {}: {}",
-            filename.filename(),
-            get_last_error_string());
-        return;
-    }
-
-    auto data = util::make_unique_plain<VOID>(size);
-    if (!GetFileVersionInfoW(filename.wstring().c_str(), handle, size, data.get())) {
-        log_debug(
-            "libutils",
-            "GetFileVersionInfoA failed for {}: {}",
-            filename.filename(),
-            get_last_error_string());
+    const auto image = util::PEImage::open(filename);
+    if (!image) {
+        log_debug("libutils", "could not open {}", filename.filename());
         return;
     }
 
-    struct LANGANDCODEPAGE {
-        WORD wLanguage;
-        WORD wCodePage;
-    } *lpTranslate = nullptr;
-
-    UINT cbTranslate = 0;
-    if (!VerQueryValueA(data.get(), "\\VarFileInfo\\Translation", (LPVOID*)&lpTranslate, &cbTranslate)) {
-        log_debug(
-            "libutils",
-            "VerQueryValueA failed for {}: {}",
-            filename.filename(),
-            get_last_error_string());
+    const auto &version = image->version();
+    if (!version.has_fixed_info && version.company_name.empty() &&
+        version.product_name.empty() && version.file_version.empty()) {
+        log_debug("libutils", "no version resource in {}", filename.filename());
         return;
     }
-    if (cbTranslate == 0 || lpTranslate == nullptr) {
-        log_debug(
-            "libutils",
-            "VerQueryValueA returned invalid results for {}",
-            filename.filename());
-        return;
-    }
-
-    // pick language - prefer English
-    WORD lang = 0, codepage = 0;
-    for (UINT i = 0; i < cbTranslate / sizeof(*lpTranslate); i++) {
-        if (lpTranslate[i].wLanguage == 0x0409) { // en-us
-            lang = lpTranslate[i].wLanguage;
-            codepage = lpTranslate[i].wCodePage;
-            break;
-        }
-    }
-    if (lang == 0) {
-        lang = lpTranslate[0].wLanguage;
-        codepage = lpTranslate[0].wCodePage;
-    }
-
-    // StringFileInfo helper
-    auto query_string = [&](const char* key) -> std::string {
-        std::string subBlock = fmt::format(
-            "\\StringFileInfo\\{:04x}{:04x}\\{}",
-            lang, codepage, key
-        );
-
-        char* value = nullptr;
-        UINT size_out = 0;
-
-        if (VerQueryValueA(data.get(), subBlock.c_str(), (LPVOID*)&value, &size_out) && value) {
-            return value;
-        }
-        log_debug(
-            "libutils",
-            "VerQueryValueA({}) failed for {}: {}",
-            subBlock,
-            filename.filename(),
-            get_last_error_string());
-        return "";
-    };
-
-    const auto company_name = query_string("CompanyName");
-    const auto product_name = query_string("ProductName");
-    const auto version_str = query_string("FileVersion");
 
     log_info(
         "libutils",
         "DLL info for {}: CompanyName = {}, ProductName = {}, Version = {}",
         filename.filename(),
-        company_name.empty() ? "?" : company_name,
-        product_name.empty() ? "?" : product_name,
-        version_str.empty() ? "?" : version_str);
+        version.company_name.empty() ? "?" : version.company_name,
+        version.product_name.empty() ? "?" : version.product_name,
+        version.file_version.empty() ? "?" : version.file_version);
 }
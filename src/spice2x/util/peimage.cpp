@@ -0,0 +1,440 @@
+#include "peimage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+    namespace {
+
+        template<typename T>
+        inline T read(const uint8_t *p) {
+            T value;
+            memcpy(&value, p, sizeof(T));
+            return value;
+        }
+
+        // UTF-16 to UTF-8, unpaired surrogates become U+FFFD
+        std::string narrow(const char16_t *text, size_t length) {
+            std::string result;
+            result.reserve(length);
+            for (size_t i = 0; i < length; i++) {
+                uint32_t c = text[i];
+                if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length &&
+                    text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (text[++i] - 0xDC00);
+                } else if (c >= 0xD800 && c <= 0xDFFF) {
+                    c = 0xFFFD;
+                }
+                if (c < 0x80) {
+                    result += static_cast<char>(c);
+                } else if (c < 0x800) {
+                    result += static_cast<char>(0xC0 | (c >> 6));
+                    result += static_cast<char>(0x80 | (c & 0x3F));
+                } else if (c < 0x10000) {
+                    result += static_cast<char>(0xE0 | (c >> 12));
+                    result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (c & 0x3F));
+                } else {
+                    result += static_cast<char>(0xF0 | (c >> 18));
+                    result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                    result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (c & 0x3F));
+                }
+            }
+            return result;
+        }
+
+        /*
+         * VS_VERSIONINFO is a tree of nodes: a header of three words, a null terminated UTF-16
+         * key, the value and the children, each padded to a multiple of 4 bytes
+         */
+        struct VersionNode {
+            std::u16string_view key;
+            uint16_t type;
+            const uint8_t *value;
+            size_t value_size;
+            const uint8_t *children;
+            const uint8_t *end;
+        };
+
+        inline const uint8_t *align4(const uint8_t *blob, const uint8_t *p) {
+            return blob + ((p - blob + 3) & ~static_cast<ptrdiff_t>(3));
+        }
+
+        bool parse_version_node(const uint8_t *blob, const uint8_t *p, const uint8_t *limit, VersionNode &node) {
+            if (limit - p < 6) {
+                return false;
+            }
+            const uint16_t length = read<uint16_t>(p);
+            const uint16_t value_length = read<uint16_t>(p + 2);
+            node.type = read<uint16_t>(p + 4);
+            if (length < 6 || length > limit - p) {
+                return false;
+            }
+            node.end = p + length;
+
+            // key
+            auto key = reinterpret_cast<const char16_t *>(p + 6);
+            auto key_end = key;
+            while (reinterpret_cast<const uint8_t *>(key_end + 1) <= node.end && *key_end != 0) {
+                key_end++;
+            }
+            if (reinterpret_cast<const uint8_t *>(key_end + 1) > node.end) {
+                return false;
+            }
+            node.key = std::u16string_view(key, key_end - key);
+
+            // value, its length is in characters for text values
+            node.value = align4(blob, reinterpret_cast<const uint8_t *>(key_end + 1));
+            node.value_size = node.type == 1 ? value_length * sizeof(char16_t) : value_length;
+            if (node.value > node.end || node.value_size > static_cast<size_t>(node.end - node.value)) {
+                node.value = node.end;
+                node.value_size = 0;
+            }
+            node.children = std::min(align4(blob, node.value + node.value_size), node.end);
+            return true;
+        }
+
+        template<typename F>
+        void for_each_version_child(const uint8_t *blob, const VersionNode &parent, F callback) {
+            VersionNode child;
+            const uint8_t *p = parent.children;
+            while (p < parent.end && parse_version_node(blob, p, parent.end, child)) {
+                callback(child);
+                p = align4(blob, child.end);
+            }
+        }
+
+        inline bool key_equals(std::u16string_view key, std::string_view ascii) {
+            return key.size() == ascii.size() && std::equal(key.begin(), key.end(), ascii.begin(),
+                    [](char16_t a, char b) { return a == static_cast<unsigned char>(b); });
+        }
+
+        void parse_version_blob(const uint8_t *blob, size_t size, PEImage::VersionInfo &info) {
+            VersionNode root;
+            if (!parse_version_node(blob, blob, blob + size, root) || !key_equals(root.key, "VS_VERSION_INFO")) {
+                return;
+            }
+            if (root.value_size >= sizeof(VS_FIXEDFILEINFO)) {
+                memcpy(&info.fixed_info, root.value, sizeof(VS_FIXEDFILEINFO));
+                info.has_fixed_info = info.fixed_info.dwSignature == 0xFEEF04BD;
+            }
+
+            // pick the string table - prefer English
+            VersionNode table {};
+            bool table_found = false;
+            bool table_english = false;
+            for_each_version_child(blob, root, [&](const VersionNode &child) {
+                if (!key_equals(child.key, "StringFileInfo")) {
+                    return;
+                }
+                for_each_version_child(blob, child, [&](const VersionNode &candidate) {
+                    const bool english = key_equals(candidate.key.substr(0, 4), "0409");
+                    if (!table_found || (english && !table_english)) {
+                        table = candidate;
+                        table_found = true;
+                        table_english = english;
+                    }
+                });
+            });
+            if (!table_found) {
+                return;
+            }
+
+            for_each_version_child(blob, table, [&](const VersionNode &entry) {
+                auto text = reinterpret_cast<const char16_t *>(entry.value);
+                size_t length = entry.value_size / sizeof(char16_t);
+                while (length > 0 && text[length - 1] == 0) {
+                    length--;
+                }
+                if (key_equals(entry.key, "CompanyName")) {
+                    info.company_name = narrow(text, length);
+                } else if (key_equals(entry.key, "ProductName")) {
+                    info.product_name = narrow(text, length);
+                } else if (key_equals(entry.key, "FileVersion")) {
+                    info.file_version = narrow(text, length);
+                }
+            });
+        }
+    }
+
+    std::shared_ptr<const PEImage> PEImage::parse(std::vector<uint8_t> data) {
+        auto storage = std::make_shared<std::vector<uint8_t>>(std::move(data));
+        const auto base = storage->data();
+        const auto length = storage->size();
+        return std::shared_ptr<const PEImage>(new PEImage(std::shared_ptr<const uint8_t>(std::move(storage), base), length));
+    }
+
+    PEImage::PEImage(std::shared_ptr<const uint8_t> storage, size_t length)
+            : storage(std::move(storage)), base(this->storage.get()), length(length) {
+        if (length < sizeof(IMAGE_DOS_HEADER) || read<uint16_t>(base) != IMAGE_DOS_SIGNATURE) {
+            return;
+        }
+
+        // NT headers up to and including the optional header magic
+        const auto nt_offset = static_cast<size_t>(read<LONG>(base + offsetof(IMAGE_DOS_HEADER, e_lfanew)));
+        const size_t optional_offset = nt_offset + offsetof(IMAGE_NT_HEADERS32, OptionalHeader);
+        if (nt_offset > length || length - nt_offset < offsetof(IMAGE_NT_HEADERS32, OptionalHeader) + sizeof(WORD)) {
+            return;
+        }
+        if (read<DWORD>(base + nt_offset) != IMAGE_NT_SIGNATURE) {
+            return;
+        }
+        auto nt = reinterpret_cast<const IMAGE_NT_HEADERS32 *>(base + nt_offset);
+
+        // optional header and section table must be within the file
+        const auto optional_size = static_cast<size_t>(nt->FileHeader.SizeOfOptionalHeader);
+        const size_t sections_offset = optional_offset + optional_size;
+        const size_t section_count = nt->FileHeader.NumberOfSections;
+        if (sections_offset > length ||
+            (length - sections_offset) / sizeof(IMAGE_SECTION_HEADER) < section_count) {
+            return;
+        }
+
+        // the data directories follow the fixed part of the optional header, which differs
+        // between PE32 and PE32+
+        size_t fixed_size;
+        DWORD directory_count;
+        switch (read<WORD>(base + optional_offset)) {
+            case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+                fixed_size = offsetof(IMAGE_OPTIONAL_HEADER32, DataDirectory);
+                if (optional_size < fixed_size) {
+                    return;
+                }
+                directory_count = reinterpret_cast<const IMAGE_OPTIONAL_HEADER32 *>(
+                        base + optional_offset)->NumberOfRvaAndSizes;
+                break;
+            case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+                fixed_size = offsetof(IMAGE_OPTIONAL_HEADER64, DataDirectory);
+                if (optional_size < fixed_size) {
+                    return;
+                }
+                directory_count = reinterpret_cast<const IMAGE_OPTIONAL_HEADER64 *>(
+                        base + optional_offset)->NumberOfRvaAndSizes;
+                this->pe32_plus = true;
+                break;
+            default:
+                return;
+        }
+
+        this->nt_headers = nt;
+        this->data_directories = reinterpret_cast<const IMAGE_DATA_DIRECTORY *>(base + optional_offset + fixed_size);
+        this->data_directory_count = std::min<size_t>({
+            directory_count,
+            (optional_size - fixed_size) / sizeof(IMAGE_DATA_DIRECTORY),
+            IMAGE_NUMBEROF_DIRECTORY_ENTRIES,
+        });
+        this->section_table = reinterpret_cast<const IMAGE_SECTION_HEADER *>(base + sections_offset);
+        this->sections_count = section_count;
+    }
+
+    const IMAGE_FILE_HEADER &PEImage::file_header() const {
+        return this->nt_headers->FileHeader;
+    }
+
+    uint32_t PEImage::entry_point() const {
+
+        // same offset in PE32 and PE32+
+        return this->nt_headers->OptionalHeader.AddressOfEntryPoint;
+    }
+
+    IMAGE_DATA_DIRECTORY PEImage::directory(size_t index) const {
+        if (index >= this->data_directory_count) {
+            return IMAGE_DATA_DIRECTORY {};
+        }
+        return read<IMAGE_DATA_DIRECTORY>(reinterpret_cast<const uint8_t *>(&this->data_directories[index]));
+    }
+
+    intptr_t PEImage::rva2offset(intptr_t rva) const {
+        for (size_t i = 0; i < this->sections_count; i++) {
+            const auto section = read<IMAGE_SECTION_HEADER>(
+                    reinterpret_cast<const uint8_t *>(&this->section_table[i]));
+            if (section.VirtualAddress <= (DWORD) rva &&
+                (section.VirtualAddress + section.Misc.VirtualSize) > (DWORD) rva) {
+                return rva - section.VirtualAddress + section.PointerToRawData;
+            }
+        }
+        return -1;
+    }
+
+    intptr_t PEImage::offset2rva(intptr_t offset) const {
+        for (size_t i = 0; i < this->sections_count; i++) {
+            const auto section = read<IMAGE_SECTION_HEADER>(
+                    reinterpret_cast<const uint8_t *>(&this->section_table[i]));
+            if (section.PointerToRawData <= (DWORD) offset &&
+                (section.PointerToRawData + section.SizeOfRawData) > (DWORD) offset) {
+                return offset - section.PointerToRawData + section.VirtualAddress;
+            }
+        }
+        return -1;
+    }
+
+    const uint8_t *PEImage::at_rva(uint32_t rva, size_t size) const {
+        const auto offset = this->rva2offset(rva);
+        if (offset < 0 || static_cast<size_t>(offset) > this->length || this->length - offset < size) {
+            return nullptr;
+        }
+        return this->base + offset;
+    }
+
+    const std::vector<std::string> &PEImage::imports() const {
+        std::call_once(this->imports_once, [this] { this->parse_imports(); });
+        return this->import_list;
+    }
+
+    const std::vector<PEImage::Export> &PEImage::exports() const {
+        std::call_once(this->exports_once, [this] { this->parse_exports(); });
+        return this->export_list;
+    }
+
+    const PEImage::Export *PEImage::find_export(std::string_view name) const {
+
+        // exports by ordinal only have no name to match
+        if (name.empty()) {
+            return nullptr;
+        }
+        for (const auto &entry : this->exports()) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    const PEImage::VersionInfo &PEImage::version() const {
+        std::call_once(this->version_once, [this] { this->parse_version(); });
+        return this->version_info;
+    }
+
+    // null terminated string at `rva`, empty when it runs past the end of the file
+    static std::string string_at_rva(const PEImage &image, uint32_t rva) {
+        auto text = image.at_rva(rva, 1);
+        if (!text) {
+            return std::string();
+        }
+        const size_t max_length = image.size() - (text - image.data());
+        const auto end = static_cast<const uint8_t *>(memchr(text, 0, max_length));
+        return end ? std::string(reinterpret_cast<const char *>(text), end - text) : std::string();
+    }
+
+    void PEImage::parse_imports() const {
+        if (!this->valid()) {
+            return;
+        }
+        const auto directory = this->directory(IMAGE_DIRECTORY_ENTRY_IMPORT);
+        if (directory.VirtualAddress == 0) {
+            return;
+        }
+        for (uint32_t rva = directory.VirtualAddress;; rva += sizeof(IMAGE_IMPORT_DESCRIPTOR)) {
+            auto descriptor = this->at_rva(rva, sizeof(IMAGE_IMPORT_DESCRIPTOR));
+            if (!descriptor) {
+                break;
+            }
+            const auto name = read<DWORD>(descriptor + offsetof(IMAGE_IMPORT_DESCRIPTOR, Name));
+            if (name == 0) {
+                break;
+            }
+            auto dll_name = string_at_rva(*this, name);
+            if (!dll_name.empty()) {
+                this->import_list.emplace_back(std::move(dll_name));
+            }
+        }
+    }
+
+    void PEImage::parse_exports() const {
+        if (!this->valid()) {
+            return;
+        }
+        const auto directory = this->directory(IMAGE_DIRECTORY_ENTRY_EXPORT);
+        auto header = this->at_rva(directory.VirtualAddress, sizeof(IMAGE_EXPORT_DIRECTORY));
+        if (directory.VirtualAddress == 0 || !header) {
+            return;
+        }
+        const auto exports = read<IMAGE_EXPORT_DIRECTORY>(header);
+        if (exports.NumberOfFunctions > 0x10000 || exports.NumberOfNames > exports.NumberOfFunctions) {
+            return;
+        }
+        auto functions = this->at_rva(exports.AddressOfFunctions, exports.NumberOfFunctions * sizeof(DWORD));
+        if (!functions) {
+            return;
+        }
+
+        this->export_list.reserve(exports.NumberOfFunctions);
+        for (DWORD i = 0; i < exports.NumberOfFunctions; i++) {
+            this->export_list.push_back(Export {
+                .name = std::string(),
+                .ordinal = static_cast<uint16_t>(exports.Base + i),
+                .rva = read<DWORD>(functions + i * sizeof(DWORD)),
+            });
+        }
+
+        // attach names through the name ordinal table
+        auto names = this->at_rva(exports.AddressOfNames, exports.NumberOfNames * sizeof(DWORD));
+        auto ordinals = this->at_rva(exports.AddressOfNameOrdinals, exports.NumberOfNames * sizeof(WORD));
+        if (names && ordinals) {
+            for (DWORD i = 0; i < exports.NumberOfNames; i++) {
+                const auto index = read<WORD>(ordinals + i * sizeof(WORD));
+                if (index < this->export_list.size()) {
+                    this->export_list[index].name = string_at_rva(*this, read<DWORD>(names + i * sizeof(DWORD)));
+                }
+            }
+        }
+
+        // unused slots
+        this->export_list.erase(std::remove_if(this->export_list.begin(), this->export_list.end(),
+                [](const Export &entry) { return entry.rva == 0; }), this->export_list.end());
+    }
+
+    void PEImage::parse_version() const {
+        if (!this->valid()) {
+            return;
+        }
+        const auto directory = this->directory(IMAGE_DIRECTORY_ENTRY_RESOURCE);
+        const uint32_t root = directory.VirtualAddress;
+        if (root == 0) {
+            return;
+        }
+
+        // resource directory entries are a name/ID followed by an offset relative to the root,
+        // with the high bit set for subdirectories
+        auto find_entry = [this, root](uint32_t directory_offset, bool by_id, uint32_t id, uint32_t &result) {
+            auto header = this->at_rva(root + directory_offset, sizeof(IMAGE_RESOURCE_DIRECTORY));
+            if (!header) {
+                return false;
+            }
+            const auto named = read<WORD>(header + offsetof(IMAGE_RESOURCE_DIRECTORY, NumberOfNamedEntries));
+            const auto ids = read<WORD>(header + offsetof(IMAGE_RESOURCE_DIRECTORY, NumberOfIdEntries));
+            const uint32_t count = named + ids;
+            auto entries = this->at_rva(root + directory_offset + sizeof(IMAGE_RESOURCE_DIRECTORY), count * 8);
+            if (!entries) {
+                return false;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                const auto name = read<DWORD>(entries + i * 8);
+                if (!by_id || name == id) {
+                    result = read<DWORD>(entries + i * 8 + 4);
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // type RT_VERSION, then the first name and the first language
+        uint32_t offset = 0;
+        if (!find_entry(0, true, 16, offset) || !(offset & 0x80000000) ||
+            !find_entry(offset & 0x7FFFFFFF, false, 0, offset) || !(offset & 0x80000000) ||
+            !find_entry(offset & 0x7FFFFFFF, false, 0, offset) || (offset & 0x80000000)) {
+            return;
+        }
+        auto data_entry = this->at_rva(root + offset, sizeof(IMAGE_RESOURCE_DATA_ENTRY));
+        if (!data_entry) {
+            return;
+        }
+        const auto data = read<IMAGE_RESOURCE_DATA_ENTRY>(data_entry);
+        auto blob = this->at_rva(data.OffsetToData, data.Size);
+        if (blob && (reinterpret_cast<uintptr_t>(blob) & 1) == 0) {
+            parse_version_blob(blob, data.Size, this->version_info);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <windows.h>
+
+namespace util {
+
+    /*
+     * Read-only view of a PE file on disk, shared by everything that inspects game DLLs.
+     *
+     * Files are mapped once and kept in a process wide cache keyed by path, which is refreshed
+     * when the size or last write time of the file changes. Headers are validated on open, the
+     * import and export directories and the version resource are parsed on first use. Both 32
+     * and 64 bit images can be inspected from either build, and every access is bounds checked
+     * so truncated or malformed files read as invalid instead of faulting.
+     *
+     * The parsing in peimage.cpp only needs the PE structure definitions, the file mapping and
+     * cache live in peimage_cache.cpp.
+     */
+    class PEImage {
+    public:
+
+        struct Export {
+            std::string name; // empty for exports by ordinal only
+            uint16_t ordinal;
+            uint32_t rva;
+        };
+
+        struct VersionInfo {
+            bool has_fixed_info = false;
+            VS_FIXEDFILEINFO fixed_info {};
+
+            // from the english string table, or the first one if there is none
+            std::string company_name;
+            std::string product_name;
+            std::string file_version;
+        };
+
+        struct Stats {
+            size_t opens = 0;
+            size_t cache_hits = 0;
+            uint64_t bytes_mapped = 0;
+        };
+
+        // cached image for `path`; null when the file can't be opened or mapped
+        static std::shared_ptr<const PEImage> open(const std::filesystem::path &path);
+
+        // drops the cached image, call before modifying the file on disk.
+        // images still referenced elsewhere stay mapped until released
+        static void evict(const std::filesystem::path &path);
+
+        static Stats stats();
+
+        // image over an in-memory copy of a file, not cached
+        static std::shared_ptr<const PEImage> parse(std::vector<uint8_t> data);
+
+        PEImage(const PEImage &) = delete;
+        PEImage &operator=(const PEImage &) = delete;
+
+        const uint8_t *data() const { return this->base; }
+        size_t size() const { return this->length; }
+
+        // DOS and NT headers are present and within the file; everything below requires this
+        bool valid() const { return this->nt_headers != nullptr; }
+        bool is_64bit() const { return this->pe32_plus; }
+
+        const IMAGE_FILE_HEADER &file_header() const;
+        uint32_t entry_point() const;
+        const IMAGE_SECTION_HEADER *sections() const { return this->section_table; }
+        size_t section_count() const { return this->sections_count; }
+
+        // data directory entry, zeroed when absent
+        IMAGE_DATA_DIRECTORY directory(size_t index) const;
+
+        // file offset <-> RVA through the section table, -1 when outside of all sections
+        intptr_t rva2offset(intptr_t rva) const;
+        intptr_t offset2rva(intptr_t offset) const;
+
+        // pointer to `size` bytes at `rva` within the file, null when out of bounds
+        const uint8_t *at_rva(uint32_t rva, size_t size) const;
+
+        // names of the imported DLLs
+        const std::vector<std::string> &imports() const;
+
+        // exported functions, in ordinal order
+        const std::vector<Export> &exports() const;
+        const Export *find_export(std::string_view name) const;
+
+        const VersionInfo &version() const;
+
+    private:
+
+        // `storage` keeps the file contents alive, a mapped view or an owned copy
+        PEImage(std::shared_ptr<const uint8_t> storage, size_t length);
+
+        void parse_imports() const;
+        void parse_exports() const;
+        void parse_version() const;
+
+        std::shared_ptr<const uint8_t> storage;
+        const uint8_t *base;
+        size_t length;
+
+        const IMAGE_NT_HEADERS32 *nt_headers = nullptr;
+        bool pe32_plus = false;
+        const IMAGE_DATA_DIRECTORY *data_directories = nullptr;
+        size_t data_directory_count = 0;
+        const IMAGE_SECTION_HEADER *section_table = nullptr;
+        size_t sections_count = 0;
+
+        // lazily parsed parts
+        mutable std::once_flag imports_once;
+        mutable std::vector<std::string> import_list;
+        mutable std::once_flag exports_once;
+        mutable std::vector<Export> export_list;
+        mutable std::once_flag version_once;
+        mutable VersionInfo version_info;
+    };
+}
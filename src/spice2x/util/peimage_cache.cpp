@@ -0,0 +1,117 @@
+#include "peimage.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <unordered_map>
+
+#include "logging.h"
+#include "utils.h"
+
+namespace util {
+
+    namespace {
+
+        // on 32 bit builds address space is scarce, so large files are mapped per open instead
+        // of staying mapped for the lifetime of the process
+#if SPICE64
+        constexpr uint64_t CACHE_SIZE_LIMIT = UINT64_MAX;
+#else
+        constexpr uint64_t CACHE_SIZE_LIMIT = 64 * 1024 * 1024;
+#endif
+
+        struct CacheEntry {
+            std::shared_ptr<const PEImage> image;
+            uint64_t file_size;
+            FILETIME last_write;
+        };
+
+        std::mutex CACHE_MUTEX;
+        std::unordered_map<std::wstring, CacheEntry> CACHE;
+        PEImage::Stats STATS;
+
+        // paths are case insensitive on windows
+        std::wstring cache_key(const std::filesystem::path &path) {
+            std::wstring key = path.lexically_normal().wstring();
+            std::transform(key.begin(), key.end(), key.begin(), ::towlower);
+            return key;
+        }
+    }
+
+    std::shared_ptr<const PEImage> PEImage::open(const std::filesystem::path &path) {
+
+        // the attributes give size and write time without opening the file
+        WIN32_FILE_ATTRIBUTE_DATA attributes {};
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes) ||
+            (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            return nullptr;
+        }
+        const uint64_t file_size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        if (file_size == 0 || file_size > SIZE_MAX) {
+            return nullptr;
+        }
+
+        const auto key = cache_key(path);
+        std::lock_guard lock(CACHE_MUTEX);
+        auto it = CACHE.find(key);
+        if (it != CACHE.end()) {
+            if (it->second.file_size == file_size &&
+                CompareFileTime(&it->second.last_write, &attributes.ftLastWriteTime) == 0) {
+                STATS.cache_hits++;
+                return it->second.image;
+            }
+            CACHE.erase(it);
+        }
+
+        // map the whole file; the view keeps the mapping alive, so both handles can go right
+        // away and other processes are free to open the file for reading
+        HANDLE file = CreateFileW(
+                path.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_DELETE,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            log_warning("peimage", "could not create file mapping for {}: {}", path, get_last_error_string());
+            return nullptr;
+        }
+        auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) {
+            log_warning("peimage", "could not map view of file for {}: {}", path, get_last_error_string());
+            return nullptr;
+        }
+
+        std::shared_ptr<const uint8_t> storage(static_cast<const uint8_t *>(view), [](const uint8_t *data) {
+            UnmapViewOfFile(data);
+        });
+        std::shared_ptr<const PEImage> image(new PEImage(std::move(storage), file_size));
+        STATS.opens++;
+        STATS.bytes_mapped += file_size;
+
+        if (file_size <= CACHE_SIZE_LIMIT) {
+            CACHE.emplace(key, CacheEntry {
+                .image = image,
+                .file_size = file_size,
+                .last_write = attributes.ftLastWriteTime,
+            });
+        }
+        return image;
+    }
+
+    void PEImage::evict(const std::filesystem::path &path) {
+        std::lock_guard lock(CACHE_MUTEX);
+        CACHE.erase(cache_key(path));
+    }
+
+    PEImage::Stats PEImage::stats() {
+        std::lock_guard lock(CACHE_MUTEX);
+        return STATS;
+    }
+}
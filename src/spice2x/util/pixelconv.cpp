@@ -0,0 +1,239 @@
+#include "pixelconv.h"
+
+#include <cstring>
+
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
+namespace pixelconv {
+
+    void row_to_rgb_scalar(
+            SourceFormat format,
+            const uint8_t *data,
+            uint8_t *pixels,
+            size_t begin,
+            size_t width) {
+
+        switch (format) {
+            case SourceFormat::XRGB8888: {
+                for (size_t column = begin; column < width; column++) {
+                    auto cell = data + column * 4;
+                    auto pixel = &pixels[column * 3];
+                    pixel[0] = cell[2];
+                    pixel[1] = cell[1];
+                    pixel[2] = cell[0];
+                }
+                break;
+            }
+            // the 5 and 6 bit channels are widened by bit replication so that
+            // full scale stays full scale
+            case SourceFormat::RGB565: {
+                auto cells = reinterpret_cast<const uint16_t *>(data);
+                for (size_t column = begin; column < width; column++) {
+                    const uint16_t cell = cells[column];
+                    const uint8_t red = (cell >> 11) & 0x1F;
+                    const uint8_t green = (cell >> 5) & 0x3F;
+                    const uint8_t blue = cell & 0x1F;
+                    auto pixel = &pixels[column * 3];
+                    pixel[0] = (red << 3) | (red >> 2);
+                    pixel[1] = (green << 2) | (green >> 4);
+                    pixel[2] = (blue << 3) | (blue >> 2);
+                }
+                break;
+            }
+            case SourceFormat::XRGB1555: {
+                auto cells = reinterpret_cast<const uint16_t *>(data);
+                for (size_t column = begin; column < width; column++) {
+                    const uint16_t cell = cells[column];
+                    const uint8_t red = (cell >> 10) & 0x1F;
+                    const uint8_t green = (cell >> 5) & 0x1F;
+                    const uint8_t blue = cell & 0x1F;
+                    auto pixel = &pixels[column * 3];
+                    pixel[0] = (red << 3) | (red >> 2);
+                    pixel[1] = (green << 3) | (green >> 2);
+                    pixel[2] = (blue << 3) | (blue >> 2);
+                }
+                break;
+            }
+            case SourceFormat::ARGB2101010: {
+                auto cells = reinterpret_cast<const uint32_t *>(data);
+                for (size_t column = begin; column < width; column++) {
+                    const uint32_t cell = cells[column];
+                    auto pixel = &pixels[column * 3];
+                    pixel[0] = static_cast<uint8_t>((cell >> 22) & 0xFF);
+                    pixel[1] = static_cast<uint8_t>((cell >> 12) & 0xFF);
+                    pixel[2] = static_cast<uint8_t>((cell >> 2) & 0xFF);
+                }
+                break;
+            }
+            default: {
+                std::memset(&pixels[begin * 3], 0, (width - begin) * 3);
+            }
+        }
+    }
+
+#if SIMD_X86
+
+    static bool use_ssse3() {
+        static const bool ssse3 = cpuutils::has_ssse3();
+        return ssse3;
+    }
+
+    // kernels work on blocks of sixteen pixels, which come out as exactly three stores of RGB
+    static constexpr size_t SIMD_BLOCK = 16;
+
+    // packs sixteen pixels, four per register, into 48 bytes of RGB. `order` picks the three
+    // channel bytes of each pixel in RGB order and zeroes the last four lanes
+    static SIMD_TARGET_SSSE3 SIMD_INLINE void ssse3_store_rgb(
+            uint8_t *pixels, __m128i order, __m128i q0, __m128i q1, __m128i q2, __m128i q3) {
+
+        q0 = _mm_shuffle_epi8(q0, order);
+        q1 = _mm_shuffle_epi8(q1, order);
+        q2 = _mm_shuffle_epi8(q2, order);
+        q3 = _mm_shuffle_epi8(q3, order);
+
+        auto out = reinterpret_cast<__m128i *>(pixels);
+        _mm_storeu_si128(out + 0, _mm_or_si128(q0, _mm_slli_si128(q1, 12)));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_srli_si128(q1, 4), _mm_slli_si128(q2, 8)));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_srli_si128(q2, 8), _mm_slli_si128(q3, 4)));
+    }
+
+    static SIMD_TARGET_SSSE3 SIMD_INLINE __m128i ssse3_rgbx_order() {
+        return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    }
+
+    // sixteen pixels given as one register per channel
+    static SIMD_TARGET_SSSE3 SIMD_INLINE void ssse3_store_channels(
+            uint8_t *pixels, __m128i red, __m128i green, __m128i blue) {
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rg_lo = _mm_unpacklo_epi8(red, green);
+        const __m128i rg_hi = _mm_unpackhi_epi8(red, green);
+        const __m128i b_lo = _mm_unpacklo_epi8(blue, zero);
+        const __m128i b_hi = _mm_unpackhi_epi8(blue, zero);
+        ssse3_store_rgb(pixels, ssse3_rgbx_order(),
+                _mm_unpacklo_epi16(rg_lo, b_lo),
+                _mm_unpackhi_epi16(rg_lo, b_lo),
+                _mm_unpacklo_epi16(rg_hi, b_hi),
+                _mm_unpackhi_epi16(rg_hi, b_hi));
+    }
+
+    // bit replication like the scalar path, on 16 bit lanes
+    static SIMD_TARGET_SSSE3 SIMD_INLINE __m128i widen5(__m128i v) {
+        return _mm_or_si128(_mm_slli_epi16(v, 3), _mm_srli_epi16(v, 2));
+    }
+
+    static SIMD_TARGET_SSSE3 SIMD_INLINE __m128i widen6(__m128i v) {
+        return _mm_or_si128(_mm_slli_epi16(v, 2), _mm_srli_epi16(v, 4));
+    }
+
+    // keeps the top 8 bits of each 10 bit channel, moved straight to its byte
+    static SIMD_TARGET_SSSE3 SIMD_INLINE __m128i rgbx_from_2101010(__m128i cells) {
+        return _mm_or_si128(
+                _mm_or_si128(
+                        _mm_and_si128(_mm_srli_epi32(cells, 22), _mm_set1_epi32(0x0000FF)),
+                        _mm_and_si128(_mm_srli_epi32(cells, 4), _mm_set1_epi32(0x00FF00))),
+                _mm_and_si128(_mm_slli_epi32(cells, 14), _mm_set1_epi32(0xFF0000)));
+    }
+
+    // returns the number of columns converted, always a multiple of SIMD_BLOCK
+    static SIMD_TARGET_SSSE3 size_t ssse3_row_to_rgb(
+            SourceFormat format,
+            const uint8_t *data,
+            uint8_t *pixels,
+            size_t width) {
+
+        const size_t blocks = width / SIMD_BLOCK;
+        auto in = reinterpret_cast<const __m128i *>(data);
+
+        switch (format) {
+            case SourceFormat::XRGB8888: {
+                const __m128i order = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+                for (size_t block = 0; block < blocks; block++, in += 4) {
+                    ssse3_store_rgb(pixels + block * SIMD_BLOCK * 3, order,
+                            _mm_loadu_si128(in + 0),
+                            _mm_loadu_si128(in + 1),
+                            _mm_loadu_si128(in + 2),
+                            _mm_loadu_si128(in + 3));
+                }
+                break;
+            }
+            case SourceFormat::RGB565: {
+                const __m128i mask5 = _mm_set1_epi16(0x1F);
+                const __m128i mask6 = _mm_set1_epi16(0x3F);
+                for (size_t block = 0; block < blocks; block++, in += 2) {
+                    const __m128i lo = _mm_loadu_si128(in + 0);
+                    const __m128i hi = _mm_loadu_si128(in + 1);
+                    ssse3_store_channels(pixels + block * SIMD_BLOCK * 3,
+                            _mm_packus_epi16(
+                                    widen5(_mm_srli_epi16(lo, 11)),
+                                    widen5(_mm_srli_epi16(hi, 11))),
+                            _mm_packus_epi16(
+                                    widen6(_mm_and_si128(_mm_srli_epi16(lo, 5), mask6)),
+                                    widen6(_mm_and_si128(_mm_srli_epi16(hi, 5), mask6))),
+                            _mm_packus_epi16(
+                                    widen5(_mm_and_si128(lo, mask5)),
+                                    widen5(_mm_and_si128(hi, mask5))));
+                }
+                break;
+            }
+            case SourceFormat::XRGB1555: {
+                const __m128i mask5 = _mm_set1_epi16(0x1F);
+                for (size_t block = 0; block < blocks; block++, in += 2) {
+                    const __m128i lo = _mm_loadu_si128(in + 0);
+                    const __m128i hi = _mm_loadu_si128(in + 1);
+                    ssse3_store_channels(pixels + block * SIMD_BLOCK * 3,
+                            _mm_packus_epi16(
+                                    widen5(_mm_and_si128(_mm_srli_epi16(lo, 10), mask5)),
+                                    widen5(_mm_and_si128(_mm_srli_epi16(hi, 10), mask5))),
+                            _mm_packus_epi16(
+                                    widen5(_mm_and_si128(_mm_srli_epi16(lo, 5), mask5)),
+                                    widen5(_mm_and_si128(_mm_srli_epi16(hi, 5), mask5))),
+                            _mm_packus_epi16(
+                                    widen5(_mm_and_si128(lo, mask5)),
+                                    widen5(_mm_and_si128(hi, mask5))));
+                }
+                break;
+            }
+            case SourceFormat::ARGB2101010: {
+                for (size_t block = 0; block < blocks; block++, in += 4) {
+                    ssse3_store_rgb(pixels + block * SIMD_BLOCK * 3, ssse3_rgbx_order(),
+                            rgbx_from_2101010(_mm_loadu_si128(in + 0)),
+                            rgbx_from_2101010(_mm_loadu_si128(in + 1)),
+                            rgbx_from_2101010(_mm_loadu_si128(in + 2)),
+                            rgbx_from_2101010(_mm_loadu_si128(in + 3)));
+                }
+                break;
+            }
+            default:
+                return 0;
+        }
+
+        return blocks * SIMD_BLOCK;
+    }
+
+#endif
+
+    void row_to_rgb(SourceFormat format, const uint8_t *data, uint8_t *pixels, size_t width) {
+        size_t converted = 0;
+#if SIMD_X86
+        if (use_ssse3()) {
+            converted = ssse3_row_to_rgb(format, data, pixels, width);
+        }
+#endif
+        row_to_rgb_scalar(format, data, pixels, converted, width);
+    }
+
+    void image_to_rgb(
+            SourceFormat format,
+            size_t width,
+            size_t height,
+            const uint8_t *data,
+            size_t pitch,
+            uint8_t *pixels) {
+
+        for (size_t row = 0; row < height; row++) {
+            row_to_rgb(format, data + row * pitch, pixels + row * width * 3, width);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * conversion of the surface layouts screenshots and api captures are read in to packed 24bpp
+ * RGB, in R, G, B byte order. kept free of D3D so the kernels can be tested and measured on
+ * their own; the graphics backends map their formats onto SourceFormat
+ */
+
+namespace pixelconv {
+
+    enum class SourceFormat {
+        XRGB8888,       // X8R8G8B8 and A8R8G8B8, 4 bytes per pixel
+        RGB565,         // R5G6B5, 2 bytes per pixel
+        XRGB1555,       // X1R5G5B5 and A1R5G5B5, 2 bytes per pixel
+        ARGB2101010,    // A2R10G10B10, 4 bytes per pixel
+    };
+
+    // convert one row of `width` pixels, with SSSE3 when the CPU has it
+    void row_to_rgb(SourceFormat format, const uint8_t *data, uint8_t *pixels, size_t width);
+
+    // convert the columns [begin, width) of one row; the scalar reference for the SSSE3 kernels,
+    // which leave it the columns that do not fill a whole block of sixteen
+    void row_to_rgb_scalar(
+            SourceFormat format,
+            const uint8_t *data,
+            uint8_t *pixels,
+            size_t begin,
+            size_t width);
+
+    // a whole image whose rows are `pitch` bytes apart, into tightly packed rows
+    void image_to_rgb(
+            SourceFormat format,
+            size_t width,
+            size_t height,
+            const uint8_t *data,
+            size_t pitch,
+            uint8_t *pixels);
+}
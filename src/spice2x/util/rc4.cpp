@@ -1,46 +1,88 @@
 #include "rc4.h"
+#include <algorithm>
+#include <cstring>
 #include <iterator>
-#include "util/logging.h"
 
 util::RC4::RC4(uint8_t *key, size_t key_size) {
 
     // initialize S-BOX
     for (size_t i = 0; i < std::size(s_box); i++)
-        s_box[i] = (uint8_t) i;
+        s_box[i] = (uint32_t) i;
 
     // check key size
     if (!key_size)
         return;
 
     // KSA
-    size_t j = 0;
+    uint8_t j = 0;
+    size_t key_pos = 0;
     for (size_t i = 0; i < std::size(s_box); i++) {
 
         // update
-        j = (j + s_box[i] + key[i % key_size]) % std::size(s_box);
+        j += s_box[i] + key[key_pos];
+        if (++key_pos == key_size)
+            key_pos = 0;
 
         // swap
-        auto tmp = s_box[i];
-        s_box[i] = s_box[j];
-        s_box[j] = tmp;
+        std::swap(s_box[i], s_box[j]);
     }
 }
 
 void util::RC4::crypt(uint8_t *data, size_t size) {
 
-    // iterate all bytes
-    for (size_t pos = 0; pos < size; pos++) {
+    // indices stay in registers for the whole call instead of going through the object
+    uint8_t i = a, j = b;
 
-        // update
-        a = (a + 1) % std::size(s_box);
-        b = (b + s_box[a]) % std::size(s_box);
+    // the keystream is generated a block at a time and applied a word at a time
+    alignas(8) uint8_t keystream[256];
+    while (size > 0) {
+        const size_t block = std::min(size, sizeof(keystream));
 
-        // swap
-        auto tmp = s_box[a];
-        s_box[a] = s_box[b];
-        s_box[b] = tmp;
+        for (size_t pos = 0; pos < block; pos++) {
+            const uint32_t si = s_box[++i];
+            j += si;
+            const uint32_t sj = s_box[j];
+            s_box[i] = sj;
+            s_box[j] = si;
+            keystream[pos] = (uint8_t) s_box[(uint8_t) (si + sj)];
+        }
+
+        size_t pos = 0;
+        for (; pos + 8 <= block; pos += 8) {
+            uint64_t word, key;
+            memcpy(&word, data + pos, 8);
+            memcpy(&key, keystream + pos, 8);
+            word ^= key;
+            memcpy(data + pos, &word, 8);
+        }
+        for (; pos < block; pos++)
+            data[pos] ^= keystream[pos];
 
-        // crypt
-        data[pos] ^= s_box[(s_box[a] + s_box[b]) % std::size(s_box)];
+        data += block;
+        size -= block;
     }
+
+    a = i;
+    b = j;
+}
+
+size_t util::RC4::crypt_until(uint8_t *data, size_t size, uint8_t terminator) {
+    uint8_t i = a, j = b;
+
+    // a byte at a time, the terminator has to be checked before the keystream moves on
+    size_t pos = 0;
+    while (pos < size) {
+        const uint32_t si = s_box[++i];
+        j += si;
+        const uint32_t sj = s_box[j];
+        s_box[i] = sj;
+        s_box[j] = si;
+        data[pos] ^= (uint8_t) s_box[(uint8_t) (si + sj)];
+        if (data[pos++] == terminator)
+            break;
+    }
+
+    a = i;
+    b = j;
+    return pos;
 }
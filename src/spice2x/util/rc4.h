@@ -1,18 +1,27 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace util {
 
     class RC4 {
     private:
-        uint8_t s_box[256];
-        size_t a = 0, b = 0;
+        // byte values held in words: whole word loads and stores keep the swap in the
+        // keystream loop free of partial register writes
+        uint32_t s_box[256];
+
+        // wrap at 256 by their type
+        uint8_t a = 0, b = 0;
 
     public:
 
         RC4(uint8_t *key, size_t key_size);
 
         void crypt(uint8_t *data, size_t size);
+
+        // crypts up to and including the first byte that comes out as `terminator`, so a
+        // stream can switch keys right after a message; returns how many bytes it crypted
+        size_t crypt_until(uint8_t *data, size_t size, uint8_t terminator);
     };
 }
@@ -7,6 +7,7 @@
 
 #include "util/logging.h"
 #include "util/memutils.h"
+#include "util/peimage.h"
 #include "util/utils.h"
 
 intptr_t find_pattern(std::vector<uint8_t> &data, intptr_t base, const uint8_t *pattern,
@@ -273,34 +274,19 @@ intptr_t replace_pattern(HMODULE module, const std::string &signature,
 }
 
 bool get_pe_identifier(const std::filesystem::path& dll_path, uint32_t* time_date_stamp, uint32_t* address_of_entry_point) {
-    std::ifstream file(dll_path, std::ios::binary);
-    if (!file) {
+    const auto image = util::PEImage::open(dll_path);
+    if (!image) {
         log_warning("sigscan", "Failed to open file: {}", dll_path);
         return false;
     }
-
-    // read the DOS header
-    IMAGE_DOS_HEADER dos_header;
-    file.read(reinterpret_cast<char*>(&dos_header), sizeof(dos_header));
-    if (dos_header.e_magic != IMAGE_DOS_SIGNATURE) {
-        log_warning("sigscan", "Invalid DOS signature: {}", dll_path);
-        return false;
-    }
-
-    // move to the NT headers
-    file.seekg(dos_header.e_lfanew);
-
-    // read the NT headers
-    IMAGE_NT_HEADERS nt_headers;
-    file.read(reinterpret_cast<char*>(&nt_headers), sizeof(nt_headers));
-    if (nt_headers.Signature != IMAGE_NT_SIGNATURE) {
-        log_warning("sigscan", "Invalid NT signature: {}", dll_path);
+    if (!image->valid()) {
+        log_warning("sigscan", "Invalid PE headers: {}", dll_path);
         return false;
     }
 
     // get the TimeDateStamp and AddressOfEntryPoint from the file header
-    *time_date_stamp = nt_headers.FileHeader.TimeDateStamp;
-    *address_of_entry_point = nt_headers.OptionalHeader.AddressOfEntryPoint;
+    *time_date_stamp = image->file_header().TimeDateStamp;
+    *address_of_entry_point = image->entry_point();
 
     return true;
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * helpers for SIMD kernels with runtime dispatch
+ *
+ * the CPU baseline is not raised for the whole build, so kernels that use SSE2 or newer
+ * instruction sets are annotated per function and must only be called after checking the
+ * matching cpuutils::has_*() query.
+ */
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SIMD_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define SIMD_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define SIMD_TARGET_SSE2
+#define SIMD_TARGET_SSSE3
+#define SIMD_TARGET_SSE41
+#define SIMD_TARGET_AVX2
+#define SIMD_INLINE __forceinline
+#endif
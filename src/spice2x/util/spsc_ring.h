@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Bounded single producer, single consumer ring buffer.
+ *
+ * Neither side ever blocks or waits on the other, a full ring rejects pushes instead of
+ * overwriting. With more than one thread on either side, that side has to serialize itself.
+ */
+template<class T, size_t Capacity>
+class spsc_ring {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+
+    // producer
+    bool push(const T &item) {
+        const auto head = this->head_.load(std::memory_order_relaxed);
+        if (head - this->tail_.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        this->buf_[head & (Capacity - 1)] = item;
+        this->head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer
+    bool pop(T &item) {
+        const auto tail = this->tail_.load(std::memory_order_relaxed);
+        if (tail == this->head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = this->buf_[tail & (Capacity - 1)];
+        this->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer, drops everything pushed so far
+    void clear() {
+        this->tail_.store(this->head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // exact from either side as long as the other one does not move meanwhile
+    size_t size() const {
+        const auto tail = this->tail_.load(std::memory_order_acquire);
+        return this->head_.load(std::memory_order_acquire) - tail;
+    }
+
+    bool empty() const {
+        return this->size() == 0;
+    }
+
+    bool full() const {
+        return this->size() >= Capacity;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+
+    // each index on its own cache line so both sides do not keep stealing it from each other
+    alignas(64) std::atomic<size_t> head_ {0};
+    alignas(64) std::atomic<size_t> tail_ {0};
+    alignas(64) T buf_[Capacity] {};
+};
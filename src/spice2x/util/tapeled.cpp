@@ -1,34 +1,237 @@
 #include "tapeled.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "util/cpuutils.h"
+#include "util/simd.h"
+
 namespace tapeledutils {
 
     led_tape_color_pick_algorithm TAPE_LED_ALGORITHM = TAPE_LED_USE_MIDDLE;
 
+    // LEDs summed per kernel call, keeps the 16 bit lanes of the SSE2 sums from overflowing
+    static const size_t SUM_BLOCK_LEDS = 4096;
+
     bool is_enabled() {
         return (TAPE_LED_ALGORITHM != TAPE_LED_USE_NONE);
     }
 
+    static bool use_sse2() {
+#if SIMD_X86
+        static const bool sse2 = cpuutils::has_sse2();
+        return sse2;
+#else
+        return false;
+#endif
+    }
+
+    /*
+     * scalar reference
+     */
+
+    static void sum_channels_scalar(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        for (size_t i = 0; i < count; i++) {
+            sums[0] += data[i * 3];
+            sums[1] += data[i * 3 + 1];
+            sums[2] += data[i * 3 + 2];
+        }
+    }
+
+    static void sum_channel_squares_scalar(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        for (size_t i = 0; i < count; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                const uint32_t value = data[i * 3 + c];
+                sums[c] += value * value;
+            }
+        }
+    }
+
+#if SIMD_X86
+
+    /*
+     * SSE2 kernels
+     *
+     * 16 LEDs are 48 bytes, three registers whose byte lanes always hold the same channel:
+     * lane i of the block is channel i % 3. Lanes are summed on their own and only sorted into
+     * channels at the end.
+     */
+
+    SIMD_TARGET_SSE2 static size_t sum_channels_sse2(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        const size_t blocks = count / 16;
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc[6];
+        for (auto &a : acc) {
+            a = zero;
+        }
+        for (size_t block = 0; block < blocks; block++) {
+            const auto src = reinterpret_cast<const __m128i *>(data + block * 48);
+            for (int r = 0; r < 3; r++) {
+                const __m128i v = _mm_loadu_si128(src + r);
+                acc[r * 2] = _mm_add_epi16(acc[r * 2], _mm_unpacklo_epi8(v, zero));
+                acc[r * 2 + 1] = _mm_add_epi16(acc[r * 2 + 1], _mm_unpackhi_epi8(v, zero));
+            }
+        }
+
+        alignas(16) uint16_t lanes[48];
+        for (int r = 0; r < 6; r++) {
+            _mm_store_si128(reinterpret_cast<__m128i *>(&lanes[r * 8]), acc[r]);
+        }
+        for (size_t lane = 0; lane < 48; lane++) {
+            sums[lane % 3] += lanes[lane];
+        }
+        return blocks * 16;
+    }
+
+    SIMD_TARGET_SSE2 static size_t sum_channel_squares_sse2(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        const size_t blocks = count / 16;
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc[12];
+        for (auto &a : acc) {
+            a = zero;
+        }
+        for (size_t block = 0; block < blocks; block++) {
+            const auto src = reinterpret_cast<const __m128i *>(data + block * 48);
+            for (int r = 0; r < 3; r++) {
+                const __m128i v = _mm_loadu_si128(src + r);
+                const __m128i lo = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+                // squares of bytes fit unsigned 16 bit, widen before summing
+                const __m128i lo_sq = _mm_mullo_epi16(lo, lo);
+                const __m128i hi_sq = _mm_mullo_epi16(hi, hi);
+                acc[r * 4] = _mm_add_epi32(acc[r * 4], _mm_unpacklo_epi16(lo_sq, zero));
+                acc[r * 4 + 1] = _mm_add_epi32(acc[r * 4 + 1], _mm_unpackhi_epi16(lo_sq, zero));
+                acc[r * 4 + 2] = _mm_add_epi32(acc[r * 4 + 2], _mm_unpacklo_epi16(hi_sq, zero));
+                acc[r * 4 + 3] = _mm_add_epi32(acc[r * 4 + 3], _mm_unpackhi_epi16(hi_sq, zero));
+            }
+        }
+
+        alignas(16) uint32_t lanes[48];
+        for (int r = 0; r < 12; r++) {
+            _mm_store_si128(reinterpret_cast<__m128i *>(&lanes[r * 4]), acc[r]);
+        }
+        for (size_t lane = 0; lane < 48; lane++) {
+            sums[lane % 3] += lanes[lane];
+        }
+        return blocks * 16;
+    }
+#endif
+
+    static void sum_channels(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        sums[0] = sums[1] = sums[2] = 0;
+        for (size_t offset = 0; offset < count; offset += SUM_BLOCK_LEDS) {
+            const auto block = std::min(count - offset, SUM_BLOCK_LEDS);
+            const auto src = data + offset * 3;
+            size_t done = 0;
+#if SIMD_X86
+            if (use_sse2()) {
+                done = sum_channels_sse2(src, block, sums);
+            }
+#endif
+            sum_channels_scalar(src + done * 3, block - done, sums);
+        }
+    }
+
+    static void sum_channel_squares(const uint8_t *data, size_t count, uint64_t sums[3]) {
+        sums[0] = sums[1] = sums[2] = 0;
+        for (size_t offset = 0; offset < count; offset += SUM_BLOCK_LEDS) {
+            const auto block = std::min(count - offset, SUM_BLOCK_LEDS);
+            const auto src = data + offset * 3;
+            size_t done = 0;
+#if SIMD_X86
+            if (use_sse2()) {
+                done = sum_channel_squares_sse2(src, block, sums);
+            }
+#endif
+            sum_channel_squares_scalar(src + done * 3, block - done, sums);
+        }
+    }
+
+    /*
+     * Most common color, ignoring LEDs that are (nearly) off unless all of them are. Colors are
+     * grouped by the top three bits of each channel, the result is the average of the largest
+     * group, ties going to the group that reached that size first along the tape.
+     */
+    static void dominant_color(const uint8_t *data, size_t count, uint64_t sums[3], size_t &members) {
+        static const uint8_t OFF_THRESHOLD = 16;
+
+        uint16_t counts[512] {};
+        int best = -1;
+        uint16_t best_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            const auto color = &data[i * 3];
+            if (color[0] < OFF_THRESHOLD && color[1] < OFF_THRESHOLD && color[2] < OFF_THRESHOLD) {
+                continue;
+            }
+            const int bucket = (color[0] >> 5) << 6 | (color[1] >> 5) << 3 | (color[2] >> 5);
+            if (counts[bucket] < UINT16_MAX && ++counts[bucket] > best_count) {
+                best_count = counts[bucket];
+                best = bucket;
+            }
+        }
+
+        // everything is off, that is the color then
+        sums[0] = sums[1] = sums[2] = 0;
+        members = 0;
+        for (size_t i = 0; i < count; i++) {
+            const auto color = &data[i * 3];
+            const int bucket = (color[0] >> 5) << 6 | (color[1] >> 5) << 3 | (color[2] >> 5);
+            if (best >= 0 && bucket != best) {
+                continue;
+            }
+            sums[0] += color[0];
+            sums[1] += color[1];
+            sums[2] += color[2];
+            members++;
+        }
+    }
+
     // for bi2x-style byte array of all colors and LEDs at once
-    static rgb_float3_t pick_color_from_led_tape_internal(uint8_t *data, size_t data_size, uint8_t divisor) {
+    static rgb_float3_t pick_color_from_led_tape_internal(const uint8_t *data, size_t data_size, uint8_t divisor) {
         rgb_float3_t result = {0.f, 0.f, 0.f};
+        if (data_size == 0) {
+            return result;
+        }
+
         if (TAPE_LED_ALGORITHM == TAPE_LED_USE_AVERAGE) {
 
             // calculate average color
-            size_t avg_ri = 0;
-            size_t avg_gi = 0;
-            size_t avg_bi = 0;
-            for (size_t i = 0; i < data_size; i++) {
-                const auto color = &data[i * 3];
-                avg_ri += color[0];
-                avg_gi += color[1];
-                avg_bi += color[2];
-            }
+            uint64_t sums[3];
+            sum_channels(data, data_size, sums);
 
             // normalize
             const float avg_mult = 1.f / (data_size * divisor);
-            result.r = avg_ri * avg_mult;
-            result.g = avg_gi * avg_mult;
-            result.b = avg_bi * avg_mult;
+            result.r = sums[0] * avg_mult;
+            result.g = sums[1] * avg_mult;
+            result.b = sums[2] * avg_mult;
+
+        } else if (TAPE_LED_ALGORITHM == TAPE_LED_USE_PERCEPTUAL) {
+
+            // average the light rather than the values, approximating gamma with a square, so a
+            // few bright LEDs are not drowned out by the dark ones like in a plain average
+            uint64_t sums[3];
+            sum_channel_squares(data, data_size, sums);
+
+            // normalize
+            const float mult = 1.f / divisor;
+            result.r = std::sqrt((float) sums[0] / data_size) * mult;
+            result.g = std::sqrt((float) sums[1] / data_size) * mult;
+            result.b = std::sqrt((float) sums[2] / data_size) * mult;
+
+        } else if (TAPE_LED_ALGORITHM == TAPE_LED_USE_DOMINANT) {
+
+            // average of the most common color
+            uint64_t sums[3];
+            size_t members;
+            dominant_color(data, data_size, sums, members);
+
+            // normalize
+            const float avg_mult = 1.f / (members * divisor);
+            result.r = sums[0] * avg_mult;
+            result.g = sums[1] * avg_mult;
+            result.b = sums[2] * avg_mult;
 
         } else if (TAPE_LED_ALGORITHM == TAPE_LED_USE_FIRST ||
             TAPE_LED_ALGORITHM == TAPE_LED_USE_MIDDLE ||
@@ -67,22 +270,31 @@ namespace tapeledutils {
         return pick_color_from_led_tape_internal(data, data_size, 0xFF);
     }
 
-    // for bi2a-style that calls for each individual LED
-    size_t get_led_index_using_avg_algo(size_t data_size) {
-        size_t index_to_use;
+    bool update_led_tape(tape_cache &cache, const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t &color) {
+        return update_led_tape(cache, data, data_size, max_value, &color, 1);
+    }
+
+    bool update_led_tape(tape_cache &cache, const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t *colors, size_t zone_count) {
 
-        if (TAPE_LED_ALGORITHM == TAPE_LED_USE_FIRST) {
-            index_to_use = 0;
-        } else if (TAPE_LED_ALGORITHM == TAPE_LED_USE_LAST) {
-            index_to_use = data_size - 1;
-        } else if (TAPE_LED_ALGORITHM == TAPE_LED_USE_MIDDLE) {
-            index_to_use = (size_t)(data_size / 2);
-        } else {
-            // TAPE_LED_USE_AVERAGE can't work for this model since we don't cache the entire tape
-            // LED array, so just use the middle-of-tape value instead
-            index_to_use = (size_t)(data_size / 2);
+        // games resend unchanged tapes all the time, skip those
+        const auto bytes = data_size * 3;
+        if (cache.data.size() == bytes && memcmp(cache.data.data(), data, bytes) == 0) {
+            return false;
         }
+        cache.data.assign(data, data + bytes);
+        pick_zone_colors_from_led_tape(data, data_size, max_value, colors, zone_count);
+        return true;
+    }
 
-        return index_to_use;
+    void pick_zone_colors_from_led_tape(const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t *colors, size_t zone_count) {
+        const auto divisor = max_value > 0 ? max_value : 0xFF;
+        for (size_t zone = 0; zone < zone_count; zone++) {
+            const auto begin = data_size * zone / zone_count;
+            const auto end = data_size * (zone + 1) / zone_count;
+            colors[zone] = pick_color_from_led_tape_internal(&data[begin * 3], end - begin, divisor);
+        }
     }
 }
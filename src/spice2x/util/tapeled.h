@@ -12,6 +12,8 @@ namespace tapeledutils {
         TAPE_LED_USE_MIDDLE = 2,
         TAPE_LED_USE_LAST = 3,
         TAPE_LED_USE_AVERAGE = 4,
+        TAPE_LED_USE_PERCEPTUAL = 5,
+        TAPE_LED_USE_DOMINANT = 6,
     };
 
     extern led_tape_color_pick_algorithm TAPE_LED_ALGORITHM;
@@ -22,11 +24,17 @@ namespace tapeledutils {
         float b;
     } rgb_float3_t;
 
+    // a tape as of the last update, so colors are only picked again when it changed
+    struct tape_cache {
+        std::vector<uint8_t> data;
+    };
+
     struct tape_led {
         std::vector<rgb_float3_t> data;
         int index_r, index_g, index_b; // Averaged RGB light output indexes
         uint8_t max_value;
         std::string lightName;
+        tape_cache cache;
 
         tape_led(
             size_t data_size,
@@ -53,5 +61,20 @@ namespace tapeledutils {
     bool is_enabled();
     rgb_float3_t pick_color_from_led_tape(tape_led &light, uint8_t *data, size_t data_size);
     rgb_float3_t pick_color_from_led_tape(uint8_t *data, size_t data_size);
-    size_t get_led_index_using_avg_algo(size_t data_size);
+
+    /*
+     * Picks the color of a tape of `data_size` RGB LEDs like pick_color_from_led_tape, but only
+     * when the tape differs from what `cache` saw last. Returns false and leaves `color` alone
+     * when nothing changed, so callers can skip writing the lights.
+     */
+    bool update_led_tape(tape_cache &cache, const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t &color);
+
+    // same for a tape split into zones, see pick_zone_colors_from_led_tape
+    bool update_led_tape(tape_cache &cache, const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t *colors, size_t zone_count);
+
+    // splits the tape into `zone_count` equally long segments and picks a color for each
+    void pick_zone_colors_from_led_tape(const uint8_t *data, size_t data_size, uint8_t max_value,
+            rgb_float3_t *colors, size_t zone_count);
 }
@@ -0,0 +1,216 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+#include "util/logging.h"
+
+namespace {
+
+    // which pool and worker the calling thread belongs to, if any
+    thread_local ThreadPool *CURRENT_POOL = nullptr;
+    thread_local size_t CURRENT_INDEX = 0;
+
+    struct ParallelFor {
+        size_t first;
+        size_t last;
+        size_t grain;
+        size_t chunks;
+        void (*call)(void *, size_t, size_t);
+        void *context;
+
+        std::atomic<size_t> next {0};
+        std::atomic<size_t> remaining;
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        // the context is only touched for a claimed chunk, and the caller does not return
+        // before every claimed chunk is done, so late helpers never see it dangle
+        void run() {
+            for (size_t chunk = this->next++; chunk < this->chunks; chunk = this->next++) {
+                const size_t begin = this->first + chunk * this->grain;
+                const size_t end = std::min(begin + this->grain, this->last);
+                try {
+                    this->call(this->context, begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(this->error_mutex);
+                    if (!this->error) {
+                        this->error = std::current_exception();
+                    }
+                }
+                if (this->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    this->remaining.notify_all();
+                }
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool(size_t size) : worker_count(size), locals(new WorkQueue[size]) {
+    this->threads.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        this->threads.emplace_back([this, i] {
+            this->worker(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+
+    // set under the lock, or a worker between its check and its wait would sleep through it
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->exit.store(true);
+    }
+    this->sleep_cv.notify_all();
+
+    // workers finish what is queued before they leave
+    for (auto &thread : this->threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static auto *instance = new ThreadPool(
+            std::clamp<size_t>(std::thread::hardware_concurrency(), 3, 9) - 1);
+    return *instance;
+}
+
+void ThreadPool::push(Task task, TaskPriority priority) {
+    WorkQueue *queue;
+    if (priority == TaskPriority::High) {
+        queue = &this->urgent;
+    } else if (CURRENT_POOL == this) {
+        queue = &this->locals[CURRENT_INDEX];
+    } else {
+        queue = &this->injected;
+    }
+
+    // publish the task before counting it, so a worker seeing the count always finds
+    // something to take instead of spinning until the push lands
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(std::move(task));
+    }
+    this->queued.fetch_add(1);
+
+    // pairs with the worker announcing itself before it checks `queued`: either it sees
+    // this task, or this sees it and wakes it
+    if (this->sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->sleep_cv.notify_one();
+    }
+}
+
+bool ThreadPool::pop_front(WorkQueue &queue, Task &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::pop_back(WorkQueue &queue, Task &task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::take(size_t index, Task &task) {
+    bool found = this->pop_front(this->urgent, task)
+            || this->pop_back(this->locals[index], task)
+            || this->pop_front(this->injected, task);
+
+    // steal, starting at the next worker so thieves spread out
+    for (size_t i = 1; !found && i < this->worker_count; i++) {
+        found = this->pop_front(this->locals[(index + i) % this->worker_count], task);
+    }
+
+    if (found) {
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return found;
+}
+
+void ThreadPool::worker(size_t index) {
+    CURRENT_POOL = this;
+    CURRENT_INDEX = index;
+
+    while (true) {
+        Task task;
+        if (this->take(index, task)) {
+
+            // an escape from here would terminate the process
+            try {
+                task();
+            } catch (const std::exception &e) {
+                log_warning("threadpool", "task failed: {}", e.what());
+            } catch (...) {
+                log_warning("threadpool", "task failed");
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->sleepers.fetch_add(1);
+        this->sleep_cv.wait(lock, [this] {
+            return this->queued.load() > 0 || this->exit.load();
+        });
+        this->sleepers.fetch_sub(1);
+        if (this->exit.load() && this->queued.load() <= 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallel_for_chunks(size_t first, size_t last, size_t grain,
+        void (*call)(void *, size_t, size_t), void *context, TaskPriority priority) {
+    if (first >= last) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (last - first + grain - 1) / grain;
+
+    // nothing to share
+    if (chunks == 1 || this->worker_count == 0) {
+        for (size_t begin = first; begin < last; begin += grain) {
+            call(context, begin, std::min(begin + grain, last));
+        }
+        return;
+    }
+
+    // shared with the helpers, which may only get to run after this has returned
+    auto state = std::make_shared<ParallelFor>();
+    state->first = first;
+    state->last = last;
+    state->grain = grain;
+    state->chunks = chunks;
+    state->call = call;
+    state->context = context;
+    state->remaining.store(chunks, std::memory_order_relaxed);
+
+    const size_t helpers = std::min(chunks - 1, this->worker_count);
+    for (size_t i = 0; i < helpers; i++) {
+        this->post([state] {
+            state->run();
+        }, priority);
+    }
+
+    state->run();
+    for (size_t remaining = state->remaining.load(std::memory_order_acquire); remaining != 0;
+            remaining = state->remaining.load(std::memory_order_acquire)) {
+        state->remaining.wait(remaining, std::memory_order_acquire);
+    }
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
@@ -1,70 +1,230 @@
 #pragma once
 
-#include <vector>
-#include <queue>
-#include <memory>
-#include <thread>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <future>
+#include <cstddef>
+#include <deque>
+#include <exception>
 #include <functional>
-#include <stdexcept>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-class ThreadPool {
-private:
-    std::vector<std::thread> threads;
-    std::queue<std::function<void()>> queue;
-    std::mutex mut;
-    std::condition_variable cv;
-    bool exit = false;
+/*
+ * Work-stealing thread pool.
+ *
+ * Every worker owns a deque. Tasks posted by one of the pool's own workers go to the back of
+ * that worker's deque and are taken back LIFO, which keeps work spawned by a task on the core
+ * that has its data cached, while idle workers steal from the front of the other deques. Tasks
+ * posted from outside the pool go to a FIFO injection queue, so a pool with a single worker
+ * still runs external submissions in order. High priority tasks have a queue of their own that
+ * every worker checks before anything else.
+ *
+ * Tasks are held in a move-only wrapper with inline storage, so posting a small lambda costs
+ * no allocation of its own. post() is fire and forget; add() returns a future and pays for its
+ * shared state. Exceptions escaping a posted task are logged and dropped.
+ */
+
+enum class TaskPriority {
+    Normal,
+    High,
+};
 
+class Task {
 public:
+    // enough for a lambda capturing a few pointers and a vector or two
+    static constexpr size_t INLINE_SIZE = 48;
 
-    ThreadPool(size_t size) {
-        for (size_t i = 0; i < size; i++) {
-            threads.emplace_back([this] {
-                while (true) {
-                    std::function<void()> func;
-                    std::unique_lock<std::mutex> lock(mut);
-                    cv.wait(lock, [this] { return exit || !queue.empty(); });
-                    if (exit && queue.empty()) return;
-                    func = std::move(queue.front());
-                    queue.pop();
-                    lock.unlock();
-                    func();
-                }
-            });
+    Task() = default;
+
+    template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F &&func) {
+        using Func = std::decay_t<F>;
+        if constexpr (fits_inline<Func>()) {
+            new (this->storage) Func(std::forward<F>(func));
+            this->ops = &inline_ops<Func>;
+        } else {
+            *reinterpret_cast<Func **>(this->storage) = new Func(std::forward<F>(func));
+            this->ops = &heap_ops<Func>;
+        }
+    }
+
+    Task(Task &&other) noexcept : ops(other.ops) {
+        if (this->ops) {
+            this->ops->move(this->storage, other.storage);
+            other.ops = nullptr;
         }
     }
 
-    ~ThreadPool() {
-        exit = true;
-        mut.lock();
-        mut.unlock();
-        cv.notify_all();
-        for (auto &thread : threads) {
-            if (thread.joinable()) {
-                thread.join();
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            this->reset();
+            if (other.ops) {
+                other.ops->move(this->storage, other.storage);
+                this->ops = std::exchange(other.ops, nullptr);
             }
         }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        this->reset();
     }
 
-    size_t queue_size() {
-        std::unique_lock<std::mutex> lock(mut);
-        return queue.size();
+    explicit operator bool() const {
+        return this->ops != nullptr;
+    }
+
+    void operator()() {
+        this->ops->invoke(this->storage);
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void *storage);
+        void (*move)(void *destination, void *source) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template<class Func>
+    static constexpr bool fits_inline() {
+        return sizeof(Func) <= INLINE_SIZE
+            && alignof(Func) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Func>;
+    }
+
+    template<class Func>
+    static constexpr Ops inline_ops {
+        [](void *storage) {
+            (*static_cast<Func *>(storage))();
+        },
+        [](void *destination, void *source) noexcept {
+            new (destination) Func(std::move(*static_cast<Func *>(source)));
+            static_cast<Func *>(source)->~Func();
+        },
+        [](void *storage) noexcept {
+            static_cast<Func *>(storage)->~Func();
+        },
+    };
+
+    template<class Func>
+    static constexpr Ops heap_ops {
+        [](void *storage) {
+            (**static_cast<Func **>(storage))();
+        },
+        [](void *destination, void *source) noexcept {
+            *static_cast<Func **>(destination) = *static_cast<Func **>(source);
+        },
+        [](void *storage) noexcept {
+            delete *static_cast<Func **>(storage);
+        },
+    };
+
+    void reset() {
+        if (this->ops) {
+            this->ops->destroy(this->storage);
+            this->ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops *ops = nullptr;
+};
+
+class ThreadPool {
+public:
+
+    explicit ThreadPool(size_t size);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // process wide pool for short CPU bound work, sized to the machine. never destroyed, so
+    // work still queued at exit cannot touch a dead pool
+    static ThreadPool &shared();
+
+    size_t size() const {
+        return this->worker_count;
+    }
+
+    // tasks queued and not yet started
+    size_t queue_size() const {
+        return static_cast<size_t>(std::max<ptrdiff_t>(this->queued.load(std::memory_order_relaxed), 0));
+    }
+
+    template<class F>
+    void post(F &&func, TaskPriority priority = TaskPriority::Normal) {
+        this->push(Task(std::forward<F>(func)), priority);
     }
 
     template<class T, class... Args>
-    auto add(T&& func, Args&&... args)
-    -> std::future<typename std::invoke_result<T, Args...>::type> {
-        using ret_t = typename std::invoke_result<T, Args...>::type;
-        auto task = std::make_shared<std::packaged_task<ret_t()>>(
-                std::bind(std::forward<T>(func), std::forward<Args>(args)...));
-        std::future<ret_t> fut = task->get_future();
-        std::unique_lock<std::mutex> lock(mut);
-        queue.emplace([task] () { (*task)(); });
-        lock.unlock();
-        cv.notify_one();
-        return fut;
+    auto add(T &&func, Args &&... args)
+    -> std::future<std::invoke_result_t<std::decay_t<T> &, std::decay_t<Args> &...>> {
+        using ret_t = std::invoke_result_t<std::decay_t<T> &, std::decay_t<Args> &...>;
+        std::packaged_task<ret_t()> task(
+                [func = std::forward<T>(func), ...args = std::forward<Args>(args)]() mutable {
+            return std::invoke(func, args...);
+        });
+        auto future = task.get_future();
+        this->push(Task(std::move(task)), TaskPriority::Normal);
+        return future;
     }
+
+    /*
+     * Calls func(begin, end) for consecutive chunks of at most `grain` indices covering
+     * [first, last) and returns once all of them are done. The calling thread works through
+     * chunks itself while up to one helper per worker joins in, so this makes progress even
+     * when called from a busy worker of the same pool. The first exception thrown by a chunk
+     * is rethrown once all chunks have finished.
+     */
+    template<class F>
+    void parallel_for(size_t first, size_t last, size_t grain, F &&func,
+            TaskPriority priority = TaskPriority::Normal) {
+        auto call = [](void *context, size_t begin, size_t end) {
+            (*static_cast<std::remove_reference_t<F> *>(context))(begin, end);
+        };
+        this->parallel_for_chunks(first, last, grain, call, &func, priority);
+    }
+
+private:
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task, TaskPriority priority);
+    bool pop_front(WorkQueue &queue, Task &task);
+    bool pop_back(WorkQueue &queue, Task &task);
+    bool take(size_t index, Task &task);
+    void worker(size_t index);
+
+    void parallel_for_chunks(size_t first, size_t last, size_t grain,
+            void (*call)(void *, size_t, size_t), void *context, TaskPriority priority);
+
+    size_t worker_count;
+    std::unique_ptr<WorkQueue[]> locals;
+    WorkQueue injected;
+    WorkQueue urgent;
+    std::vector<std::thread> threads;
+
+    // a task is counted after it is pushed, so a worker that sees a count here has something
+    // to find. a worker can take the task first, which leaves the count at -1 until the push
+    // catches up; that reads as empty, which it is. workers announce themselves in
+    // `sleepers` before checking it
+    std::atomic<ptrdiff_t> queued {0};
+    std::atomic<size_t> sleepers {0};
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<bool> exit {false};
 };